@@ -0,0 +1,8 @@
+import roaring from ".";
+
+/**
+ * Streaming union of many bitmaps, for merging results as they arrive.
+ *
+ * @type {roaring.RoaringBitmap32Accumulator}
+ */
+export = roaring.RoaringBitmap32Accumulator;
@@ -0,0 +1 @@
+module.exports = require("./index").RoaringBitmap32Accumulator;
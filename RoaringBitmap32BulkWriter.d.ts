@@ -0,0 +1,8 @@
+import roaring from ".";
+
+/**
+ * Adds values to a RoaringBitmap32 in batches, through a reusable Uint32Array.
+ *
+ * @type {roaring.RoaringBitmap32BulkWriter}
+ */
+export = roaring.RoaringBitmap32BulkWriter;
@@ -0,0 +1,8 @@
+import roaring from ".";
+
+/**
+ * A bitmap pack file opened for reading, bitmaps are read or viewed by index on demand.
+ *
+ * @type {roaring.RoaringBitmap32Pack}
+ */
+export = roaring.RoaringBitmap32Pack;
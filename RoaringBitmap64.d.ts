@@ -0,0 +1,10 @@
+import roaring from ".";
+
+/**
+ * Roaring bitmap that supports 64 bit unsigned integers.
+ *
+ * See http://roaringbitmap.org/
+ *
+ * @type {roaring.RoaringBitmap64}
+ */
+export = roaring.RoaringBitmap64;
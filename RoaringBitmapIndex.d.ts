@@ -0,0 +1,8 @@
+import roaring from ".";
+
+/**
+ * A native keyed store of bitmaps, for inverted indexes with millions of keys.
+ *
+ * @type {roaring.RoaringBitmapIndex}
+ */
+export = roaring.RoaringBitmapIndex;
@@ -0,0 +1,8 @@
+import roaring from ".";
+
+/**
+ * A bit-sliced index that maps 32 bit columns to 32 bit unsigned values, for range and aggregate queries.
+ *
+ * @type {roaring.RoaringBitmapSliced32}
+ */
+export = roaring.RoaringBitmapSliced32;
@@ -402,10 +402,11 @@ export interface ReadonlyRoaringBitmap32
    *
    * Same as [Symbol.iterator]()
    *
+   * @param {RoaringBitmap32IteratorOptions} [options] Optional start value and exclusive end bound.
    * @returns {RoaringBitmap32Iterator} A new iterator
    * @memberof ReadonlyRoaringBitmap32
    */
-  iterator(): RoaringBitmap32Iterator;
+  iterator(options?: RoaringBitmap32IteratorOptions): RoaringBitmap32Iterator;
 
   /**
    * Gets a new iterator able to iterate all values in the set in descending order.
@@ -413,10 +414,11 @@ export interface ReadonlyRoaringBitmap32
    * WARNING: Is not allowed to change the bitmap while iterating.
    * The iterator may throw exception if the bitmap is changed during the iteration.
    *
+   * @param {RoaringBitmap32IteratorOptions} [options] Optional start value and exclusive end bound, in descending order.
    * @returns {RoaringBitmap32Iterator} A new reverse iterator
    * @memberof ReadonlyRoaringBitmap32
    */
-  reverseIterator(): RoaringBitmap32Iterator;
+  reverseIterator(options?: RoaringBitmap32IteratorOptions): RoaringBitmap32Iterator;
 
   /**
    * Gets a new iterator able to iterate all values in the set in ascending order.
@@ -676,6 +678,40 @@ export interface ReadonlyRoaringBitmap32
    */
   has(value: unknown): boolean;
 
+  /**
+   * Checks the presence of many values with a single native call.
+   *
+   * By default a new Uint8Array is returned, with 1 for each value in the set and 0 for each value not in the set.
+   * If output is a Uint8Array, it is filled in the same way and returned.
+   * If output is a Uint32Array, it is filled with a packed bitset, where bit i is set if values[i] is in the set,
+   * it must have at least Math.ceil(values.length / 32) elements.
+   *
+   * Lookups of close values are faster, sorting the values improves performance.
+   *
+   * @param {Uint32Array | Int32Array} values The values to search.
+   * @param {Uint8Array | Uint32Array} [output] The output array.
+   * @returns {Uint8Array | Uint32Array} The output array.
+   * @memberof ReadonlyRoaringBitmap32
+   */
+  hasMany(values: Uint32Array | Int32Array): Uint8Array;
+  hasMany<TOutput extends Uint8Array | Uint32Array>(values: Uint32Array | Int32Array, output: TOutput): TOutput;
+
+  /**
+   * Checks the presence of many values asynchronously, splitting the values between multiple threads.
+   * See hasMany. The bitmap is frozen until the operation completes.
+   * The values and the output array must not be modified until the operation completes.
+   *
+   * @param {Uint32Array | Int32Array} values The values to search.
+   * @param {Uint8Array | Uint32Array} [output] The output array.
+   * @returns {Promise<Uint8Array | Uint32Array>} A promise that resolves to the output array.
+   * @memberof ReadonlyRoaringBitmap32
+   */
+  hasManyAsync(values: Uint32Array | Int32Array): Promise<Uint8Array>;
+  hasManyAsync<TOutput extends Uint8Array | Uint32Array>(
+    values: Uint32Array | Int32Array,
+    output: TOutput,
+  ): Promise<TOutput>;
+
   /**
    * Checks wether the given value exists in the set.
    * Is the same as this.has(value).
@@ -882,6 +918,18 @@ export interface ReadonlyRoaringBitmap32
    */
   rank(maxValue: number): number;
 
+  /**
+   * Computes the rank of many values at once, like calling rank for each value.
+   * The values can be in any order, sorted values are ranked with a single pass over the bitmap.
+   *
+   * @param {Uint32Array | Int32Array} values The values to rank.
+   * @param {Float64Array | Uint32Array} [output] The array to fill, it must be at least as long as values. A new Float64Array is created if not given.
+   * @returns {Float64Array | Uint32Array} The output array.
+   * @memberof ReadonlyRoaringBitmap32
+   */
+  rankMany(values: Uint32Array | Int32Array): Float64Array;
+  rankMany<TOutput extends Float64Array | Uint32Array>(values: Uint32Array | Int32Array, output: TOutput): TOutput;
+
   /**
    * If the size of the roaring bitmap is strictly greater than rank,
    * then this function returns the element of given rank.
@@ -894,6 +942,27 @@ export interface ReadonlyRoaringBitmap32
    */
   select(rank: number): number | undefined;
 
+  /**
+   * Selects the elements of many ranks at once, like calling select for each rank.
+   * The ranks can be in any order, sorted ranks are resolved with a single pass over the bitmap.
+   * Ranks greater or equal to the size of the bitmap produce missingValue, NaN by default in a Float64Array output
+   * and 0 by default in a Uint32Array output.
+   * In a Uint32Array output every value can be a member of the bitmap, so 0 or any other missingValue is ambiguous:
+   * pass a value known not to be in the bitmap, or compare the ranks with the size of the bitmap.
+   *
+   * @param {Uint32Array | Int32Array} ranks The ranks to select.
+   * @param {Float64Array | Uint32Array} [output] The array to fill, it must be at least as long as ranks. A new Float64Array is created if not given.
+   * @param {number} [missingValue] The value written for ranks out of range. It must be an unsigned 32 bit integer for a Uint32Array output.
+   * @returns {Float64Array | Uint32Array} The output array.
+   * @memberof ReadonlyRoaringBitmap32
+   */
+  selectMany(ranks: Uint32Array | Int32Array, output?: undefined, missingValue?: number): Float64Array;
+  selectMany<TOutput extends Float64Array | Uint32Array>(
+    ranks: Uint32Array | Int32Array,
+    output: TOutput,
+    missingValue?: number,
+  ): TOutput;
+
   /**
    * Creates a new Uint32Array and fills it with all the values in the bitmap.
    *
@@ -1355,7 +1424,18 @@ export interface RoaringBitmap32 extends ReadonlyRoaringBitmap32 {
   clear(): boolean;
 
   /**
-   * Disposes this bitmap, releasing its native resources. Equivalent to calling clear().
+   * Unmaps the file of a bitmap created with RoaringBitmap32.mapFile.
+   * The bitmap becomes empty and stays frozen.
+   * Throws if an async operation is still reading the bitmap.
+   *
+   * @returns {boolean} True if a mapped file was released, false if this bitmap is not backed by a mapped file.
+   * @memberof RoaringBitmap32
+   */
+  releaseMappedFile(): boolean;
+
+  /**
+   * Disposes this bitmap, releasing its native resources.
+   * Equivalent to calling clear(), or releaseMappedFile() for a bitmap created with RoaringBitmap32.mapFile.
    */
   dispose(): void;
 
@@ -1566,6 +1646,31 @@ export interface RoaringBitmap32 extends ReadonlyRoaringBitmap32 {
    */
   orInPlace(values: Iterable<number>): this;
 
+  /**
+   * Performs an union in place ("this = this OR values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @returns {Promise<this>} A promise that resolves to this RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  orInPlaceAsync(values: Iterable<number>): Promise<this>;
+
+  /**
+   * Performs an union in place ("this = this OR values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  orInPlaceAsync(values: Iterable<number>, callback: RoaringBitmap32Callback): void;
+
   /**
    * Performs a AND NOT operation in place ("this = this AND NOT values"), same as removeMany.
    *
@@ -1579,6 +1684,31 @@ export interface RoaringBitmap32 extends ReadonlyRoaringBitmap32 {
    */
   andNotInPlace(values: Iterable<number>): this;
 
+  /**
+   * Performs a AND NOT operation in place ("this = this AND NOT values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @returns {Promise<this>} A promise that resolves to this RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  andNotInPlaceAsync(values: Iterable<number>): Promise<this>;
+
+  /**
+   * Performs a AND NOT operation in place ("this = this AND NOT values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  andNotInPlaceAsync(values: Iterable<number>, callback: RoaringBitmap32Callback): void;
+
   /**
    * Performs the intersection (and) between the current bitmap and the provided bitmap,
    * writing the result in the current bitmap.
@@ -1595,6 +1725,55 @@ export interface RoaringBitmap32 extends ReadonlyRoaringBitmap32 {
    */
   andInPlace(values: Iterable<number>): this;
 
+  /**
+   * Performs the intersection between the current bitmap and all the provided bitmaps,
+   * writing the result in the current bitmap ("this = this AND bitmaps[0] AND bitmaps[1] ...").
+   *
+   * Bitmaps are intersected from the smallest to the largest, and the operation stops as soon as the result is empty.
+   *
+   * The provided bitmaps are not modified.
+   *
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @returns {this} This RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  andManyInPlace(bitmaps: readonly ReadonlyRoaringBitmap32[]): this;
+
+  /**
+   * Performs the intersection between the current bitmap and all the provided bitmaps,
+   * writing the result in the current bitmap ("this = this AND bitmaps[0] AND bitmaps[1] ...").
+   *
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances.
+   * @returns {this} This RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  andManyInPlace(...bitmaps: readonly ReadonlyRoaringBitmap32[]): this;
+
+  /**
+   * Performs the intersection in place ("this = this AND values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @returns {Promise<this>} A promise that resolves to this RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  andInPlaceAsync(values: Iterable<number>): Promise<this>;
+
+  /**
+   * Performs the intersection in place ("this = this AND values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  andInPlaceAsync(values: Iterable<number>, callback: RoaringBitmap32Callback): void;
+
   /**
    * Performs the symmetric union (xor) between the current bitmap and the provided bitmap,
    * writing the result in the current bitmap.
@@ -1611,6 +1790,31 @@ export interface RoaringBitmap32 extends ReadonlyRoaringBitmap32 {
    */
   xorInPlace(values: Iterable<number>): this;
 
+  /**
+   * Performs the symmetric union in place ("this = this XOR values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @returns {Promise<this>} A promise that resolves to this RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  xorInPlaceAsync(values: Iterable<number>): Promise<this>;
+
+  /**
+   * Performs the symmetric union in place ("this = this XOR values") asynchronously in a worker thread.
+   *
+   * The result replaces the content of this bitmap when the operation completes.
+   * Both bitmaps are frozen while the operation is running, trying to modify them throws.
+   *
+   * @param {Iterable<number>} values A RoaringBitmap32 instance or an iterable of unsigned 32 bit integers.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  xorInPlaceAsync(values: Iterable<number>, callback: RoaringBitmap32Callback): void;
+
   /**
    * Remove run-length encoding even when it is more space efficient.
    *
@@ -2110,6 +2314,8 @@ export class RoaringBitmap32 {
    * This is faster, everything runs in its own thread and it consumes less memory than serializing to a Buffer and then to write to a file,
    * internally it uses memory mapped files and skip all the JS overhead.
    *
+   * Text formats (comma, tab or newline separated values and json_array) are split in chunks parsed in parallel by multiple threads.
+   *
    * @static
    * @param {string} filePath The path of the file to read.
    * @param {FileDeserializationFormatType} format The format of the serialized data. true means "portable". false means "croaring".
@@ -2118,6 +2324,98 @@ export class RoaringBitmap32 {
    */
   static deserializeFileAsync(filePath: string, format: FileDeserializationFormatType): Promise<RoaringBitmap32>;
 
+  /**
+   * Writes many bitmaps in a single bitmap pack file, that can be opened with RoaringBitmap32Pack.
+   *
+   * The pack contains a header, an offset table and the serialized bitmaps, each aligned to 32 bytes,
+   * so a single bitmap can be read or viewed without reading the whole file.
+   *
+   * @static
+   * @param {string} filePath The path of the file to write.
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to write.
+   * @param {"portable" | "unsafe_frozen_croaring"} format The format of each bitmap in the pack.
+   * @memberof RoaringBitmap32
+   */
+  static serializePackFile(
+    filePath: string,
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    format: "portable" | "unsafe_frozen_croaring",
+  ): void;
+
+  /**
+   * Writes many bitmaps in a single bitmap pack file asynchronously, in a worker thread.
+   * The bitmaps are frozen until the operation completes.
+   *
+   * @static
+   * @param {string} filePath The path of the file to write.
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to write.
+   * @param {"portable" | "unsafe_frozen_croaring"} format The format of each bitmap in the pack.
+   * @returns {Promise<void>} A promise that resolves when the file is written.
+   * @memberof RoaringBitmap32
+   */
+  static serializePackFileAsync(
+    filePath: string,
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    format: "portable" | "unsafe_frozen_croaring",
+  ): Promise<void>;
+
+  /**
+   * Serializes many bitmaps asynchronously in multiple parallel threads, with a single scheduling round trip.
+   *
+   * Returns a Promise that resolves to an array of Buffer, one for each bitmap.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to serialize.
+   * @param {SerializationFormatType} format The format of the serialized data. true means "portable". false means "croaring".
+   * @param {{ contiguous?: false }} [options] Options.
+   * @returns {Promise<Buffer[]>} A promise that resolves to the serialized bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static serializeParallelAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    format: SerializationFormatType,
+    options?: { contiguous?: false | undefined },
+  ): Promise<Buffer[]>;
+
+  /**
+   * Serializes many bitmaps asynchronously in multiple parallel threads into a single pre-sized Buffer.
+   *
+   * The bitmap i is serialized in buffer.subarray(offsets[i], offsets[i] + lengths[i]).
+   * With the "unsafe_frozen_croaring" format every bitmap starts at a 32 bytes boundary, so it can be used with unsafeFrozenView.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to serialize.
+   * @param {SerializationFormatType} format The format of the serialized data. true means "portable". false means "croaring".
+   * @param {{ contiguous: true }} options Options.
+   * @returns {Promise<RoaringBitmap32SerializedContiguous>} A promise that resolves to the buffer, the offsets and the lengths.
+   * @memberof RoaringBitmap32
+   */
+  static serializeParallelAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    format: SerializationFormatType,
+    options: { contiguous: true },
+  ): Promise<RoaringBitmap32SerializedContiguous>;
+
+  /**
+   * Serializes many bitmaps asynchronously in multiple parallel threads, with a single scheduling round trip.
+   *
+   * When serialization is completed or failed, the given callback will be executed with an array of Buffer, one for each bitmap.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to serialize.
+   * @param {SerializationFormatType} format The format of the serialized data. true means "portable". false means "croaring".
+   * @param {{ contiguous?: false } | undefined} options Options.
+   * @param {(error: Error | null, buffers: Buffer[] | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static serializeParallelAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    format: SerializationFormatType,
+    options: { contiguous?: false | undefined } | undefined,
+    callback: (error: Error | null, buffers: Buffer[] | undefined) => void,
+  ): void;
+
   /**
    *
    * Deserializes many bitmaps from an array of Uint8Array or an array of Buffer asynchronously in multiple parallel threads.
@@ -2199,6 +2497,25 @@ export class RoaringBitmap32 {
     format: FrozenViewFormatType,
   ): RoaringBitmap32;
 
+  /**
+   * Memory maps a file written with serializeFile in a frozen format and returns a frozen bitmap that reads directly from the mapping.
+   * Nothing is copied: loading is almost instant, and processes that map the same file share the same page cache memory.
+   *
+   * The file is unmapped when the bitmap is garbage collected, disposed or when releaseMappedFile() is called.
+   *
+   * This function is unsafe like unsafeFrozenView: the file must not be modified or truncated while it is mapped,
+   * or the application can crash. "unsafe_frozen_portable" checks that the structure matches the file size,
+   * but does not validate the content of the containers.
+   * new RoaringBitmap32(mapped, "readonly") returns the mapped bitmap itself, that is already readonly.
+   *
+   * @static
+   * @param {string} filePath The path of the file to map.
+   * @param {FrozenViewFormatType} [format="unsafe_frozen_croaring"] The format of the file.
+   * @returns {RoaringBitmap32} A new frozen RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32
+   */
+  static mapFile(filePath: string, format?: FrozenViewFormatType): RoaringBitmap32;
+
   /**
    * Swaps the content of two RoaringBitmap32 instances.
    *
@@ -2232,6 +2549,33 @@ export class RoaringBitmap32 {
    */
   static and(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): RoaringBitmap32;
 
+  /**
+   * Returns a new RoaringBitmap32 with the intersection (and) between the given two bitmaps, computed asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32, a AND b
+   * @memberof RoaringBitmap32
+   */
+  static andAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): Promise<RoaringBitmap32>;
+
+  /**
+   * Computes the intersection (and) between the given two bitmaps asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes, with a new RoaringBitmap32, a AND b
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static andAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32, callback: RoaringBitmap32Callback): void;
+
   /**
    * Returns a new RoaringBitmap32 with the union (or) of the two given bitmaps.
    *
@@ -2245,6 +2589,33 @@ export class RoaringBitmap32 {
    */
   static or(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): RoaringBitmap32;
 
+  /**
+   * Returns a new RoaringBitmap32 with the union (or) of the two given bitmaps, computed asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32, a OR b
+   * @memberof RoaringBitmap32
+   */
+  static orAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): Promise<RoaringBitmap32>;
+
+  /**
+   * Computes the union (or) of the two given bitmaps asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes, with a new RoaringBitmap32, a OR b
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static orAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32, callback: RoaringBitmap32Callback): void;
+
   /**
    * Returns a new RoaringBitmap32 with the symmetric union (xor) between the two given bitmaps.
    *
@@ -2258,6 +2629,33 @@ export class RoaringBitmap32 {
    */
   static xor(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): RoaringBitmap32;
 
+  /**
+   * Returns a new RoaringBitmap32 with the symmetric union (xor) between the two given bitmaps, computed asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32, a XOR b
+   * @memberof RoaringBitmap32
+   */
+  static xorAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): Promise<RoaringBitmap32>;
+
+  /**
+   * Computes the symmetric union (xor) between the two given bitmaps asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes, with a new RoaringBitmap32, a XOR b
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static xorAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32, callback: RoaringBitmap32Callback): void;
+
   /**
    * Returns a new RoaringBitmap32 with the difference (and not) between the two given bitmaps.
    *
@@ -2271,6 +2669,33 @@ export class RoaringBitmap32 {
    */
   static andNot(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): RoaringBitmap32;
 
+  /**
+   * Returns a new RoaringBitmap32 with the difference (and not) between the two given bitmaps, computed asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32, a AND NOT b
+   * @memberof RoaringBitmap32
+   */
+  static andNotAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32): Promise<RoaringBitmap32>;
+
+  /**
+   * Computes the difference (and not) between the two given bitmaps asynchronously in a worker thread.
+   *
+   * The provided bitmaps are not modified, they are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} a The first RoaringBitmap32 instance.
+   * @param {ReadonlyRoaringBitmap32} b The second RoaringBitmap32 instance.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes, with a new RoaringBitmap32, a AND NOT b
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static andNotAsync(a: ReadonlyRoaringBitmap32, b: ReadonlyRoaringBitmap32, callback: RoaringBitmap32Callback): void;
+
   /**
    * Performs a union between all the given array of RoaringBitmap32 instances.
    *
@@ -2295,6 +2720,45 @@ export class RoaringBitmap32 {
    */
   static orMany(...bitmaps: readonly ReadonlyRoaringBitmap32[]): RoaringBitmap32;
 
+  /**
+   * Performs a union between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to or together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static orManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
+  /**
+   * Performs a union between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to or together.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static orManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[], callback: RoaringBitmap32Callback): void;
+
+  /**
+   * Performs a union between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances to or together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static orManyAsync(...bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
   /**
    * Performs a xor between all the given array of RoaringBitmap32 instances.
    *
@@ -2319,6 +2783,433 @@ export class RoaringBitmap32 {
    */
   static xorMany(...bitmaps: readonly ReadonlyRoaringBitmap32[]): RoaringBitmap32;
 
+  /**
+   * Performs an intersection between all the given array of RoaringBitmap32 instances.
+   *
+   * This function is faster than calling and multiple times.
+   * Bitmaps are intersected from the smallest to the largest, and the operation stops as soon as the result is empty.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to and together.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 that contains the intersection of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static andMany(bitmaps: readonly ReadonlyRoaringBitmap32[]): RoaringBitmap32;
+
+  /**
+   * Performs an intersection between all the given RoaringBitmap32 instances.
+   *
+   * This function is faster than calling and multiple times.
+   * Bitmaps are intersected from the smallest to the largest, and the operation stops as soon as the result is empty.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances to and together.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 that contains the intersection of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static andMany(...bitmaps: readonly ReadonlyRoaringBitmap32[]): RoaringBitmap32;
+
+  /**
+   * Computes the number of values in the union of all the given RoaringBitmap32 instances, without creating the union.
+   *
+   * The containers of all the bitmaps are combined key by key and counted, no result container is allocated.
+   * This is faster than RoaringBitmap32.orMany(bitmaps).size.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @returns {number} The cardinality of the union of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static orManyCardinality(bitmaps: readonly ReadonlyRoaringBitmap32[]): number;
+
+  /**
+   * Computes the number of values in the union of all the given RoaringBitmap32 instances, without creating the union.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances.
+   * @returns {number} The cardinality of the union of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static orManyCardinality(...bitmaps: readonly ReadonlyRoaringBitmap32[]): number;
+
+  /**
+   * Computes the number of values in the intersection of all the given RoaringBitmap32 instances, without creating the intersection.
+   *
+   * Only the keys of the smallest bitmap are visited, the containers with the same key are intersected in a scratch buffer and counted.
+   * This is faster than RoaringBitmap32.andMany(bitmaps).size.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @returns {number} The cardinality of the intersection of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static andManyCardinality(bitmaps: readonly ReadonlyRoaringBitmap32[]): number;
+
+  /**
+   * Computes the number of values in the intersection of all the given RoaringBitmap32 instances, without creating the intersection.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances.
+   * @returns {number} The cardinality of the intersection of all the given bitmaps.
+   * @memberof RoaringBitmap32
+   */
+  static andManyCardinality(...bitmaps: readonly ReadonlyRoaringBitmap32[]): number;
+
+  /**
+   * Performs a xor between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to xor together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static xorManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
+  /**
+   * Performs a xor between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to xor together.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static xorManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[], callback: RoaringBitmap32Callback): void;
+
+  /**
+   * Performs a xor between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances to xor together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static xorManyAsync(...bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
+  /**
+   * Performs an intersection between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to and together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static andManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
+  /**
+   * Performs an intersection between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * The bitmaps are split in partitions that are reduced in parallel in multiple threads,
+   * the partial results are then merged together.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances to and together.
+   * @param {RoaringBitmap32Callback} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static andManyAsync(bitmaps: readonly ReadonlyRoaringBitmap32[], callback: RoaringBitmap32Callback): void;
+
+  /**
+   * Performs an intersection between all the given RoaringBitmap32 instances, asynchronously.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances to and together.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 that contains the result.
+   * @memberof RoaringBitmap32
+   */
+  static andManyAsync(...bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<RoaringBitmap32>;
+
+  /**
+   * Computes the number of values in the union of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * The key space is split in ranges that are counted in parallel in multiple threads.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @returns {Promise<number>} A promise that resolves to the cardinality of the union.
+   * @memberof RoaringBitmap32
+   */
+  static orManyCardinalityAsync(bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<number>;
+
+  /**
+   * Computes the number of values in the union of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @param {(error: Error | null, cardinality: number | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static orManyCardinalityAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    callback: (error: Error | null, cardinality: number | undefined) => void,
+  ): void;
+
+  /**
+   * Computes the number of values in the union of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances.
+   * @returns {Promise<number>} A promise that resolves to the cardinality of the union.
+   * @memberof RoaringBitmap32
+   */
+  static orManyCardinalityAsync(...bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<number>;
+
+  /**
+   * Computes the number of values in the intersection of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * The key space is split in ranges that are counted in parallel in multiple threads.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @returns {Promise<number>} A promise that resolves to the cardinality of the intersection.
+   * @memberof RoaringBitmap32
+   */
+  static andManyCardinalityAsync(bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<number>;
+
+  /**
+   * Computes the number of values in the intersection of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps An array of RoaringBitmap32 instances.
+   * @param {(error: Error | null, cardinality: number | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static andManyCardinalityAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    callback: (error: Error | null, cardinality: number | undefined) => void,
+  ): void;
+
+  /**
+   * Computes the number of values in the intersection of all the given RoaringBitmap32 instances asynchronously, without creating it.
+   *
+   * @static
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The RoaringBitmap32 instances.
+   * @returns {Promise<number>} A promise that resolves to the cardinality of the intersection.
+   * @memberof RoaringBitmap32
+   */
+  static andManyCardinalityAsync(...bitmaps: readonly ReadonlyRoaringBitmap32[]): Promise<number>;
+
+  /**
+   * Computes a metric between all the pairs of the given bitmaps.
+   *
+   * The result is the upper triangle of the matrix without the diagonal, row by row:
+   * the pair (i, j) with i < j is at the index i * (2 * n - i - 1) / 2 + (j - i - 1).
+   * With the option full, the result is the symmetric n x n matrix, the pair (i, j) is at the index i * n + j.
+   *
+   * The metric can be:
+   *  - "intersection": the number of values in common, in a Uint32Array.
+   *  - "jaccard": the Jaccard index, in a Float64Array. NaN if both bitmaps are empty.
+   *  - "cosine": the cosine similarity, intersection / sqrt(size(a) * size(b)), in a Float64Array. NaN if a bitmap is empty.
+   *
+   * The pair space is computed in tiles of bitmaps, so the bitmaps of a tile stay in the CPU cache.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to compare.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @param {RoaringBitmap32PairwiseOptions} [options] Options.
+   * @returns {Uint32Array | Float64Array} The matrix.
+   * @memberof RoaringBitmap32
+   */
+  static pairwise(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: "intersection",
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Uint32Array;
+
+  static pairwise(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: "jaccard" | "cosine",
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Float64Array;
+
+  static pairwise(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: RoaringBitmap32PairwiseMetric,
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Uint32Array | Float64Array;
+
+  /**
+   * Computes a metric between all the pairs of the given bitmaps, asynchronously, in multiple parallel threads.
+   * See RoaringBitmap32.pairwise for the layout of the result.
+   *
+   * The tiles of the pair space are computed in parallel.
+   * The given bitmaps are frozen while the operation is running.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to compare.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @param {RoaringBitmap32PairwiseOptions} [options] Options.
+   * @returns {Promise<Uint32Array | Float64Array>} A promise that resolves to the matrix.
+   * @memberof RoaringBitmap32
+   */
+  static pairwiseAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: "intersection",
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Promise<Uint32Array>;
+
+  static pairwiseAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: "jaccard" | "cosine",
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Promise<Float64Array>;
+
+  static pairwiseAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: RoaringBitmap32PairwiseMetric,
+    options?: RoaringBitmap32PairwiseOptions | undefined,
+  ): Promise<Uint32Array | Float64Array>;
+
+  /**
+   * Computes a metric between all the pairs of the given bitmaps, asynchronously, in multiple parallel threads.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to compare.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @param {RoaringBitmap32PairwiseOptions | undefined} options Options.
+   * @param {(error: Error | null, matrix: Uint32Array | Float64Array | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static pairwiseAsync(
+    bitmaps: readonly ReadonlyRoaringBitmap32[],
+    metric: RoaringBitmap32PairwiseMetric,
+    options: RoaringBitmap32PairwiseOptions | undefined,
+    callback: (error: Error | null, matrix: Uint32Array | Float64Array | undefined) => void,
+  ): void;
+
+  /**
+   * Finds the k candidates most similar to the query bitmap, using the given metric (see RoaringBitmap32.pairwise).
+   *
+   * Results are sorted by score, highest first, ties are sorted by candidate index.
+   * Candidates with an undefined score (NaN, for example when both bitmaps are empty) are never returned.
+   *
+   * Candidates are visited from the highest upper bound of their score, computed from the sizes and the
+   * [minimum, maximum] range of the bitmaps, and the search stops when no remaining candidate can enter the top k.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} query The bitmap to compare.
+   * @param {ReadonlyRoaringBitmap32[]} candidates The candidate bitmaps.
+   * @param {number} k The maximum number of results.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @returns {RoaringBitmap32TopKResult} The indices of the best candidates and their scores.
+   * @memberof RoaringBitmap32
+   */
+  static topK(
+    query: ReadonlyRoaringBitmap32,
+    candidates: readonly ReadonlyRoaringBitmap32[],
+    k: number,
+    metric: RoaringBitmap32PairwiseMetric,
+  ): RoaringBitmap32TopKResult;
+
+  /**
+   * Finds the k candidates most similar to the query bitmap, asynchronously, in multiple parallel threads.
+   * The query and the candidates are frozen until the operation completes.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} query The bitmap to compare.
+   * @param {ReadonlyRoaringBitmap32[]} candidates The candidate bitmaps.
+   * @param {number} k The maximum number of results.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @returns {Promise<RoaringBitmap32TopKResult>} A promise that resolves to the indices of the best candidates and their scores.
+   * @memberof RoaringBitmap32
+   */
+  static topKAsync(
+    query: ReadonlyRoaringBitmap32,
+    candidates: readonly ReadonlyRoaringBitmap32[],
+    k: number,
+    metric: RoaringBitmap32PairwiseMetric,
+  ): Promise<RoaringBitmap32TopKResult>;
+
+  /**
+   * Finds the k candidates most similar to the query bitmap, asynchronously, in multiple parallel threads.
+   *
+   * @static
+   * @param {ReadonlyRoaringBitmap32} query The bitmap to compare.
+   * @param {ReadonlyRoaringBitmap32[]} candidates The candidate bitmaps.
+   * @param {number} k The maximum number of results.
+   * @param {RoaringBitmap32PairwiseMetric} metric The metric to compute.
+   * @param {(error: Error | null, result: RoaringBitmap32TopKResult | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static topKAsync(
+    query: ReadonlyRoaringBitmap32,
+    candidates: readonly ReadonlyRoaringBitmap32[],
+    k: number,
+    metric: RoaringBitmap32PairwiseMetric,
+    callback: (error: Error | null, result: RoaringBitmap32TopKResult | undefined) => void,
+  ): void;
+
+  /**
+   * Evaluates a boolean expression over many bitmaps in a single native call, creating only the resulting bitmap.
+   *
+   * An expression is a RoaringBitmap32 or an array [operation, ...operands], where each operand is an expression.
+   * The operations are:
+   *  - "or": the union of all the operands.
+   *  - "and": the intersection of all the operands.
+   *  - "andNot": the first operand minus all the other operands.
+   *  - "xor": the symmetric difference of all the operands.
+   * An operation without operands is the empty set.
+   *
+   * Intersections are computed from the smallest operand and stop as soon as the result is empty,
+   * operands that cannot change the result are not evaluated.
+   *
+   * @example
+   * // (A ∪ B ∪ C) ∩ D ∖ (E ∪ F)
+   * RoaringBitmap32.evaluate(["andNot", ["and", ["or", a, b, c], d], ["or", e, f]]);
+   *
+   * @static
+   * @param {RoaringBitmap32Expression} expression The expression to evaluate.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the result.
+   * @memberof RoaringBitmap32
+   */
+  static evaluate(expression: RoaringBitmap32Expression): RoaringBitmap32;
+
+  /**
+   * Evaluates a boolean expression over many bitmaps asynchronously, in a worker thread.
+   * The bitmaps in the expression are frozen until the operation completes.
+   * See RoaringBitmap32.evaluate for the format of the expression.
+   *
+   * @static
+   * @param {RoaringBitmap32Expression} expression The expression to evaluate.
+   * @returns {Promise<RoaringBitmap32>} A promise that resolves to a new RoaringBitmap32 with the result.
+   * @memberof RoaringBitmap32
+   */
+  static evaluateAsync(expression: RoaringBitmap32Expression): Promise<RoaringBitmap32>;
+
+  /**
+   * Evaluates a boolean expression over many bitmaps asynchronously, in a worker thread.
+   *
+   * @static
+   * @param {RoaringBitmap32Expression} expression The expression to evaluate.
+   * @param {(error: Error | null, bitmap: RoaringBitmap32 | undefined) => void} callback The callback to execute when the operation completes.
+   * @returns {void}
+   * @memberof RoaringBitmap32
+   */
+  static evaluateAsync(
+    expression: RoaringBitmap32Expression,
+    callback: (error: Error | null, bitmap: RoaringBitmap32 | undefined) => void,
+  ): void;
+
   /**
    * @returns a new RoaringBitmap32 containing all the elements in this Set and also all the elements in the argument.
    */
@@ -2385,6 +3276,52 @@ export class RoaringBitmap32 {
   isDisjointFrom(other: ReadonlySetLike<unknown> | ReadonlyRoaringBitmap32): boolean;
 }
 
+/** The metrics supported by RoaringBitmap32.pairwise. */
+export type RoaringBitmap32PairwiseMetric = "intersection" | "jaccard" | "cosine";
+
+/** Options for RoaringBitmap32.pairwise. */
+export interface RoaringBitmap32PairwiseOptions {
+  /** If true, the result is the full symmetric n x n matrix, with the diagonal. Default is false, only the upper triangle. */
+  full?: boolean | undefined;
+}
+
+/** A boolean expression over bitmaps, evaluated by RoaringBitmap32.evaluate. */
+export type RoaringBitmap32Expression =
+  | ReadonlyRoaringBitmap32
+  | readonly ["or" | "and" | "andNot" | "xor", ...RoaringBitmap32Expression[]];
+
+/** The result of RoaringBitmap32.topK. */
+export interface RoaringBitmap32TopKResult {
+  /** The indices of the best candidates, best first. */
+  indices: Uint32Array;
+  /** The scores of the best candidates, in the same order of indices. */
+  scores: Float64Array;
+}
+
+/** Many bitmaps serialized in a single buffer by RoaringBitmap32.serializeParallelAsync. */
+export interface RoaringBitmap32SerializedContiguous {
+  /** The buffer that contains all the serialized bitmaps. */
+  buffer: Buffer;
+
+  /** The offset in the buffer of each serialized bitmap. */
+  offsets: Float64Array;
+
+  /** The length in bytes of each serialized bitmap. */
+  lengths: Float64Array;
+}
+
+/**
+ * Options to iterate only a range of a RoaringBitmap32, for example to paginate with a cursor.
+ * Both values are in the iteration direction: for a reverse iterator, from is the highest value and to the lowest.
+ */
+export interface RoaringBitmap32IteratorOptions {
+  /** The first value to return, inclusive. The iteration starts at the first value of the set at or after it. */
+  from?: number | undefined;
+
+  /** The exclusive bound where the iteration stops. */
+  to?: number | undefined;
+}
+
 /**
  * Iterator for RoaringBitmap32.
  *
@@ -2429,6 +3366,20 @@ export class RoaringBitmap32Iterator implements IterableIterator<number> {
    */
   constructor(roaringBitmap32: ReadonlyRoaringBitmap32, buffer: Uint32Array);
 
+  /**
+   * Creates a new iterator able to iterate a range of a RoaringBitmap32.
+   *
+   * @param {ReadonlyRoaringBitmap32} roaringBitmap32 The roaring bitmap to iterate
+   * @param {number | Uint32Array | undefined} buffer Buffer size or reusable temporary buffer, undefined for the default.
+   * @param {RoaringBitmap32IteratorOptions} options Start value and exclusive end bound.
+   * @memberof RoaringBitmap32Iterator
+   */
+  constructor(
+    roaringBitmap32: ReadonlyRoaringBitmap32,
+    buffer: number | Uint32Array | undefined,
+    options: RoaringBitmap32IteratorOptions,
+  );
+
   /**
    * Returns this.
    *
@@ -2447,6 +3398,17 @@ export class RoaringBitmap32Iterator implements IterableIterator<number> {
    */
   next(): IteratorResult<number>;
 
+  /**
+   * Moves the iterator to the first value at or after the given value, up to the end bound.
+   * It costs a binary search, so cursor based pagination does not depend on the offset of the page.
+   * It can be called also after the iterator was exhausted, but not after return or dispose.
+   *
+   * @param {number} value The value to move to.
+   * @returns {this} The same instance.
+   * @memberof RoaringBitmap32Iterator
+   */
+  seek(value: number): this;
+
   /**
    * Stops the iteration early and releases the underlying buffer.
    */
@@ -2505,6 +3467,20 @@ export class RoaringBitmap32ReverseIterator implements IterableIterator<number>
    */
   constructor(roaringBitmap32: ReadonlyRoaringBitmap32, buffer: Uint32Array);
 
+  /**
+   * Creates a new iterator able to iterate a range of a RoaringBitmap32.
+   *
+   * @param {ReadonlyRoaringBitmap32} roaringBitmap32 The roaring bitmap to iterate
+   * @param {number | Uint32Array | undefined} buffer Buffer size or reusable temporary buffer, undefined for the default.
+   * @param {RoaringBitmap32IteratorOptions} options Start value and exclusive end bound.
+   * @memberof RoaringBitmap32ReverseIterator
+   */
+  constructor(
+    roaringBitmap32: ReadonlyRoaringBitmap32,
+    buffer: number | Uint32Array | undefined,
+    options: RoaringBitmap32IteratorOptions,
+  );
+
   /**
    * Returns this.
    *
@@ -2523,6 +3499,17 @@ export class RoaringBitmap32ReverseIterator implements IterableIterator<number>
    */
   next(): IteratorResult<number>;
 
+  /**
+   * Moves the iterator to the first value at or before the given value, down to the end bound.
+   * It costs a binary search, so cursor based pagination does not depend on the offset of the page.
+   * It can be called also after the iterator was exhausted, but not after return or dispose.
+   *
+   * @param {number} value The value to move to.
+   * @returns {this} The same instance.
+   * @memberof RoaringBitmap32ReverseIterator
+   */
+  seek(value: number): this;
+
   /**
    * Stops the iteration early and releases the underlying buffer.
    */
@@ -2539,6 +3526,1072 @@ export class RoaringBitmap32ReverseIterator implements IterableIterator<number>
   [Symbol.dispose](): IteratorResult<number>;
 }
 
+/**
+ * A value accepted by RoaringBitmap64: a bigint or a non negative safe integer number.
+ */
+export type RoaringBitmap64Value = bigint | number;
+
+/**
+ * Roaring bitmap that supports 64 bit unsigned integers.
+ *
+ * Values are partitioned by their high 32 bits, each partition is a 32 bit roaring bitmap.
+ * The portable serialization format is compatible with CRoaring roaring64 and with the Java and Go implementations.
+ *
+ * Values are returned as bigint. Inputs can be bigint, non negative safe integer numbers or a BigUint64Array.
+ *
+ * See http://roaringbitmap.org/
+ *
+ * @export
+ * @class RoaringBitmap64
+ */
+export class RoaringBitmap64 implements Iterable<bigint> {
+  // Allows: import RoaringBitmap64 from 'roaring/RoaringBitmap64'
+  static readonly default: typeof RoaringBitmap64;
+
+  static readonly RoaringBitmap64Iterator: typeof RoaringBitmap64Iterator;
+
+  static readonly RoaringBitmap64ReverseIterator: typeof RoaringBitmap64ReverseIterator;
+
+  /** Gets the approximate memory allocated by the roaring bitmap library. */
+  static getRoaringUsedMemory(): number;
+
+  /** Gets the total number of RoaringBitmap64 instances allocated. */
+  static getInstancesCount(): number;
+
+  /**
+   * Creates a new empty or pre-populated RoaringBitmap64.
+   *
+   * @param {Iterable<bigint | number> | BigUint64Array | RoaringBitmap64 | RoaringBitmap32} [values] The values to add.
+   * A number argument is accepted for symmetry with RoaringBitmap32 and creates an empty bitmap.
+   * A BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   * @memberof RoaringBitmap64
+   */
+  constructor(values?: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64 | RoaringBitmap32 | number);
+
+  /**
+   * Creates a new RoaringBitmap64 instance from the given values.
+   *
+   * @param {Iterable<bigint | number> | BigUint64Array} values The values to add.
+   * @returns {RoaringBitmap64} A new bitmap.
+   * @memberof RoaringBitmap64
+   */
+  static from(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): RoaringBitmap64;
+
+  /**
+   * Creates a new RoaringBitmap64 instance from the given arguments. Invalid values are ignored,
+   * a BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   *
+   * @param {...(bigint | number)[]} values The values to add.
+   * @returns {RoaringBitmap64} A new bitmap.
+   * @memberof RoaringBitmap64
+   */
+  static of(...values: RoaringBitmap64Value[]): RoaringBitmap64;
+
+  /**
+   * Deserializes a bitmap serialized with the portable 64 bit format.
+   *
+   * @param {Uint8Array | ArrayBuffer} serialized The buffer to deserialize.
+   * @param {"portable" | true} format The format, only the portable format is supported.
+   * @returns {RoaringBitmap64} A new bitmap.
+   * @memberof RoaringBitmap64
+   */
+  static deserialize(serialized: Uint8Array | ArrayBuffer | SharedArrayBuffer, format: "portable" | true): RoaringBitmap64;
+
+  /**
+   * Creates a frozen, readonly view over a buffer serialized with the portable 64 bit format, without copying it.
+   *
+   * WARNING: the buffer must not be modified while the view is in use.
+   *
+   * @param {Uint8Array | ArrayBuffer} storage The buffer.
+   * @param {"unsafe_frozen_portable"} format The format, only unsafe_frozen_portable is supported.
+   * @returns {RoaringBitmap64} A new frozen bitmap.
+   * @memberof RoaringBitmap64
+   */
+  static unsafeFrozenView(
+    storage: Uint8Array | ArrayBuffer | SharedArrayBuffer,
+    format: "unsafe_frozen_portable" | FrozenViewFormat.unsafe_frozen_portable,
+  ): RoaringBitmap64;
+
+  /**
+   * Intersects two bitmaps, returning a new bitmap.
+   *
+   * @static
+   * @param {RoaringBitmap64} a The first bitmap.
+   * @param {RoaringBitmap64} b The second bitmap.
+   * @returns {RoaringBitmap64} A new bitmap, a AND b.
+   * @memberof RoaringBitmap64
+   */
+  static and(a: RoaringBitmap64, b: RoaringBitmap64): RoaringBitmap64;
+
+  /**
+   * Union of two bitmaps, returning a new bitmap.
+   *
+   * @static
+   * @param {RoaringBitmap64} a The first bitmap.
+   * @param {RoaringBitmap64} b The second bitmap.
+   * @returns {RoaringBitmap64} A new bitmap, a OR b.
+   * @memberof RoaringBitmap64
+   */
+  static or(a: RoaringBitmap64, b: RoaringBitmap64): RoaringBitmap64;
+
+  /**
+   * Symmetric difference of two bitmaps, returning a new bitmap.
+   *
+   * @static
+   * @param {RoaringBitmap64} a The first bitmap.
+   * @param {RoaringBitmap64} b The second bitmap.
+   * @returns {RoaringBitmap64} A new bitmap, a XOR b.
+   * @memberof RoaringBitmap64
+   */
+  static xor(a: RoaringBitmap64, b: RoaringBitmap64): RoaringBitmap64;
+
+  /**
+   * Difference of two bitmaps, returning a new bitmap.
+   *
+   * @static
+   * @param {RoaringBitmap64} a The first bitmap.
+   * @param {RoaringBitmap64} b The second bitmap.
+   * @returns {RoaringBitmap64} A new bitmap, a AND NOT b.
+   * @memberof RoaringBitmap64
+   */
+  static andNot(a: RoaringBitmap64, b: RoaringBitmap64): RoaringBitmap64;
+
+  /**
+   * Property. Gets the number of items in the set (cardinality).
+   *
+   * @type {number}
+   * @memberof RoaringBitmap64
+   */
+  get size(): number;
+
+  /**
+   * Property. True if the bitmap is empty.
+   *
+   * @type {boolean}
+   * @memberof RoaringBitmap64
+   */
+  get isEmpty(): boolean;
+
+  /**
+   * Property. True if the bitmap is read-only, because it was frozen or it is a frozen view.
+   *
+   * @type {boolean}
+   * @memberof RoaringBitmap64
+   */
+  get isFrozen(): boolean;
+
+  /**
+   * [Symbol.iterator]() Gets a new iterator able to iterate all values in the set in ascending order.
+   *
+   * WARNING: Is not allowed to change the bitmap while iterating.
+   *
+   * @returns {RoaringBitmap64Iterator} A new iterator
+   * @memberof RoaringBitmap64
+   */
+  [Symbol.iterator](): RoaringBitmap64Iterator;
+
+  /** Same as [Symbol.iterator]() */
+  iterator(): RoaringBitmap64Iterator;
+
+  /** Gets a new iterator able to iterate all values in the set in descending order. */
+  reverseIterator(): RoaringBitmap64ReverseIterator;
+
+  /** Same as [Symbol.iterator]() */
+  keys(): RoaringBitmap64Iterator;
+
+  /** Same as [Symbol.iterator]() */
+  values(): RoaringBitmap64Iterator;
+
+  /** Returns an iterator of [value, value] pairs, like Set.entries() */
+  entries(): IterableIterator<[bigint, bigint]>;
+
+  /**
+   * Executes a function for each value in the set, in ascending order.
+   *
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  forEach<This = unknown>(callbackfn: (this: This, value: bigint, index: number, set: this) => void, thisArg?: This): this;
+
+  /** Clears the bitmap, so it can be used with the Symbol.dispose protocol. */
+  dispose(): void;
+
+  /**
+   * Checks whether the given value exists in the set.
+   *
+   * @param {bigint | number} value The value to look for.
+   * @returns {boolean} True if the value exists, false if not or if the value is not a valid uint64.
+   * @memberof RoaringBitmap64
+   */
+  has(value: unknown): boolean;
+
+  /** Same as has(value) */
+  includes(value: unknown): boolean;
+
+  /**
+   * Adds values to the set. Invalid values are ignored,
+   * a BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   *
+   * @param {...(bigint | number)[]} values The values to add.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  add(...values: RoaringBitmap64Value[]): this;
+
+  /**
+   * Adds values to the set. Invalid values are ignored,
+   * a BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   *
+   * @param {...(bigint | number)[]} values The values to add.
+   * @returns {boolean} True if the set changed, false if all the values were already in the set.
+   * @memberof RoaringBitmap64
+   */
+  tryAdd(...values: RoaringBitmap64Value[]): boolean;
+
+  /**
+   * Adds many values. BigUint64Array is the fastest input.
+   * A Uint32Array or a RoaringBitmap32 are added to the lower 2^32 range.
+   * A BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   *
+   * @param {Iterable<bigint | number> | BigUint64Array | RoaringBitmap64 | RoaringBitmap32} values The values to add.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  addMany(values: Iterable<RoaringBitmap64Value> | BigUint64Array | Uint32Array | RoaringBitmap64 | RoaringBitmap32): this;
+
+  /**
+   * Removes values from the set.
+   *
+   * @param {...(bigint | number)[]} values The values to remove.
+   * @returns {boolean} True if the set changed.
+   * @memberof RoaringBitmap64
+   */
+  remove(...values: RoaringBitmap64Value[]): boolean;
+
+  /** Same as remove(...values) */
+  delete(...values: RoaringBitmap64Value[]): boolean;
+
+  /**
+   * Removes many values from the set.
+   * A BigInt outside the 64 bit unsigned integer range throws a RangeError.
+   *
+   * @param {Iterable<bigint | number> | BigUint64Array | RoaringBitmap64} values The values to remove.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  removeMany(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): this;
+
+  /**
+   * Removes all values.
+   *
+   * @returns {boolean} True if something was removed, false if the bitmap was already empty.
+   * @memberof RoaringBitmap64
+   */
+  clear(): boolean;
+
+  /**
+   * Adds all the values in the interval [rangeStart, rangeEnd).
+   * rangeEnd can be up to 2n ** 64n, but the range can touch at most 65536 blocks of 2n ** 32n values
+   * (one bitmap is allocated per block), an error is thrown otherwise.
+   *
+   * @param {bigint | number | undefined} rangeStart The start of the range, inclusive. Default 0.
+   * @param {bigint | number | undefined} [rangeEnd] The end of the range, exclusive. Default 2n ** 64n.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  addRange(rangeStart: RoaringBitmap64Value | undefined, rangeEnd?: RoaringBitmap64Value | undefined): this;
+
+  /**
+   * Removes all the values in the interval [rangeStart, rangeEnd).
+   *
+   * @param {bigint | number | undefined} rangeStart The start of the range, inclusive. Default 0.
+   * @param {bigint | number | undefined} [rangeEnd] The end of the range, exclusive. Default 2n ** 64n.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  removeRange(rangeStart: RoaringBitmap64Value | undefined, rangeEnd?: RoaringBitmap64Value | undefined): this;
+
+  /**
+   * Negates in place all the values in the interval [rangeStart, rangeEnd).
+   * The range can touch at most 65536 blocks of 2n ** 32n values, an error is thrown otherwise.
+   *
+   * @param {bigint | number | undefined} rangeStart The start of the range, inclusive. Default 0.
+   * @param {bigint | number | undefined} [rangeEnd] The end of the range, exclusive. Default 2n ** 64n.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  flipRange(rangeStart: RoaringBitmap64Value | undefined, rangeEnd?: RoaringBitmap64Value | undefined): this;
+
+  /**
+   * Checks whether the set contains all the values in the interval [rangeStart, rangeEnd).
+   *
+   * @returns {boolean} True if all the values in the range are in the set.
+   * @memberof RoaringBitmap64
+   */
+  hasRange(rangeStart: RoaringBitmap64Value | undefined, rangeEnd?: RoaringBitmap64Value | undefined): boolean;
+
+  /**
+   * Counts the values in the interval [rangeStart, rangeEnd).
+   *
+   * @returns {number} The number of values in the range.
+   * @memberof RoaringBitmap64
+   */
+  rangeCardinality(rangeStart: RoaringBitmap64Value | undefined, rangeEnd?: RoaringBitmap64Value | undefined): number;
+
+  /**
+   * Gets the smallest value in the set.
+   *
+   * @returns {bigint | undefined} The smallest value, or undefined if the set is empty.
+   * @memberof RoaringBitmap64
+   */
+  minimum(): bigint | undefined;
+
+  /**
+   * Gets the largest value in the set.
+   *
+   * @returns {bigint | undefined} The largest value, or undefined if the set is empty.
+   * @memberof RoaringBitmap64
+   */
+  maximum(): bigint | undefined;
+
+  /**
+   * Returns the number of values in the set that are smaller or equal to the given value.
+   *
+   * @param {bigint | number} maxValue The maximum value.
+   * @returns {number} The number of values smaller or equal to maxValue.
+   * @memberof RoaringBitmap64
+   */
+  rank(maxValue: RoaringBitmap64Value): number;
+
+  /**
+   * Returns the value at the given position, in ascending order.
+   *
+   * @param {bigint | number} rank The position.
+   * @returns {bigint | undefined} The value at the given position, or undefined if out of bounds.
+   * @memberof RoaringBitmap64
+   */
+  select(rank: RoaringBitmap64Value): bigint | undefined;
+
+  /** Computes the size of the intersection between two bitmaps. */
+  andCardinality(other: RoaringBitmap64): number;
+
+  /** Computes the size of the union between two bitmaps. */
+  orCardinality(other: RoaringBitmap64): number;
+
+  /** Computes the size of the difference between this and another bitmap. */
+  andNotCardinality(other: RoaringBitmap64): number;
+
+  /** Computes the size of the symmetric difference between two bitmaps. */
+  xorCardinality(other: RoaringBitmap64): number;
+
+  /** Checks whether the two bitmaps have at least one value in common. */
+  intersects(other: RoaringBitmap64): boolean;
+
+  /** Checks whether this bitmap is a subset of the other bitmap. */
+  isSubset(other: RoaringBitmap64): boolean;
+
+  /** Checks whether this bitmap is a superset of the other bitmap. */
+  isSuperset(other: RoaringBitmap64): boolean;
+
+  /** Checks whether the two bitmaps contain the same values. */
+  isEqual(other: RoaringBitmap64): boolean;
+
+  /** Intersects this bitmap with the given values, in place. */
+  andInPlace(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): this;
+
+  /** Adds the given values to this bitmap, in place. */
+  orInPlace(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): this;
+
+  /** Removes the given values from this bitmap, in place. */
+  andNotInPlace(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): this;
+
+  /** Computes the symmetric difference with the given values, in place. */
+  xorInPlace(values: Iterable<RoaringBitmap64Value> | BigUint64Array | RoaringBitmap64): this;
+
+  /**
+   * Optimizes the bitmap by using run containers where they are smaller.
+   *
+   * @returns {boolean} True if the bitmap changed.
+   * @memberof RoaringBitmap64
+   */
+  runOptimize(): boolean;
+
+  /**
+   * Reallocates the memory to the minimum required.
+   *
+   * @returns {number} The number of bytes saved.
+   * @memberof RoaringBitmap64
+   */
+  shrinkToFit(): number;
+
+  /**
+   * Makes this bitmap readonly. Any further attempt to modify it will throw.
+   *
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap64
+   */
+  freeze(): this;
+
+  /** Creates a new, mutable copy of this bitmap. */
+  clone(): RoaringBitmap64;
+
+  /**
+   * Gets all the values in a new BigUint64Array, in ascending order.
+   *
+   * @returns {BigUint64Array} A new BigUint64Array.
+   * @memberof RoaringBitmap64
+   */
+  toBigUint64Array(): BigUint64Array;
+
+  /**
+   * Gets all the values in a new array of bigint, in ascending order.
+   *
+   * @param {number} [maxLength] The maximum number of values to return.
+   * @returns {bigint[]} A new array.
+   * @memberof RoaringBitmap64
+   */
+  toArray(maxLength?: number | undefined): bigint[];
+
+  /**
+   * How many bytes are required to serialize this bitmap.
+   *
+   * @param {"portable" | true} format The format, only the portable format is supported.
+   * @returns {number} The number of bytes.
+   * @memberof RoaringBitmap64
+   */
+  getSerializationSizeInBytes(format: "portable" | true): number;
+
+  /**
+   * Serializes the bitmap with the portable 64 bit format.
+   *
+   * @param {"portable" | true} format The format, only the portable format is supported.
+   * @param {Uint8Array | ArrayBuffer} [output] Optional output buffer, must be big enough.
+   * @returns {Buffer} The serialized bitmap.
+   * @memberof RoaringBitmap64
+   */
+  serialize(format: "portable" | true, output?: Uint8Array | ArrayBuffer | SharedArrayBuffer): Buffer;
+
+  /** Returns "RoaringBitmap64" */
+  toString(): string;
+
+  /** Resource-management hook so RoaringBitmap64 participates in the Symbol.dispose protocol. */
+  [Symbol.dispose](): void;
+}
+
+/**
+ * Iterator for RoaringBitmap64.
+ *
+ * WARNING: Is not allowed to change the bitmap while iterating.
+ * The iterator may throw exception if the bitmap is changed during the iteration.
+ *
+ * @export
+ * @class RoaringBitmap64Iterator
+ * @implements {IterableIterator<bigint>}
+ */
+export class RoaringBitmap64Iterator implements IterableIterator<bigint> {
+  /**
+   * Creates a new iterator able to iterate a RoaringBitmap64.
+   *
+   * @param {RoaringBitmap64} [roaringBitmap64] The roaring bitmap to iterate. If null or undefined, an empty iterator is created.
+   * @param {number | BigUint64Array} [buffer] The size of the temporary buffer, or a reusable BigUint64Array buffer.
+   * @memberof RoaringBitmap64Iterator
+   */
+  constructor(roaringBitmap64?: RoaringBitmap64, buffer?: number | BigUint64Array);
+
+  [Symbol.iterator](): this;
+
+  /**
+   * Returns the next element in the iterator.
+   *
+   * For performance reasons, this function returns always the same instance.
+   *
+   * @returns {IteratorResult<bigint>} The next result.
+   * @memberof RoaringBitmap64Iterator
+   */
+  next(): IteratorResult<bigint>;
+
+  /**
+   * Stops the iteration early and releases the underlying buffer.
+   */
+  return(value?: bigint): IteratorResult<bigint>;
+
+  /**
+   * Disposes this iterator so it can be used with the Symbol.dispose protocol.
+   */
+  dispose(value?: bigint): IteratorResult<bigint>;
+
+  [Symbol.dispose](): IteratorResult<bigint>;
+}
+
+/**
+ * Reverse iterator for RoaringBitmap64, iterates the values in descending order.
+ *
+ * @export
+ * @class RoaringBitmap64ReverseIterator
+ * @implements {IterableIterator<bigint>}
+ */
+export class RoaringBitmap64ReverseIterator extends RoaringBitmap64Iterator {}
+
+/**
+ * Streaming union of many bitmaps, for merging results as they arrive (for example, responses of many shards).
+ *
+ * Calling orInPlace repeatedly computes exact cardinalities and converts containers after every call.
+ * The accumulator merges the inputs with lazy unions instead, and repairs the result only once, in finish.
+ * The inputs are not modified and can be reused or released after they are merged.
+ *
+ * @export
+ * @class RoaringBitmap32Accumulator
+ */
+export class RoaringBitmap32Accumulator {
+  /**
+   * Creates a new empty accumulator.
+   *
+   * @memberof RoaringBitmap32Accumulator
+   */
+  constructor();
+
+  /**
+   * The number of bitmaps merged since the accumulator was created, finished or cleared.
+   *
+   * @type {number}
+   * @memberof RoaringBitmap32Accumulator
+   */
+  readonly count: number;
+
+  /**
+   * Merges a bitmap into the union.
+   *
+   * @param {ReadonlyRoaringBitmap32} bitmap The bitmap to merge.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap32Accumulator
+   */
+  or(bitmap: ReadonlyRoaringBitmap32): this;
+
+  /**
+   * Merges many bitmaps into the union.
+   *
+   * @param {readonly ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to merge.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap32Accumulator
+   */
+  orMany(bitmaps: readonly ReadonlyRoaringBitmap32[]): this;
+
+  /**
+   * Merges many bitmaps into the union.
+   *
+   * @param {...ReadonlyRoaringBitmap32[]} bitmaps The bitmaps to merge.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap32Accumulator
+   */
+  orMany(...bitmaps: readonly ReadonlyRoaringBitmap32[]): this;
+
+  /**
+   * Returns the union of all the merged bitmaps as a new RoaringBitmap32, and resets the accumulator to empty.
+   *
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32Accumulator
+   */
+  finish(): RoaringBitmap32;
+
+  /**
+   * Discards the accumulated union.
+   *
+   * @memberof RoaringBitmap32Accumulator
+   */
+  clear(): void;
+}
+
+/**
+ * Adds values to a RoaringBitmap32 in batches, for hot paths that would call add once per value.
+ *
+ * The caller writes values in the buffer and calls flush(n) to add the first n of them to the bitmap,
+ * with a single native call. The same buffer is reused for every batch.
+ * Consecutive values in the same 64K chunk are cheap to add, and the position in the bitmap is remembered
+ * across flushes, as long as the bitmap is not modified in other ways.
+ *
+ * @example
+ * const writer = new RoaringBitmap32BulkWriter(bitmap);
+ * const buffer = writer.buffer;
+ * let n = 0;
+ * for (const id of ids) {
+ *   buffer[n++] = id;
+ *   if (n === buffer.length) {
+ *     writer.flush(n);
+ *     n = 0;
+ *   }
+ * }
+ * writer.flush(n);
+ *
+ * @export
+ * @class RoaringBitmap32BulkWriter
+ */
+export class RoaringBitmap32BulkWriter {
+  /**
+   * Creates a writer for a bitmap.
+   *
+   * @param {RoaringBitmap32} bitmap The bitmap to write to. It is kept alive by the writer.
+   * @param {number | Uint32Array} [buffer=4096] The buffer to use, or the length of a new 32 bytes aligned buffer.
+   * @memberof RoaringBitmap32BulkWriter
+   */
+  constructor(bitmap: RoaringBitmap32, buffer?: number | Uint32Array);
+
+  /**
+   * The bitmap the values are added to.
+   *
+   * @type {RoaringBitmap32}
+   * @memberof RoaringBitmap32BulkWriter
+   */
+  readonly bitmap: RoaringBitmap32;
+
+  /**
+   * The buffer to fill with the values to add.
+   *
+   * @type {Uint32Array}
+   * @memberof RoaringBitmap32BulkWriter
+   */
+  readonly buffer: Uint32Array;
+
+  /**
+   * Adds the first count values of the buffer to the bitmap.
+   * Throws if the bitmap is frozen.
+   *
+   * @param {number} [count=buffer.length] The number of values to add, from the start of the buffer.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmap32BulkWriter
+   */
+  flush(count?: number): this;
+}
+
+/**
+ * A bitmap pack file written with RoaringBitmap32.serializePackFile, opened for reading.
+ *
+ * The file is memory mapped: opening is immediate and bitmaps are read only when requested.
+ * The file must not be modified while the pack or any of its views are alive.
+ *
+ * @export
+ * @class RoaringBitmap32Pack
+ */
+export class RoaringBitmap32Pack {
+  /**
+   * Opens a bitmap pack file.
+   *
+   * @param {string} filePath The path of the pack file.
+   * @memberof RoaringBitmap32Pack
+   */
+  constructor(filePath: string);
+
+  /**
+   * The number of bitmaps in the pack.
+   *
+   * @type {number}
+   * @memberof RoaringBitmap32Pack
+   */
+  readonly length: number;
+
+  /**
+   * The format of the bitmaps in the pack.
+   *
+   * @memberof RoaringBitmap32Pack
+   */
+  readonly format: "portable" | "unsafe_frozen_croaring";
+
+  /**
+   * Deserializes the bitmap at the given index into a new, mutable, RoaringBitmap32.
+   *
+   * @param {number} index The index of the bitmap in the pack.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32Pack
+   */
+  get(index: number): RoaringBitmap32;
+
+  /**
+   * Creates a frozen RoaringBitmap32 that reads the bitmap at the given index directly from the mapped file, without copying it.
+   * The view keeps the pack alive.
+   *
+   * @param {number} index The index of the bitmap in the pack.
+   * @returns {RoaringBitmap32} A new frozen RoaringBitmap32 instance.
+   * @memberof RoaringBitmap32Pack
+   */
+  view(index: number): RoaringBitmap32;
+}
+
+/**
+ * A keyed store of bitmaps, for inverted indexes: maps string keys to sets of 32 bit unsigned ids.
+ *
+ * Unlike a Map<string, RoaringBitmap32>, the bitmaps are kept in a native hash table and are not JS objects,
+ * so millions of keys do not add garbage collector work or per object overhead.
+ * RoaringBitmap32 instances are created only by get and by the operations over many keys.
+ *
+ * Keys whose bitmap becomes empty are removed.
+ *
+ * @export
+ * @class RoaringBitmapIndex
+ */
+export class RoaringBitmapIndex {
+  /**
+   * Creates a new empty index.
+   *
+   * @memberof RoaringBitmapIndex
+   */
+  constructor();
+
+  /**
+   * The number of keys in the index.
+   *
+   * @type {number}
+   * @memberof RoaringBitmapIndex
+   */
+  readonly size: number;
+
+  /**
+   * Adds an id to the bitmap of a key.
+   *
+   * @param {string} key The key.
+   * @param {number} id The id, a 32 bit unsigned integer.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapIndex
+   */
+  add(key: string, id: number): this;
+
+  /**
+   * Adds many ids to the bitmap of a key.
+   *
+   * @param {string} key The key.
+   * @param {Uint32Array | Int32Array | readonly number[]} ids The ids to add.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapIndex
+   */
+  addMany(key: string, ids: Uint32Array | Int32Array | readonly number[]): this;
+
+  /**
+   * Adds ids[i] to the bitmap of keys[i], for every i.
+   * Consecutive equal keys are resolved only once, so grouping the pairs by key is faster.
+   *
+   * @param {readonly string[]} keys The keys.
+   * @param {Uint32Array | Int32Array | readonly number[]} ids The ids, same length of keys.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapIndex
+   */
+  addMany(keys: readonly string[], ids: Uint32Array | Int32Array | readonly number[]): this;
+
+  /**
+   * Removes an id from the bitmap of a key. The key is removed if its bitmap becomes empty.
+   *
+   * @param {string} key The key.
+   * @param {number} id The id.
+   * @returns {boolean} True if the id was removed.
+   * @memberof RoaringBitmapIndex
+   */
+  remove(key: string, id: number): boolean;
+
+  /**
+   * Replaces the bitmap of a key with a copy of the given bitmap. An empty bitmap removes the key.
+   *
+   * @param {string} key The key.
+   * @param {ReadonlyRoaringBitmap32} bitmap The bitmap to copy.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapIndex
+   */
+  set(key: string, bitmap: ReadonlyRoaringBitmap32): this;
+
+  /**
+   * Gets a copy of the bitmap of a key.
+   *
+   * @param {string} key The key.
+   * @returns {RoaringBitmap32 | undefined} A new RoaringBitmap32, or undefined if the key does not exist.
+   * @memberof RoaringBitmapIndex
+   */
+  get(key: string): RoaringBitmap32 | undefined;
+
+  /**
+   * Checks if a key exists.
+   *
+   * @param {string} key The key.
+   * @returns {boolean} True if the key exists.
+   * @memberof RoaringBitmapIndex
+   */
+  has(key: string): boolean;
+
+  /**
+   * Removes a key and its bitmap.
+   *
+   * @param {string} key The key.
+   * @returns {boolean} True if the key existed.
+   * @memberof RoaringBitmapIndex
+   */
+  delete(key: string): boolean;
+
+  /**
+   * Removes all the keys.
+   *
+   * @memberof RoaringBitmapIndex
+   */
+  clear(): void;
+
+  /**
+   * Gets the number of ids of a key, without creating a bitmap.
+   *
+   * @param {string} key The key.
+   * @returns {number} The number of ids, 0 if the key does not exist.
+   * @memberof RoaringBitmapIndex
+   */
+  cardinality(key: string): number;
+
+  /**
+   * Gets all the keys, in no particular order.
+   *
+   * @returns {string[]} A new array with the keys.
+   * @memberof RoaringBitmapIndex
+   */
+  keys(): string[];
+
+  /**
+   * Computes the union of the bitmaps of the given keys. Missing keys are ignored.
+   *
+   * @param {readonly string[]} keys The keys.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the union.
+   * @memberof RoaringBitmapIndex
+   */
+  orMany(keys: readonly string[]): RoaringBitmap32;
+
+  /**
+   * Computes the intersection of the bitmaps of the given keys, smallest first.
+   * A missing key is an empty set, so the result is empty.
+   *
+   * @param {readonly string[]} keys The keys.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the intersection.
+   * @memberof RoaringBitmapIndex
+   */
+  andMany(keys: readonly string[]): RoaringBitmap32;
+
+  /**
+   * Computes the number of ids in the union of the bitmaps of the given keys, without creating it.
+   *
+   * @param {readonly string[]} keys The keys.
+   * @returns {number} The cardinality of the union.
+   * @memberof RoaringBitmapIndex
+   */
+  orManyCardinality(keys: readonly string[]): number;
+
+  /**
+   * Computes the number of ids in the intersection of the bitmaps of the given keys, without creating it.
+   *
+   * @param {readonly string[]} keys The keys.
+   * @returns {number} The cardinality of the intersection.
+   * @memberof RoaringBitmapIndex
+   */
+  andManyCardinality(keys: readonly string[]): number;
+}
+
+/**
+ * A bit-sliced index (BSI): maps 32 bit unsigned columns, usually row ids, to 32 bit unsigned values.
+ *
+ * Values are stored as one RoaringBitmap per bit, plus a bitmap of the columns that have a value.
+ * Range predicates and aggregates are computed with bitmap operations, one per bit of the values,
+ * so they can be combined with other RoaringBitmap32 filters without converting columns to arrays.
+ *
+ * All the queries accept an optional filter: only the columns in the filter are considered.
+ *
+ * @export
+ * @class RoaringBitmapSliced32
+ */
+export class RoaringBitmapSliced32 {
+  /**
+   * Creates a new empty bit-sliced index.
+   *
+   * @memberof RoaringBitmapSliced32
+   */
+  constructor();
+
+  /**
+   * The number of columns that have a value.
+   *
+   * @type {number}
+   * @memberof RoaringBitmapSliced32
+   */
+  readonly size: number;
+
+  /**
+   * The number of bit slices, the number of bits of the highest value ever stored.
+   *
+   * @type {number}
+   * @memberof RoaringBitmapSliced32
+   */
+  readonly bitDepth: number;
+
+  /**
+   * Sets the value of a column.
+   *
+   * @param {number} column The column, a 32 bit unsigned integer.
+   * @param {number} value The value, a 32 bit unsigned integer.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapSliced32
+   */
+  set(column: number, value: number): this;
+
+  /**
+   * Sets the values of many columns. columns[i] is set to values[i].
+   * Faster than calling set in a loop, especially when the columns are sorted.
+   *
+   * @param {Uint32Array} columns The columns.
+   * @param {Uint32Array} values The values, same length of columns.
+   * @returns {this} This instance.
+   * @memberof RoaringBitmapSliced32
+   */
+  setMany(columns: Uint32Array | Int32Array, values: Uint32Array | Int32Array): this;
+
+  /**
+   * Gets the value of a column.
+   *
+   * @param {number} column The column.
+   * @returns {number | undefined} The value, or undefined if the column has no value.
+   * @memberof RoaringBitmapSliced32
+   */
+  get(column: number): number | undefined;
+
+  /**
+   * Checks if a column has a value.
+   *
+   * @param {number} column The column.
+   * @returns {boolean} True if the column has a value.
+   * @memberof RoaringBitmapSliced32
+   */
+  has(column: number): boolean;
+
+  /**
+   * Removes the value of a column.
+   *
+   * @param {number} column The column.
+   * @returns {boolean} True if the column had a value.
+   * @memberof RoaringBitmapSliced32
+   */
+  delete(column: number): boolean;
+
+  /**
+   * Removes all the columns.
+   *
+   * @memberof RoaringBitmapSliced32
+   */
+  clear(): void;
+
+  /**
+   * Gets the columns that have a value.
+   *
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are returned.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  columns(filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is equal to the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  equal(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is not equal to the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  notEqual(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is lower than the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  lessThan(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is lower than or equal to the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  lessThanOrEqual(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is greater than the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  greaterThan(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is greater than or equal to the given value.
+   *
+   * @param {number} value The value to compare.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  greaterThanOrEqual(value: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Gets the columns whose value is between min and max, inclusive.
+   *
+   * @param {number} min The minimum value.
+   * @param {number} max The maximum value.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with the matching columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  between(min: number, max: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+
+  /**
+   * Sums the values of the columns. The result is exact up to Number.MAX_SAFE_INTEGER.
+   *
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are summed.
+   * @returns {number} The sum of the values, 0 if there are no columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  sum(filter?: ReadonlyRoaringBitmap32 | null): number;
+
+  /**
+   * Gets the minimum value of the columns.
+   *
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {number | undefined} The minimum value, or undefined if there are no columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  min(filter?: ReadonlyRoaringBitmap32 | null): number | undefined;
+
+  /**
+   * Gets the maximum value of the columns.
+   *
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {number | undefined} The maximum value, or undefined if there are no columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  max(filter?: ReadonlyRoaringBitmap32 | null): number | undefined;
+
+  /**
+   * Gets the k columns with the highest values. Columns with the same value are taken in ascending column order.
+   *
+   * @param {number} k The number of columns to return.
+   * @param {ReadonlyRoaringBitmap32} [filter] If given, only the columns in the filter are considered.
+   * @returns {RoaringBitmap32} A new RoaringBitmap32 with at most k columns.
+   * @memberof RoaringBitmapSliced32
+   */
+  topK(k: number, filter?: ReadonlyRoaringBitmap32 | null): RoaringBitmap32;
+}
+
 /**
  * Object returned by RoaringBitmap32 statistics() method
  *
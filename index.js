@@ -45,7 +45,7 @@ const { defineProperty } = Reflect;
 
 defineProperty(roaring, "__esModule", { value: true, configurable: true });
 
-const { RoaringBitmap32, RoaringBitmap32BufferedIterator } = roaring;
+const { RoaringBitmap32, RoaringBitmap32BufferedIterator, RoaringBitmap64, RoaringBitmap64BufferedIterator } = roaring;
 
 class RoaringBitmap32IteratorResult {
   constructor() {
@@ -56,8 +56,6 @@ class RoaringBitmap32IteratorResult {
 
 const _iteratorBufferPoolMax = 32;
 const _iteratorBufferPoolDefaultLen = 2048;
-const _iteratorBufferPool = new Array(_iteratorBufferPoolMax);
-let _iteratorBufferPoolLen = 0;
 const _symbolDispose = typeof Symbol.dispose === "symbol" ? Symbol.dispose : undefined;
 
 function normalizeIteratorChunkLength(length) {
@@ -72,28 +70,58 @@ function normalizeIteratorChunkLength(length) {
   return normalized > 0 ? normalized : 1;
 }
 
-function acquireIteratorBuffer(length) {
-  if (length === _iteratorBufferPoolDefaultLen && _iteratorBufferPoolLen) {
-    return _iteratorBufferPool[--_iteratorBufferPoolLen];
+/** Describes a bitmap class and the native buffered iterator and typed array used to iterate it. */
+function defineIteratorKind(Bitmap, BufferedIterator, BufferType, bitmapName, seekable) {
+  return {
+    Bitmap,
+    BufferedIterator,
+    BufferType,
+    bitmapName,
+    seekable,
+    iteratorName: `${bitmapName}Iterator`,
+    pool: new Array(_iteratorBufferPoolMax),
+    poolLen: 0,
+  };
+}
+
+const _iteratorKind32 = defineIteratorKind(
+  RoaringBitmap32,
+  RoaringBitmap32BufferedIterator,
+  Uint32Array,
+  "RoaringBitmap32",
+  true,
+);
+
+const _iteratorKind64 = defineIteratorKind(
+  RoaringBitmap64,
+  RoaringBitmap64BufferedIterator,
+  BigUint64Array,
+  "RoaringBitmap64",
+  false,
+);
+
+function acquireIteratorBuffer(kind, length) {
+  if (length === _iteratorBufferPoolDefaultLen && kind.poolLen) {
+    return kind.pool[--kind.poolLen];
   }
-  return new Uint32Array(length);
+  return new kind.BufferType(length);
 }
 
-function releaseIteratorBuffer(buffer) {
-  if (_iteratorBufferPoolLen < _iteratorBufferPoolMax) {
-    _iteratorBufferPool[_iteratorBufferPoolLen++] = buffer;
+function releaseIteratorBuffer(kind, buffer) {
+  if (kind.poolLen < _iteratorBufferPoolMax) {
+    kind.pool[kind.poolLen++] = buffer;
   }
 }
 
-function normalizeIteratorInputs(bitmap, buffer) {
+function normalizeIteratorInputs(kind, bitmap, buffer) {
   let done = false;
-  if (bitmap instanceof RoaringBitmap32) {
+  if (bitmap instanceof kind.Bitmap) {
     done = false;
   } else if (bitmap === undefined || bitmap === null) {
     bitmap = undefined;
     done = true;
   } else {
-    throw new TypeError("RoaringBitmap32Iterator constructor expects a RoaringBitmap32 instance");
+    throw new TypeError(`${kind.iteratorName} constructor expects a ${kind.bitmapName} instance`);
   }
 
   let chunk = null;
@@ -103,9 +131,9 @@ function normalizeIteratorInputs(bitmap, buffer) {
     if (typeof buffer === "number") {
       bufferLength = normalizeIteratorChunkLength(buffer);
       bufferReusable = bufferLength === _iteratorBufferPoolDefaultLen;
-    } else if (buffer instanceof Uint32Array) {
+    } else if (buffer instanceof kind.BufferType) {
       if (buffer.length === 0) {
-        throw new TypeError("RoaringBitmap32Iterator buffer must have a positive length");
+        throw new TypeError(`${kind.iteratorName} buffer must have a positive length`);
       }
       chunk = buffer;
       bufferLength = buffer.length;
@@ -114,17 +142,32 @@ function normalizeIteratorInputs(bitmap, buffer) {
       bufferLength = _iteratorBufferPoolDefaultLen;
       bufferReusable = true;
     } else {
-      throw new TypeError("RoaringBitmap32Iterator buffer must be a number or a Uint32Array");
+      throw new TypeError(`${kind.iteratorName} buffer must be a number or a ${kind.BufferType.name}`);
     }
   }
 
   return { bitmap, chunk, bufferLength, bufferReusable, done };
 }
 
-function defineRoaringBitmap32Iterator(reverse, name) {
-  function Iterator(bitmap, buffer = _iteratorBufferPoolDefaultLen) {
+function normalizeIteratorBound(kind, value, name) {
+  if (value === undefined || value === null) {
+    return undefined;
+  }
+  if (!kind.seekable) {
+    throw new TypeError(`${kind.iteratorName} does not support the ${name} option`);
+  }
+  if (typeof value !== "number" || Number.isNaN(value)) {
+    throw new TypeError(`${kind.iteratorName} ${name} must be a number`);
+  }
+  return value;
+}
+
+function defineRoaringBitmapIterator(kind, reverse, name) {
+  const BufferedIterator = kind.BufferedIterator;
+
+  function Iterator(bitmap, buffer = _iteratorBufferPoolDefaultLen, options) {
     if (!new.target) {
-      return new Iterator(bitmap, buffer);
+      return new Iterator(bitmap, buffer, options);
     }
 
     var result = null;
@@ -136,7 +179,14 @@ function defineRoaringBitmap32Iterator(reverse, name) {
     var bufferCount = 0;
     var done = false;
 
-    ({ bitmap, chunk, bufferLength, bufferReusable, done } = normalizeIteratorInputs(bitmap, buffer));
+    ({ bitmap, chunk, bufferLength, bufferReusable, done } = normalizeIteratorInputs(kind, bitmap, buffer));
+
+    var from = options ? normalizeIteratorBound(kind, options.from, "from") : undefined;
+    var to = options ? normalizeIteratorBound(kind, options.to, "to") : undefined;
+    // Kept until return() so an exhausted iterator can be seeked again.
+    var source = bitmap;
+    const userChunk = chunk;
+    const pooled = bufferReusable;
 
     this.next = function next() {
       if (done) {
@@ -149,9 +199,12 @@ function defineRoaringBitmap32Iterator(reverse, name) {
       while (bufferIndex >= bufferCount) {
         if (reader === null) {
           if (!chunk) {
-            chunk = acquireIteratorBuffer(bufferLength);
+            chunk = acquireIteratorBuffer(kind, bufferLength);
           }
-          reader = new RoaringBitmap32BufferedIterator(bitmap, chunk, reverse);
+          reader =
+            from === undefined && to === undefined
+              ? new BufferedIterator(bitmap, chunk, reverse)
+              : new BufferedIterator(bitmap, chunk, reverse, from, to);
           bufferCount = reader.n;
           bitmap = null;
         } else {
@@ -164,7 +217,7 @@ function defineRoaringBitmap32Iterator(reverse, name) {
             reader = null;
           }
           if (bufferReusable && chunk) {
-            releaseIteratorBuffer(chunk);
+            releaseIteratorBuffer(kind, chunk);
           }
           bitmap = null;
           chunk = null;
@@ -183,8 +236,41 @@ function defineRoaringBitmap32Iterator(reverse, name) {
       return result;
     };
 
+    if (kind.seekable) {
+      this.seek = function seek(value) {
+        value = normalizeIteratorBound(kind, value, "seek value");
+        if (value === undefined) {
+          throw new TypeError(`${kind.iteratorName} seek value must be a number`);
+        }
+        if (source === null || source === undefined) {
+          return this;
+        }
+        from = value;
+        bufferIndex = 0;
+        if (reader !== null) {
+          bufferCount = reader.seek(value);
+          if (bufferCount > 0) {
+            return this;
+          }
+          // Nothing after the seek value: the native reader released the bitmap, so it cannot seek again.
+          reader.close();
+          reader = null;
+        }
+        // Not started yet or exhausted, the reader is created on the next call to next().
+        if (done) {
+          chunk = userChunk;
+          bufferReusable = pooled;
+          done = false;
+        }
+        bitmap = source;
+        bufferCount = 0;
+        return this;
+      };
+    }
+
     const iteratorReturn = function iteratorReturn(value) {
       result ||= new RoaringBitmap32IteratorResult();
+      source = null;
       if (!done) {
         done = true;
         bitmap = null;
@@ -193,7 +279,7 @@ function defineRoaringBitmap32Iterator(reverse, name) {
           reader = null;
         }
         if (bufferReusable && chunk) {
-          releaseIteratorBuffer(chunk);
+          releaseIteratorBuffer(kind, chunk);
         }
         chunk = null;
         bufferReusable = false;
@@ -230,16 +316,28 @@ function defineRoaringBitmap32Iterator(reverse, name) {
   return Iterator;
 }
 
-const RoaringBitmap32Iterator = defineRoaringBitmap32Iterator(false, "RoaringBitmap32Iterator");
+const RoaringBitmap32Iterator = defineRoaringBitmapIterator(_iteratorKind32, false, "RoaringBitmap32Iterator");
+
+const RoaringBitmap32ReverseIterator = defineRoaringBitmapIterator(_iteratorKind32, true, "RoaringBitmap32ReverseIterator");
+
+const RoaringBitmap64Iterator = defineRoaringBitmapIterator(_iteratorKind64, false, "RoaringBitmap64Iterator");
+
+const RoaringBitmap64ReverseIterator = defineRoaringBitmapIterator(_iteratorKind64, true, "RoaringBitmap64ReverseIterator");
 
-const RoaringBitmap32ReverseIterator = defineRoaringBitmap32Iterator(true, "RoaringBitmap32ReverseIterator");
+function iterator(options) {
+  return new RoaringBitmap32Iterator(this, undefined, options);
+}
+
+function reverseIterator(options) {
+  return new RoaringBitmap32ReverseIterator(this, undefined, options);
+}
 
-function iterator() {
-  return new RoaringBitmap32Iterator(this);
+function iterator64() {
+  return new RoaringBitmap64Iterator(this);
 }
 
-function reverseIterator() {
-  return new RoaringBitmap32ReverseIterator(this);
+function reverseIterator64() {
+  return new RoaringBitmap64ReverseIterator(this);
 }
 
 let isArrayBuffer;
@@ -297,7 +395,9 @@ if (!roaring[initializedSym]) {
   };
 
   roaringBitmap32_proto.dispose = function dispose() {
-    this.clear();
+    if (!this.releaseMappedFile()) {
+      this.clear();
+    }
   };
 
   if (_symbolDispose) {
@@ -730,5 +830,31 @@ if (!roaring[initializedSym]) {
 
   RoaringBitmap32.getRoaringUsedMemory = roaring.getRoaringUsedMemory;
 
+  const roaringBitmap64_proto = RoaringBitmap64.prototype;
+  roaringBitmap64_proto[Symbol.iterator] = iterator64;
+  roaringBitmap64_proto.iterator = iterator64;
+  roaringBitmap64_proto.keys = iterator64;
+  roaringBitmap64_proto.values = iterator64;
+  roaringBitmap64_proto.reverseIterator = reverseIterator64;
+  roaringBitmap64_proto.entries = roaringBitmap32_proto.entries;
+  roaringBitmap64_proto.forEach = roaringBitmap32_proto.forEach;
+  roaringBitmap64_proto.dispose = function dispose() {
+    this.clear();
+  };
+  if (_symbolDispose) {
+    roaringBitmap64_proto[_symbolDispose] = roaringBitmap64_proto.dispose;
+  }
+
+  for (const [name, value] of [
+    ["RoaringBitmap64Iterator", RoaringBitmap64Iterator],
+    ["RoaringBitmap64ReverseIterator", RoaringBitmap64ReverseIterator],
+  ]) {
+    const prop = { value, writable: false, configurable: false, enumerable: true };
+    defineProperty(roaring, name, prop);
+    defineProperty(RoaringBitmap64, name, prop);
+  }
+
+  RoaringBitmap64.getRoaringUsedMemory = roaring.getRoaringUsedMemory;
+
   roaring.asBuffer = asBuffer;
 }
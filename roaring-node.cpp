@@ -29,6 +29,7 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
 #if defined(__APPLE__)
 #  include <malloc/malloc.h>
@@ -10264,7 +10265,7 @@ void croaringMemoryInitialize() {
 
 #endif  // ROARING_NODE_CROARING_
 
-#line 37 "src/cpp/includes.h"
+#line 38 "src/cpp/includes.h"
 
 #define NEW_LITERAL_V8_STRING(isolate, str, type) v8::String::NewFromUtf8Literal(isolate, str, type)
 
@@ -10284,12 +10285,15 @@ typedef const char * const_char_ptr_t;
 
 const char * const ERROR_FROZEN = "This bitmap is frozen and cannot be modified";
 const char * const ERROR_INVALID_OBJECT = "Invalid RoaringBitmap32 object";
+const char * const ERROR_INVALID_OBJECT_64 = "Invalid RoaringBitmap64 object";
+const char * const ERROR_UINT64_RANGE = "RoaringBitmap64 - BigInt value is outside the 64 bit unsigned integer range";
 
 class AddonDataStrings final {
  public:
   v8::Global<v8::String> n;
   v8::Global<v8::String> readonly;
   v8::Global<v8::String> RoaringBitmap32;
+  v8::Global<v8::String> RoaringBitmap64;
   v8::Global<v8::Symbol> symbol_rnshared;
 
   v8::Global<v8::String> OperationFailed;
@@ -10302,6 +10306,7 @@ class AddonDataStrings final {
     literal(isolate, this->n, "n");
     literal(isolate, this->readonly, "readonly");
     literal(isolate, this->RoaringBitmap32, "RoaringBitmap32");
+    literal(isolate, this->RoaringBitmap64, "RoaringBitmap64");
     literal(isolate, this->Comma, ",");
 
     literal(isolate, this->OperationFailed, "Operation failed");
@@ -10329,6 +10334,11 @@ template <typename T>
 inline void ignoreMaybeResult(v8::MaybeLocal<T>) {}
 
 class AddonData final {
+ private:
+  v8::Global<v8::Uint32Array> scratchUint32Array;
+  uint32_t * scratchUint32ArrayData = nullptr;
+  bool scratchUint32ArrayInUse = false;
+
  public:
   v8::Isolate * isolate;
 
@@ -10337,9 +10347,12 @@ class AddonData final {
   v8::Global<v8::Object> Buffer;
   v8::Global<v8::Object> Uint32Array;
   v8::Global<v8::Function> Uint32Array_from;
+  v8::Global<v8::Function> Uint32Array_set;
   v8::Global<v8::Function> Buffer_from;
+  v8::Global<v8::Function> Array_from;
 
   std::atomic<uint64_t> RoaringBitmap32_instances;
+  std::atomic<uint64_t> RoaringBitmap64_instances;
   std::atomic<uint32_t> activeAsyncWorkers;
   std::atomic<bool> shuttingDown;
 
@@ -10349,10 +10362,24 @@ class AddonData final {
   v8::Global<v8::FunctionTemplate> RoaringBitmap32BufferedIterator_constructorTemplate;
   v8::Global<v8::Function> RoaringBitmap32BufferedIterator_constructor;
 
+  v8::Global<v8::FunctionTemplate> RoaringBitmap64_constructorTemplate;
+  v8::Global<v8::Function> RoaringBitmap64_constructor;
+
+  v8::Global<v8::FunctionTemplate> RoaringBitmap64BufferedIterator_constructorTemplate;
+  v8::Global<v8::Function> RoaringBitmap64BufferedIterator_constructor;
+
   v8::Global<v8::External> external;
 
+  /** Length of the reusable Uint32Array used to convert JS arrays, see acquireScratchUint32Array. */
+  static const constexpr uint32_t SCRATCH_UINT32_ARRAY_LENGTH = 1 << 17;
+
   inline explicit AddonData(v8::Isolate * isolate) :
-    isolate(isolate), strings(isolate), RoaringBitmap32_instances(0), activeAsyncWorkers(0), shuttingDown(false) {
+    isolate(isolate),
+    strings(isolate),
+    RoaringBitmap32_instances(0),
+    RoaringBitmap64_instances(0),
+    activeAsyncWorkers(0),
+    shuttingDown(false) {
     const int64_t externalSize = static_cast<int64_t>(sizeof(AddonData)) + 256;
     isolate->AdjustAmountOfExternalAllocatedMemory(externalSize);
   }
@@ -10363,11 +10390,18 @@ class AddonData final {
     Buffer.Reset();
     Uint32Array.Reset();
     Uint32Array_from.Reset();
+    Uint32Array_set.Reset();
+    scratchUint32Array.Reset();
     Buffer_from.Reset();
+    Array_from.Reset();
     RoaringBitmap32_constructorTemplate.Reset();
     RoaringBitmap32_constructor.Reset();
     RoaringBitmap32BufferedIterator_constructorTemplate.Reset();
     RoaringBitmap32BufferedIterator_constructor.Reset();
+    RoaringBitmap64_constructorTemplate.Reset();
+    RoaringBitmap64_constructor.Reset();
+    RoaringBitmap64BufferedIterator_constructorTemplate.Reset();
+    RoaringBitmap64BufferedIterator_constructor.Reset();
     external.Reset();
     const int64_t externalSize = -static_cast<int64_t>(sizeof(AddonData)) - 256;
     this->isolate->AdjustAmountOfExternalAllocatedMemory(externalSize);
@@ -10416,13 +10450,58 @@ class AddonData final {
 
     this->Uint32Array.Reset(isolate, uint32Array);
 
+    auto array = global->Get(context, NEW_LITERAL_V8_STRING(isolate, "Array", v8::NewStringType::kInternalized))
+                   .ToLocalChecked()
+                   .As<v8::Object>();
+
+    this->Array_from.Reset(
+      isolate,
+      array->Get(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized))
+        .ToLocalChecked()
+        .As<v8::Function>());
+
     this->Uint32Array_from.Reset(
       isolate,
       v8::Local<v8::Function>::Cast(
         uint32Array->Get(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized))
           .ToLocalChecked()));
+
+    this->Uint32Array_set.Reset(
+      isolate,
+      v8::Local<v8::Function>::Cast(
+        uint32Array->Get(context, NEW_LITERAL_V8_STRING(isolate, "prototype", v8::NewStringType::kInternalized))
+          .ToLocalChecked()
+          ->ToObject(context)
+          .ToLocalChecked()
+          ->Get(context, NEW_LITERAL_V8_STRING(isolate, "set", v8::NewStringType::kInternalized))
+          .ToLocalChecked()));
+  }
+
+  /**
+   * Returns a reusable Uint32Array of SCRATCH_UINT32_ARRAY_LENGTH elements, allocated on first use, and its data.
+   * Returns an empty handle if the array is already in use by an outer call, that can happen if the conversion of a
+   * value calls back into JS. releaseScratchUint32Array must be called when done.
+   */
+  v8::Local<v8::Uint32Array> acquireScratchUint32Array(uint32_t *& data) {
+    if (this->scratchUint32ArrayInUse) {
+      return v8::Local<v8::Uint32Array>();
+    }
+    if (this->scratchUint32Array.IsEmpty()) {
+      v8::Local<v8::ArrayBuffer> arrayBuffer =
+        v8::ArrayBuffer::New(this->isolate, SCRATCH_UINT32_ARRAY_LENGTH * sizeof(uint32_t));
+      if (arrayBuffer.IsEmpty()) {
+        return v8::Local<v8::Uint32Array>();
+      }
+      this->scratchUint32ArrayData = (uint32_t *)arrayBuffer->GetBackingStore()->Data();
+      this->scratchUint32Array.Reset(this->isolate, v8::Uint32Array::New(arrayBuffer, 0, SCRATCH_UINT32_ARRAY_LENGTH));
+    }
+    this->scratchUint32ArrayInUse = true;
+    data = this->scratchUint32ArrayData;
+    return this->scratchUint32Array.Get(this->isolate);
   }
 
+  inline void releaseScratchUint32Array() { this->scratchUint32ArrayInUse = false; }
+
   inline void setMethod(v8::Local<v8::Object> recv, const char * name, v8::FunctionCallback callback) {
     if (recv.IsEmpty() || name == nullptr || callback == nullptr) {
       return;
@@ -10560,6 +10639,44 @@ namespace v8utils {
     return true;
   }
 
+  /** Converts a non negative BigInt or a non negative safe integer number to an uint64_t. */
+  inline bool v8ValueToUint64Fast(v8::Local<v8::Context> context, v8::Local<v8::Value> value, uint64_t & result) {
+    if (value.IsEmpty()) {
+      return false;
+    }
+    if (value->IsBigInt()) {
+      bool lossless = false;
+      const uint64_t n = value.As<v8::BigInt>()->Uint64Value(&lossless);
+      if (!lossless) {
+        return false;
+      }
+      result = n;
+      return true;
+    }
+    uint32_t u32;
+    if (value->IsUint32() || value->IsInt32()) {
+      if (!v8ValueToUint32Fast(context, value, u32)) {
+        return false;
+      }
+      result = u32;
+      return true;
+    }
+    if (value->IsNullOrUndefined()) {
+      return false;
+    }
+    double d;
+    if (value->IsNumber()) {
+      d = value.As<v8::Number>()->Value();
+    } else if (!value->NumberValue(context).To(&d)) {
+      return false;
+    }
+    if (std::isnan(d) || d < 0 || d > 9007199254740991.0 || d != std::trunc(d)) {
+      return false;
+    }
+    result = static_cast<uint64_t>(d);
+    return true;
+  }
+
   template <int N>
   inline void throwError(v8::Isolate * isolate, const char (&message)[N]) {
     isolate->ThrowException(v8::Exception::Error(NEW_LITERAL_V8_STRING(isolate, message, v8::NewStringType::kInternalized)));
@@ -10599,6 +10716,20 @@ namespace v8utils {
       v8::Exception::TypeError(NEW_LITERAL_V8_STRING(isolate, "Operation failed", v8::NewStringType::kInternalized)));
   }
 
+  void throwRangeError(v8::Isolate * isolate, const char * message) {
+    v8::HandleScope scope(isolate);
+    if (message != nullptr && message[0] != '\0') {
+      auto msg = v8::String::NewFromUtf8(isolate, message, v8::NewStringType::kInternalized);
+      v8::Local<v8::String> msgLocal;
+      if (msg.ToLocal(&msgLocal)) {
+        isolate->ThrowException(v8::Exception::RangeError(msgLocal));
+        return;
+      }
+    }
+    isolate->ThrowException(
+      v8::Exception::RangeError(NEW_LITERAL_V8_STRING(isolate, "Operation failed", v8::NewStringType::kInternalized)));
+  }
+
   void throwTypeError(v8::Isolate * isolate, const char * context, const char * message) {
     v8::HandleScope scope(isolate);
     auto a = v8::String::NewFromUtf8(isolate, context, v8::NewStringType::kInternalized);
@@ -10982,6 +11113,114 @@ void AlignedBuffers_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
 #ifndef __ROARINGBITMAP32__H__
 #define __ROARINGBITMAP32__H__
 
+#line 1 "src/cpp/mmap.h"
+#ifndef ROARING_NODE_MMAP_
+#define ROARING_NODE_MMAP_
+
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+
+/* mmap() replacement for Windows
+ *
+ * Author: Mike Frysinger <vapier@gentoo.org>
+ * Placed into the public domain
+ */
+
+/* References:
+ * CreateFileMapping: http://msdn.microsoft.com/en-us/library/aa366537(VS.85).aspx
+ * CloseHandle:       http://msdn.microsoft.com/en-us/library/ms724211(VS.85).aspx
+ * MapViewOfFile:     http://msdn.microsoft.com/en-us/library/aa366761(VS.85).aspx
+ * UnmapViewOfFile:   http://msdn.microsoft.com/en-us/library/aa366882(VS.85).aspx
+ */
+
+#  include <io.h>
+#  include <windows.h>
+#  include <sys/types.h>
+
+#  define PROT_READ 0x1
+#  define PROT_WRITE 0x2
+/* This flag is only available in WinXP+ */
+#  ifdef FILE_MAP_EXECUTE
+#    define PROT_EXEC 0x4
+#  else
+#    define PROT_EXEC 0x0
+#    define FILE_MAP_EXECUTE 0
+#  endif
+
+#  define MAP_SHARED 0x01
+#  define MAP_PRIVATE 0x02
+#  define MAP_ANONYMOUS 0x20
+#  define MAP_ANON MAP_ANONYMOUS
+#  define MAP_FAILED ((void *)-1)
+
+#  ifdef __USE_FILE_OFFSET64
+#    define DWORD_HI(x) (x >> 32)
+#    define DWORD_LO(x) ((x)&0xffffffff)
+#  else
+#    define DWORD_HI(x) (0)
+#    define DWORD_LO(x) (x)
+#  endif
+
+static void * mmap(void * start, size_t length, int prot, int flags, int fd, off_t offset) {
+  if (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC)) return MAP_FAILED;
+  if (fd == -1) {
+    if (!(flags & MAP_ANON) || offset) return MAP_FAILED;
+  } else if (flags & MAP_ANON)
+    return MAP_FAILED;
+
+  DWORD flProtect;
+  if (prot & PROT_WRITE) {
+    if (prot & PROT_EXEC)
+      flProtect = PAGE_EXECUTE_READWRITE;
+    else
+      flProtect = PAGE_READWRITE;
+  } else if (prot & PROT_EXEC) {
+    if (prot & PROT_READ)
+      flProtect = PAGE_EXECUTE_READ;
+    else if (prot & PROT_EXEC)
+      flProtect = PAGE_EXECUTE;
+  } else
+    flProtect = PAGE_READONLY;
+
+  off_t end = length + offset;
+  HANDLE mmap_fd, h;
+  if (fd == -1)
+    mmap_fd = INVALID_HANDLE_VALUE;
+  else
+    mmap_fd = (HANDLE)_get_osfhandle(fd);
+  h = CreateFileMapping(mmap_fd, NULL, flProtect, DWORD_HI(end), DWORD_LO(end), NULL);
+  if (h == NULL) return MAP_FAILED;
+
+  DWORD dwDesiredAccess;
+  if (prot & PROT_WRITE)
+    dwDesiredAccess = FILE_MAP_WRITE;
+  else
+    dwDesiredAccess = FILE_MAP_READ;
+  if (prot & PROT_EXEC) dwDesiredAccess |= FILE_MAP_EXECUTE;
+  if (flags & MAP_PRIVATE) dwDesiredAccess |= FILE_MAP_COPY;
+  void * ret = MapViewOfFile(h, dwDesiredAccess, DWORD_HI(offset), DWORD_LO(offset), length);
+  if (ret == NULL) {
+    CloseHandle(h);
+    ret = MAP_FAILED;
+  }
+  return ret;
+}
+
+static void munmap(void * addr, size_t length) {
+  UnmapViewOfFile(addr);
+  /* ruh-ro, we leaked handle from CreateFileMapping() ... */
+}
+
+#  undef DWORD_HI
+#  undef DWORD_LO
+
+#else
+
+#  include <unistd.h>
+#  include <sys/mman.h>
+
+#endif
+#endif
+
 #line 1 "src/cpp/serialization-format.h"
 #ifndef ROARING_NODE_SERIALIZATION_FORMAT_
 #define ROARING_NODE_SERIALIZATION_FORMAT_
@@ -11210,7 +11449,7 @@ struct WorkerError {
 
 #endif
 
-#line 7 "src/cpp/RoaringBitmap32.h"
+#line 8 "src/cpp/RoaringBitmap32.h"
 
 using namespace roaring;
 using namespace roaring::api;
@@ -11235,6 +11474,13 @@ class RoaringBitmap32 final : public ObjectWrap {
   v8::Global<v8::Object> persistent;
   v8utils::TypedArrayContent<uint8_t> frozenStorage;
 
+  /** Memory mapped file backing a frozen bitmap created with mapFile, or nullptr. */
+  void * mappedFile;
+  size_t mappedFileSize;
+
+  /** Number of async operations reading a bitmap that is frozen forever, a mapped file cannot be released while in use. */
+  uint32_t foreverFrozenPins;
+
   inline bool isEmpty() const {
     if (this->sizeCache == 0) {
       return true;
@@ -11270,22 +11516,59 @@ class RoaringBitmap32 final : public ObjectWrap {
   inline void beginFreeze() {
     if (this->frozenCounter >= 0) {
       ++this->frozenCounter;
+    } else {
+      ++this->foreverFrozenPins;
     }
   }
 
   inline void endFreeze() {
     if (this->frozenCounter > 0) {
       --this->frozenCounter;
+    } else if (this->frozenCounter < 0 && this->foreverFrozenPins > 0) {
+      --this->foreverFrozenPins;
+    }
+  }
+
+  /**
+   * Releases the memory mapped file of a bitmap created with mapFile, the bitmap becomes empty and stays frozen.
+   * Returns false if the bitmap is in use by an async operation.
+   */
+  bool releaseMappedFile() {
+    if (this->mappedFile == nullptr) {
+      return true;
+    }
+    if (this->foreverFrozenPins != 0) {
+      return false;
+    }
+    roaring_bitmap_t * empty = roaring_bitmap_create();
+    if (empty == nullptr) {
+      return false;
     }
+    roaring_bitmap_free(this->roaring);
+    this->roaring = empty;
+    munmap(this->mappedFile, this->mappedFileSize);
+    this->mappedFile = nullptr;
+    this->mappedFileSize = 0;
+    this->invalidate();
+    return true;
   }
 
   inline int64_t getVersion() const { return this->_version; }
 
-  inline void invalidate() {
-    this->sizeCache = -1;
+  inline void invalidate() { this->invalidate(-1); }
+
+  /** Marks the bitmap as changed, caching its new size, or -1 if the size is not known. */
+  inline void invalidate(int64_t newSize) {
+    this->sizeCache = newSize;
     ++this->_version;
   }
 
+  /** Marks the bitmap as changed by a mutation that changed the size by delta. The cached size stays valid. */
+  inline void invalidateAddingToSize(int64_t delta) {
+    const int64_t size = this->sizeCache;
+    this->invalidate(size >= 0 ? size + delta : -1);
+  }
+
   inline bool roaring_bitmap_t_is_frozen(const roaring_bitmap_t * r) {
     return r->high_low_container.flags & ROARING_FLAG_FROZEN;
   }
@@ -11311,7 +11594,10 @@ class RoaringBitmap32 final : public ObjectWrap {
     roaring(readonlyViewOf->roaring),
     sizeCache(-1),
     frozenCounter(RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN),
-    readonlyViewOf(readonlyViewOf->readonlyViewOf ? readonlyViewOf->readonlyViewOf : readonlyViewOf) {
+    readonlyViewOf(readonlyViewOf->readonlyViewOf ? readonlyViewOf->readonlyViewOf : readonlyViewOf),
+    mappedFile(nullptr),
+    mappedFileSize(0),
+    foreverFrozenPins(0) {
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32));
   }
 
@@ -11321,7 +11607,10 @@ class RoaringBitmap32 final : public ObjectWrap {
     sizeCache(0),
     _version(0),
     frozenCounter(0),
-    readonlyViewOf(nullptr) {
+    readonlyViewOf(nullptr),
+    mappedFile(nullptr),
+    mappedFileSize(0),
+    foreverFrozenPins(0) {
     ++addonData->RoaringBitmap32_instances;
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32));
   }
@@ -11336,6 +11625,9 @@ class RoaringBitmap32 final : public ObjectWrap {
       if (this->frozenStorage.data != nullptr && this->frozenStorage.length == std::numeric_limits<size_t>::max()) {
         gcaware_aligned_free(this->isolate, this->frozenStorage.data);
       }
+      if (this->mappedFile != nullptr) {
+        munmap(this->mappedFile, this->mappedFileSize);
+      }
     }
     if (!this->persistent.IsEmpty()) {
       this->persistent.ClearWeak();
@@ -11343,1047 +11635,1515 @@ class RoaringBitmap32 final : public ObjectWrap {
   }
 };
 
-#endif
+/**
+ * Strong references to the bitmaps read by an asynchronous operation, and to the owners of readonly views.
+ * Worker threads use raw pointers, the caller may drop every reference to the bitmaps before the operation completes.
+ */
+class RoaringBitmap32Pins final {
+ public:
+  void pin(v8::Isolate * isolate, const RoaringBitmap32 * bitmap) {
+    this->_pins.emplace_back(isolate, bitmap->persistent.Get(isolate));
+    if (bitmap->readonlyViewOf != nullptr) {
+      this->_pins.emplace_back(isolate, bitmap->readonlyViewOf->persistent.Get(isolate));
+    }
+  }
 
-#line 1 "src/cpp/RoaringBitmap32-ops.h"
-#ifndef ROARING_NODE_ROARINGBITMAP32_OPS_
-#define ROARING_NODE_ROARINGBITMAP32_OPS_
+ private:
+  std::vector<v8::Global<v8::Object>> _pins;
+};
 
-#line 5 "src/cpp/RoaringBitmap32-ops.h"
+/** Sorts the given bitmaps by cardinality, smallest first, using the cached size. */
+inline void roaringSortBySize(RoaringBitmap32 ** bitmaps, size_t count) {
+  std::stable_sort(
+    bitmaps, bitmaps + count, [](const RoaringBitmap32 * a, const RoaringBitmap32 * b) { return a->getSize() < b->getSize(); });
+}
 
-inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Local<v8::Value> arg, bool replace = false) {
-  if (self->isFrozen()) {
-    v8utils::throwError(isolate, ERROR_FROZEN);
-    return false;
+/** Sorts the given roaring bitmaps by cardinality, smallest first. */
+inline void roaringSortByCardinality(const roaring_bitmap_t ** bitmaps, size_t count) {
+  if (count < 2) {
+    return;
   }
+  std::vector<std::pair<uint64_t, const roaring_bitmap_t *>> sorted(count);
+  for (size_t i = 0; i != count; ++i) {
+    sorted[i] = {roaring_bitmap_get_cardinality(bitmaps[i]), bitmaps[i]};
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto & a, const auto & b) { return a.first < b.first; });
+  for (size_t i = 0; i != count; ++i) {
+    bitmaps[i] = sorted[i].second;
+  }
+}
 
-  if (arg.IsEmpty()) {
-    return false;
+/**
+ * Intersects the given bitmaps into a new bitmap.
+ * The bitmaps should be sorted by cardinality, smallest first: the running result never grows,
+ * so starting from the smallest keeps every step cheap, and the loop stops as soon as the result is empty.
+ */
+roaring_bitmap_t * roaringAndMany(size_t count, const roaring_bitmap_t ** x) {
+  if (count == 0) {
+    return roaring_bitmap_create();
+  }
+  if (count == 1) {
+    return roaring_bitmap_copy(x[0]);
   }
+  roaring_bitmap_t * r = roaring_bitmap_and(x[0], x[1]);
+  for (size_t i = 2; r != nullptr && i < count && !roaring_bitmap_is_empty(r); ++i) {
+    roaring_bitmap_and_inplace(r, x[i]);
+  }
+  return r;
+}
 
-  if (arg->IsNullOrUndefined()) {
-    if (replace && self->roaring->high_low_container.containers != nullptr) {
-      roaring_bitmap_clear(self->roaring);
-    }
-    return true;
+/**
+ * A bitset container on the stack, used to combine the containers with the same key without allocating.
+ * The croaring bitset functions are used, they dispatch at runtime to the vectorized versions.
+ */
+struct RoaringScratchBitset {
+  alignas(64) uint64_t words[roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS];
+  roaring::internal::bitset_container_t bitset;
+
+  RoaringScratchBitset() {
+    this->bitset.cardinality = roaring::internal::BITSET_UNKNOWN_CARDINALITY;
+    this->bitset.words = this->words;
   }
 
-  if (!arg->IsObject()) {
+  inline void clear() { memset(this->words, 0, sizeof(this->words)); }
+
+  inline uint64_t cardinality() const { return (uint64_t)roaring::internal::bitset_container_compute_cardinality(&this->bitset); }
+
+  /** Adds the values of a container. Returns true if the bitset is known to be full. */
+  bool orContainer(const roaring::internal::container_t * c, uint8_t typecode) {
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    switch (typecode) {
+      case BITSET_CONTAINER_TYPE:
+        // Computing the cardinality while merging is almost free, and allows to stop as soon as the union is full.
+        return roaring::internal::bitset_container_or(
+                 &this->bitset, (const roaring::internal::bitset_container_t *)c, &this->bitset) == (1 << 16);
+      case RUN_CONTAINER_TYPE: {
+        const auto * rc = (const roaring::internal::run_container_t *)c;
+        for (int32_t i = 0; i != rc->n_runs; ++i) {
+          roaring::internal::bitset_set_lenrange(this->words, rc->runs[i].value, rc->runs[i].length);
+        }
+        break;
+      }
+      default: {
+        const auto * ac = (const roaring::internal::array_container_t *)c;
+        roaring::internal::bitset_set_list(this->words, ac->array, (uint64_t)ac->cardinality);
+        break;
+      }
+    }
     return false;
   }
 
-  if (arg->IsUint32Array() || arg->IsInt32Array() || arg->IsArrayBuffer() || arg->IsSharedArrayBuffer()) {
-    if (replace && self->roaring->high_low_container.containers != nullptr) {
-      roaring_bitmap_clear(self->roaring);
+  /** Removes the values that are not in a bitset or run container. Returns true if the bitset is known to be empty. */
+  bool andContainer(const roaring::internal::container_t * c, uint8_t typecode) {
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    if (typecode == BITSET_CONTAINER_TYPE) {
+      return roaring::internal::bitset_container_and(
+               &this->bitset, (const roaring::internal::bitset_container_t *)c, &this->bitset) == 0;
     }
-    const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
-    roaring_bitmap_add_many(self->roaring, typedArray.length, typedArray.data);
-    self->invalidate();
-    return true;
+    const auto * rc = (const roaring::internal::run_container_t *)c;
+    uint32_t start = 0;
+    for (int32_t i = 0; i != rc->n_runs; ++i) {
+      roaring::internal::bitset_reset_range(this->words, start, rc->runs[i].value);
+      start = (uint32_t)rc->runs[i].value + rc->runs[i].length + 1;
+    }
+    roaring::internal::bitset_reset_range(this->words, start, 1 << 16);
+    return false;
   }
+};
 
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
-  if (other != nullptr) {
-    if (self != other) {
-      if (replace || self->roaring->high_low_container.containers == nullptr) {
-        roaring_bitmap_overwrite(self->roaring, other->roaring);
-      } else {
-        roaring_bitmap_or_inplace(self->roaring, other->roaring);
+/** Keeps only the sorted values that are in the given container. Returns the number of values kept. */
+inline int32_t roaringContainerFilterValues(
+  const roaring::internal::container_t * c, uint8_t typecode, uint16_t * values, int32_t count) {
+  c = roaring::internal::container_unwrap_shared(c, &typecode);
+  int32_t kept = 0;
+  switch (typecode) {
+    case BITSET_CONTAINER_TYPE: {
+      const uint64_t * words = ((const roaring::internal::bitset_container_t *)c)->words;
+      for (int32_t i = 0; i != count; ++i) {
+        const uint16_t v = values[i];
+        values[kept] = v;
+        kept += (int32_t)((words[v >> 6] >> (v & 63)) & 1);
       }
-      self->invalidate();
+      break;
+    }
+    case RUN_CONTAINER_TYPE: {
+      const auto * rc = (const roaring::internal::run_container_t *)c;
+      int32_t r = 0;
+      for (int32_t i = 0; i != count; ++i) {
+        const uint16_t v = values[i];
+        while (r != rc->n_runs && (uint32_t)rc->runs[r].value + rc->runs[r].length < v) {
+          ++r;
+        }
+        if (r == rc->n_runs) {
+          break;
+        }
+        values[kept] = v;
+        kept += (int32_t)(v >= rc->runs[r].value);
+      }
+      break;
+    }
+    default: {
+      // Wraps the values in an array container, to use the vectorized in place intersection of croaring.
+      roaring::internal::array_container_t candidates;
+      candidates.cardinality = count;
+      candidates.capacity = count;
+      candidates.array = values;
+      roaring::internal::array_container_intersection_inplace(&candidates, (const roaring::internal::array_container_t *)c);
+      kept = candidates.cardinality;
+      break;
     }
-    return true;
-  }
-
-  AddonData * addonData = self->addonData;
-
-  v8::Local<v8::Value> argv[] = {arg};
-  auto tMaybe = addonData->Uint32Array_from.Get(isolate)->Call(
-    isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
-  v8::Local<v8::Value> t;
-  if (!tMaybe.ToLocal(&t)) return false;
-
-  const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, t);
-  if (replace) {
-    roaring_bitmap_clear(self->roaring);
   }
-  roaring_bitmap_add_many(self->roaring, typedArray.length, typedArray.data);
-  self->invalidate();
-  return true;
-}
-
-void RoaringBitmap32_andCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_and_cardinality(self->roaring, other->roaring) : -1);
-}
-
-void RoaringBitmap32_orCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_or_cardinality(self->roaring, other->roaring) : -1);
-}
-
-void RoaringBitmap32_andNotCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_andnot_cardinality(self->roaring, other->roaring) : -1);
+  return kept;
 }
 
-void RoaringBitmap32_xorCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  if (self == nullptr) {
-    return info.GetReturnValue().Set(0);
+/**
+ * Computes the cardinality of the union of the given bitmaps, only for the keys (high 16 bits) in [keyBegin, keyEnd).
+ * The containers with the same key are combined in a scratch bitset and counted, no container is allocated.
+ * Returns false if the allocation of the cursors failed.
+ */
+inline bool roaringOrManyCardinality(
+  const roaring_bitmap_t ** x, size_t count, uint64_t & result, uint32_t keyBegin = 0, uint32_t keyEnd = 1 << 16) {
+  result = 0;
+  if (count == 0) {
+    return true;
   }
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_xor_cardinality(self->roaring, other->roaring) : -1);
-}
-
-void RoaringBitmap32_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  auto isolate = info.GetIsolate();
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  auto * positions = (int32_t *)gcaware_malloc(count * (sizeof(int32_t) + sizeof(uint32_t)));
+  if (positions == nullptr) {
+    return false;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+  auto * matching = (uint32_t *)(positions + count);
+  for (size_t i = 0; i != count; ++i) {
+    positions[i] = keyBegin == 0 ? 0 : roaring::internal::ra_advance_until(&x[i]->high_low_container, (uint16_t)keyBegin, -1);
   }
 
-  info.GetReturnValue().Set(info.This());
+  RoaringScratchBitset scratch;
+  uint64_t total = 0;
+  for (;;) {
+    uint32_t key = keyEnd;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      if (positions[i] < ra.size && ra.keys[positions[i]] < key) {
+        key = ra.keys[positions[i]];
+      }
+    }
+    if (key >= keyEnd) {
+      break;
+    }
 
-  bool changed = false;
-  auto roaring = self->roaring;
-  int len = info.Length();
-  auto context = isolate->GetCurrentContext();
-  uint32_t v = 0;
-  for (int i = 0; i < len; ++i) {
-    auto arg = info[i];
-    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
-      continue;
+    size_t n = 0;
+    bool full = false;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const int32_t p = positions[i];
+      if (p < ra.size && ra.keys[p] == key) {
+        matching[n++] = (uint32_t)i;
+        full = full || roaring::internal::container_is_full(ra.containers[p], ra.typecodes[p]);
+      }
     }
-    if (roaring_bitmap_add_checked(roaring, v)) {
-      changed = true;
+
+    const roaring_array_t & ra0 = x[matching[0]]->high_low_container;
+    const int32_t p0 = positions[matching[0]];
+    if (full) {
+      total += 1 << 16;
+    } else if (n == 1) {
+      total += (uint64_t)roaring::internal::container_get_cardinality(ra0.containers[p0], ra0.typecodes[p0]);
+    } else if (n == 2) {
+      const roaring_array_t & ra1 = x[matching[1]]->high_low_container;
+      const int32_t p1 = positions[matching[1]];
+      total += (uint64_t)(roaring::internal::container_get_cardinality(ra0.containers[p0], ra0.typecodes[p0]) +
+                          roaring::internal::container_get_cardinality(ra1.containers[p1], ra1.typecodes[p1]) -
+                          roaring::internal::container_and_cardinality(
+                            ra0.containers[p0], ra0.typecodes[p0], ra1.containers[p1], ra1.typecodes[p1]));
+    } else {
+      scratch.clear();
+      bool filled = false;
+      for (size_t j = 0; j != n && !filled; ++j) {
+        const roaring_array_t & ra = x[matching[j]]->high_low_container;
+        const int32_t p = positions[matching[j]];
+        filled = scratch.orContainer(ra.containers[p], ra.typecodes[p]);
+      }
+      total += filled ? 1 << 16 : scratch.cardinality();
+    }
+
+    for (size_t j = 0; j != n; ++j) {
+      ++positions[matching[j]];
     }
   }
-  if (changed) {
-    self->invalidate();
-  }
+
+  gcaware_free(positions);
+  result = total;
+  return true;
 }
 
-void RoaringBitmap32_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+/**
+ * Computes the cardinality of the intersection of the given bitmaps, only for the keys (high 16 bits) in [keyBegin, keyEnd).
+ * The bitmaps should be sorted by cardinality, smallest first: only the keys of the first bitmap are visited.
+ * The containers with the same key are intersected in a scratch buffer and counted, no container is allocated.
+ * Returns false if the allocation of the cursors failed.
+ */
+inline bool roaringAndManyCardinality(
+  const roaring_bitmap_t ** x, size_t count, uint64_t & result, uint32_t keyBegin = 0, uint32_t keyEnd = 1 << 16) {
+  result = 0;
+  if (count == 0) {
+    return true;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+  auto * positions = (int32_t *)gcaware_malloc(count * sizeof(int32_t));
+  if (positions == nullptr) {
+    return false;
   }
+  for (size_t i = 0; i != count; ++i) {
+    positions[i] = -1;
+  }
+
+  RoaringScratchBitset scratch;
+  uint16_t values[roaring::internal::DEFAULT_MAX_SIZE];
+  uint64_t total = 0;
+
+  const roaring_array_t & first = x[0]->high_low_container;
+  int32_t p = keyBegin == 0 ? 0 : roaring::internal::ra_advance_until(&first, (uint16_t)keyBegin, -1);
+  for (; p < first.size && first.keys[p] < keyEnd; ++p) {
+    const uint16_t key = first.keys[p];
+
+    // Finds the container with the same key in every other bitmap, and the smallest array container to start from.
+    bool found = true;
+    size_t smallestArray = SIZE_MAX;
+    int32_t smallestArrayCardinality = INT32_MAX;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const int32_t q = i == 0 ? p : roaring::internal::ra_advance_until(&ra, key, positions[i]);
+      if (q >= ra.size) {
+        // No more keys in this bitmap, nothing else can intersect.
+        gcaware_free(positions);
+        result = total;
+        return true;
+      }
+      if (ra.keys[q] != key) {
+        positions[i] = q - 1;
+        found = false;
+        break;
+      }
+      positions[i] = q;
+      uint8_t typecode = ra.typecodes[q];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra.containers[q], &typecode);
+      if (typecode == ARRAY_CONTAINER_TYPE) {
+        const int32_t cardinality = ((const roaring::internal::array_container_t *)c)->cardinality;
+        if (cardinality < smallestArrayCardinality) {
+          smallestArrayCardinality = cardinality;
+          smallestArray = i;
+        }
+      }
+    }
+    if (!found) {
+      continue;
+    }
 
-  bool changed = false;
-  auto roaring = self->roaring;
-  uint32_t v = 0;
-  int len = info.Length();
-  auto context = isolate->GetCurrentContext();
-  for (int i = 0; i < len; ++i) {
-    auto arg = info[i];
-    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+    if (count == 1) {
+      total += (uint64_t)roaring::internal::container_get_cardinality(first.containers[p], first.typecodes[p]);
       continue;
     }
-    if (roaring_bitmap_add_checked(roaring, v)) {
-      changed = true;
+    if (count == 2) {
+      const roaring_array_t & ra1 = x[1]->high_low_container;
+      total += (uint64_t)roaring::internal::container_and_cardinality(
+        first.containers[p], first.typecodes[p], ra1.containers[positions[1]], ra1.typecodes[positions[1]]);
+      continue;
     }
-  }
-  if (changed) {
-    self->invalidate();
-  }
-  info.GetReturnValue().Set(changed);
-}
 
-void RoaringBitmap32_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
-  }
-  bool changed = false;
-  auto roaring = self->roaring;
-  uint32_t v = 0;
-  int len = info.Length();
-  auto context = isolate->GetCurrentContext();
-  for (int i = 0; i < len; ++i) {
-    auto arg = info[i];
-    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+    if (smallestArray != SIZE_MAX) {
+      // Filters the values of the smallest array container through all the other containers.
+      const roaring_array_t & base = x[smallestArray]->high_low_container;
+      uint8_t typecode = base.typecodes[positions[smallestArray]];
+      const auto * ac = (const roaring::internal::array_container_t *)roaring::internal::container_unwrap_shared(
+        base.containers[positions[smallestArray]], &typecode);
+      int32_t n = ac->cardinality;
+      memcpy(values, ac->array, n * sizeof(uint16_t));
+      for (size_t i = 0; i != count && n != 0; ++i) {
+        if (i != smallestArray) {
+          const roaring_array_t & ra = x[i]->high_low_container;
+          n = roaringContainerFilterValues(ra.containers[positions[i]], ra.typecodes[positions[i]], values, n);
+        }
+      }
+      total += (uint64_t)n;
       continue;
     }
-    if (roaring_bitmap_remove_checked(roaring, v)) {
-      changed = true;
+
+    // Only bitset and run containers, full containers do not change the intersection.
+    bool initialized = false;
+    bool emptied = false;
+    for (size_t i = 0; i != count && !emptied; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const roaring::internal::container_t * c = ra.containers[positions[i]];
+      const uint8_t typecode = ra.typecodes[positions[i]];
+      if (roaring::internal::container_is_full(c, typecode)) {
+        continue;
+      }
+      if (!initialized) {
+        scratch.clear();
+        scratch.orContainer(c, typecode);
+        initialized = true;
+      } else {
+        emptied = scratch.andContainer(c, typecode);
+      }
     }
+    total += emptied ? 0 : initialized ? scratch.cardinality() : 1 << 16;
   }
-  if (changed) {
-    self->invalidate();
-  }
-  info.GetReturnValue().Set(changed);
+
+  gcaware_free(positions);
+  result = total;
+  return true;
 }
 
-void RoaringBitmap32_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  auto isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+/**
+ * Checks the presence of many values, writing 1 or 0 for each value in output.
+ * The bulk context caches the last container, so lookups of close values skip the container search.
+ * Returns the number of values found.
+ */
+inline size_t roaringHasMany(const roaring_bitmap_t * r, const uint32_t * values, size_t count, uint8_t * output) {
+  roaring_bulk_context_t context;
+  memset(&context, 0, sizeof(context));
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const bool has = roaring_bitmap_contains_bulk(r, &context, values[i]);
+    output[i] = has;
+    found += has;
   }
-  if (info.Length() > 0) {
-    self->invalidate();
-    if (roaringAddMany(isolate, self, info[0])) {
-      return info.GetReturnValue().Set(info.This());
+  return found;
+}
+
+/**
+ * Checks the presence of many values, writing a packed bitset in output: bit i is set if values[i] is present.
+ * Output words are overwritten, the bits after count in the last word are cleared.
+ * Returns the number of values found.
+ */
+inline size_t roaringHasManyBits(const roaring_bitmap_t * r, const uint32_t * values, size_t count, uint32_t * output) {
+  roaring_bulk_context_t context;
+  memset(&context, 0, sizeof(context));
+  size_t found = 0;
+  for (size_t i = 0; i < count; i += 32) {
+    const size_t n = count - i < 32 ? count - i : 32;
+    uint32_t word = 0;
+    for (size_t j = 0; j < n; ++j) {
+      word |= (uint32_t)roaring_bitmap_contains_bulk(r, &context, values[i + j]) << j;
     }
+    output[i >> 5] = word;
+    found += roaring_hamming(word);
   }
-  v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+  return found;
 }
 
-void RoaringBitmap32_pop(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+/**
+ * Returns the positions of the values sorted by value, or nullptr if the values are already sorted.
+ * Sets failed to true if the allocation failed.
+ */
+inline uint32_t * roaringSortedOrder(const uint32_t * values, size_t count, bool & failed) {
+  failed = false;
+  size_t i = 1;
+  while (i < count && values[i - 1] <= values[i]) {
+    ++i;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+  if (i >= count) {
+    return nullptr;
   }
-  uint32_t v = roaring_bitmap_maximum(self->roaring);
-  bool result = roaring_bitmap_remove_checked(self->roaring, v);
-  if (result) {
-    self->invalidate();
-    info.GetReturnValue().Set(v);
+  uint32_t * order = (uint32_t *)gcaware_malloc(count * sizeof(uint32_t));
+  if (order == nullptr) {
+    failed = true;
+    return nullptr;
+  }
+  for (size_t k = 0; k < count; ++k) {
+    order[k] = (uint32_t)k;
   }
+  std::stable_sort(order, order + count, [values](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+  return order;
 }
 
-void RoaringBitmap32_shift(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  auto isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+/**
+ * Computes the rank of many values, sorted or not, with a single merged pass over the containers.
+ * Returns false if the allocation failed.
+ */
+template <typename T>
+bool roaringRankMany(const roaring_bitmap_t * r, const uint32_t * values, size_t count, T * output) {
+  if (count == 0) {
+    return true;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+  bool failed;
+  uint32_t * order = roaringSortedOrder(values, count, failed);
+  if (failed) {
+    return false;
   }
-  uint32_t v = roaring_bitmap_minimum(self->roaring);
-  bool result = roaring_bitmap_remove_checked(self->roaring, v);
-  if (result) {
-    self->invalidate();
-    info.GetReturnValue().Set(v);
+  uint64_t * ranks = (uint64_t *)gcaware_malloc(count * sizeof(uint64_t));
+  uint32_t * sorted = order != nullptr ? (uint32_t *)gcaware_malloc(count * sizeof(uint32_t)) : nullptr;
+  if (ranks == nullptr || (order != nullptr && sorted == nullptr)) {
+    gcaware_free(ranks);
+    gcaware_free(sorted);
+    gcaware_free(order);
+    return false;
   }
-}
-
-void RoaringBitmap32_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return info.GetReturnValue().Set(false);
+  if (order != nullptr) {
+    for (size_t i = 0; i < count; ++i) {
+      sorted[i] = values[order[i]];
+    }
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+
+  // roaring_bitmap_rank_many stops at the last container, values after it have the rank of the whole set.
+  const uint64_t cardinality = roaring_bitmap_get_cardinality(r);
+  for (size_t i = 0; i < count; ++i) {
+    ranks[i] = cardinality;
   }
-  if (self->roaring && self->roaring->high_low_container.size == 0) {
-    info.GetReturnValue().Set(false);
+  const uint32_t * begin = order != nullptr ? sorted : values;
+  roaring_bitmap_rank_many(r, begin, begin + count, ranks);
+
+  if (order != nullptr) {
+    for (size_t i = 0; i < count; ++i) {
+      output[order[i]] = (T)ranks[i];
+    }
   } else {
-    if (self->roaring != nullptr) {
-      roaring_bitmap_clear(self->roaring);
-      roaring_bitmap_shrink_to_fit(self->roaring);
-      self->invalidate();
+    for (size_t i = 0; i < count; ++i) {
+      output[i] = (T)ranks[i];
     }
-    info.GetReturnValue().Set(true);
   }
+
+  gcaware_free(ranks);
+  gcaware_free(sorted);
+  gcaware_free(order);
+  return true;
 }
 
-void RoaringBitmap32_removeMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  bool done = false;
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+/**
+ * Selects the values at many ranks, sorted or not, walking the containers once and accumulating their cardinality.
+ * Ranks out of range are set to missing. Returns false if the allocation failed.
+ */
+template <typename T>
+bool roaringSelectMany(const roaring_bitmap_t * r, const uint32_t * ranks, size_t count, T * output, T missing) {
+  if (count == 0) {
+    return true;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
+  bool failed;
+  uint32_t * order = roaringSortedOrder(ranks, count, failed);
+  if (failed) {
+    return false;
   }
 
-  if (info.Length() > 0) {
-    auto const & arg = info[0];
+  const roaring_array_t * ra = &r->high_low_container;
+  int32_t containerIndex = 0;
+  uint32_t startRank = 0;
+  for (size_t k = 0; k < count; ++k) {
+    const size_t i = order != nullptr ? order[k] : k;
+    const uint32_t rank = ranks[i];
+    uint32_t element = 0;
+    bool found = false;
+    while (containerIndex < ra->size) {
+      // container_select adds the container cardinality to the start rank when the rank is not in the container.
+      uint32_t nextStartRank = startRank;
+      if (roaring::internal::container_select(
+            ra->containers[containerIndex], ra->typecodes[containerIndex], &nextStartRank, rank, &element)) {
+        element |= (uint32_t)ra->keys[containerIndex] << 16;
+        found = true;
+        break;
+      }
+      startRank = nextStartRank;
+      ++containerIndex;
+    }
+    output[i] = found ? (T)element : missing;
+  }
 
-    if (arg->IsUint32Array() || arg->IsInt32Array()) {
-      const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
-      roaring_bitmap_remove_many(self->roaring, typedArray.length, typedArray.data);
-      self->invalidate();
-      done = true;
-    } else {
-      AddonData * addonData = self->addonData;
-      RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
-      if (other != nullptr) {
-        roaring_bitmap_andnot_inplace(self->roaring, other->roaring);
-        self->invalidate();
-        done = true;
-      } else {
-        v8::Local<v8::Value> argv[] = {arg};
-        auto tMaybe = addonData->Uint32Array_from.Get(isolate)->Call(
-          isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
-        v8::Local<v8::Value> t;
-        if (tMaybe.ToLocal(&t)) {
-          const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, t);
-          roaring_bitmap_remove_many(self->roaring, typedArray.length, typedArray.data);
-          self->invalidate();
-          done = true;
-        } else {
-          RoaringBitmap32 tmp(addonData, 0U);
-          if (roaringAddMany(isolate, &tmp, arg)) {
-            roaring_bitmap_andnot_inplace(self->roaring, tmp.roaring);
-            self->invalidate();
-            done = true;
-          }
+  gcaware_free(order);
+  return true;
+}
+
+/**
+ * Positions the iterator on the last value of the container at it->container_index,
+ * the same as roaring_uint32_iterator_previous does when it moves to the previous container.
+ */
+inline bool roaringIteratorLoadLast(roaring_uint32_iterator_t * it) {
+  const roaring_array_t * ra = &it->parent->high_low_container;
+  if (it->container_index < 0 || it->container_index >= ra->size) {
+    return (it->has_value = false);
+  }
+  uint8_t typecode = ra->typecodes[it->container_index];
+  it->container = roaring::internal::container_unwrap_shared(ra->containers[it->container_index], &typecode);
+  it->typecode = typecode;
+  it->highbits = (uint32_t)ra->keys[it->container_index] << 16;
+  uint16_t low16 = 0;
+  it->container_it = roaring::internal::container_init_iterator_last(it->container, it->typecode, &low16);
+  it->current_value = it->highbits | low16;
+  return (it->has_value = true);
+}
+
+/**
+ * Copies up to count values of a container in descending order, starting from the iterator position.
+ * Returns true and updates the position if the container still has values.
+ */
+inline bool roaringContainerReadReverse(
+  const roaring::internal::container_t * c,
+  uint8_t typecode,
+  roaring::internal::roaring_container_iterator_t * cit,
+  uint32_t highbits,
+  uint32_t * buf,
+  uint32_t count,
+  uint32_t * consumed,
+  uint16_t * low16) {
+  uint32_t n = 0;
+  switch (typecode) {
+    case BITSET_CONTAINER_TYPE: {
+      const uint64_t * words = ((const roaring::internal::bitset_container_t *)c)->words;
+      int32_t wordindex = cit->index / 64;
+      uint64_t word = words[wordindex] & (UINT64_MAX >> (63 - (cit->index % 64)));
+      for (;;) {
+        while (word != 0 && n < count) {
+          const uint32_t bit = 63 - roaring_leading_zeroes(word);
+          buf[n++] = highbits | ((uint32_t)wordindex * 64 + bit);
+          word ^= (uint64_t)1 << bit;
+        }
+        if (n >= count) {
+          break;
+        }
+        if (wordindex == 0) {
+          break;
+        }
+        word = words[--wordindex];
+      }
+      *consumed = n;
+      if (word == 0) {
+        while (wordindex > 0 && (word = words[--wordindex]) == 0) {
+        }
+        if (word == 0) {
+          return false;
+        }
+      }
+      cit->index = wordindex * 64 + (63 - roaring_leading_zeroes(word));
+      *low16 = (uint16_t)cit->index;
+      return true;
+    }
+    case ARRAY_CONTAINER_TYPE: {
+      const uint16_t * array = ((const roaring::internal::array_container_t *)c)->array;
+      int32_t index = cit->index;
+      const uint32_t available = (uint32_t)index + 1;
+      n = available < count ? available : count;
+      for (uint32_t i = 0; i < n; ++i) {
+        buf[i] = highbits | array[index - (int32_t)i];
+      }
+      *consumed = n;
+      index -= (int32_t)n;
+      cit->index = index;
+      if (index < 0) {
+        return false;
+      }
+      *low16 = array[index];
+      return true;
+    }
+    case RUN_CONTAINER_TYPE: {
+      const roaring::internal::rle16_t * runs = ((const roaring::internal::run_container_t *)c)->runs;
+      int32_t index = cit->index;
+      uint32_t value = *low16;
+      while (n < count) {
+        const uint32_t start = runs[index].value;
+        const uint32_t available = value - start + 1;
+        const uint32_t toRead = available < count - n ? available : count - n;
+        for (uint32_t i = 0; i < toRead; ++i) {
+          buf[n + i] = highbits | (value - i);
+        }
+        n += toRead;
+        if (toRead < available) {
+          value -= toRead;
+          break;
+        }
+        if (--index < 0) {
+          break;
         }
+        value = (uint32_t)runs[index].value + runs[index].length;
+      }
+      *consumed = n;
+      cit->index = index;
+      if (index < 0) {
+        return false;
       }
+      *low16 = (uint16_t)value;
+      return true;
     }
-  }
-
-  if (done) {
-    info.GetReturnValue().Set(info.This());
-  } else {
-    v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+    default: *consumed = 0; return false;
   }
 }
 
-void RoaringBitmap32_andInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
-  }
-  if (info.Length() > 0) {
-    auto const & arg = info[0];
-    RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
-    if (other != nullptr) {
-      roaring_bitmap_and_inplace(self->roaring, other->roaring);
-      self->invalidate();
-      return info.GetReturnValue().Set(info.This());
-    }
-
-    RoaringBitmap32 tmp(self->addonData, 0U);
-    if (roaringAddMany(isolate, &tmp, arg)) {
-      roaring_bitmap_and_inplace(self->roaring, tmp.roaring);
-      self->invalidate();
-      return info.GetReturnValue().Set(info.This());
+/**
+ * Reads up to count values walking backwards from the current position of the iterator,
+ * the reverse of roaring_uint32_iterator_read. Returns the number of values read.
+ */
+inline uint32_t roaringIteratorReadReverse(roaring_uint32_iterator_t * it, uint32_t * buf, uint32_t count) {
+  uint32_t ret = 0;
+  while (it->has_value && ret < count) {
+    uint32_t consumed;
+    uint16_t low16 = (uint16_t)it->current_value;
+    const bool hasValue = roaringContainerReadReverse(
+      it->container, it->typecode, &it->container_it, it->highbits, buf + ret, count - ret, &consumed, &low16);
+    ret += consumed;
+    if (hasValue) {
+      it->current_value = it->highbits | low16;
+      return ret;
     }
+    --it->container_index;
+    roaringIteratorLoadLast(it);
   }
-
-  return v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+  return ret;
 }
 
-void RoaringBitmap32_xorInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
-  }
-  if (info.Length() > 0) {
-    auto const & arg = info[0];
-    RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
-    if (other != nullptr) {
-      roaring_bitmap_xor_inplace(self->roaring, other->roaring);
-      self->invalidate();
-      return info.GetReturnValue().Set(info.This());
-    }
+#endif
 
-    RoaringBitmap32 tmp(self->addonData, 0U);
-    roaringAddMany(info.GetIsolate(), &tmp, arg);
-    roaring_bitmap_xor_inplace(self->roaring, tmp.roaring);
-    self->invalidate();
-    return info.GetReturnValue().Set(info.This());
-  }
+#line 1 "src/cpp/RoaringBitmap32-ops.h"
+#ifndef ROARING_NODE_ROARINGBITMAP32_OPS_
+#define ROARING_NODE_ROARINGBITMAP32_OPS_
 
-  return v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
-}
+#line 1 "src/cpp/async-workers.h"
+#ifndef ROARING_NODE_ASYNC_WORKERS_
+#define ROARING_NODE_ASYNC_WORKERS_
 
-#endif  // ROARING_NODE_ROARINGBITMAP32_OPS_
+#line 1 "src/cpp/serialization.h"
+#ifndef ROARING_NODE_SERIALIZATION_
+#define ROARING_NODE_SERIALIZATION_
 
-#line 1 "src/cpp/RoaringBitmap32-static-ops.h"
-#ifndef ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
-#define ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
+#line 1 "src/cpp/serialization-csv.h"
+#ifndef ROARING_NODE_SERIALIZATION_CSV_
+#define ROARING_NODE_SERIALIZATION_CSV_
 
-#line 5 "src/cpp/RoaringBitmap32-static-ops.h"
+#line 5 "src/cpp/serialization-csv.h"
+#include <fcntl.h>
+#line 9 "src/cpp/serialization-csv.h"
 
-void RoaringBitmap32_addOffsetStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+struct CsvFileDescriptorSerializer final {
+ public:
+  static int iterate(const roaring::api::roaring_bitmap_t * r, int fd, FileSerializationFormat format) {
+    char separator;
+    switch (format) {
+      case FileSerializationFormat::newline_separated_values: separator = '\n'; break;
+      case FileSerializationFormat::comma_separated_values: separator = ','; break;
+      case FileSerializationFormat::tab_separated_values: separator = '\t'; break;
+      case FileSerializationFormat::json_array: separator = ','; break;
+      default: return EINVAL;
+    }
 
-  if (info.Length() < 2) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset expects 2 arguments");
-  }
+    CsvFileDescriptorSerializer writer(fd, separator);
+    if (!writer.buf) {
+      return ENOMEM;
+    }
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr)
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset first argument must be a RoaringBitmap32");
+    if (format == FileSerializationFormat::json_array) {
+      writer.appendChar('[');
+    }
 
-  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+    if (r && !writer.appendBitmap(r)) {
+      return writer.error();
+    }
 
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset failed to create new instance");
-  }
+    if (format == FileSerializationFormat::newline_separated_values) {
+      writer.appendChar('\n');
+    } else if (format == FileSerializationFormat::json_array) {
+      writer.appendChar(']');
+    }
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
-  }
+    if (!writer.flush()) {
+      return writer.error();
+    }
 
-  // Second argument is the offset, read as double
-  double offset = info[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(NAN);
-  if (std::isnan(offset)) {
-    offset = 0;
-  } else if (offset < -4294967296) {
-    offset = -4294967296;
-  } else if (offset > 4294967296) {
-    offset = 4294967296;
+    return 0;
   }
 
-  roaring_bitmap_t * r = roaring_bitmap_add_offset(a->roaring, (int64_t)offset);
-  if (r == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset failed materalization");
+  /** Number of decimal digits of a 32 bit unsigned integer. */
+  static inline uint32_t digitsCount(uint32_t value) {
+    if (value < 100000) {
+      return value < 100 ? (value < 10 ? 1 : 2) : (value < 1000 ? 3 : value < 10000 ? 4 : 5);
+    }
+    return value < 10000000 ? (value < 1000000 ? 6 : 7) : (value < 100000000 ? 8 : value < 1000000000 ? 9 : 10);
+  }
+
+  /**
+   * Writes the decimal representation of a 32 bit unsigned integer, two digits at a time from a lookup table.
+   * Returns the number of characters written, at most 10.
+   */
+  static inline uint32_t formatUint32(char * out, uint32_t value) {
+    static const char digitPairs[201] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+
+    const uint32_t length = digitsCount(value);
+    char * p = out + length;
+    while (value >= 100) {
+      const uint32_t pair = (value % 100) * 2;
+      value /= 100;
+      p -= 2;
+      p[0] = digitPairs[pair];
+      p[1] = digitPairs[pair + 1];
+    }
+    if (value >= 10) {
+      p -= 2;
+      p[0] = digitPairs[value * 2];
+      p[1] = digitPairs[value * 2 + 1];
+    } else {
+      *--p = (char)('0' + value);
+    }
+    return length;
   }
-  self->replaceBitmapInstance(isolate, r);
 
-  info.GetReturnValue().Set(result);
-}
+ private:
+  const constexpr static size_t BUFFER_SIZE = 1048576;
 
-void RoaringBitmap32_andStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+  /** Number of values read from the bitmap at a time. */
+  const constexpr static uint32_t BLOCK_SIZE = 2048;
 
-  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::and expects 2 arguments");
+  /** Maximum number of bytes a value takes, separator included. */
+  const constexpr static size_t MAX_VALUE_LENGTH = 11;
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::and first argument must be a RoaringBitmap32");
+  char * buf;
+  size_t bufPos;
+  int fd;
+  int errorno;
+  bool needsSeparator;
+  char separator;
 
-  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
-  if (b == nullptr)
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and second argument must be a RoaringBitmap32");
+  CsvFileDescriptorSerializer(int fd, char separator) :
+    buf((char *)gcaware_aligned_malloc(32, BUFFER_SIZE)),
+    bufPos(0),
+    fd(fd),
+    errorno(0),
+    needsSeparator(false),
+    separator(separator) {}
 
-  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+  ~CsvFileDescriptorSerializer() { gcaware_aligned_free(this->buf); }
 
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and failed to create new instance");
-  }
+  int error() const { return this->errorno ? this->errorno : EIO; }
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  bool flush() {
+    if (!this->buf) {
+      return false;
+    }
+    const char * p = this->buf;
+    size_t remaining = this->bufPos;
+    while (remaining != 0) {
+      ssize_t written = write(this->fd, p, remaining);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        this->errorno = errno;
+        errno = 0;
+        gcaware_aligned_free(this->buf);
+        this->buf = nullptr;
+        return false;
+      }
+      p += written;
+      remaining -= (size_t)written;
+    }
+    this->bufPos = 0;
+    return true;
   }
 
-  roaring_bitmap_t * r = roaring_bitmap_and(a->roaring, b->roaring);
-  if (r == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and failed materalization");
+  bool appendChar(char c) {
+    if (this->bufPos + 1 >= BUFFER_SIZE) {
+      if (!this->flush()) {
+        return false;
+      }
+    }
+    if (!this->buf) {
+      return false;
+    }
+    this->buf[this->bufPos++] = c;
+    return true;
   }
 
-  self->replaceBitmapInstance(isolate, r);
+  /**
+   * Appends all the values of the bitmap, reading them in blocks.
+   * Consecutive values, common in run containers, are formatted incrementing the previous decimal string
+   * instead of converting every value from scratch.
+   */
+  bool appendBitmap(const roaring::api::roaring_bitmap_t * r) {
+    uint32_t values[BLOCK_SIZE];
+    char last[MAX_VALUE_LENGTH];
+    uint32_t lastLength = 0;
+    uint32_t lastValue = 0;
 
-  info.GetReturnValue().Set(result);
-}
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(r, &it);
+    for (;;) {
+      const uint32_t count = roaring_uint32_iterator_read(&it, values, BLOCK_SIZE);
+      if (count == 0) {
+        break;
+      }
 
-void RoaringBitmap32_orStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+      if (this->bufPos + count * MAX_VALUE_LENGTH >= BUFFER_SIZE && !this->flush()) {
+        return false;
+      }
 
-  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::or expects 2 arguments");
+      char * out = this->buf + this->bufPos;
+      uint32_t i = 0;
+      if (!this->needsSeparator) {
+        this->needsSeparator = true;
+        lastValue = values[0];
+        lastLength = formatUint32(last, lastValue);
+        memcpy(out, last, lastLength);
+        out += lastLength;
+        i = 1;
+      }
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::or first argument must be a RoaringBitmap32");
-  }
+      const char separator = this->separator;
+      for (; i < count; ++i) {
+        const uint32_t value = values[i];
+        *out++ = separator;
+        if (value == lastValue + 1 && lastLength != 0) {
+          lastLength = incrementDecimal(last, lastLength);
+        } else {
+          lastLength = formatUint32(last, value);
+        }
+        lastValue = value;
+        memcpy(out, last, lastLength);
+        out += lastLength;
+      }
 
-  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
-  if (b == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::or second argument must be a RoaringBitmap32");
+      this->bufPos = (size_t)(out - this->buf);
+    }
+    return true;
   }
 
-  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+  /** Adds one to a decimal string in place, returns the new length. */
+  static inline uint32_t incrementDecimal(char * str, uint32_t length) {
+    uint32_t i = length;
+    while (i != 0) {
+      if (str[--i] != '9') {
+        ++str[i];
+        return length;
+      }
+      str[i] = '0';
+    }
+    // All nines, 999 + 1 = 1000
+    str[0] = '1';
+    str[length] = '0';
+    return length + 1;
+  }
+};
 
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) return;
+WorkerError deserializeRoaringCsvFile(
+  roaring::api::roaring_bitmap_t * r, int fd, const char * input, size_t input_size, const std::string & filePath) {
+  const constexpr static size_t BUFFER_SIZE = 131072;
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  char * buf;
+  ssize_t readBytes;
+  if (input == nullptr) {
+    buf = (char *)gcaware_aligned_malloc(32, BUFFER_SIZE);
+    if (!buf) {
+      return WorkerError("Failed to allocate memory for text deserialization");
+    }
+  } else {
+    buf = (char *)input;
+    readBytes = (ssize_t)input_size;
+    if (readBytes < 0) {
+      return WorkerError("Input too big");
+    }
+    if (readBytes == 0) {
+      return WorkerError();
+    }
   }
 
-  roaring_bitmap_t * r = roaring_bitmap_or(a->roaring, b->roaring);
-  if (r == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::or failed materalization");
-
-  self->replaceBitmapInstance(isolate, r);
+  roaring_bulk_context_t context;
+  memset(&context, 0, sizeof(context));
+  uint64_t value = 0;
 
-  info.GetReturnValue().Set(result);
-}
+  bool hasValue = false;
+  bool isNegative = false;
+  for (;;) {
+    if (input == nullptr) {
+      readBytes = read(fd, buf, BUFFER_SIZE);
+      if (readBytes <= 0) {
+        if (readBytes < 0) {
+          WorkerError err = WorkerError::from_errno("read", filePath);
+          gcaware_aligned_free(buf);
+          return err;
+        }
+        break;
+      }
+    }
 
-void RoaringBitmap32_xorStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+    for (ssize_t i = 0; i < readBytes; i++) {
+      char c = buf[i];
+      if (c >= '0' && c <= '9') {
+        if (value <= 0xffffffff) {
+          hasValue = true;
+          value = value * 10 + (c - '0');
+        }
+      } else {
+        if (hasValue) {
+          hasValue = false;
+          if (!isNegative && value <= 0xffffffff) {
+            roaring_bitmap_add_bulk(r, &context, value);
+          }
+        }
+        value = 0;
+        isNegative = c == '-';
+      }
+    }
 
-  if (info.Length() < 2) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor expects 2 arguments");
+    if (input != nullptr) {
+      break;
+    }
   }
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor first argument must be a RoaringBitmap32");
+  if (!isNegative && hasValue && value <= 0xffffffff) {
+    roaring_bitmap_add_bulk(r, &context, value);
   }
-
-  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
-  if (b == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor second argument must be a RoaringBitmap32");
+  if (input == nullptr) {
+    gcaware_aligned_free(buf);
   }
 
-  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
-
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) return;
+  return WorkerError();
+}
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+/**
+ * Parses the chunk [begin, end) of a text buffer, so a big text file can be split and parsed in parallel.
+ * A number belongs to the chunk that contains its first digit: the digits of a number that started in the
+ * previous chunk are skipped, and a number that continues past the end of the chunk is parsed entirely.
+ */
+WorkerError deserializeRoaringCsvChunk(
+  roaring::api::roaring_bitmap_t * r, const char * input, size_t inputSize, size_t begin, size_t end) {
+  if (end > inputSize) {
+    end = inputSize;
+  }
+  if (begin > 0 && input[begin - 1] >= '0' && input[begin - 1] <= '9') {
+    while (begin < end && input[begin] >= '0' && input[begin] <= '9') {
+      ++begin;
+    }
+  }
+  if (begin >= end) {
+    return WorkerError();
+  }
+  if (begin > 0 && input[begin - 1] == '-') {
+    --begin;  // Keep the sign of the first number
   }
+  while (end < inputSize && input[end] >= '0' && input[end] <= '9') {
+    ++end;
+  }
+  return deserializeRoaringCsvFile(r, -1, input + begin, end - begin, "");
+}
 
-  roaring_bitmap_t * r = roaring_bitmap_xor(a->roaring, b->roaring);
-  if (r == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor failed materalization");
+#endif
 
-  self->replaceBitmapInstance(isolate, r);
+#line 1 "src/cpp/serialization-pack.h"
+#ifndef ROARING_NODE_SERIALIZATION_PACK_
+#define ROARING_NODE_SERIALIZATION_PACK_
 
-  info.GetReturnValue().Set(result);
-}
+#line 6 "src/cpp/serialization-pack.h"
 
-void RoaringBitmap32_andNotStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#  include <io.h>
+#endif
 
-  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot expects 2 arguments");
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot first argument must be a RoaringBitmap32");
-  }
+/*
+ * Bitmap pack file layout, little endian:
+ *
+ *   RoaringBitmapPackHeader   32 bytes, magic "RBPK", version, body format and number of bitmaps
+ *   RoaringBitmapPackEntry[]  offset and length of each serialized bitmap, from the start of the file
+ *   bodies                    each bitmap serialized in the body format, every body starts at a 32 bytes boundary
+ *
+ * The offset table allows to read or to create a frozen view of a single bitmap without reading the whole file.
+ */
 
-  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
-  if (b == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot second argument must be a RoaringBitmap32");
-  }
+static const constexpr char ROARING_PACK_MAGIC[4] = {'R', 'B', 'P', 'K'};
+static const constexpr uint32_t ROARING_PACK_VERSION = 1;
+static const constexpr size_t ROARING_PACK_ALIGNMENT = 32;
 
-  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+enum class RoaringBitmapPackFormat : uint32_t {
+  INVALID = 0,
+  portable = 1,
+  unsafe_frozen_croaring = 2,
+};
 
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) return;
+struct RoaringBitmapPackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t format;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t reserved2;
+};
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
-  }
+struct RoaringBitmapPackEntry {
+  uint64_t offset;
+  uint64_t length;
+};
 
-  roaring_bitmap_t * r = roaring_bitmap_andnot(a->roaring, b->roaring);
-  if (r == nullptr) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot failed materalization");
-  }
+static_assert(sizeof(RoaringBitmapPackHeader) == 32, "RoaringBitmapPackHeader must be 32 bytes");
+static_assert(sizeof(RoaringBitmapPackEntry) == 16, "RoaringBitmapPackEntry must be 16 bytes");
 
-  self->replaceBitmapInstance(isolate, r);
+inline RoaringBitmapPackFormat tryParseRoaringBitmapPackFormat(const v8::Local<v8::Value> & value, v8::Isolate * isolate) {
+  switch (tryParseFileSerializationFormat(value, isolate)) {
+    case FileSerializationFormat::portable: return RoaringBitmapPackFormat::portable;
+    case FileSerializationFormat::unsafe_frozen_croaring: return RoaringBitmapPackFormat::unsafe_frozen_croaring;
+    default: return RoaringBitmapPackFormat::INVALID;
+  }
+}
 
-  info.GetReturnValue().Set(result);
+inline uint64_t roaringPackAlign(uint64_t offset) {
+  return (offset + (ROARING_PACK_ALIGNMENT - 1)) & ~(uint64_t)(ROARING_PACK_ALIGNMENT - 1);
 }
 
-template <typename TSize>
-void roaringOpMany(
-  const char * opName,
-  roaring_bitmap_t * op(TSize number, const roaring_bitmap_t ** x),
-  const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+/** Writes many bitmaps in a single pack file. */
+class RoaringBitmapPackFileSerializer final {
+ public:
+  std::string filePath;
+  RoaringBitmapPackFormat format = RoaringBitmapPackFormat::INVALID;
+  RoaringBitmap32 ** bitmaps = nullptr;
+  uint32_t count = 0;
+  v8::Isolate * isolate = nullptr;
 
-  int length = info.Length();
+  RoaringBitmapPackFileSerializer() = default;
+  RoaringBitmapPackFileSerializer(const RoaringBitmapPackFileSerializer &) = delete;
+  RoaringBitmapPackFileSerializer & operator=(const RoaringBitmapPackFileSerializer &) = delete;
 
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  ~RoaringBitmapPackFileSerializer() {
+    if (this->bitmaps != nullptr) {
+      gcaware_free(this->isolate, this->bitmaps);
+    }
   }
 
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
-
-  auto context = isolate->GetCurrentContext();
+  /** Parses (filePath, bitmaps, format). */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
 
-  if (length == 0) {
-    auto vMaybe = cons->NewInstance(context, 0, nullptr);
-    v8::Local<v8::Object> v;
-    if (vMaybe.ToLocal(&v)) {
-      info.GetReturnValue().Set(v);
+    if (info.Length() < 3) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects a file path, an array of bitmaps and a format");
+    }
+    if (!info[0]->IsString()) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects a file path as the first argument");
+    }
+    if (!info[1]->IsArray()) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects an array of RoaringBitmap32 as the second argument");
+    }
+    this->format = tryParseRoaringBitmapPackFormat(info[2], isolate);
+    if (this->format == RoaringBitmapPackFormat::INVALID) {
+      return WorkerError(
+        "RoaringBitmap32::serializePackFile format argument was invalid, only portable and unsafe_frozen_croaring are supported");
     }
-    return;
-  }
-
-  if (length == 1) {
-    if (info[0]->IsArray()) {
-      auto array = v8::Local<v8::Array>::Cast(info[0]);
 
-      size_t arrayLength = array->Length();
+    v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+    this->filePath = std::string(*filePathUtf8, filePathUtf8.length());
 
-      if (arrayLength == 0) {
-        auto vMaybe = cons->NewInstance(context, 0, nullptr);
-        v8::Local<v8::Object> v;
-        if (vMaybe.ToLocal(&v)) {
-          info.GetReturnValue().Set(v);
-        }
-        return;
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[1]);
+    const uint32_t length = array->Length();
+    if (length != 0) {
+      this->bitmaps = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      if (this->bitmaps == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile array can contain only RoaringBitmap32 instances");
       }
+      this->bitmaps[this->count++] = bitmap;
+    }
+    return WorkerError();
+  }
 
-      if (arrayLength == 1) {
-        auto itemMaybe = array->Get(context, 0);
+  /** Freezes the bitmaps, so they cannot be modified while written in another thread. */
+  void beginFreeze() {
+    for (uint32_t i = 0; i != this->count; ++i) {
+      this->owner(i)->beginFreeze();
+    }
+  }
 
-        v8::Local<v8::Value> item;
-        if (!itemMaybe.ToLocal(&item)) {
-          return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
-        }
+  void endFreeze() {
+    for (uint32_t i = 0; i != this->count; ++i) {
+      this->owner(i)->endFreeze();
+    }
+  }
 
-        v8::Local<v8::Value> argv[] = {item};
-        auto vMaybe = cons->NewInstance(context, 1, argv);
-        v8::Local<v8::Object> v;
-        if (vMaybe.ToLocal(&v)) {
-          info.GetReturnValue().Set(v);
-        }
-        return;
+  WorkerError serialize() {
+    const uint64_t tableEnd = sizeof(RoaringBitmapPackHeader) + (uint64_t)this->count * sizeof(RoaringBitmapPackEntry);
+    RoaringBitmapPackEntry * entries = nullptr;
+    if (this->count != 0) {
+      entries = (RoaringBitmapPackEntry *)gcaware_malloc(this->count * sizeof(RoaringBitmapPackEntry));
+      if (entries == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile failed to allocate memory");
       }
+    }
 
-      auto resultMaybe = cons->NewInstance(context, 0, nullptr);
-      v8::Local<v8::Object> result;
-      if (!resultMaybe.ToLocal(&result)) {
-        return;
-      }
+    uint64_t fileSize = tableEnd;
+    for (uint32_t i = 0; i != this->count; ++i) {
+      const roaring_bitmap_t * r = this->bitmaps[i]->roaring;
+      const uint64_t offset = roaringPackAlign(fileSize);
+      const uint64_t length = this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring
+        ? roaring_bitmap_frozen_size_in_bytes(r)
+        : roaring_bitmap_portable_size_in_bytes(r);
+      entries[i].offset = offset;
+      entries[i].length = length;
+      fileSize = offset + length;
+    }
 
-      auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-      if (!self) {
-        return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-      }
+    WorkerError err = this->writeFile(entries, (size_t)fileSize);
+    gcaware_free(this->isolate, entries);
+    return err;
+  }
 
-      const auto ** x = (const roaring_bitmap_t **)gcaware_malloc(arrayLength * sizeof(roaring_bitmap_t *));
-      if (x == nullptr) {
-        return v8utils::throwTypeError(isolate, opName, " failed allocation");
+ private:
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->bitmaps[index];
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  /** Writes the pack, data must be large enough for the last entry: the entries were computed from the bitmaps sizes. */
+  void serializeToBuffer(uint8_t * data, const RoaringBitmapPackEntry * entries) const {
+    RoaringBitmapPackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROARING_PACK_MAGIC, sizeof(header.magic));
+    header.version = ROARING_PACK_VERSION;
+    header.format = (uint32_t)this->format;
+    header.count = this->count;
+    memcpy(data, &header, sizeof(header));
+    if (this->count != 0) {
+      memcpy(data + sizeof(header), entries, this->count * sizeof(RoaringBitmapPackEntry));
+    }
+
+    size_t written = sizeof(header) + this->count * sizeof(RoaringBitmapPackEntry);
+    for (uint32_t i = 0; i != this->count; ++i) {
+      // Zero the alignment padding, the file may have been mapped over old content.
+      memset(data + written, 0, (size_t)entries[i].offset - written);
+      char * body = (char *)data + entries[i].offset;
+      if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+        roaring_bitmap_frozen_serialize(this->bitmaps[i]->roaring, body);
+      } else {
+        roaring_bitmap_portable_serialize(this->bitmaps[i]->roaring, body);
       }
+      written = (size_t)(entries[i].offset + entries[i].length);
+    }
+  }
 
-      for (size_t i = 0; i < arrayLength; ++i) {
-        v8::Local<v8::Value> item;
-        RoaringBitmap32 * p =
-          array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
-        if (p == nullptr) {
-          gcaware_free(isolate, x);
-          return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
-        }
-        x[i] = p->roaring;
-      }
-
-      roaring_bitmap_t * r = op((TSize)arrayLength, x);
-      gcaware_free(isolate, x);
-      if (r == nullptr) {
-        return v8utils::throwTypeError(isolate, opName, " failed roaring allocation");
-      }
-
-      self->replaceBitmapInstance(isolate, r);
-
-      info.GetReturnValue().Set(result);
+  WorkerError writeFile(const RoaringBitmapPackEntry * entries, size_t fileSize) {
+    int fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+    if (fd < 0) {
+      return WorkerError::from_errno("open", this->filePath);
+    }
 
-    } else {
-      v8::Local<v8::Value> argv[] = {info[0]};
-      auto vMaybe = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
-      v8::Local<v8::Object> v;
-      if (vMaybe.ToLocal(&v)) {
-        info.GetReturnValue().Set(v);
-      }
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    int truncateErr = _chsize_s(fd, fileSize);
+    if (truncateErr != 0) {
+      close(fd);
+      return WorkerError(truncateErr, "_chsize_s", this->filePath);
     }
-  } else {
-    v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-    v8::Local<v8::Object> result;
-    if (!resultMaybe.ToLocal(&result)) {
-      return;
+#else
+    if (ftruncate(fd, fileSize) < 0) {
+      WorkerError err = WorkerError::from_errno("ftruncate", this->filePath);
+      close(fd);
+      return err;
     }
+#endif
 
-    auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-    if (!self) {
-      return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    uint8_t * data = (uint8_t *)mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      this->serializeToBuffer(data, entries);
+      munmap(data, fileSize);
+      close(fd);
+      return WorkerError();
     }
 
-    const auto ** x = (const roaring_bitmap_t **)gcaware_malloc(length * sizeof(roaring_bitmap_t *));
-    if (x == nullptr) {
-      return v8utils::throwTypeError(isolate, opName, " failed allocation");
+    // mmap failed, serialize to a buffer and write it instead
+    data = (uint8_t *)gcaware_aligned_malloc(32, fileSize);
+    if (data == nullptr) {
+      WorkerError err = WorkerError::from_errno("mmap", this->filePath);
+      close(fd);
+      return err;
     }
-
-    for (int i = 0; i < length; ++i) {
-      RoaringBitmap32 * p = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, i);
-      if (p == nullptr) {
-        gcaware_free(isolate, x);
-        return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+    this->serializeToBuffer(data, entries);
+    WorkerError err;
+    for (size_t pos = 0; pos < fileSize;) {
+      ssize_t written = write(fd, data + pos, fileSize - pos);
+      if (written < 0) {
+        err = WorkerError::from_errno("write", this->filePath);
+        break;
       }
-      x[i] = p->roaring;
-    }
-
-    roaring_bitmap_t * r = op((TSize)length, x);
-    gcaware_free(isolate, x);
-    if (r == nullptr) {
-      return v8utils::throwTypeError(isolate, opName, " failed roaring allocation");
+      pos += (size_t)written;
     }
-
-    self->replaceBitmapInstance(isolate, r);
-
-    info.GetReturnValue().Set(result);
+    gcaware_aligned_free(data);
+    close(fd);
+    return err;
   }
-}
-
-void RoaringBitmap32_orManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  roaringOpMany("RoaringBitmap32::orMany", roaring_bitmap_or_many_heap, info);
-}
-
-void RoaringBitmap32_xorManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  roaringOpMany("RoaringBitmap32::xorMany", roaring_bitmap_xor_many, info);
-}
-
-#endif  // ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
-
-#line 1 "src/cpp/RoaringBitmap32-serialization.h"
-#ifndef ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
-#define ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
-
-#line 1 "src/cpp/serialization.h"
-#ifndef ROARING_NODE_SERIALIZATION_
-#define ROARING_NODE_SERIALIZATION_
-
-#line 1 "src/cpp/serialization-csv.h"
-#ifndef ROARING_NODE_SERIALIZATION_CSV_
-#define ROARING_NODE_SERIALIZATION_CSV_
-
-#line 5 "src/cpp/serialization-csv.h"
-#include <fcntl.h>
-#line 1 "src/cpp/mmap.h"
-#ifndef ROARING_NODE_MMAP_
-#define ROARING_NODE_MMAP_
-
-#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
-
-/* mmap() replacement for Windows
- *
- * Author: Mike Frysinger <vapier@gentoo.org>
- * Placed into the public domain
- */
-
-/* References:
- * CreateFileMapping: http://msdn.microsoft.com/en-us/library/aa366537(VS.85).aspx
- * CloseHandle:       http://msdn.microsoft.com/en-us/library/ms724211(VS.85).aspx
- * MapViewOfFile:     http://msdn.microsoft.com/en-us/library/aa366761(VS.85).aspx
- * UnmapViewOfFile:   http://msdn.microsoft.com/en-us/library/aa366882(VS.85).aspx
- */
-
-#  include <io.h>
-#  include <windows.h>
-#  include <sys/types.h>
-
-#  define PROT_READ 0x1
-#  define PROT_WRITE 0x2
-/* This flag is only available in WinXP+ */
-#  ifdef FILE_MAP_EXECUTE
-#    define PROT_EXEC 0x4
-#  else
-#    define PROT_EXEC 0x0
-#    define FILE_MAP_EXECUTE 0
-#  endif
-
-#  define MAP_SHARED 0x01
-#  define MAP_PRIVATE 0x02
-#  define MAP_ANONYMOUS 0x20
-#  define MAP_ANON MAP_ANONYMOUS
-#  define MAP_FAILED ((void *)-1)
-
-#  ifdef __USE_FILE_OFFSET64
-#    define DWORD_HI(x) (x >> 32)
-#    define DWORD_LO(x) ((x)&0xffffffff)
-#  else
-#    define DWORD_HI(x) (0)
-#    define DWORD_LO(x) (x)
-#  endif
-
-static void * mmap(void * start, size_t length, int prot, int flags, int fd, off_t offset) {
-  if (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC)) return MAP_FAILED;
-  if (fd == -1) {
-    if (!(flags & MAP_ANON) || offset) return MAP_FAILED;
-  } else if (flags & MAP_ANON)
-    return MAP_FAILED;
-
-  DWORD flProtect;
-  if (prot & PROT_WRITE) {
-    if (prot & PROT_EXEC)
-      flProtect = PAGE_EXECUTE_READWRITE;
-    else
-      flProtect = PAGE_READWRITE;
-  } else if (prot & PROT_EXEC) {
-    if (prot & PROT_READ)
-      flProtect = PAGE_EXECUTE_READ;
-    else if (prot & PROT_EXEC)
-      flProtect = PAGE_EXECUTE;
-  } else
-    flProtect = PAGE_READONLY;
-
-  off_t end = length + offset;
-  HANDLE mmap_fd, h;
-  if (fd == -1)
-    mmap_fd = INVALID_HANDLE_VALUE;
-  else
-    mmap_fd = (HANDLE)_get_osfhandle(fd);
-  h = CreateFileMapping(mmap_fd, NULL, flProtect, DWORD_HI(end), DWORD_LO(end), NULL);
-  if (h == NULL) return MAP_FAILED;
+};
 
-  DWORD dwDesiredAccess;
-  if (prot & PROT_WRITE)
-    dwDesiredAccess = FILE_MAP_WRITE;
-  else
-    dwDesiredAccess = FILE_MAP_READ;
-  if (prot & PROT_EXEC) dwDesiredAccess |= FILE_MAP_EXECUTE;
-  if (flags & MAP_PRIVATE) dwDesiredAccess |= FILE_MAP_COPY;
-  void * ret = MapViewOfFile(h, dwDesiredAccess, DWORD_HI(offset), DWORD_LO(offset), length);
-  if (ret == NULL) {
-    CloseHandle(h);
-    ret = MAP_FAILED;
+/** Validates the header and the offset table of a pack. Returns the entries, or nullptr if the data is not a valid pack. */
+inline const RoaringBitmapPackEntry * roaringPackValidate(
+  const uint8_t * data, size_t size, RoaringBitmapPackFormat & format, uint32_t & count) {
+  if (size < sizeof(RoaringBitmapPackHeader)) {
+    return nullptr;
   }
-  return ret;
-}
-
-static void munmap(void * addr, size_t length) {
-  UnmapViewOfFile(addr);
-  /* ruh-ro, we leaked handle from CreateFileMapping() ... */
+  RoaringBitmapPackHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, ROARING_PACK_MAGIC, sizeof(header.magic)) != 0 || header.version != ROARING_PACK_VERSION) {
+    return nullptr;
+  }
+  if (
+    header.format != (uint32_t)RoaringBitmapPackFormat::portable &&
+    header.format != (uint32_t)RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+    return nullptr;
+  }
+  if (header.count > UINT32_MAX || header.count > (size - sizeof(header)) / sizeof(RoaringBitmapPackEntry)) {
+    return nullptr;
+  }
+  format = (RoaringBitmapPackFormat)header.format;
+  count = (uint32_t)header.count;
+  return (const RoaringBitmapPackEntry *)(data + sizeof(header));
 }
 
-#  undef DWORD_HI
-#  undef DWORD_LO
-
-#else
+#endif  // ROARING_NODE_SERIALIZATION_PACK_
 
-#  include <unistd.h>
-#  include <sys/mman.h>
+#line 1 "src/cpp/serialization-parallel.h"
+#ifndef ROARING_NODE_SERIALIZATION_PARALLEL_
+#define ROARING_NODE_SERIALIZATION_PARALLEL_
 
-#endif
-#endif
+#line 5 "src/cpp/serialization-parallel.h"
 
-#line 9 "src/cpp/serialization-csv.h"
+/** A range of containers serialized by one thread, with the offsets where its payloads start in the output. */
+struct RoaringBitmapSerializationPart {
+  int32_t container;
+  /** Portable format: offset of the first container. Frozen format: offset in the bitset zone. */
+  size_t offset;
+  /** Frozen format only: offsets in the run and in the array zones. */
+  size_t runOffset;
+  size_t arrayOffset;
+};
 
-struct CsvFileDescriptorSerializer final {
+/**
+ * Splits the serialization of a single bitmap in the portable or frozen format in parts that can be written concurrently.
+ * The layout is computed up front from the container sizes, so every part knows where to write its containers,
+ * and the output is byte identical to roaring_bitmap_portable_serialize and roaring_bitmap_frozen_serialize.
+ * The part 0 writes also the header.
+ */
+class RoaringBitmapParallelSerialization final {
  public:
-  static int iterate(const roaring::api::roaring_bitmap_t * r, int fd, FileSerializationFormat format) {
-    char separator;
-    switch (format) {
-      case FileSerializationFormat::newline_separated_values: separator = '\n'; break;
-      case FileSerializationFormat::comma_separated_values: separator = ','; break;
-      case FileSerializationFormat::tab_separated_values: separator = '\t'; break;
-      case FileSerializationFormat::json_array: separator = ','; break;
-      default: return EINVAL;
-    }
-
-    CsvFileDescriptorSerializer writer(fd, separator);
-    if (format == FileSerializationFormat::json_array) {
-      writer.appendChar('[');
-    }
-
-    if (r) {
-      roaring_iterate(r, roaringIteratorFn, &writer);
+  /** Outputs smaller than this are serialized by a single thread. */
+  static const constexpr size_t PART_MIN_BYTES = 1 << 20;
+
+  RoaringBitmapSerializationPart * parts = nullptr;
+  uint32_t count = 0;
+
+  RoaringBitmapParallelSerialization() = default;
+  RoaringBitmapParallelSerialization(const RoaringBitmapParallelSerialization &) = delete;
+  RoaringBitmapParallelSerialization & operator=(const RoaringBitmapParallelSerialization &) = delete;
+
+  ~RoaringBitmapParallelSerialization() { gcaware_free(this->parts); }
+
+  /**
+   * Computes the parts for a portable (frozen is false) or a frozen serialization of totalSize bytes, starting at headerOffset,
+   * to be written by the given number of threads. Returns the number of parts, 0 on allocation failure.
+   * If 1 is returned the bitmap is too small to be worth splitting.
+   */
+  uint32_t compute(const roaring_bitmap_t * r, bool frozen, size_t headerOffset, size_t totalSize, uint32_t threads) {
+    gcaware_free(this->parts);
+    this->parts = nullptr;
+    this->count = 1;
+    this->frozen = frozen;
+    this->headerOffset = headerOffset;
+
+    const roaring_array_t * ra = &r->high_low_container;
+    if (totalSize < 2 * PART_MIN_BYTES || ra->size < 2) {
+      return 1;
+    }
+
+    // A few parts per thread balance the load when containers have different sizes.
+    const size_t partBytes = std::max(PART_MIN_BYTES, totalSize / ((size_t)std::max(threads, 1U) * 4));
+    const size_t maxParts = totalSize / partBytes + 1;
+    this->parts = (RoaringBitmapSerializationPart *)gcaware_malloc((maxParts + 1) * sizeof(RoaringBitmapSerializationPart));
+    if (this->parts == nullptr) {
+      return 0;
     }
 
-    if (format == FileSerializationFormat::newline_separated_values) {
-      writer.appendChar('\n');
-    } else if (format == FileSerializationFormat::json_array) {
-      writer.appendChar(']');
+    size_t bitsetOffset = headerOffset, runOffset = 0, arrayOffset = 0;
+    if (frozen) {
+      size_t bitsetZone = 0, runZone = 0;
+      for (int32_t i = 0; i < ra->size; ++i) {
+        uint8_t typecode = ra->typecodes[i];
+        const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+        if (typecode == BITSET_CONTAINER_TYPE) {
+          bitsetZone += roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+        } else if (typecode == RUN_CONTAINER_TYPE) {
+          runZone += ((const roaring::internal::run_container_t *)c)->n_runs * sizeof(roaring::internal::rle16_t);
+        }
+      }
+      runOffset = headerOffset + bitsetZone;
+      arrayOffset = runOffset + runZone;
+    } else {
+      bitsetOffset += roaring::internal::ra_portable_header_size(ra);
     }
 
-    if (!writer.flush()) {
-      int errorno = errno;
-      errno = 0;
-      return errorno ? errorno : EIO;
+    uint32_t n = 0;
+    size_t written = 0, partStart = 0;
+    this->parts[0] = {0, bitsetOffset, runOffset, arrayOffset};
+    for (int32_t i = 0; i < ra->size; ++i) {
+      if (written - partStart >= partBytes && n + 1 < maxParts) {
+        this->parts[++n] = {i, bitsetOffset, runOffset, arrayOffset};
+        partStart = written;
+      }
+      const size_t bytes = this->containerBytes(ra->containers[i], ra->typecodes[i]);
+      if (!frozen) {
+        bitsetOffset += bytes;
+      } else {
+        uint8_t typecode = ra->typecodes[i];
+        roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+        (typecode == BITSET_CONTAINER_TYPE ? bitsetOffset : typecode == RUN_CONTAINER_TYPE ? runOffset : arrayOffset) +=
+          bytes;
+      }
+      written += bytes;
     }
-
-    return 0;
+    this->parts[++n] = {ra->size, bitsetOffset, runOffset, arrayOffset};
+    this->count = n;
+    return n;
   }
 
- private:
-  const constexpr static size_t BUFFER_SIZE = 131072;
-
-  char * buf;
-  size_t bufPos;
-  int fd;
-  bool needsSeparator;
-  char separator;
-
-  CsvFileDescriptorSerializer(int fd, char separator) :
-    buf((char *)gcaware_aligned_malloc(32, BUFFER_SIZE)), bufPos(0), fd(fd), needsSeparator(false), separator(separator) {}
-
-  ~CsvFileDescriptorSerializer() { gcaware_aligned_free(this->buf); }
-
-  bool flush() {
-    if (this->bufPos == 0) {
-      return true;
-    }
-    if (!this->buf) {
-      return false;
-    }
-    ssize_t written = write(this->fd, this->buf, this->bufPos);
-    if (written < 0) {
-      gcaware_aligned_free(this->buf);
-      this->buf = nullptr;
-      return false;
-    }
-    this->bufPos = 0;
-    return true;
-  }
+  /** Writes the containers of the given part, and the header if index is 0. Parts can be written concurrently. */
+  void serializePart(const roaring_bitmap_t * r, uint8_t * data, uint32_t index) const {
+    const roaring_array_t * ra = &r->high_low_container;
+    const RoaringBitmapSerializationPart & part = this->parts[index];
+    const int32_t end = this->parts[index + 1].container;
 
-  bool appendChar(char c) {
-    if (this->bufPos + 1 >= BUFFER_SIZE) {
-      if (!this->flush()) {
-        return false;
+    if (!this->frozen) {
+      if (index == 0) {
+        this->writePortableHeader(ra, (char *)data + this->headerOffset);
       }
-    }
-    if (!this->buf) {
-      return false;
-    }
-    this->buf[this->bufPos++] = c;
-    return true;
-  }
-
-  bool appendValue(uint32_t value) {
-    if (this->bufPos + 15 >= BUFFER_SIZE) {
-      if (!this->flush()) {
-        return false;
+      char * out = (char *)data + part.offset;
+      for (int32_t i = part.container; i < end; ++i) {
+        out += roaring::internal::container_write(ra->containers[i], ra->typecodes[i], out);
       }
+      return;
     }
-    if (!this->buf) {
-      return false;
-    }
-    if (this->needsSeparator) {
-      this->buf[this->bufPos++] = this->separator;
-    }
-    this->needsSeparator = true;
-
-    char * str = this->buf + this->bufPos;
-    int32_t i, j;
-    char c;
-
-    /* uint to decimal  */
-    i = 0;
-    do {
-      uint32_t remainder = value % 10;
-      str[i++] = (char)(remainder + 48);
-      value = value / 10;
-    } while (value != 0);
-
-    this->bufPos += i;
 
-    /* reverse string */
-    for (j = 0, i--; j < i; j++, i--) {
-      c = str[i];
-      str[i] = str[j];
-      str[j] = c;
+    if (index == 0) {
+      this->writeFrozenHeader(ra, data + this->parts[this->count].arrayOffset);
+    }
+    uint8_t * bitsetZone = data + part.offset;
+    uint8_t * runZone = data + part.runOffset;
+    uint8_t * arrayZone = data + part.arrayOffset;
+    for (int32_t i = part.container; i < end; ++i) {
+      uint8_t typecode = ra->typecodes[i];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+      switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+          const size_t bytes = roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+          memcpy(bitsetZone, ((const roaring::internal::bitset_container_t *)c)->words, bytes);
+          bitsetZone += bytes;
+          break;
+        }
+        case RUN_CONTAINER_TYPE: {
+          const auto * rc = (const roaring::internal::run_container_t *)c;
+          const size_t bytes = rc->n_runs * sizeof(roaring::internal::rle16_t);
+          memcpy(runZone, rc->runs, bytes);
+          runZone += bytes;
+          break;
+        }
+        default: {
+          const auto * ac = (const roaring::internal::array_container_t *)c;
+          const size_t bytes = ac->cardinality * sizeof(uint16_t);
+          memcpy(arrayZone, ac->array, bytes);
+          arrayZone += bytes;
+          break;
+        }
+      }
     }
-
-    return true;
-  }
-
-  static bool roaringIteratorFn(uint32_t value, void * param) {
-    return ((CsvFileDescriptorSerializer *)param)->appendValue(value);
   }
-};
 
-WorkerError deserializeRoaringCsvFile(
-  roaring::api::roaring_bitmap_t * r, int fd, const char * input, size_t input_size, const std::string & filePath) {
-  const constexpr static size_t BUFFER_SIZE = 131072;
+ private:
+  bool frozen = false;
+  size_t headerOffset = 0;
 
-  char * buf;
-  ssize_t readBytes;
-  if (input == nullptr) {
-    buf = (char *)gcaware_aligned_malloc(32, BUFFER_SIZE);
-    if (!buf) {
-      return WorkerError("Failed to allocate memory for text deserialization");
-    }
-  } else {
-    buf = (char *)input;
-    readBytes = (ssize_t)input_size;
-    if (readBytes < 0) {
-      return WorkerError("Input too big");
+  size_t containerBytes(const roaring::internal::container_t * c, uint8_t typecode) const {
+    if (!this->frozen) {
+      return roaring::internal::container_size_in_bytes(c, typecode);
     }
-    if (readBytes == 0) {
-      return WorkerError();
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    switch (typecode) {
+      case BITSET_CONTAINER_TYPE: return roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+      case RUN_CONTAINER_TYPE:
+        return ((const roaring::internal::run_container_t *)c)->n_runs * sizeof(roaring::internal::rle16_t);
+      default: return ((const roaring::internal::array_container_t *)c)->cardinality * sizeof(uint16_t);
     }
   }
 
-  roaring_bulk_context_t context;
-  memset(&context, 0, sizeof(context));
-  uint64_t value = 0;
-
-  bool hasValue = false;
-  bool isNegative = false;
-  for (;;) {
-    if (input == nullptr) {
-      readBytes = read(fd, buf, BUFFER_SIZE);
-      if (readBytes <= 0) {
-        if (readBytes < 0) {
-          WorkerError err = WorkerError::from_errno("read", filePath);
-          gcaware_aligned_free(buf);
-          return err;
+  /** The header written by ra_portable_serialize: cookie, run containers bitset, keys and cardinalities, offsets. */
+  static void writePortableHeader(const roaring_array_t * ra, char * buf) {
+    uint32_t startOffset;
+    const bool hasrun = roaring::internal::ra_has_run_container(ra);
+    if (hasrun) {
+      const uint32_t cookie = roaring::internal::SERIAL_COOKIE | ((uint32_t)(ra->size - 1) << 16);
+      memcpy(buf, &cookie, sizeof(cookie));
+      buf += sizeof(cookie);
+      const uint32_t s = (ra->size + 7) / 8;
+      memset(buf, 0, s);
+      for (int32_t i = 0; i < ra->size; ++i) {
+        if (roaring::internal::get_container_type(ra->containers[i], ra->typecodes[i]) == RUN_CONTAINER_TYPE) {
+          buf[i / 8] |= 1 << (i % 8);
         }
-        break;
       }
+      buf += s;
+      startOffset = ra->size < roaring::internal::NO_OFFSET_THRESHOLD ? 4 + 4 * ra->size + s : 4 + 8 * ra->size + s;
+    } else {
+      const uint32_t cookie = roaring::internal::SERIAL_COOKIE_NO_RUNCONTAINER;
+      memcpy(buf, &cookie, sizeof(cookie));
+      buf += sizeof(cookie);
+      memcpy(buf, &ra->size, sizeof(ra->size));
+      buf += sizeof(ra->size);
+      startOffset = 4 + 4 + 4 * ra->size + 4 * ra->size;
     }
-
-    for (ssize_t i = 0; i < readBytes; i++) {
-      char c = buf[i];
-      if (c >= '0' && c <= '9') {
-        if (value <= 0xffffffff) {
-          hasValue = true;
-          value = value * 10 + (c - '0');
-        }
-      } else {
-        if (hasValue) {
-          hasValue = false;
-          if (!isNegative && value <= 0xffffffff) {
-            roaring_bitmap_add_bulk(r, &context, value);
-          }
-        }
-        value = 0;
-        isNegative = c == '-';
+    for (int32_t k = 0; k < ra->size; ++k) {
+      memcpy(buf, &ra->keys[k], sizeof(ra->keys[k]));
+      buf += sizeof(ra->keys[k]);
+      const uint16_t card = (uint16_t)(roaring::internal::container_get_cardinality(ra->containers[k], ra->typecodes[k]) - 1);
+      memcpy(buf, &card, sizeof(card));
+      buf += sizeof(card);
+    }
+    if (!hasrun || ra->size >= roaring::internal::NO_OFFSET_THRESHOLD) {
+      for (int32_t k = 0; k < ra->size; ++k) {
+        memcpy(buf, &startOffset, sizeof(startOffset));
+        buf += sizeof(startOffset);
+        startOffset += roaring::internal::container_size_in_bytes(ra->containers[k], ra->typecodes[k]);
       }
     }
-
-    if (input != nullptr) {
-      break;
-    }
   }
 
-  if (!isNegative && hasValue && value <= 0xffffffff) {
-    roaring_bitmap_add_bulk(r, &context, value);
-  }
-  if (input == nullptr) {
-    gcaware_aligned_free(buf);
+  /** The tail written by roaring_bitmap_frozen_serialize after the array zone: keys, counts, typecodes and header. */
+  static void writeFrozenHeader(const roaring_array_t * ra, uint8_t * buf) {
+    uint8_t * keyZone = buf;
+    uint8_t * countZone = keyZone + 2 * ra->size;
+    uint8_t * typecodeZone = countZone + 2 * ra->size;
+    uint8_t * headerZone = typecodeZone + ra->size;
+    for (int32_t i = 0; i < ra->size; ++i) {
+      uint8_t typecode = ra->typecodes[i];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+      uint16_t count;
+      switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+          const auto * bc = (const roaring::internal::bitset_container_t *)c;
+          count = (uint16_t)((bc->cardinality != roaring::internal::BITSET_UNKNOWN_CARDINALITY ? bc->cardinality
+                                                                           : roaring::internal::bitset_container_compute_cardinality(bc)) -
+                             1);
+          break;
+        }
+        case RUN_CONTAINER_TYPE: count = (uint16_t)((const roaring::internal::run_container_t *)c)->n_runs; break;
+        default: count = (uint16_t)(((const roaring::internal::array_container_t *)c)->cardinality - 1); break;
+      }
+      memcpy(countZone + 2 * i, &count, 2);
+      typecodeZone[i] = typecode;
+    }
+    memcpy(keyZone, ra->keys, ra->size * sizeof(uint16_t));
+    const uint32_t header = ((uint32_t)ra->size << 15) | roaring::internal::FROZEN_COOKIE;
+    memcpy(headerZone, &header, 4);
   }
+};
 
-  return WorkerError();
-}
-
-#endif
+#endif  // ROARING_NODE_SERIALIZATION_PARALLEL_
 
-#line 7 "src/cpp/serialization.h"
+#line 9 "src/cpp/serialization.h"
 
 #if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
 #  include <io.h>
@@ -12405,6 +13165,7 @@ class RoaringBitmapSerializerBase {
  private:
   bool serializeArray = false;
   size_t cardinality = 0;
+  RoaringBitmapParallelSerialization parallel;
 
  public:
   RoaringBitmap32 * self = nullptr;
@@ -12450,6 +13211,32 @@ class RoaringBitmapSerializerBase {
     return WorkerError();
   }
 
+  /**
+   * Splits the serialization in parts that can be written concurrently by serializePart, for the formats that support it.
+   * computeSerializedSize must be called before. Returns the number of parts, 1 if the serialization cannot be split.
+   */
+  uint32_t computeParts(uint32_t threads) {
+    const roaring_bitmap_t * r = this->self->roaring;
+    switch (this->format) {
+      case FileSerializationFormat::croaring:
+        return this->serializeArray ? 1 : this->parallel.compute(r, false, 1, this->serializedSize, threads);
+      case FileSerializationFormat::portable: return this->parallel.compute(r, false, 0, this->serializedSize, threads);
+      case FileSerializationFormat::unsafe_frozen_croaring:
+        return this->parallel.compute(r, true, 0, this->serializedSize, threads);
+      default: return 1;
+    }
+  }
+
+  inline uint32_t partsCount() const { return this->parallel.count; }
+
+  /** Writes one of the parts computed by computeParts. Different parts can be written concurrently. */
+  void serializePart(uint8_t * data, uint32_t index) {
+    if (index == 0 && this->format == FileSerializationFormat::croaring) {
+      data[0] = CROARING_SERIALIZATION_CONTAINER;
+    }
+    this->parallel.serializePart(this->self->roaring, data, index);
+  }
+
   WorkerError serializeToBuffer(uint8_t * data) {
     if (!data) {
       return WorkerError("RoaringBitmap32 serialization allocation failed");
@@ -12493,6 +13280,7 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
  public:
   v8utils::TypedArrayContent<uint8_t> inputBuffer;
   uint8_t * volatile allocatedBuffer = nullptr;
+  uint8_t * outputBuffer = nullptr;
 
   void parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info) {
     v8::Isolate * isolate = info.GetIsolate();
@@ -12533,12 +13321,8 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
     this->self = bitmap;
   }
 
-  WorkerError serialize() {
-    WorkerError err = this->computeSerializedSize();
-    if (err.hasError()) {
-      return err;
-    }
-
+  /** Allocates the output buffer, or checks the size of the given one. computeSerializedSize must be called before. */
+  WorkerError prepareBuffer() {
     uint8_t * data = this->inputBuffer.data;
 
     if (data == nullptr) {
@@ -12549,7 +13333,22 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
       return WorkerError("RoaringBitmap32 serialization buffer is too small");
     }
 
-    return this->serializeToBuffer(data);
+    this->outputBuffer = data;
+    return data ? WorkerError() : WorkerError("RoaringBitmap32 serialization allocation failed");
+  }
+
+  WorkerError serialize() {
+    WorkerError err = this->computeSerializedSize();
+    if (err.hasError()) {
+      return err;
+    }
+
+    err = this->prepareBuffer();
+    if (err.hasError()) {
+      return err;
+    }
+
+    return this->serializeToBuffer(this->outputBuffer);
   }
 
   void done(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
@@ -12630,62 +13429,81 @@ class RoaringBitmapFileSerializer final : public RoaringBitmapSerializerBase {
       return err;
     }
 
-    int fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
-    if (fd < 0) {
+    uint8_t * data = nullptr;
+    err = this->openOutput(data);
+    if (!err.hasError() && data != nullptr) {
+      err = this->serializeToBuffer(data);
+    }
+    WorkerError closeErr = this->closeOutput(data, !err.hasError());
+    return err.hasError() ? err : closeErr;
+  }
+
+  /**
+   * Creates the file with the size computed by computeSerializedSize and maps it in memory.
+   * If the file cannot be mapped, data is a buffer written to the file by closeOutput. data is nullptr for an empty file.
+   */
+  WorkerError openOutput(uint8_t *& data) {
+    data = nullptr;
+    this->fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+    if (this->fd < 0) {
       return WorkerError::from_errno("open", this->filePath);
     }
 
 #if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
-    int truncateErr = _chsize_s(fd, this->serializedSize);
+    int truncateErr = _chsize_s(this->fd, this->serializedSize);
     if (truncateErr != 0) {
-      err = WorkerError(truncateErr, "_chsize_s", this->filePath);
-      close(fd);
-      return err;
+      return WorkerError(truncateErr, "_chsize_s", this->filePath);
     }
 #else
-    if (ftruncate(fd, this->serializedSize) < 0) {
-      err = WorkerError::from_errno("ftruncate", this->filePath);
-      close(fd);
-      return err;
+    if (ftruncate(this->fd, this->serializedSize) < 0) {
+      return WorkerError::from_errno("ftruncate", this->filePath);
     }
 #endif
 
-    if (this->serializedSize != 0) {
-      uint8_t * data = (uint8_t *)mmap(nullptr, this->serializedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-      if (data == MAP_FAILED) {
-        // mmap failed, allocate and write to buffer instead
-        data = (uint8_t *)gcaware_aligned_malloc(32, this->serializedSize);
-        if (data) {
-          err = this->serializeToBuffer(data);
-          if (!err.hasError()) {
-            auto wresult = write(fd, data, this->serializedSize);
-            if (wresult < 0) {
-              err = WorkerError::from_errno("write", this->filePath);
-              close(fd);
-            }
-          }
-          gcaware_aligned_free(data);
-          return err;
-        }
+    if (this->serializedSize == 0) {
+      return WorkerError();
+    }
 
-        err = WorkerError::from_errno("mmap", this->filePath);
-        close(fd);
-        return err;
-      }
+    data = (uint8_t *)mmap(nullptr, this->serializedSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (data != MAP_FAILED) {
+      this->isMmap = true;
+      return WorkerError();
+    }
 
-      err = this->serializeToBuffer(data);
+    // mmap failed, allocate and write to buffer instead
+    this->isMmap = false;
+    data = (uint8_t *)gcaware_aligned_malloc(32, this->serializedSize);
+    return data ? WorkerError() : WorkerError::from_errno("mmap", this->filePath);
+  }
 
-      if (err.hasError()) {
-        close(fd);
-        return err;
+  /** Unmaps the file or writes the buffer returned by openOutput, if write is true, and closes the file. */
+  WorkerError closeOutput(uint8_t * data, bool write) {
+    WorkerError err;
+    if (data != nullptr) {
+      if (this->isMmap) {
+        munmap(data, this->serializedSize);
+      } else {
+        for (size_t pos = 0; write && pos < this->serializedSize;) {
+          auto written = ::write(this->fd, data + pos, this->serializedSize - pos);
+          if (written < 0) {
+            err = WorkerError::from_errno("write", this->filePath);
+            break;
+          }
+          pos += (size_t)written;
+        }
+        gcaware_aligned_free(data);
       }
-
-      munmap(data, this->serializedSize);
     }
-
-    close(fd);
+    if (this->fd >= 0) {
+      close(this->fd);
+      this->fd = -1;
+    }
     return err;
   }
+
+ private:
+  int fd = -1;
+  bool isMmap = false;
 };
 
 class RoaringBitmapDeserializerBase {
@@ -13003,10 +13821,6 @@ class RoaringBitmapFileDeserializer final : public RoaringBitmapDeserializerBase
 
 #endif  // ROARING_NODE_SERIALIZATION_
 
-#line 1 "src/cpp/async-workers.h"
-#ifndef ROARING_NODE_ASYNC_WORKERS_
-#define ROARING_NODE_ASYNC_WORKERS_
-
 #line 8 "src/cpp/async-workers.h"
 
 uint32_t getCpusCount() {
@@ -13180,1773 +13994,9223 @@ class AsyncWorker {
     this->_registeredWithAddon = true;
   }
 
-  void _unregisterFromAddon() {
-    if (this->_registeredWithAddon && this->maybeAddonData != nullptr) {
-      this->maybeAddonData->leaveAsyncWorker();
-      this->_registeredWithAddon = false;
-    }
+  void _unregisterFromAddon() {
+    if (this->_registeredWithAddon && this->maybeAddonData != nullptr) {
+      this->maybeAddonData->leaveAsyncWorker();
+      this->_registeredWithAddon = false;
+    }
+  }
+
+  static void _resolveOrReject(AsyncWorker * worker, v8::Local<v8::Value> & error) {
+    if (worker->_completed.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    worker->_completed.store(true, std::memory_order_release);
+
+    worker->_unregisterFromAddon();
+
+    if (worker->isShuttingDown()) {
+      worker->finally();
+      delete worker;
+      return;
+    }
+
+    v8::Isolate * isolate = worker->isolate;
+    v8::HandleScope scope(isolate);
+
+    v8::TryCatch tryCatch(isolate);
+
+    v8::Local<v8::Value> result;
+
+    if (!worker->_error.hasError() && error.IsEmpty()) {
+      worker->done(result);
+    }
+
+    if (tryCatch.HasCaught()) {
+      error = worker->_makeError(tryCatch.Exception());
+      tryCatch.Reset();
+    }
+
+    worker->finally();
+
+    if (tryCatch.HasCaught()) {
+      error = worker->_makeError(tryCatch.Exception());
+      tryCatch.Reset();
+    }
+
+    if (result.IsEmpty() && error.IsEmpty()) {
+      worker->setError(WorkerError("Async operation failed"));
+    }
+
+    if (worker->hasError() && error.IsEmpty()) {
+      error = worker->_error.newV8Error(isolate);
+    }
+
+    auto context = isolate->GetCurrentContext();
+
+    if (worker->_resolver.IsEmpty()) {
+      v8::Local<v8::Function> callback = worker->_callback.Get(isolate);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!error.IsEmpty()) {
+        v8::Local<v8::Value> argv[] = {error, v8::Undefined(isolate)};
+        ignoreMaybeResult(callback->Call(context, context->Global(), 2, argv));
+      } else {
+        v8::Local<v8::Value> argv[] = {v8::Null(isolate), result};
+        ignoreMaybeResult(callback->Call(context, context->Global(), 2, argv));
+      }
+      delete worker;
+    } else {
+      v8::Local<v8::Promise::Resolver> resolver = worker->_resolver.Get(isolate);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      delete worker;
+      if (!error.IsEmpty()) {
+        ignoreMaybeResult(resolver->Reject(context, error));
+      } else if (!result.IsEmpty()) {
+        ignoreMaybeResult(resolver->Resolve(context, result));
+      } else {
+        ignoreMaybeResult(resolver->Reject(context, v8::Undefined(isolate)));
+      }
+    }
+  }
+
+  static void _complete(AsyncWorker * worker) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    v8::Isolate * isolate = worker->isolate;
+    const bool shouldRunMicrotasks = !worker->isShuttingDown();
+    worker->_applyPendingExternalMemoryDelta();
+    v8::Local<v8::Value> error;
+    _resolveOrReject(worker, error);
+    if (shouldRunMicrotasks) {
+      isolate->PerformMicrotaskCheckpoint();
+    }
+  }
+
+  static void _work(uv_work_t * request) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto * worker = static_cast<AsyncWorker *>(request->data);
+    if (worker && !worker->hasError()) {
+      struct AsyncWorkerMemoryCounterScope {
+        std::atomic<int64_t> * previous;
+        explicit AsyncWorkerMemoryCounterScope(std::atomic<int64_t> * current) :
+          previous(gcawarePushAsyncWorkerMemoryCounter(current)) {}
+        ~AsyncWorkerMemoryCounterScope() { gcawarePopAsyncWorkerMemoryCounter(previous); }
+      } memoryScope(&worker->_pendingExternalMemoryDelta);
+
+      worker->work();
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  static void _done(uv_work_t * request, int status) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto * worker = static_cast<AsyncWorker *>(request->data);
+
+    if (status != 0) {
+      worker->setError(WorkerError("Error executing async thread"));
+    }
+    _complete(worker);
+  }
+
+  v8::Local<v8::Value> _makeError(v8::Local<v8::Value> error) {
+    if (error.IsEmpty() || error->IsNull() || error->IsUndefined()) {
+      this->setError(WorkerError("Exception in async operation"));
+      return {};
+    }
+    if (!error->IsObject()) {
+      v8::MaybeLocal<v8::String> message = error->ToString(isolate->GetCurrentContext());
+      if (message.IsEmpty()) {
+        if (this->maybeAddonData != nullptr) {
+          message = this->maybeAddonData->strings.OperationFailed.Get(isolate);
+        } else {
+          message = v8::String::NewFromUtf8(isolate, "Operation failed", v8::NewStringType::kInternalized);
+        }
+      }
+      error = v8::Exception::Error(error.IsEmpty() ? v8::String::Empty(isolate) : message.ToLocalChecked());
+    }
+    return error;
+  }
+
+  friend class ParallelAsyncWorker;
+
+  void _applyPendingExternalMemoryDelta() {
+    int64_t delta = _pendingExternalMemoryDelta.exchange(0, std::memory_order_acq_rel);
+    if (delta != 0) {
+      this->isolate->AdjustAmountOfExternalAllocatedMemory(delta);
+    }
+  }
+};
+
+class ParallelAsyncWorker : public AsyncWorker {
+ public:
+  uint32_t loopCount;
+  uint32_t concurrency;
+
+  explicit ParallelAsyncWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
+    AsyncWorker(isolate, maybeAddonData),
+    loopCount(0),
+    concurrency(0),
+    _tasks(nullptr),
+    _pendingTasks(0),
+    _currentIndex(0) {}
+
+  virtual ~ParallelAsyncWorker() { gcaware_free(this->isolate, _tasks); }
+
+ protected:
+  void work() override {
+    const uint32_t c = loopCount;
+    for (uint32_t i = 0; i != c && !hasError() && !_completed.load(std::memory_order_acquire); ++i) {
+      parallelWork(i);
+    }
+  }
+
+  virtual void parallelWork(uint32_t index) = 0;
+
+ private:
+  uv_work_t * _tasks;
+  std::atomic<int32_t> _pendingTasks;
+  std::atomic<uint32_t> _currentIndex;
+
+  bool _start() override {
+    if (concurrency == 0) {
+      concurrency = getCpusCount();
+    }
+
+    uint32_t tasksCount = concurrency < loopCount ? concurrency : loopCount;
+
+    if (tasksCount <= 1) {
+      return AsyncWorker::_start();
+    }
+
+    uv_work_t * tasks = (uv_work_t *)gcaware_malloc(tasksCount * sizeof(uv_work_t));
+    if (tasks == nullptr) {
+      this->setError(WorkerError("Failed to allocate memory"));
+      return false;
+    }
+    memset(tasks, 0, tasksCount * sizeof(uv_work_t));
+
+    _tasks = tasks;
+
+    for (uint32_t taskIndex = 0; taskIndex != tasksCount; ++taskIndex) {
+      tasks[taskIndex].data = this;
+    }
+
+    for (uint32_t taskIndex = 0; taskIndex != tasksCount; ++taskIndex) {
+      if (
+        uv_queue_work(
+          node::GetCurrentEventLoop(this->isolate),
+          &tasks[taskIndex],
+          ParallelAsyncWorker::_parallelWork,
+          ParallelAsyncWorker::_parallelDone) != 0) {
+        setError(WorkerError("Error starting async parallel task"));
+        break;
+      }
+      _pendingTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return _pendingTasks.load(std::memory_order_acquire) > 0;
+  }
+
+  static void _parallelWork(uv_work_t * request) {
+    auto * worker = static_cast<ParallelAsyncWorker *>(request->data);
+
+    if (worker) {
+      struct ParallelWorkerMemoryCounterScope {
+        std::atomic<int64_t> * previous;
+        explicit ParallelWorkerMemoryCounterScope(std::atomic<int64_t> * current) :
+          previous(gcawarePushAsyncWorkerMemoryCounter(current)) {}
+        ~ParallelWorkerMemoryCounterScope() { gcawarePopAsyncWorkerMemoryCounter(previous); }
+      } memoryScope(&worker->_pendingExternalMemoryDelta);
+
+      uint32_t loopCount = worker->loopCount;
+      while (!worker->hasError() && !worker->_completed.load(std::memory_order_acquire)) {
+        const uint32_t prevIndex = worker->_currentIndex.load(std::memory_order_relaxed);
+        const uint32_t index = worker->_currentIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= loopCount || index < prevIndex) {
+          break;
+        }
+        worker->parallelWork(index);
+      }
+    }
+  }
+
+  static void _parallelDone(uv_work_t * request, int status) {
+    auto * worker = static_cast<ParallelAsyncWorker *>(request->data);
+
+    if (worker->_completed.load(std::memory_order_acquire)) {
+      if (!worker->isShuttingDown()) {
+        worker->isolate->PerformMicrotaskCheckpoint();
+      }
+      return;
+    }
+
+    int32_t remaining = worker->_pendingTasks.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (remaining <= 0) {
+      _complete(worker);
+      return;
+    }
+
+    if (!worker->isShuttingDown()) {
+      worker->isolate->PerformMicrotaskCheckpoint();
+    }
+  }
+};
+
+/////////////// ParallelAsyncWorker ///////////////
+
+class RoaringBitmap32FactoryAsyncWorker : public AsyncWorker {
+ public:
+  std::atomic<roaring_bitmap_t_ptr> bitmap;
+
+  explicit RoaringBitmap32FactoryAsyncWorker(v8::Isolate * isolate, AddonData * addonData) :
+    AsyncWorker(isolate, addonData), bitmap(nullptr) {}
+
+  virtual ~RoaringBitmap32FactoryAsyncWorker() {
+    roaring_bitmap_t_ptr ptr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (ptr != nullptr) {
+      roaring_bitmap_free(ptr);
+    }
+  }
+
+ protected:
+  void done(v8::Local<v8::Value> & result) override {
+    roaring_bitmap_t_ptr bitmapPtr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (bitmapPtr == nullptr) {
+      return this->setError(WorkerError("Error deserializing roaring bitmap"));
+    }
+
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(this->isolate);
+
+    v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+
+    if (!resultMaybe.ToLocal(&result)) {
+      return this->setError(WorkerError("Error instantiating roaring bitmap"));
+    }
+
+    RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+    if (unwrapped == nullptr) {
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+
+    unwrapped->replaceBitmapInstance(this->isolate, bitmapPtr);
+  }
+};
+
+class ToUint32ArrayAsyncWorker final : public ParallelAsyncWorker {
+ public:
+  /** Outputs smaller than this are decoded by a single thread. */
+  static const constexpr size_t PARALLEL_MIN_VALUES = 1 << 21;
+  /** Minimum number of values decoded by each parallel task. */
+  static const constexpr size_t PARTITION_MIN_VALUES = 1 << 18;
+
+  /** First container and output offset of a range of containers decoded by one task. */
+  struct Partition {
+    int32_t container;
+    size_t offset;
+  };
+
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  v8::Global<v8::Value> bitmapPersistent;
+  RoaringBitmap32 * bitmap = nullptr;
+  v8utils::TypedArrayContent<uint32_t> inputContent;
+  std::atomic<uint32_t *> allocatedBuffer{nullptr};
+  std::atomic<size_t> outputSize{0};
+  size_t maxSize = std::numeric_limits<size_t>::max();
+  bool hasInput = false;
+  uint32_t * output = nullptr;
+  Partition * partitions = nullptr;
+
+  explicit ToUint32ArrayAsyncWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ToUint32ArrayAsyncWorker));
+  }
+
+  ~ToUint32ArrayAsyncWorker() {
+    uint32_t * buffer = this->allocatedBuffer.exchange(nullptr, std::memory_order_acq_rel);
+    if (buffer) {
+      bare_aligned_free(buffer);
+    }
+    gcaware_free(this->isolate, this->partitions);
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ToUint32ArrayAsyncWorker));
+  }
+
+ protected:
+  // Called before the thread starts, in the main thread.
+  void before() final {
+    v8::Isolate * isolate = info.GetIsolate();
+
+    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+    if (self == nullptr) {
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = self->addonData;
+    }
+
+    if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+      if (info[0]->IsNumber()) {
+        double maxSizeDouble;
+        if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxSizeDouble) || std::isnan(maxSizeDouble)) {
+          return v8utils::throwError(
+            isolate, "RoaringBitmap32::toUint32ArrayAsync - argument must be a valid integer number");
+        }
+        this->maxSize =
+          maxSizeDouble <= 0 ? 0 : (maxSizeDouble > 0xfffffffff ? 0xfffffffff : static_cast<size_t>(maxSizeDouble));
+      } else {
+        if (!argumentIsValidUint32ArrayOutput(info[0]) || !this->inputContent.set(isolate, info[0])) {
+          return v8utils::throwError(
+            isolate, "RoaringBitmap32::toUint32ArrayAsync - argument must be a UInt32Array, Int32Array or ArrayBuffer");
+        }
+        this->hasInput = true;
+      }
+    }
+
+    this->bitmap = self;
+    this->bitmap->beginFreeze();
+
+    size_t size = this->bitmap->getSize();
+    const size_t limit = this->hasInput ? this->inputContent.length : this->maxSize;
+    if (size > limit) {
+      size = limit;
+    }
+    if (size == 0) {
+      return;
+    }
+
+    if (this->hasInput) {
+      this->output = this->inputContent.data;
+    } else {
+      this->output = static_cast<uint32_t *>(bare_aligned_malloc(32, size * sizeof(uint32_t)));
+      if (!this->output) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to allocate memory"));
+      }
+      this->allocatedBuffer.store(this->output, std::memory_order_release);
+    }
+    this->outputSize.store(size, std::memory_order_release);
+
+    this->partition(size);
+  }
+
+  /**
+   * Splits the containers in ranges of about the same number of values, so each thread
+   * decodes a disjoint range straight into the output at an offset known in advance.
+   */
+  void partition(size_t size) {
+    const roaring_array_t * ra = &this->bitmap->roaring->high_low_container;
+
+    size_t partitionValues = size;
+    if (size >= PARALLEL_MIN_VALUES) {
+      // A few partitions per thread balance the load when containers have different cardinality.
+      partitionValues = std::max(PARTITION_MIN_VALUES, size / ((size_t)getCpusCount() * 4));
+    }
+    const size_t maxPartitions = (size + partitionValues - 1) / partitionValues + 1;
+    this->partitions = (Partition *)gcaware_malloc((maxPartitions + 1) * sizeof(Partition));
+    if (this->partitions == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to allocate memory"));
+    }
+
+    uint32_t count = 0;
+    size_t offset = 0;
+    size_t partitionStart = 0;
+    this->partitions[0] = {0, 0};
+    int32_t i = 0;
+    for (; i < ra->size && offset < size; ++i) {
+      if (offset - partitionStart >= partitionValues && count + 1 < maxPartitions) {
+        this->partitions[++count] = {i, offset};
+        partitionStart = offset;
+      }
+      offset += roaring::internal::container_get_cardinality(ra->containers[i], ra->typecodes[i]);
+    }
+    this->partitions[++count] = {i, offset};
+    this->loopCount = count;
+  }
+
+  void parallelWork(uint32_t index) final {
+    const roaring_bitmap_t * r = this->bitmap->roaring;
+    const roaring_array_t * ra = &r->high_low_container;
+    const size_t size = this->outputSize.load(std::memory_order_relaxed);
+    size_t offset = this->partitions[index].offset;
+    const int32_t end = this->partitions[index + 1].container;
+    for (int32_t i = this->partitions[index].container; i < end; ++i) {
+      const size_t cardinality = roaring::internal::container_get_cardinality(ra->containers[i], ra->typecodes[i]);
+      if (offset + cardinality > size) {
+        // The output is truncated in the middle of the last container.
+        roaring_bitmap_range_uint32_array(r, offset, size - offset, this->output + offset);
+        break;
+      }
+      roaring::internal::container_to_uint32_array(
+        this->output + offset, ra->containers[i], ra->typecodes[i], (uint32_t)ra->keys[i] << 16);
+      offset += cardinality;
+    }
+  }
+
+  void finally() final {
+    if (this->bitmap) {
+      this->bitmap->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    uint32_t * allocatedBuffer = this->allocatedBuffer.load(std::memory_order_acquire);
+    size_t outputSize = this->outputSize.load(std::memory_order_acquire);
+
+    if (this->hasInput) {
+      if (!v8utils::v8ValueToUint32ArrayWithLimit(
+            isolate, this->inputContent.bufferPersistent.Get(isolate), outputSize, result)) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a UInt32Array range"));
+      }
+      return;
+    }
+
+    if (allocatedBuffer && outputSize != 0) {
+      // Create a new buffer using the allocated memory
+      v8::MaybeLocal<v8::Object> nodeBufferMaybeLocal = node::Buffer::New(
+        isolate,
+        reinterpret_cast<char *>(allocatedBuffer),
+        outputSize * sizeof(uint32_t),
+        bare_aligned_free_callback,
+        nullptr);
+      if (!nodeBufferMaybeLocal.IsEmpty()) {
+        this->allocatedBuffer.store(nullptr, std::memory_order_release);
+      }
+
+      v8::Local<v8::Object> nodeBufferObject;
+      if (!nodeBufferMaybeLocal.ToLocal(&nodeBufferObject)) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
+      }
+
+      v8::Local<v8::Uint8Array> nodeBuffer = nodeBufferObject.As<v8::Uint8Array>();
+      if (nodeBuffer.IsEmpty()) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
+      }
+      result = v8::Uint32Array::New(nodeBuffer->Buffer(), 0, outputSize);
+      if (result.IsEmpty()) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
+      }
+      return;
+    }
+
+    auto arrayBuffer = v8::ArrayBuffer::New(isolate, 0);
+    if (arrayBuffer.IsEmpty()) {
+      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create an empty ArrayBuffer"));
+    }
+    result = v8::Uint32Array::New(arrayBuffer, 0, 0);
+    if (result.IsEmpty()) {
+      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create an empty ArrayBuffer"));
+    }
+  }
+};
+
+/**
+ * Serializes a bitmap to a buffer. Big bitmaps in the croaring, portable and unsafe_frozen_croaring formats
+ * are split in ranges of containers written concurrently, the output is the same of the synchronous serialize.
+ */
+class SerializeWorker final : public ParallelAsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  v8::Global<v8::Value> bitmapPersistent;
+  RoaringBitmapSerializer serializer;
+
+  explicit SerializeWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeWorker));
+  }
+
+  virtual ~SerializeWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializeWorker)); }
+
+ protected:
+  // Called before the thread starts, in the main thread.
+  void before() final {
+    this->serializer.parseArguments(this->info);
+    if (!this->serializer.self) {
+      return;
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = this->serializer.self->addonData;
+    }
+    this->bitmapPersistent.Reset(isolate, this->info.This());
+    this->serializer.self->beginFreeze();
+
+    WorkerError err = this->serializer.computeSerializedSize();
+    if (!err.hasError()) {
+      err = this->serializer.prepareBuffer();
+    }
+    if (err.hasError()) {
+      return this->setError(err);
+    }
+    this->loopCount = this->serializer.computeParts(getCpusCount());
+    if (this->loopCount == 0) {
+      this->setError(WorkerError("RoaringBitmap32 serialization allocation failed"));
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    if (this->serializer.partsCount() <= 1) {
+      this->setError(this->serializer.serializeToBuffer(this->serializer.outputBuffer));
+    } else {
+      this->serializer.serializePart(this->serializer.outputBuffer, index);
+    }
+  }
+
+  void finally() final {
+    if (this->serializer.self) {
+      this->serializer.self->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final { this->serializer.done(this->isolate, result); }
+};
+
+/**
+ * Serializes a bitmap to a file. As SerializeWorker, big bitmaps are written concurrently in ranges of containers,
+ * the file is created and mapped by the first task and closed by the last one.
+ */
+class SerializeFileWorker final : public ParallelAsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  v8::Global<v8::Value> bitmapPersistent;
+  RoaringBitmapFileSerializer serializer;
+
+  explicit SerializeFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData),
+    info(info),
+    _data(nullptr),
+    _opened(false),
+    _completedParts(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeFileWorker));
+  }
+
+  virtual ~SerializeFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializeFileWorker)); }
+
+ protected:
+  // Called before the thread starts, in the main thread.
+  void before() final {
+    this->serializer.parseArguments(this->info);
+    if (!this->serializer.self) {
+      return;
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = this->serializer.self->addonData;
+    }
+    this->bitmapPersistent.Reset(isolate, this->info.This());
+    this->serializer.self->beginFreeze();
+
+    // Text formats have no size known up front, they are always written by a single task.
+    this->loopCount = 1;
+    if (!this->serializer.computeSerializedSize().hasError()) {
+      this->loopCount = this->serializer.computeParts(getCpusCount());
+      if (this->loopCount == 0) {
+        this->setError(WorkerError("RoaringBitmap32 serialization allocation failed"));
+      }
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    if (this->serializer.partsCount() <= 1) {
+      this->setError(this->serializer.serialize());
+      return;
+    }
+    if (!this->_open()) {
+      return;
+    }
+    this->serializer.serializePart(this->_data, index);
+    if (this->_completedParts.fetch_add(1, std::memory_order_acq_rel) + 1 == this->loopCount) {
+      std::lock_guard<std::mutex> lock(this->_outputMutex);
+      this->setError(this->serializer.closeOutput(this->_data, true));
+      this->_data = nullptr;
+    }
+  }
+
+  void finally() final {
+    if (this->_opened && this->_data != nullptr) {
+      // Not all the parts were written, release the output without writing it.
+      this->serializer.closeOutput(this->_data, false);
+      this->_data = nullptr;
+    }
+    if (this->serializer.self) {
+      this->serializer.self->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->bitmapPersistent.IsEmpty()) {
+      result = this->bitmapPersistent.Get(this->isolate);
+    }
+  }
+
+ private:
+  std::mutex _outputMutex;
+  uint8_t * _data;
+  bool _opened;
+  std::atomic<uint32_t> _completedParts;
+
+  bool _open() {
+    std::lock_guard<std::mutex> lock(this->_outputMutex);
+    if (!this->_opened) {
+      this->_opened = true;
+      WorkerError err = this->serializer.openOutput(this->_data);
+      if (err.hasError()) {
+        this->serializer.closeOutput(this->_data, false);
+        this->_data = nullptr;
+        this->setError(err);
+      }
+    }
+    return this->_data != nullptr;
+  }
+};
+
+/**
+ * Checks the presence of many values in a bitmap, in parallel.
+ * The values are split in chunks of CHUNK_SIZE values, each chunk is checked by one thread with its own bulk context.
+ */
+class HasManyParallelWorker final : public ParallelAsyncWorker {
+ public:
+  /** Number of values per chunk, a multiple of 32 so threads never write the same word of a packed output. */
+  static const constexpr size_t CHUNK_SIZE = 65536;
+
+  RoaringBitmap32 * bitmap;
+  v8::Global<v8::Value> bitmapPersistent;
+  v8::Global<v8::Value> resultPersistent;
+  v8utils::TypedArrayContent<uint32_t> values;
+  v8utils::TypedArrayContent<uint8_t> output;
+  bool packed;
+  bool frozen;
+
+  explicit HasManyParallelWorker(v8::Isolate * isolate, RoaringBitmap32 * bitmap) :
+    ParallelAsyncWorker(isolate, bitmap->addonData), bitmap(bitmap), packed(false), frozen(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(HasManyParallelWorker));
+  }
+
+  virtual ~HasManyParallelWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(HasManyParallelWorker)); }
+
+  void setResult(v8::Local<v8::Value> result) {
+    this->resultPersistent.Reset(this->isolate, result);
+    this->loopCount = (uint32_t)((this->values.length + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  }
+
+ protected:
+  void before() final {
+    if (!this->hasError()) {
+      this->bitmapPersistent.Reset(this->isolate, this->bitmap->persistent.Get(this->isolate));
+      this->owner()->beginFreeze();
+      this->frozen = true;
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    const size_t begin = (size_t)index * CHUNK_SIZE;
+    const size_t count = std::min(CHUNK_SIZE, this->values.length - begin);
+    if (this->packed) {
+      roaringHasManyBits(this->bitmap->roaring, this->values.data + begin, count, (uint32_t *)this->output.data + (begin >> 5));
+    } else {
+      roaringHasMany(this->bitmap->roaring, this->values.data + begin, count, this->output.data + begin);
+    }
+  }
+
+  void finally() final {
+    if (this->frozen) {
+      this->frozen = false;
+      this->owner()->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final { result = this->resultPersistent.Get(this->isolate); }
+
+ private:
+  RoaringBitmap32 * owner() const {
+    return this->bitmap->readonlyViewOf ? this->bitmap->readonlyViewOf : this->bitmap;
+  }
+};
+
+class SerializePackFileWorker final : public AsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  RoaringBitmap32Pins pins;
+  RoaringBitmapPackFileSerializer serializer;
+  bool frozen;
+
+  explicit SerializePackFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    AsyncWorker(info.GetIsolate(), addonData), info(info), frozen(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializePackFileWorker));
+  }
+
+  virtual ~SerializePackFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializePackFileWorker)); }
+
+ protected:
+  void before() final {
+    this->setError(this->serializer.parseArguments(this->info));
+    if (!this->hasError()) {
+      for (uint32_t i = 0; i != this->serializer.count; ++i) {
+        this->pins.pin(this->isolate, this->serializer.bitmaps[i]);
+      }
+      this->serializer.beginFreeze();
+      this->frozen = true;
+    }
+  }
+
+  void work() final { this->setError(this->serializer.serialize()); }
+
+  void finally() final {
+    if (this->frozen) {
+      this->frozen = false;
+      this->serializer.endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final { result = v8::Undefined(this->isolate); }
+};
+
+class DeserializeWorker final : public AsyncWorker {
+ public:
+  RoaringBitmapDeserializer deserializer;
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+
+  explicit DeserializeWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    AsyncWorker(info.GetIsolate(), addonData), info(info) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeWorker));
+  }
+
+  virtual ~DeserializeWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeWorker)); }
+
+ protected:
+  void before() final {
+    this->setError(this->deserializer.parseArguments(this->info, false));
+    if (this->maybeAddonData == nullptr) {
+      if (this->deserializer.targetBitmap != nullptr) {
+        this->maybeAddonData = this->deserializer.targetBitmap->addonData;
+      }
+      if (this->maybeAddonData == nullptr && !this->hasError()) {
+        this->setError(WorkerError("RoaringBitmap32 deserialization failed to get the addon data"));
+      }
+    }
+  }
+
+  void work() final { this->setError(this->deserializer.deserialize()); }
+
+  void done(v8::Local<v8::Value> & result) final {
+    v8::Isolate * isolate = this->isolate;
+
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+
+    if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
+    }
+
+    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+    if (self == nullptr) {
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+
+    self->replaceBitmapInstance(isolate, nullptr);
+
+    this->deserializer.finalizeTargetBitmap(self);
+  }
+};
+
+/**
+ * Same as DeserializeWorker but it uses memory mapped files to deserialize the bitmaps.
+ */
+class DeserializeFileWorker final : public AsyncWorker {
+ public:
+  RoaringBitmapFileDeserializer deserializer;
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+
+  explicit DeserializeFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    AsyncWorker(info.GetIsolate(), addonData), info(info) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeFileWorker));
+  }
+
+  virtual ~DeserializeFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeFileWorker)); }
+
+ protected:
+  void before() final { this->setError(this->deserializer.parseArguments(this->info)); }
+
+  void work() final { this->setError(this->deserializer.deserialize()); }
+
+  void done(v8::Local<v8::Value> & result) {
+    v8::Isolate * isolate = this->isolate;
+
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+
+    if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
+    }
+
+    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+    if (self == nullptr) {
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+
+    self->replaceBitmapInstance(isolate, nullptr);
+
+    this->deserializer.finalizeTargetBitmap(self);
+  }
+};
+
+class DeserializeParallelWorker : public ParallelAsyncWorker {
+ public:
+  v8::Global<v8::Value> bufferPersistent;
+
+  RoaringBitmapDeserializer * items;
+
+  explicit DeserializeParallelWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(isolate, maybeAddonData), items(nullptr) {}
+
+  virtual ~DeserializeParallelWorker() {
+    if (items) {
+      delete[] items;
+    }
+  }
+
+ protected:
+  virtual void parallelWork(uint32_t index) {
+    RoaringBitmapDeserializer & item = items[index];
+    const WorkerError error = item.deserialize();
+    if (error.hasError()) {
+      this->setError(error);
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+
+    const uint32_t itemsCount = this->loopCount;
+    RoaringBitmapDeserializer * items = this->items;
+
+    v8::MaybeLocal<v8::Array> resultArrayMaybe = v8::Array::New(isolate, itemsCount);
+    v8::Local<v8::Array> resultArray;
+    if (!resultArrayMaybe.ToLocal(&resultArray)) {
+      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new array"));
+    }
+
+    v8::Local<v8::Context> currentContext = isolate->GetCurrentContext();
+
+    for (uint32_t i = 0; i != itemsCount; ++i) {
+      v8::MaybeLocal<v8::Object> instanceMaybe = cons->NewInstance(currentContext, 0, nullptr);
+      v8::Local<v8::Object> instance;
+      if (!instanceMaybe.ToLocal(&instance)) {
+        return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
+      }
+
+      RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(instance, isolate);
+      if (unwrapped == nullptr) {
+        return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+      }
+
+      RoaringBitmapDeserializer & item = items[i];
+      item.finalizeTargetBitmap(unwrapped);
+      ignoreMaybeResult(resultArray->Set(currentContext, i, instance));
+    }
+
+    result = resultArray;
+  }
+};
+
+/**
+ * Serializes many bitmaps in parallel, to a buffer each or, if contiguous is true, to a single pre-sized buffer.
+ * In the contiguous buffer the bitmaps in the unsafe_frozen_croaring format start at a 32 bytes boundary.
+ */
+class SerializeParallelWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmap32Pins pins;
+  RoaringBitmapSerializer * items;
+  bool contiguous;
+
+  explicit SerializeParallelWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(isolate, maybeAddonData),
+    items(nullptr),
+    contiguous(false),
+    _offsets(nullptr),
+    _buffer(nullptr),
+    _bufferSize(0),
+    _frozen(false) {}
+
+  virtual ~SerializeParallelWorker() {
+    if (items) {
+      delete[] items;
+    }
+    gcaware_free(this->isolate, _offsets);
+    bare_aligned_free(_buffer);
+  }
+
+ protected:
+  // Called before the threads start, in the main thread.
+  void before() final {
+    const uint32_t count = this->loopCount;
+    for (uint32_t i = 0; i != count; ++i) {
+      this->owner(i)->beginFreeze();
+    }
+    this->_frozen = true;
+
+    for (uint32_t i = 0; i != count; ++i) {
+      WorkerError err = this->items[i].computeSerializedSize();
+      if (err.hasError()) {
+        return this->setError(err);
+      }
+    }
+
+    if (!this->contiguous) {
+      return;
+    }
+
+    if (count != 0) {
+      this->_offsets = (size_t *)gcaware_malloc(count * sizeof(size_t));
+      if (this->_offsets == nullptr) {
+        return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+      }
+    }
+    size_t size = 0;
+    for (uint32_t i = 0; i != count; ++i) {
+      const RoaringBitmapSerializer & item = this->items[i];
+      if (item.format == FileSerializationFormat::unsafe_frozen_croaring) {
+        size = (size + 31) & ~(size_t)31;
+      }
+      this->_offsets[i] = size;
+      size += item.serializedSize;
+    }
+    this->_bufferSize = size;
+    this->_buffer = (uint8_t *)bare_aligned_malloc(32, size != 0 ? size : 1);
+    if (this->_buffer == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    RoaringBitmapSerializer & item = this->items[index];
+    WorkerError error;
+    if (this->contiguous) {
+      // Zero the alignment padding before the body.
+      const size_t previousEnd = index != 0 ? this->_offsets[index - 1] + this->items[index - 1].serializedSize : 0;
+      memset(this->_buffer + previousEnd, 0, this->_offsets[index] - previousEnd);
+      error = item.serializeToBuffer(this->_buffer + this->_offsets[index]);
+    } else {
+      error = item.serialize();
+    }
+    if (error.hasError()) {
+      std::lock_guard<std::mutex> lock(this->_errorMutex);
+      this->setError(error);
+    }
+  }
+
+  void finally() final {
+    if (this->_frozen) {
+      this->_frozen = false;
+      for (uint32_t i = 0; i != this->loopCount; ++i) {
+        this->owner(i)->endFreeze();
+      }
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    const uint32_t count = this->loopCount;
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    if (!this->contiguous) {
+      v8::Local<v8::Array> resultArray = v8::Array::New(isolate, count);
+      if (resultArray.IsEmpty()) {
+        return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to create a new array"));
+      }
+      for (uint32_t i = 0; i != count; ++i) {
+        v8::Local<v8::Value> buffer;
+        this->items[i].done(isolate, buffer);
+        if (buffer.IsEmpty()) {
+          return;
+        }
+        ignoreMaybeResult(resultArray->Set(context, i, buffer));
+      }
+      result = resultArray;
+      return;
+    }
+
+    v8::Local<v8::Object> buffer;
+    if (!node::Buffer::New(isolate, (char *)this->_buffer, this->_bufferSize, bare_aligned_free_callback, nullptr)
+           .ToLocal(&buffer)) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to create a new buffer"));
+    }
+    this->_buffer = nullptr;
+
+    v8::Local<v8::ArrayBuffer> offsetsBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    v8::Local<v8::ArrayBuffer> lengthsBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    if (offsetsBuffer.IsEmpty() || lengthsBuffer.IsEmpty()) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+    }
+    double * offsets = (double *)offsetsBuffer->GetBackingStore()->Data();
+    double * lengths = (double *)lengthsBuffer->GetBackingStore()->Data();
+    for (uint32_t i = 0; i != count; ++i) {
+      offsets[i] = (double)this->_offsets[i];
+      lengths[i] = (double)this->items[i].serializedSize;
+    }
+
+    v8::Local<v8::Object> resultObject = v8::Object::New(isolate);
+    ignoreMaybeResult(
+      resultObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "buffer", v8::NewStringType::kInternalized), buffer));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "offsets", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(offsetsBuffer, 0, count)));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "lengths", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(lengthsBuffer, 0, count)));
+    result = resultObject;
+  }
+
+ private:
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->items[index].self;
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  std::mutex _errorMutex;
+  size_t * _offsets;
+  uint8_t * _buffer;
+  size_t _bufferSize;
+  bool _frozen;
+};
+
+class FromArrayAsyncWorker : public RoaringBitmap32FactoryAsyncWorker {
+ public:
+  v8::Global<v8::Value> argPersistent;
+  v8utils::TypedArrayContent<uint32_t> buffer;
+
+  explicit FromArrayAsyncWorker(v8::Isolate * isolate, AddonData * addonData) :
+    RoaringBitmap32FactoryAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(FromArrayAsyncWorker));
+  }
+
+  virtual ~FromArrayAsyncWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(FromArrayAsyncWorker)); }
+
+ protected:
+  void work() final {
+    roaring_bitmap_t_ptr newBitmap = roaring_bitmap_create_with_capacity(buffer.length);
+    if (newBitmap == nullptr) {
+      this->setError(WorkerError("Failed to allocate roaring bitmap"));
+      return;
+    }
+    this->bitmap.store(newBitmap, std::memory_order_release);
+    roaring_bitmap_add_many(newBitmap, buffer.length, buffer.data);
+    roaring_bitmap_run_optimize(newBitmap);
+    roaring_bitmap_shrink_to_fit(newBitmap);
+  }
+};
+
+typedef roaring_bitmap_t * (*RoaringBitmap32BinaryOperation)(const roaring_bitmap_t *, const roaring_bitmap_t *);
+
+/**
+ * Computes a binary set operation (and, or, xor, andNot) in a worker thread.
+ * Both inputs are frozen until the operation completes.
+ * If inPlace is true the result replaces the content of the first bitmap (this) when the worker completes,
+ * so readers on the main thread never observe a partially modified bitmap.
+ */
+class BinaryOperationAsyncWorker final : public RoaringBitmap32FactoryAsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  const RoaringBitmap32BinaryOperation operation;
+  const bool inPlace;
+  v8::Global<v8::Value> aPersistent;
+  v8::Global<v8::Value> bPersistent;
+  RoaringBitmap32 * a = nullptr;
+  RoaringBitmap32 * b = nullptr;
+  int64_t resultSize = -1;
+
+  explicit BinaryOperationAsyncWorker(
+    const v8::FunctionCallbackInfo<v8::Value> & info,
+    AddonData * addonData,
+    RoaringBitmap32BinaryOperation operation,
+    bool inPlace) :
+    RoaringBitmap32FactoryAsyncWorker(info.GetIsolate(), addonData), info(info), operation(operation), inPlace(inPlace) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(BinaryOperationAsyncWorker));
+  }
+
+  virtual ~BinaryOperationAsyncWorker() {
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(BinaryOperationAsyncWorker));
+  }
+
+ protected:
+  // Called before the thread starts, in the main thread.
+  void before() final {
+    v8::Isolate * isolate = this->isolate;
+
+    v8::Local<v8::Value> aValue = this->inPlace ? v8::Local<v8::Value>(this->info.This()) : this->info[0];
+    v8::Local<v8::Value> bValue = this->inPlace ? this->info[0] : this->info[1];
+
+    RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(aValue, isolate);
+    if (a == nullptr) {
+      return this->setError(WorkerError(
+        this->inPlace ? ERROR_INVALID_OBJECT : "RoaringBitmap32 async operation first argument must be a RoaringBitmap32"));
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = a->addonData;
+    }
+    if (this->inPlace && a->isFrozen()) {
+      return this->setError(WorkerError(ERROR_FROZEN));
+    }
+
+    RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(bValue, isolate);
+    if (b == nullptr) {
+      if (!this->inPlace) {
+        return this->setError(WorkerError("RoaringBitmap32 async operation second argument must be a RoaringBitmap32"));
+      }
+      // In place operations accept anything the constructor accepts, like the synchronous versions.
+      v8::Local<v8::Value> argv[] = {bValue};
+      v8::Local<v8::Object> converted;
+      if (!this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate)
+             ->NewInstance(isolate->GetCurrentContext(), 1, argv)
+             .ToLocal(&converted)) {
+        return;
+      }
+      bValue = converted;
+      b = ObjectWrap::TryUnwrap<RoaringBitmap32>(bValue, isolate);
+      if (b == nullptr) {
+        return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+      }
+    }
+
+    this->aPersistent.Reset(isolate, aValue);
+    this->bPersistent.Reset(isolate, bValue);
+
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    this->a = a->readonlyViewOf ? a->readonlyViewOf : a;
+    this->b = b->readonlyViewOf ? b->readonlyViewOf : b;
+    this->a->beginFreeze();
+    this->b->beginFreeze();
+  }
+
+  void work() final {
+    roaring_bitmap_t_ptr r = this->operation(this->a->roaring, this->b->roaring);
+    if (r == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32 async operation failed materalization"));
+    }
+    if (this->inPlace) {
+      // Count here, in the worker thread, so the size of the target is already known when the operation completes.
+      this->resultSize = (int64_t)roaring_bitmap_get_cardinality(r);
+    }
+    this->bitmap.store(r, std::memory_order_release);
+  }
+
+  void finally() final {
+    if (this->a) {
+      this->a->endFreeze();
+    }
+    if (this->b) {
+      this->b->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->inPlace) {
+      return RoaringBitmap32FactoryAsyncWorker::done(result);
+    }
+
+    roaring_bitmap_t_ptr r = this->bitmap.load(std::memory_order_acquire);
+    if (r == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32 async operation failed materalization"));
+    }
+
+    // Swap the content instead of the pointer, readonly views keep pointing to the same roaring bitmap.
+    // The previous content is released by the destructor of this worker.
+    std::swap(*this->a->roaring, *r);
+    this->a->invalidate(this->resultSize);
+
+    result = this->aPersistent.Get(this->isolate);
+  }
+};
+
+/**
+ * Base class for workers that compute a RoaringBitmap32 with a parallel reduction.
+ * Each partition is reduced to a partial bitmap in a different thread,
+ * the last partition to complete merges all the partial results, still in a worker thread.
+ */
+class RoaringBitmap32ParallelReduceWorker : public ParallelAsyncWorker {
+ public:
+  roaring_bitmap_t ** partials;
+  std::atomic<uint32_t> completedPartitions;
+  std::atomic<roaring_bitmap_t_ptr> bitmap;
+
+  explicit RoaringBitmap32ParallelReduceWorker(v8::Isolate * isolate, AddonData * addonData) :
+    ParallelAsyncWorker(isolate, addonData), partials(nullptr), completedPartitions(0), bitmap(nullptr) {}
+
+  virtual ~RoaringBitmap32ParallelReduceWorker() {
+    if (this->partials != nullptr) {
+      for (uint32_t i = 0; i != this->loopCount; ++i) {
+        if (this->partials[i] != nullptr) {
+          roaring_bitmap_free(this->partials[i]);
+        }
+      }
+      gcaware_free(this->isolate, this->partials);
+    }
+    roaring_bitmap_t_ptr ptr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (ptr != nullptr) {
+      roaring_bitmap_free(ptr);
+    }
+  }
+
+  /** Allocates the given number of partitions, one per thread. */
+  bool allocatePartitions(uint32_t count) {
+    if (count == 0) {
+      count = 1;
+    }
+    this->partials = (roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    if (this->partials == nullptr) {
+      return false;
+    }
+    memset(this->partials, 0, count * sizeof(roaring_bitmap_t *));
+    this->loopCount = count;
+    this->concurrency = count;
+    return true;
+  }
+
+ protected:
+  /** Sets the error from a worker thread, partitions can fail concurrently. */
+  void setPartitionError(const WorkerError & error) {
+    std::lock_guard<std::mutex> lock(this->_errorMutex);
+    this->setError(error);
+  }
+
+  /** Computes the partial result of a partition, in a worker thread. Returns nullptr on failure. */
+  virtual roaring_bitmap_t * reducePartition(uint32_t index) = 0;
+
+  /** Merges the partial results, in a worker thread. Returns nullptr on failure. */
+  virtual roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) = 0;
+
+  void parallelWork(uint32_t index) final {
+    roaring_bitmap_t * partial = this->reducePartition(index);
+    if (partial == nullptr) {
+      return this->setPartitionError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+    }
+    this->partials[index] = partial;
+
+    const uint32_t partitions = this->loopCount;
+    if (this->completedPartitions.fetch_add(1, std::memory_order_acq_rel) + 1 != partitions) {
+      return;
+    }
+
+    roaring_bitmap_t * result;
+    if (partitions == 1) {
+      result = partial;
+      this->partials[0] = nullptr;
+    } else {
+      result = this->mergePartitions(this->partials, partitions);
+      if (result == nullptr) {
+        return this->setPartitionError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+      }
+    }
+    this->bitmap.store(result, std::memory_order_release);
+  }
+
+  void done(v8::Local<v8::Value> & result) override {
+    roaring_bitmap_t_ptr bitmapPtr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (bitmapPtr == nullptr) {
+      bitmapPtr = roaring_bitmap_create();
+      if (bitmapPtr == nullptr) {
+        return this->setError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+      }
+    }
+
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(this->isolate);
+
+    if (!cons->NewInstance(this->isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+      roaring_bitmap_free(bitmapPtr);
+      return this->setError(WorkerError("RoaringBitmap32 parallel operation failed to create a new instance"));
+    }
+
+    RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, this->isolate);
+    if (unwrapped == nullptr) {
+      roaring_bitmap_free(bitmapPtr);
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+
+    unwrapped->replaceBitmapInstance(this->isolate, bitmapPtr);
+  }
+
+ private:
+  std::mutex _errorMutex;
+};
+
+/**
+ * Computes a multi-way OR, XOR or AND of many bitmaps with a parallel reduction.
+ * The inputs are split in partitions, each partition is reduced in a different thread.
+ * For an intersection the inputs sorted by size are interleaved, so every partition starts from one of the smallest.
+ */
+class ManyOperationParallelWorker final : public RoaringBitmap32ParallelReduceWorker {
+ public:
+  enum class Operation { OR, XOR, AND };
+
+  /** Below this number of bitmaps per partition, splitting the work is not worth the overhead. */
+  static const constexpr uint32_t MIN_PARTITION_SIZE = 4;
+
+  const Operation operation;
+  RoaringBitmap32Pins pins;
+  const roaring_bitmap_t ** inputs;
+  RoaringBitmap32 ** pinned;
+  uint32_t inputsCount;
+  uint32_t pinnedCount;
+  std::atomic<bool> emptyIntersection;
+
+  explicit ManyOperationParallelWorker(v8::Isolate * isolate, AddonData * addonData, Operation operation) :
+    RoaringBitmap32ParallelReduceWorker(isolate, addonData),
+    operation(operation),
+    inputs(nullptr),
+    pinned(nullptr),
+    inputsCount(0),
+    pinnedCount(0),
+    emptyIntersection(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ManyOperationParallelWorker));
+  }
+
+  virtual ~ManyOperationParallelWorker() {
+    gcaware_free(this->isolate, this->inputs);
+    gcaware_free(this->isolate, this->pinned);
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ManyOperationParallelWorker));
+  }
+
+  /** Allocates the inputs. Returns false if the allocation failed. */
+  bool reserve(uint32_t count) {
+    if (count == 0) {
+      return true;
+    }
+    this->inputs = (const roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    this->pinned = (RoaringBitmap32 **)gcaware_malloc(count * sizeof(RoaringBitmap32 *));
+    return this->inputs != nullptr && this->pinned != nullptr;
+  }
+
+  /** Adds an input bitmap and freezes it until the operation completes. */
+  void addInput(RoaringBitmap32 * input) {
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    RoaringBitmap32 * owner = input->readonlyViewOf ? input->readonlyViewOf : input;
+    owner->beginFreeze();
+    this->pins.pin(this->isolate, input);
+    this->pinned[this->pinnedCount++] = owner;
+    this->inputs[this->inputsCount++] = input->roaring;
+  }
+
+  /** Sorts the inputs by cardinality, smallest first, so each partition of an intersection starts from the smallest. */
+  void sortInputsBySize() {
+    roaringSortBySize(this->pinned, this->pinnedCount);
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->inputs[i] = this->pinned[i]->roaring;
+    }
+  }
+
+  /** Splits the inputs in partitions, one per thread. */
+  bool partition() {
+    uint32_t partitions = this->inputsCount / MIN_PARTITION_SIZE;
+    const uint32_t cpus = getCpusCount();
+    if (partitions > cpus) {
+      partitions = cpus;
+    }
+    if (!this->allocatePartitions(partitions)) {
+      return false;
+    }
+    if (this->operation == Operation::AND && this->loopCount > 1) {
+      // Partition p takes the sorted inputs p, p + partitions, p + 2 * partitions..., still sorted by size.
+      uint32_t position = 0;
+      for (uint32_t p = 0; p != this->loopCount; ++p) {
+        for (uint32_t i = p; i < this->pinnedCount; i += this->loopCount) {
+          this->inputs[position++] = this->pinned[i]->roaring;
+        }
+      }
+    }
+    return true;
+  }
+
+ protected:
+  roaring_bitmap_t * reducePartition(uint32_t index) final {
+    const uint32_t begin = this->partitionBegin(index);
+    return this->reduce(this->inputs + begin, this->partitionBegin(index + 1) - begin, false);
+  }
+
+  roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) final {
+    return this->reduce((const roaring_bitmap_t **)partials, count, true);
+  }
+
+  void finally() final {
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->pinned[i]->endFreeze();
+    }
+    this->pinnedCount = 0;
+  }
+
+ private:
+  /** The first input of a partition. The first count % partitions partitions have one input more than the others. */
+  uint32_t partitionBegin(uint32_t index) const {
+    const uint32_t partitions = this->loopCount;
+    return index * (this->inputsCount / partitions) + std::min(index, this->inputsCount % partitions);
+  }
+
+  roaring_bitmap_t * reduce(const roaring_bitmap_t ** x, uint32_t n, bool isMerge) {
+    if (n == 0) {
+      return roaring_bitmap_create();
+    }
+    if (n == 1) {
+      return roaring_bitmap_copy(x[0]);
+    }
+    switch (this->operation) {
+      case Operation::OR: return roaring_bitmap_or_many(n, x);
+      case Operation::XOR: return roaring_bitmap_xor_many(n, x);
+      default: break;
+    }
+    if (this->emptyIntersection.load(std::memory_order_relaxed)) {
+      return roaring_bitmap_create();
+    }
+    if (isMerge) {
+      // Inputs are sorted by size before partitioning, partial results are not.
+      std::sort(x, x + n, [](const roaring_bitmap_t * a, const roaring_bitmap_t * b) {
+        return roaring_bitmap_get_cardinality(a) < roaring_bitmap_get_cardinality(b);
+      });
+    }
+    roaring_bitmap_t * r = roaringAndMany(n, x);
+    if (r != nullptr && roaring_bitmap_is_empty(r)) {
+      // The intersection of everything is empty, other partitions can stop early.
+      this->emptyIntersection.store(true, std::memory_order_relaxed);
+    }
+    return r;
+  }
+};
+
+/**
+ * Computes the cardinality of the union or of the intersection of many bitmaps without materializing the result.
+ * The key space (high 16 bits) is split in ranges with about the same number of containers, each range is counted
+ * in a different thread and the partial counts are summed.
+ */
+class ManyCardinalityParallelWorker final : public ParallelAsyncWorker {
+ public:
+  enum class Operation { OR, AND };
+
+  /** Below this number of containers per range, splitting the work is not worth the overhead. */
+  static const constexpr int32_t MIN_PARTITION_CONTAINERS = 64;
+
+  const Operation operation;
+  RoaringBitmap32Pins pins;
+  const roaring_bitmap_t ** inputs;
+  RoaringBitmap32 ** pinned;
+  uint32_t * boundaries;
+  uint32_t inputsCount;
+  uint32_t pinnedCount;
+  std::atomic<uint64_t> cardinality;
+
+  explicit ManyCardinalityParallelWorker(v8::Isolate * isolate, AddonData * addonData, Operation operation) :
+    ParallelAsyncWorker(isolate, addonData),
+    operation(operation),
+    inputs(nullptr),
+    pinned(nullptr),
+    boundaries(nullptr),
+    inputsCount(0),
+    pinnedCount(0),
+    cardinality(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ManyCardinalityParallelWorker));
+  }
+
+  virtual ~ManyCardinalityParallelWorker() {
+    gcaware_free(this->isolate, this->inputs);
+    gcaware_free(this->isolate, this->pinned);
+    gcaware_free(this->isolate, this->boundaries);
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ManyCardinalityParallelWorker));
+  }
+
+  /** Allocates the inputs. Returns false if the allocation failed. */
+  bool reserve(uint32_t count) {
+    if (count == 0) {
+      return true;
+    }
+    this->inputs = (const roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    this->pinned = (RoaringBitmap32 **)gcaware_malloc(count * sizeof(RoaringBitmap32 *));
+    return this->inputs != nullptr && this->pinned != nullptr;
+  }
+
+  /** Adds an input bitmap and freezes it until the operation completes. */
+  void addInput(RoaringBitmap32 * input) {
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    RoaringBitmap32 * owner = input->readonlyViewOf ? input->readonlyViewOf : input;
+    owner->beginFreeze();
+    this->pins.pin(this->isolate, input);
+    this->pinned[this->pinnedCount++] = owner;
+    this->inputs[this->inputsCount++] = input->roaring;
+  }
+
+  /**
+   * Splits the key space in ranges, one per thread. An intersection visits only the keys of the smallest bitmap,
+   * that is sorted first, an union visits the keys of all the bitmaps, the ranges follow the keys of the largest one.
+   */
+  bool partition() {
+    if (this->operation == Operation::AND) {
+      roaringSortBySize(this->pinned, this->pinnedCount);
+      for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+        this->inputs[i] = this->pinned[i]->roaring;
+      }
+    }
+
+    const roaring_array_t * reference = nullptr;
+    for (uint32_t i = 0; i != this->inputsCount; ++i) {
+      const roaring_array_t * ra = &this->inputs[i]->high_low_container;
+      if (reference == nullptr || (this->operation == Operation::OR && ra->size > reference->size)) {
+        reference = ra;
+      }
+    }
+
+    uint32_t partitions = reference != nullptr ? (uint32_t)(reference->size / MIN_PARTITION_CONTAINERS) : 0;
+    const uint32_t cpus = getCpusCount();
+    if (partitions > cpus) {
+      partitions = cpus;
+    }
+    if (partitions == 0) {
+      partitions = 1;
+    }
+
+    this->boundaries = (uint32_t *)gcaware_malloc((partitions + 1) * sizeof(uint32_t));
+    if (this->boundaries == nullptr) {
+      return false;
+    }
+    this->boundaries[0] = 0;
+    for (uint32_t i = 1; i != partitions; ++i) {
+      this->boundaries[i] = reference->keys[(uint64_t)reference->size * i / partitions];
+    }
+    this->boundaries[partitions] = 1 << 16;
+    this->loopCount = partitions;
+    this->concurrency = partitions;
+    return true;
+  }
+
+ protected:
+  void parallelWork(uint32_t index) final {
+    uint64_t partial;
+    const bool succeeded = this->operation == Operation::OR
+      ? roaringOrManyCardinality(
+          this->inputs, this->inputsCount, partial, this->boundaries[index], this->boundaries[index + 1])
+      : roaringAndManyCardinality(
+          this->inputs, this->inputsCount, partial, this->boundaries[index], this->boundaries[index + 1]);
+    if (!succeeded) {
+      std::lock_guard<std::mutex> lock(this->_errorMutex);
+      return this->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+    }
+    this->cardinality.fetch_add(partial, std::memory_order_relaxed);
+  }
+
+  void finally() final {
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->pinned[i]->endFreeze();
+    }
+    this->pinnedCount = 0;
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    result = v8::Number::New(this->isolate, (double)this->cardinality.load(std::memory_order_acquire));
+  }
+
+ private:
+  std::mutex _errorMutex;
+};
+
+/**
+ * Deserializes a text file (comma, tab or newline separated values, or a JSON array) in parallel.
+ * The file is memory mapped and split in chunks at number boundaries, each chunk is parsed
+ * in a different thread in its own bitmap, and the bitmaps are merged with a multi-way OR.
+ */
+class DeserializeTextFileParallelWorker final : public RoaringBitmap32ParallelReduceWorker {
+ public:
+  /** The minimum size of a partition, files smaller than this are parsed by a single thread. */
+  static const constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+  RoaringBitmapFileDeserializer args;
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+
+  explicit DeserializeTextFileParallelWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    RoaringBitmap32ParallelReduceWorker(info.GetIsolate(), addonData),
+    info(info),
+    _mapped(false),
+    _isMmap(false),
+    _data(nullptr),
+    _size(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeTextFileParallelWorker));
+  }
+
+  virtual ~DeserializeTextFileParallelWorker() {
+    this->_unmap();
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeTextFileParallelWorker));
+  }
+
+ protected:
+  void before() final {
+    this->setError(this->args.parseArguments(this->info));
+    if (!this->hasError() && !this->allocatePartitions(this->_partitionsCount())) {
+      this->setError(WorkerError("RoaringBitmap32::deserializeFileAsync failed to allocate memory"));
+    }
+  }
+
+  roaring_bitmap_t * reducePartition(uint32_t index) final {
+    roaring_bitmap_t * r = roaring_bitmap_create();
+    if (r == nullptr) {
+      return nullptr;
+    }
+
+    if (!this->_map()) {
+      return r;
+    }
+
+    const uint32_t chunks = this->loopCount;
+    const size_t begin = (size_t)(((uint64_t)this->_size * index) / chunks);
+    const size_t end = (size_t)(((uint64_t)this->_size * (index + 1)) / chunks);
+    WorkerError error = deserializeRoaringCsvChunk(r, this->_data, this->_size, begin, end);
+    if (error.hasError()) {
+      this->setPartitionError(error);
+    }
+    return r;
+  }
+
+  roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) final {
+    this->_unmap();
+    return roaring_bitmap_or_many(count, (const roaring_bitmap_t **)partials);
+  }
+
+ private:
+  std::mutex _mapMutex;
+  bool _mapped;
+  bool _isMmap;
+  const char * _data;
+  size_t _size;
+
+  /**
+   * One partition per MIN_CHUNK_SIZE bytes of the file, at most one per CPU.
+   * A file that cannot be read gets a single partition, that reports the error when it maps the file.
+   */
+  uint32_t _partitionsCount() const {
+    struct stat st;
+    if (stat(this->args.filePath.c_str(), &st) == -1 || st.st_size <= 0) {
+      return 1;
+    }
+    const uint64_t chunks = (uint64_t)st.st_size / MIN_CHUNK_SIZE + 1;
+    const uint32_t cpus = getCpusCount();
+    return chunks < cpus ? (uint32_t)chunks : cpus;
+  }
+
+  /** Maps the file in memory, once, the first thread to get here does it. Returns false if the file is empty or on error. */
+  bool _map() {
+    std::lock_guard<std::mutex> lock(this->_mapMutex);
+    if (this->_mapped) {
+      return this->_data != nullptr && !this->hasError();
+    }
+    this->_mapped = true;
+
+    const std::string & filePath = this->args.filePath;
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd == -1) {
+      this->setPartitionError(WorkerError::from_errno("open", filePath));
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      this->setPartitionError(WorkerError::from_errno("fstat", filePath));
+      close(fd);
+      return false;
+    }
+
+    const size_t fileSize = (size_t)st.st_size;
+    if (fileSize == 0) {
+      close(fd);
+      return false;
+    }
+
+    void * buf = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (buf != MAP_FAILED) {
+      this->_isMmap = true;
+    } else {
+      // mmap failed, try to read the file into a buffer
+      buf = gcaware_aligned_malloc(32, fileSize);
+      if (buf == nullptr) {
+        this->setPartitionError(WorkerError::from_errno("mmap", filePath));
+        close(fd);
+        return false;
+      }
+      ssize_t bytesRead = read(fd, buf, fileSize);
+      if (bytesRead == -1 || (size_t)bytesRead != fileSize) {
+        this->setPartitionError(
+          bytesRead == -1 ? WorkerError::from_errno("read", filePath)
+                          : WorkerError("RoaringBitmap32::deserializeFileAsync read less bytes than expected"));
+        gcaware_aligned_free(buf);
+        close(fd);
+        return false;
+      }
+    }
+    close(fd);
+
+    this->_data = (const char *)buf;
+    this->_size = fileSize;
+    return true;
+  }
+
+  void _unmap() {
+    const char * data = this->_data;
+    if (data == nullptr) {
+      return;
+    }
+    this->_data = nullptr;
+    if (this->_isMmap) {
+      munmap((void *)data, this->_size);
+    } else {
+      gcaware_aligned_free((void *)data);
+    }
+  }
+};
+
+#endif  // ROARING_NODE_ASYNC_WORKERS_
+
+#line 6 "src/cpp/RoaringBitmap32-ops.h"
+
+/**
+ * Adds many values to a bitmap. If the values are sorted, runs of consecutive values are added as ranges,
+ * the values between the runs with roaring_bitmap_add_many.
+ */
+inline void roaringAddManyDetectingRuns(roaring_bitmap_t * r, const uint32_t * values, size_t count) {
+  static const constexpr size_t RANGE_MIN_LENGTH = 64;
+
+  // A branchless first pass, so unsorted input and sorted input without runs pay almost nothing.
+  size_t unsorted = 0, adjacent = 0;
+  for (size_t i = 1; i < count; ++i) {
+    unsorted += values[i] <= values[i - 1];
+    adjacent += values[i] == values[i - 1] + 1;
+  }
+  if (unsorted != 0 || adjacent < RANGE_MIN_LENGTH) {
+    return roaring_bitmap_add_many(r, count, values);
+  }
+
+  size_t pending = 0;
+  for (size_t i = 1; i < count;) {
+    if (values[i] != values[i - 1] + 1) {
+      ++i;
+      continue;
+    }
+    const size_t start = i - 1;
+    size_t end = i + 1;
+    while (end < count && values[end] == values[end - 1] + 1) {
+      ++end;
+    }
+    if (end - start >= RANGE_MIN_LENGTH) {
+      roaring_bitmap_add_many(r, start - pending, values + pending);
+      roaring_bitmap_add_range_closed(r, values[start], values[end - 1]);
+      pending = end;
+    }
+    i = end;
+  }
+  roaring_bitmap_add_many(r, count - pending, values + pending);
+}
+
+inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Local<v8::Value> arg, bool replace = false) {
+  if (self->isFrozen()) {
+    v8utils::throwError(isolate, ERROR_FROZEN);
+    return false;
+  }
+
+  if (arg.IsEmpty()) {
+    return false;
+  }
+
+  if (arg->IsNullOrUndefined()) {
+    if (replace && self->roaring->high_low_container.containers != nullptr) {
+      roaring_bitmap_clear(self->roaring);
+      self->invalidate(0);
+    }
+    return true;
+  }
+
+  if (!arg->IsObject()) {
+    return false;
+  }
+
+  if (arg->IsUint32Array() || arg->IsInt32Array() || arg->IsArrayBuffer() || arg->IsSharedArrayBuffer()) {
+    if (replace && self->roaring->high_low_container.containers != nullptr) {
+      roaring_bitmap_clear(self->roaring);
+    }
+    const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
+    roaringAddManyDetectingRuns(self->roaring, typedArray.data, typedArray.length);
+    self->invalidate();
+    return true;
+  }
+
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+  if (other != nullptr) {
+    if (self != other) {
+      if (replace || self->roaring->high_low_container.containers == nullptr) {
+        roaring_bitmap_overwrite(self->roaring, other->roaring);
+        self->invalidate(other->readonlyViewOf ? -1 : other->sizeCache);
+      } else {
+        roaring_bitmap_or_inplace(self->roaring, other->roaring);
+        self->invalidate();
+      }
+    }
+    return true;
+  }
+
+  AddonData * addonData = self->addonData;
+
+  if (arg->IsArray() && arg.As<v8::Array>()->Length() <= AddonData::SCRATCH_UINT32_ARRAY_LENGTH) {
+    // Converts plain arrays into a reusable Uint32Array instead of allocating a new one with Uint32Array.from.
+    uint32_t * data = nullptr;
+    v8::Local<v8::Uint32Array> scratch = addonData->acquireScratchUint32Array(data);
+    if (!scratch.IsEmpty()) {
+      const uint32_t length = arg.As<v8::Array>()->Length();
+      v8::Local<v8::Value> argv[] = {arg};
+      const bool converted =
+        !addonData->Uint32Array_set.Get(isolate)->Call(isolate->GetCurrentContext(), scratch, 1, argv).IsEmpty();
+      if (converted) {
+        if (replace) {
+          roaring_bitmap_clear(self->roaring);
+        }
+        roaringAddManyDetectingRuns(self->roaring, data, length);
+        self->invalidate();
+      }
+      addonData->releaseScratchUint32Array();
+      return converted;
+    }
+  }
+
+  v8::Local<v8::Value> argv[] = {arg};
+  auto tMaybe = addonData->Uint32Array_from.Get(isolate)->Call(
+    isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
+  v8::Local<v8::Value> t;
+  if (!tMaybe.ToLocal(&t)) return false;
+
+  const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, t);
+  if (replace) {
+    roaring_bitmap_clear(self->roaring);
+  }
+  roaringAddManyDetectingRuns(self->roaring, typedArray.data, typedArray.length);
+  self->invalidate();
+  return true;
+}
+
+void RoaringBitmap32_andCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_and_cardinality(self->roaring, other->roaring) : -1);
+}
+
+void RoaringBitmap32_orCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_or_cardinality(self->roaring, other->roaring) : -1);
+}
+
+void RoaringBitmap32_andNotCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_andnot_cardinality(self->roaring, other->roaring) : -1);
+}
+
+void RoaringBitmap32_xorCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  if (self == nullptr) {
+    return info.GetReturnValue().Set(0);
+  }
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other ? (double)roaring_bitmap_xor_cardinality(self->roaring, other->roaring) : -1);
+}
+
+void RoaringBitmap32_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  auto isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  info.GetReturnValue().Set(info.This());
+
+  int64_t added = 0;
+  auto roaring = self->roaring;
+  int len = info.Length();
+  auto context = isolate->GetCurrentContext();
+  uint32_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    auto arg = info[i];
+    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+      continue;
+    }
+    if (roaring_bitmap_add_checked(roaring, v)) {
+      ++added;
+    }
+  }
+  if (added != 0) {
+    self->invalidateAddingToSize(added);
+  }
+}
+
+void RoaringBitmap32_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  int64_t added = 0;
+  auto roaring = self->roaring;
+  uint32_t v = 0;
+  int len = info.Length();
+  auto context = isolate->GetCurrentContext();
+  for (int i = 0; i < len; ++i) {
+    auto arg = info[i];
+    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+      continue;
+    }
+    if (roaring_bitmap_add_checked(roaring, v)) {
+      ++added;
+    }
+  }
+  if (added != 0) {
+    self->invalidateAddingToSize(added);
+  }
+  info.GetReturnValue().Set(added != 0);
+}
+
+void RoaringBitmap32_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  int64_t removed = 0;
+  auto roaring = self->roaring;
+  uint32_t v = 0;
+  int len = info.Length();
+  auto context = isolate->GetCurrentContext();
+  for (int i = 0; i < len; ++i) {
+    auto arg = info[i];
+    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+      continue;
+    }
+    if (roaring_bitmap_remove_checked(roaring, v)) {
+      ++removed;
+    }
+  }
+  if (removed != 0) {
+    self->invalidateAddingToSize(-removed);
+  }
+  info.GetReturnValue().Set(removed != 0);
+}
+
+void RoaringBitmap32_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  auto isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    if (roaringAddMany(isolate, self, info[0])) {
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+  v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+}
+
+void RoaringBitmap32_pop(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint32_t v = roaring_bitmap_maximum(self->roaring);
+  bool result = roaring_bitmap_remove_checked(self->roaring, v);
+  if (result) {
+    self->invalidateAddingToSize(-1);
+    info.GetReturnValue().Set(v);
+  }
+}
+
+void RoaringBitmap32_shift(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  auto isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint32_t v = roaring_bitmap_minimum(self->roaring);
+  bool result = roaring_bitmap_remove_checked(self->roaring, v);
+  if (result) {
+    self->invalidateAddingToSize(-1);
+    info.GetReturnValue().Set(v);
+  }
+}
+
+void RoaringBitmap32_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (self->roaring && self->roaring->high_low_container.size == 0) {
+    info.GetReturnValue().Set(false);
+  } else {
+    if (self->roaring != nullptr) {
+      roaring_bitmap_clear(self->roaring);
+      roaring_bitmap_shrink_to_fit(self->roaring);
+      self->invalidate(0);
+    }
+    info.GetReturnValue().Set(true);
+  }
+}
+
+void RoaringBitmap32_removeMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  bool done = false;
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  if (info.Length() > 0) {
+    auto const & arg = info[0];
+
+    if (arg->IsUint32Array() || arg->IsInt32Array()) {
+      const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
+      roaring_bitmap_remove_many(self->roaring, typedArray.length, typedArray.data);
+      self->invalidate();
+      done = true;
+    } else {
+      AddonData * addonData = self->addonData;
+      RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+      if (other != nullptr) {
+        roaring_bitmap_andnot_inplace(self->roaring, other->roaring);
+        self->invalidate();
+        done = true;
+      } else {
+        v8::Local<v8::Value> argv[] = {arg};
+        auto tMaybe = addonData->Uint32Array_from.Get(isolate)->Call(
+          isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
+        v8::Local<v8::Value> t;
+        if (tMaybe.ToLocal(&t)) {
+          const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, t);
+          roaring_bitmap_remove_many(self->roaring, typedArray.length, typedArray.data);
+          self->invalidate();
+          done = true;
+        } else {
+          RoaringBitmap32 tmp(addonData, 0U);
+          if (roaringAddMany(isolate, &tmp, arg)) {
+            roaring_bitmap_andnot_inplace(self->roaring, tmp.roaring);
+            self->invalidate();
+            done = true;
+          }
+        }
+      }
+    }
+  }
+
+  if (done) {
+    info.GetReturnValue().Set(info.This());
+  } else {
+    v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+  }
+}
+
+void RoaringBitmap32_andInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    auto const & arg = info[0];
+    RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+    if (other != nullptr) {
+      roaring_bitmap_and_inplace(self->roaring, other->roaring);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    RoaringBitmap32 tmp(self->addonData, 0U);
+    if (roaringAddMany(isolate, &tmp, arg)) {
+      roaring_bitmap_and_inplace(self->roaring, tmp.roaring);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+
+  return v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+}
+
+void RoaringBitmap32_xorInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    auto const & arg = info[0];
+    RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+    if (other != nullptr) {
+      roaring_bitmap_xor_inplace(self->roaring, other->roaring);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    RoaringBitmap32 tmp(self->addonData, 0U);
+    roaringAddMany(info.GetIsolate(), &tmp, arg);
+    roaring_bitmap_xor_inplace(self->roaring, tmp.roaring);
+    self->invalidate();
+    return info.GetReturnValue().Set(info.This());
+  }
+
+  return v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
+}
+
+void RoaringBitmap32_binaryOperationAsync(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmap32BinaryOperation operation, bool inPlace) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  // Prototype methods do not carry the addon data, in place workers get it from this in before().
+  AddonData * addonData = nullptr;
+  if (!inPlace) {
+    addonData = AddonData::get(info);
+    if (addonData == nullptr) {
+      return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    }
+  }
+
+  auto * worker = new BinaryOperationAsyncWorker(info, addonData, operation, inPlace);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  const int callbackIndex = inPlace ? 1 : 2;
+  if (info.Length() > callbackIndex && info[callbackIndex]->IsFunction()) {
+    worker->setCallback(info[callbackIndex]);
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_and, true);
+}
+
+void RoaringBitmap32_andNotInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_andnot, true);
+}
+
+void RoaringBitmap32_orInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_or, true);
+}
+
+void RoaringBitmap32_xorInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_xor, true);
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_OPS_
+
+#line 1 "src/cpp/RoaringBitmap32-static-ops.h"
+#ifndef ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
+#define ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
+
+#line 6 "src/cpp/RoaringBitmap32-static-ops.h"
+
+void RoaringBitmap32_addOffsetStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 2) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset expects 2 arguments");
+  }
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr)
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset first argument must be a RoaringBitmap32");
+
+  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset failed to create new instance");
+  }
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  // Second argument is the offset, read as double
+  double offset = info[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(NAN);
+  if (std::isnan(offset)) {
+    offset = 0;
+  } else if (offset < -4294967296) {
+    offset = -4294967296;
+  } else if (offset > 4294967296) {
+    offset = 4294967296;
+  }
+
+  roaring_bitmap_t * r = roaring_bitmap_add_offset(a->roaring, (int64_t)offset);
+  if (r == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::addOffset failed materalization");
+  }
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_andStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::and expects 2 arguments");
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::and first argument must be a RoaringBitmap32");
+
+  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
+  if (b == nullptr)
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and second argument must be a RoaringBitmap32");
+
+  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and failed to create new instance");
+  }
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = roaring_bitmap_and(a->roaring, b->roaring);
+  if (r == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::and failed materalization");
+  }
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_orStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::or expects 2 arguments");
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::or first argument must be a RoaringBitmap32");
+  }
+
+  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
+  if (b == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::or second argument must be a RoaringBitmap32");
+  }
+
+  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) return;
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = roaring_bitmap_or(a->roaring, b->roaring);
+  if (r == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::or failed materalization");
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_xorStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 2) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor expects 2 arguments");
+  }
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor first argument must be a RoaringBitmap32");
+  }
+
+  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
+  if (b == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor second argument must be a RoaringBitmap32");
+  }
+
+  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) return;
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = roaring_bitmap_xor(a->roaring, b->roaring);
+  if (r == nullptr) return v8utils::throwTypeError(isolate, "RoaringBitmap32::xor failed materalization");
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_andNotStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot expects 2 arguments");
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot first argument must be a RoaringBitmap32");
+  }
+
+  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
+  if (b == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot second argument must be a RoaringBitmap32");
+  }
+
+  v8::Local<v8::Function> cons = a->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) return;
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = roaring_bitmap_andnot(a->roaring, b->roaring);
+  if (r == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andnot failed materalization");
+  }
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+template <typename TSize>
+void roaringOpMany(
+  const char * opName,
+  roaring_bitmap_t * op(TSize number, const roaring_bitmap_t ** x),
+  const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  int length = info.Length();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto context = isolate->GetCurrentContext();
+
+  if (length == 0) {
+    auto vMaybe = cons->NewInstance(context, 0, nullptr);
+    v8::Local<v8::Object> v;
+    if (vMaybe.ToLocal(&v)) {
+      info.GetReturnValue().Set(v);
+    }
+    return;
+  }
+
+  if (length == 1) {
+    if (info[0]->IsArray()) {
+      auto array = v8::Local<v8::Array>::Cast(info[0]);
+
+      size_t arrayLength = array->Length();
+
+      if (arrayLength == 0) {
+        auto vMaybe = cons->NewInstance(context, 0, nullptr);
+        v8::Local<v8::Object> v;
+        if (vMaybe.ToLocal(&v)) {
+          info.GetReturnValue().Set(v);
+        }
+        return;
+      }
+
+      if (arrayLength == 1) {
+        auto itemMaybe = array->Get(context, 0);
+
+        v8::Local<v8::Value> item;
+        if (!itemMaybe.ToLocal(&item)) {
+          return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+        }
+
+        v8::Local<v8::Value> argv[] = {item};
+        auto vMaybe = cons->NewInstance(context, 1, argv);
+        v8::Local<v8::Object> v;
+        if (vMaybe.ToLocal(&v)) {
+          info.GetReturnValue().Set(v);
+        }
+        return;
+      }
+
+      auto resultMaybe = cons->NewInstance(context, 0, nullptr);
+      v8::Local<v8::Object> result;
+      if (!resultMaybe.ToLocal(&result)) {
+        return;
+      }
+
+      auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+      if (!self) {
+        return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+      }
+
+      const auto ** x = (const roaring_bitmap_t **)gcaware_malloc(arrayLength * sizeof(roaring_bitmap_t *));
+      if (x == nullptr) {
+        return v8utils::throwTypeError(isolate, opName, " failed allocation");
+      }
+
+      for (size_t i = 0; i < arrayLength; ++i) {
+        v8::Local<v8::Value> item;
+        RoaringBitmap32 * p =
+          array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+        if (p == nullptr) {
+          gcaware_free(isolate, x);
+          return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+        }
+        x[i] = p->roaring;
+      }
+
+      roaring_bitmap_t * r = op((TSize)arrayLength, x);
+      gcaware_free(isolate, x);
+      if (r == nullptr) {
+        return v8utils::throwTypeError(isolate, opName, " failed roaring allocation");
+      }
+
+      self->replaceBitmapInstance(isolate, r);
+
+      info.GetReturnValue().Set(result);
+
+    } else {
+      v8::Local<v8::Value> argv[] = {info[0]};
+      auto vMaybe = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
+      v8::Local<v8::Object> v;
+      if (vMaybe.ToLocal(&v)) {
+        info.GetReturnValue().Set(v);
+      }
+    }
+  } else {
+    v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+    v8::Local<v8::Object> result;
+    if (!resultMaybe.ToLocal(&result)) {
+      return;
+    }
+
+    auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+    if (!self) {
+      return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    }
+
+    const auto ** x = (const roaring_bitmap_t **)gcaware_malloc(length * sizeof(roaring_bitmap_t *));
+    if (x == nullptr) {
+      return v8utils::throwTypeError(isolate, opName, " failed allocation");
+    }
+
+    for (int i = 0; i < length; ++i) {
+      RoaringBitmap32 * p = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, i);
+      if (p == nullptr) {
+        gcaware_free(isolate, x);
+        return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+      }
+      x[i] = p->roaring;
+    }
+
+    roaring_bitmap_t * r = op((TSize)length, x);
+    gcaware_free(isolate, x);
+    if (r == nullptr) {
+      return v8utils::throwTypeError(isolate, opName, " failed roaring allocation");
+    }
+
+    self->replaceBitmapInstance(isolate, r);
+
+    info.GetReturnValue().Set(result);
+  }
+}
+
+/**
+ * Collects the RoaringBitmap32 instances passed as a single array or as a list of arguments, starting at firstArg.
+ * Returns the number of bitmaps, or -1 if an argument is not a RoaringBitmap32 or the allocation failed.
+ * The returned array has room for one additional item and must be released with gcaware_free.
+ */
+int64_t roaringCollectBitmaps(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int firstArg, RoaringBitmap32 ** & bitmaps) {
+  v8::Isolate * isolate = info.GetIsolate();
+  auto context = isolate->GetCurrentContext();
+  const int length = info.Length() - firstArg;
+
+  bitmaps = nullptr;
+
+  v8::Local<v8::Array> array;
+  const bool isArray = length == 1 && info[firstArg]->IsArray();
+  if (isArray) {
+    array = v8::Local<v8::Array>::Cast(info[firstArg]);
+  }
+
+  const uint32_t count = isArray ? array->Length() : (length > 0 ? (uint32_t)length : 0);
+  bitmaps = (RoaringBitmap32 **)gcaware_malloc((count + 1) * sizeof(RoaringBitmap32 *));
+  if (bitmaps == nullptr) {
+    return -1;
+  }
+
+  for (uint32_t i = 0; i != count; ++i) {
+    RoaringBitmap32 * p;
+    if (isArray) {
+      v8::Local<v8::Value> item;
+      p = array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    } else {
+      p = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, firstArg + (int)i);
+    }
+    if (p == nullptr) {
+      gcaware_free(isolate, bitmaps);
+      bitmaps = nullptr;
+      return -1;
+    }
+    bitmaps[i] = p;
+  }
+
+  return count;
+}
+
+/** Intersects the given bitmaps smallest first. The given array is sorted in place. */
+roaring_bitmap_t * roaringAndManyBySize(v8::Isolate * isolate, RoaringBitmap32 ** bitmaps, size_t count) {
+  roaringSortBySize(bitmaps, count);
+  if (count != 0 && bitmaps[0]->isEmpty()) {
+    return roaring_bitmap_create();
+  }
+  const auto ** x = (const roaring_bitmap_t **)gcaware_malloc((count + 1) * sizeof(roaring_bitmap_t *));
+  if (x == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i != count; ++i) {
+    x[i] = bitmaps[i]->roaring;
+  }
+  roaring_bitmap_t * r = roaringAndMany(count, x);
+  gcaware_free(isolate, x);
+  return r;
+}
+
+void RoaringBitmap32_andManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andMany accepts only RoaringBitmap32 instances");
+  }
+
+  roaring_bitmap_t * r = roaringAndManyBySize(isolate, bitmaps, (size_t)count);
+  gcaware_free(isolate, bitmaps);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::andMany failed roaring allocation");
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * self = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)
+    ? ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate)
+    : nullptr;
+  if (self == nullptr) {
+    roaring_bitmap_free(r);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_andManyInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andManyInPlace accepts only RoaringBitmap32 instances");
+  }
+
+  bitmaps[count] = self;
+  roaring_bitmap_t * r = roaringAndManyBySize(isolate, bitmaps, (size_t)count + 1);
+  gcaware_free(isolate, bitmaps);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::andManyInPlace failed roaring allocation");
+  }
+
+  // Swap the content instead of the pointer, readonly views keep pointing to the same roaring bitmap.
+  std::swap(*self->roaring, *r);
+  roaring_bitmap_free(r);
+  self->invalidate();
+
+  info.GetReturnValue().Set(info.This());
+}
+
+void roaringOpManyCardinality(
+  const char * opName, ManyCardinalityParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+  }
+
+  const auto ** x = (const roaring_bitmap_t **)gcaware_malloc((count + 1) * sizeof(roaring_bitmap_t *));
+  if (x == nullptr) {
+    gcaware_free(isolate, bitmaps);
+    return v8utils::throwError(isolate, (std::string(opName) + " failed allocation").c_str());
+  }
+
+  if (operation == ManyCardinalityParallelWorker::Operation::AND) {
+    roaringSortBySize(bitmaps, (size_t)count);
+  }
+  for (int64_t i = 0; i != count; ++i) {
+    x[i] = bitmaps[i]->roaring;
+  }
+  gcaware_free(isolate, bitmaps);
+
+  uint64_t cardinality;
+  const bool succeeded = operation == ManyCardinalityParallelWorker::Operation::OR
+    ? roaringOrManyCardinality(x, (size_t)count, cardinality)
+    : roaringAndManyCardinality(x, (size_t)count, cardinality);
+  gcaware_free(isolate, x);
+  if (!succeeded) {
+    return v8utils::throwError(isolate, (std::string(opName) + " failed allocation").c_str());
+  }
+
+  info.GetReturnValue().Set((double)cardinality);
+}
+
+void RoaringBitmap32_andManyCardinalityStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinality("RoaringBitmap32::andManyCardinality", ManyCardinalityParallelWorker::Operation::AND, info);
+}
+
+void RoaringBitmap32_orManyCardinalityStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinality("RoaringBitmap32::orManyCardinality", ManyCardinalityParallelWorker::Operation::OR, info);
+}
+
+void RoaringBitmap32_orManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpMany("RoaringBitmap32::orMany", roaring_bitmap_or_many_heap, info);
+}
+
+void RoaringBitmap32_xorManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpMany("RoaringBitmap32::xorMany", roaring_bitmap_xor_many, info);
+}
+
+void RoaringBitmap32_andStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_and, false);
+}
+
+void RoaringBitmap32_andNotStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_andnot, false);
+}
+
+void RoaringBitmap32_orStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_or, false);
+}
+
+void RoaringBitmap32_xorStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_xor, false);
+}
+
+void roaringOpManyAsync(
+  const char * opName, ManyOperationParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new ManyOperationParallelWorker(isolate, addonData, operation);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  auto context = isolate->GetCurrentContext();
+
+  // Accepts both an array of bitmaps or a list of bitmaps as arguments, like the synchronous versions.
+  v8::Local<v8::Array> array;
+  if (length == 1 && info[0]->IsArray()) {
+    array = v8::Local<v8::Array>::Cast(info[0]);
+  } else {
+    array = v8::Array::New(isolate, length);
+    for (int i = 0; i < length; ++i) {
+      ignoreMaybeResult(array->Set(context, (uint32_t)i, info[i]));
+    }
+  }
+
+  const uint32_t arrayLength = array->Length();
+  if (!worker->reserve(arrayLength)) {
+    worker->setError(WorkerError("RoaringBitmap32 many operation failed allocation"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  for (uint32_t i = 0; i != arrayLength; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * p =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (p == nullptr) {
+      worker->setError(WorkerError(opName));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->addInput(p);
+  }
+
+  if (operation == ManyOperationParallelWorker::Operation::AND) {
+    worker->sortInputsBySize();
+  }
+
+  if (!worker->partition()) {
+    worker->setError(WorkerError("RoaringBitmap32 many operation failed allocation"));
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::andManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::AND, info);
+}
+
+void RoaringBitmap32_orManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::orManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::OR, info);
+}
+
+void RoaringBitmap32_xorManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::xorManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::XOR, info);
+}
+
+void roaringOpManyCardinalityAsync(
+  const char * opName, ManyCardinalityParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new ManyCardinalityParallelWorker(isolate, addonData, operation);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  auto context = isolate->GetCurrentContext();
+
+  // Accepts both an array of bitmaps or a list of bitmaps as arguments, like the synchronous versions.
+  v8::Local<v8::Array> array;
+  if (length == 1 && info[0]->IsArray()) {
+    array = v8::Local<v8::Array>::Cast(info[0]);
+  } else {
+    array = v8::Array::New(isolate, length);
+    for (int i = 0; i < length; ++i) {
+      ignoreMaybeResult(array->Set(context, (uint32_t)i, info[i]));
+    }
+  }
+
+  const uint32_t arrayLength = array->Length();
+  if (!worker->reserve(arrayLength)) {
+    worker->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  for (uint32_t i = 0; i != arrayLength; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * p =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (p == nullptr) {
+      worker->setError(WorkerError(opName));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->addInput(p);
+  }
+
+  if (!worker->partition()) {
+    worker->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andManyCardinalityStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinalityAsync(
+    "RoaringBitmap32::andManyCardinalityAsync accepts only RoaringBitmap32 instances",
+    ManyCardinalityParallelWorker::Operation::AND,
+    info);
+}
+
+void RoaringBitmap32_orManyCardinalityStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinalityAsync(
+    "RoaringBitmap32::orManyCardinalityAsync accepts only RoaringBitmap32 instances",
+    ManyCardinalityParallelWorker::Operation::OR,
+    info);
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
+
+#line 1 "src/cpp/RoaringBitmap32-serialization.h"
+#ifndef ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
+#define ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
+
+#line 7 "src/cpp/RoaringBitmap32-serialization.h"
+
+void RoaringBitmap32_serialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapSerializer serializer;
+  serializer.parseArguments(info);
+  if (serializer.self) {
+    WorkerError error = serializer.serialize();
+    if (error.hasError()) {
+      isolate->ThrowException(error.newV8Error(isolate));
+      return;
+    }
+    v8::Local<v8::Value> result;
+    serializer.done(isolate, result);
+    if (!result.IsEmpty()) {
+      info.GetReturnValue().Set(result);
+    }
+  }
+}
+
+void RoaringBitmap32_serializeAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  SerializeWorker * worker = new SerializeWorker(info, nullptr);
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_serializeFileAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  SerializeFileWorker * worker = new SerializeFileWorker(info, nullptr);
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_unsafeFrozenViewStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) {
+    return;
+  }
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  self->replaceBitmapInstance(isolate, nullptr);
+
+  if (info.Length() < 2) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView expects a format and a buffer arguments");
+  }
+
+  int bufferArgIndex = 1;
+  FrozenViewFormat format = tryParseFrozenViewFormat(info[0], isolate);
+  if (format == FrozenViewFormat::INVALID) {
+    bufferArgIndex = 0;
+    format = tryParseFrozenViewFormat(info[1], isolate);
+  }
+  if (format == FrozenViewFormat::INVALID) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView format argument is invalid");
+  }
+
+  v8utils::TypedArrayContent<uint8_t> storage(isolate, info[bufferArgIndex]);
+
+  v8utils::TypedArrayContent<uint8_t> & frozenStorage = self->frozenStorage;
+
+  if (
+    !info[bufferArgIndex]->IsNullOrUndefined() &&
+    !frozenStorage.set(isolate, info[bufferArgIndex]->ToObject(isolate->GetCurrentContext()))) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView buffer argument was invalid");
+  }
+
+  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+
+  roaring_bitmap_t * bitmap = nullptr;
+
+  switch (format) {
+    case FrozenViewFormat::unsafe_frozen_croaring: {
+      if (!is_pointer_aligned(storage.data, 32)) {
+        return v8utils::throwError(
+          isolate,
+          "RoaringBitmap32::unsafeFrozenView with format unsafe_frozen_croaring requires the buffer to be 32 bytes aligned. "
+          "You can use bufferAlignedAlloc, bufferAlignedAllocUnsafe or ensureBufferAligned exposed by the roaring library.");
+      }
+
+      bitmap =
+        const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view((const char *)frozenStorage.data, frozenStorage.length));
+      break;
+    }
+    case FrozenViewFormat::unsafe_frozen_portable: {
+      bitmap = roaring_bitmap_portable_deserialize_frozen((const char *)frozenStorage.data);
+      break;
+    }
+    default: {
+      return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView format argument is invalid");
+    }
+  }
+
+  if (!bitmap) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView failed to deserialize the input");
+  }
+
+  self->replaceBitmapInstance(isolate, bitmap);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_mapFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  if (info.Length() < 1 || !info[0]->IsString()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::mapFile expects a file path as the first argument");
+  }
+
+  FrozenViewFormat format = FrozenViewFormat::unsafe_frozen_croaring;
+  if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+    format = tryParseFrozenViewFormat(info[1], isolate);
+    if (format == FrozenViewFormat::INVALID) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::mapFile format argument is invalid");
+    }
+  }
+
+  v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+  const std::string filePath(*filePathUtf8, filePathUtf8.length());
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd == -1) {
+    isolate->ThrowException(WorkerError::from_errno("open", filePath).newV8Error(isolate));
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    WorkerError err = WorkerError::from_errno("fstat", filePath);
+    close(fd);
+    isolate->ThrowException(err.newV8Error(isolate));
+    return;
+  }
+
+  const size_t fileSize = (size_t)st.st_size;
+  if (fileSize == 0) {
+    // Nothing to map, an empty file is an empty bitmap.
+    close(fd);
+    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+    return info.GetReturnValue().Set(result);
+  }
+
+  // The mapping is shared, every process that maps the same file uses the same page cache pages.
+  void * data = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    WorkerError err = WorkerError::from_errno("mmap", filePath);
+    close(fd);
+    isolate->ThrowException(err.newV8Error(isolate));
+    return;
+  }
+  close(fd);
+
+  roaring_bitmap_t * bitmap;
+  if (format == FrozenViewFormat::unsafe_frozen_croaring) {
+    bitmap = const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view((const char *)data, fileSize));
+  } else if (roaring_bitmap_portable_deserialize_size((const char *)data, fileSize) == fileSize) {
+    // Checks the structure first, roaring_bitmap_portable_deserialize_frozen does not validate the input.
+    bitmap = const_cast<roaring_bitmap_t *>(roaring_bitmap_portable_deserialize_frozen((const char *)data));
+  } else {
+    bitmap = nullptr;
+  }
+
+  if (bitmap == nullptr) {
+    munmap(data, fileSize);
+    return v8utils::throwError(isolate, "RoaringBitmap32::mapFile failed to create a frozen view of the file");
+  }
+
+  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+  self->replaceBitmapInstance(isolate, bitmap);
+  self->mappedFile = data;
+  self->mappedFileSize = fileSize;
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_serializePackFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapPackFileSerializer serializer;
+  WorkerError error = serializer.parseArguments(info);
+  if (!error.hasError()) {
+    error = serializer.serialize();
+  }
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+  }
+}
+
+void RoaringBitmap32_serializePackFileAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new SerializePackFileWorker(info, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 serialization failed to allocate async worker");
+  }
+
+  if (info.Length() >= 4 && info[3]->IsFunction()) {
+    worker->setCallback(info[3]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_releaseMappedFile(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr || self->mappedFile == nullptr) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (!self->releaseMappedFile()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::releaseMappedFile - the bitmap is in use by an async operation");
+  }
+  info.GetReturnValue().Set(true);
+}
+
+void RoaringBitmap32_deserializeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) {
+    return;
+  }
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  self->replaceBitmapInstance(isolate, nullptr);
+
+  RoaringBitmapDeserializer deserializer;
+  WorkerError error = deserializer.parseArguments(info, false);
+  if (!error.hasError()) {
+    error = deserializer.deserialize();
+  }
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  deserializer.finalizeTargetBitmap(self);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_deserializeFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) {
+    return;
+  }
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  self->replaceBitmapInstance(isolate, nullptr);
+
+  RoaringBitmapFileDeserializer deserializer;
+  WorkerError error = deserializer.parseArguments(info);
+  if (!error.hasError()) {
+    error = deserializer.deserialize();
+  }
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  deserializer.finalizeTargetBitmap(self);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_deserialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapDeserializer deserializer;
+  WorkerError error = deserializer.parseArguments(info, true);
+  if (!error.hasError()) {
+    error = deserializer.deserialize();
+  }
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  deserializer.targetBitmap->replaceBitmapInstance(isolate, nullptr);
+
+  deserializer.finalizeTargetBitmap(deserializer.targetBitmap);
+
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_deserializeAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new DeserializeWorker(info, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 deserialization failed to allocate async worker");
+  }
+
+  if (info.Length() >= 3 && info[2]->IsFunction()) {
+    worker->setCallback(info[2]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_deserializeFileAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  AsyncWorker * worker;
+  switch (info.Length() >= 2 ? tryParseFileDeserializationFormat(info[1], isolate) : FileDeserializationFormat::INVALID) {
+    case FileDeserializationFormat::comma_separated_values:
+    case FileDeserializationFormat::tab_separated_values:
+    case FileDeserializationFormat::newline_separated_values:
+    case FileDeserializationFormat::json_array:
+      // Text files are split in chunks and parsed in parallel.
+      worker = new DeserializeTextFileParallelWorker(info, addonData);
+      break;
+    default: worker = new DeserializeFileWorker(info, addonData); break;
+  }
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 deserialization failed to allocate async worker");
+  }
+
+  if (info.Length() >= 3 && info[2]->IsFunction()) {
+    worker->setCallback(info[2]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_deserializeParallelStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new DeserializeParallelWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  if (info.Length() >= 3 && info[2]->IsFunction()) {
+    worker->setCallback(info[2]);
+  }
+
+  if (info.Length() < 2) {
+    worker->setError(WorkerError("RoaringBitmap32::deserializeAsync - requires at least two arguments"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  if (!info[0]->IsArray()) {
+    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync requires an array as first argument"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto array = v8::Local<v8::Array>::Cast(info[0]);
+  uint32_t length = array->Length();
+
+  if (length > 0x01FFFFFF) {
+    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync - array too big"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  DeserializationFormat format = tryParseDeserializationFormat(info[1], isolate);
+  if (format == DeserializationFormat::INVALID) {
+    worker->setError(
+      WorkerError("RoaringBitmap32::deserializeAsync - second argument must be a valid deserialization format"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  RoaringBitmapDeserializer * items = length ? new RoaringBitmapDeserializer[length]() : nullptr;
+  if (items == nullptr && length != 0) {
+    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync - failed to allocate array of deserializers"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  worker->items = items;
+  worker->loopCount = length;
+
+  auto context = isolate->GetCurrentContext();
+  for (uint32_t i = 0; i != length; ++i) {
+    WorkerError err = items[i].setOutput(isolate, array->Get(context, i), (FileDeserializationFormat)format);
+    if (err.hasError()) {
+      worker->setError(err);
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_serializeParallelStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new SerializeParallelWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int optionsArgIndex = -1;
+  if (info.Length() >= 3 && info[2]->IsFunction()) {
+    worker->setCallback(info[2]);
+  } else if (info.Length() >= 3) {
+    optionsArgIndex = 2;
+    if (info.Length() >= 4 && info[3]->IsFunction()) {
+      worker->setCallback(info[3]);
+    }
+  }
+
+  if (info.Length() < 2) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - requires at least two arguments"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  if (!info[0]->IsArray()) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync requires an array as first argument"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto array = v8::Local<v8::Array>::Cast(info[0]);
+  uint32_t length = array->Length();
+
+  if (length > 0x01FFFFFF) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - array too big"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto format = static_cast<FileSerializationFormat>(tryParseSerializationFormat(info[1], isolate));
+  if (format == FileSerializationFormat::INVALID) {
+    worker->setError(
+      WorkerError("RoaringBitmap32::serializeParallelAsync - second argument must be a valid serialization format"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto context = isolate->GetCurrentContext();
+  if (optionsArgIndex >= 0 && !info[optionsArgIndex]->IsUndefined()) {
+    if (!info[optionsArgIndex]->IsObject()) {
+      worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - options must be an object"));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    v8::Local<v8::Value> contiguous;
+    if (info[optionsArgIndex]
+          .As<v8::Object>()
+          ->Get(context, NEW_LITERAL_V8_STRING(isolate, "contiguous", v8::NewStringType::kInternalized))
+          .ToLocal(&contiguous)) {
+      worker->contiguous = contiguous->BooleanValue(isolate);
+    }
+  }
+
+  RoaringBitmapSerializer * items = length ? new RoaringBitmapSerializer[length]() : nullptr;
+  if (items == nullptr && length != 0) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate array of serializers"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  worker->items = items;
+  for (uint32_t i = 0; i != length; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * bitmap =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (bitmap == nullptr) {
+      worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync array can contain only RoaringBitmap32 instances"));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->pins.pin(isolate, bitmap);
+    items[i].self = bitmap;
+    items[i].format = format;
+  }
+
+  worker->loopCount = length;
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_getSerializationSizeInBytes(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return info.GetReturnValue().Set(0U);
+  }
+
+  SerializationFormat format =
+    info.Length() > 0 ? tryParseSerializationFormat(info[0], isolate) : SerializationFormat::INVALID;
+
+  if (format == SerializationFormat::INVALID) {
+    return v8utils::throwError(
+      info.GetIsolate(), "RoaringBitmap32::getSerializationSizeInBytes format argument was invalid");
+  }
+
+  switch (format) {
+    case SerializationFormat::croaring: {
+      auto cardinality = self->getSize();
+      auto sizeasarray = cardinality * sizeof(uint32_t) + sizeof(uint32_t);
+      auto portablesize = roaring_bitmap_portable_size_in_bytes(self->roaring);
+      if (portablesize < sizeasarray || sizeasarray >= MAX_SERIALIZATION_ARRAY_SIZE_IN_BYTES - 1) {
+        return info.GetReturnValue().Set((double)(portablesize) + 1);
+      }
+      return info.GetReturnValue().Set((double)(sizeasarray) + 1);
+    }
+
+    case SerializationFormat::portable: {
+      return info.GetReturnValue().Set((double)(roaring_bitmap_portable_size_in_bytes(self->roaring)));
+    }
+
+    case SerializationFormat::unsafe_frozen_croaring: {
+      return info.GetReturnValue().Set((double)(roaring_bitmap_frozen_size_in_bytes(self->roaring)));
+    }
+
+    default: {
+      return v8utils::throwError(
+        info.GetIsolate(), "RoaringBitmap32::getSerializationSizeInBytes format argument was invalid");
+    }
+  }
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
+
+#line 1 "src/cpp/RoaringBitmap32-ranges.h"
+#ifndef ROARING_NODE_ROARING_BITMAP32_RANGES_
+#define ROARING_NODE_ROARING_BITMAP32_RANGES_
+
+#line 6 "src/cpp/RoaringBitmap32-ranges.h"
+
+inline bool getRangeOperationParameters(
+  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & minInteger, uint64_t & maxInteger) {
+  v8::Isolate * isolate = info.GetIsolate();
+  double minimum = 0, maximum = 4294967296;
+
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    if (!info[0]->IsNumber()) {
+      return false;
+    }
+    if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&minimum)) {
+      minimum = 0;
+    }
+  }
+
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    if (!info[1]->IsNumber()) {
+      return false;
+    }
+    if (!info[1]->NumberValue(isolate->GetCurrentContext()).To(&maximum)) {
+      maximum = 4294967296;
+    }
+  }
+
+  if (std::isnan(minimum) || std::isnan(maximum) || minimum > 4294967295 || maximum <= 0) {
+    return false;
+  }
+
+  if (minimum < 0) {
+    minimum = 0;
+  }
+
+  minimum = ceil(minimum);
+  maximum = ceil(maximum);
+
+  if (maximum > 4294967296) {
+    maximum = 4294967296;
+  }
+
+  minInteger = (uint64_t)minimum;
+  maxInteger = (uint64_t)maximum;
+
+  return minimum < 4294967296 && minInteger < maxInteger;
+}
+
+/**
+ * Number of values of the bitmap in [minInteger, maxInteger), used to keep the cached size valid across a range mutation.
+ * Returns 0 without counting if the size is not cached, as the size will be recomputed anyway.
+ */
+inline int64_t roaringRangeCardinalityIfSizeKnown(const RoaringBitmap32 * self, uint64_t minInteger, uint64_t maxInteger) {
+  return self->sizeCache >= 0 ? (int64_t)roaring_bitmap_range_cardinality(self->roaring, minInteger, maxInteger) : 0;
+}
+
+void RoaringBitmap32_rangeCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t minInteger, maxInteger;
+  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
+    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+    if (!self) {
+      return info.GetReturnValue().Set(0u);
+    }
+    auto card = roaring_bitmap_range_cardinality(self->roaring, minInteger, maxInteger);
+    if (card <= 0xFFFFFFFF) {
+      return info.GetReturnValue().Set((uint32_t)card);
+    }
+    return info.GetReturnValue().Set((double)card);
+  }
+  return info.GetReturnValue().Set(0u);
+}
+
+void RoaringBitmap32_flipRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t minInteger, maxInteger;
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  }
+  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
+    if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
+      roaring_bitmap_flip_inplace(self->roaring, minInteger, maxInteger);
+      self->invalidateAddingToSize((int64_t)(maxInteger - minInteger) - 2 * before);
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_addRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t minInteger, maxInteger;
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  }
+  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
+    if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
+      roaring_bitmap_add_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
+      self->invalidateAddingToSize((int64_t)(maxInteger - minInteger) - before);
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_removeRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t minInteger, maxInteger;
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  }
+  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
+    if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
+      roaring_bitmap_remove_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
+      self->invalidateAddingToSize(-before);
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_intersectsWithRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  uint64_t minInteger, maxInteger;
+  info.GetReturnValue().Set(
+    self != nullptr && getRangeOperationParameters(info, minInteger, maxInteger) &&
+    roaring_bitmap_intersect_with_range(self->roaring, (uint64_t)minInteger, (uint64_t)(maxInteger - 1)));
+}
+
+void RoaringBitmap32_toUint32Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  size_t size = self->getSize();
+  size_t maxSize = size;
+
+  v8utils::TypedArrayContent<uint32_t> typedArrayContent;
+  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+    if (info[0]->IsNumber()) {
+      double maxSizeDouble;
+      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxSizeDouble) || std::isnan(maxSizeDouble)) {
+        return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - argument must be a valid integer number");
+      }
+      maxSize = maxSizeDouble <= 0 ? 0 : (maxSizeDouble >= size ? size : (size_t)maxSizeDouble);
+    } else {
+      if (!argumentIsValidUint32ArrayOutput(info[0]) || !typedArrayContent.set(isolate, info[0])) {
+        return v8utils::throwError(
+          isolate, "RoaringBitmap32::toUint32Array - argument must be a UInt32Array, Int32Array or ArrayBuffer");
+      }
+
+      bool arrayIsSmaller = typedArrayContent.length < size;
+      if (arrayIsSmaller) {
+        roaring_bitmap_range_uint32_array(self->roaring, 0, typedArrayContent.length, typedArrayContent.data);
+        size = typedArrayContent.length;
+      }
+
+      v8::Local<v8::Value> result;
+      if (!v8utils::v8ValueToUint32ArrayWithLimit(isolate, typedArrayContent.bufferPersistent.Get(isolate), size, result)) {
+        return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to create a new UInt32Array");
+      }
+
+      if (size != 0 && !arrayIsSmaller) {
+        roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
+      }
+
+      return info.GetReturnValue().Set(result);
+    }
+  }
+
+  auto arrayBuffer = v8::ArrayBuffer::New(isolate, maxSize * sizeof(uint32_t));
+  if (arrayBuffer.IsEmpty()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
+  }
+  auto typedArray = v8::Uint32Array::New(arrayBuffer, 0, maxSize);
+  if (typedArray.IsEmpty()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
+  }
+
+  if (maxSize != 0) {
+    if (!typedArrayContent.set(isolate, typedArray)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
+    }
+    if (maxSize < size) {
+      roaring_bitmap_range_uint32_array(self->roaring, 0, maxSize, typedArrayContent.data);
+    } else {
+      roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
+    }
+  }
+
+  info.GetReturnValue().Set(typedArray);
+}
+
+void RoaringBitmap32_toUint32ArrayAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  ToUint32ArrayAsyncWorker * worker = new ToUint32ArrayAsyncWorker(info, nullptr);
+  if (!worker) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32ArrayAsync - allocation failed");
+  }
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_rangeUint32Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  double num;
+
+  int outputArgIndex = -1;
+  int offsetArgIndex = -1;
+  int limitArgIndex = -1;
+
+  if (info[0]->IsNumber()) {
+    offsetArgIndex = 0;
+
+    if (info.Length() > 1) {
+      if (info[1]->IsNumber()) {
+        limitArgIndex = 1;
+        if (info.Length() > 2 && !info[2]->IsUndefined()) {
+          outputArgIndex = 2;
+        }
+      } else {
+        outputArgIndex = 1;
+      }
+    }
+  } else {
+    outputArgIndex = 0;
+    if (info.Length() > 1) {
+      offsetArgIndex = 1;
+      if (info.Length() > 2 && !info[2]->IsUndefined()) {
+        limitArgIndex = 2;
+      }
+    }
+  }
+
+  size_t offset = 0;
+  if (offsetArgIndex == -1) {
+    if (outputArgIndex == -1) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - offset or output argument is missing");
+    }
+  } else {
+    if (!info[offsetArgIndex]->NumberValue(isolate->GetCurrentContext()).To(&num) || std::isnan(num)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - limit argument must be a valid integer");
+    }
+    offset = (size_t)std::min(std::max(num, 0.0), 4294967296.0);
+  }
+
+  if (limitArgIndex == -1 && outputArgIndex == -1) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - missing limit or output argument");
+  }
+
+  size_t limit = 4294967296;
+  if (limitArgIndex != -1) {
+    if (!info[limitArgIndex]->NumberValue(isolate->GetCurrentContext()).To(&num) || std::isnan(num)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - limit argument must be a valid integer");
+    }
+    limit = (size_t)std::min(std::max(num, 0.0), 4294967296.0);
+  }
+
+  v8utils::TypedArrayContent<uint32_t> typedArrayContent;
+
+  if (outputArgIndex != -1) {
+    if (!argumentIsValidUint32ArrayOutput(info[outputArgIndex]) || !typedArrayContent.set(isolate, info[outputArgIndex])) {
+      return v8utils::throwError(
+        isolate, "RoaringBitmap32::rangeUint32Array - output argument must be a UInt32Array, Int32Array or ArrayBuffer");
+    }
+    limit = std::min(limit, typedArrayContent.length);
+  }
+
+  size_t size;
+  auto cardinality = self->getSize();
+  if (offset > cardinality) {
+    size = 0;
+  } else {
+    size = limit < cardinality - offset ? limit : cardinality - offset;
+    if (offset > cardinality) {
+      size = 0;
+    }
+    if (limit > cardinality - offset) {
+      limit = cardinality - offset;
+    }
+  }
+
+  if (outputArgIndex == -1) {
+    auto arrayBuffer = v8::ArrayBuffer::New(isolate, size * sizeof(uint32_t));
+    if (arrayBuffer.IsEmpty()) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an ArrayBuffer");
+    }
+    auto typedArray = v8::Uint32Array::New(arrayBuffer, 0, size);
+    if (typedArray.IsEmpty()) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an Uint32Array");
+    }
+    if (!typedArrayContent.set(isolate, typedArray)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an Uint32Array");
+    }
+  }
+
+  if (size > 0) {
+    if (offset == 0 && limit == cardinality) {
+      roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
+    } else {
+      if (!roaring_bitmap_range_uint32_array(self->roaring, offset, limit, typedArrayContent.data)) {
+        return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to build the range");
+      }
+    }
+  }
+
+  v8::Local<v8::Value> result;
+  if (!v8utils::v8ValueToUint32ArrayWithLimit(isolate, typedArrayContent.bufferPersistent.Get(isolate), size, result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32ArrayAsync - failed to create an Uint32Array range");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_toArray(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  size_t cardinality = self ? self->getSize() : 0;
+
+  struct iter_data {
+    uint32_t index;
+    uint32_t count;
+    double maxLength;
+    v8::Isolate * isolate;
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Array> jsArray;
+  } iterData;
+
+  iterData.index = 0;
+  iterData.count = 0;
+  iterData.isolate = isolate;
+  iterData.context = isolate->GetCurrentContext();
+
+  double maxLength = (double)cardinality;
+
+  // Check if the first argument is an array
+  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+    if (info[0]->IsNumber()) {
+      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxLength)) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - maxLength argument must be a valid number");
+      }
+      if (maxLength > cardinality) {
+        maxLength = (double)cardinality;
+      }
+      iterData.jsArray = v8::Array::New(isolate, (uint32_t)maxLength);
+    } else {
+      v8::Local<v8::Object> obj;
+      if (!info[0]->ToObject(isolate->GetCurrentContext()).ToLocal(&obj) || !obj->IsArray()) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - argument must be an array");
+      }
+      iterData.jsArray = v8::Local<v8::Array>::Cast(obj);
+
+      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        if (
+          !info[1]->IsNumber() || !info[1]->NumberValue(isolate->GetCurrentContext()).To(&maxLength) ||
+          std::isnan(maxLength)) {
+          return v8utils::throwTypeError(
+            isolate, "RoaringBitmap32::toArray - maxLength must be zero or a valid uint32 value");
+        }
+        if (maxLength > cardinality) {
+          maxLength = (double)cardinality;
+        }
+      }
+
+      int64_t offset = 0;
+      if (info.Length() >= 3 && !info[2]->IsUndefined()) {
+        if (
+          !info[2]->IsNumber() || !info[2]->IntegerValue(isolate->GetCurrentContext()).To(&offset) || offset < 0 ||
+          offset > 4294967295) {
+          return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - offset must be zero or a valid uint32 value");
+        }
+        iterData.index = (uint32_t)offset;
+      } else {
+        iterData.index = iterData.jsArray->Length();
+      }
+    }
+  } else {
+    iterData.jsArray = v8::Array::New(isolate, cardinality);
+  }
+
+  iterData.maxLength = maxLength;
+
+  info.GetReturnValue().Set(iterData.jsArray);
+
+  if (cardinality != 0) {
+    roaring_iterate(
+      self->roaring,
+      [](uint32_t value, void * vp) -> bool {
+        auto * p = reinterpret_cast<iter_data *>(vp);
+        bool r = false;
+        return (p->count++) < p->maxLength &&
+          p->jsArray->Set(p->context, p->index++, v8::Uint32::NewFromUnsigned(p->isolate, value)).To(&r) && r;
+      },
+      (void *)&iterData);
+  }
+}
+
+void RoaringBitmap32_toReversed(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  const size_t cardinality = self ? self->getSize() : 0;
+
+  const size_t maxJsLength = 0xFFFFFFFFull;
+  size_t limit = cardinality;
+  size_t skip = 0;
+  uint32_t writeIndex = 0;
+  bool arrayProvided = false;
+  v8::Local<v8::Array> jsArray;
+
+  auto clampSize = [&](v8::Local<v8::Value> value, size_t maxValue) -> size_t {
+    if (value.IsEmpty() || value->IsUndefined() || value->IsNull()) {
+      return 0;
+    }
+    double d;
+    if (!value->NumberValue(context).To(&d) || std::isnan(d)) {
+      return 0;
+    }
+    if (d <= 0) {
+      return 0;
+    }
+    double limitDouble = static_cast<double>(maxValue);
+    if (d >= limitDouble) {
+      return maxValue;
+    }
+    return static_cast<size_t>(d);
+  };
+
+  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+    if (info[0]->IsNumber()) {
+      limit = clampSize(info[0], cardinality);
+      if (limit > maxJsLength) {
+        limit = maxJsLength;
+      }
+      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        skip = clampSize(info[1], cardinality);
+      }
+    } else {
+      v8::Local<v8::Object> obj;
+      if (!info[0]->ToObject(context).ToLocal(&obj) || !obj->IsArray()) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toReversed - argument must be an array");
+      }
+      jsArray = v8::Local<v8::Array>::Cast(obj);
+      arrayProvided = true;
+
+      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        limit = clampSize(info[1], cardinality);
+        if (limit > maxJsLength) {
+          limit = maxJsLength;
+        }
+      }
+
+      if (info.Length() >= 3 && !info[2]->IsUndefined()) {
+        size_t offset = clampSize(info[2], maxJsLength);
+        writeIndex = static_cast<uint32_t>(offset);
+      } else {
+        writeIndex = jsArray->Length();
+      }
+
+      if (info.Length() >= 4 && !info[3]->IsUndefined()) {
+        skip = clampSize(info[3], cardinality);
+      }
+    }
+  }
+
+  if (limit > maxJsLength) {
+    limit = maxJsLength;
+  }
+
+  size_t writeCapacity = maxJsLength - writeIndex;
+  if (limit > writeCapacity) {
+    limit = writeCapacity;
+  }
+
+  size_t available = cardinality > skip ? cardinality - skip : 0;
+  if (limit > available) {
+    limit = available;
+  }
+
+  if (!arrayProvided) {
+    jsArray = v8::Array::New(isolate, static_cast<uint32_t>(limit));
+  }
+
+  info.GetReturnValue().Set(jsArray);
+
+  if (self == nullptr || jsArray.IsEmpty() || limit == 0) {
+    return;
+  }
+
+  roaring_uint32_iterator_t it;
+  roaring_iterator_init_last(self->roaring, &it);
+  if (skip != 0 && roaring_uint32_iterator_skip_backward(&it, (uint32_t)skip) != skip) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::toReversed - failed to build the range");
+  }
+
+  constexpr size_t kChunkSize = 1024;
+  uint32_t buffer[kChunkSize];
+  size_t processed = 0;
+
+  while (processed < limit) {
+    size_t chunk = limit - processed;
+    if (chunk > kChunkSize) {
+      chunk = kChunkSize;
+    }
+    if (roaringIteratorReadReverse(&it, buffer, (uint32_t)chunk) != chunk) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::toReversed - failed to build the range");
+    }
+    for (size_t i = 0; i < chunk; ++i) {
+      bool ok = false;
+      uint32_t targetIndex = writeIndex + static_cast<uint32_t>(processed + i);
+      if (!jsArray->Set(context, targetIndex, v8::Uint32::NewFromUnsigned(isolate, buffer[i])).To(&ok) || !ok) {
+        return;
+      }
+    }
+    processed += chunk;
+  }
+}
+
+void RoaringBitmap32_toSet(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  struct iter_data {
+    uint64_t count;
+    double maxLength;
+    v8::Isolate * isolate;
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Set> jsSet;
+  } iterData;
+
+  iterData.count = 0;
+  iterData.maxLength = std::numeric_limits<double>::infinity();
+  iterData.isolate = isolate;
+  iterData.context = isolate->GetCurrentContext();
+
+  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+    if (info[0]->IsNumber()) {
+      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&iterData.maxLength)) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toSet - maxLength argument must be a valid number");
+      }
+      iterData.jsSet = v8::Set::New(isolate);
+    } else {
+      v8::Local<v8::Object> obj;
+      if (!info[0]->ToObject(isolate->GetCurrentContext()).ToLocal(&obj) || !obj->IsSet()) {
+        return v8utils::throwError(isolate, "RoaringBitmap32::toSet - argument must be a Set");
+      }
+
+      iterData.jsSet = v8::Local<v8::Set>::Cast(obj);
+
+      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        if (!info[1]->IsNumber() || !info[1]->NumberValue(isolate->GetCurrentContext()).To(&iterData.maxLength)) {
+          return v8utils::throwTypeError(isolate, "RoaringBitmap32::toSet - maxLength argument must be a valid number");
+        }
+      }
+    }
+  } else {
+    iterData.jsSet = v8::Set::New(isolate);
+  }
+
+  if (std::isnan(iterData.maxLength)) {
+    iterData.maxLength = std::numeric_limits<double>::infinity();
+  }
+
+  info.GetReturnValue().Set(iterData.jsSet);
+
+  if (self != nullptr && !self->isEmpty()) {
+    roaring_iterate(
+      self->roaring,
+      [](uint32_t value, void * vp) -> bool {
+        auto * p = reinterpret_cast<iter_data *>(vp);
+        return p->count++ < p->maxLength &&
+          !p->jsSet->Add(p->context, v8::Uint32::NewFromUnsigned(p->isolate, value)).IsEmpty();
+      },
+      (void *)&iterData);
+  }
+}
+
+void RoaringBitmap32_hasRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return info.GetReturnValue().Set(false);
+  }
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  double minimum, maximum;
+  if (
+    info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber() || !info[0]->NumberValue(context).To(&minimum) ||
+    !info[1]->NumberValue(context).To(&maximum)) {
+    return info.GetReturnValue().Set(false);
+  }
+
+  if (std::isnan(minimum) || std::isnan(maximum)) {
+    return info.GetReturnValue().Set(false);
+  }
+
+  minimum = ceil(minimum);
+  maximum = ceil(maximum);
+  if (minimum < 0 || maximum > 4294967296) {
+    return info.GetReturnValue().Set(false);
+  }
+
+  uint64_t minInteger = (uint64_t)minimum;
+  uint64_t maxInteger = (uint64_t)maximum;
+
+  if (minInteger >= maxInteger || maxInteger > 4294967296) {
+    return info.GetReturnValue().Set(false);
+  }
+
+  info.GetReturnValue().Set(roaring_bitmap_contains_range(self->roaring, minInteger, maxInteger));
+}
+
+void RoaringBitmap32_fromRangeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+  v8::Local<v8::Object> result;
+  if (!resultMaybe.ToLocal(&result)) return;
+
+  uint32_t v;
+  uint32_t step = 1;
+  if (info.Length() >= 3 && info[2]->IsNumber() && info[2]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    step = v;
+    if (step == 0) {
+      step = 1;
+    }
+  }
+
+  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (!self) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+
+  uint64_t minInteger, maxInteger;
+  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
+    roaring_bitmap_t * r = roaring_bitmap_from_range(minInteger, maxInteger, step);
+    if (r != nullptr) {
+      self->replaceBitmapInstance(isolate, r);
+    }
+  }
+
+  info.GetReturnValue().Set(result);
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP32_RANGES_
+
+#line 1 "src/cpp/RoaringBitmap32-pairwise.h"
+#ifndef ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
+#define ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
+
+#line 6 "src/cpp/RoaringBitmap32-pairwise.h"
+
+enum class PairwiseMetric {
+  INVALID = -1,
+  intersection = 0,
+  jaccard = 1,
+  cosine = 2,
+};
+
+inline PairwiseMetric tryParsePairwiseMetric(const v8::Local<v8::Value> & value, v8::Isolate * isolate) {
+  if (!isolate || value.IsEmpty() || !value->IsString()) {
+    return PairwiseMetric::INVALID;
+  }
+  v8::String::Utf8Value metricString(isolate, value);
+  if (strcmp(*metricString, "intersection") == 0) {
+    return PairwiseMetric::intersection;
+  }
+  if (strcmp(*metricString, "jaccard") == 0) {
+    return PairwiseMetric::jaccard;
+  }
+  if (strcmp(*metricString, "cosine") == 0) {
+    return PairwiseMetric::cosine;
+  }
+  return PairwiseMetric::INVALID;
+}
+
+/**
+ * Computes the metric of two bitmaps from the cardinality of their intersection and their sizes.
+ * The result is NaN for a jaccard index of two empty bitmaps and for a cosine similarity with an empty bitmap.
+ * It never decreases when the intersection grows, so it can be used to compute upper bounds.
+ */
+inline double roaringPairwiseScore(PairwiseMetric metric, uint64_t intersection, uint64_t sizeA, uint64_t sizeB) {
+  switch (metric) {
+    case PairwiseMetric::intersection: return (double)intersection;
+    case PairwiseMetric::jaccard: return (double)intersection / (double)(sizeA + sizeB - intersection);
+    default: return (double)intersection / std::sqrt((double)sizeA * (double)sizeB);
+  }
+}
+
+/**
+ * Computes a metric between all the pairs of an array of bitmaps.
+ *
+ * The pair space is split in square tiles of TILE_SIZE x TILE_SIZE bitmaps, a tile compares the bitmaps of a block of rows
+ * with the bitmaps of a block of columns, so the containers of the two blocks stay in the cache while the tile is computed.
+ * Tiles are independent and can be computed concurrently.
+ *
+ * The output is the upper triangle without the diagonal, row by row, or the full symmetric n x n matrix.
+ * The intersection metric is written in a Uint32Array, the other metrics in a Float64Array.
+ */
+class RoaringBitmapPairwise final {
+ public:
+  static const constexpr uint32_t TILE_SIZE = 64;
+
+  RoaringBitmap32 ** bitmaps = nullptr;
+  uint64_t * sizes = nullptr;
+  uint32_t count = 0;
+  PairwiseMetric metric = PairwiseMetric::INVALID;
+  bool full = false;
+
+  /** The block of rows and the block of columns of each tile. */
+  uint32_t * tiles = nullptr;
+  uint32_t tilesCount = 0;
+
+  void * output = nullptr;
+  size_t outputLength = 0;
+
+  v8::Isolate * isolate = nullptr;
+
+  RoaringBitmapPairwise() = default;
+  RoaringBitmapPairwise(const RoaringBitmapPairwise &) = delete;
+  RoaringBitmapPairwise & operator=(const RoaringBitmapPairwise &) = delete;
+
+  ~RoaringBitmapPairwise() {
+    this->endFreeze();
+    if (this->bitmaps != nullptr) {
+      gcaware_free(this->isolate, this->bitmaps);
+    }
+    if (this->sizes != nullptr) {
+      gcaware_free(this->isolate, this->sizes);
+    }
+    if (this->tiles != nullptr) {
+      gcaware_free(this->isolate, this->tiles);
+    }
+    bare_aligned_free(this->output);
+  }
+
+  /** Parses (bitmaps, metric, options), options is an optional object with a boolean full property. */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentsCount) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
+
+    if (argumentsCount < 2) {
+      return WorkerError("RoaringBitmap32::pairwise expects an array of bitmaps and a metric");
+    }
+    if (!info[0]->IsArray()) {
+      return WorkerError("RoaringBitmap32::pairwise expects an array of RoaringBitmap32 as the first argument");
+    }
+    this->metric = tryParsePairwiseMetric(info[1], isolate);
+    if (this->metric == PairwiseMetric::INVALID) {
+      return WorkerError("RoaringBitmap32::pairwise metric must be one of intersection, jaccard, cosine");
+    }
+
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    if (argumentsCount >= 3 && !info[2]->IsUndefined()) {
+      if (!info[2]->IsObject()) {
+        return WorkerError("RoaringBitmap32::pairwise options must be an object");
+      }
+      v8::Local<v8::Value> fullValue;
+      if (info[2]
+            .As<v8::Object>()
+            ->Get(context, NEW_LITERAL_V8_STRING(isolate, "full", v8::NewStringType::kInternalized))
+            .ToLocal(&fullValue)) {
+        this->full = fullValue->BooleanValue(isolate);
+      }
+    }
+
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[0]);
+    const uint32_t length = array->Length();
+    const uint64_t cells = this->full ? (uint64_t)length * length : (uint64_t)length * (length - (length != 0)) / 2;
+    const size_t cellSize = this->metric == PairwiseMetric::intersection ? sizeof(uint32_t) : sizeof(double);
+    if (cells > node::Buffer::kMaxLength / cellSize) {
+      return WorkerError("RoaringBitmap32::pairwise too many bitmaps, the matrix would be too big");
+    }
+
+    if (length != 0) {
+      this->bitmaps = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      this->sizes = (uint64_t *)gcaware_malloc(length * sizeof(uint64_t));
+      if (this->bitmaps == nullptr || this->sizes == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise array can contain only RoaringBitmap32 instances");
+      }
+      this->bitmaps[i] = bitmap;
+      this->sizes[i] = bitmap->getSize();
+      this->count = i + 1;
+    }
+
+    // The tiles of the upper triangle of the blocks matrix, row by row.
+    const uint64_t blocks = ((uint64_t)length + TILE_SIZE - 1) / TILE_SIZE;
+    if (blocks * (blocks + 1) / 2 > UINT32_MAX) {
+      return WorkerError("RoaringBitmap32::pairwise too many bitmaps, the matrix would be too big");
+    }
+    this->tilesCount = (uint32_t)(blocks * (blocks + 1) / 2);
+    if (this->tilesCount != 0) {
+      this->tiles = (uint32_t *)gcaware_malloc(this->tilesCount * 2 * sizeof(uint32_t));
+      if (this->tiles == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+      }
+    }
+    uint32_t * tile = this->tiles;
+    for (uint32_t row = 0; row != (uint32_t)blocks; ++row) {
+      for (uint32_t column = row; column != (uint32_t)blocks; ++column) {
+        *tile++ = row;
+        *tile++ = column;
+      }
+    }
+
+    this->outputLength = (size_t)cells;
+    this->output = bare_aligned_malloc(32, cells != 0 ? (size_t)cells * cellSize : 1);
+    if (this->output == nullptr) {
+      return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+    }
+    return WorkerError();
+  }
+
+  /** Freezes the bitmaps, so they cannot be modified while compared in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      for (uint32_t i = 0; i != this->count; ++i) {
+        this->owner(i)->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      for (uint32_t i = 0; i != this->count; ++i) {
+        this->owner(i)->endFreeze();
+      }
+    }
+  }
+
+  /** Computes the cells of a tile. Different tiles can be computed concurrently. */
+  void computeTile(uint32_t index) {
+    const uint32_t n = this->count;
+    const uint32_t rowBegin = this->tiles[index * 2] * TILE_SIZE;
+    const uint32_t columnBegin = this->tiles[index * 2 + 1] * TILE_SIZE;
+    const uint32_t rowEnd = std::min(rowBegin + TILE_SIZE, n);
+    const uint32_t columnEnd = std::min(columnBegin + TILE_SIZE, n);
+
+    for (uint32_t i = rowBegin; i < rowEnd; ++i) {
+      const roaring_bitmap_t * a = this->bitmaps[i]->roaring;
+      if (this->full && rowBegin == columnBegin) {
+        this->write((uint64_t)i * n + i, this->sizes[i], this->sizes[i], this->sizes[i]);
+      }
+      // Index of the cell (i, i + 1) in the upper triangle.
+      const uint64_t rowStart = (uint64_t)i * (2 * (uint64_t)n - i - 1) / 2;
+      for (uint32_t j = std::max(columnBegin, i + 1); j < columnEnd; ++j) {
+        const uint64_t intersection = roaring_bitmap_and_cardinality(a, this->bitmaps[j]->roaring);
+        if (this->full) {
+          this->write((uint64_t)i * n + j, intersection, this->sizes[i], this->sizes[j]);
+          this->write((uint64_t)j * n + i, intersection, this->sizes[i], this->sizes[j]);
+        } else {
+          this->write(rowStart + (j - i - 1), intersection, this->sizes[i], this->sizes[j]);
+        }
+      }
+    }
+  }
+
+  /** Creates the output typed array, the output memory is moved to the typed array. */
+  bool createResult(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
+    const size_t cellSize = this->metric == PairwiseMetric::intersection ? sizeof(uint32_t) : sizeof(double);
+    std::unique_ptr<v8::BackingStore> backingStore =
+      v8::ArrayBuffer::NewBackingStore(this->output, this->outputLength * cellSize, bare_aligned_free_callback2, nullptr);
+    if (!backingStore) {
+      return false;
+    }
+    this->output = nullptr;
+    v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, std::move(backingStore));
+    if (arrayBuffer.IsEmpty()) {
+      return false;
+    }
+    if (this->metric == PairwiseMetric::intersection) {
+      result = v8::Uint32Array::New(arrayBuffer, 0, this->outputLength);
+    } else {
+      result = v8::Float64Array::New(arrayBuffer, 0, this->outputLength);
+    }
+    return !result.IsEmpty();
+  }
+
+ private:
+  bool frozen = false;
+
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->bitmaps[index];
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  inline void write(uint64_t cell, uint64_t intersection, uint64_t sizeA, uint64_t sizeB) {
+    if (this->metric == PairwiseMetric::intersection) {
+      // Only the intersection of two full bitmaps does not fit, it saturates.
+      ((uint32_t *)this->output)[cell] = intersection > UINT32_MAX ? UINT32_MAX : (uint32_t)intersection;
+    } else {
+      ((double *)this->output)[cell] = roaringPairwiseScore(this->metric, intersection, sizeA, sizeB);
+    }
+  }
+};
+
+class PairwiseWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmapPairwise pairwise;
+  RoaringBitmap32Pins pins;
+
+  explicit PairwiseWorker(v8::Isolate * isolate, AddonData * addonData) : ParallelAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(PairwiseWorker));
+  }
+
+  virtual ~PairwiseWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(PairwiseWorker)); }
+
+ protected:
+  void before() final {
+    this->pairwise.beginFreeze();
+    this->loopCount = this->pairwise.tilesCount;
+  }
+
+  void parallelWork(uint32_t index) final { this->pairwise.computeTile(index); }
+
+  void finally() final { this->pairwise.endFreeze(); }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->pairwise.createResult(this->isolate, result)) {
+      return this->setError(WorkerError("RoaringBitmap32::pairwiseAsync failed to create the result"));
+    }
+  }
+};
+
+void RoaringBitmap32_pairwiseStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapPairwise pairwise;
+  WorkerError error = pairwise.parseArguments(info, info.Length());
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  for (uint32_t i = 0; i != pairwise.tilesCount; ++i) {
+    pairwise.computeTile(i);
+  }
+
+  v8::Local<v8::Value> result;
+  if (!pairwise.createResult(isolate, result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::pairwise failed to create the result");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_pairwiseStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new PairwiseWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  WorkerError error = worker->pairwise.parseArguments(info, length);
+  if (error.hasError()) {
+    worker->setError(error);
+  } else {
+    for (uint32_t i = 0; i != worker->pairwise.count; ++i) {
+      worker->pins.pin(isolate, worker->pairwise.bitmaps[i]);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
+
+#line 1 "src/cpp/RoaringBitmap32-topk.h"
+#ifndef ROARING_NODE_ROARINGBITMAP32_TOPK_
+#define ROARING_NODE_ROARINGBITMAP32_TOPK_
+
+#line 7 "src/cpp/RoaringBitmap32-topk.h"
+
+struct RoaringTopKEntry {
+  double score;
+  uint32_t index;
+
+  /** Higher scores first, lower indices first on equal scores. */
+  static inline bool better(const RoaringTopKEntry & a, const RoaringTopKEntry & b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+  }
+};
+
+/**
+ * Finds the k candidates most similar to a query bitmap.
+ *
+ * An upper bound of the score of every candidate is computed up front from the sizes and from the overlap of the ranges
+ * [minimum, maximum] of the query and of the candidate. Candidates are visited from the highest bound, each partition
+ * keeps the best k in a bounded heap and stops as soon as the next bound is below the worst score in the heap.
+ * Partitions take the candidates interleaved, so every partition starts from the most promising ones.
+ */
+class RoaringBitmapTopK final {
+ public:
+  /** Below this number of candidates per partition, splitting the work is not worth the overhead. */
+  static const constexpr uint32_t MIN_PARTITION_SIZE = 256;
+
+  RoaringBitmap32 * query = nullptr;
+  RoaringBitmap32 ** candidates = nullptr;
+  uint32_t count = 0;
+  uint32_t k = 0;
+  uint64_t querySize = 0;
+  PairwiseMetric metric = PairwiseMetric::INVALID;
+
+  /** Candidate indices sorted by upper bound, highest first. */
+  uint32_t * order = nullptr;
+  double * bounds = nullptr;
+  uint64_t * sizes = nullptr;
+
+  uint32_t partitions = 0;
+  std::vector<RoaringTopKEntry> * heaps = nullptr;
+
+  v8::Isolate * isolate = nullptr;
+
+  RoaringBitmapTopK() = default;
+  RoaringBitmapTopK(const RoaringBitmapTopK &) = delete;
+  RoaringBitmapTopK & operator=(const RoaringBitmapTopK &) = delete;
+
+  ~RoaringBitmapTopK() {
+    this->endFreeze();
+    if (this->candidates != nullptr) {
+      gcaware_free(this->isolate, this->candidates);
+    }
+    if (this->order != nullptr) {
+      gcaware_free(this->isolate, this->order);
+    }
+    if (this->bounds != nullptr) {
+      gcaware_free(this->isolate, this->bounds);
+    }
+    if (this->sizes != nullptr) {
+      gcaware_free(this->isolate, this->sizes);
+    }
+    delete[] this->heaps;
+  }
+
+  /** Parses (query, candidates, k, metric) and computes the upper bounds. */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentsCount) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
+
+    if (argumentsCount < 4) {
+      return WorkerError("RoaringBitmap32::topK expects a query bitmap, an array of candidates, k and a metric");
+    }
+    this->query = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+    if (this->query == nullptr) {
+      return WorkerError("RoaringBitmap32::topK expects a RoaringBitmap32 as the first argument");
+    }
+    if (!info[1]->IsArray()) {
+      return WorkerError("RoaringBitmap32::topK expects an array of RoaringBitmap32 as the second argument");
+    }
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    const double kValue = info[2]->IsNumber() ? info[2]->NumberValue(context).FromMaybe(NAN) : NAN;
+    if (!(kValue >= 0)) {
+      return WorkerError("RoaringBitmap32::topK k must be a non negative number");
+    }
+    this->metric = tryParsePairwiseMetric(info[3], isolate);
+    if (this->metric == PairwiseMetric::INVALID) {
+      return WorkerError("RoaringBitmap32::topK metric must be one of intersection, jaccard, cosine");
+    }
+
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[1]);
+    const uint32_t length = array->Length();
+    this->k = kValue < (double)length ? (uint32_t)kValue : length;
+    if (length != 0) {
+      this->candidates = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      this->order = (uint32_t *)gcaware_malloc(length * sizeof(uint32_t));
+      this->bounds = (double *)gcaware_malloc(length * sizeof(double));
+      this->sizes = (uint64_t *)gcaware_malloc(length * sizeof(uint64_t));
+      if (this->candidates == nullptr || this->order == nullptr || this->bounds == nullptr || this->sizes == nullptr) {
+        return WorkerError("RoaringBitmap32::topK failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * candidate =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (candidate == nullptr) {
+        return WorkerError("RoaringBitmap32::topK array can contain only RoaringBitmap32 instances");
+      }
+      this->candidates[i] = candidate;
+      this->count = i + 1;
+    }
+
+    const roaring_bitmap_t * q = this->query->roaring;
+    const uint64_t querySize = this->query->getSize();
+    this->querySize = querySize;
+    const uint64_t queryMin = querySize != 0 ? roaring_bitmap_minimum(q) : 0;
+    const uint64_t queryMax = querySize != 0 ? roaring_bitmap_maximum(q) : 0;
+    for (uint32_t i = 0; i != length; ++i) {
+      const uint64_t size = this->candidates[i]->getSize();
+      this->sizes[i] = size;
+      this->order[i] = i;
+      uint64_t maxIntersection = 0;
+      if (size != 0 && querySize != 0) {
+        const roaring_bitmap_t * c = this->candidates[i]->roaring;
+        const uint64_t low = std::max(queryMin, (uint64_t)roaring_bitmap_minimum(c));
+        const uint64_t high = std::min(queryMax, (uint64_t)roaring_bitmap_maximum(c));
+        maxIntersection = high >= low ? std::min(std::min(querySize, size), high - low + 1) : 0;
+      }
+      const double bound = roaringPairwiseScore(this->metric, maxIntersection, querySize, size);
+      // Candidates that can only have an undefined score are never returned, they go last.
+      this->bounds[i] = std::isnan(bound) ? -1 : bound;
+    }
+    const double * bounds = this->bounds;
+    std::stable_sort(
+      this->order, this->order + length, [bounds](uint32_t a, uint32_t b) { return bounds[a] > bounds[b]; });
+
+    this->partitions = this->k != 0 ? std::max(1U, std::min(getCpusCount(), length / MIN_PARTITION_SIZE)) : 0;
+    if (this->partitions != 0) {
+      this->heaps = new std::vector<RoaringTopKEntry>[this->partitions]();
+    }
+    return WorkerError();
+  }
+
+  /** Freezes the query and the candidates, so they cannot be modified while compared in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      owner(this->query)->beginFreeze();
+      for (uint32_t i = 0; i != this->count; ++i) {
+        owner(this->candidates[i])->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      owner(this->query)->endFreeze();
+      for (uint32_t i = 0; i != this->count; ++i) {
+        owner(this->candidates[i])->endFreeze();
+      }
+    }
+  }
+
+  /** Finds the best k candidates of a partition. Different partitions can be computed concurrently. */
+  void computePartition(uint32_t partition) {
+    std::vector<RoaringTopKEntry> & heap = this->heaps[partition];
+    heap.reserve(this->k);
+    const roaring_bitmap_t * q = this->query->roaring;
+    for (uint32_t position = partition; position < this->count; position += this->partitions) {
+      const uint32_t index = this->order[position];
+      if (heap.size() == this->k && this->bounds[index] < heap.front().score) {
+        break;  // Bounds are sorted, no other candidate of this partition can enter the heap.
+      }
+      const uint64_t intersection = roaring_bitmap_and_cardinality(q, this->candidates[index]->roaring);
+      const RoaringTopKEntry entry = {
+        roaringPairwiseScore(this->metric, intersection, this->querySize, this->sizes[index]), index};
+      if (std::isnan(entry.score)) {
+        continue;
+      }
+      if (heap.size() < this->k) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+      } else if (RoaringTopKEntry::better(entry, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+      }
+    }
+  }
+
+  /** Merges the partitions and creates the result object { indices: Uint32Array, scores: Float64Array }. */
+  bool createResult(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
+    std::vector<RoaringTopKEntry> merged;
+    for (uint32_t i = 0; i != this->partitions; ++i) {
+      merged.insert(merged.end(), this->heaps[i].begin(), this->heaps[i].end());
+    }
+    std::sort(merged.begin(), merged.end(), RoaringTopKEntry::better);
+    const size_t length = std::min(merged.size(), (size_t)this->k);
+
+    v8::Local<v8::ArrayBuffer> indicesBuffer = v8::ArrayBuffer::New(isolate, length * sizeof(uint32_t));
+    v8::Local<v8::ArrayBuffer> scoresBuffer = v8::ArrayBuffer::New(isolate, length * sizeof(double));
+    if (indicesBuffer.IsEmpty() || scoresBuffer.IsEmpty()) {
+      return false;
+    }
+    uint32_t * indices = (uint32_t *)indicesBuffer->GetBackingStore()->Data();
+    double * scores = (double *)scoresBuffer->GetBackingStore()->Data();
+    for (size_t i = 0; i != length; ++i) {
+      indices[i] = merged[i].index;
+      scores[i] = merged[i].score;
+    }
+
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Object> resultObject = v8::Object::New(isolate);
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "indices", v8::NewStringType::kInternalized),
+      v8::Uint32Array::New(indicesBuffer, 0, length)));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "scores", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(scoresBuffer, 0, length)));
+    result = resultObject;
+    return true;
+  }
+
+ private:
+  bool frozen = false;
+
+  static RoaringBitmap32 * owner(RoaringBitmap32 * bitmap) {
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+};
+
+class TopKWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmapTopK topK;
+  RoaringBitmap32Pins pins;
+
+  explicit TopKWorker(v8::Isolate * isolate, AddonData * addonData) : ParallelAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(TopKWorker));
+  }
+
+  virtual ~TopKWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(TopKWorker)); }
+
+ protected:
+  void before() final {
+    this->topK.beginFreeze();
+    this->loopCount = this->topK.partitions;
+    this->concurrency = this->topK.partitions;
+  }
+
+  void parallelWork(uint32_t index) final { this->topK.computePartition(index); }
+
+  void finally() final { this->topK.endFreeze(); }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->topK.createResult(this->isolate, result)) {
+      return this->setError(WorkerError("RoaringBitmap32::topKAsync failed to create the result"));
+    }
+  }
+};
+
+void RoaringBitmap32_topKStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapTopK topK;
+  WorkerError error = topK.parseArguments(info, info.Length());
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  for (uint32_t i = 0; i != topK.partitions; ++i) {
+    topK.computePartition(i);
+  }
+
+  v8::Local<v8::Value> result;
+  if (!topK.createResult(isolate, result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::topK failed to create the result");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_topKStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new TopKWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  WorkerError error = worker->topK.parseArguments(info, length);
+  if (error.hasError()) {
+    worker->setError(error);
+  } else {
+    worker->pins.pin(isolate, worker->topK.query);
+    for (uint32_t i = 0; i != worker->topK.count; ++i) {
+      worker->pins.pin(isolate, worker->topK.candidates[i]);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_TOPK_
+
+#line 1 "src/cpp/RoaringBitmap32-evaluate.h"
+#ifndef ROARING_NODE_ROARINGBITMAP32_EVALUATE_
+#define ROARING_NODE_ROARINGBITMAP32_EVALUATE_
+
+#line 6 "src/cpp/RoaringBitmap32-evaluate.h"
+
+enum class RoaringExpressionOperation { LEAF, OR, AND, AND_NOT, XOR };
+
+struct RoaringExpressionNode {
+  RoaringExpressionOperation op;
+  /** The bitmap of a leaf. */
+  const roaring_bitmap_t * bitmap;
+  /** Upper bound of the cardinality of the result, used to order intersections and to skip empty operands. */
+  uint64_t estimate;
+  /** Range of the operands in RoaringExpression::operands. */
+  uint32_t firstOperand;
+  uint32_t operandsCount;
+};
+
+/**
+ * A boolean expression over bitmaps, parsed from nested arrays: [operation, ...operands], where an operand is a
+ * RoaringBitmap32 or another expression. Operations are "or", "and", "andNot" (the first operand minus all the others)
+ * and "xor".
+ *
+ * The expression is evaluated natively in a single call. Intermediate results are plain roaring bitmaps, leaves are
+ * never copied unless they are the result. Intersections are computed smallest first and stop as soon as they are
+ * empty, unions are lazy and repaired once at the end.
+ */
+class RoaringExpression final {
+ public:
+  /** Limits the recursion, it also rejects arrays that contain themselves. */
+  static const constexpr uint32_t MAX_DEPTH = 512;
+  static const constexpr uint64_t MAX_CARDINALITY = (uint64_t)1 << 32;
+
+  std::vector<RoaringExpressionNode> nodes;
+  std::vector<uint32_t> operands;
+  std::vector<RoaringBitmap32 *> leaves;
+  uint32_t root = 0;
+
+  RoaringExpression() = default;
+  RoaringExpression(const RoaringExpression &) = delete;
+  RoaringExpression & operator=(const RoaringExpression &) = delete;
+
+  ~RoaringExpression() { this->endFreeze(); }
+
+  /** Parses the expression. Returns an error message, or nullptr on success. */
+  const char * parse(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+    const char * error = this->parseNode(isolate, value, 0, this->root);
+    if (error != nullptr) {
+      this->nodes.clear();
+      this->operands.clear();
+      this->leaves.clear();
+    }
+    return error;
+  }
+
+  /** Freezes the operands, so they cannot be modified while the expression is evaluated in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      for (RoaringBitmap32 * leaf : this->leaves) {
+        owner(leaf)->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      for (RoaringBitmap32 * leaf : this->leaves) {
+        owner(leaf)->endFreeze();
+      }
+    }
+  }
+
+  /** Evaluates the expression into a new bitmap. Returns nullptr if an allocation failed. */
+  roaring_bitmap_t * evaluate() const {
+    const roaring_bitmap_t * view;
+    roaring_bitmap_t * owned;
+    if (!this->evaluateNode(this->root, view, owned)) {
+      return nullptr;
+    }
+    return owned != nullptr ? owned : roaring_bitmap_copy(view);
+  }
+
+ private:
+  bool frozen = false;
+
+  static RoaringBitmap32 * owner(RoaringBitmap32 * bitmap) {
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  const char * parseNode(v8::Isolate * isolate, v8::Local<v8::Value> value, uint32_t depth, uint32_t & index) {
+    if (depth >= MAX_DEPTH) {
+      return "RoaringBitmap32::evaluate - expression is too deep";
+    }
+
+    if (value.IsEmpty()) {
+      return "RoaringBitmap32::evaluate - an operand must be a RoaringBitmap32 or an array [operation, ...operands]";
+    }
+
+    RoaringBitmap32 * leaf = ObjectWrap::TryUnwrap<RoaringBitmap32>(value, isolate);
+    if (leaf != nullptr) {
+      index = (uint32_t)this->nodes.size();
+      this->nodes.push_back({RoaringExpressionOperation::LEAF, leaf->roaring, leaf->getSize(), 0, 0});
+      this->leaves.push_back(leaf);
+      return nullptr;
+    }
+
+    if (!value->IsArray()) {
+      return "RoaringBitmap32::evaluate - an operand must be a RoaringBitmap32 or an array [operation, ...operands]";
+    }
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+    const uint32_t length = array->Length();
+    v8::Local<v8::Value> opValue;
+    if (length == 0 || !array->Get(context, 0).ToLocal(&opValue) || !opValue->IsString()) {
+      return "RoaringBitmap32::evaluate - an expression must start with the operation";
+    }
+
+    RoaringExpressionOperation op;
+    v8::String::Utf8Value opString(isolate, opValue);
+    if (strcmp(*opString, "or") == 0) {
+      op = RoaringExpressionOperation::OR;
+    } else if (strcmp(*opString, "and") == 0) {
+      op = RoaringExpressionOperation::AND;
+    } else if (strcmp(*opString, "andNot") == 0) {
+      op = RoaringExpressionOperation::AND_NOT;
+    } else if (strcmp(*opString, "xor") == 0) {
+      op = RoaringExpressionOperation::XOR;
+    } else {
+      return "RoaringBitmap32::evaluate - operation must be one of or, and, andNot, xor";
+    }
+
+    std::vector<uint32_t> children;
+    children.reserve(length - 1);
+    for (uint32_t i = 1; i < length; ++i) {
+      v8::Local<v8::Value> item;
+      if (!array->Get(context, i).ToLocal(&item)) {
+        return "RoaringBitmap32::evaluate - failed to read the expression";
+      }
+      uint32_t child;
+      const char * error = this->parseNode(isolate, item, depth + 1, child);
+      if (error != nullptr) {
+        return error;
+      }
+      children.push_back(child);
+    }
+
+    uint64_t estimate = 0;
+    if (!children.empty()) {
+      switch (op) {
+        case RoaringExpressionOperation::AND:
+          // Smallest first: the running intersection never grows and becomes empty sooner.
+          std::stable_sort(children.begin(), children.end(), [this](uint32_t a, uint32_t b) {
+            return this->nodes[a].estimate < this->nodes[b].estimate;
+          });
+          estimate = this->nodes[children[0]].estimate;
+          break;
+        case RoaringExpressionOperation::AND_NOT: estimate = this->nodes[children[0]].estimate; break;
+        default:
+          for (uint32_t child : children) {
+            estimate += this->nodes[child].estimate;
+          }
+          estimate = std::min(estimate, MAX_CARDINALITY);
+          break;
+      }
+    }
+
+    index = (uint32_t)this->nodes.size();
+    this->nodes.push_back({op, nullptr, estimate, (uint32_t)this->operands.size(), (uint32_t)children.size()});
+    this->operands.insert(this->operands.end(), children.begin(), children.end());
+    return nullptr;
+  }
+
+  /**
+   * Evaluates a node. On success, view is the result; owned is the same bitmap if it was allocated by the evaluation
+   * and must be freed by the caller, or nullptr if view is a leaf.
+   */
+  bool evaluateNode(uint32_t index, const roaring_bitmap_t *& view, roaring_bitmap_t *& owned) const {
+    const RoaringExpressionNode & node = this->nodes[index];
+    view = nullptr;
+    owned = nullptr;
+
+    if (node.op == RoaringExpressionOperation::LEAF) {
+      view = node.bitmap;
+      return true;
+    }
+
+    if (node.operandsCount == 0 || node.estimate == 0) {
+      view = owned = roaring_bitmap_create();
+      return owned != nullptr;
+    }
+
+    const uint32_t * children = this->operands.data() + node.firstOperand;
+    if (!this->evaluateNode(children[0], view, owned)) {
+      return false;
+    }
+
+    roaring_bitmap_t * result = owned;
+    bool lazy = false;
+    for (uint32_t i = 1; i < node.operandsCount; ++i) {
+      const bool resultEmpty = roaring_bitmap_is_empty(view);
+      if (resultEmpty && (node.op == RoaringExpressionOperation::AND || node.op == RoaringExpressionOperation::AND_NOT)) {
+        break;
+      }
+      const RoaringExpressionNode & child = this->nodes[children[i]];
+      if (child.estimate == 0 && node.op != RoaringExpressionOperation::AND) {
+        continue;  // An empty operand does not change a union, a difference or a symmetric difference.
+      }
+
+      const roaring_bitmap_t * operandView;
+      roaring_bitmap_t * operandOwned;
+      if (!this->evaluateNode(children[i], operandView, operandOwned)) {
+        roaring_bitmap_free(result);
+        return false;
+      }
+
+      if (result == nullptr) {
+        // The first operand is a leaf, the first operation allocates the result.
+        switch (node.op) {
+          case RoaringExpressionOperation::OR:
+            result = roaring_bitmap_lazy_or(view, operandView, false);
+            lazy = true;
+            break;
+          case RoaringExpressionOperation::AND: result = roaring_bitmap_and(view, operandView); break;
+          case RoaringExpressionOperation::AND_NOT: result = roaring_bitmap_andnot(view, operandView); break;
+          default: result = roaring_bitmap_xor(view, operandView); break;
+        }
+      } else {
+        switch (node.op) {
+          case RoaringExpressionOperation::OR:
+            roaring_bitmap_lazy_or_inplace(result, operandView, false);
+            lazy = true;
+            break;
+          case RoaringExpressionOperation::AND: roaring_bitmap_and_inplace(result, operandView); break;
+          case RoaringExpressionOperation::AND_NOT: roaring_bitmap_andnot_inplace(result, operandView); break;
+          default: roaring_bitmap_xor_inplace(result, operandView); break;
+        }
+      }
+      roaring_bitmap_free(operandOwned);
+      if (result == nullptr) {
+        return false;
+      }
+      view = result;
+    }
+
+    if (lazy) {
+      roaring_bitmap_repair_after_lazy(result);
+    }
+    owned = result;
+    return true;
+  }
+};
+
+class EvaluateWorker final : public RoaringBitmap32FactoryAsyncWorker {
+ public:
+  RoaringBitmap32Pins pins;
+  RoaringExpression expression;
+
+  explicit EvaluateWorker(v8::Isolate * isolate, AddonData * addonData) :
+    RoaringBitmap32FactoryAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(EvaluateWorker));
+  }
+
+  virtual ~EvaluateWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(EvaluateWorker)); }
+
+ protected:
+  void before() final { this->expression.beginFreeze(); }
+
+  void work() final {
+    roaring_bitmap_t * result = this->expression.evaluate();
+    if (result == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32::evaluateAsync - failed to allocate memory"));
+    }
+    this->bitmap = result;
+  }
+
+  void finally() final { this->expression.endFreeze(); }
+};
+
+void RoaringBitmap32_evaluateStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringExpression expression;
+  const char * error = expression.parse(isolate, info.Length() > 0 ? info[0] : v8::Undefined(isolate).As<v8::Value>());
+  if (error != nullptr) {
+    return v8utils::throwTypeError(isolate, error);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = expression.evaluate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::evaluate - failed to allocate memory");
+  }
+  self->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_evaluateStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new EvaluateWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  const char * error = worker->expression.parse(isolate, length > 0 ? info[0] : v8::Undefined(isolate).As<v8::Value>());
+  if (error != nullptr) {
+    worker->setError(WorkerError(error));
+  } else {
+    for (RoaringBitmap32 * leaf : worker->expression.leaves) {
+      worker->pins.pin(isolate, leaf);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_EVALUATE_
+
+#line 13 "src/cpp/RoaringBitmap32-main.h"
+
+void RoaringBitmap32_copyFrom(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() == 0 || !roaringAddMany(isolate, self, info[0], true)) {
+    return v8utils::throwError(
+      isolate, "RoaringBitmap32::copyFrom expects a RoaringBitmap32, an Uint32Array or an Iterable");
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32> const & info) {
+  RoaringBitmap32 * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  if (!info.IsConstructCall()) {
+    v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+    v8::MaybeLocal<v8::Object> v;
+    if (info.Length() < 1) {
+      v = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+    } else {
+      v8::Local<v8::Value> argv[1] = {info[0]};
+      v = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
+    }
+
+    v8::Local<v8::Object> vlocal;
+    if (v.ToLocal(&vlocal)) {
+      info.GetReturnValue().Set(vlocal);
+    }
+    return;
+  }
+
+  auto holder = info.This();
+
+  // If first parameter is a RoaringBitmap32 instance,
+  // and the second parameter is "readonly", creates a readonly bitmap.
+
+  RoaringBitmap32 * readonlyViewOf = nullptr;
+
+  if (info.Length() >= 2 && info[1]->IsString()) {
+    v8::String::Utf8Value arg1String(isolate, info[1]);
+    if (strcmp(*arg1String, "readonly") == 0) {
+      readonlyViewOf = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+      if (readonlyViewOf == nullptr) {
+        return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+      }
+      if (readonlyViewOf->mappedFile != nullptr) {
+        // A mapped bitmap is already readonly, and a view would keep using the mapping after releaseMappedFile.
+        return info.GetReturnValue().Set(info[0]);
+      }
+    }
+  }
+
+  auto * instanceMemory = bare_aligned_malloc(32, sizeof(RoaringBitmap32));
+  RoaringBitmap32 * instance;
+  bool hasCapacity = false;
+
+  if (readonlyViewOf) {
+    instance = new (instanceMemory) RoaringBitmap32(addonData, readonlyViewOf);
+  } else {
+    if (info.Length() > 0 && info[0]->IsNumber()) {
+      hasCapacity = true;
+      double capacity;
+      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&capacity)) {
+        capacity = 0;
+      }
+      if (capacity < 0) {
+        capacity = 0;
+      } else if (capacity > UINT32_MAX) {
+        capacity = UINT32_MAX;
+      }
+      instance = new (instanceMemory) RoaringBitmap32(addonData, (uint32_t)capacity);
+    } else {
+      instance = new (instanceMemory) RoaringBitmap32(addonData, 0U);
+    }
+  }
+
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::ctor - failed to create RoaringBitmap32 instance");
+  }
+
+  if (instance->roaring == nullptr) {
+    instance->~RoaringBitmap32();
+    bare_aligned_free(instance);
+    return v8utils::throwError(isolate, "RoaringBitmap32::ctor - failed to create native RoaringBitmap32 instance");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  if (readonlyViewOf) {
+    instance->frozenStorage.bufferPersistent.Reset(isolate, holder);
+  } else if (!hasCapacity) {
+    bool hasParameter = info.Length() != 0 && !info[0]->IsUndefined() && !info[0]->IsNull();
+    if (hasParameter) {
+      if (addonData->RoaringBitmap32_constructorTemplate.Get(isolate)->HasInstance(info[0])) {
+        RoaringBitmap32_copyFrom(info);
+      } else {
+        RoaringBitmap32_addMany(info);
+      }
+    }
+  }
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmap32_ofStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  auto context = isolate->GetCurrentContext();
+
+  int len = info.Length();
+  if (len < 0) {
+    len = 0;
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto newRoaringBitmap32ObjectMaybe = addonData->RoaringBitmap32_constructor.Get(isolate)->NewInstance(context, 0, nullptr);
+
+  v8::Local<v8::Object> newRoaringBitmap32Object;
+  if (!newRoaringBitmap32ObjectMaybe.ToLocal(&newRoaringBitmap32Object)) {
+    return;
+  }
+
+  info.GetReturnValue().Set(newRoaringBitmap32Object);
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(newRoaringBitmap32Object, isolate);
+  if (self == nullptr || !self->roaring) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto roaring = self->roaring;
+  uint32_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    auto arg = info[i];
+    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
+      continue;
+    }
+    roaring_bitmap_add(roaring, v);
+  }
+  self->invalidate();
+}
+
+void RoaringBitmap32_getInstanceCountStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  AddonData * addonData = AddonData::get(info);
+  info.GetReturnValue().Set(addonData ? (double)(addonData->RoaringBitmap32_instances) : 0.0);
+}
+
+void RoaringBitmap32_asReadonlyView(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Object> vlocal;
+  if (!self->readonlyViewPersistent.IsEmpty()) {
+    vlocal = self->readonlyViewPersistent.Get(isolate);
+    if (vlocal->IsObject()) {
+      info.GetReturnValue().Set(vlocal);
+      return;
+    }
+  }
+
+  if (self->isFrozenForever()) {
+    self->readonlyViewPersistent.Reset(isolate, info.This());
+    info.GetReturnValue().Set(info.This());
+    return;
+  }
+
+  AddonData * addonData = self->addonData;
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::MaybeLocal<v8::Object> v;
+  v8::Local<v8::Value> argv[2] = {info.This(), addonData->strings.readonly.Get(isolate)};
+  v = cons->NewInstance(isolate->GetCurrentContext(), 2, argv);
+
+  if (!v.ToLocal(&vlocal)) {
+    return v8utils::throwError(
+      isolate, "RoaringBitmap32::asReadonlyView - failed to create readonly RoaringBitmap32 instance");
+  }
+
+  self->readonlyViewPersistent.Reset(isolate, vlocal);
+
+  info.GetReturnValue().Set(vlocal);
+}
+
+void RoaringBitmap32_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
+  auto size = self != nullptr ? self->getSize() : 0U;
+  return size <= 0xFFFFFFFF ? info.GetReturnValue().Set((uint32_t)size) : info.GetReturnValue().Set((double)size);
+}
+
+void RoaringBitmap32_isEmpty_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
+  auto result = self == nullptr || self->isEmpty();
+  return info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_isFrozen_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self == nullptr || self->isFrozen());
+}
+
+void RoaringBitmap32_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  uint32_t v;
+  if (
+    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
+    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    info.GetReturnValue().Set(false);
+  } else {
+    info.GetReturnValue().Set(roaring_bitmap_contains(self->roaring, v));
+  }
+}
+
+/**
+ * Parses the (values, output) arguments of hasMany and hasManyAsync.
+ * If the output is not given, a new Uint8Array is created. Returns an error message if the arguments are invalid.
+ */
+const char * RoaringBitmap32_hasManyArguments(
+  const v8::FunctionCallbackInfo<v8::Value> & info,
+  v8utils::TypedArrayContent<uint32_t> & values,
+  v8utils::TypedArrayContent<uint8_t> & output,
+  bool & packed,
+  v8::Local<v8::Value> & result) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 1 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) || !values.set(isolate, info[0])) {
+    return "RoaringBitmap32::hasMany - values must be a Uint32Array or an Int32Array";
+  }
+
+  const size_t count = values.length;
+  packed = false;
+  if (info.Length() >= 2 && !info[1]->IsUndefined() && !info[1]->IsFunction()) {
+    packed = info[1]->IsUint32Array();
+    if (!(packed || info[1]->IsUint8Array()) || !output.set(isolate, info[1])) {
+      return "RoaringBitmap32::hasMany - output must be a Uint8Array or a Uint32Array";
+    }
+    if (output.length < (packed ? ((count + 31) / 32) * sizeof(uint32_t) : count)) {
+      return "RoaringBitmap32::hasMany - output array is too small";
+    }
+    result = info[1];
+    return nullptr;
+  }
+
+  v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, count);
+  v8::Local<v8::Uint8Array> typedArray;
+  if (arrayBuffer.IsEmpty() || (typedArray = v8::Uint8Array::New(arrayBuffer, 0, count)).IsEmpty()) {
+    return "RoaringBitmap32::hasMany - failed to allocate memory";
+  }
+  if (count != 0 && !output.set(isolate, typedArray)) {
+    return "RoaringBitmap32::hasMany - failed to allocate memory";
+  }
+  result = typedArray;
+  return nullptr;
+}
+
+void RoaringBitmap32_hasMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8utils::TypedArrayContent<uint32_t> values;
+  v8utils::TypedArrayContent<uint8_t> output;
+  bool packed;
+  v8::Local<v8::Value> result;
+  const char * error = RoaringBitmap32_hasManyArguments(info, values, output, packed, result);
+  if (error != nullptr) {
+    return v8utils::throwTypeError(isolate, error);
+  }
+
+  if (values.length != 0) {
+    if (packed) {
+      roaringHasManyBits(self->roaring, values.data, values.length, (uint32_t *)output.data);
+    } else {
+      roaringHasMany(self->roaring, values.data, values.length, output.data);
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_hasManyAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new HasManyParallelWorker(isolate, self);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::hasManyAsync - failed to allocate async worker");
+  }
+
+  v8::Local<v8::Value> result;
+  const char * error = RoaringBitmap32_hasManyArguments(info, worker->values, worker->output, worker->packed, result);
+  if (error != nullptr) {
+    worker->setError(WorkerError(error));
+  } else {
+    worker->setResult(result);
+  }
+
+  const int length = info.Length();
+  if (length >= 2 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_indexOf(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  uint32_t v;
+  if (
+    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
+    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    return info.GetReturnValue().Set(-1);
+  }
+  int64_t r = roaring_bitmap_get_index(self->roaring, v);
+  if (r >= 0) {
+    int64_t fromIndex;
+    if (info.Length() > 1 && info[1]->IntegerValue(isolate->GetCurrentContext()).To(&fromIndex)) {
+      if (fromIndex < 0) {
+        fromIndex += self->getSize();
+      }
+      if (r < fromIndex) {
+        return info.GetReturnValue().Set(-1);
+      }
+    }
+  }
+  return (uint64_t)r <= 0xFFFFFFFFull
+    ? r < 0x7fffffff ? info.GetReturnValue().Set((int)r) : info.GetReturnValue().Set((uint32_t)r)
+    : info.GetReturnValue().Set((double)r);
+}
+
+void RoaringBitmap32_lastIndexOf(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  uint32_t v;
+  if (
+    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
+    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    return info.GetReturnValue().Set(-1);
+  }
+  int64_t r = roaring_bitmap_get_index(self->roaring, v);
+  if (r >= 0) {
+    int64_t fromIndex;
+    if (info.Length() > 1 && info[1]->IntegerValue(isolate->GetCurrentContext()).To(&fromIndex)) {
+      if (fromIndex < 0) {
+        fromIndex += self->getSize();
+      }
+      if (r > fromIndex) {
+        return info.GetReturnValue().Set(-1);
+      }
+    }
+  }
+  return (uint64_t)r <= 0xFFFFFFFFull
+    ? r < 0x7fffffff ? info.GetReturnValue().Set((int)r) : info.GetReturnValue().Set((uint32_t)r)
+    : info.GetReturnValue().Set((double)r);
+}
+
+void RoaringBitmap32_minimum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  return info.GetReturnValue().Set(self != nullptr ? roaring_bitmap_minimum(self->roaring) : 0);
+}
+
+void RoaringBitmap32_maximum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  return info.GetReturnValue().Set(self != nullptr ? roaring_bitmap_maximum(self->roaring) : 0);
+}
+
+void RoaringBitmap32_rank(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return info.GetReturnValue().Set(0);
+  }
+  uint32_t v;
+  if (info.Length() < 1 || !info[0]->IsUint32() || !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    return info.GetReturnValue().Set(0);
+  }
+  info.GetReturnValue().Set((double)roaring_bitmap_rank(self->roaring, v));
+}
+
+void RoaringBitmap32_select(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return info.GetReturnValue().Set(0);
+  }
+  uint32_t v;
+  if (info.Length() >= 1 && info[0]->IsUint32() && info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
+    if (roaring_bitmap_select(self->roaring, v, &v)) {
+      info.GetReturnValue().Set(v);
+    }
+  }
+}
+
+/**
+ * Shared implementation of rankMany and selectMany.
+ * The output can be a Float64Array or a Uint32Array, if not given a new Float64Array is created.
+ * selectMany writes the optional third argument for missing ranks, NaN or 0 by default.
+ */
+template <bool SELECT>
+void RoaringBitmap32_positionalMany(const v8::FunctionCallbackInfo<v8::Value> & info, const char * name) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8utils::TypedArrayContent<uint32_t> values;
+  if (info.Length() < 1 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) || !values.set(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, name, " - argument must be a Uint32Array or an Int32Array");
+  }
+  const size_t count = values.length;
+
+  v8::Local<v8::Value> result;
+  bool isFloat64 = true;
+  if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+    isFloat64 = info[1]->IsFloat64Array();
+    if (!isFloat64 && !info[1]->IsUint32Array()) {
+      return v8utils::throwTypeError(isolate, name, " - output must be a Float64Array or a Uint32Array");
+    }
+    if (v8::Local<v8::TypedArray>::Cast(info[1])->Length() < count) {
+      return v8utils::throwTypeError(isolate, name, " - output array is too small");
+    }
+    result = info[1];
+  } else {
+    v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    if (arrayBuffer.IsEmpty()) {
+      return v8utils::throwError(isolate, (std::string(name) + " - failed to allocate memory").c_str());
+    }
+    result = v8::Float64Array::New(arrayBuffer, 0, count);
+  }
+
+  double missing = isFloat64 ? NAN : 0;
+  if (SELECT && info.Length() >= 3 && !info[2]->IsUndefined()) {
+    if (isFloat64 ? !info[2]->IsNumber() : !info[2]->IsUint32()) {
+      return v8utils::throwTypeError(
+        isolate, name, " - missing value must be a number, or an unsigned 32 bit integer for a Uint32Array output");
+    }
+    missing = info[2].As<v8::Number>()->Value();
+  }
+
+  if (count == 0) {
+    return info.GetReturnValue().Set(result);
+  }
+
+  bool ok;
+  if (isFloat64) {
+    v8utils::TypedArrayContent<double> output(isolate, result);
+    ok = SELECT ? roaringSelectMany<double>(self->roaring, values.data, count, output.data, missing)
+                : roaringRankMany<double>(self->roaring, values.data, count, output.data);
+  } else {
+    v8utils::TypedArrayContent<uint32_t> output(isolate, result);
+    ok = SELECT ? roaringSelectMany<uint32_t>(self->roaring, values.data, count, output.data, (uint32_t)missing)
+                : roaringRankMany<uint32_t>(self->roaring, values.data, count, output.data);
+  }
+  if (!ok) {
+    return v8utils::throwError(isolate, (std::string(name) + " - failed to allocate memory").c_str());
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_rankMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_positionalMany<false>(info, "RoaringBitmap32::rankMany");
+}
+
+void RoaringBitmap32_selectMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_positionalMany<true>(info, "RoaringBitmap32::selectMany");
+}
+
+void RoaringBitmap32_removeRunCompression(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  }
+  bool removed = roaring_bitmap_remove_run_compression(self->roaring);
+  if (removed) {
+    self->invalidateAddingToSize(0);
+  }
+  info.GetReturnValue().Set(removed);
+}
+
+void RoaringBitmap32_runOptimize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  bool result = roaring_bitmap_run_optimize(self->roaring);
+  // Containers may have been converted, iterators and bulk writers must not reuse them.
+  self->invalidateAddingToSize(0);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  size_t result = roaring_bitmap_shrink_to_fit(self->roaring);
+  // Containers may have been reallocated, iterators and bulk writers must not reuse them.
+  self->invalidateAddingToSize(0);
+  info.GetReturnValue().Set((double)result);
+}
+
+void RoaringBitmap32_freeze(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self && self->frozenCounter >= 0) {
+    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_SOFT_FROZEN;
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32_clone(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+
+  v8::Local<v8::Value> argv[1] = {info.This()};
+  auto v = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
+  v8::Local<v8::Object> vlocal;
+  if (v.ToLocal(&vlocal)) {
+    info.GetReturnValue().Set(vlocal);
+  }
+}
+
+void RoaringBitmap32_statistics(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  roaring_statistics_t stats;
+  roaring_bitmap_statistics(self->roaring, &stats);
+  auto context = isolate->GetCurrentContext();
+  auto result = v8::Object::New(isolate);
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "containers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "arrayContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_array_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "runContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_run_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "bitsetContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_bitset_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "valuesInArrayContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_array_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "valuesInRunContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_run_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "valuesInBitsetContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_bitset_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "bytesInArrayContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_array_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "bytesInRunContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_run_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "bytesInBitsetContainers", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_bitset_containers)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "maxValue", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.max_value)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "minValue", v8::NewStringType::kInternalized),
+    v8::Uint32::NewFromUnsigned(isolate, stats.min_value)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    v8::Number::New(isolate, (double)stats.cardinality)));
+  ignoreMaybeResult(result->Set(
+    context,
+    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
+    v8::Boolean::New(isolate, self->isFrozen())));
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_isSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self == other || (self && other && roaring_bitmap_is_subset(self->roaring, other->roaring)));
+}
+
+void RoaringBitmap32_isSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self == other || (self && other && roaring_bitmap_is_subset(other->roaring, self->roaring)));
+}
+
+void RoaringBitmap32_isStrictSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring_bitmap_is_strict_subset(self->roaring, other->roaring));
+}
+
+void RoaringBitmap32_isStrictSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring_bitmap_is_strict_subset(other->roaring, self->roaring));
+}
+
+void RoaringBitmap32_isEqual(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(
+    self == other || (self && other && roaring_bitmap_equals(self->roaring, other->roaring) ? true : false));
+}
+
+void RoaringBitmap32_intersects(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring_bitmap_intersect(self->roaring, other->roaring) ? true : false);
+}
+
+void RoaringBitmap32_jaccardIndex(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
+  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
+  info.GetReturnValue().Set(self && other ? roaring_bitmap_jaccard_index(self->roaring, other->roaring) : -1);
+}
+
+void RoaringBitmap32_swapStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap expects 2 arguments");
+
+  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (a == nullptr)
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap first argument must be a RoaringBitmap32");
+
+  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
+  if (b == nullptr)
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap second argument must be a RoaringBitmap32");
+
+  if (a->isFrozen() || b->isFrozen()) return v8utils::throwError(isolate, ERROR_FROZEN);
+
+  if (a != b) {
+    auto * a_roaring = a->roaring;
+    auto a_sizeCache = a->sizeCache;
+    a->roaring = b->roaring;
+    b->roaring = a_roaring;
+
+    a->invalidate(b->sizeCache);
+    b->invalidate(a_sizeCache);
+  }
+}
+
+void RoaringBitmap32_toString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  info.GetReturnValue().Set(self->addonData->strings.RoaringBitmap32.Get(isolate));
+}
+
+void RoaringBitmap32_at(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (info.Length() < 1) {
+    return;
+  }
+  const size_t cardinality = self->getSize();
+  auto context = isolate->GetCurrentContext();
+  uint32_t index;
+  if (!v8utils::v8ValueToUint32Fast(context, info[0], index)) {
+    if (info[0]->IsNullOrUndefined()) {
+      return;
+    }
+    double d;
+    if (!info[0]->NumberValue(context).To(&d) || std::isnan(d)) {
+      return;
+    }
+    d = std::trunc(d);
+    if (d < 0) {
+      d += static_cast<double>(cardinality);
+      if (d < 0) {
+        return;
+      }
+    }
+    if (d >= 4294967296.0) {
+      return;
+    }
+    index = static_cast<uint32_t>(d);
+  }
+
+  uint32_t result;
+  if (roaring_bitmap_select(self->roaring, index, &result)) {
+    info.GetReturnValue().Set(result);
+  }
+}
+
+void RoaringBitmap32_join(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  struct iter_data {
+    uint32_t count;
+    std::string sep;
+    std::string result;
+  } iterData;
+
+  iterData.count = 0;
+
+  if (info.Length() >= 1 && info[0]->IsString()) {
+    v8::String::Utf8Value sep(isolate, info[0]);
+    iterData.sep = *sep;
+  } else {
+    iterData.sep = ",";
+  }
+
+  if (self != nullptr && !self->isEmpty()) {
+    roaring_iterate(
+      self->roaring,
+      [](uint32_t value, void * vp) -> bool {
+        auto * p = reinterpret_cast<iter_data *>(vp);
+        if (p->result.length() >= 536870880) {
+          return false;
+        }
+
+        if (p->count++ > 0 && !p->sep.empty()) {
+          p->result.append(p->sep);
+        }
+        p->result.append(std::to_string(value));
+        return true;
+      },
+      (void *)&iterData);
+  }
+
+  auto returnValue = v8::String::NewFromUtf8(isolate, iterData.result.c_str(), v8::NewStringType::kNormal);
+  v8::Local<v8::String> returnValueLocal;
+  if (returnValue.ToLocal(&returnValueLocal)) {
+    info.GetReturnValue().Set(returnValueLocal);
+  } else {
+    info.GetReturnValue().Set(v8::String::Empty(isolate));
+  }
+}
+
+void RoaringBitmap32_contentToString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  struct iter_data {
+    std::string str;
+    char first_char = '[';
+    uint64_t maxLen = 32000;
+  } iterData;
+
+  double nv;
+  if (info.Length() >= 1 && info[0]->IsNumber() && info[0]->NumberValue(isolate->GetCurrentContext()).To(&nv) && nv >= 0) {
+    iterData.maxLen = (uint64_t)nv;
+  }
+
+  if (iterData.maxLen > 536870880) {
+    iterData.maxLen = 536870880;
+  }
+
+  if (self != nullptr && !self->isEmpty()) {
+    roaring_iterate(
+      self->roaring,
+      [](uint32_t value, void * vp) -> bool {
+        auto * p = reinterpret_cast<iter_data *>(vp);
+        if (p->str.length() >= p->maxLen) {
+          p->str.append("...");
+          return false;
+        }
+
+        p->str += p->first_char;
+        p->str.append(std::to_string(value));
+        p->first_char = ',';
+        return true;
+      },
+      (void *)&iterData);
+  } else {
+    iterData.str = '[';
+  }
+  iterData.str += ']';
+
+  auto returnValue = v8::String::NewFromUtf8(isolate, iterData.str.c_str(), v8::NewStringType::kNormal);
+  v8::Local<v8::String> returnValueLocal;
+  if (returnValue.ToLocal(&returnValueLocal)) {
+    info.GetReturnValue().Set(returnValueLocal);
+  } else {
+    info.GetReturnValue().Set(v8::String::Empty(isolate));
+  }
+}
+
+void RoaringBitmap32_fromArrayStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  v8::Local<v8::Value> arg;
+
+  if (info.Length() >= 1) {
+    arg = info[0];
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new FromArrayAsyncWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  if (!arg->IsNullOrUndefined() && !arg->IsFunction()) {
+    if (arg->IsUint32Array() || arg->IsInt32Array()) {
+      worker->buffer.set(isolate, arg);
+      const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
+    } else if (arg->IsObject()) {
+      if (addonData->RoaringBitmap32_constructorTemplate.Get(isolate)->HasInstance(arg)) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32::fromArrayAsync cannot be called with a RoaringBitmap32 instance");
+      }
+      v8::Local<v8::Value> argv[] = {arg};
+      auto carg = addonData->Uint32Array_from.Get(isolate)->Call(
+        isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
+      v8::Local<v8::Value> local;
+      if (carg.ToLocal(&local)) {
+        worker->buffer.set(isolate, local);
+      }
+    }
+
+    worker->argPersistent.Reset(isolate, arg);
+  }
+
+  if (info.Length() >= 2 && info[1]->IsFunction()) {
+    worker->setCallback(info[1]);
+  } else if (info.Length() >= 1 && info[0]->IsFunction()) {
+    worker->setCallback(info[0]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  croaringMemoryInitialize();
+
+  v8::Isolate * isolate = addonData->isolate;
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::String> className = addonData->strings.RoaringBitmap32.Get(isolate);
+
+  auto versionString = NEW_LITERAL_V8_STRING(isolate, ROARING_VERSION, v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32_New, addonData->external.Get(isolate));
+  if (ctor.IsEmpty()) {
+    return;
+  }
+  addonData->RoaringBitmap32_constructorTemplate.Reset(isolate, ctor);
+
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctor->SetClassName(className);
+
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
+    RoaringBitmap32_isEmpty_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmap32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
+    RoaringBitmap32_isFrozen_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
+    RoaringBitmap32_isEmpty_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmap32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
+    RoaringBitmap32_isFrozen_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmap32_add);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmap32_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addRange", RoaringBitmap32_addRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andCardinality", RoaringBitmap32_andCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlace", RoaringBitmap32_andInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlaceAsync", RoaringBitmap32_andInPlaceAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andManyInPlace", RoaringBitmap32_andManyInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotCardinality", RoaringBitmap32_andNotCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlace", RoaringBitmap32_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlaceAsync", RoaringBitmap32_andNotInPlaceAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "asReadonlyView", RoaringBitmap32_asReadonlyView);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "at", RoaringBitmap32_at);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap32_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clone", RoaringBitmap32_clone);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "contains", RoaringBitmap32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "containsRange", RoaringBitmap32_hasRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "contentToString", RoaringBitmap32_contentToString);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "copyFrom", RoaringBitmap32_copyFrom);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmap32_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "deserialize", RoaringBitmap32_deserialize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "flipRange", RoaringBitmap32_flipRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "freeze", RoaringBitmap32_freeze);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "getSerializationSizeInBytes", RoaringBitmap32_getSerializationSizeInBytes);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmap32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasMany", RoaringBitmap32_hasMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasManyAsync", RoaringBitmap32_hasManyAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasRange", RoaringBitmap32_hasRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "includes", RoaringBitmap32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "indexOf", RoaringBitmap32_indexOf);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "intersects", RoaringBitmap32_intersects);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "intersectsWithRange", RoaringBitmap32_intersectsWithRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isEqual", RoaringBitmap32_isEqual);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isStrictSubset", RoaringBitmap32_isStrictSubset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isStrictSuperset", RoaringBitmap32_isStrictSuperset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSubset", RoaringBitmap32_isSubset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSuperset", RoaringBitmap32_isSuperset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "jaccardIndex", RoaringBitmap32_jaccardIndex);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "join", RoaringBitmap32_join);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "lastIndexOf", RoaringBitmap32_lastIndexOf);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "maximum", RoaringBitmap32_maximum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "minimum", RoaringBitmap32_minimum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orCardinality", RoaringBitmap32_orCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlace", RoaringBitmap32_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlaceAsync", RoaringBitmap32_orInPlaceAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "pop", RoaringBitmap32_pop);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeCardinality", RoaringBitmap32_rangeCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeUint32Array", RoaringBitmap32_rangeUint32Array);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rank", RoaringBitmap32_rank);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rankMany", RoaringBitmap32_rankMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "releaseMappedFile", RoaringBitmap32_releaseMappedFile);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmap32_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeMany", RoaringBitmap32_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRange", RoaringBitmap32_removeRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRunCompression", RoaringBitmap32_removeRunCompression);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "runOptimize", RoaringBitmap32_runOptimize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "select", RoaringBitmap32_select);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "selectMany", RoaringBitmap32_selectMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "serialize", RoaringBitmap32_serialize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "serializeAsync", RoaringBitmap32_serializeAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "serializeFileAsync", RoaringBitmap32_serializeFileAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "shift", RoaringBitmap32_shift);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "shrinkToFit", RoaringBitmap32_shrinkToFit);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "statistics", RoaringBitmap32_statistics);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toArray", RoaringBitmap32_toArray);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toReversed", RoaringBitmap32_toReversed);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toSet", RoaringBitmap32_toSet);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toString", RoaringBitmap32_toString);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toUint32Array", RoaringBitmap32_toUint32Array);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toUint32ArrayAsync", RoaringBitmap32_toUint32ArrayAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "tryAdd", RoaringBitmap32_tryAdd);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorCardinality", RoaringBitmap32_xorCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlace", RoaringBitmap32_xorInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlaceAsync", RoaringBitmap32_xorInPlaceAsync);
+
+  auto ctorFunction = ctor->GetFunction(context).ToLocalChecked();
+  auto ctorObject = ctorFunction->ToObject(context).ToLocalChecked();
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+  ctor->PrototypeTemplate()->Set(isolate, "CRoaringVersion", versionString);
+
+  addonData->setMethod(ctorObject, "addOffset", RoaringBitmap32_addOffsetStatic);
+  addonData->setMethod(ctorObject, "and", RoaringBitmap32_andStatic);
+  addonData->setMethod(ctorObject, "andAsync", RoaringBitmap32_andStaticAsync);
+  addonData->setMethod(ctorObject, "andMany", RoaringBitmap32_andManyStatic);
+  addonData->setMethod(ctorObject, "andManyAsync", RoaringBitmap32_andManyStaticAsync);
+  addonData->setMethod(ctorObject, "andManyCardinality", RoaringBitmap32_andManyCardinalityStatic);
+  addonData->setMethod(ctorObject, "andManyCardinalityAsync", RoaringBitmap32_andManyCardinalityStaticAsync);
+  addonData->setMethod(ctorObject, "andNot", RoaringBitmap32_andNotStatic);
+  addonData->setMethod(ctorObject, "andNotAsync", RoaringBitmap32_andNotStaticAsync);
+
+  v8utils::defineHiddenField(isolate, ctorObject, "default", ctorFunction);
+
+  addonData->setMethod(ctorObject, "deserialize", RoaringBitmap32_deserializeStatic);
+  addonData->setMethod(ctorObject, "deserializeAsync", RoaringBitmap32_deserializeAsyncStatic);
+  addonData->setMethod(ctorObject, "deserializeFile", RoaringBitmap32_deserializeFileStatic);
+  addonData->setMethod(ctorObject, "deserializeFileAsync", RoaringBitmap32_deserializeFileAsyncStatic);
+  addonData->setMethod(ctorObject, "deserializeParallelAsync", RoaringBitmap32_deserializeParallelStaticAsync);
+  addonData->setMethod(ctorObject, "evaluate", RoaringBitmap32_evaluateStatic);
+  addonData->setMethod(ctorObject, "evaluateAsync", RoaringBitmap32_evaluateStaticAsync);
+
+  ignoreMaybeResult(
+    ctorObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized), ctorFunction));
+
+  addonData->setMethod(ctorObject, "fromArrayAsync", RoaringBitmap32_fromArrayStaticAsync);
+  addonData->setMethod(ctorObject, "fromRange", RoaringBitmap32_fromRangeStatic);
+  addonData->setMethod(ctorObject, "getInstancesCount", RoaringBitmap32_getInstanceCountStatic);
+  addonData->setMethod(ctorObject, "mapFile", RoaringBitmap32_mapFileStatic);
+  addonData->setMethod(ctorObject, "of", RoaringBitmap32_ofStatic);
+  addonData->setMethod(ctorObject, "or", RoaringBitmap32_orStatic);
+  addonData->setMethod(ctorObject, "orAsync", RoaringBitmap32_orStaticAsync);
+  addonData->setMethod(ctorObject, "orMany", RoaringBitmap32_orManyStatic);
+  addonData->setMethod(ctorObject, "orManyAsync", RoaringBitmap32_orManyStaticAsync);
+  addonData->setMethod(ctorObject, "orManyCardinality", RoaringBitmap32_orManyCardinalityStatic);
+  addonData->setMethod(ctorObject, "orManyCardinalityAsync", RoaringBitmap32_orManyCardinalityStaticAsync);
+  addonData->setMethod(ctorObject, "pairwise", RoaringBitmap32_pairwiseStatic);
+  addonData->setMethod(ctorObject, "pairwiseAsync", RoaringBitmap32_pairwiseStaticAsync);
+  addonData->setMethod(ctorObject, "serializePackFile", RoaringBitmap32_serializePackFileStatic);
+  addonData->setMethod(ctorObject, "serializePackFileAsync", RoaringBitmap32_serializePackFileAsyncStatic);
+  addonData->setMethod(ctorObject, "serializeParallelAsync", RoaringBitmap32_serializeParallelStaticAsync);
+  addonData->setMethod(ctorObject, "swap", RoaringBitmap32_swapStatic);
+  addonData->setMethod(ctorObject, "topK", RoaringBitmap32_topKStatic);
+  addonData->setMethod(ctorObject, "topKAsync", RoaringBitmap32_topKStaticAsync);
+  addonData->setMethod(ctorObject, "unsafeFrozenView", RoaringBitmap32_unsafeFrozenViewStatic);
+  addonData->setMethod(ctorObject, "xor", RoaringBitmap32_xorStatic);
+  addonData->setMethod(ctorObject, "xorAsync", RoaringBitmap32_xorStaticAsync);
+  addonData->setMethod(ctorObject, "xorMany", RoaringBitmap32_xorManyStatic);
+  addonData->setMethod(ctorObject, "xorManyAsync", RoaringBitmap32_xorManyStaticAsync);
+
+  v8utils::defineReadonlyField(isolate, ctorObject, "CRoaringVersion", versionString);
+  v8utils::defineReadonlyField(isolate, exports, "CRoaringVersion", versionString);
+
+  v8utils::defineHiddenField(isolate, ctorObject, className, ctorFunction);
+
+  ignoreMaybeResult(exports->Set(context, className, ctorFunction));
+
+  addonData->RoaringBitmap32_constructor.Reset(isolate, ctorFunction);
+}
+
+#line 1 "src/cpp/RoaringBitmap32BufferedIterator.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
+#define ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
+
+#line 5 "src/cpp/RoaringBitmap32BufferedIterator.h"
+
+class RoaringBitmap32BufferedIterator final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152490000;
+
+  enum { allocatedMemoryDelta = 1024 };
+
+  roaring_uint32_iterator_t it;
+  bool reversed;
+  /** Exclusive bound in the iteration direction, -1 or 2^32 if the iterator is not bounded. */
+  int64_t endBound;
+  RoaringBitmap32 * bitmapInstance;
+  int64_t bitmapVersion;
+  v8utils::TypedArrayContent<uint32_t> bufferContent;
+
+  v8::Global<v8::Object> bitmap;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmap32BufferedIterator(AddonData * addonData, bool reversed) :
+    ObjectWrap(addonData), reversed(reversed), endBound(reversed ? -1 : 0x100000000LL), bitmapInstance(nullptr) {
+    this->it.parent = nullptr;
+    this->it.has_value = false;
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32BufferedIterator));
+  }
+
+  ~RoaringBitmap32BufferedIterator() {
+    this->destroy();
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32BufferedIterator));
+  }
+
+  inline bool _outOfBounds(uint32_t value) const {
+    return this->reversed ? (int64_t)value <= this->endBound : (int64_t)value >= this->endBound;
+  }
+
+  /**
+   * Positions the iterator on the first value at or after the given one in the iteration direction,
+   * the largest value less or equal than it when reversed.
+   */
+  inline void _seek(double from) {
+    const roaring_bitmap_t * r = this->bitmapInstance->roaring;
+    if (this->reversed) {
+      if (from >= 4294967295.0) {
+        roaring_iterator_init_last(r, &this->it);
+      } else {
+        roaring_iterator_init(r, &this->it);
+        if (from < 0) {
+          this->it.has_value = false;
+        } else {
+          // Moves past the value and steps back, CRoaring has no backward seek.
+          roaring_uint32_iterator_move_equalorlarger(&this->it, (uint32_t)std::floor(from) + 1);
+          roaring_uint32_iterator_previous(&this->it);
+        }
+      }
+    } else {
+      roaring_iterator_init(r, &this->it);
+      if (from > 4294967295.0) {
+        this->it.has_value = false;
+      } else if (from > 0) {
+        roaring_uint32_iterator_move_equalorlarger(&this->it, (uint32_t)std::ceil(from));
+      }
+    }
+  }
+
+  inline uint32_t _fill() {
+    uint32_t * data = this->bufferContent.data;
+    if (this->it.has_value && this->_outOfBounds(this->it.current_value)) {
+      this->it.has_value = false;
+    }
+    uint32_t n = this->reversed ? roaringIteratorReadReverse(&this->it, data, this->bufferContent.length)
+                                : roaring_uint32_iterator_read(&this->it, data, this->bufferContent.length);
+    if (n != 0 && this->_outOfBounds(data[n - 1])) {
+      // Values are sorted in the iteration direction, keep only the ones before the bound.
+      n = (uint32_t)(std::partition_point(data, data + n, [this](uint32_t v) { return !this->_outOfBounds(v); }) - data);
+      this->it.has_value = false;
+    }
+    if (n == 0) {
+      this->bitmapInstance = nullptr;
+      this->bufferContent.reset();
+      this->bitmap.Reset();
+    }
+    return n;
+  }
+
+  inline void close() {
+    this->bitmapInstance = nullptr;
+    this->bitmapVersion = 0;
+    this->bufferContent.reset();
+    this->bitmap.Reset();
+    this->it.has_value = false;
+  }
+
+ private:
+  void destroy() {
+    this->bitmap.Reset();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+  }
+};
+
+void RoaringBitmap32BufferedIterator_fill(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), isolate);
+
+  RoaringBitmap32 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
+
+  if (bitmapInstance == nullptr) {
+    return info.GetReturnValue().Set(0U);
+  }
+
+  if (bitmapInstance->getVersion() != instance->bitmapVersion) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 iterator - bitmap changed while iterating");
+  }
+
+  return info.GetReturnValue().Set(instance->_fill());
+}
+
+void RoaringBitmap32BufferedIterator_seek(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), isolate);
+
+  RoaringBitmap32 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
+
+  if (bitmapInstance == nullptr) {
+    return info.GetReturnValue().Set(0U);
+  }
+
+  if (bitmapInstance->getVersion() != instance->bitmapVersion) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 iterator - bitmap changed while iterating");
+  }
+
+  double from;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&from) || std::isnan(from)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32 iterator - seek value must be a number");
+  }
+
+  instance->_seek(from);
+  return info.GetReturnValue().Set(instance->_fill());
+}
+
+void RoaringBitmap32BufferedIterator_close(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32BufferedIterator * instance =
+    ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), info.GetIsolate());
+  if (instance == nullptr) {
+    return;
+  }
+  instance->close();
+}
+
+void RoaringBitmap32BufferedIterator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32BufferedIterator> const & info) {
+  RoaringBitmap32BufferedIterator * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32BufferedIterator();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap32BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs to be called with new");
+  }
+
+  auto holder = info.This();
+
+  if (info.Length() < 2) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs 2 to 5 arguments");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringBitmap32 * bitmapInstance = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  if (bitmapInstance == nullptr) {
+    return v8utils::throwTypeError(
+      isolate, "RoaringBitmap32BufferedIterator::ctor - first argument must be of type RoaringBitmap32");
+  }
+
+  bool reversed = info.Length() > 2 && info[2]->BooleanValue(isolate);
+
+  // Optional start value and exclusive end bound, both in the iteration direction.
+  double from = reversed ? 4294967295.0 : 0;
+  double to = reversed ? -1 : 4294967296.0;
+  if (info.Length() > 3 && !info[3]->IsUndefined()) {
+    if (!info[3]->IsNumber() || !info[3]->NumberValue(isolate->GetCurrentContext()).To(&from) || std::isnan(from)) {
+      return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - from must be a number");
+    }
+  }
+  if (info.Length() > 4 && !info[4]->IsUndefined()) {
+    if (!info[4]->IsNumber() || !info[4]->NumberValue(isolate->GetCurrentContext()).To(&to) || std::isnan(to)) {
+      return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - to must be a number");
+    }
+  }
+
+  auto bufferObject = info[1];
+
+  if (!bufferObject->IsUint32Array()) {
+    return v8utils::throwTypeError(
+      isolate, "RoaringBitmap32BufferedIterator::ctor - second argument must be of type Uint32Array");
+  }
+
+  const v8utils::TypedArrayContent<uint32_t> bufferContent(isolate, bufferObject);
+  if (!bufferContent.data || bufferContent.length < 1) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - invalid Uint32Array buffer");
+  }
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32BufferedIterator));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32BufferedIterator(addonData, reversed) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32BufferedIterator::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  info.GetReturnValue().Set(holder);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32BufferedIterator_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  auto context = isolate->GetCurrentContext();
+
+  instance->bitmapInstance = bitmapInstance;
+  instance->bitmapVersion = bitmapInstance->getVersion();
+
+  auto a0Maybe = info[0]->ToObject(context);
+  v8::Local<v8::Object> a0;
+  if (!a0Maybe.ToLocal(&a0)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
+  }
+  instance->bitmap.Reset(isolate, a0);
+
+  auto a1Maybe = bufferObject->ToObject(context);
+  v8::Local<v8::Object> a1;
+  if (!a1Maybe.ToLocal(&a1)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
+  }
+
+  instance->bufferContent.set(isolate, bufferObject);
+
+  // A value on the other side of a bound is never returned, so the bound is clamped to [-1, 2^32].
+  instance->endBound = (int64_t)(reversed ? std::floor(std::max(-1.0, std::min(to, 4294967296.0)))
+                                          : std::ceil(std::max(-1.0, std::min(to, 4294967296.0))));
+  instance->_seek(from);
+
+  uint32_t n = instance->_fill();
+
+  if (holder->Set(context, addonData->strings.n.Get(isolate), v8::Uint32::NewFromUnsigned(isolate, n)).IsNothing()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - instantiation failed");
+  }
+}
+
+void RoaringBitmap32BufferedIterator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32BufferedIterator", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32BufferedIterator_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
+
+  addonData->RoaringBitmap32BufferedIterator_constructorTemplate.Reset(isolate, ctor);
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "fill", RoaringBitmap32BufferedIterator_fill);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "close", RoaringBitmap32BufferedIterator_close);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "seek", RoaringBitmap32BufferedIterator_seek);
+
+  auto ctorFunctionMaybe = ctor->GetFunction(isolate->GetCurrentContext());
+  v8::Local<v8::Function> ctorFunction;
+
+  if (!ctorFunctionMaybe.ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32BufferedIterator");
   }
 
-  static void _resolveOrReject(AsyncWorker * worker, v8::Local<v8::Value> & error) {
-    if (worker->_completed.load(std::memory_order_acquire)) {
-      return;
-    }
-
-    worker->_completed.store(true, std::memory_order_release);
+  addonData->RoaringBitmap32BufferedIterator_constructor.Reset(isolate, ctorFunction);
+  v8utils::defineHiddenField(isolate, exports, "RoaringBitmap32BufferedIterator", ctorFunction);
+}
 
-    worker->_unregisterFromAddon();
+#endif  // ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
 
-    if (worker->isShuttingDown()) {
-      worker->finally();
-      delete worker;
-      return;
-    }
+#line 1 "src/cpp/RoaringBitmap32BulkWriter.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
+#define ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
 
-    v8::Isolate * isolate = worker->isolate;
-    v8::HandleScope scope(isolate);
+#line 5 "src/cpp/RoaringBitmap32BulkWriter.h"
 
-    v8::TryCatch tryCatch(isolate);
+/**
+ * Adds values to a bitmap in batches: JS fills a reusable Uint32Array and flush adds the first n values of it,
+ * with a single native call and a bulk context that is kept across flushes while the bitmap is not changed elsewhere.
+ */
+class RoaringBitmap32BulkWriter final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152425700;
 
-    v8::Local<v8::Value> result;
+  static const constexpr uint32_t DEFAULT_CAPACITY = 4096;
 
-    if (!worker->_error.hasError() && error.IsEmpty()) {
-      worker->done(result);
-    }
+  RoaringBitmap32 * bitmapInstance;
+  /**
+   * The version of the bitmap after the last flush, the bulk context is valid only while it does not change.
+   * Every operation that can move, convert or reallocate containers changes the version, runOptimize and shrinkToFit too.
+   */
+  int64_t bitmapVersion;
+  roaring_bulk_context_t bulkContext;
+  v8utils::TypedArrayContent<uint32_t> bufferContent;
 
-    if (tryCatch.HasCaught()) {
-      error = worker->_makeError(tryCatch.Exception());
-      tryCatch.Reset();
-    }
+  v8::Global<v8::Object> bitmap;
+  v8::Global<v8::Object> persistent;
 
-    worker->finally();
+  explicit RoaringBitmap32BulkWriter(AddonData * addonData, RoaringBitmap32 * bitmapInstance) :
+    ObjectWrap(addonData), bitmapInstance(bitmapInstance), bitmapVersion(-1), bulkContext() {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32BulkWriter));
+  }
 
-    if (tryCatch.HasCaught()) {
-      error = worker->_makeError(tryCatch.Exception());
-      tryCatch.Reset();
+  ~RoaringBitmap32BulkWriter() {
+    this->bitmap.Reset();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
     }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32BulkWriter));
+  }
 
-    if (result.IsEmpty() && error.IsEmpty()) {
-      worker->setError(WorkerError("Async operation failed"));
+  void flush(size_t count) {
+    RoaringBitmap32 * target = this->bitmapInstance;
+    if (target->getVersion() != this->bitmapVersion) {
+      // The cached container may have been moved or converted by other operations on the bitmap.
+      this->bulkContext = roaring_bulk_context_t();
     }
-
-    if (worker->hasError() && error.IsEmpty()) {
-      error = worker->_error.newV8Error(isolate);
+    roaring_bitmap_t * r = target->roaring;
+    const uint32_t * values = this->bufferContent.data;
+    for (size_t i = 0; i != count; ++i) {
+      roaring_bitmap_add_bulk(r, &this->bulkContext, values[i]);
     }
+    target->invalidate();
+    this->bitmapVersion = target->getVersion();
+  }
+};
 
-    auto context = isolate->GetCurrentContext();
+/** Allocates a zeroed Uint32Array of the given length, on a 32 bytes aligned memory block. */
+static bool RoaringBitmap32BulkWriter_allocBuffer(v8::Isolate * isolate, uint32_t length, v8::Local<v8::Value> & result) {
+  const size_t size = (size_t)length * sizeof(uint32_t);
+  void * ptr = bare_aligned_malloc(32, size);
+  if (ptr == nullptr) {
+    return false;
+  }
+  memset(ptr, 0, size);
+  auto backingStore = v8::ArrayBuffer::NewBackingStore(ptr, size, bare_aligned_free_callback2, nullptr);
+  if (!backingStore) {
+    bare_aligned_free(ptr);
+    return false;
+  }
+  v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, std::move(backingStore));
+  if (arrayBuffer.IsEmpty()) {
+    return false;
+  }
+  v8::Local<v8::Uint32Array> array = v8::Uint32Array::New(arrayBuffer, 0, length);
+  if (array.IsEmpty()) {
+    return false;
+  }
+  result = array;
+  return true;
+}
 
-    if (worker->_resolver.IsEmpty()) {
-      v8::Local<v8::Function> callback = worker->_callback.Get(isolate);
-      std::atomic_thread_fence(std::memory_order_seq_cst);
-      if (!error.IsEmpty()) {
-        v8::Local<v8::Value> argv[] = {error, v8::Undefined(isolate)};
-        ignoreMaybeResult(callback->Call(context, context->Global(), 2, argv));
-      } else {
-        v8::Local<v8::Value> argv[] = {v8::Null(isolate), result};
-        ignoreMaybeResult(callback->Call(context, context->Global(), 2, argv));
-      }
-      delete worker;
-    } else {
-      v8::Local<v8::Promise::Resolver> resolver = worker->_resolver.Get(isolate);
-      std::atomic_thread_fence(std::memory_order_seq_cst);
-      delete worker;
-      if (!error.IsEmpty()) {
-        ignoreMaybeResult(resolver->Reject(context, error));
-      } else if (!result.IsEmpty()) {
-        ignoreMaybeResult(resolver->Resolve(context, result));
-      } else {
-        ignoreMaybeResult(resolver->Reject(context, v8::Undefined(isolate)));
-      }
-    }
+void RoaringBitmap32BulkWriter_flush(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32BulkWriter * self = ObjectWrap::TryUnwrap<RoaringBitmap32BulkWriter>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->bitmapInstance->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
 
-  static void _complete(AsyncWorker * worker) {
-    std::atomic_thread_fence(std::memory_order_seq_cst);
-    v8::Isolate * isolate = worker->isolate;
-    const bool shouldRunMicrotasks = !worker->isShuttingDown();
-    worker->_applyPendingExternalMemoryDelta();
-    v8::Local<v8::Value> error;
-    _resolveOrReject(worker, error);
-    if (shouldRunMicrotasks) {
-      isolate->PerformMicrotaskCheckpoint();
+  size_t count = self->bufferContent.length;
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    uint32_t n;
+    if (!v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[0], n) || n > self->bufferContent.length) {
+      return v8utils::throwTypeError(
+        isolate, "RoaringBitmap32BulkWriter::flush - count must be an integer between 0 and the buffer length");
     }
+    count = n;
   }
 
-  static void _work(uv_work_t * request) {
-    std::atomic_thread_fence(std::memory_order_seq_cst);
-    auto * worker = static_cast<AsyncWorker *>(request->data);
-    if (worker && !worker->hasError()) {
-      struct AsyncWorkerMemoryCounterScope {
-        std::atomic<int64_t> * previous;
-        explicit AsyncWorkerMemoryCounterScope(std::atomic<int64_t> * current) :
-          previous(gcawarePushAsyncWorkerMemoryCounter(current)) {}
-        ~AsyncWorkerMemoryCounterScope() { gcawarePopAsyncWorkerMemoryCounter(previous); }
-      } memoryScope(&worker->_pendingExternalMemoryDelta);
+  self->flush(count);
+  info.GetReturnValue().Set(info.This());
+}
 
-      worker->work();
+void RoaringBitmap32BulkWriter_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32BulkWriter> const & info) {
+  RoaringBitmap32BulkWriter * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32BulkWriter();
+    bare_aligned_free(p);
+  }
+}
 
-      std::atomic_thread_fence(std::memory_order_seq_cst);
-    }
+void RoaringBitmap32BulkWriter_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BulkWriter::ctor - needs to be called with new");
   }
 
-  static void _done(uv_work_t * request, int status) {
-    std::atomic_thread_fence(std::memory_order_seq_cst);
-    auto * worker = static_cast<AsyncWorker *>(request->data);
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
 
-    if (status != 0) {
-      worker->setError(WorkerError("Error executing async thread"));
-    }
-    _complete(worker);
+  RoaringBitmap32 * bitmapInstance = info.Length() > 0 ? ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate) : nullptr;
+  if (bitmapInstance == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BulkWriter::ctor - first argument must be a RoaringBitmap32");
   }
 
-  v8::Local<v8::Value> _makeError(v8::Local<v8::Value> error) {
-    if (error.IsEmpty() || error->IsNull() || error->IsUndefined()) {
-      this->setError(WorkerError("Exception in async operation"));
-      return {};
-    }
-    if (!error->IsObject()) {
-      v8::MaybeLocal<v8::String> message = error->ToString(isolate->GetCurrentContext());
-      if (message.IsEmpty()) {
-        if (this->maybeAddonData != nullptr) {
-          message = this->maybeAddonData->strings.OperationFailed.Get(isolate);
-        } else {
-          message = v8::String::NewFromUtf8(isolate, "Operation failed", v8::NewStringType::kInternalized);
-        }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  // The buffer is a Uint32Array provided by the caller, or a new aligned one of the given length.
+  v8::Local<v8::Value> bufferObject;
+  if (info.Length() > 1 && info[1]->IsUint32Array()) {
+    bufferObject = info[1];
+  } else {
+    uint32_t capacity = RoaringBitmap32BulkWriter::DEFAULT_CAPACITY;
+    if (info.Length() > 1 && !info[1]->IsUndefined()) {
+      if (!v8utils::v8ValueToUint32Fast(context, info[1], capacity) || capacity == 0 || capacity > 0x10000000) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32BulkWriter::ctor - buffer must be a Uint32Array or a positive length");
       }
-      error = v8::Exception::Error(error.IsEmpty() ? v8::String::Empty(isolate) : message.ToLocalChecked());
     }
-    return error;
+    if (!RoaringBitmap32BulkWriter_allocBuffer(isolate, capacity, bufferObject)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - buffer allocation failed");
+    }
   }
 
-  friend class ParallelAsyncWorker;
+  auto holder = info.This();
 
-  void _applyPendingExternalMemoryDelta() {
-    int64_t delta = _pendingExternalMemoryDelta.exchange(0, std::memory_order_acq_rel);
-    if (delta != 0) {
-      this->isolate->AdjustAmountOfExternalAllocatedMemory(delta);
-    }
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32BulkWriter));
+  auto * instance =
+    instanceMemory ? new (instanceMemory) RoaringBitmap32BulkWriter(addonData, bitmapInstance) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - allocation failed");
   }
-};
 
-class ParallelAsyncWorker : public AsyncWorker {
- public:
-  uint32_t loopCount;
-  uint32_t concurrency;
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32BulkWriter::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
 
-  explicit ParallelAsyncWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
-    AsyncWorker(isolate, maybeAddonData),
-    loopCount(0),
-    concurrency(0),
-    _tasks(nullptr),
-    _pendingTasks(0),
-    _currentIndex(0) {}
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32BulkWriter_WeakCallback, v8::WeakCallbackType::kParameter);
 
-  virtual ~ParallelAsyncWorker() { gcaware_free(this->isolate, _tasks); }
+  // The bitmap is kept alive by the writer.
+  instance->bitmap.Reset(isolate, info[0].As<v8::Object>());
+  instance->bufferContent.set(isolate, bufferObject);
 
- protected:
-  void work() override {
-    const uint32_t c = loopCount;
-    for (uint32_t i = 0; i != c && !hasError() && !_completed.load(std::memory_order_acquire); ++i) {
-      parallelWork(i);
-    }
+  const auto attributes = (v8::PropertyAttribute)(v8::ReadOnly | v8::DontDelete);
+  if (
+    holder
+      ->DefineOwnProperty(
+        context, NEW_LITERAL_V8_STRING(isolate, "bitmap", v8::NewStringType::kInternalized), info[0], attributes)
+      .IsNothing() ||
+    holder
+      ->DefineOwnProperty(
+        context, NEW_LITERAL_V8_STRING(isolate, "buffer", v8::NewStringType::kInternalized), bufferObject, attributes)
+      .IsNothing()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - instantiation failed");
   }
 
-  virtual void parallelWork(uint32_t index) = 0;
-
- private:
-  uv_work_t * _tasks;
-  std::atomic<int32_t> _pendingTasks;
-  std::atomic<uint32_t> _currentIndex;
-
-  bool _start() override {
-    if (concurrency == 0) {
-      concurrency = getCpusCount();
-    }
+  info.GetReturnValue().Set(holder);
+}
 
-    uint32_t tasksCount = concurrency < loopCount ? concurrency : loopCount;
+void RoaringBitmap32BulkWriter_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
 
-    if (tasksCount <= 1) {
-      return AsyncWorker::_start();
-    }
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32BulkWriter", v8::NewStringType::kInternalized);
 
-    uv_work_t * tasks = (uv_work_t *)gcaware_malloc(tasksCount * sizeof(uv_work_t));
-    if (tasks == nullptr) {
-      this->setError(WorkerError("Failed to allocate memory"));
-      return false;
-    }
-    memset(tasks, 0, tasksCount * sizeof(uv_work_t));
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32BulkWriter_New, addonData->external.Get(isolate));
 
-    _tasks = tasks;
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
 
-    for (uint32_t taskIndex = 0; taskIndex != tasksCount; ++taskIndex) {
-      tasks[taskIndex].data = this;
-    }
+  NODE_SET_PROTOTYPE_METHOD(ctor, "flush", RoaringBitmap32BulkWriter_flush);
 
-    for (uint32_t taskIndex = 0; taskIndex != tasksCount; ++taskIndex) {
-      if (
-        uv_queue_work(
-          node::GetCurrentEventLoop(this->isolate),
-          &tasks[taskIndex],
-          ParallelAsyncWorker::_parallelWork,
-          ParallelAsyncWorker::_parallelDone) != 0) {
-        setError(WorkerError("Error starting async parallel task"));
-        break;
-      }
-      _pendingTasks.fetch_add(1, std::memory_order_relaxed);
-    }
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
 
-    return _pendingTasks.load(std::memory_order_acquire) > 0;
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32BulkWriter");
   }
 
-  static void _parallelWork(uv_work_t * request) {
-    auto * worker = static_cast<ParallelAsyncWorker *>(request->data);
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
 
-    if (worker) {
-      struct ParallelWorkerMemoryCounterScope {
-        std::atomic<int64_t> * previous;
-        explicit ParallelWorkerMemoryCounterScope(std::atomic<int64_t> * current) :
-          previous(gcawarePushAsyncWorkerMemoryCounter(current)) {}
-        ~ParallelWorkerMemoryCounterScope() { gcawarePopAsyncWorkerMemoryCounter(previous); }
-      } memoryScope(&worker->_pendingExternalMemoryDelta);
+#endif  // ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
 
-      uint32_t loopCount = worker->loopCount;
-      while (!worker->hasError() && !worker->_completed.load(std::memory_order_acquire)) {
-        const uint32_t prevIndex = worker->_currentIndex.load(std::memory_order_relaxed);
-        const uint32_t index = worker->_currentIndex.fetch_add(1, std::memory_order_relaxed);
-        if (index >= loopCount || index < prevIndex) {
-          break;
-        }
-        worker->parallelWork(index);
-      }
-    }
-  }
+#line 1 "src/cpp/RoaringBitmap32Accumulator.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
+#define ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
 
-  static void _parallelDone(uv_work_t * request, int status) {
-    auto * worker = static_cast<ParallelAsyncWorker *>(request->data);
+#line 5 "src/cpp/RoaringBitmap32Accumulator.h"
 
-    if (worker->_completed.load(std::memory_order_acquire)) {
-      if (!worker->isShuttingDown()) {
-        worker->isolate->PerformMicrotaskCheckpoint();
-      }
-      return;
-    }
+/**
+ * Streaming union of many bitmaps.
+ *
+ * Inputs are merged with lazy unions, that skip the computation of exact cardinalities and container conversions;
+ * the result is repaired only once, when finish is called.
+ */
+class RoaringBitmap32Accumulator final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152414300;
 
-    int32_t remaining = worker->_pendingTasks.fetch_sub(1, std::memory_order_acq_rel) - 1;
-    if (remaining <= 0) {
-      _complete(worker);
-      return;
-    }
+  /** The accumulated union, in lazy state if count is not zero. nullptr until the first input. */
+  roaring_bitmap_t * roaring;
+  /** The number of bitmaps merged since the last finish or clear. */
+  uint32_t count;
+  v8::Global<v8::Object> persistent;
 
-    if (!worker->isShuttingDown()) {
-      worker->isolate->PerformMicrotaskCheckpoint();
-    }
+  explicit RoaringBitmap32Accumulator(AddonData * addonData) : ObjectWrap(addonData), roaring(nullptr), count(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32Accumulator));
   }
-};
-
-/////////////// ParallelAsyncWorker ///////////////
-
-class RoaringBitmap32FactoryAsyncWorker : public AsyncWorker {
- public:
-  std::atomic<roaring_bitmap_t_ptr> bitmap;
-
-  explicit RoaringBitmap32FactoryAsyncWorker(v8::Isolate * isolate, AddonData * addonData) :
-    AsyncWorker(isolate, addonData), bitmap(nullptr) {}
 
-  virtual ~RoaringBitmap32FactoryAsyncWorker() {
-    roaring_bitmap_t_ptr ptr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
-    if (ptr != nullptr) {
-      roaring_bitmap_free(ptr);
+  ~RoaringBitmap32Accumulator() {
+    this->clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
     }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32Accumulator));
   }
 
- protected:
-  void done(v8::Local<v8::Value> & result) override {
-    roaring_bitmap_t_ptr bitmapPtr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
-    if (bitmapPtr == nullptr) {
-      return this->setError(WorkerError("Error deserializing roaring bitmap"));
+  void clear() {
+    if (this->roaring != nullptr) {
+      roaring_bitmap_free(this->roaring);
+      this->roaring = nullptr;
     }
+    this->count = 0;
+  }
 
-    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(this->isolate);
-
-    v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-
-    if (!resultMaybe.ToLocal(&result)) {
-      return this->setError(WorkerError("Error instantiating roaring bitmap"));
+  /** Merges a bitmap in the accumulated union. Returns false if allocation failed. */
+  bool merge(const roaring_bitmap_t * bitmap) {
+    if (this->roaring == nullptr) {
+      this->roaring = roaring_bitmap_create();
+      if (this->roaring == nullptr) {
+        return false;
+      }
     }
+    // Bitset conversion, as in roaring_bitmap_or_many: merging many inputs ends up in bitset containers anyway.
+    roaring_bitmap_lazy_or_inplace(this->roaring, bitmap, true);
+    ++this->count;
+    return true;
+  }
 
-    RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-    if (unwrapped == nullptr) {
-      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+  /** Repairs and returns the accumulated union, the accumulator is reset. Returns nullptr if allocation failed. */
+  roaring_bitmap_t * finish() {
+    roaring_bitmap_t * result = this->roaring;
+    if (result == nullptr) {
+      return roaring_bitmap_create();
     }
-
-    unwrapped->replaceBitmapInstance(this->isolate, bitmapPtr);
+    roaring_bitmap_repair_after_lazy(result);
+    this->roaring = nullptr;
+    this->count = 0;
+    return result;
   }
 };
 
-class ToUint32ArrayAsyncWorker final : public AsyncWorker {
- public:
-  const v8::FunctionCallbackInfo<v8::Value> & info;
-  v8::Global<v8::Value> bitmapPersistent;
-  RoaringBitmap32 * bitmap = nullptr;
-  v8utils::TypedArrayContent<uint32_t> inputContent;
-  std::atomic<uint32_t *> allocatedBuffer{nullptr};
-  std::atomic<size_t> outputSize{0};
-  size_t maxSize = std::numeric_limits<size_t>::max();
-  bool hasInput = false;
-
-  explicit ToUint32ArrayAsyncWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ToUint32ArrayAsyncWorker));
+static RoaringBitmap32Accumulator * RoaringBitmap32Accumulator_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = ObjectWrap::TryUnwrap<RoaringBitmap32Accumulator>(info.This(), isolate);
+  if (self == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
+  return self;
+}
 
-  ~ToUint32ArrayAsyncWorker() {
-    uint32_t * buffer = this->allocatedBuffer.exchange(nullptr, std::memory_order_acq_rel);
-    if (buffer) {
-      bare_aligned_free(buffer);
-    }
-    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ToUint32ArrayAsyncWorker));
+void RoaringBitmap32Accumulator_or(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
   }
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, 0);
+  if (bitmap == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Accumulator::or - argument must be a RoaringBitmap32");
+  }
+  if (!self->merge(bitmap->roaring)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::or - failed to allocate memory");
+  }
+  info.GetReturnValue().Set(info.This());
+}
 
- protected:
-  // Called before the thread starts, in the main thread.
-  void before() final {
-    v8::Isolate * isolate = info.GetIsolate();
-
-    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-    if (self == nullptr) {
-      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
-    }
-    if (this->maybeAddonData == nullptr) {
-      this->maybeAddonData = self->addonData;
+/** orMany(bitmaps) or orMany(...bitmaps). All the arguments are validated before merging. */
+void RoaringBitmap32Accumulator_orMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  if (info.Length() == 1 && info[0]->IsArray()) {
+    v8::Local<v8::Array> array = info[0].As<v8::Array>();
+    const uint32_t length = array->Length();
+    bitmaps.reserve(length);
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      const RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<const RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32Accumulator::orMany - array must contain only RoaringBitmap32 instances");
+      }
+      bitmaps.push_back(bitmap->roaring);
     }
-
-    if (info.Length() >= 1 && !info[0]->IsUndefined()) {
-      if (info[0]->IsNumber()) {
-        double maxSizeDouble;
-        if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxSizeDouble) || std::isnan(maxSizeDouble)) {
-          return v8utils::throwError(
-            isolate, "RoaringBitmap32::toUint32ArrayAsync - argument must be a valid integer number");
-        }
-        this->maxSize =
-          maxSizeDouble <= 0 ? 0 : (maxSizeDouble > 0xfffffffff ? 0xfffffffff : static_cast<size_t>(maxSizeDouble));
-      } else {
-        if (!argumentIsValidUint32ArrayOutput(info[0]) || !this->inputContent.set(isolate, info[0])) {
-          return v8utils::throwError(
-            isolate, "RoaringBitmap32::toUint32ArrayAsync - argument must be a UInt32Array, Int32Array or ArrayBuffer");
-        }
-        this->hasInput = true;
+  } else {
+    const int length = info.Length();
+    bitmaps.reserve(length);
+    for (int i = 0; i != length; ++i) {
+      const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, i);
+      if (bitmap == nullptr) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32Accumulator::orMany - arguments must be RoaringBitmap32 instances");
       }
+      bitmaps.push_back(bitmap->roaring);
     }
+  }
+  for (const roaring_bitmap_t * bitmap : bitmaps) {
+    if (!self->merge(bitmap)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::orMany - failed to allocate memory");
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
 
-    this->bitmap = self;
-    this->bitmap->beginFreeze();
+void RoaringBitmap32Accumulator_finish(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
+  roaring_bitmap_t * r = self->finish();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::finish - failed to allocate memory");
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
 
-  void work() final {
-    auto size = this->bitmap->getSize();
-    if (size == 0) {
-      return;
-    }
+void RoaringBitmap32Accumulator_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
+  }
+}
 
-    if (this->hasInput) {
-      if (size > this->inputContent.length) {
-        size_t limitedSize = this->inputContent.length;
-        this->outputSize.store(limitedSize, std::memory_order_release);
-        roaring_bitmap_range_uint32_array(this->bitmap->roaring, 0, limitedSize, this->inputContent.data);
-      } else {
-        this->outputSize.store(size, std::memory_order_release);
-        roaring_bitmap_to_uint32_array(this->bitmap->roaring, this->inputContent.data);
-      }
-      return;
-    }
+void RoaringBitmap32Accumulator_count_getter(
+  v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap32Accumulator * self =
+    ObjectWrap::TryUnwrap<const RoaringBitmap32Accumulator>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? self->count : 0U);
+}
 
-    auto maxSize = this->maxSize;
-    if (maxSize > size) {
-      maxSize = size;
-    }
+void RoaringBitmap32Accumulator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32Accumulator> const & info) {
+  RoaringBitmap32Accumulator * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32Accumulator();
+    bare_aligned_free(p);
+  }
+}
 
-    // Allocate a new buffer
-    uint32_t * buffer = static_cast<uint32_t *>(bare_aligned_malloc(32, size * sizeof(uint32_t)));
-    if (!buffer) {
-      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to allocate memory"));
-    }
-    this->allocatedBuffer.store(buffer, std::memory_order_release);
+void RoaringBitmap32Accumulator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
 
-    if (maxSize < size) {
-      roaring_bitmap_range_uint32_array(this->bitmap->roaring, 0, maxSize, buffer);
-    } else {
-      roaring_bitmap_to_uint32_array(this->bitmap->roaring, buffer);
-    }
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Accumulator::ctor - needs to be called with new");
+  }
 
-    this->outputSize.store(maxSize, std::memory_order_release);
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
   }
 
-  void finally() final {
-    if (this->bitmap) {
-      this->bitmap->endFreeze();
-    }
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32Accumulator));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32Accumulator(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::ctor - allocation failed");
   }
 
-  void done(v8::Local<v8::Value> & result) final {
-    uint32_t * allocatedBuffer = this->allocatedBuffer.load(std::memory_order_acquire);
-    size_t outputSize = this->outputSize.load(std::memory_order_acquire);
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32Accumulator::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
 
-    if (this->hasInput) {
-      if (!v8utils::v8ValueToUint32ArrayWithLimit(
-            isolate, this->inputContent.bufferPersistent.Get(isolate), outputSize, result)) {
-        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a UInt32Array range"));
-      }
-      return;
-    }
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32Accumulator_WeakCallback, v8::WeakCallbackType::kParameter);
 
-    if (allocatedBuffer && outputSize != 0) {
-      // Create a new buffer using the allocated memory
-      v8::MaybeLocal<v8::Object> nodeBufferMaybeLocal = node::Buffer::New(
-        isolate,
-        reinterpret_cast<char *>(allocatedBuffer),
-        outputSize * sizeof(uint32_t),
-        bare_aligned_free_callback,
-        nullptr);
-      if (!nodeBufferMaybeLocal.IsEmpty()) {
-        this->allocatedBuffer.store(nullptr, std::memory_order_release);
-      }
+  info.GetReturnValue().Set(holder);
+}
 
-      v8::Local<v8::Object> nodeBufferObject;
-      if (!nodeBufferMaybeLocal.ToLocal(&nodeBufferObject)) {
-        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
-      }
+void RoaringBitmap32Accumulator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
 
-      v8::Local<v8::Uint8Array> nodeBuffer = nodeBufferObject.As<v8::Uint8Array>();
-      if (nodeBuffer.IsEmpty()) {
-        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
-      }
-      result = v8::Uint32Array::New(nodeBuffer->Buffer(), 0, outputSize);
-      if (result.IsEmpty()) {
-        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create a new buffer"));
-      }
-      return;
-    }
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32Accumulator", v8::NewStringType::kInternalized);
 
-    auto arrayBuffer = v8::ArrayBuffer::New(isolate, 0);
-    if (arrayBuffer.IsEmpty()) {
-      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create an empty ArrayBuffer"));
-    }
-    result = v8::Uint32Array::New(arrayBuffer, 0, 0);
-    if (result.IsEmpty()) {
-      return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to create an empty ArrayBuffer"));
-    }
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32Accumulator_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "count", v8::NewStringType::kInternalized),
+    RoaringBitmap32Accumulator_count_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "count", v8::NewStringType::kInternalized),
+    RoaringBitmap32Accumulator_count_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap32Accumulator_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "finish", RoaringBitmap32Accumulator_finish);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "or", RoaringBitmap32Accumulator_or);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orMany", RoaringBitmap32Accumulator_orMany);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32Accumulator");
   }
-};
 
-class SerializeWorker final : public AsyncWorker {
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
+
+#line 1 "src/cpp/RoaringBitmap32Pack.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_32_PACK_
+#define ROARING_NODE_ROARING_BITMAP_32_PACK_
+
+#line 6 "src/cpp/RoaringBitmap32Pack.h"
+
+/**
+ * A bitmap pack file opened for reading.
+ * The file is memory mapped, bitmaps are deserialized or viewed one at a time when requested.
+ */
+class RoaringBitmap32Pack final : public ObjectWrap {
  public:
-  const v8::FunctionCallbackInfo<v8::Value> & info;
-  v8::Global<v8::Value> bitmapPersistent;
-  RoaringBitmapSerializer serializer;
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F41525B0000;
 
-  explicit SerializeWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeWorker));
-  }
+  const uint8_t * data;
+  size_t size;
+  bool isMmap;
+  RoaringBitmapPackFormat format;
+  uint32_t count;
+  const RoaringBitmapPackEntry * entries;
+  v8::Global<v8::Object> persistent;
 
-  virtual ~SerializeWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializeWorker)); }
+  explicit RoaringBitmap32Pack(AddonData * addonData) :
+    ObjectWrap(addonData),
+    data(nullptr),
+    size(0),
+    isMmap(false),
+    format(RoaringBitmapPackFormat::INVALID),
+    count(0),
+    entries(nullptr) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32Pack));
+  }
 
- protected:
-  // Called before the thread starts, in the main thread.
-  void before() final {
-    this->serializer.parseArguments(this->info);
-    if (this->serializer.self) {
-      if (this->maybeAddonData == nullptr) {
-        this->maybeAddonData = this->serializer.self->addonData;
-      }
-      this->bitmapPersistent.Reset(isolate, this->info.This());
-      this->serializer.self->beginFreeze();
+  ~RoaringBitmap32Pack() {
+    this->unmap();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
     }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32Pack));
   }
 
-  void work() final {
-    if (this->serializer.self) {
-      this->setError(this->serializer.serialize());
+  WorkerError map(const std::string & filePath) {
+    int fd = open(filePath.c_str(), O_RDONLY | O_BINARY);
+    if (fd == -1) {
+      return WorkerError::from_errno("open", filePath);
     }
-  }
 
-  void finally() final {
-    if (this->serializer.self) {
-      this->serializer.self->endFreeze();
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      WorkerError err = WorkerError::from_errno("fstat", filePath);
+      close(fd);
+      return err;
     }
-  }
 
-  void done(v8::Local<v8::Value> & result) final { this->serializer.done(this->isolate, result); }
-};
+    const size_t fileSize = (size_t)st.st_size;
+    if (fileSize < sizeof(RoaringBitmapPackHeader)) {
+      close(fd);
+      return WorkerError("RoaringBitmap32Pack - the file is not a valid bitmap pack");
+    }
 
-class SerializeFileWorker final : public AsyncWorker {
- public:
-  const v8::FunctionCallbackInfo<v8::Value> & info;
-  v8::Global<v8::Value> bitmapPersistent;
-  RoaringBitmapFileSerializer serializer;
+    void * buf = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (buf != MAP_FAILED) {
+      this->isMmap = true;
+    } else {
+      // mmap failed, try to read the file into a buffer
+      buf = gcaware_aligned_malloc(32, fileSize);
+      if (buf == nullptr) {
+        WorkerError err = WorkerError::from_errno("mmap", filePath);
+        close(fd);
+        return err;
+      }
+      ssize_t bytesRead = read(fd, buf, fileSize);
+      if (bytesRead == -1 || (size_t)bytesRead != fileSize) {
+        WorkerError err = bytesRead == -1 ? WorkerError::from_errno("read", filePath)
+                                          : WorkerError("RoaringBitmap32Pack - read less bytes than expected");
+        gcaware_aligned_free(buf);
+        close(fd);
+        return err;
+      }
+    }
+    close(fd);
 
-  explicit SerializeFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeFileWorker));
-  }
+    this->data = (const uint8_t *)buf;
+    this->size = fileSize;
 
-  virtual ~SerializeFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializeFileWorker)); }
+    this->entries = roaringPackValidate(this->data, this->size, this->format, this->count);
+    if (this->entries == nullptr) {
+      this->unmap();
+      return WorkerError("RoaringBitmap32Pack - the file is not a valid bitmap pack");
+    }
+    return WorkerError();
+  }
 
- protected:
-  // Called before the thread starts, in the main thread.
-  void before() final {
-    this->serializer.parseArguments(this->info);
-    if (this->serializer.self) {
-      if (this->maybeAddonData == nullptr) {
-        this->maybeAddonData = this->serializer.self->addonData;
-      }
-      this->bitmapPersistent.Reset(isolate, this->info.This());
-      this->serializer.self->beginFreeze();
+  /** Gets the body of the bitmap at the given index. Returns nullptr if the entry is out of the file. */
+  const char * body(uint32_t index, size_t & length) const {
+    RoaringBitmapPackEntry entry;
+    memcpy(&entry, this->entries + index, sizeof(entry));
+    if (entry.offset > this->size || entry.length > this->size - entry.offset || entry.offset % ROARING_PACK_ALIGNMENT != 0) {
+      return nullptr;
     }
+    length = (size_t)entry.length;
+    return (const char *)this->data + entry.offset;
   }
 
-  void work() final {
-    if (this->serializer.self) {
-      this->setError(this->serializer.serialize());
+  /** Creates a frozen view of the bitmap at the given index, over the mapped file. Returns nullptr if the body is invalid. */
+  roaring_bitmap_t * frozenView(uint32_t index) const {
+    size_t length;
+    const char * buf = this->body(index, length);
+    if (buf == nullptr) {
+      return nullptr;
+    }
+    if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+      return const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view(buf, length));
+    }
+    // Checks the structure first, roaring_bitmap_portable_deserialize_frozen does not validate the input.
+    if (roaring_bitmap_portable_deserialize_size(buf, length) != length) {
+      return nullptr;
     }
+    return roaring_bitmap_portable_deserialize_frozen(buf);
   }
 
-  void finally() final {
-    if (this->serializer.self) {
-      this->serializer.self->endFreeze();
+  /** Deserializes a copy of the bitmap at the given index. Returns nullptr if the body is invalid. */
+  roaring_bitmap_t * deserialize(uint32_t index) const {
+    if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+      roaring_bitmap_t * view = this->frozenView(index);
+      if (view == nullptr) {
+        return nullptr;
+      }
+      roaring_bitmap_t * result = roaring_bitmap_copy(view);
+      roaring_bitmap_free(view);
+      return result;
     }
+    size_t length;
+    const char * buf = this->body(index, length);
+    return buf != nullptr ? roaring_bitmap_portable_deserialize_safe(buf, length) : nullptr;
   }
 
-  void done(v8::Local<v8::Value> & result) final {
-    if (!this->bitmapPersistent.IsEmpty()) {
-      result = this->bitmapPersistent.Get(this->isolate);
+ private:
+  void unmap() {
+    if (this->data == nullptr) {
+      return;
+    }
+    if (this->isMmap) {
+      munmap((void *)this->data, this->size);
+    } else {
+      gcaware_aligned_free((void *)this->data);
     }
+    this->data = nullptr;
+    this->entries = nullptr;
+    this->count = 0;
   }
 };
 
-class DeserializeWorker final : public AsyncWorker {
- public:
-  RoaringBitmapDeserializer deserializer;
-  const v8::FunctionCallbackInfo<v8::Value> & info;
+static bool RoaringBitmap32Pack_getIndex(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmap32Pack *& pack, uint32_t & index) {
+  v8::Isolate * isolate = info.GetIsolate();
+  pack = ObjectWrap::TryUnwrap<RoaringBitmap32Pack>(info.This(), isolate);
+  if (pack == nullptr) {
+    v8utils::throwError(isolate, "RoaringBitmap32Pack - invalid object");
+    return false;
+  }
+  double n;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&n)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmap32Pack - index must be a number");
+    return false;
+  }
+  if (!(n >= 0 && n < pack->count) || n != (double)(uint32_t)n) {
+    v8utils::throwError(isolate, "RoaringBitmap32Pack - index out of range");
+    return false;
+  }
+  index = (uint32_t)n;
+  return true;
+}
 
-  explicit DeserializeWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
-    AsyncWorker(info.GetIsolate(), addonData), info(info) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeWorker));
+static bool RoaringBitmap32Pack_newBitmap(
+  RoaringBitmap32Pack * pack, v8::Local<v8::Object> & result, RoaringBitmap32 *& bitmap) {
+  v8::Isolate * isolate = pack->isolate;
+  v8::Local<v8::Function> cons = pack->addonData->RoaringBitmap32_constructor.Get(isolate);
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return false;
+  }
+  bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return false;
   }
+  return true;
+}
 
-  virtual ~DeserializeWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeWorker)); }
+void RoaringBitmap32Pack_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Pack * pack;
+  uint32_t index;
+  if (!RoaringBitmap32Pack_getIndex(info, pack, index)) {
+    return;
+  }
 
- protected:
-  void before() final {
-    this->setError(this->deserializer.parseArguments(this->info, false));
-    if (this->maybeAddonData == nullptr) {
-      if (this->deserializer.targetBitmap != nullptr) {
-        this->maybeAddonData = this->deserializer.targetBitmap->addonData;
-      }
-      if (this->maybeAddonData == nullptr && !this->hasError()) {
-        this->setError(WorkerError("RoaringBitmap32 deserialization failed to get the addon data"));
-      }
-    }
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * bitmap;
+  if (!RoaringBitmap32Pack_newBitmap(pack, result, bitmap)) {
+    return;
   }
 
-  void work() final { this->setError(this->deserializer.deserialize()); }
+  roaring_bitmap_t * r = pack->deserialize(index);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::get - failed to deserialize the bitmap");
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
 
-  void done(v8::Local<v8::Value> & result) final {
-    v8::Isolate * isolate = this->isolate;
+void RoaringBitmap32Pack_view(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Pack * pack;
+  uint32_t index;
+  if (!RoaringBitmap32Pack_getIndex(info, pack, index)) {
+    return;
+  }
 
-    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * bitmap;
+  if (!RoaringBitmap32Pack_newBitmap(pack, result, bitmap)) {
+    return;
+  }
 
-    if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
-      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
-    }
+  roaring_bitmap_t * r = pack->frozenView(index);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::view - failed to create a frozen view");
+  }
 
-    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-    if (self == nullptr) {
-      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
-    }
+  bitmap->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+  bitmap->replaceBitmapInstance(isolate, r);
+  // The view reads from the mapped file, it keeps the pack alive.
+  bitmap->frozenStorage.bufferPersistent.Reset(isolate, info.This());
+  info.GetReturnValue().Set(result);
+}
 
-    self->replaceBitmapInstance(isolate, nullptr);
+void RoaringBitmap32Pack_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32Pack> const & info) {
+  RoaringBitmap32Pack * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32Pack();
+    bare_aligned_free(p);
+  }
+}
 
-    this->deserializer.finalizeTargetBitmap(self);
+void RoaringBitmap32Pack_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Pack::ctor - needs to be called with new");
   }
-};
 
-/**
- * Same as DeserializeWorker but it uses memory mapped files to deserialize the bitmaps.
- */
-class DeserializeFileWorker final : public AsyncWorker {
- public:
-  RoaringBitmapFileDeserializer deserializer;
-  const v8::FunctionCallbackInfo<v8::Value> & info;
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
 
-  explicit DeserializeFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
-    AsyncWorker(info.GetIsolate(), addonData), info(info) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeFileWorker));
+  if (info.Length() < 1 || !info[0]->IsString()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Pack::ctor - expects a file path as the first argument");
   }
 
-  virtual ~DeserializeFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeFileWorker)); }
+  auto holder = info.This();
 
- protected:
-  void before() final { this->setError(this->deserializer.parseArguments(this->info)); }
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32Pack));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32Pack(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::ctor - allocation failed");
+  }
 
-  void work() final { this->setError(this->deserializer.deserialize()); }
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32Pack::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
 
-  void done(v8::Local<v8::Value> & result) {
-    v8::Isolate * isolate = this->isolate;
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32Pack_WeakCallback, v8::WeakCallbackType::kParameter);
 
-    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+  WorkerError error = instance->map(std::string(*filePathUtf8, filePathUtf8.length()));
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
 
-    if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
-      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
-    }
+  v8utils::defineReadonlyField(isolate, holder, "length", v8::Uint32::NewFromUnsigned(isolate, instance->count));
+  v8utils::defineReadonlyField(
+    isolate,
+    holder,
+    "format",
+    instance->format == RoaringBitmapPackFormat::unsafe_frozen_croaring
+      ? NEW_LITERAL_V8_STRING(isolate, "unsafe_frozen_croaring", v8::NewStringType::kInternalized)
+      : NEW_LITERAL_V8_STRING(isolate, "portable", v8::NewStringType::kInternalized));
 
-    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-    if (self == nullptr) {
-      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
-    }
+  info.GetReturnValue().Set(holder);
+}
 
-    self->replaceBitmapInstance(isolate, nullptr);
+void RoaringBitmap32Pack_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
 
-    this->deserializer.finalizeTargetBitmap(self);
-  }
-};
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32Pack", v8::NewStringType::kInternalized);
 
-class DeserializeParallelWorker : public ParallelAsyncWorker {
- public:
-  v8::Global<v8::Value> bufferPersistent;
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32Pack_New, addonData->external.Get(isolate));
 
-  RoaringBitmapDeserializer * items;
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
 
-  explicit DeserializeParallelWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
-    ParallelAsyncWorker(isolate, maybeAddonData), items(nullptr) {}
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmap32Pack_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "view", RoaringBitmap32Pack_view);
 
-  virtual ~DeserializeParallelWorker() {
-    if (items) {
-      delete[] items;
-    }
-  }
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
 
- protected:
-  virtual void parallelWork(uint32_t index) {
-    RoaringBitmapDeserializer & item = items[index];
-    const WorkerError error = item.deserialize();
-    if (error.hasError()) {
-      this->setError(error);
-    }
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32Pack");
   }
 
-  void done(v8::Local<v8::Value> & result) final {
-    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate);
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
 
-    const uint32_t itemsCount = this->loopCount;
-    RoaringBitmapDeserializer * items = this->items;
+#endif  // ROARING_NODE_ROARING_BITMAP_32_PACK_
 
-    v8::MaybeLocal<v8::Array> resultArrayMaybe = v8::Array::New(isolate, itemsCount);
-    v8::Local<v8::Array> resultArray;
-    if (!resultArrayMaybe.ToLocal(&resultArray)) {
-      return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new array"));
-    }
+#line 1 "src/cpp/RoaringBitmapIndex.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_INDEX_
+#define ROARING_NODE_ROARING_BITMAP_INDEX_
 
-    v8::Local<v8::Context> currentContext = isolate->GetCurrentContext();
+#line 5 "src/cpp/RoaringBitmapIndex.h"
 
-    for (uint32_t i = 0; i != itemsCount; ++i) {
-      v8::MaybeLocal<v8::Object> instanceMaybe = cons->NewInstance(currentContext, 0, nullptr);
-      v8::Local<v8::Object> instance;
-      if (!instanceMaybe.ToLocal(&instance)) {
-        return this->setError(WorkerError("RoaringBitmap32 deserialization failed to create a new instance"));
-      }
+/**
+ * A keyed store of bitmaps, for inverted indexes: string keys are mapped to native roaring bitmaps.
+ *
+ * Bitmaps are owned by a C++ hash table and have no JS object, no persistent handle and no weak callback each;
+ * JS RoaringBitmap32 instances are created only when a bitmap or the result of an operation is requested.
+ * Keys whose bitmap becomes empty are removed.
+ */
+class RoaringBitmapIndex final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152494400;
 
-      RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(instance, isolate);
-      if (unwrapped == nullptr) {
-        return this->setError(WorkerError(ERROR_INVALID_OBJECT));
-      }
+  /** Approximation of the memory used by an entry of the hash table, in addition to the key and the bitmap. */
+  static const constexpr int64_t ENTRY_OVERHEAD =
+    (int64_t)(sizeof(std::string) + sizeof(roaring_bitmap_t) + 4 * sizeof(void *));
 
-      RoaringBitmapDeserializer & item = items[i];
-      item.finalizeTargetBitmap(unwrapped);
-      ignoreMaybeResult(resultArray->Set(currentContext, i, instance));
-    }
+  std::unordered_map<std::string, roaring_bitmap_t *> entries;
+  v8::Global<v8::Object> persistent;
 
-    result = resultArray;
+  explicit RoaringBitmapIndex(AddonData * addonData) : ObjectWrap(addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmapIndex));
   }
-};
-
-class FromArrayAsyncWorker : public RoaringBitmap32FactoryAsyncWorker {
- public:
-  v8::Global<v8::Value> argPersistent;
-  v8utils::TypedArrayContent<uint32_t> buffer;
 
-  explicit FromArrayAsyncWorker(v8::Isolate * isolate, AddonData * addonData) :
-    RoaringBitmap32FactoryAsyncWorker(isolate, addonData) {
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(FromArrayAsyncWorker));
+  ~RoaringBitmapIndex() {
+    this->clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmapIndex));
   }
 
-  virtual ~FromArrayAsyncWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(FromArrayAsyncWorker)); }
-
- protected:
-  void work() final {
-    roaring_bitmap_t_ptr newBitmap = roaring_bitmap_create_with_capacity(buffer.length);
-    if (newBitmap == nullptr) {
-      this->setError(WorkerError("Failed to allocate roaring bitmap"));
-      return;
+  void clear() {
+    int64_t memory = 0;
+    for (auto & entry : this->entries) {
+      memory += ENTRY_OVERHEAD + (int64_t)entry.first.size();
+      roaring_bitmap_free(entry.second);
     }
-    this->bitmap.store(newBitmap, std::memory_order_release);
-    roaring_bitmap_add_many(newBitmap, buffer.length, buffer.data);
-    roaring_bitmap_run_optimize(newBitmap);
-    roaring_bitmap_shrink_to_fit(newBitmap);
+    this->entries.clear();
+    _gcaware_adjustAllocatedMemory(this->isolate, -memory);
   }
-};
 
-#endif  // ROARING_NODE_ASYNC_WORKERS_
-
-#line 7 "src/cpp/RoaringBitmap32-serialization.h"
+  roaring_bitmap_t * find(const std::string & key) const {
+    auto it = this->entries.find(key);
+    return it != this->entries.end() ? it->second : nullptr;
+  }
 
-void RoaringBitmap32_serialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+  /** Gets the bitmap of a key, creating an empty one if the key does not exist. Returns nullptr if allocation failed. */
+  roaring_bitmap_t * getOrCreate(const std::string & key) {
+    auto it = this->entries.find(key);
+    if (it != this->entries.end()) {
+      return it->second;
+    }
+    roaring_bitmap_t * bitmap = roaring_bitmap_create();
+    if (bitmap == nullptr) {
+      return nullptr;
+    }
+    this->entries.emplace(key, bitmap);
+    _gcaware_adjustAllocatedMemory(this->isolate, ENTRY_OVERHEAD + (int64_t)key.size());
+    return bitmap;
+  }
 
-  RoaringBitmapSerializer serializer;
-  serializer.parseArguments(info);
-  if (serializer.self) {
-    WorkerError error = serializer.serialize();
-    if (error.hasError()) {
-      isolate->ThrowException(error.newV8Error(isolate));
+  /** Replaces the bitmap of a key, the index takes ownership of the bitmap. Empty bitmaps remove the key. */
+  void replace(const std::string & key, roaring_bitmap_t * bitmap) {
+    if (roaring_bitmap_is_empty(bitmap)) {
+      roaring_bitmap_free(bitmap);
+      this->erase(key);
       return;
     }
-    v8::Local<v8::Value> result;
-    serializer.done(isolate, result);
-    if (!result.IsEmpty()) {
-      info.GetReturnValue().Set(result);
+    auto it = this->entries.find(key);
+    if (it != this->entries.end()) {
+      roaring_bitmap_free(it->second);
+      it->second = bitmap;
+    } else {
+      this->entries.emplace(key, bitmap);
+      _gcaware_adjustAllocatedMemory(this->isolate, ENTRY_OVERHEAD + (int64_t)key.size());
+    }
+  }
+
+  bool erase(const std::string & key) {
+    auto it = this->entries.find(key);
+    if (it == this->entries.end()) {
+      return false;
     }
+    roaring_bitmap_free(it->second);
+    this->entries.erase(it);
+    _gcaware_adjustAllocatedMemory(this->isolate, -(ENTRY_OVERHEAD + (int64_t)key.size()));
+    return true;
+  }
+};
+
+static RoaringBitmapIndex * RoaringBitmapIndex_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = ObjectWrap::TryUnwrap<RoaringBitmapIndex>(info.This(), isolate);
+  if (self == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
+  return self;
 }
 
-void RoaringBitmap32_serializeAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  SerializeWorker * worker = new SerializeWorker(info, nullptr);
-  info.GetReturnValue().Set(AsyncWorker::run(worker));
+static bool RoaringBitmapIndex_toKey(v8::Isolate * isolate, const v8::Local<v8::Value> & value, std::string & key) {
+  if (value.IsEmpty() || !value->IsString()) {
+    return false;
+  }
+  v8::String::Utf8Value utf8(isolate, value);
+  key.assign(*utf8, utf8.length());
+  return true;
 }
 
-void RoaringBitmap32_serializeFileAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  SerializeFileWorker * worker = new SerializeFileWorker(info, nullptr);
-  info.GetReturnValue().Set(AsyncWorker::run(worker));
+static bool RoaringBitmapIndex_getKey(const v8::FunctionCallbackInfo<v8::Value> & info, std::string & key) {
+  if (info.Length() < 1 || !RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key)) {
+    v8utils::throwTypeError(info.GetIsolate(), "RoaringBitmapIndex - key must be a string");
+    return false;
+  }
+  return true;
 }
 
-void RoaringBitmap32_unsafeFrozenViewStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+static bool RoaringBitmapIndex_getId(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, uint32_t & id) {
   v8::Isolate * isolate = info.GetIsolate();
-
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  if (info.Length() <= argumentIndex || !v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[argumentIndex], id)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapIndex - id must be a 32 bit unsigned integer");
+    return false;
   }
+  return true;
+}
 
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+/**
+ * Collects the bitmaps of an array of keys. Missing keys are skipped and counted.
+ * Returns false and throws if the argument is not an array of strings.
+ */
+static bool RoaringBitmapIndex_getBitmaps(
+  const v8::FunctionCallbackInfo<v8::Value> & info,
+  const RoaringBitmapIndex * self,
+  std::vector<const roaring_bitmap_t *> & bitmaps,
+  size_t & missing) {
+  v8::Isolate * isolate = info.GetIsolate();
+  missing = 0;
+  if (info.Length() < 1 || !info[0]->IsArray()) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+    return false;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> array = info[0].As<v8::Array>();
+  const uint32_t length = array->Length();
+  bitmaps.reserve(length);
+  std::string key;
+  for (uint32_t i = 0; i != length; ++i) {
+    v8::Local<v8::Value> item;
+    if (!array->Get(context, i).ToLocal(&item) || !RoaringBitmapIndex_toKey(isolate, item, key)) {
+      v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+      return false;
+    }
+    const roaring_bitmap_t * bitmap = self->find(key);
+    if (bitmap != nullptr) {
+      bitmaps.push_back(bitmap);
+    } else {
+      ++missing;
+    }
+  }
+  return true;
+}
 
-  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+/** Wraps a roaring_bitmap_t in a new RoaringBitmap32 and returns it. The bitmap is released on failure. */
+static void RoaringBitmapIndex_returnBitmap(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmapIndex * self, roaring_bitmap_t * r) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex - failed to allocate memory");
+  }
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
   v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) {
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    roaring_bitmap_free(r);
     return;
   }
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (self == nullptr) {
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    roaring_bitmap_free(r);
     return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
-  self->replaceBitmapInstance(isolate, nullptr);
-
-  if (info.Length() < 2) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView expects a format and a buffer arguments");
-  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
 
-  int bufferArgIndex = 1;
-  FrozenViewFormat format = tryParseFrozenViewFormat(info[0], isolate);
-  if (format == FrozenViewFormat::INVALID) {
-    bufferArgIndex = 0;
-    format = tryParseFrozenViewFormat(info[1], isolate);
+void RoaringBitmapIndex_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  uint32_t id;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key) || !RoaringBitmapIndex_getId(info, 1, id)) {
+    return;
   }
-  if (format == FrozenViewFormat::INVALID) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView format argument is invalid");
+  roaring_bitmap_t * bitmap = self->getOrCreate(key);
+  if (bitmap == nullptr) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex::add - failed to allocate memory");
   }
+  roaring_bitmap_add(bitmap, id);
+  info.GetReturnValue().Set(info.This());
+}
 
-  v8utils::TypedArrayContent<uint8_t> storage(isolate, info[bufferArgIndex]);
-
-  v8utils::TypedArrayContent<uint8_t> & frozenStorage = self->frozenStorage;
-
-  if (
-    !info[bufferArgIndex]->IsNullOrUndefined() &&
-    !frozenStorage.set(isolate, info[bufferArgIndex]->ToObject(isolate->GetCurrentContext()))) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView buffer argument was invalid");
+/**
+ * addMany(key, ids) adds all the ids to a key.
+ * addMany(keys, ids) adds ids[i] to keys[i], the ids of consecutive equal keys are added to their bitmap at once.
+ * Keys and ids are all validated before the index is modified.
+ */
+void RoaringBitmapIndex_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self == nullptr) {
+    return;
   }
-
-  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
-
-  roaring_bitmap_t * bitmap = nullptr;
-
-  switch (format) {
-    case FrozenViewFormat::unsafe_frozen_croaring: {
-      if (!is_pointer_aligned(storage.data, 32)) {
-        return v8utils::throwError(
-          isolate,
-          "RoaringBitmap32::unsafeFrozenView with format unsafe_frozen_croaring requires the buffer to be 32 bytes aligned. "
-          "You can use bufferAlignedAlloc, bufferAlignedAllocUnsafe or ensureBufferAligned exposed by the roaring library.");
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  const bool manyKeys = info.Length() > 0 && info[0]->IsArray();
+  if (info.Length() < 2 || !(manyKeys || info[0]->IsString())) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::addMany - keys must be a string or an array of strings");
+  }
+
+  // Ids in a JS array are converted first, so invalid ids are rejected before the index is modified.
+  v8utils::TypedArrayContent<uint32_t> typedIds;
+  std::vector<uint32_t> arrayIds;
+  const uint32_t * ids;
+  size_t idsCount;
+  if (info[1]->IsUint32Array() || info[1]->IsInt32Array()) {
+    typedIds.set(isolate, info[1]);
+    ids = typedIds.data;
+    idsCount = typedIds.length;
+  } else if (info[1]->IsArray()) {
+    v8::Local<v8::Array> array = info[1].As<v8::Array>();
+    idsCount = array->Length();
+    arrayIds.resize(idsCount);
+    for (size_t i = 0; i != idsCount; ++i) {
+      v8::Local<v8::Value> item;
+      if (
+        !array->Get(context, (uint32_t)i).ToLocal(&item) ||
+        !v8utils::v8ValueToUint32Fast(context, item, arrayIds[i])) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmapIndex - id must be a 32 bit unsigned integer");
       }
-
-      bitmap =
-        const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view((const char *)frozenStorage.data, frozenStorage.length));
-      break;
-    }
-    case FrozenViewFormat::unsafe_frozen_portable: {
-      bitmap = roaring_bitmap_portable_deserialize_frozen((const char *)frozenStorage.data);
-      break;
-    }
-    default: {
-      return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView format argument is invalid");
     }
+    ids = arrayIds.data();
+  } else {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::addMany - ids must be a Uint32Array or an array");
   }
 
-  if (!bitmap) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::unsafeFrozenView failed to deserialize the input");
+  info.GetReturnValue().Set(info.This());
+  std::string key;
+  if (!manyKeys) {
+    if (idsCount == 0) {
+      return;
+    }
+    RoaringBitmapIndex_toKey(isolate, info[0], key);
+    roaring_bitmap_t * bitmap = self->getOrCreate(key);
+    if (bitmap == nullptr) {
+      return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - failed to allocate memory");
+    }
+    roaring_bitmap_add_many(bitmap, idsCount, ids);
+    return;
   }
 
-  self->replaceBitmapInstance(isolate, bitmap);
-
-  info.GetReturnValue().Set(result);
-}
-
-void RoaringBitmap32_deserializeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  v8::Local<v8::Array> keys = info[0].As<v8::Array>();
+  if (keys->Length() != idsCount) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - keys and ids must have the same length");
   }
 
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
-
-  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) {
-    return;
+  // Keys are converted before the index is modified too. Each run of consecutive equal keys is stored once, with the
+  // index of the id that follows the run.
+  std::vector<std::pair<std::string, size_t>> runs;
+  v8::Local<v8::Value> previousKey;
+  for (size_t i = 0; i != idsCount; ++i) {
+    v8::Local<v8::Value> item;
+    if (!keys->Get(context, (uint32_t)i).ToLocal(&item)) {
+      return;
+    }
+    if (runs.empty() || !item->StrictEquals(previousKey)) {
+      if (!RoaringBitmapIndex_toKey(isolate, item, key)) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+      }
+      runs.emplace_back(std::move(key), i);
+      previousKey = item;
+    }
+    runs.back().second = i + 1;
   }
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  size_t start = 0;
+  for (const auto & run : runs) {
+    roaring_bitmap_t * bitmap = self->getOrCreate(run.first);
+    if (bitmap == nullptr) {
+      return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - failed to allocate memory");
+    }
+    roaring_bitmap_add_many(bitmap, run.second - start, ids + start);
+    start = run.second;
   }
-  self->replaceBitmapInstance(isolate, nullptr);
+}
 
-  RoaringBitmapDeserializer deserializer;
-  WorkerError error = deserializer.parseArguments(info, false);
-  if (!error.hasError()) {
-    error = deserializer.deserialize();
-  }
-  if (error.hasError()) {
-    isolate->ThrowException(error.newV8Error(isolate));
+void RoaringBitmapIndex_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  uint32_t id;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key) || !RoaringBitmapIndex_getId(info, 1, id)) {
     return;
   }
-
-  deserializer.finalizeTargetBitmap(self);
-
-  info.GetReturnValue().Set(result);
+  roaring_bitmap_t * bitmap = self->find(key);
+  const bool removed = bitmap != nullptr && roaring_bitmap_remove_checked(bitmap, id);
+  if (removed && roaring_bitmap_is_empty(bitmap)) {
+    self->erase(key);
+  }
+  info.GetReturnValue().Set(removed);
 }
 
-void RoaringBitmap32_deserializeFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmapIndex_set(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
-
-  v8::MaybeLocal<v8::Object> resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
     return;
   }
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, 1);
+  if (bitmap == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::set - bitmap must be a RoaringBitmap32");
   }
-  self->replaceBitmapInstance(isolate, nullptr);
-
-  RoaringBitmapFileDeserializer deserializer;
-  WorkerError error = deserializer.parseArguments(info);
-  if (!error.hasError()) {
-    error = deserializer.deserialize();
+  roaring_bitmap_t * copy = roaring_bitmap_copy(bitmap->roaring);
+  if (copy == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::set - failed to allocate memory");
   }
-  if (error.hasError()) {
-    isolate->ThrowException(error.newV8Error(isolate));
+  self->replace(key, copy);
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmapIndex_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
     return;
   }
+  const roaring_bitmap_t * bitmap = self->find(key);
+  if (bitmap != nullptr) {
+    RoaringBitmapIndex_returnBitmap(info, self, roaring_bitmap_copy(bitmap));
+  }
+}
 
-  deserializer.finalizeTargetBitmap(self);
-
-  info.GetReturnValue().Set(result);
+void RoaringBitmapIndex_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key) &&
+    self->find(key) != nullptr);
 }
 
-void RoaringBitmap32_deserialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+void RoaringBitmapIndex_delete(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key) &&
+    self->erase(key));
+}
 
-  RoaringBitmapDeserializer deserializer;
-  WorkerError error = deserializer.parseArguments(info, true);
-  if (!error.hasError()) {
-    error = deserializer.deserialize();
+void RoaringBitmapIndex_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
   }
-  if (error.hasError()) {
-    isolate->ThrowException(error.newV8Error(isolate));
+}
+
+void RoaringBitmapIndex_cardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
     return;
   }
-
-  deserializer.targetBitmap->replaceBitmapInstance(isolate, nullptr);
-
-  deserializer.finalizeTargetBitmap(deserializer.targetBitmap);
-
-  info.GetReturnValue().Set(info.This());
+  const roaring_bitmap_t * bitmap = self->find(key);
+  info.GetReturnValue().Set(bitmap != nullptr ? (double)roaring_bitmap_get_cardinality(bitmap) : 0.0);
 }
 
-void RoaringBitmap32_deserializeAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmapIndex_keys(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self == nullptr) {
+    return;
   }
-
-  auto * worker = new DeserializeWorker(info, addonData);
-  if (worker == nullptr) {
-    return v8utils::throwError(isolate, "RoaringBitmap32 deserialization failed to allocate async worker");
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> result = v8::Array::New(isolate, (int)self->entries.size());
+  uint32_t index = 0;
+  for (const auto & entry : self->entries) {
+    v8::Local<v8::String> key;
+    if (!v8::String::NewFromUtf8(isolate, entry.first.data(), v8::NewStringType::kNormal, (int)entry.first.size())
+           .ToLocal(&key)) {
+      return;
+    }
+    ignoreMaybeResult(result->Set(context, index++, key));
   }
+  info.GetReturnValue().Set(result);
+}
 
-  if (info.Length() >= 3 && info[2]->IsFunction()) {
-    worker->setCallback(info[2]);
+void RoaringBitmapIndex_orMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
   }
-
-  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
-  info.GetReturnValue().Set(returnValue);
+  RoaringBitmapIndex_returnBitmap(
+    info, self, bitmaps.empty() ? roaring_bitmap_create() : roaring_bitmap_or_many(bitmaps.size(), bitmaps.data()));
 }
 
-void RoaringBitmap32_deserializeFileAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+void RoaringBitmapIndex_andMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  if (missing != 0) {
+    bitmaps.clear();  // A missing key is an empty bitmap, the intersection is empty.
   }
+  roaringSortByCardinality(bitmaps.data(), bitmaps.size());
+  RoaringBitmapIndex_returnBitmap(info, self, roaringAndMany(bitmaps.size(), bitmaps.data()));
+}
 
-  auto * worker = new DeserializeFileWorker(info, addonData);
-  if (worker == nullptr) {
-    return v8utils::throwError(isolate, "RoaringBitmap32 deserialization failed to allocate async worker");
+void RoaringBitmapIndex_orManyCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
   }
+  uint64_t cardinality;
+  if (!roaringOrManyCardinality(bitmaps.data(), bitmaps.size(), cardinality)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex - failed to allocate memory");
+  }
+  info.GetReturnValue().Set((double)cardinality);
+}
 
-  if (info.Length() >= 3 && info[2]->IsFunction()) {
-    worker->setCallback(info[2]);
+void RoaringBitmapIndex_andManyCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  if (missing != 0) {
+    return info.GetReturnValue().Set(0);
+  }
+  roaringSortByCardinality(bitmaps.data(), bitmaps.size());
+  uint64_t cardinality;
+  if (!roaringAndManyCardinality(bitmaps.data(), bitmaps.size(), cardinality)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex - failed to allocate memory");
   }
+  info.GetReturnValue().Set((double)cardinality);
+}
 
-  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
-  info.GetReturnValue().Set(returnValue);
+void RoaringBitmapIndex_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapIndex * self = ObjectWrap::TryUnwrap<const RoaringBitmapIndex>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? (double)self->entries.size() : 0.0);
 }
 
-void RoaringBitmap32_deserializeParallelStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmapIndex_WeakCallback(v8::WeakCallbackInfo<RoaringBitmapIndex> const & info) {
+  RoaringBitmapIndex * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmapIndex();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmapIndex_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::ctor - needs to be called with new");
+  }
+
   AddonData * addonData = AddonData::get(info);
   if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
   }
 
-  auto * worker = new DeserializeParallelWorker(isolate, addonData);
-  if (worker == nullptr) {
-    return v8utils::throwError(isolate, "Failed to allocate async worker");
-  }
+  auto holder = info.This();
 
-  if (info.Length() >= 3 && info[2]->IsFunction()) {
-    worker->setCallback(info[2]);
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmapIndex));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmapIndex(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::ctor - allocation failed");
   }
 
-  if (info.Length() < 2) {
-    worker->setError(WorkerError("RoaringBitmap32::deserializeAsync - requires at least two arguments"));
-    return info.GetReturnValue().Set(AsyncWorker::run(worker));
-  }
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmapIndex::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
 
-  if (!info[0]->IsArray()) {
-    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync requires an array as first argument"));
-    return info.GetReturnValue().Set(AsyncWorker::run(worker));
-  }
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmapIndex_WeakCallback, v8::WeakCallbackType::kParameter);
 
-  auto array = v8::Local<v8::Array>::Cast(info[0]);
-  uint32_t length = array->Length();
+  info.GetReturnValue().Set(holder);
+}
 
-  if (length > 0x01FFFFFF) {
-    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync - array too big"));
-    return info.GetReturnValue().Set(AsyncWorker::run(worker));
-  }
+void RoaringBitmapIndex_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
 
-  DeserializationFormat format = tryParseDeserializationFormat(info[1], isolate);
-  if (format == DeserializationFormat::INVALID) {
-    worker->setError(
-      WorkerError("RoaringBitmap32::deserializeAsync - second argument must be a valid deserialization format"));
-    return info.GetReturnValue().Set(AsyncWorker::run(worker));
-  }
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmapIndex", v8::NewStringType::kInternalized);
 
-  RoaringBitmapDeserializer * items = length ? new RoaringBitmapDeserializer[length]() : nullptr;
-  if (items == nullptr && length != 0) {
-    worker->setError(WorkerError("RoaringBitmap32::deserializeParallelAsync - failed to allocate array of deserializers"));
-    return info.GetReturnValue().Set(AsyncWorker::run(worker));
-  }
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmapIndex_New, addonData->external.Get(isolate));
 
-  worker->items = items;
-  worker->loopCount = length;
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
 
-  auto context = isolate->GetCurrentContext();
-  for (uint32_t i = 0; i != length; ++i) {
-    WorkerError err = items[i].setOutput(isolate, array->Get(context, i), (FileDeserializationFormat)format);
-    if (err.hasError()) {
-      worker->setError(err);
-      return info.GetReturnValue().Set(AsyncWorker::run(worker));
-    }
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapIndex_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapIndex_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmapIndex_add);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmapIndex_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andMany", RoaringBitmapIndex_andMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andManyCardinality", RoaringBitmapIndex_andManyCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "cardinality", RoaringBitmapIndex_cardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmapIndex_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmapIndex_delete);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmapIndex_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmapIndex_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "keys", RoaringBitmapIndex_keys);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orMany", RoaringBitmapIndex_orMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orManyCardinality", RoaringBitmapIndex_orManyCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmapIndex_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "set", RoaringBitmapIndex_set);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmapIndex");
   }
 
-  info.GetReturnValue().Set(AsyncWorker::run(worker));
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
 }
 
-void RoaringBitmap32_getSerializationSizeInBytes(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return info.GetReturnValue().Set(0U);
+#endif  // ROARING_NODE_ROARING_BITMAP_INDEX_
+
+#line 1 "src/cpp/RoaringBitmapSliced32.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_SLICED_32_
+#define ROARING_NODE_ROARING_BITMAP_SLICED_32_
+
+#line 5 "src/cpp/RoaringBitmapSliced32.h"
+
+enum class RoaringBitmapSliced32Operation { EQ, NEQ, LT, LE, GT, GE };
+
+/**
+ * A bit-sliced index: maps 32 bit columns (row ids) to 32 bit unsigned values.
+ *
+ * The existence bitmap contains all the columns that have a value, the slice i contains the columns whose value has the
+ * bit i set. Slices are allocated up to the highest bit ever set, so small values use few bitmaps.
+ * Predicates and aggregates are computed slice by slice with bitmap operations, without visiting the columns.
+ */
+class RoaringBitmapSliced32 final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152534900;
+  static const constexpr uint32_t MAX_BIT_DEPTH = 32;
+
+  roaring_bitmap_t * existence;
+  roaring_bitmap_t * slices[MAX_BIT_DEPTH];
+  uint32_t bitDepth;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmapSliced32(AddonData * addonData) :
+    ObjectWrap(addonData), existence(roaring_bitmap_create()), slices(), bitDepth(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmapSliced32));
   }
 
-  SerializationFormat format =
-    info.Length() > 0 ? tryParseSerializationFormat(info[0], isolate) : SerializationFormat::INVALID;
+  ~RoaringBitmapSliced32() {
+    this->clear();
+    if (this->existence != nullptr) {
+      roaring_bitmap_free(this->existence);
+    }
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmapSliced32));
+  }
 
-  if (format == SerializationFormat::INVALID) {
-    return v8utils::throwError(
-      info.GetIsolate(), "RoaringBitmap32::getSerializationSizeInBytes format argument was invalid");
+  /** Removes all the columns and releases the slices. */
+  void clear() {
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      roaring_bitmap_free(this->slices[i]);
+      this->slices[i] = nullptr;
+    }
+    this->bitDepth = 0;
+    if (this->existence != nullptr) {
+      roaring_bitmap_clear(this->existence);
+    }
   }
 
-  switch (format) {
-    case SerializationFormat::croaring: {
-      auto cardinality = self->getSize();
-      auto sizeasarray = cardinality * sizeof(uint32_t) + sizeof(uint32_t);
-      auto portablesize = roaring_bitmap_portable_size_in_bytes(self->roaring);
-      if (portablesize < sizeasarray || sizeasarray >= MAX_SERIALIZATION_ARRAY_SIZE_IN_BYTES - 1) {
-        return info.GetReturnValue().Set((double)(portablesize) + 1);
+  /** Allocates the slices needed to store the given value. Returns false if the allocation failed. */
+  bool grow(uint32_t value) {
+    const uint32_t depth = value != 0 ? 64 - (uint32_t)roaring_leading_zeroes(value) : 0;
+    while (this->bitDepth < depth) {
+      roaring_bitmap_t * slice = roaring_bitmap_create();
+      if (slice == nullptr) {
+        return false;
       }
-      return info.GetReturnValue().Set((double)(sizeasarray) + 1);
+      this->slices[this->bitDepth++] = slice;
     }
+    return true;
+  }
 
-    case SerializationFormat::portable: {
-      return info.GetReturnValue().Set((double)(roaring_bitmap_portable_size_in_bytes(self->roaring)));
+  /** Sets the value of a column. The slice bulk contexts can be passed to speed up sequential calls. */
+  bool set(uint32_t column, uint32_t value, roaring_bulk_context_t * contexts = nullptr) {
+    if (this->existence == nullptr || !this->grow(value)) {
+      return false;
     }
-
-    case SerializationFormat::unsafe_frozen_croaring: {
-      return info.GetReturnValue().Set((double)(roaring_bitmap_frozen_size_in_bytes(self->roaring)));
+    // Columns that are new have no bit set in any slice, there is nothing to remove.
+    const bool existed = !roaring_bitmap_add_checked(this->existence, column);
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      if ((value >> i) & 1) {
+        if (contexts != nullptr) {
+          roaring_bitmap_add_bulk(this->slices[i], &contexts[i], column);
+        } else {
+          roaring_bitmap_add(this->slices[i], column);
+        }
+      } else if (existed) {
+        roaring_bitmap_remove(this->slices[i], column);
+        if (contexts != nullptr) {
+          // A removal can convert or free the container cached in the bulk context.
+          contexts[i] = roaring_bulk_context_t();
+        }
+      }
     }
+    return true;
+  }
 
-    default: {
-      return v8utils::throwError(
-        info.GetIsolate(), "RoaringBitmap32::getSerializationSizeInBytes format argument was invalid");
+  bool get(uint32_t column, uint32_t & value) const {
+    if (this->existence == nullptr || !roaring_bitmap_contains(this->existence, column)) {
+      return false;
+    }
+    uint32_t result = 0;
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      if (roaring_bitmap_contains(this->slices[i], column)) {
+        result |= (uint32_t)1 << i;
+      }
     }
+    value = result;
+    return true;
   }
-}
 
-#endif  // ROARING_NODE_ROARING_BITMAP32_SERIALIZATION_
+  bool remove(uint32_t column) {
+    if (this->existence == nullptr || !roaring_bitmap_remove_checked(this->existence, column)) {
+      return false;
+    }
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      roaring_bitmap_remove(this->slices[i], column);
+    }
+    return true;
+  }
 
-#line 1 "src/cpp/RoaringBitmap32-ranges.h"
-#ifndef ROARING_NODE_ROARING_BITMAP32_RANGES_
-#define ROARING_NODE_ROARING_BITMAP32_RANGES_
+  /** Creates the set of the columns that have a value and are in the filter, if a filter is given. */
+  roaring_bitmap_t * found(const roaring_bitmap_t * filter) const {
+    return filter != nullptr ? roaring_bitmap_and(this->existence, filter) : roaring_bitmap_copy(this->existence);
+  }
 
-#line 6 "src/cpp/RoaringBitmap32-ranges.h"
+  /**
+   * Computes the columns whose value satisfies the comparison with the given value, with the O'Neil algorithm:
+   * the slices are visited from the most significant one, the columns equal so far are split in the columns
+   * that are lower, greater or still equal to the prefix of the value.
+   */
+  roaring_bitmap_t * compare(RoaringBitmapSliced32Operation op, uint32_t value, const roaring_bitmap_t * filter) const {
+    roaring_bitmap_t * eq = this->found(filter);
+    if (eq == nullptr) {
+      return nullptr;
+    }
+    roaring_bitmap_t * lt = roaring_bitmap_create();
+    roaring_bitmap_t * gt = roaring_bitmap_create();
+    if (lt == nullptr || gt == nullptr) {
+      roaring_bitmap_free(eq);
+      roaring_bitmap_free(lt);
+      roaring_bitmap_free(gt);
+      return nullptr;
+    }
 
-inline bool getRangeOperationParameters(
-  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & minInteger, uint64_t & maxInteger) {
-  v8::Isolate * isolate = info.GetIsolate();
-  double minimum = 0, maximum = 4294967296;
+    const bool needsLt = op == RoaringBitmapSliced32Operation::LT || op == RoaringBitmapSliced32Operation::LE ||
+      op == RoaringBitmapSliced32Operation::NEQ;
+    const bool needsGt = op == RoaringBitmapSliced32Operation::GT || op == RoaringBitmapSliced32Operation::GE ||
+      op == RoaringBitmapSliced32Operation::NEQ;
 
-  if (info.Length() > 0 && !info[0]->IsUndefined()) {
-    if (!info[0]->IsNumber()) {
-      return false;
+    if (this->bitDepth < 32 && (value >> this->bitDepth) != 0) {
+      // The value has a bit higher than any stored value, all the values are lower.
+      std::swap(lt, eq);
+    } else {
+      for (uint32_t i = this->bitDepth; i-- != 0 && !roaring_bitmap_is_empty(eq);) {
+        const roaring_bitmap_t * slice = this->slices[i];
+        if ((value >> i) & 1) {
+          if (needsLt) {
+            roaring_bitmap_t * lower = roaring_bitmap_andnot(eq, slice);
+            roaring_bitmap_or_inplace(lt, lower);
+            roaring_bitmap_free(lower);
+          }
+          roaring_bitmap_and_inplace(eq, slice);
+        } else {
+          if (needsGt) {
+            roaring_bitmap_t * greater = roaring_bitmap_and(eq, slice);
+            roaring_bitmap_or_inplace(gt, greater);
+            roaring_bitmap_free(greater);
+          }
+          roaring_bitmap_andnot_inplace(eq, slice);
+        }
+      }
     }
-    if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&minimum)) {
-      minimum = 0;
+
+    roaring_bitmap_t ** result;
+    switch (op) {
+      case RoaringBitmapSliced32Operation::EQ: result = &eq; break;
+      case RoaringBitmapSliced32Operation::NEQ:
+        roaring_bitmap_or_inplace(lt, gt);
+        result = &lt;
+        break;
+      case RoaringBitmapSliced32Operation::LT: result = &lt; break;
+      case RoaringBitmapSliced32Operation::LE:
+        roaring_bitmap_or_inplace(lt, eq);
+        result = &lt;
+        break;
+      case RoaringBitmapSliced32Operation::GT: result = &gt; break;
+      default:
+        roaring_bitmap_or_inplace(gt, eq);
+        result = &gt;
+        break;
     }
+    roaring_bitmap_t * output = *result;
+    *result = nullptr;
+    roaring_bitmap_free(eq);
+    roaring_bitmap_free(lt);
+    roaring_bitmap_free(gt);
+    return output;
   }
 
-  if (info.Length() > 1 && !info[1]->IsUndefined()) {
-    if (!info[1]->IsNumber()) {
-      return false;
+  /** Computes the columns whose value is between min and max, inclusive. */
+  roaring_bitmap_t * between(uint32_t min, uint32_t max, const roaring_bitmap_t * filter) const {
+    if (min > max) {
+      return roaring_bitmap_create();
     }
-    if (!info[1]->NumberValue(isolate->GetCurrentContext()).To(&maximum)) {
-      maximum = 4294967296;
+    roaring_bitmap_t * ge = this->compare(RoaringBitmapSliced32Operation::GE, min, filter);
+    if (ge == nullptr) {
+      return nullptr;
     }
+    roaring_bitmap_t * result = this->compare(RoaringBitmapSliced32Operation::LE, max, ge);
+    roaring_bitmap_free(ge);
+    return result;
   }
 
-  if (std::isnan(minimum) || std::isnan(maximum) || minimum > 4294967295 || maximum <= 0) {
-    return false;
+  /** Sums the values of the columns in the filter, one intersection cardinality per slice. */
+  uint64_t sum(const roaring_bitmap_t * filter, uint64_t & count) const {
+    count = filter != nullptr ? roaring_bitmap_and_cardinality(this->existence, filter)
+                              : roaring_bitmap_get_cardinality(this->existence);
+    uint64_t result = 0;
+    for (uint32_t i = 0; i != this->bitDepth && count != 0; ++i) {
+      const uint64_t bits = filter != nullptr ? roaring_bitmap_and_cardinality(this->slices[i], filter)
+                                              : roaring_bitmap_get_cardinality(this->slices[i]);
+      result += bits << i;
+    }
+    return result;
   }
 
-  if (minimum < 0) {
-    minimum = 0;
+  /**
+   * Finds the minimum or the maximum value of the columns in the filter.
+   * Returns 0 if there are no columns, -1 if an allocation failed, 1 if found.
+   */
+  int extreme(bool maximum, const roaring_bitmap_t * filter, uint32_t & value) const {
+    roaring_bitmap_t * candidates = this->found(filter);
+    if (candidates == nullptr) {
+      return -1;
+    }
+    if (roaring_bitmap_is_empty(candidates)) {
+      roaring_bitmap_free(candidates);
+      return 0;
+    }
+    uint32_t result = 0;
+    for (uint32_t i = this->bitDepth; i-- != 0;) {
+      // Keeps the candidates with the bit set for the maximum, cleared for the minimum, if there are any.
+      roaring_bitmap_t * next =
+        maximum ? roaring_bitmap_and(candidates, this->slices[i]) : roaring_bitmap_andnot(candidates, this->slices[i]);
+      if (next == nullptr) {
+        roaring_bitmap_free(candidates);
+        return -1;
+      }
+      if (roaring_bitmap_is_empty(next)) {
+        roaring_bitmap_free(next);
+        if (!maximum) {
+          result |= (uint32_t)1 << i;
+        }
+      } else {
+        roaring_bitmap_free(candidates);
+        candidates = next;
+        if (maximum) {
+          result |= (uint32_t)1 << i;
+        }
+      }
+    }
+    roaring_bitmap_free(candidates);
+    value = result;
+    return 1;
   }
 
-  minimum = ceil(minimum);
-  maximum = ceil(maximum);
-
-  if (maximum > 4294967296) {
-    maximum = 4294967296;
+  /**
+   * Computes the k columns in the filter with the highest values.
+   * Columns with the same value are taken in ascending column order.
+   */
+  roaring_bitmap_t * topK(uint64_t k, const roaring_bitmap_t * filter) const {
+    roaring_bitmap_t * candidates = this->found(filter);
+    if (candidates == nullptr || roaring_bitmap_get_cardinality(candidates) <= k) {
+      return candidates;
+    }
+    roaring_bitmap_t * taken = roaring_bitmap_create();
+    if (taken == nullptr) {
+      roaring_bitmap_free(candidates);
+      return nullptr;
+    }
+    uint64_t takenCount = 0;
+    for (uint32_t i = this->bitDepth; i-- != 0 && takenCount < k;) {
+      // Candidates are the columns not taken yet, all with the same prefix of the highest values.
+      roaring_bitmap_t * high = roaring_bitmap_and(candidates, this->slices[i]);
+      const uint64_t highCount = roaring_bitmap_get_cardinality(high);
+      if (takenCount + highCount > k) {
+        roaring_bitmap_free(candidates);
+        candidates = high;
+      } else {
+        roaring_bitmap_or_inplace(taken, high);
+        roaring_bitmap_andnot_inplace(candidates, high);
+        roaring_bitmap_free(high);
+        takenCount += highCount;
+      }
+    }
+    if (takenCount < k) {
+      // All the remaining candidates have the same value, the ones with the lowest columns are taken.
+      uint32_t last;
+      if (roaring_bitmap_select(candidates, (uint32_t)(k - takenCount - 1), &last)) {
+        roaring_bitmap_remove_range_closed(candidates, last, UINT32_MAX);
+        roaring_bitmap_add(candidates, last);
+        roaring_bitmap_or_inplace(taken, candidates);
+      }
+    }
+    roaring_bitmap_free(candidates);
+    return taken;
   }
+};
 
-  minInteger = (uint64_t)minimum;
-  maxInteger = (uint64_t)maximum;
+static RoaringBitmapSliced32 * RoaringBitmapSliced32_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<RoaringBitmapSliced32>(info.This(), isolate);
+  if (self == nullptr || self->existence == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return nullptr;
+  }
+  return self;
+}
 
-  return minimum < 4294967296 && minInteger < maxInteger;
+/** Reads an optional RoaringBitmap32 filter argument. Returns false and throws if the argument is not valid. */
+static bool RoaringBitmapSliced32_getFilter(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, const roaring_bitmap_t *& filter) {
+  filter = nullptr;
+  if (info.Length() <= argumentIndex || info[argumentIndex]->IsNullOrUndefined()) {
+    return true;
+  }
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info[argumentIndex], info.GetIsolate());
+  if (bitmap == nullptr) {
+    v8utils::throwTypeError(info.GetIsolate(), "RoaringBitmapSliced32 - filter must be a RoaringBitmap32");
+    return false;
+  }
+  filter = bitmap->roaring;
+  return true;
 }
 
-void RoaringBitmap32_rangeCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  uint64_t minInteger, maxInteger;
-  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
-    RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-    if (!self) {
-      return info.GetReturnValue().Set(0u);
-    }
-    auto card = roaring_bitmap_range_cardinality(self->roaring, minInteger, maxInteger);
-    if (card <= 0xFFFFFFFF) {
-      return info.GetReturnValue().Set((uint32_t)card);
-    }
-    return info.GetReturnValue().Set((double)card);
+static bool RoaringBitmapSliced32_getUint32(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, uint32_t & value) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (info.Length() <= argumentIndex || !v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[argumentIndex], value)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapSliced32 - columns and values must be 32 bit unsigned integers");
+    return false;
   }
-  return info.GetReturnValue().Set(0u);
+  return true;
 }
 
-void RoaringBitmap32_flipRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  uint64_t minInteger, maxInteger;
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+/** Wraps a roaring_bitmap_t in a new RoaringBitmap32 and returns it. The bitmap is released on failure. */
+static void RoaringBitmapSliced32_returnBitmap(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmapSliced32 * self, roaring_bitmap_t * r) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32 - failed to allocate memory");
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    roaring_bitmap_free(r);
+    return;
   }
-  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
-    if (self != nullptr) {
-      roaring_bitmap_flip_inplace(self->roaring, minInteger, maxInteger);
-      self->invalidate();
-    }
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    roaring_bitmap_free(r);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
-  info.GetReturnValue().Set(info.This());
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_addRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  uint64_t minInteger, maxInteger;
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+void RoaringBitmapSliced32_set(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column, value;
+  if (
+    self == nullptr || !RoaringBitmapSliced32_getUint32(info, 0, column) ||
+    !RoaringBitmapSliced32_getUint32(info, 1, value)) {
+    return;
   }
-  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
-    if (self != nullptr) {
-      roaring_bitmap_add_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
-      self->invalidate();
-    }
+  if (!self->set(column, value)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapSliced32::set - failed to allocate memory");
   }
   info.GetReturnValue().Set(info.This());
 }
 
-void RoaringBitmap32_removeRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  uint64_t minInteger, maxInteger;
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+void RoaringBitmapSliced32_setMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self == nullptr) {
+    return;
   }
-  if (self->isFrozen()) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  v8utils::TypedArrayContent<uint32_t> columns;
+  v8utils::TypedArrayContent<uint32_t> values;
+  if (
+    info.Length() < 2 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) ||
+    !(info[1]->IsUint32Array() || info[1]->IsInt32Array()) || !columns.set(isolate, info[0]) ||
+    !values.set(isolate, info[1])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::setMany - columns and values must be Uint32Array");
   }
-  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
-    if (self != nullptr) {
-      roaring_bitmap_remove_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
-      self->invalidate();
-    }
+  if (columns.length != values.length) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::setMany - columns and values must have the same length");
+  }
+
+  // Grows once for the highest value, so the bulk contexts are valid for the whole loop.
+  uint32_t maxValue = 0;
+  for (size_t i = 0; i != values.length; ++i) {
+    maxValue |= values.data[i];
+  }
+  if (!self->grow(maxValue)) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::setMany - failed to allocate memory");
+  }
+  roaring_bulk_context_t contexts[RoaringBitmapSliced32::MAX_BIT_DEPTH] = {};
+  for (size_t i = 0; i != columns.length; ++i) {
+    self->set(columns.data[i], values.data[i], contexts);
   }
   info.GetReturnValue().Set(info.This());
 }
 
-void RoaringBitmap32_intersectsWithRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  uint64_t minInteger, maxInteger;
+void RoaringBitmapSliced32_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column, value;
+  if (self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+      info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) && self->get(column, value)) {
+    info.GetReturnValue().Set(value);
+  }
+}
+
+void RoaringBitmapSliced32_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column;
   info.GetReturnValue().Set(
-    self != nullptr && getRangeOperationParameters(info, minInteger, maxInteger) &&
-    roaring_bitmap_intersect_with_range(self->roaring, (uint64_t)minInteger, (uint64_t)(maxInteger - 1)));
+    self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+    info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) &&
+    roaring_bitmap_contains(self->existence, column));
 }
 
-void RoaringBitmap32_toUint32Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+void RoaringBitmapSliced32_delete(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+    info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) && self->remove(column));
+}
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+void RoaringBitmapSliced32_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
   }
+}
 
-  size_t size = self->getSize();
-  size_t maxSize = size;
-
-  v8utils::TypedArrayContent<uint32_t> typedArrayContent;
-  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
-    if (info[0]->IsNumber()) {
-      double maxSizeDouble;
-      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxSizeDouble) || std::isnan(maxSizeDouble)) {
-        return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - argument must be a valid integer number");
-      }
-      maxSize = maxSizeDouble <= 0 ? 0 : (maxSizeDouble >= size ? size : (size_t)maxSizeDouble);
-    } else {
-      if (!argumentIsValidUint32ArrayOutput(info[0]) || !typedArrayContent.set(isolate, info[0])) {
-        return v8utils::throwError(
-          isolate, "RoaringBitmap32::toUint32Array - argument must be a UInt32Array, Int32Array or ArrayBuffer");
-      }
+void RoaringBitmapSliced32_columns(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->found(filter));
+  }
+}
 
-      bool arrayIsSmaller = typedArrayContent.length < size;
-      if (arrayIsSmaller) {
-        roaring_bitmap_range_uint32_array(self->roaring, 0, typedArrayContent.length, typedArrayContent.data);
-        size = typedArrayContent.length;
-      }
+template <RoaringBitmapSliced32Operation OP>
+void RoaringBitmapSliced32_compare(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t value;
+  const roaring_bitmap_t * filter;
+  if (
+    self != nullptr && RoaringBitmapSliced32_getUint32(info, 0, value) &&
+    RoaringBitmapSliced32_getFilter(info, 1, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->compare(OP, value, filter));
+  }
+}
 
-      v8::Local<v8::Value> result;
-      if (!v8utils::v8ValueToUint32ArrayWithLimit(isolate, typedArrayContent.bufferPersistent.Get(isolate), size, result)) {
-        return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to create a new UInt32Array");
-      }
+void RoaringBitmapSliced32_between(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t min, max;
+  const roaring_bitmap_t * filter;
+  if (
+    self != nullptr && RoaringBitmapSliced32_getUint32(info, 0, min) && RoaringBitmapSliced32_getUint32(info, 1, max) &&
+    RoaringBitmapSliced32_getFilter(info, 2, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->between(min, max, filter));
+  }
+}
 
-      if (size != 0 && !arrayIsSmaller) {
-        roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
-      }
+void RoaringBitmapSliced32_sum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    uint64_t count;
+    info.GetReturnValue().Set((double)self->sum(filter, count));
+  }
+}
 
-      return info.GetReturnValue().Set(result);
+template <bool MAXIMUM>
+void RoaringBitmapSliced32_extreme(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    uint32_t value;
+    const int found = self->extreme(MAXIMUM, filter, value);
+    if (found < 0) {
+      return v8utils::throwError(info.GetIsolate(), "RoaringBitmapSliced32 - failed to allocate memory");
+    }
+    if (found > 0) {
+      info.GetReturnValue().Set(value);
     }
   }
+}
 
-  auto arrayBuffer = v8::ArrayBuffer::New(isolate, maxSize * sizeof(uint32_t));
-  if (arrayBuffer.IsEmpty()) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
+void RoaringBitmapSliced32_topK(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self == nullptr) {
+    return;
   }
-  auto typedArray = v8::Uint32Array::New(arrayBuffer, 0, maxSize);
-  if (typedArray.IsEmpty()) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
+  double k;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&k) || !(k >= 0)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::topK - k must be a non negative number");
   }
+  const roaring_bitmap_t * filter;
+  if (RoaringBitmapSliced32_getFilter(info, 1, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->topK(k < 4294967296.0 ? (uint64_t)k : 4294967296ULL, filter));
+  }
+}
 
-  if (maxSize != 0) {
-    if (!typedArrayContent.set(isolate, typedArray)) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::toUint32Array - failed to allocate memory");
-    }
-    if (maxSize < size) {
-      roaring_bitmap_range_uint32_array(self->roaring, 0, maxSize, typedArrayContent.data);
-    } else {
-      roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
+void RoaringBitmapSliced32_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<const RoaringBitmapSliced32>(info.This(), info.GetIsolate());
+  const uint64_t size = self != nullptr && self->existence != nullptr ? roaring_bitmap_get_cardinality(self->existence) : 0;
+  return size <= 0xFFFFFFFF ? info.GetReturnValue().Set((uint32_t)size) : info.GetReturnValue().Set((double)size);
+}
+
+void RoaringBitmapSliced32_bitDepth_getter(
+  v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<const RoaringBitmapSliced32>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? self->bitDepth : 0U);
+}
+
+void RoaringBitmapSliced32_WeakCallback(v8::WeakCallbackInfo<RoaringBitmapSliced32> const & info) {
+  RoaringBitmapSliced32 * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmapSliced32();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmapSliced32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmapSliced32));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmapSliced32(addonData) : nullptr;
+  if (instance == nullptr || instance->existence == nullptr) {
+    if (instance != nullptr) {
+      instance->~RoaringBitmapSliced32();
+      bare_aligned_free(instance);
     }
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::ctor - allocation failed");
   }
 
-  info.GetReturnValue().Set(typedArray);
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmapSliced32::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmapSliced32_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  info.GetReturnValue().Set(holder);
 }
 
-void RoaringBitmap32_toUint32ArrayAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  ToUint32ArrayAsyncWorker * worker = new ToUint32ArrayAsyncWorker(info, nullptr);
-  if (!worker) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::toUint32ArrayAsync - allocation failed");
+void RoaringBitmapSliced32_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmapSliced32", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmapSliced32_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "bitDepth", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_bitDepth_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "bitDepth", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_bitDepth_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "between", RoaringBitmapSliced32_between);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmapSliced32_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "columns", RoaringBitmapSliced32_columns);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmapSliced32_delete);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "equal", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::EQ>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmapSliced32_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "greaterThan", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::GT>);
+  NODE_SET_PROTOTYPE_METHOD(
+    ctor, "greaterThanOrEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::GE>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmapSliced32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "lessThan", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::LT>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "lessThanOrEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::LE>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "max", RoaringBitmapSliced32_extreme<true>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "min", RoaringBitmapSliced32_extreme<false>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "notEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::NEQ>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "set", RoaringBitmapSliced32_set);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "setMany", RoaringBitmapSliced32_setMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "sum", RoaringBitmapSliced32_sum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "topK", RoaringBitmapSliced32_topK);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmapSliced32");
   }
-  info.GetReturnValue().Set(AsyncWorker::run(worker));
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
 }
 
-void RoaringBitmap32_rangeUint32Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+#endif  // ROARING_NODE_ROARING_BITMAP_SLICED_32_
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
+#line 1 "src/cpp/RoaringBitmap64-main.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_64_MAIN_
+#define ROARING_NODE_ROARING_BITMAP_64_MAIN_
 
-  double num;
+#line 1 "src/cpp/RoaringBitmap64.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_64_
+#define ROARING_NODE_ROARING_BITMAP_64_
 
-  int outputArgIndex = -1;
-  int offsetArgIndex = -1;
-  int limitArgIndex = -1;
+#line 5 "src/cpp/RoaringBitmap64.h"
 
-  if (info[0]->IsNumber()) {
-    offsetArgIndex = 0;
+/** One 32 bit roaring bitmap holding all the values of a RoaringBitmap64 that share the same high 32 bits. */
+struct RoaringBitmap64Bucket {
+  uint32_t high;
+  roaring_bitmap_t * bitmap;
+};
 
-    if (info.Length() > 1) {
-      if (info[1]->IsNumber()) {
-        limitArgIndex = 1;
-        if (info.Length() > 2 && !info[2]->IsUndefined()) {
-          outputArgIndex = 2;
-        }
-      } else {
-        outputArgIndex = 1;
-      }
-    }
-  } else {
-    outputArgIndex = 0;
-    if (info.Length() > 1) {
-      offsetArgIndex = 1;
-      if (info.Length() > 2 && !info[2]->IsUndefined()) {
-        limitArgIndex = 2;
-      }
-    }
+/**
+ * Sorted array of buckets, keyed by the high 32 bits of the values.
+ * This is the same two level layout used by the portable 64 bit roaring format,
+ * so serialization and deserialization are a straight walk of the buckets.
+ */
+class RoaringBitmap64Buckets final {
+ public:
+  RoaringBitmap64Bucket * items;
+  uint32_t count;
+  uint32_t capacity;
+
+  inline RoaringBitmap64Buckets() : items(nullptr), count(0), capacity(0) {}
+
+  RoaringBitmap64Buckets(const RoaringBitmap64Buckets &) = delete;
+  RoaringBitmap64Buckets & operator=(const RoaringBitmap64Buckets &) = delete;
+
+  inline ~RoaringBitmap64Buckets() {
+    this->clear();
+    gcaware_free(this->items);
   }
 
-  size_t offset = 0;
-  if (offsetArgIndex == -1) {
-    if (outputArgIndex == -1) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - offset or output argument is missing");
+  inline void clear() {
+    for (uint32_t i = 0; i < this->count; ++i) {
+      roaring_bitmap_free(this->items[i].bitmap);
     }
-  } else {
-    if (!info[offsetArgIndex]->NumberValue(isolate->GetCurrentContext()).To(&num) || std::isnan(num)) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - limit argument must be a valid integer");
-    }
-    offset = (size_t)std::min(std::max(num, 0.0), 4294967296.0);
+    this->count = 0;
   }
 
-  if (limitArgIndex == -1 && outputArgIndex == -1) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - missing limit or output argument");
+  inline void swap(RoaringBitmap64Buckets & other) {
+    std::swap(this->items, other.items);
+    std::swap(this->count, other.count);
+    std::swap(this->capacity, other.capacity);
   }
 
-  size_t limit = 4294967296;
-  if (limitArgIndex != -1) {
-    if (!info[limitArgIndex]->NumberValue(isolate->GetCurrentContext()).To(&num) || std::isnan(num)) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - limit argument must be a valid integer");
+  bool reserve(uint32_t newCapacity) {
+    if (newCapacity <= this->capacity) {
+      return true;
     }
-    limit = (size_t)std::min(std::max(num, 0.0), 4294967296.0);
+    auto * newItems = (RoaringBitmap64Bucket *)gcaware_realloc(this->items, (size_t)newCapacity * sizeof(RoaringBitmap64Bucket));
+    if (newItems == nullptr) {
+      return false;
+    }
+    this->items = newItems;
+    this->capacity = newCapacity;
+    return true;
   }
 
-  v8utils::TypedArrayContent<uint32_t> typedArrayContent;
-
-  if (outputArgIndex != -1) {
-    if (!argumentIsValidUint32ArrayOutput(info[outputArgIndex]) || !typedArrayContent.set(isolate, info[outputArgIndex])) {
-      return v8utils::throwError(
-        isolate, "RoaringBitmap32::rangeUint32Array - output argument must be a UInt32Array, Int32Array or ArrayBuffer");
+  /** Index of the first bucket with high >= the given high. */
+  inline uint32_t lowerBound(uint32_t high) const {
+    uint32_t lo = 0, hi = this->count;
+    // Appending in order is the common case, check the last bucket first.
+    if (hi != 0 && this->items[hi - 1].high < high) {
+      return hi;
     }
-    limit = std::min(limit, typedArrayContent.length);
+    while (lo < hi) {
+      uint32_t mid = (lo + hi) >> 1;
+      if (this->items[mid].high < high) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
   }
 
-  size_t size;
-  auto cardinality = self->getSize();
-  if (offset > cardinality) {
-    size = 0;
-  } else {
-    size = limit < cardinality - offset ? limit : cardinality - offset;
-    if (offset > cardinality) {
-      size = 0;
+  inline roaring_bitmap_t * get(uint32_t high) const {
+    uint32_t index = this->lowerBound(high);
+    return index < this->count && this->items[index].high == high ? this->items[index].bitmap : nullptr;
+  }
+
+  /** Inserts the given bitmap at the given position. Takes ownership of the bitmap, also on failure. */
+  bool insertAt(uint32_t index, uint32_t high, roaring_bitmap_t * bitmap) {
+    if (bitmap == nullptr) {
+      return false;
     }
-    if (limit > cardinality - offset) {
-      limit = cardinality - offset;
+    if (this->count == this->capacity && !this->reserve(this->capacity < 4 ? 4 : this->capacity * 2)) {
+      roaring_bitmap_free(bitmap);
+      return false;
+    }
+    if (index < this->count) {
+      memmove(this->items + index + 1, this->items + index, (this->count - index) * sizeof(RoaringBitmap64Bucket));
     }
+    this->items[index].high = high;
+    this->items[index].bitmap = bitmap;
+    ++this->count;
+    return true;
   }
 
-  if (outputArgIndex == -1) {
-    auto arrayBuffer = v8::ArrayBuffer::New(isolate, size * sizeof(uint32_t));
-    if (arrayBuffer.IsEmpty()) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an ArrayBuffer");
+  /** Appends a bucket, the high must be greater than the high of the last bucket. */
+  inline bool append(uint32_t high, roaring_bitmap_t * bitmap) { return this->insertAt(this->count, high, bitmap); }
+
+  roaring_bitmap_t * getOrCreate(uint32_t high) {
+    uint32_t index = this->lowerBound(high);
+    if (index < this->count && this->items[index].high == high) {
+      return this->items[index].bitmap;
     }
-    auto typedArray = v8::Uint32Array::New(arrayBuffer, 0, size);
-    if (typedArray.IsEmpty()) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an Uint32Array");
+    if (!this->insertAt(index, high, roaring_bitmap_create())) {
+      return nullptr;
     }
-    if (!typedArrayContent.set(isolate, typedArray)) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to create an Uint32Array");
+    return this->items[index].bitmap;
+  }
+
+  void removeAt(uint32_t index) {
+    roaring_bitmap_free(this->items[index].bitmap);
+    --this->count;
+    if (index < this->count) {
+      memmove(this->items + index, this->items + index + 1, (this->count - index) * sizeof(RoaringBitmap64Bucket));
     }
   }
 
-  if (size > 0) {
-    if (offset == 0 && limit == cardinality) {
-      roaring_bitmap_to_uint32_array(self->roaring, typedArrayContent.data);
-    } else {
-      if (!roaring_bitmap_range_uint32_array(self->roaring, offset, limit, typedArrayContent.data)) {
-        return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32Array - failed to build the range");
+  /** Removes all the buckets that became empty. */
+  void compact() {
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < this->count; ++i) {
+      if (roaring_bitmap_is_empty(this->items[i].bitmap)) {
+        roaring_bitmap_free(this->items[i].bitmap);
+      } else {
+        this->items[j++] = this->items[i];
       }
     }
+    this->count = j;
   }
 
-  v8::Local<v8::Value> result;
-  if (!v8utils::v8ValueToUint32ArrayWithLimit(isolate, typedArrayContent.bufferPersistent.Get(isolate), size, result)) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::rangeUint32ArrayAsync - failed to create an Uint32Array range");
+  uint64_t cardinality() const {
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < this->count; ++i) {
+      result += roaring_bitmap_get_cardinality(this->items[i].bitmap);
+    }
+    return result;
   }
-  info.GetReturnValue().Set(result);
-}
-
-void RoaringBitmap32_toArray(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  size_t cardinality = self ? self->getSize() : 0;
-
-  struct iter_data {
-    uint32_t index;
-    uint32_t count;
-    double maxLength;
-    v8::Isolate * isolate;
-    v8::Local<v8::Context> context;
-    v8::Local<v8::Array> jsArray;
-  } iterData;
 
-  iterData.index = 0;
-  iterData.count = 0;
-  iterData.isolate = isolate;
-  iterData.context = isolate->GetCurrentContext();
+  bool copyFrom(const RoaringBitmap64Buckets & other) {
+    this->clear();
+    if (!this->reserve(other.count)) {
+      return false;
+    }
+    for (uint32_t i = 0; i < other.count; ++i) {
+      if (!this->append(other.items[i].high, roaring_bitmap_copy(other.items[i].bitmap))) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
 
-  double maxLength = (double)cardinality;
+enum class RoaringBitmap64Operation { AND, OR, XOR, ANDNOT };
 
-  // Check if the first argument is an array
-  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
-    if (info[0]->IsNumber()) {
-      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxLength)) {
-        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - maxLength argument must be a valid number");
+/**
+ * Computes a op b into result, walking the two sorted bucket arrays in lockstep.
+ * If inPlace is true, a is consumed: its buckets are moved into the result and modified in place.
+ */
+bool roaring64BucketsOperation(
+  RoaringBitmap64Operation op, RoaringBitmap64Buckets & a, const RoaringBitmap64Buckets & b, RoaringBitmap64Buckets & result, bool inPlace) {
+  result.clear();
+  if (!result.reserve(op == RoaringBitmap64Operation::AND ? std::min(a.count, b.count) : a.count + b.count)) {
+    return false;
+  }
+  const bool keepA = op != RoaringBitmap64Operation::AND;
+  const bool keepB = op == RoaringBitmap64Operation::OR || op == RoaringBitmap64Operation::XOR;
+  uint32_t i = 0, j = 0;
+  bool ok = true;
+  while (ok && (i < a.count || j < b.count)) {
+    if (j >= b.count || (i < a.count && a.items[i].high < b.items[j].high)) {
+      RoaringBitmap64Bucket & bucket = a.items[i++];
+      if (keepA) {
+        ok = result.append(bucket.high, inPlace ? bucket.bitmap : roaring_bitmap_copy(bucket.bitmap));
+        if (inPlace) {
+          bucket.bitmap = nullptr;
+        }
       }
-      if (maxLength > cardinality) {
-        maxLength = (double)cardinality;
+    } else if (i >= a.count || b.items[j].high < a.items[i].high) {
+      const RoaringBitmap64Bucket & bucket = b.items[j++];
+      if (keepB) {
+        ok = result.append(bucket.high, roaring_bitmap_copy(bucket.bitmap));
       }
-      iterData.jsArray = v8::Array::New(isolate, (uint32_t)maxLength);
     } else {
-      v8::Local<v8::Object> obj;
-      if (!info[0]->ToObject(isolate->GetCurrentContext()).ToLocal(&obj) || !obj->IsArray()) {
-        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - argument must be an array");
-      }
-      iterData.jsArray = v8::Local<v8::Array>::Cast(obj);
-
-      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
-        if (
-          !info[1]->IsNumber() || !info[1]->NumberValue(isolate->GetCurrentContext()).To(&maxLength) ||
-          std::isnan(maxLength)) {
-          return v8utils::throwTypeError(
-            isolate, "RoaringBitmap32::toArray - maxLength must be zero or a valid uint32 value");
-        }
-        if (maxLength > cardinality) {
-          maxLength = (double)cardinality;
+      RoaringBitmap64Bucket & x = a.items[i++];
+      const roaring_bitmap_t * y = b.items[j++].bitmap;
+      roaring_bitmap_t * r;
+      if (inPlace) {
+        switch (op) {
+          case RoaringBitmap64Operation::AND: roaring_bitmap_and_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::OR: roaring_bitmap_or_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::XOR: roaring_bitmap_xor_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::ANDNOT: roaring_bitmap_andnot_inplace(x.bitmap, y); break;
+        }
+        r = x.bitmap;
+        x.bitmap = nullptr;
+      } else {
+        switch (op) {
+          case RoaringBitmap64Operation::AND: r = roaring_bitmap_and(x.bitmap, y); break;
+          case RoaringBitmap64Operation::OR: r = roaring_bitmap_or(x.bitmap, y); break;
+          case RoaringBitmap64Operation::XOR: r = roaring_bitmap_xor(x.bitmap, y); break;
+          default: r = roaring_bitmap_andnot(x.bitmap, y); break;
         }
       }
-
-      int64_t offset = 0;
-      if (info.Length() >= 3 && !info[2]->IsUndefined()) {
-        if (
-          !info[2]->IsNumber() || !info[2]->IntegerValue(isolate->GetCurrentContext()).To(&offset) || offset < 0 ||
-          offset > 4294967295) {
-          return v8utils::throwTypeError(isolate, "RoaringBitmap32::toArray - offset must be zero or a valid uint32 value");
-        }
-        iterData.index = (uint32_t)offset;
+      if (r != nullptr && roaring_bitmap_is_empty(r)) {
+        roaring_bitmap_free(r);
       } else {
-        iterData.index = iterData.jsArray->Length();
+        ok = result.append(x.high, r);
       }
     }
-  } else {
-    iterData.jsArray = v8::Array::New(isolate, cardinality);
   }
-
-  iterData.maxLength = maxLength;
-
-  info.GetReturnValue().Set(iterData.jsArray);
-
-  if (cardinality != 0) {
-    roaring_iterate(
-      self->roaring,
-      [](uint32_t value, void * vp) -> bool {
-        auto * p = reinterpret_cast<iter_data *>(vp);
-        bool r = false;
-        return (p->count++) < p->maxLength &&
-          p->jsArray->Set(p->context, p->index++, v8::Uint32::NewFromUnsigned(p->isolate, value)).To(&r) && r;
-      },
-      (void *)&iterData);
+  if (inPlace) {
+    // Buckets not moved into the result are released when a is cleared.
+    uint32_t k = 0;
+    for (uint32_t n = 0; n < a.count; ++n) {
+      if (a.items[n].bitmap != nullptr) {
+        a.items[k++] = a.items[n];
+      }
+    }
+    a.count = k;
+    a.clear();
   }
+  return ok;
 }
 
-void RoaringBitmap32_toReversed(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  v8::Local<v8::Context> context = isolate->GetCurrentContext();
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  const size_t cardinality = self ? self->getSize() : 0;
+/**
+ * The maximum number of 32 bit buckets a range operation that creates buckets (addRange, flipRange) can touch.
+ * A range over the whole 64 bit space would otherwise allocate 2^32 bitmaps.
+ */
+static const constexpr uint64_t ROARING64_MAX_RANGE_BUCKETS = 65536;
 
-  const size_t maxJsLength = 0xFFFFFFFFull;
-  size_t limit = cardinality;
-  size_t skip = 0;
-  uint32_t writeIndex = 0;
-  bool arrayProvided = false;
-  v8::Local<v8::Array> jsArray;
+/** The number of 32 bit buckets touched by the inclusive range [minimum, maximum]. */
+inline uint64_t roaring64RangeBucketsCount(uint64_t minimum, uint64_t maximum) {
+  return minimum > maximum ? 0 : (maximum >> 32) - (minimum >> 32) + 1;
+}
 
-  auto clampSize = [&](v8::Local<v8::Value> value, size_t maxValue) -> size_t {
-    if (value.IsEmpty() || value->IsUndefined() || value->IsNull()) {
-      return 0;
-    }
-    double d;
-    if (!value->NumberValue(context).To(&d) || std::isnan(d)) {
-      return 0;
-    }
-    if (d <= 0) {
-      return 0;
-    }
-    double limitDouble = static_cast<double>(maxValue);
-    if (d >= limitDouble) {
-      return maxValue;
+/** Calls fn(high, lowMin, lowMax) for every 32 bit bucket touched by the inclusive range [minimum, maximum]. */
+template <typename F>
+inline void roaring64ForEachRangeBucket(uint64_t minimum, uint64_t maximum, F fn) {
+  const uint32_t highMin = (uint32_t)(minimum >> 32);
+  const uint32_t highMax = (uint32_t)(maximum >> 32);
+  for (uint64_t high = highMin; high <= highMax; ++high) {
+    const uint32_t lowMin = high == highMin ? (uint32_t)minimum : 0;
+    const uint32_t lowMax = high == highMax ? (uint32_t)maximum : UINT32_MAX;
+    if (!fn((uint32_t)high, lowMin, lowMax)) {
+      break;
     }
-    return static_cast<size_t>(d);
-  };
+  }
+}
 
-  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
-    if (info[0]->IsNumber()) {
-      limit = clampSize(info[0], cardinality);
-      if (limit > maxJsLength) {
-        limit = maxJsLength;
-      }
-      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
-        skip = clampSize(info[1], cardinality);
-      }
-    } else {
-      v8::Local<v8::Object> obj;
-      if (!info[0]->ToObject(context).ToLocal(&obj) || !obj->IsArray()) {
-        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toReversed - argument must be an array");
-      }
-      jsArray = v8::Local<v8::Array>::Cast(obj);
-      arrayProvided = true;
+class RoaringBitmap64 final : public ObjectWrap {
+ public:
+  static const constexpr uint64_t OBJECT_TOKEN = 0x21524F4152360000;
 
-      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
-        limit = clampSize(info[1], cardinality);
-        if (limit > maxJsLength) {
-          limit = maxJsLength;
-        }
-      }
+  RoaringBitmap64Buckets buckets;
+  int64_t sizeCache;
+  int64_t _version;
+  int64_t frozenCounter;
+  v8::Global<v8::Object> persistent;
+  v8utils::TypedArrayContent<uint8_t> frozenStorage;
 
-      if (info.Length() >= 3 && !info[2]->IsUndefined()) {
-        size_t offset = clampSize(info[2], maxJsLength);
-        writeIndex = static_cast<uint32_t>(offset);
-      } else {
-        writeIndex = jsArray->Length();
-      }
+  inline bool isEmpty() const { return this->buckets.count == 0; }
 
-      if (info.Length() >= 4 && !info[3]->IsUndefined()) {
-        skip = clampSize(info[3], cardinality);
-      }
+  inline uint64_t getSize() const {
+    int64_t size = this->sizeCache;
+    if (size < 0) {
+      size = (int64_t)this->buckets.cardinality();
+      const_cast<RoaringBitmap64 *>(this)->sizeCache = size;
     }
+    return (uint64_t)size;
   }
 
-  if (limit > maxJsLength) {
-    limit = maxJsLength;
+  inline bool isFrozen() const { return this->frozenCounter != 0; }
+  inline bool isFrozenHard() const {
+    return this->frozenCounter > 0 || this->frozenCounter == RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
   }
 
-  size_t writeCapacity = maxJsLength - writeIndex;
-  if (limit > writeCapacity) {
-    limit = writeCapacity;
-  }
+  inline int64_t getVersion() const { return this->_version; }
 
-  size_t available = cardinality > skip ? cardinality - skip : 0;
-  if (limit > available) {
-    limit = available;
+  inline void invalidate() {
+    this->sizeCache = -1;
+    ++this->_version;
   }
 
-  if (!arrayProvided) {
-    jsArray = v8::Array::New(isolate, static_cast<uint32_t>(limit));
+  inline bool contains(uint64_t value) const {
+    const roaring_bitmap_t * r = this->buckets.get((uint32_t)(value >> 32));
+    return r != nullptr && roaring_bitmap_contains(r, (uint32_t)value);
   }
 
-  info.GetReturnValue().Set(jsArray);
-
-  if (self == nullptr || jsArray.IsEmpty() || limit == 0) {
-    return;
+  inline bool addChecked(uint64_t value) {
+    roaring_bitmap_t * r = this->buckets.getOrCreate((uint32_t)(value >> 32));
+    return r != nullptr && roaring_bitmap_add_checked(r, (uint32_t)value);
   }
 
-  size_t startOffset = cardinality - skip - limit;
-  constexpr size_t kChunkSize = 1024;
-  uint32_t buffer[kChunkSize];
-  size_t processed = 0;
-
-  while (processed < limit) {
-    size_t chunk = limit - processed;
-    if (chunk > kChunkSize) {
-      chunk = kChunkSize;
+  inline bool removeChecked(uint64_t value) {
+    const uint32_t high = (uint32_t)(value >> 32);
+    const uint32_t index = this->buckets.lowerBound(high);
+    if (index >= this->buckets.count || this->buckets.items[index].high != high) {
+      return false;
     }
-    if (!roaring_bitmap_range_uint32_array(self->roaring, startOffset + processed, chunk, buffer)) {
-      return v8utils::throwError(isolate, "RoaringBitmap32::toReversed - failed to build the range");
+    roaring_bitmap_t * r = this->buckets.items[index].bitmap;
+    if (!roaring_bitmap_remove_checked(r, (uint32_t)value)) {
+      return false;
     }
-    for (size_t i = 0; i < chunk; ++i) {
-      bool ok = false;
-      uint32_t targetIndex = writeIndex + static_cast<uint32_t>(limit - 1 - (processed + i));
-      if (!jsArray->Set(context, targetIndex, v8::Uint32::NewFromUnsigned(isolate, buffer[i])).To(&ok) || !ok) {
-        return;
-      }
+    if (roaring_bitmap_is_empty(r)) {
+      this->buckets.removeAt(index);
     }
-    processed += chunk;
+    return true;
   }
-}
 
-void RoaringBitmap32_toSet(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  explicit RoaringBitmap64(AddonData * addonData) :
+    ObjectWrap(addonData), sizeCache(0), _version(0), frozenCounter(0) {
+    ++addonData->RoaringBitmap64_instances;
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap64));
   }
 
-  struct iter_data {
-    uint64_t count;
-    double maxLength;
-    v8::Isolate * isolate;
-    v8::Local<v8::Context> context;
-    v8::Local<v8::Set> jsSet;
-  } iterData;
+  ~RoaringBitmap64() {
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap64));
+    --this->addonData->RoaringBitmap64_instances;
+    // Frozen views reference frozenStorage, release them before the storage goes away.
+    this->buckets.clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+    }
+  }
+};
 
-  iterData.count = 0;
-  iterData.maxLength = std::numeric_limits<double>::infinity();
-  iterData.isolate = isolate;
-  iterData.context = isolate->GetCurrentContext();
+#endif  // ROARING_NODE_ROARING_BITMAP_64_
 
-  if (info.Length() >= 1 && !info[0]->IsUndefined()) {
-    if (info[0]->IsNumber()) {
-      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&iterData.maxLength)) {
-        return v8utils::throwTypeError(isolate, "RoaringBitmap32::toSet - maxLength argument must be a valid number");
-      }
-      iterData.jsSet = v8::Set::New(isolate);
-    } else {
-      v8::Local<v8::Object> obj;
-      if (!info[0]->ToObject(isolate->GetCurrentContext()).ToLocal(&obj) || !obj->IsSet()) {
-        return v8utils::throwError(isolate, "RoaringBitmap32::toSet - argument must be a Set");
-      }
+#line 5 "src/cpp/RoaringBitmap64-main.h"
 
-      iterData.jsSet = v8::Local<v8::Set>::Cast(obj);
+/** Adds values one by one, reusing the roaring bulk context while consecutive values share the same high 32 bits. */
+class RoaringBitmap64BulkAdder final {
+ public:
+  RoaringBitmap64Buckets & buckets;
+  roaring_bitmap_t * bitmap;
+  uint32_t high;
+  roaring_bulk_context_t context;
 
-      if (info.Length() >= 2 && !info[1]->IsUndefined()) {
-        if (!info[1]->IsNumber() || !info[1]->NumberValue(isolate->GetCurrentContext()).To(&iterData.maxLength)) {
-          return v8utils::throwTypeError(isolate, "RoaringBitmap32::toSet - maxLength argument must be a valid number");
-        }
+  explicit RoaringBitmap64BulkAdder(RoaringBitmap64Buckets & buckets) : buckets(buckets), bitmap(nullptr), high(0), context() {}
+
+  inline bool add(uint64_t value) {
+    const uint32_t h = (uint32_t)(value >> 32);
+    if (this->bitmap == nullptr || h != this->high) {
+      this->bitmap = this->buckets.getOrCreate(h);
+      if (this->bitmap == nullptr) {
+        return false;
       }
+      this->high = h;
+      this->context = roaring_bulk_context_t();
     }
-  } else {
-    iterData.jsSet = v8::Set::New(isolate);
+    roaring_bitmap_add_bulk(this->bitmap, &this->context, (uint32_t)value);
+    return true;
   }
+};
 
-  if (std::isnan(iterData.maxLength)) {
-    iterData.maxLength = std::numeric_limits<double>::infinity();
+bool roaring64AddUint64Array(RoaringBitmap64Buckets & buckets, const uint64_t * values, size_t length) {
+  RoaringBitmap64BulkAdder adder(buckets);
+  for (size_t i = 0; i < length; ++i) {
+    if (!adder.add(values[i])) {
+      return false;
+    }
   }
+  return true;
+}
 
-  info.GetReturnValue().Set(iterData.jsSet);
+void roaring64RemoveUint64Array(RoaringBitmap64Buckets & buckets, const uint64_t * values, size_t length) {
+  roaring_bitmap_t * bitmap = nullptr;
+  uint32_t high = 0;
+  for (size_t i = 0; i < length; ++i) {
+    const uint64_t value = values[i];
+    const uint32_t h = (uint32_t)(value >> 32);
+    if (bitmap == nullptr || h != high) {
+      bitmap = buckets.get(h);
+      high = h;
+      if (bitmap == nullptr) {
+        continue;
+      }
+    }
+    roaring_bitmap_remove(bitmap, (uint32_t)value);
+  }
+  buckets.compact();
+}
 
-  if (self != nullptr && !self->isEmpty()) {
-    roaring_iterate(
-      self->roaring,
-      [](uint32_t value, void * vp) -> bool {
-        auto * p = reinterpret_cast<iter_data *>(vp);
-        return p->count++ < p->maxLength &&
-          !p->jsSet->Add(p->context, v8::Uint32::NewFromUnsigned(p->isolate, value)).IsEmpty();
-      },
-      (void *)&iterData);
+/**
+ * Returns true if value is a BigInt outside the uint64 range, throwing a RangeError.
+ * Other invalid values are left to the caller.
+ */
+inline bool roaring64ThrowIfBigIntOutOfRange(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+  if (value.IsEmpty() || !value->IsBigInt()) {
+    return false;
+  }
+  bool lossless = false;
+  value.As<v8::BigInt>()->Uint64Value(&lossless);
+  if (lossless) {
+    return false;
   }
+  v8utils::throwRangeError(isolate, ERROR_UINT64_RANGE);
+  return true;
 }
 
-void RoaringBitmap32_hasRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return info.GetReturnValue().Set(false);
+/**
+ * Converts a JS array or iterable of numbers and bigints.
+ * Returns false if the conversion failed, or if any of the values is not a valid uint64; a BigInt outside the uint64
+ * range throws a RangeError.
+ */
+template <typename F>
+bool roaring64ForEachArrayValue(v8::Isolate * isolate, AddonData * addonData, v8::Local<v8::Value> arg, F fn) {
+  auto context = isolate->GetCurrentContext();
+  v8::Local<v8::Value> arrayValue = arg;
+  if (!arg->IsArray()) {
+    v8::Local<v8::Value> argv[] = {arg};
+    if (!addonData->Array_from.Get(isolate)->Call(context, v8::Undefined(isolate), 1, argv).ToLocal(&arrayValue)) {
+      return false;
+    }
+    if (!arrayValue->IsArray()) {
+      return false;
+    }
   }
+  v8::Local<v8::Array> array = arrayValue.As<v8::Array>();
+  const uint32_t length = array->Length();
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < length; ++i) {
+    v8::Local<v8::Value> item;
+    if (!array->Get(context, i).ToLocal(&item)) {
+      return false;
+    }
+    if (!v8utils::v8ValueToUint64Fast(context, item, v)) {
+      roaring64ThrowIfBigIntOutOfRange(isolate, item);
+      return false;
+    }
+    if (!fn(v)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+/**
+ * Adds the values of a JS array, an iterable, a typed array or a bitmap.
+ * Returns false if the argument is not valid; allocation failures and out of range BigInts also throw.
+ */
+inline bool roaring64AddMany(v8::Isolate * isolate, RoaringBitmap64 * self, v8::Local<v8::Value> arg, bool replace = false) {
+  if (self->isFrozen()) {
+    v8utils::throwError(isolate, ERROR_FROZEN);
+    return false;
+  }
 
-  double minimum, maximum;
-  if (
-    info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber() || !info[0]->NumberValue(context).To(&minimum) ||
-    !info[1]->NumberValue(context).To(&maximum)) {
-    return info.GetReturnValue().Set(false);
+  if (arg.IsEmpty()) {
+    return false;
   }
 
-  if (std::isnan(minimum) || std::isnan(maximum)) {
-    return info.GetReturnValue().Set(false);
+  if (arg->IsNullOrUndefined()) {
+    if (replace) {
+      self->buckets.clear();
+      self->invalidate();
+    }
+    return true;
   }
 
-  minimum = ceil(minimum);
-  maximum = ceil(maximum);
-  if (minimum < 0 || maximum > 4294967296) {
-    return info.GetReturnValue().Set(false);
+  if (!arg->IsObject()) {
+    return false;
   }
 
-  uint64_t minInteger = (uint64_t)minimum;
-  uint64_t maxInteger = (uint64_t)maximum;
+  RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(arg, isolate);
+  if (other != nullptr) {
+    if (self != other) {
+      bool copied;
+      if (replace || self->isEmpty()) {
+        copied = self->buckets.copyFrom(other->buckets);
+      } else {
+        RoaringBitmap64Buckets result;
+        copied = roaring64BucketsOperation(RoaringBitmap64Operation::OR, self->buckets, other->buckets, result, true);
+        self->buckets.swap(result);
+      }
+      self->invalidate();
+      if (!copied) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+    }
+    return true;
+  }
 
-  if (minInteger >= maxInteger || maxInteger > 4294967296) {
-    return info.GetReturnValue().Set(false);
+  if (replace) {
+    self->buckets.clear();
   }
+  self->invalidate();
 
-  info.GetReturnValue().Set(roaring_bitmap_contains_range(self->roaring, minInteger, maxInteger));
-}
+  if (arg->IsBigUint64Array() || arg->IsBigInt64Array()) {
+    const v8utils::TypedArrayContent<uint64_t> typedArray(isolate, arg);
+    if (!roaring64AddUint64Array(self->buckets, typedArray.data, typedArray.length)) {
+      v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+      return false;
+    }
+    return true;
+  }
 
-void RoaringBitmap32_fromRangeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+  if (arg->IsUint32Array() || arg->IsInt32Array()) {
+    const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
+    if (typedArray.length != 0) {
+      roaring_bitmap_t * bitmap = self->buckets.getOrCreate(0);
+      if (bitmap == nullptr) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+      roaring_bitmap_add_many(bitmap, typedArray.length, typedArray.data);
+    }
+    return true;
+  }
 
-  AddonData * addonData = AddonData::get(info);
-  if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  RoaringBitmap32 * other32 = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+  if (other32 != nullptr) {
+    if (!other32->isEmpty()) {
+      roaring_bitmap_t * bitmap = self->buckets.getOrCreate(0);
+      if (bitmap == nullptr) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+      roaring_bitmap_or_inplace(bitmap, other32->roaring);
+    }
+    return true;
   }
 
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  RoaringBitmap64BulkAdder adder(self->buckets);
+  return roaring64ForEachArrayValue(isolate, self->addonData, arg, [isolate, &adder](uint64_t v) {
+    if (!adder.add(v)) {
+      v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+      return false;
+    }
+    return true;
+  });
+}
 
-  auto resultMaybe = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
-  v8::Local<v8::Object> result;
-  if (!resultMaybe.ToLocal(&result)) return;
+/** Parses the [rangeStart, rangeEnd) arguments. rangeEnd can be up to 2^64. Returns false if the range is empty. */
+inline bool getRange64OperationParameters(
+  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & minimum, uint64_t & maximumInclusive) {
+  minimum = 0;
+  maximumInclusive = UINT64_MAX;
 
-  uint32_t v;
-  uint32_t step = 1;
-  if (info.Length() >= 3 && info[2]->IsNumber() && info[2]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    step = v;
-    if (step == 0) {
-      step = 1;
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    auto arg = info[0];
+    if (arg->IsBigInt()) {
+      int sign = 0;
+      int wordCount = 1;
+      uint64_t word = 0;
+      arg.As<v8::BigInt>()->ToWordsArray(&sign, &wordCount, &word);
+      if (sign == 0) {
+        if (wordCount > 1) {
+          return false;
+        }
+        minimum = word;
+      }
+    } else if (arg->IsNumber()) {
+      double d = arg.As<v8::Number>()->Value();
+      if (std::isnan(d) || d >= 18446744073709551616.0) {
+        return false;
+      }
+      if (d > 0) {
+        minimum = (uint64_t)ceil(d);
+      }
+    } else {
+      return false;
     }
   }
 
-  auto self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
-  if (!self) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
-  }
-
-  uint64_t minInteger, maxInteger;
-  if (getRangeOperationParameters(info, minInteger, maxInteger)) {
-    roaring_bitmap_t * r = roaring_bitmap_from_range(minInteger, maxInteger, step);
-    if (r != nullptr) {
-      self->replaceBitmapInstance(isolate, r);
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    auto arg = info[1];
+    if (arg->IsBigInt()) {
+      int sign = 0;
+      int wordCount = 2;
+      uint64_t words[2] = {0, 0};
+      arg.As<v8::BigInt>()->ToWordsArray(&sign, &wordCount, words);
+      if (sign != 0 || wordCount == 0 || (wordCount == 1 && words[0] == 0)) {
+        return false;
+      }
+      if (wordCount == 1) {
+        maximumInclusive = words[0] - 1;
+      }
+    } else if (arg->IsNumber()) {
+      double d = arg.As<v8::Number>()->Value();
+      if (std::isnan(d) || d <= 0) {
+        return false;
+      }
+      if (d < 18446744073709551616.0) {
+        maximumInclusive = (uint64_t)ceil(d) - 1;
+      }
+    } else {
+      return false;
     }
   }
 
-  info.GetReturnValue().Set(result);
-}
-
-#endif  // ROARING_NODE_ROARING_BITMAP32_RANGES_
-
-#line 10 "src/cpp/RoaringBitmap32-main.h"
-
-void RoaringBitmap32_copyFrom(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (!self) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-  if (self->isFrozen()) {
-    return v8utils::throwError(isolate, ERROR_FROZEN);
-  }
-  if (info.Length() == 0 || !roaringAddMany(isolate, self, info[0], true)) {
-    return v8utils::throwError(
-      isolate, "RoaringBitmap32::copyFrom expects a RoaringBitmap32, an Uint32Array or an Iterable");
-  }
-  self->invalidate();
-  info.GetReturnValue().Set(info.This());
+  return minimum <= maximumInclusive;
 }
 
-void RoaringBitmap32_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32> const & info) {
-  RoaringBitmap32 * p = info.GetParameter();
+void RoaringBitmap64_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap64> const & info) {
+  RoaringBitmap64 * p = info.GetParameter();
   if (p != nullptr) {
-    p->~RoaringBitmap32();
+    p->~RoaringBitmap64();
     bare_aligned_free(p);
   }
 }
 
-void RoaringBitmap32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_addMany(const v8::FunctionCallbackInfo<v8::Value> & info);
+
+void RoaringBitmap64_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
   AddonData * addonData = AddonData::get(info);
   if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
 
   if (!info.IsConstructCall()) {
-    v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+    v8::Local<v8::Function> cons = addonData->RoaringBitmap64_constructor.Get(isolate);
     v8::MaybeLocal<v8::Object> v;
     if (info.Length() < 1) {
       v = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
@@ -14964,703 +23228,999 @@ void RoaringBitmap32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
 
   auto holder = info.This();
 
-  // If first parameter is a RoaringBitmap32 instance,
-  // and the second parameter is "readonly", creates a readonly bitmap.
-
-  RoaringBitmap32 * readonlyViewOf = nullptr;
-
-  if (info.Length() >= 2 && info[1]->IsString()) {
-    v8::String::Utf8Value arg1String(isolate, info[1]);
-    if (strcmp(*arg1String, "readonly") == 0) {
-      readonlyViewOf = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-      if (readonlyViewOf == nullptr) {
-        return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-      }
-    }
-  }
-
-  auto * instanceMemory = bare_aligned_malloc(32, sizeof(RoaringBitmap32));
-  RoaringBitmap32 * instance;
-  bool hasCapacity = false;
-
-  if (readonlyViewOf) {
-    instance = new (instanceMemory) RoaringBitmap32(addonData, readonlyViewOf);
-  } else {
-    if (info.Length() > 0 && info[0]->IsNumber()) {
-      hasCapacity = true;
-      double capacity;
-      if (!info[0]->NumberValue(isolate->GetCurrentContext()).To(&capacity)) {
-        capacity = 0;
-      }
-      if (capacity < 0) {
-        capacity = 0;
-      } else if (capacity > UINT32_MAX) {
-        capacity = UINT32_MAX;
-      }
-      instance = new (instanceMemory) RoaringBitmap32(addonData, (uint32_t)capacity);
-    } else {
-      instance = new (instanceMemory) RoaringBitmap32(addonData, 0U);
-    }
-  }
-
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap64));
+  RoaringBitmap64 * instance = instanceMemory ? new (instanceMemory) RoaringBitmap64(addonData) : nullptr;
   if (instance == nullptr) {
-    return v8utils::throwError(isolate, "RoaringBitmap32::ctor - failed to create RoaringBitmap32 instance");
-  }
-
-  if (instance->roaring == nullptr) {
-    instance->~RoaringBitmap32();
-    bare_aligned_free(instance);
-    return v8utils::throwError(isolate, "RoaringBitmap32::ctor - failed to create native RoaringBitmap32 instance");
+    return v8utils::throwError(isolate, "RoaringBitmap64::ctor - failed to create RoaringBitmap64 instance");
   }
 
   int indices[2] = {0, 1};
-  void * values[2] = {instance, (void *)(RoaringBitmap32::OBJECT_TOKEN)};
+  void * values[2] = {instance, (void *)(RoaringBitmap64::OBJECT_TOKEN)};
   holder->SetAlignedPointerInInternalFields(2, indices, values);
 
   instance->persistent.Reset(isolate, holder);
-  instance->persistent.SetWeak(instance, RoaringBitmap32_WeakCallback, v8::WeakCallbackType::kParameter);
+  instance->persistent.SetWeak(instance, RoaringBitmap64_WeakCallback, v8::WeakCallbackType::kParameter);
 
-  if (readonlyViewOf) {
-    instance->frozenStorage.bufferPersistent.Reset(isolate, holder);
-  } else if (!hasCapacity) {
-    bool hasParameter = info.Length() != 0 && !info[0]->IsUndefined() && !info[0]->IsNull();
-    if (hasParameter) {
-      if (addonData->RoaringBitmap32_constructorTemplate.Get(isolate)->HasInstance(info[0])) {
-        RoaringBitmap32_copyFrom(info);
-      } else {
-        RoaringBitmap32_addMany(info);
-      }
-    }
+  if (info.Length() != 0 && !info[0]->IsNullOrUndefined() && !info[0]->IsNumber()) {
+    RoaringBitmap64_addMany(info);
   }
 
   info.GetReturnValue().Set(holder);
 }
 
-void RoaringBitmap32_ofStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+inline bool RoaringBitmap64_newInstance(
+  v8::Isolate * isolate, AddonData * addonData, v8::Local<v8::Object> & result, RoaringBitmap64 *& instance) {
+  if (!addonData->RoaringBitmap64_constructor.Get(isolate)->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return false;
+  }
+  instance = ObjectWrap::TryUnwrap<RoaringBitmap64>(result, isolate);
+  if (instance == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+    return false;
+  }
+  return true;
+}
+
+void RoaringBitmap64_ofStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
   auto context = isolate->GetCurrentContext();
 
-  int len = info.Length();
-  if (len < 0) {
-    len = 0;
-  }
-
   AddonData * addonData = AddonData::get(info);
   if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
 
-  auto newRoaringBitmap32ObjectMaybe = addonData->RoaringBitmap32_constructor.Get(isolate)->NewInstance(context, 0, nullptr);
-
-  v8::Local<v8::Object> newRoaringBitmap32Object;
-  if (!newRoaringBitmap32ObjectMaybe.ToLocal(&newRoaringBitmap32Object)) {
-    return;
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
+    }
   }
 
-  info.GetReturnValue().Set(newRoaringBitmap32Object);
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(newRoaringBitmap32Object, isolate);
-  if (self == nullptr || !self->roaring) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
   }
 
-  auto roaring = self->roaring;
-  uint32_t v = 0;
+  RoaringBitmap64BulkAdder adder(self->buckets);
+  uint64_t v = 0;
   for (int i = 0; i < len; ++i) {
-    auto arg = info[i];
-    if (!v8utils::v8ValueToUint32Fast(context, arg, v)) {
-      continue;
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && !adder.add(v)) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::of - failed to allocate memory");
     }
-    roaring_bitmap_add(roaring, v);
   }
   self->invalidate();
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_getInstanceCountStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_getInstanceCountStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   AddonData * addonData = AddonData::get(info);
-  info.GetReturnValue().Set(addonData ? (double)(addonData->RoaringBitmap32_instances) : 0.0);
+  info.GetReturnValue().Set(addonData ? (double)(addonData->RoaringBitmap64_instances) : 0.0);
 }
 
-void RoaringBitmap32_asReadonlyView(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
-  }
-
-  v8::Local<v8::Object> vlocal;
-  if (!self->readonlyViewPersistent.IsEmpty()) {
-    vlocal = self->readonlyViewPersistent.Get(isolate);
-    if (vlocal->IsObject()) {
-      info.GetReturnValue().Set(vlocal);
-      return;
-    }
-  }
-
-  if (self->isFrozenForever()) {
-    self->readonlyViewPersistent.Reset(isolate, info.This());
-    info.GetReturnValue().Set(info.This());
-    return;
-  }
-
-  AddonData * addonData = self->addonData;
-  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
-  v8::MaybeLocal<v8::Object> v;
-  v8::Local<v8::Value> argv[2] = {info.This(), addonData->strings.readonly.Get(isolate)};
-  v = cons->NewInstance(isolate->GetCurrentContext(), 2, argv);
-
-  if (!v.ToLocal(&vlocal)) {
-    return v8utils::throwError(
-      isolate, "RoaringBitmap32::asReadonlyView - failed to create readonly RoaringBitmap32 instance");
-  }
-
-  self->readonlyViewPersistent.Reset(isolate, vlocal);
-
-  info.GetReturnValue().Set(vlocal);
-}
-
-void RoaringBitmap32_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
+void RoaringBitmap64_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
   auto size = self != nullptr ? self->getSize() : 0U;
   return size <= 0xFFFFFFFF ? info.GetReturnValue().Set((uint32_t)size) : info.GetReturnValue().Set((double)size);
 }
 
-void RoaringBitmap32_isEmpty_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
-  auto result = self == nullptr || self->isEmpty();
-  return info.GetReturnValue().Set(result);
+void RoaringBitmap64_isEmpty_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self == nullptr || self->isEmpty());
 }
 
-void RoaringBitmap32_isFrozen_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), info.GetIsolate());
+void RoaringBitmap64_isFrozen_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
   info.GetReturnValue().Set(self == nullptr || self->isFrozen());
 }
 
-void RoaringBitmap32_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
-  uint32_t v;
-  if (
-    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
-    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    info.GetReturnValue().Set(false);
-  } else {
-    info.GetReturnValue().Set(roaring_bitmap_contains(self->roaring, v));
-  }
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), isolate);
+  uint64_t v;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], v) &&
+    self->contains(v));
 }
 
-void RoaringBitmap32_indexOf(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
-  uint32_t v;
-  if (
-    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
-    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    return info.GetReturnValue().Set(-1);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  int64_t r = roaring_bitmap_get_index(self->roaring, v);
-  if (r >= 0) {
-    int64_t fromIndex;
-    if (info.Length() > 1 && info[1]->IntegerValue(isolate->GetCurrentContext()).To(&fromIndex)) {
-      if (fromIndex < 0) {
-        fromIndex += self->getSize();
-      }
-      if (r < fromIndex) {
-        return info.GetReturnValue().Set(-1);
-      }
-    }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  return (uint64_t)r <= 0xFFFFFFFFull
-    ? r < 0x7fffffff ? info.GetReturnValue().Set((int)r) : info.GetReturnValue().Set((uint32_t)r)
-    : info.GetReturnValue().Set((double)r);
-}
 
-void RoaringBitmap32_lastIndexOf(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
-  uint32_t v;
-  if (
-    self == nullptr || info.Length() < 1 || !info[0]->IsUint32() ||
-    !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    return info.GetReturnValue().Set(-1);
-  }
-  int64_t r = roaring_bitmap_get_index(self->roaring, v);
-  if (r >= 0) {
-    int64_t fromIndex;
-    if (info.Length() > 1 && info[1]->IntegerValue(isolate->GetCurrentContext()).To(&fromIndex)) {
-      if (fromIndex < 0) {
-        fromIndex += self->getSize();
-      }
-      if (r > fromIndex) {
-        return info.GetReturnValue().Set(-1);
-      }
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
     }
   }
-  return (uint64_t)r <= 0xFFFFFFFFull
-    ? r < 0x7fffffff ? info.GetReturnValue().Set((int)r) : info.GetReturnValue().Set((uint32_t)r)
-    : info.GetReturnValue().Set((double)r);
-}
 
-void RoaringBitmap32_minimum(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  return info.GetReturnValue().Set(self != nullptr ? roaring_bitmap_minimum(self->roaring) : 0);
-}
+  info.GetReturnValue().Set(info.This());
 
-void RoaringBitmap32_maximum(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  return info.GetReturnValue().Set(self != nullptr ? roaring_bitmap_maximum(self->roaring) : 0);
+  bool changed = false;
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->addChecked(v)) {
+      changed = true;
+    }
+  }
+  if (changed) {
+    self->invalidate();
+  }
 }
 
-void RoaringBitmap32_rank(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return info.GetReturnValue().Set(0);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  uint32_t v;
-  if (info.Length() < 1 || !info[0]->IsUint32() || !info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    return info.GetReturnValue().Set(0);
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  info.GetReturnValue().Set((double)roaring_bitmap_rank(self->roaring, v));
-}
 
-void RoaringBitmap32_select(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return info.GetReturnValue().Set(0);
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
+    }
   }
-  uint32_t v;
-  if (info.Length() >= 1 && info[0]->IsUint32() && info[0]->Uint32Value(isolate->GetCurrentContext()).To(&v)) {
-    if (roaring_bitmap_select(self->roaring, v, &v)) {
-      info.GetReturnValue().Set(v);
+
+  bool changed = false;
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->addChecked(v)) {
+      changed = true;
     }
   }
+  if (changed) {
+    self->invalidate();
+  }
+  info.GetReturnValue().Set(changed);
 }
 
-void RoaringBitmap32_removeRunCompression(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_INVALID_OBJECT);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  if (self->isFrozenHard()) {
-    return v8utils::throwError(info.GetIsolate(), ERROR_FROZEN);
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  bool removed = roaring_bitmap_remove_run_compression(self->roaring);
-  if (removed) {
+
+  bool changed = false;
+  const int len = info.Length();
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->removeChecked(v)) {
+      changed = true;
+    }
+  }
+  if (changed) {
     self->invalidate();
   }
-  info.GetReturnValue().Set(removed);
+  info.GetReturnValue().Set(changed);
 }
 
-void RoaringBitmap32_runOptimize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  if (self->isFrozenHard()) {
+  if (self->isFrozen()) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  info.GetReturnValue().Set(roaring_bitmap_run_optimize(self->roaring));
+  if (info.Length() > 0) {
+    v8::TryCatch tryCatch(isolate);
+    bool added = roaring64AddMany(isolate, self, info[0]);
+    if (tryCatch.HasCaught()) {
+      tryCatch.ReThrow();
+      return;
+    }
+    if (added) {
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
 }
 
-void RoaringBitmap32_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_removeMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  if (self->isFrozenHard()) {
+  if (self->isFrozen()) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  info.GetReturnValue().Set((double)roaring_bitmap_shrink_to_fit(self->roaring));
+  if (info.Length() > 0 && info[0]->IsObject()) {
+    auto arg = info[0];
+    RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(arg, isolate);
+    if (other != nullptr) {
+      if (other == self) {
+        self->buckets.clear();
+      } else {
+        RoaringBitmap64Buckets result;
+        roaring64BucketsOperation(RoaringBitmap64Operation::ANDNOT, self->buckets, other->buckets, result, true);
+        self->buckets.swap(result);
+      }
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    if (arg->IsBigUint64Array() || arg->IsBigInt64Array()) {
+      const v8utils::TypedArrayContent<uint64_t> typedArray(isolate, arg);
+      roaring64RemoveUint64Array(self->buckets, typedArray.data, typedArray.length);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    RoaringBitmap64 tmp(self->addonData);
+    v8::TryCatch tryCatch(isolate);
+    const bool added = roaring64AddMany(isolate, &tmp, arg);
+    if (tryCatch.HasCaught()) {
+      tryCatch.ReThrow();
+      return;
+    }
+    if (added) {
+      RoaringBitmap64Buckets result;
+      roaring64BucketsOperation(RoaringBitmap64Operation::ANDNOT, self->buckets, tmp.buckets, result, true);
+      self->buckets.swap(result);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
 }
 
-void RoaringBitmap32_freeze(const v8::FunctionCallbackInfo<v8::Value> & info) {
+template <RoaringBitmap64Operation OP>
+void RoaringBitmap64_opInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self && self->frozenCounter >= 0) {
-    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_SOFT_FROZEN;
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  info.GetReturnValue().Set(info.This());
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    RoaringBitmap64 tmp(self->addonData);
+    RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info[0], isolate);
+    if (other == nullptr) {
+      v8::TryCatch tryCatch(isolate);
+      const bool added = roaring64AddMany(isolate, &tmp, info[0]);
+      if (tryCatch.HasCaught()) {
+        tryCatch.ReThrow();
+        return;
+      }
+      if (!added) {
+        return v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
+      }
+      other = &tmp;
+    }
+    if (other == self) {
+      if (OP == RoaringBitmap64Operation::XOR || OP == RoaringBitmap64Operation::ANDNOT) {
+        self->buckets.clear();
+      }
+    } else {
+      RoaringBitmap64Buckets result;
+      roaring64BucketsOperation(OP, self->buckets, other->buckets, result, true);
+      self->buckets.swap(result);
+    }
+    self->invalidate();
+    return info.GetReturnValue().Set(info.This());
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
 }
 
-void RoaringBitmap32_clone(const v8::FunctionCallbackInfo<v8::Value> & info) {
+template <RoaringBitmap64Operation OP>
+void RoaringBitmap64_opStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
 
-  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  RoaringBitmap64 * a = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  RoaringBitmap64 * b = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 1);
+  if (a == nullptr || b == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 operation expects two RoaringBitmap64 arguments");
+  }
 
-  v8::Local<v8::Value> argv[1] = {info.This()};
-  auto v = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
-  v8::Local<v8::Object> vlocal;
-  if (v.ToLocal(&vlocal)) {
-    info.GetReturnValue().Set(vlocal);
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
   }
+
+  if (!roaring64BucketsOperation(OP, a->buckets, b->buckets, self->buckets, false)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 operation failed to allocate memory");
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_statistics(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  v8::Isolate * isolate = info.GetIsolate();
+uint64_t roaring64AndCardinality(const RoaringBitmap64Buckets & a, const RoaringBitmap64Buckets & b) {
+  uint64_t result = 0;
+  for (uint32_t i = 0, j = 0; i < a.count && j < b.count;) {
+    if (a.items[i].high < b.items[j].high) {
+      ++i;
+    } else if (b.items[j].high < a.items[i].high) {
+      ++j;
+    } else {
+      result += roaring_bitmap_and_cardinality(a.items[i++].bitmap, b.items[j++].bitmap);
+    }
+  }
+  return result;
+}
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
-  if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+/** The other cardinalities are derived from |a|, |b| and |a and b|. */
+inline bool roaring64GetCardinalities(
+  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & sizeA, uint64_t & sizeB, uint64_t & sizeAnd) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return false;
   }
-  roaring_statistics_t stats;
-  roaring_bitmap_statistics(self->roaring, &stats);
-  auto context = isolate->GetCurrentContext();
-  auto result = v8::Object::New(isolate);
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "containers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "arrayContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_array_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "runContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_run_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "bitsetContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_bitset_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "valuesInArrayContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_array_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "valuesInRunContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_run_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "valuesInBitsetContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_values_bitset_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "bytesInArrayContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_array_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "bytesInRunContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_run_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "bytesInBitsetContainers", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.n_bytes_bitset_containers)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "maxValue", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.max_value)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "minValue", v8::NewStringType::kInternalized),
-    v8::Uint32::NewFromUnsigned(isolate, stats.min_value)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
-    v8::Number::New(isolate, (double)stats.cardinality)));
-  ignoreMaybeResult(result->Set(
-    context,
-    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
-    v8::Boolean::New(isolate, self->isFrozen())));
-  info.GetReturnValue().Set(result);
+  sizeAnd = roaring64AndCardinality(self->buckets, other->buckets);
+  sizeA = self->getSize();
+  sizeB = other->getSize();
+  return true;
 }
 
-void RoaringBitmap32_isSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self == other || (self && other && roaring_bitmap_is_subset(self->roaring, other->roaring)));
+void RoaringBitmap64_andCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)ab : -1);
 }
 
-void RoaringBitmap32_isSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self == other || (self && other && roaring_bitmap_is_subset(other->roaring, self->roaring)));
+void RoaringBitmap64_orCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a + b - ab) : -1);
 }
 
-void RoaringBitmap32_isStrictSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other && roaring_bitmap_is_strict_subset(self->roaring, other->roaring));
+void RoaringBitmap64_andNotCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a - ab) : -1);
 }
 
-void RoaringBitmap32_isStrictSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other && roaring_bitmap_is_strict_subset(other->roaring, self->roaring));
+void RoaringBitmap64_xorCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a + b - 2 * ab) : -1);
 }
 
-void RoaringBitmap32_isEqual(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(
-    self == other || (self && other && roaring_bitmap_equals(self->roaring, other->roaring) ? true : false));
+void RoaringBitmap64_intersects(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return info.GetReturnValue().Set(false);
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  for (uint32_t i = 0, j = 0; i < a.count && j < b.count;) {
+    if (a.items[i].high < b.items[j].high) {
+      ++i;
+    } else if (b.items[j].high < a.items[i].high) {
+      ++j;
+    } else if (roaring_bitmap_intersect(a.items[i++].bitmap, b.items[j++].bitmap)) {
+      return info.GetReturnValue().Set(true);
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+inline bool roaring64IsSubset(const RoaringBitmap64 * self, const RoaringBitmap64 * other) {
+  if (self == other) {
+    return true;
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  if (a.count > b.count) {
+    return false;
+  }
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < a.count; ++i) {
+    while (j < b.count && b.items[j].high < a.items[i].high) {
+      ++j;
+    }
+    if (j >= b.count || b.items[j].high != a.items[i].high || !roaring_bitmap_is_subset(a.items[i].bitmap, b.items[j].bitmap)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RoaringBitmap64_isSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring64IsSubset(self, other));
+}
+
+void RoaringBitmap64_isSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring64IsSubset(other, self));
+}
+
+void RoaringBitmap64_isEqual(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (self == other) {
+    return info.GetReturnValue().Set(true);
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  if (a.count != b.count) {
+    return info.GetReturnValue().Set(false);
+  }
+  for (uint32_t i = 0; i < a.count; ++i) {
+    if (a.items[i].high != b.items[i].high || !roaring_bitmap_equals(a.items[i].bitmap, b.items[i].bitmap)) {
+      return info.GetReturnValue().Set(false);
+    }
+  }
+  info.GetReturnValue().Set(true);
 }
 
-void RoaringBitmap32_intersects(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other && roaring_bitmap_intersect(self->roaring, other->roaring) ? true : false);
+void RoaringBitmap64_minimum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self != nullptr && !self->isEmpty()) {
+    const RoaringBitmap64Bucket & bucket = self->buckets.items[0];
+    const uint64_t v = ((uint64_t)bucket.high << 32) | roaring_bitmap_minimum(bucket.bitmap);
+    info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, v));
+  }
 }
 
-void RoaringBitmap32_jaccardIndex(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), info.GetIsolate());
-  RoaringBitmap32 * other = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, 0);
-  info.GetReturnValue().Set(self && other ? roaring_bitmap_jaccard_index(self->roaring, other->roaring) : -1);
+void RoaringBitmap64_maximum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self != nullptr && !self->isEmpty()) {
+    const RoaringBitmap64Bucket & bucket = self->buckets.items[self->buckets.count - 1];
+    const uint64_t v = ((uint64_t)bucket.high << 32) | roaring_bitmap_maximum(bucket.bitmap);
+    info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, v));
+  }
 }
 
-void RoaringBitmap32_swapStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_rank(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  if (info.Length() < 2) return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap expects 2 arguments");
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  uint64_t v;
+  if (self == nullptr || info.Length() < 1 || !v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], v)) {
+    return info.GetReturnValue().Set(0);
+  }
+  const uint32_t high = (uint32_t)(v >> 32);
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  uint64_t result = 0;
+  for (uint32_t i = 0; i < buckets.count && buckets.items[i].high <= high; ++i) {
+    if (buckets.items[i].high < high) {
+      result += roaring_bitmap_get_cardinality(buckets.items[i].bitmap);
+    } else {
+      result += roaring_bitmap_rank(buckets.items[i].bitmap, (uint32_t)v);
+    }
+  }
+  info.GetReturnValue().Set((double)result);
+}
 
-  RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
-  if (a == nullptr)
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap first argument must be a RoaringBitmap32");
+void RoaringBitmap64_select(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  uint64_t rank;
+  if (self == nullptr || info.Length() < 1 || !v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], rank)) {
+    return;
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    const uint64_t card = roaring_bitmap_get_cardinality(buckets.items[i].bitmap);
+    if (rank < card) {
+      uint32_t low;
+      if (roaring_bitmap_select(buckets.items[i].bitmap, (uint32_t)rank, &low)) {
+        info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, ((uint64_t)buckets.items[i].high << 32) | low));
+      }
+      return;
+    }
+    rank -= card;
+  }
+}
 
-  RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[1], isolate);
-  if (b == nullptr)
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32::swap second argument must be a RoaringBitmap32");
+void RoaringBitmap64_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (self->isEmpty()) {
+    return info.GetReturnValue().Set(false);
+  }
+  self->buckets.clear();
+  self->invalidate();
+  info.GetReturnValue().Set(true);
+}
 
-  if (a->isFrozen() || b->isFrozen()) return v8utils::throwError(isolate, ERROR_FROZEN);
+void RoaringBitmap64_clone(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * instance;
+  if (!RoaringBitmap64_newInstance(isolate, self->addonData, result, instance)) {
+    return;
+  }
+  if (!instance->buckets.copyFrom(self->buckets)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::clone failed to allocate memory");
+  }
+  instance->invalidate();
+  info.GetReturnValue().Set(result);
+}
 
-  if (a != b) {
-    auto * a_roaring = a->roaring;
-    auto a_sizeCache = a->sizeCache;
-    a->roaring = b->roaring;
-    a->sizeCache = b->sizeCache;
-    b->roaring = a_roaring;
-    b->sizeCache = a_sizeCache;
+void RoaringBitmap64_freeze(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  if (self && self->frozenCounter >= 0) {
+    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_SOFT_FROZEN;
+  }
+  info.GetReturnValue().Set(info.This());
+}
 
-    a->invalidate();
-    b->invalidate();
+void RoaringBitmap64_runOptimize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
+  bool result = false;
+  for (uint32_t i = 0; i < self->buckets.count; ++i) {
+    if (roaring_bitmap_run_optimize(self->buckets.items[i].bitmap)) {
+      result = true;
+    }
+  }
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_toString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
   if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  info.GetReturnValue().Set(self->addonData->strings.RoaringBitmap32.Get(isolate));
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  double result = 0;
+  for (uint32_t i = 0; i < self->buckets.count; ++i) {
+    result += (double)roaring_bitmap_shrink_to_fit(self->buckets.items[i].bitmap);
+  }
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_at(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_addRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
   if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  if (info.Length() < 1) {
-    return;
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  const size_t cardinality = self->getSize();
-  auto context = isolate->GetCurrentContext();
-  uint32_t index;
-  if (!v8utils::v8ValueToUint32Fast(context, info[0], index)) {
-    if (info[0]->IsNullOrUndefined()) {
-      return;
-    }
-    double d;
-    if (!info[0]->NumberValue(context).To(&d) || std::isnan(d)) {
-      return;
-    }
-    d = std::trunc(d);
-    if (d < 0) {
-      d += static_cast<double>(cardinality);
-      if (d < 0) {
-        return;
-      }
-    }
-    if (d >= 4294967296.0) {
-      return;
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    if (roaring64RangeBucketsCount(minimum, maximum) > ROARING64_MAX_RANGE_BUCKETS) {
+      return v8utils::throwError(
+        isolate, "RoaringBitmap64::addRange - the range touches more than 65536 blocks of 2^32 values");
+    }
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    bool allocated = true;
+    roaring64ForEachRangeBucket(
+      minimum, maximum, [&buckets, &allocated](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+        roaring_bitmap_t * bitmap = buckets.getOrCreate(high);
+        if (bitmap == nullptr) {
+          allocated = false;
+          return false;
+        }
+        roaring_bitmap_add_range_closed(bitmap, lowMin, lowMax);
+        return true;
+      });
+    self->invalidate();
+    if (!allocated) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::addRange - failed to allocate memory");
     }
-    index = static_cast<uint32_t>(d);
   }
+  info.GetReturnValue().Set(info.This());
+}
 
-  uint32_t result;
-  if (roaring_bitmap_select(self->roaring, index, &result)) {
-    info.GetReturnValue().Set(result);
+void RoaringBitmap64_removeRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    const uint32_t highMax = (uint32_t)(maximum >> 32);
+    for (uint32_t i = buckets.lowerBound((uint32_t)(minimum >> 32)); i < buckets.count && buckets.items[i].high <= highMax;
+         ++i) {
+      const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+      const uint32_t lowMin = minimum > base ? (uint32_t)minimum : 0;
+      const uint32_t lowMax = maximum < base + UINT32_MAX ? (uint32_t)maximum : UINT32_MAX;
+      roaring_bitmap_remove_range_closed(buckets.items[i].bitmap, lowMin, lowMax);
+    }
+    buckets.compact();
+    self->invalidate();
   }
+  info.GetReturnValue().Set(info.This());
 }
 
-void RoaringBitmap32_join(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_flipRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
   if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-
-  struct iter_data {
-    uint32_t count;
-    std::string sep;
-    std::string result;
-  } iterData;
-
-  iterData.count = 0;
-
-  if (info.Length() >= 1 && info[0]->IsString()) {
-    v8::String::Utf8Value sep(isolate, info[0]);
-    iterData.sep = *sep;
-  } else {
-    iterData.sep = ",";
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-
-  if (self != nullptr && !self->isEmpty()) {
-    roaring_iterate(
-      self->roaring,
-      [](uint32_t value, void * vp) -> bool {
-        auto * p = reinterpret_cast<iter_data *>(vp);
-        if (p->result.length() >= 536870880) {
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    if (roaring64RangeBucketsCount(minimum, maximum) > ROARING64_MAX_RANGE_BUCKETS) {
+      return v8utils::throwError(
+        isolate, "RoaringBitmap64::flipRange - the range touches more than 65536 blocks of 2^32 values");
+    }
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    bool allocated = true;
+    roaring64ForEachRangeBucket(
+      minimum, maximum, [&buckets, &allocated](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+        roaring_bitmap_t * bitmap = buckets.getOrCreate(high);
+        if (bitmap == nullptr) {
+          allocated = false;
           return false;
         }
-
-        if (p->count++ > 0 && !p->sep.empty()) {
-          p->result.append(p->sep);
-        }
-        p->result.append(std::to_string(value));
+        roaring_bitmap_flip_inplace(bitmap, lowMin, (uint64_t)lowMax + 1);
         return true;
-      },
-      (void *)&iterData);
+      });
+    buckets.compact();
+    self->invalidate();
+    if (!allocated) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::flipRange - failed to allocate memory");
+    }
   }
+  info.GetReturnValue().Set(info.This());
+}
 
-  auto returnValue = v8::String::NewFromUtf8(isolate, iterData.result.c_str(), v8::NewStringType::kNormal);
-  v8::Local<v8::String> returnValueLocal;
-  if (returnValue.ToLocal(&returnValueLocal)) {
-    info.GetReturnValue().Set(returnValueLocal);
-  } else {
-    info.GetReturnValue().Set(v8::String::Empty(isolate));
+void RoaringBitmap64_hasRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  uint64_t minimum, maximum;
+  if (self == nullptr || !getRange64OperationParameters(info, minimum, maximum)) {
+    return info.GetReturnValue().Set(false);
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  // Every bucket in the range must exist, so the bucket count is a cheap upper bound.
+  if ((maximum >> 32) - (minimum >> 32) >= buckets.count) {
+    return info.GetReturnValue().Set(false);
   }
+  bool result = true;
+  roaring64ForEachRangeBucket(minimum, maximum, [&buckets, &result](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+    const roaring_bitmap_t * bitmap = buckets.get(high);
+    result = bitmap != nullptr && roaring_bitmap_contains_range(bitmap, lowMin, (uint64_t)lowMax + 1);
+    return result;
+  });
+  info.GetReturnValue().Set(result);
 }
 
-void RoaringBitmap32_contentToString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_rangeCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  uint64_t minimum, maximum;
+  if (self == nullptr || !getRange64OperationParameters(info, minimum, maximum)) {
+    return info.GetReturnValue().Set(0);
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  const uint32_t highMax = (uint32_t)(maximum >> 32);
+  uint64_t result = 0;
+  for (uint32_t i = buckets.lowerBound((uint32_t)(minimum >> 32)); i < buckets.count && buckets.items[i].high <= highMax;
+       ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    const uint32_t lowMin = minimum > base ? (uint32_t)minimum : 0;
+    const uint32_t lowMax = maximum < base + UINT32_MAX ? (uint32_t)maximum : UINT32_MAX;
+    result += roaring_bitmap_range_cardinality(buckets.items[i].bitmap, lowMin, (uint64_t)lowMax + 1);
+  }
+  info.GetReturnValue().Set((double)result);
+}
+
+/** Writes up to length values in ascending order, returns the number of values written. */
+inline size_t roaring64ToUint64Array(const RoaringBitmap64Buckets & buckets, uint64_t * output, size_t length) {
+  uint32_t chunk[1024];
+  size_t n = 0;
+  for (uint32_t i = 0; i < buckets.count && n < length; ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(buckets.items[i].bitmap, &it);
+    while (n < length) {
+      const size_t toRead = std::min<size_t>(sizeof(chunk) / sizeof(chunk[0]), length - n);
+      const uint32_t read = roaring_uint32_iterator_read(&it, chunk, (uint32_t)toRead);
+      for (uint32_t k = 0; k < read; ++k) {
+        output[n++] = base | chunk[k];
+      }
+      if (read < toRead) {
+        break;
+      }
+    }
+  }
+  return n;
+}
+
+void RoaringBitmap64_toBigUint64Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  const uint64_t size = self->getSize();
+  if (size > node::Buffer::kMaxLength / sizeof(uint64_t)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::toBigUint64Array - bitmap is too big");
+  }
+  auto arrayBuffer = v8::ArrayBuffer::New(isolate, (size_t)size * sizeof(uint64_t));
+  if (size != 0) {
+    roaring64ToUint64Array(self->buckets, (uint64_t *)arrayBuffer->GetBackingStore()->Data(), (size_t)size);
+  }
+  info.GetReturnValue().Set(v8::BigUint64Array::New(arrayBuffer, 0, (size_t)size));
+}
 
-  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+void RoaringBitmap64_toArray(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
   if (self == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
-  struct iter_data {
-    std::string str;
-    char first_char = '[';
-    uint64_t maxLen = 32000;
-  } iterData;
+  uint64_t size = self->getSize();
+  double maxLength;
+  if (
+    info.Length() > 0 && info[0]->IsNumber() && info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxLength) &&
+    maxLength >= 0 && maxLength < (double)size) {
+    size = (uint64_t)maxLength;
+  }
+  if (size > 0xFFFFFFF) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::toArray - bitmap is too big, use toBigUint64Array");
+  }
+  auto context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> result = v8::Array::New(isolate, (int)size);
+  uint32_t index = 0;
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  for (uint32_t i = 0; i < buckets.count && index < size; ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(buckets.items[i].bitmap, &it);
+    for (; it.has_value && index < size; roaring_uint32_iterator_advance(&it)) {
+      ignoreMaybeResult(result->Set(context, index++, v8::BigInt::NewFromUnsigned(isolate, base | it.current_value)));
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
 
-  double nv;
-  if (info.Length() >= 1 && info[0]->IsNumber() && info[0]->NumberValue(isolate->GetCurrentContext()).To(&nv) && nv >= 0) {
-    iterData.maxLen = (uint64_t)nv;
+void RoaringBitmap64_toString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
   }
+  info.GetReturnValue().Set(self->addonData->strings.RoaringBitmap64.Get(isolate));
+}
 
-  if (iterData.maxLen > 536870880) {
-    iterData.maxLen = 536870880;
+/////////////////// serialization ///////////////////
+
+/**
+ * Portable 64 bit format, compatible with CRoaring roaring64_bitmap_portable_serialize and the Java and Go implementations:
+ * uint64 number of buckets, then for each bucket the uint32 high 32 bits followed by the portable 32 bit bitmap.
+ */
+size_t roaring64PortableSizeInBytes(const RoaringBitmap64Buckets & buckets) {
+  size_t result = sizeof(uint64_t);
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    result += sizeof(uint32_t) + roaring_bitmap_portable_size_in_bytes(buckets.items[i].bitmap);
   }
+  return result;
+}
 
-  if (self != nullptr && !self->isEmpty()) {
-    roaring_iterate(
-      self->roaring,
-      [](uint32_t value, void * vp) -> bool {
-        auto * p = reinterpret_cast<iter_data *>(vp);
-        if (p->str.length() >= p->maxLen) {
-          p->str.append("...");
-          return false;
-        }
+size_t roaring64PortableSerialize(const RoaringBitmap64Buckets & buckets, char * buf) {
+  char * p = buf;
+  const uint64_t count = buckets.count;
+  memcpy(p, &count, sizeof(count));
+  p += sizeof(count);
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    memcpy(p, &buckets.items[i].high, sizeof(uint32_t));
+    p += sizeof(uint32_t);
+    p += roaring_bitmap_portable_serialize(buckets.items[i].bitmap, p);
+  }
+  return p - buf;
+}
 
-        p->str += p->first_char;
-        p->str.append(std::to_string(value));
-        p->first_char = ',';
-        return true;
-      },
-      (void *)&iterData);
-  } else {
-    iterData.str = '[';
+const char * roaring64PortableDeserialize(RoaringBitmap64Buckets & buckets, const char * buf, size_t length, bool frozen) {
+  buckets.clear();
+  uint64_t count;
+  if (length < sizeof(count)) {
+    return "RoaringBitmap64 deserialization - buffer is too small";
   }
-  iterData.str += ']';
+  memcpy(&count, buf, sizeof(count));
+  size_t offset = sizeof(count);
+  if (count > (length - offset) / sizeof(uint32_t) || !buckets.reserve((uint32_t)count)) {
+    return "RoaringBitmap64 deserialization - invalid number of buckets";
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    uint32_t high;
+    if (length - offset < sizeof(high)) {
+      return "RoaringBitmap64 deserialization - buffer is too small";
+    }
+    memcpy(&high, buf + offset, sizeof(high));
+    offset += sizeof(high);
+    if (buckets.count != 0 && high <= buckets.items[buckets.count - 1].high) {
+      return "RoaringBitmap64 deserialization - buckets are not sorted";
+    }
+    const size_t size = roaring_bitmap_portable_deserialize_size(buf + offset, length - offset);
+    if (size == 0) {
+      return "RoaringBitmap64 deserialization - invalid portable bitmap";
+    }
+    roaring_bitmap_t * bitmap = frozen ? roaring_bitmap_portable_deserialize_frozen(buf + offset)
+                                       : roaring_bitmap_portable_deserialize_safe(buf + offset, length - offset);
+    if (bitmap == nullptr) {
+      return "RoaringBitmap64 deserialization - invalid portable bitmap";
+    }
+    offset += size;
+    if (roaring_bitmap_is_empty(bitmap)) {
+      roaring_bitmap_free(bitmap);
+    } else if (!buckets.append(high, bitmap)) {
+      return "RoaringBitmap64 deserialization - failed to allocate memory";
+    }
+  }
+  return nullptr;
+}
 
-  auto returnValue = v8::String::NewFromUtf8(isolate, iterData.str.c_str(), v8::NewStringType::kNormal);
-  v8::Local<v8::String> returnValueLocal;
-  if (returnValue.ToLocal(&returnValueLocal)) {
-    info.GetReturnValue().Set(returnValueLocal);
-  } else {
-    info.GetReturnValue().Set(v8::String::Empty(isolate));
+inline bool roaring64ParsePortableFormat(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+  return tryParseSerializationFormat(value, isolate) == SerializationFormat::portable;
+}
+
+void RoaringBitmap64_getSerializationSizeInBytes(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 1 || !roaring64ParsePortableFormat(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 only supports the portable serialization format");
   }
+  info.GetReturnValue().Set((double)roaring64PortableSizeInBytes(self->buckets));
 }
 
-void RoaringBitmap32_fromArrayStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64_serialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 1 || !roaring64ParsePortableFormat(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 only supports the portable serialization format");
+  }
 
-  v8::Local<v8::Value> arg;
+  const size_t size = roaring64PortableSizeInBytes(self->buckets);
 
-  if (info.Length() >= 1) {
-    arg = info[0];
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    v8utils::TypedArrayContent<uint8_t> output(isolate, info[1]);
+    if (output.data == nullptr || output.length < size) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::serialize - output buffer is too small");
+    }
+    roaring64PortableSerialize(self->buckets, (char *)output.data);
+    v8::Local<v8::Value> result;
+    if (!v8utils::v8ValueToBufferWithLimit(isolate, self->addonData, info[1], size, result)) {
+      return v8utils::throwError(isolate, "RoaringBitmap64 serialization failed to create the buffer view");
+    }
+    return info.GetReturnValue().Set(result);
+  }
+
+  char * data = (char *)bare_aligned_malloc(32, size);
+  if (data == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 serialization allocation failed");
+  }
+  roaring64PortableSerialize(self->buckets, data);
+  v8::Local<v8::Object> result;
+  if (!node::Buffer::New(isolate, data, size, bare_aligned_free_callback, nullptr).ToLocal(&result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 serialization failed to create a new buffer");
   }
+  info.GetReturnValue().Set(result);
+}
 
+void RoaringBitmap64_deserializeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
   AddonData * addonData = AddonData::get(info);
   if (addonData == nullptr) {
-    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 2 || !roaring64ParsePortableFormat(isolate, info[1])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::deserialize only supports the portable serialization format");
   }
+  if (!info[0]->IsArrayBufferView() && !info[0]->IsArrayBuffer() && !info[0]->IsSharedArrayBuffer()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::deserialize expects a buffer");
+  }
+  const v8utils::TypedArrayContent<uint8_t> input(isolate, info[0]);
 
-  auto * worker = new FromArrayAsyncWorker(isolate, addonData);
-  if (worker == nullptr) {
-    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
   }
+  const char * error = roaring64PortableDeserialize(self->buckets, (const char *)input.data, input.length, false);
+  if (error != nullptr) {
+    self->buckets.clear();
+    return v8utils::throwError(isolate, error);
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
 
-  if (!arg->IsNullOrUndefined() && !arg->IsFunction()) {
-    if (arg->IsUint32Array() || arg->IsInt32Array()) {
-      worker->buffer.set(isolate, arg);
-      const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
-    } else if (arg->IsObject()) {
-      if (addonData->RoaringBitmap32_constructorTemplate.Get(isolate)->HasInstance(arg)) {
-        return v8utils::throwTypeError(
-          isolate, "RoaringBitmap32::fromArrayAsync cannot be called with a RoaringBitmap32 instance");
-      }
-      v8::Local<v8::Value> argv[] = {arg};
-      auto carg = addonData->Uint32Array_from.Get(isolate)->Call(
-        isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
-      v8::Local<v8::Value> local;
-      if (carg.ToLocal(&local)) {
-        worker->buffer.set(isolate, local);
-      }
-    }
+void RoaringBitmap64_unsafeFrozenViewStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 2 || tryParseFrozenViewFormat(info[1], isolate) != FrozenViewFormat::unsafe_frozen_portable) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::unsafeFrozenView only supports the unsafe_frozen_portable format");
+  }
 
-    worker->argPersistent.Reset(isolate, arg);
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
   }
 
-  if (info.Length() >= 2 && info[1]->IsFunction()) {
-    worker->setCallback(info[1]);
-  } else if (info.Length() >= 1 && info[0]->IsFunction()) {
-    worker->setCallback(info[0]);
+  v8utils::TypedArrayContent<uint8_t> & frozenStorage = self->frozenStorage;
+  if (info[0]->IsNullOrUndefined() || !frozenStorage.set(isolate, info[0])) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::unsafeFrozenView buffer argument was invalid");
   }
 
-  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
-  info.GetReturnValue().Set(returnValue);
-}
+  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
 
-void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
-  croaringMemoryInitialize();
+  const char * error =
+    roaring64PortableDeserialize(self->buckets, (const char *)frozenStorage.data, frozenStorage.length, true);
+  if (error != nullptr) {
+    self->buckets.clear();
+    return v8utils::throwError(isolate, error);
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
 
+void RoaringBitmap64_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
   v8::Isolate * isolate = addonData->isolate;
   v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-  v8::Local<v8::String> className = addonData->strings.RoaringBitmap32.Get(isolate);
-
-  auto versionString = NEW_LITERAL_V8_STRING(isolate, ROARING_VERSION, v8::NewStringType::kInternalized);
+  v8::Local<v8::String> className = addonData->strings.RoaringBitmap64.Get(isolate);
 
   v8::Local<v8::FunctionTemplate> ctor =
-    v8::FunctionTemplate::New(isolate, RoaringBitmap32_New, addonData->external.Get(isolate));
+    v8::FunctionTemplate::New(isolate, RoaringBitmap64_New, addonData->external.Get(isolate));
   if (ctor.IsEmpty()) {
     return;
   }
-  addonData->RoaringBitmap32_constructorTemplate.Reset(isolate, ctor);
+  addonData->RoaringBitmap64_constructorTemplate.Reset(isolate, ctor);
 
   v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
   ctor->SetClassName(className);
@@ -15670,7 +24230,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 #if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
   ctorInstanceTemplate->SetNativeDataProperty(
     NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
-    RoaringBitmap32_isEmpty_getter,
+    RoaringBitmap64_isEmpty_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::PropertyAttribute)(v8::ReadOnly),
@@ -15678,7 +24238,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 
   ctorInstanceTemplate->SetNativeDataProperty(
     NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
-    RoaringBitmap32_size_getter,
+    RoaringBitmap64_size_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::PropertyAttribute)(v8::ReadOnly),
@@ -15686,7 +24246,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 
   ctorInstanceTemplate->SetNativeDataProperty(
     NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
-    RoaringBitmap32_isFrozen_getter,
+    RoaringBitmap64_isFrozen_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::PropertyAttribute)(v8::ReadOnly),
@@ -15694,7 +24254,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 #else
   ctorInstanceTemplate->SetAccessor(
     NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
-    RoaringBitmap32_isEmpty_getter,
+    RoaringBitmap64_isEmpty_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::AccessControl)(v8::ALL_CAN_READ),
@@ -15702,7 +24262,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 
   ctorInstanceTemplate->SetAccessor(
     NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
-    RoaringBitmap32_size_getter,
+    RoaringBitmap64_size_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::AccessControl)(v8::ALL_CAN_READ),
@@ -15710,168 +24270,157 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 
   ctorInstanceTemplate->SetAccessor(
     NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
-    RoaringBitmap32_isFrozen_getter,
+    RoaringBitmap64_isFrozen_getter,
     nullptr,
     v8::Local<v8::Value>(),
     (v8::AccessControl)(v8::ALL_CAN_READ),
     (v8::PropertyAttribute)(v8::ReadOnly));
 #endif
 
-  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmap32_add);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmap32_addMany);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "addRange", RoaringBitmap32_addRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "andCardinality", RoaringBitmap32_andCardinality);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlace", RoaringBitmap32_andInPlace);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotCardinality", RoaringBitmap32_andNotCardinality);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlace", RoaringBitmap32_removeMany);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "asReadonlyView", RoaringBitmap32_asReadonlyView);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "at", RoaringBitmap32_at);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap32_clear);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "clone", RoaringBitmap32_clone);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "contains", RoaringBitmap32_has);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "containsRange", RoaringBitmap32_hasRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "contentToString", RoaringBitmap32_contentToString);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "copyFrom", RoaringBitmap32_copyFrom);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmap32_remove);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "deserialize", RoaringBitmap32_deserialize);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "flipRange", RoaringBitmap32_flipRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "freeze", RoaringBitmap32_freeze);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "getSerializationSizeInBytes", RoaringBitmap32_getSerializationSizeInBytes);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmap32_has);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "hasRange", RoaringBitmap32_hasRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "includes", RoaringBitmap32_has);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "indexOf", RoaringBitmap32_indexOf);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "intersects", RoaringBitmap32_intersects);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "intersectsWithRange", RoaringBitmap32_intersectsWithRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "isEqual", RoaringBitmap32_isEqual);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "isStrictSubset", RoaringBitmap32_isStrictSubset);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "isStrictSuperset", RoaringBitmap32_isStrictSuperset);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "isSubset", RoaringBitmap32_isSubset);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "isSuperset", RoaringBitmap32_isSuperset);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "jaccardIndex", RoaringBitmap32_jaccardIndex);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "join", RoaringBitmap32_join);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "lastIndexOf", RoaringBitmap32_lastIndexOf);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "maximum", RoaringBitmap32_maximum);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "minimum", RoaringBitmap32_minimum);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "orCardinality", RoaringBitmap32_orCardinality);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlace", RoaringBitmap32_addMany);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "pop", RoaringBitmap32_pop);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeCardinality", RoaringBitmap32_rangeCardinality);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeUint32Array", RoaringBitmap32_rangeUint32Array);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "rank", RoaringBitmap32_rank);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmap32_remove);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "removeMany", RoaringBitmap32_removeMany);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRange", RoaringBitmap32_removeRange);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRunCompression", RoaringBitmap32_removeRunCompression);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "runOptimize", RoaringBitmap32_runOptimize);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "select", RoaringBitmap32_select);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "serialize", RoaringBitmap32_serialize);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "serializeAsync", RoaringBitmap32_serializeAsync);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "serializeFileAsync", RoaringBitmap32_serializeFileAsync);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "shift", RoaringBitmap32_shift);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "shrinkToFit", RoaringBitmap32_shrinkToFit);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "statistics", RoaringBitmap32_statistics);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toArray", RoaringBitmap32_toArray);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toReversed", RoaringBitmap32_toReversed);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toSet", RoaringBitmap32_toSet);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toString", RoaringBitmap32_toString);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toUint32Array", RoaringBitmap32_toUint32Array);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "toUint32ArrayAsync", RoaringBitmap32_toUint32ArrayAsync);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "tryAdd", RoaringBitmap32_tryAdd);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "xorCardinality", RoaringBitmap32_xorCardinality);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlace", RoaringBitmap32_xorInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmap64_add);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmap64_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addRange", RoaringBitmap64_addRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andCardinality", RoaringBitmap64_andCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::AND>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotCardinality", RoaringBitmap64_andNotCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlace", RoaringBitmap64_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap64_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clone", RoaringBitmap64_clone);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmap64_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "flipRange", RoaringBitmap64_flipRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "freeze", RoaringBitmap64_freeze);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "getSerializationSizeInBytes", RoaringBitmap64_getSerializationSizeInBytes);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmap64_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasRange", RoaringBitmap64_hasRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "includes", RoaringBitmap64_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "intersects", RoaringBitmap64_intersects);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isEqual", RoaringBitmap64_isEqual);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSubset", RoaringBitmap64_isSubset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSuperset", RoaringBitmap64_isSuperset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "maximum", RoaringBitmap64_maximum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "minimum", RoaringBitmap64_minimum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orCardinality", RoaringBitmap64_orCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::OR>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeCardinality", RoaringBitmap64_rangeCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rank", RoaringBitmap64_rank);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmap64_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeMany", RoaringBitmap64_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRange", RoaringBitmap64_removeRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "runOptimize", RoaringBitmap64_runOptimize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "select", RoaringBitmap64_select);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "serialize", RoaringBitmap64_serialize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "shrinkToFit", RoaringBitmap64_shrinkToFit);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toArray", RoaringBitmap64_toArray);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toBigUint64Array", RoaringBitmap64_toBigUint64Array);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toString", RoaringBitmap64_toString);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "tryAdd", RoaringBitmap64_tryAdd);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorCardinality", RoaringBitmap64_xorCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::XOR>);
 
   auto ctorFunction = ctor->GetFunction(context).ToLocalChecked();
   auto ctorObject = ctorFunction->ToObject(context).ToLocalChecked();
 
   ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
-  ctor->PrototypeTemplate()->Set(isolate, "CRoaringVersion", versionString);
 
-  addonData->setMethod(ctorObject, "addOffset", RoaringBitmap32_addOffsetStatic);
-  addonData->setMethod(ctorObject, "and", RoaringBitmap32_andStatic);
-  addonData->setMethod(ctorObject, "andNot", RoaringBitmap32_andNotStatic);
+  addonData->setMethod(ctorObject, "and", RoaringBitmap64_opStatic<RoaringBitmap64Operation::AND>);
+  addonData->setMethod(ctorObject, "andNot", RoaringBitmap64_opStatic<RoaringBitmap64Operation::ANDNOT>);
 
   v8utils::defineHiddenField(isolate, ctorObject, "default", ctorFunction);
 
-  addonData->setMethod(ctorObject, "deserialize", RoaringBitmap32_deserializeStatic);
-  addonData->setMethod(ctorObject, "deserializeAsync", RoaringBitmap32_deserializeAsyncStatic);
-  addonData->setMethod(ctorObject, "deserializeFile", RoaringBitmap32_deserializeFileStatic);
-  addonData->setMethod(ctorObject, "deserializeFileAsync", RoaringBitmap32_deserializeFileAsyncStatic);
-  addonData->setMethod(ctorObject, "deserializeParallelAsync", RoaringBitmap32_deserializeParallelStaticAsync);
+  addonData->setMethod(ctorObject, "deserialize", RoaringBitmap64_deserializeStatic);
 
   ignoreMaybeResult(
     ctorObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized), ctorFunction));
 
-  addonData->setMethod(ctorObject, "fromArrayAsync", RoaringBitmap32_fromArrayStaticAsync);
-  addonData->setMethod(ctorObject, "fromRange", RoaringBitmap32_fromRangeStatic);
-  addonData->setMethod(ctorObject, "getInstancesCount", RoaringBitmap32_getInstanceCountStatic);
-  addonData->setMethod(ctorObject, "of", RoaringBitmap32_ofStatic);
-  addonData->setMethod(ctorObject, "or", RoaringBitmap32_orStatic);
-  addonData->setMethod(ctorObject, "orMany", RoaringBitmap32_orManyStatic);
-  addonData->setMethod(ctorObject, "swap", RoaringBitmap32_swapStatic);
-  addonData->setMethod(ctorObject, "unsafeFrozenView", RoaringBitmap32_unsafeFrozenViewStatic);
-  addonData->setMethod(ctorObject, "xor", RoaringBitmap32_xorStatic);
-  addonData->setMethod(ctorObject, "xorMany", RoaringBitmap32_xorManyStatic);
-
-  v8utils::defineReadonlyField(isolate, ctorObject, "CRoaringVersion", versionString);
-  v8utils::defineReadonlyField(isolate, exports, "CRoaringVersion", versionString);
+  addonData->setMethod(ctorObject, "getInstancesCount", RoaringBitmap64_getInstanceCountStatic);
+  addonData->setMethod(ctorObject, "of", RoaringBitmap64_ofStatic);
+  addonData->setMethod(ctorObject, "or", RoaringBitmap64_opStatic<RoaringBitmap64Operation::OR>);
+  addonData->setMethod(ctorObject, "unsafeFrozenView", RoaringBitmap64_unsafeFrozenViewStatic);
+  addonData->setMethod(ctorObject, "xor", RoaringBitmap64_opStatic<RoaringBitmap64Operation::XOR>);
 
   v8utils::defineHiddenField(isolate, ctorObject, className, ctorFunction);
 
   ignoreMaybeResult(exports->Set(context, className, ctorFunction));
 
-  addonData->RoaringBitmap32_constructor.Reset(isolate, ctorFunction);
+  addonData->RoaringBitmap64_constructor.Reset(isolate, ctorFunction);
 }
 
-#line 1 "src/cpp/RoaringBitmap32BufferedIterator.h"
-#ifndef ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
-#define ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
+#endif  // ROARING_NODE_ROARING_BITMAP_64_MAIN_
 
-#line 5 "src/cpp/RoaringBitmap32BufferedIterator.h"
+#line 1 "src/cpp/RoaringBitmap64BufferedIterator.h"
+#ifndef ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
+#define ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
 
-class RoaringBitmap32BufferedIterator final : public ObjectWrap {
- public:
-  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152490000;
+#line 5 "src/cpp/RoaringBitmap64BufferedIterator.h"
 
-  enum { allocatedMemoryDelta = 1024 };
+class RoaringBitmap64BufferedIterator final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F41524A0000;
 
   roaring_uint32_iterator_t it;
   bool reversed;
-  RoaringBitmap32 * bitmapInstance;
+  uint32_t bucketIndex;
+  RoaringBitmap64 * bitmapInstance;
   int64_t bitmapVersion;
-  v8utils::TypedArrayContent<uint32_t> bufferContent;
+  v8utils::TypedArrayContent<uint64_t> bufferContent;
 
   v8::Global<v8::Object> bitmap;
   v8::Global<v8::Object> persistent;
 
-  explicit RoaringBitmap32BufferedIterator(AddonData * addonData, bool reversed) :
-    ObjectWrap(addonData), reversed(reversed), bitmapInstance(nullptr) {
+  explicit RoaringBitmap64BufferedIterator(AddonData * addonData, bool reversed) :
+    ObjectWrap(addonData), reversed(reversed), bucketIndex(0), bitmapInstance(nullptr), bitmapVersion(0) {
     this->it.parent = nullptr;
     this->it.has_value = false;
-    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32BufferedIterator));
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap64BufferedIterator));
   }
 
-  ~RoaringBitmap32BufferedIterator() {
+  ~RoaringBitmap64BufferedIterator() {
     this->destroy();
-    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32BufferedIterator));
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap64BufferedIterator));
+  }
+
+  /** Positions the 32 bit iterator on the current bucket, skipping to the next bucket when one is exhausted. */
+  inline bool _seekBucket() {
+    const RoaringBitmap64Buckets & buckets = this->bitmapInstance->buckets;
+    while (!this->it.has_value) {
+      if (this->it.parent != nullptr) {
+        if (this->reversed) {
+          if (this->bucketIndex == 0) {
+            return false;
+          }
+          --this->bucketIndex;
+        } else {
+          ++this->bucketIndex;
+        }
+      }
+      if (this->bucketIndex >= buckets.count) {
+        return false;
+      }
+      if (this->reversed) {
+        roaring_iterator_init_last(buckets.items[this->bucketIndex].bitmap, &this->it);
+      } else {
+        roaring_iterator_init(buckets.items[this->bucketIndex].bitmap, &this->it);
+      }
+    }
+    return true;
   }
 
   inline uint32_t _fill() {
-    uint32_t n;
-    if (this->reversed) {
-      size_t size = this->bufferContent.length;
-      auto * data = this->bufferContent.data;
-      for (n = 0; n < size && this->it.has_value; ++n) {
-        data[n] = this->it.current_value;
-        roaring_uint32_iterator_previous(&this->it);
+    const size_t size = this->bufferContent.length;
+    uint64_t * data = this->bufferContent.data;
+    uint32_t n = 0;
+    uint32_t lows[256];
+    while (n < size && this->bitmapInstance != nullptr && this->_seekBucket()) {
+      const uint64_t base = (uint64_t)this->bitmapInstance->buckets.items[this->bucketIndex].high << 32;
+      const uint32_t toRead = (uint32_t)std::min<size_t>(sizeof(lows) / sizeof(lows[0]), size - n);
+      const uint32_t read = this->reversed ? roaringIteratorReadReverse(&this->it, lows, toRead)
+                                           : roaring_uint32_iterator_read(&this->it, lows, toRead);
+      for (uint32_t k = 0; k < read; ++k) {
+        data[n++] = base | lows[k];
       }
-    } else {
-      n = roaring_uint32_iterator_read(&this->it, this->bufferContent.data, this->bufferContent.length);
     }
     if (n == 0) {
-      this->bitmapInstance = nullptr;
-      this->bufferContent.reset();
-      this->bitmap.Reset();
+      this->close();
     }
     return n;
   }
@@ -15894,157 +24443,148 @@ class RoaringBitmap32BufferedIterator final : public ObjectWrap {
   }
 };
 
-void RoaringBitmap32BufferedIterator_fill(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64BufferedIterator_fill(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
-  RoaringBitmap32BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), isolate);
+  RoaringBitmap64BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap64BufferedIterator>(info.This(), isolate);
 
-  RoaringBitmap32 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
+  RoaringBitmap64 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
 
   if (bitmapInstance == nullptr) {
     return info.GetReturnValue().Set(0U);
   }
 
   if (bitmapInstance->getVersion() != instance->bitmapVersion) {
-    return v8utils::throwError(isolate, "RoaringBitmap32 iterator - bitmap changed while iterating");
+    return v8utils::throwError(isolate, "RoaringBitmap64 iterator - bitmap changed while iterating");
   }
 
   return info.GetReturnValue().Set(instance->_fill());
 }
 
-void RoaringBitmap32BufferedIterator_close(const v8::FunctionCallbackInfo<v8::Value> & info) {
-  RoaringBitmap32BufferedIterator * instance =
-    ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), info.GetIsolate());
+void RoaringBitmap64BufferedIterator_close(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap64BufferedIterator * instance =
+    ObjectWrap::TryUnwrap<RoaringBitmap64BufferedIterator>(info.This(), info.GetIsolate());
   if (instance == nullptr) {
     return;
   }
   instance->close();
 }
 
-void RoaringBitmap32BufferedIterator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32BufferedIterator> const & info) {
-  RoaringBitmap32BufferedIterator * p = info.GetParameter();
+void RoaringBitmap64BufferedIterator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap64BufferedIterator> const & info) {
+  RoaringBitmap64BufferedIterator * p = info.GetParameter();
   if (p != nullptr) {
-    p->~RoaringBitmap32BufferedIterator();
+    p->~RoaringBitmap64BufferedIterator();
     bare_aligned_free(p);
   }
 }
 
-void RoaringBitmap32BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+void RoaringBitmap64BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
   if (!info.IsConstructCall()) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs to be called with new");
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - needs to be called with new");
   }
 
   auto holder = info.This();
 
   if (info.Length() < 2) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs 2 or 3 arguments");
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - needs 2 or 3 arguments");
   }
 
   AddonData * addonData = AddonData::get(info);
   if (addonData == nullptr) {
-    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT_64);
   }
 
-  RoaringBitmap32 * bitmapInstance = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+  RoaringBitmap64 * bitmapInstance = ObjectWrap::TryUnwrap<RoaringBitmap64>(info[0], isolate);
   if (bitmapInstance == nullptr) {
     return v8utils::throwTypeError(
-      isolate, "RoaringBitmap32BufferedIterator::ctor - first argument must be of type RoaringBitmap32");
+      isolate, "RoaringBitmap64BufferedIterator::ctor - first argument must be of type RoaringBitmap64");
   }
 
   bool reversed = info.Length() > 2 && info[2]->BooleanValue(isolate);
 
   auto bufferObject = info[1];
 
-  if (!bufferObject->IsUint32Array()) {
+  if (!bufferObject->IsBigUint64Array()) {
     return v8utils::throwTypeError(
-      isolate, "RoaringBitmap32BufferedIterator::ctor - second argument must be of type Uint32Array");
+      isolate, "RoaringBitmap64BufferedIterator::ctor - second argument must be of type BigUint64Array");
   }
 
-  const v8utils::TypedArrayContent<uint32_t> bufferContent(isolate, bufferObject);
+  const v8utils::TypedArrayContent<uint64_t> bufferContent(isolate, bufferObject);
   if (!bufferContent.data || bufferContent.length < 1) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - invalid Uint32Array buffer");
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - invalid BigUint64Array buffer");
   }
 
-  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32BufferedIterator));
-  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32BufferedIterator(addonData, reversed) : nullptr;
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap64BufferedIterator));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap64BufferedIterator(addonData, reversed) : nullptr;
   if (instance == nullptr) {
-    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - allocation failed");
   }
 
   int indices[2] = {0, 1};
-  void * values[2] = {instance, (void *)(RoaringBitmap32BufferedIterator::OBJECT_TOKEN)};
+  void * values[2] = {instance, (void *)(RoaringBitmap64BufferedIterator::OBJECT_TOKEN)};
   holder->SetAlignedPointerInInternalFields(2, indices, values);
 
   info.GetReturnValue().Set(holder);
 
   instance->persistent.Reset(isolate, holder);
-  instance->persistent.SetWeak(instance, RoaringBitmap32BufferedIterator_WeakCallback, v8::WeakCallbackType::kParameter);
+  instance->persistent.SetWeak(instance, RoaringBitmap64BufferedIterator_WeakCallback, v8::WeakCallbackType::kParameter);
 
   auto context = isolate->GetCurrentContext();
 
   instance->bitmapInstance = bitmapInstance;
   instance->bitmapVersion = bitmapInstance->getVersion();
 
-  auto a0Maybe = info[0]->ToObject(context);
   v8::Local<v8::Object> a0;
-  if (!a0Maybe.ToLocal(&a0)) {
-    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
+  if (!info[0]->ToObject(context).ToLocal(&a0)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - allocation failed");
   }
   instance->bitmap.Reset(isolate, a0);
 
-  auto a1Maybe = bufferObject->ToObject(context);
-  v8::Local<v8::Object> a1;
-  if (!a1Maybe.ToLocal(&a1)) {
-    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - allocation failed");
-  }
-
   instance->bufferContent.set(isolate, bufferObject);
 
-  if (reversed) {
-    roaring_iterator_init_last(bitmapInstance->roaring, &instance->it);
-  } else {
-    roaring_iterator_init(bitmapInstance->roaring, &instance->it);
+  if (reversed && bitmapInstance->buckets.count != 0) {
+    instance->bucketIndex = bitmapInstance->buckets.count - 1;
   }
 
   uint32_t n = instance->_fill();
 
   if (holder->Set(context, addonData->strings.n.Get(isolate), v8::Uint32::NewFromUnsigned(isolate, n)).IsNothing()) {
-    return v8utils::throwError(isolate, "RoaringBitmap32BufferedIterator::ctor - instantiation failed");
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - instantiation failed");
   }
 }
 
-void RoaringBitmap32BufferedIterator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+void RoaringBitmap64BufferedIterator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
   v8::Isolate * isolate = addonData->isolate;
 
-  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32BufferedIterator", v8::NewStringType::kInternalized);
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap64BufferedIterator", v8::NewStringType::kInternalized);
 
   v8::Local<v8::FunctionTemplate> ctor =
-    v8::FunctionTemplate::New(isolate, RoaringBitmap32BufferedIterator_New, addonData->external.Get(isolate));
+    v8::FunctionTemplate::New(isolate, RoaringBitmap64BufferedIterator_New, addonData->external.Get(isolate));
 
   ctor->SetClassName(className);
   ctor->InstanceTemplate()->SetInternalFieldCount(2);
 
-  addonData->RoaringBitmap32BufferedIterator_constructorTemplate.Reset(isolate, ctor);
+  addonData->RoaringBitmap64BufferedIterator_constructorTemplate.Reset(isolate, ctor);
 
-  NODE_SET_PROTOTYPE_METHOD(ctor, "fill", RoaringBitmap32BufferedIterator_fill);
-  NODE_SET_PROTOTYPE_METHOD(ctor, "close", RoaringBitmap32BufferedIterator_close);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "fill", RoaringBitmap64BufferedIterator_fill);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "close", RoaringBitmap64BufferedIterator_close);
 
   auto ctorFunctionMaybe = ctor->GetFunction(isolate->GetCurrentContext());
   v8::Local<v8::Function> ctorFunction;
 
   if (!ctorFunctionMaybe.ToLocal(&ctorFunction)) {
-    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32BufferedIterator");
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap64BufferedIterator");
   }
 
-  addonData->RoaringBitmap32BufferedIterator_constructor.Reset(isolate, ctorFunction);
-  v8utils::defineHiddenField(isolate, exports, "RoaringBitmap32BufferedIterator", ctorFunction);
+  addonData->RoaringBitmap64BufferedIterator_constructor.Reset(isolate, ctorFunction);
+  v8utils::defineHiddenField(isolate, exports, "RoaringBitmap64BufferedIterator", ctorFunction);
 }
 
-#endif  // ROARING_NODE_ROARING_BITMAP_32_BUFFERED_ITERATOR_
+#endif  // ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
 
-#line 4 "src/cpp/main.cpp"
+#line 11 "src/cpp/main.cpp"
 
 using namespace v8;
 
@@ -16073,6 +24613,13 @@ void InitRoaringNode(Local<Object> exports) {
   AlignedBuffers_Init(exports, addonData);
   RoaringBitmap32_Init(exports, addonData);
   RoaringBitmap32BufferedIterator_Init(exports, addonData);
+  RoaringBitmap32BulkWriter_Init(exports, addonData);
+  RoaringBitmap32Accumulator_Init(exports, addonData);
+  RoaringBitmap32Pack_Init(exports, addonData);
+  RoaringBitmapIndex_Init(exports, addonData);
+  RoaringBitmapSliced32_Init(exports, addonData);
+  RoaringBitmap64_Init(exports, addonData);
+  RoaringBitmap64BufferedIterator_Init(exports, addonData);
 
   addonData->setMethod(exports, "getRoaringUsedMemory", getRoaringUsedMemory);
 
@@ -31231,4 +39778,4 @@ bool ra_portable_deserialize(roaring_array_t *answer, const char *buf,
 #undef printf
 #undef fprintf
 
-#line 41 "src/cpp/main.cpp"
+#line 55 "src/cpp/main.cpp"
@@ -0,0 +1,345 @@
+#ifndef ROARING_NODE_ROARINGBITMAP32_EVALUATE_
+#define ROARING_NODE_ROARINGBITMAP32_EVALUATE_
+
+#include "RoaringBitmap32.h"
+#include "async-workers.h"
+
+enum class RoaringExpressionOperation { LEAF, OR, AND, AND_NOT, XOR };
+
+struct RoaringExpressionNode {
+  RoaringExpressionOperation op;
+  /** The bitmap of a leaf. */
+  const roaring_bitmap_t * bitmap;
+  /** Upper bound of the cardinality of the result, used to order intersections and to skip empty operands. */
+  uint64_t estimate;
+  /** Range of the operands in RoaringExpression::operands. */
+  uint32_t firstOperand;
+  uint32_t operandsCount;
+};
+
+/**
+ * A boolean expression over bitmaps, parsed from nested arrays: [operation, ...operands], where an operand is a
+ * RoaringBitmap32 or another expression. Operations are "or", "and", "andNot" (the first operand minus all the others)
+ * and "xor".
+ *
+ * The expression is evaluated natively in a single call. Intermediate results are plain roaring bitmaps, leaves are
+ * never copied unless they are the result. Intersections are computed smallest first and stop as soon as they are
+ * empty, unions are lazy and repaired once at the end.
+ */
+class RoaringExpression final {
+ public:
+  /** Limits the recursion, it also rejects arrays that contain themselves. */
+  static const constexpr uint32_t MAX_DEPTH = 512;
+  static const constexpr uint64_t MAX_CARDINALITY = (uint64_t)1 << 32;
+
+  std::vector<RoaringExpressionNode> nodes;
+  std::vector<uint32_t> operands;
+  std::vector<RoaringBitmap32 *> leaves;
+  uint32_t root = 0;
+
+  RoaringExpression() = default;
+  RoaringExpression(const RoaringExpression &) = delete;
+  RoaringExpression & operator=(const RoaringExpression &) = delete;
+
+  ~RoaringExpression() { this->endFreeze(); }
+
+  /** Parses the expression. Returns an error message, or nullptr on success. */
+  const char * parse(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+    const char * error = this->parseNode(isolate, value, 0, this->root);
+    if (error != nullptr) {
+      this->nodes.clear();
+      this->operands.clear();
+      this->leaves.clear();
+    }
+    return error;
+  }
+
+  /** Freezes the operands, so they cannot be modified while the expression is evaluated in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      for (RoaringBitmap32 * leaf : this->leaves) {
+        owner(leaf)->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      for (RoaringBitmap32 * leaf : this->leaves) {
+        owner(leaf)->endFreeze();
+      }
+    }
+  }
+
+  /** Evaluates the expression into a new bitmap. Returns nullptr if an allocation failed. */
+  roaring_bitmap_t * evaluate() const {
+    const roaring_bitmap_t * view;
+    roaring_bitmap_t * owned;
+    if (!this->evaluateNode(this->root, view, owned)) {
+      return nullptr;
+    }
+    return owned != nullptr ? owned : roaring_bitmap_copy(view);
+  }
+
+ private:
+  bool frozen = false;
+
+  static RoaringBitmap32 * owner(RoaringBitmap32 * bitmap) {
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  const char * parseNode(v8::Isolate * isolate, v8::Local<v8::Value> value, uint32_t depth, uint32_t & index) {
+    if (depth >= MAX_DEPTH) {
+      return "RoaringBitmap32::evaluate - expression is too deep";
+    }
+
+    if (value.IsEmpty()) {
+      return "RoaringBitmap32::evaluate - an operand must be a RoaringBitmap32 or an array [operation, ...operands]";
+    }
+
+    RoaringBitmap32 * leaf = ObjectWrap::TryUnwrap<RoaringBitmap32>(value, isolate);
+    if (leaf != nullptr) {
+      index = (uint32_t)this->nodes.size();
+      this->nodes.push_back({RoaringExpressionOperation::LEAF, leaf->roaring, leaf->getSize(), 0, 0});
+      this->leaves.push_back(leaf);
+      return nullptr;
+    }
+
+    if (!value->IsArray()) {
+      return "RoaringBitmap32::evaluate - an operand must be a RoaringBitmap32 or an array [operation, ...operands]";
+    }
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+    const uint32_t length = array->Length();
+    v8::Local<v8::Value> opValue;
+    if (length == 0 || !array->Get(context, 0).ToLocal(&opValue) || !opValue->IsString()) {
+      return "RoaringBitmap32::evaluate - an expression must start with the operation";
+    }
+
+    RoaringExpressionOperation op;
+    v8::String::Utf8Value opString(isolate, opValue);
+    if (strcmp(*opString, "or") == 0) {
+      op = RoaringExpressionOperation::OR;
+    } else if (strcmp(*opString, "and") == 0) {
+      op = RoaringExpressionOperation::AND;
+    } else if (strcmp(*opString, "andNot") == 0) {
+      op = RoaringExpressionOperation::AND_NOT;
+    } else if (strcmp(*opString, "xor") == 0) {
+      op = RoaringExpressionOperation::XOR;
+    } else {
+      return "RoaringBitmap32::evaluate - operation must be one of or, and, andNot, xor";
+    }
+
+    std::vector<uint32_t> children;
+    children.reserve(length - 1);
+    for (uint32_t i = 1; i < length; ++i) {
+      v8::Local<v8::Value> item;
+      if (!array->Get(context, i).ToLocal(&item)) {
+        return "RoaringBitmap32::evaluate - failed to read the expression";
+      }
+      uint32_t child;
+      const char * error = this->parseNode(isolate, item, depth + 1, child);
+      if (error != nullptr) {
+        return error;
+      }
+      children.push_back(child);
+    }
+
+    uint64_t estimate = 0;
+    if (!children.empty()) {
+      switch (op) {
+        case RoaringExpressionOperation::AND:
+          // Smallest first: the running intersection never grows and becomes empty sooner.
+          std::stable_sort(children.begin(), children.end(), [this](uint32_t a, uint32_t b) {
+            return this->nodes[a].estimate < this->nodes[b].estimate;
+          });
+          estimate = this->nodes[children[0]].estimate;
+          break;
+        case RoaringExpressionOperation::AND_NOT: estimate = this->nodes[children[0]].estimate; break;
+        default:
+          for (uint32_t child : children) {
+            estimate += this->nodes[child].estimate;
+          }
+          estimate = std::min(estimate, MAX_CARDINALITY);
+          break;
+      }
+    }
+
+    index = (uint32_t)this->nodes.size();
+    this->nodes.push_back({op, nullptr, estimate, (uint32_t)this->operands.size(), (uint32_t)children.size()});
+    this->operands.insert(this->operands.end(), children.begin(), children.end());
+    return nullptr;
+  }
+
+  /**
+   * Evaluates a node. On success, view is the result; owned is the same bitmap if it was allocated by the evaluation
+   * and must be freed by the caller, or nullptr if view is a leaf.
+   */
+  bool evaluateNode(uint32_t index, const roaring_bitmap_t *& view, roaring_bitmap_t *& owned) const {
+    const RoaringExpressionNode & node = this->nodes[index];
+    view = nullptr;
+    owned = nullptr;
+
+    if (node.op == RoaringExpressionOperation::LEAF) {
+      view = node.bitmap;
+      return true;
+    }
+
+    if (node.operandsCount == 0 || node.estimate == 0) {
+      view = owned = roaring_bitmap_create();
+      return owned != nullptr;
+    }
+
+    const uint32_t * children = this->operands.data() + node.firstOperand;
+    if (!this->evaluateNode(children[0], view, owned)) {
+      return false;
+    }
+
+    roaring_bitmap_t * result = owned;
+    bool lazy = false;
+    for (uint32_t i = 1; i < node.operandsCount; ++i) {
+      const bool resultEmpty = roaring_bitmap_is_empty(view);
+      if (resultEmpty && (node.op == RoaringExpressionOperation::AND || node.op == RoaringExpressionOperation::AND_NOT)) {
+        break;
+      }
+      const RoaringExpressionNode & child = this->nodes[children[i]];
+      if (child.estimate == 0 && node.op != RoaringExpressionOperation::AND) {
+        continue;  // An empty operand does not change a union, a difference or a symmetric difference.
+      }
+
+      const roaring_bitmap_t * operandView;
+      roaring_bitmap_t * operandOwned;
+      if (!this->evaluateNode(children[i], operandView, operandOwned)) {
+        roaring_bitmap_free(result);
+        return false;
+      }
+
+      if (result == nullptr) {
+        // The first operand is a leaf, the first operation allocates the result.
+        switch (node.op) {
+          case RoaringExpressionOperation::OR:
+            result = roaring_bitmap_lazy_or(view, operandView, false);
+            lazy = true;
+            break;
+          case RoaringExpressionOperation::AND: result = roaring_bitmap_and(view, operandView); break;
+          case RoaringExpressionOperation::AND_NOT: result = roaring_bitmap_andnot(view, operandView); break;
+          default: result = roaring_bitmap_xor(view, operandView); break;
+        }
+      } else {
+        switch (node.op) {
+          case RoaringExpressionOperation::OR:
+            roaring_bitmap_lazy_or_inplace(result, operandView, false);
+            lazy = true;
+            break;
+          case RoaringExpressionOperation::AND: roaring_bitmap_and_inplace(result, operandView); break;
+          case RoaringExpressionOperation::AND_NOT: roaring_bitmap_andnot_inplace(result, operandView); break;
+          default: roaring_bitmap_xor_inplace(result, operandView); break;
+        }
+      }
+      roaring_bitmap_free(operandOwned);
+      if (result == nullptr) {
+        return false;
+      }
+      view = result;
+    }
+
+    if (lazy) {
+      roaring_bitmap_repair_after_lazy(result);
+    }
+    owned = result;
+    return true;
+  }
+};
+
+class EvaluateWorker final : public RoaringBitmap32FactoryAsyncWorker {
+ public:
+  RoaringBitmap32Pins pins;
+  RoaringExpression expression;
+
+  explicit EvaluateWorker(v8::Isolate * isolate, AddonData * addonData) :
+    RoaringBitmap32FactoryAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(EvaluateWorker));
+  }
+
+  virtual ~EvaluateWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(EvaluateWorker)); }
+
+ protected:
+  void before() final { this->expression.beginFreeze(); }
+
+  void work() final {
+    roaring_bitmap_t * result = this->expression.evaluate();
+    if (result == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32::evaluateAsync - failed to allocate memory"));
+    }
+    this->bitmap = result;
+  }
+
+  void finally() final { this->expression.endFreeze(); }
+};
+
+void RoaringBitmap32_evaluateStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringExpression expression;
+  const char * error = expression.parse(isolate, info.Length() > 0 ? info[0] : v8::Undefined(isolate).As<v8::Value>());
+  if (error != nullptr) {
+    return v8utils::throwTypeError(isolate, error);
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  roaring_bitmap_t * r = expression.evaluate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::evaluate - failed to allocate memory");
+  }
+  self->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_evaluateStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new EvaluateWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  const char * error = worker->expression.parse(isolate, length > 0 ? info[0] : v8::Undefined(isolate).As<v8::Value>());
+  if (error != nullptr) {
+    worker->setError(WorkerError(error));
+  } else {
+    for (RoaringBitmap32 * leaf : worker->expression.leaves) {
+      worker->pins.pin(isolate, leaf);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_EVALUATE_
@@ -7,6 +7,9 @@
 #include "RoaringBitmap32-static-ops.h"
 #include "RoaringBitmap32-serialization.h"
 #include "RoaringBitmap32-ranges.h"
+#include "RoaringBitmap32-pairwise.h"
+#include "RoaringBitmap32-topk.h"
+#include "RoaringBitmap32-evaluate.h"
 
 void RoaringBitmap32_copyFrom(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
@@ -21,7 +24,6 @@ void RoaringBitmap32_copyFrom(const v8::FunctionCallbackInfo<v8::Value> & info)
     return v8utils::throwError(
       isolate, "RoaringBitmap32::copyFrom expects a RoaringBitmap32, an Uint32Array or an Iterable");
   }
-  self->invalidate();
   info.GetReturnValue().Set(info.This());
 }
 
@@ -72,6 +74,10 @@ void RoaringBitmap32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
       if (readonlyViewOf == nullptr) {
         return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
       }
+      if (readonlyViewOf->mappedFile != nullptr) {
+        // A mapped bitmap is already readonly, and a view would keep using the mapping after releaseMappedFile.
+        return info.GetReturnValue().Set(info[0]);
+      }
     }
   }
 
@@ -246,6 +252,103 @@ void RoaringBitmap32_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
   }
 }
 
+/**
+ * Parses the (values, output) arguments of hasMany and hasManyAsync.
+ * If the output is not given, a new Uint8Array is created. Returns an error message if the arguments are invalid.
+ */
+const char * RoaringBitmap32_hasManyArguments(
+  const v8::FunctionCallbackInfo<v8::Value> & info,
+  v8utils::TypedArrayContent<uint32_t> & values,
+  v8utils::TypedArrayContent<uint8_t> & output,
+  bool & packed,
+  v8::Local<v8::Value> & result) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (info.Length() < 1 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) || !values.set(isolate, info[0])) {
+    return "RoaringBitmap32::hasMany - values must be a Uint32Array or an Int32Array";
+  }
+
+  const size_t count = values.length;
+  packed = false;
+  if (info.Length() >= 2 && !info[1]->IsUndefined() && !info[1]->IsFunction()) {
+    packed = info[1]->IsUint32Array();
+    if (!(packed || info[1]->IsUint8Array()) || !output.set(isolate, info[1])) {
+      return "RoaringBitmap32::hasMany - output must be a Uint8Array or a Uint32Array";
+    }
+    if (output.length < (packed ? ((count + 31) / 32) * sizeof(uint32_t) : count)) {
+      return "RoaringBitmap32::hasMany - output array is too small";
+    }
+    result = info[1];
+    return nullptr;
+  }
+
+  v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, count);
+  v8::Local<v8::Uint8Array> typedArray;
+  if (arrayBuffer.IsEmpty() || (typedArray = v8::Uint8Array::New(arrayBuffer, 0, count)).IsEmpty()) {
+    return "RoaringBitmap32::hasMany - failed to allocate memory";
+  }
+  if (count != 0 && !output.set(isolate, typedArray)) {
+    return "RoaringBitmap32::hasMany - failed to allocate memory";
+  }
+  result = typedArray;
+  return nullptr;
+}
+
+void RoaringBitmap32_hasMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8utils::TypedArrayContent<uint32_t> values;
+  v8utils::TypedArrayContent<uint8_t> output;
+  bool packed;
+  v8::Local<v8::Value> result;
+  const char * error = RoaringBitmap32_hasManyArguments(info, values, output, packed, result);
+  if (error != nullptr) {
+    return v8utils::throwTypeError(isolate, error);
+  }
+
+  if (values.length != 0) {
+    if (packed) {
+      roaringHasManyBits(self->roaring, values.data, values.length, (uint32_t *)output.data);
+    } else {
+      roaringHasMany(self->roaring, values.data, values.length, output.data);
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_hasManyAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new HasManyParallelWorker(isolate, self);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::hasManyAsync - failed to allocate async worker");
+  }
+
+  v8::Local<v8::Value> result;
+  const char * error = RoaringBitmap32_hasManyArguments(info, worker->values, worker->output, worker->packed, result);
+  if (error != nullptr) {
+    worker->setError(WorkerError(error));
+  } else {
+    worker->setResult(result);
+  }
+
+  const int length = info.Length();
+  if (length >= 2 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
 void RoaringBitmap32_indexOf(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
   const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
@@ -335,6 +438,81 @@ void RoaringBitmap32_select(const v8::FunctionCallbackInfo<v8::Value> & info) {
   }
 }
 
+/**
+ * Shared implementation of rankMany and selectMany.
+ * The output can be a Float64Array or a Uint32Array, if not given a new Float64Array is created.
+ * selectMany writes the optional third argument for missing ranks, NaN or 0 by default.
+ */
+template <bool SELECT>
+void RoaringBitmap32_positionalMany(const v8::FunctionCallbackInfo<v8::Value> & info, const char * name) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap32 * self = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  v8utils::TypedArrayContent<uint32_t> values;
+  if (info.Length() < 1 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) || !values.set(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, name, " - argument must be a Uint32Array or an Int32Array");
+  }
+  const size_t count = values.length;
+
+  v8::Local<v8::Value> result;
+  bool isFloat64 = true;
+  if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+    isFloat64 = info[1]->IsFloat64Array();
+    if (!isFloat64 && !info[1]->IsUint32Array()) {
+      return v8utils::throwTypeError(isolate, name, " - output must be a Float64Array or a Uint32Array");
+    }
+    if (v8::Local<v8::TypedArray>::Cast(info[1])->Length() < count) {
+      return v8utils::throwTypeError(isolate, name, " - output array is too small");
+    }
+    result = info[1];
+  } else {
+    v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    if (arrayBuffer.IsEmpty()) {
+      return v8utils::throwError(isolate, (std::string(name) + " - failed to allocate memory").c_str());
+    }
+    result = v8::Float64Array::New(arrayBuffer, 0, count);
+  }
+
+  double missing = isFloat64 ? NAN : 0;
+  if (SELECT && info.Length() >= 3 && !info[2]->IsUndefined()) {
+    if (isFloat64 ? !info[2]->IsNumber() : !info[2]->IsUint32()) {
+      return v8utils::throwTypeError(
+        isolate, name, " - missing value must be a number, or an unsigned 32 bit integer for a Uint32Array output");
+    }
+    missing = info[2].As<v8::Number>()->Value();
+  }
+
+  if (count == 0) {
+    return info.GetReturnValue().Set(result);
+  }
+
+  bool ok;
+  if (isFloat64) {
+    v8utils::TypedArrayContent<double> output(isolate, result);
+    ok = SELECT ? roaringSelectMany<double>(self->roaring, values.data, count, output.data, missing)
+                : roaringRankMany<double>(self->roaring, values.data, count, output.data);
+  } else {
+    v8utils::TypedArrayContent<uint32_t> output(isolate, result);
+    ok = SELECT ? roaringSelectMany<uint32_t>(self->roaring, values.data, count, output.data, (uint32_t)missing)
+                : roaringRankMany<uint32_t>(self->roaring, values.data, count, output.data);
+  }
+  if (!ok) {
+    return v8utils::throwError(isolate, (std::string(name) + " - failed to allocate memory").c_str());
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_rankMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_positionalMany<false>(info, "RoaringBitmap32::rankMany");
+}
+
+void RoaringBitmap32_selectMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_positionalMany<true>(info, "RoaringBitmap32::selectMany");
+}
+
 void RoaringBitmap32_removeRunCompression(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
   RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
@@ -346,7 +524,7 @@ void RoaringBitmap32_removeRunCompression(const v8::FunctionCallbackInfo<v8::Val
   }
   bool removed = roaring_bitmap_remove_run_compression(self->roaring);
   if (removed) {
-    self->invalidate();
+    self->invalidateAddingToSize(0);
   }
   info.GetReturnValue().Set(removed);
 }
@@ -360,7 +538,10 @@ void RoaringBitmap32_runOptimize(const v8::FunctionCallbackInfo<v8::Value> & inf
   if (self->isFrozenHard()) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  info.GetReturnValue().Set(roaring_bitmap_run_optimize(self->roaring));
+  bool result = roaring_bitmap_run_optimize(self->roaring);
+  // Containers may have been converted, iterators and bulk writers must not reuse them.
+  self->invalidateAddingToSize(0);
+  info.GetReturnValue().Set(result);
 }
 
 void RoaringBitmap32_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & info) {
@@ -372,7 +553,10 @@ void RoaringBitmap32_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & inf
   if (self->isFrozenHard()) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  info.GetReturnValue().Set((double)roaring_bitmap_shrink_to_fit(self->roaring));
+  size_t result = roaring_bitmap_shrink_to_fit(self->roaring);
+  // Containers may have been reallocated, iterators and bulk writers must not reuse them.
+  self->invalidateAddingToSize(0);
+  info.GetReturnValue().Set((double)result);
 }
 
 void RoaringBitmap32_freeze(const v8::FunctionCallbackInfo<v8::Value> & info) {
@@ -533,12 +717,10 @@ void RoaringBitmap32_swapStatic(const v8::FunctionCallbackInfo<v8::Value> & info
     auto * a_roaring = a->roaring;
     auto a_sizeCache = a->sizeCache;
     a->roaring = b->roaring;
-    a->sizeCache = b->sizeCache;
     b->roaring = a_roaring;
-    b->sizeCache = a_sizeCache;
 
-    a->invalidate();
-    b->invalidate();
+    a->invalidate(b->sizeCache);
+    b->invalidate(a_sizeCache);
   }
 }
 
@@ -818,8 +1000,11 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   NODE_SET_PROTOTYPE_METHOD(ctor, "addRange", RoaringBitmap32_addRange);
   NODE_SET_PROTOTYPE_METHOD(ctor, "andCardinality", RoaringBitmap32_andCardinality);
   NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlace", RoaringBitmap32_andInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlaceAsync", RoaringBitmap32_andInPlaceAsync);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andManyInPlace", RoaringBitmap32_andManyInPlace);
   NODE_SET_PROTOTYPE_METHOD(ctor, "andNotCardinality", RoaringBitmap32_andNotCardinality);
   NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlace", RoaringBitmap32_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlaceAsync", RoaringBitmap32_andNotInPlaceAsync);
   NODE_SET_PROTOTYPE_METHOD(ctor, "asReadonlyView", RoaringBitmap32_asReadonlyView);
   NODE_SET_PROTOTYPE_METHOD(ctor, "at", RoaringBitmap32_at);
   NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap32_clear);
@@ -834,6 +1019,8 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   NODE_SET_PROTOTYPE_METHOD(ctor, "freeze", RoaringBitmap32_freeze);
   NODE_SET_PROTOTYPE_METHOD(ctor, "getSerializationSizeInBytes", RoaringBitmap32_getSerializationSizeInBytes);
   NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmap32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasMany", RoaringBitmap32_hasMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasManyAsync", RoaringBitmap32_hasManyAsync);
   NODE_SET_PROTOTYPE_METHOD(ctor, "hasRange", RoaringBitmap32_hasRange);
   NODE_SET_PROTOTYPE_METHOD(ctor, "includes", RoaringBitmap32_has);
   NODE_SET_PROTOTYPE_METHOD(ctor, "indexOf", RoaringBitmap32_indexOf);
@@ -851,16 +1038,20 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   NODE_SET_PROTOTYPE_METHOD(ctor, "minimum", RoaringBitmap32_minimum);
   NODE_SET_PROTOTYPE_METHOD(ctor, "orCardinality", RoaringBitmap32_orCardinality);
   NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlace", RoaringBitmap32_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlaceAsync", RoaringBitmap32_orInPlaceAsync);
   NODE_SET_PROTOTYPE_METHOD(ctor, "pop", RoaringBitmap32_pop);
   NODE_SET_PROTOTYPE_METHOD(ctor, "rangeCardinality", RoaringBitmap32_rangeCardinality);
   NODE_SET_PROTOTYPE_METHOD(ctor, "rangeUint32Array", RoaringBitmap32_rangeUint32Array);
   NODE_SET_PROTOTYPE_METHOD(ctor, "rank", RoaringBitmap32_rank);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rankMany", RoaringBitmap32_rankMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "releaseMappedFile", RoaringBitmap32_releaseMappedFile);
   NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmap32_remove);
   NODE_SET_PROTOTYPE_METHOD(ctor, "removeMany", RoaringBitmap32_removeMany);
   NODE_SET_PROTOTYPE_METHOD(ctor, "removeRange", RoaringBitmap32_removeRange);
   NODE_SET_PROTOTYPE_METHOD(ctor, "removeRunCompression", RoaringBitmap32_removeRunCompression);
   NODE_SET_PROTOTYPE_METHOD(ctor, "runOptimize", RoaringBitmap32_runOptimize);
   NODE_SET_PROTOTYPE_METHOD(ctor, "select", RoaringBitmap32_select);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "selectMany", RoaringBitmap32_selectMany);
   NODE_SET_PROTOTYPE_METHOD(ctor, "serialize", RoaringBitmap32_serialize);
   NODE_SET_PROTOTYPE_METHOD(ctor, "serializeAsync", RoaringBitmap32_serializeAsync);
   NODE_SET_PROTOTYPE_METHOD(ctor, "serializeFileAsync", RoaringBitmap32_serializeFileAsync);
@@ -876,6 +1067,7 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   NODE_SET_PROTOTYPE_METHOD(ctor, "tryAdd", RoaringBitmap32_tryAdd);
   NODE_SET_PROTOTYPE_METHOD(ctor, "xorCardinality", RoaringBitmap32_xorCardinality);
   NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlace", RoaringBitmap32_xorInPlace);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlaceAsync", RoaringBitmap32_xorInPlaceAsync);
 
   auto ctorFunction = ctor->GetFunction(context).ToLocalChecked();
   auto ctorObject = ctorFunction->ToObject(context).ToLocalChecked();
@@ -885,7 +1077,13 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
 
   addonData->setMethod(ctorObject, "addOffset", RoaringBitmap32_addOffsetStatic);
   addonData->setMethod(ctorObject, "and", RoaringBitmap32_andStatic);
+  addonData->setMethod(ctorObject, "andAsync", RoaringBitmap32_andStaticAsync);
+  addonData->setMethod(ctorObject, "andMany", RoaringBitmap32_andManyStatic);
+  addonData->setMethod(ctorObject, "andManyAsync", RoaringBitmap32_andManyStaticAsync);
+  addonData->setMethod(ctorObject, "andManyCardinality", RoaringBitmap32_andManyCardinalityStatic);
+  addonData->setMethod(ctorObject, "andManyCardinalityAsync", RoaringBitmap32_andManyCardinalityStaticAsync);
   addonData->setMethod(ctorObject, "andNot", RoaringBitmap32_andNotStatic);
+  addonData->setMethod(ctorObject, "andNotAsync", RoaringBitmap32_andNotStaticAsync);
 
   v8utils::defineHiddenField(isolate, ctorObject, "default", ctorFunction);
 
@@ -894,6 +1092,8 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   addonData->setMethod(ctorObject, "deserializeFile", RoaringBitmap32_deserializeFileStatic);
   addonData->setMethod(ctorObject, "deserializeFileAsync", RoaringBitmap32_deserializeFileAsyncStatic);
   addonData->setMethod(ctorObject, "deserializeParallelAsync", RoaringBitmap32_deserializeParallelStaticAsync);
+  addonData->setMethod(ctorObject, "evaluate", RoaringBitmap32_evaluateStatic);
+  addonData->setMethod(ctorObject, "evaluateAsync", RoaringBitmap32_evaluateStaticAsync);
 
   ignoreMaybeResult(
     ctorObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized), ctorFunction));
@@ -901,13 +1101,27 @@ void RoaringBitmap32_Init(v8::Local<v8::Object> exports, AddonData * addonData)
   addonData->setMethod(ctorObject, "fromArrayAsync", RoaringBitmap32_fromArrayStaticAsync);
   addonData->setMethod(ctorObject, "fromRange", RoaringBitmap32_fromRangeStatic);
   addonData->setMethod(ctorObject, "getInstancesCount", RoaringBitmap32_getInstanceCountStatic);
+  addonData->setMethod(ctorObject, "mapFile", RoaringBitmap32_mapFileStatic);
   addonData->setMethod(ctorObject, "of", RoaringBitmap32_ofStatic);
   addonData->setMethod(ctorObject, "or", RoaringBitmap32_orStatic);
+  addonData->setMethod(ctorObject, "orAsync", RoaringBitmap32_orStaticAsync);
   addonData->setMethod(ctorObject, "orMany", RoaringBitmap32_orManyStatic);
+  addonData->setMethod(ctorObject, "orManyAsync", RoaringBitmap32_orManyStaticAsync);
+  addonData->setMethod(ctorObject, "orManyCardinality", RoaringBitmap32_orManyCardinalityStatic);
+  addonData->setMethod(ctorObject, "orManyCardinalityAsync", RoaringBitmap32_orManyCardinalityStaticAsync);
+  addonData->setMethod(ctorObject, "pairwise", RoaringBitmap32_pairwiseStatic);
+  addonData->setMethod(ctorObject, "pairwiseAsync", RoaringBitmap32_pairwiseStaticAsync);
+  addonData->setMethod(ctorObject, "serializePackFile", RoaringBitmap32_serializePackFileStatic);
+  addonData->setMethod(ctorObject, "serializePackFileAsync", RoaringBitmap32_serializePackFileAsyncStatic);
+  addonData->setMethod(ctorObject, "serializeParallelAsync", RoaringBitmap32_serializeParallelStaticAsync);
   addonData->setMethod(ctorObject, "swap", RoaringBitmap32_swapStatic);
+  addonData->setMethod(ctorObject, "topK", RoaringBitmap32_topKStatic);
+  addonData->setMethod(ctorObject, "topKAsync", RoaringBitmap32_topKStaticAsync);
   addonData->setMethod(ctorObject, "unsafeFrozenView", RoaringBitmap32_unsafeFrozenViewStatic);
   addonData->setMethod(ctorObject, "xor", RoaringBitmap32_xorStatic);
+  addonData->setMethod(ctorObject, "xorAsync", RoaringBitmap32_xorStaticAsync);
   addonData->setMethod(ctorObject, "xorMany", RoaringBitmap32_xorManyStatic);
+  addonData->setMethod(ctorObject, "xorManyAsync", RoaringBitmap32_xorManyStaticAsync);
 
   v8utils::defineReadonlyField(isolate, ctorObject, "CRoaringVersion", versionString);
   v8utils::defineReadonlyField(isolate, exports, "CRoaringVersion", versionString);
@@ -2,6 +2,45 @@
 #define ROARING_NODE_ROARINGBITMAP32_OPS_
 
 #include "RoaringBitmap32.h"
+#include "async-workers.h"
+
+/**
+ * Adds many values to a bitmap. If the values are sorted, runs of consecutive values are added as ranges,
+ * the values between the runs with roaring_bitmap_add_many.
+ */
+inline void roaringAddManyDetectingRuns(roaring_bitmap_t * r, const uint32_t * values, size_t count) {
+  static const constexpr size_t RANGE_MIN_LENGTH = 64;
+
+  // A branchless first pass, so unsorted input and sorted input without runs pay almost nothing.
+  size_t unsorted = 0, adjacent = 0;
+  for (size_t i = 1; i < count; ++i) {
+    unsorted += values[i] <= values[i - 1];
+    adjacent += values[i] == values[i - 1] + 1;
+  }
+  if (unsorted != 0 || adjacent < RANGE_MIN_LENGTH) {
+    return roaring_bitmap_add_many(r, count, values);
+  }
+
+  size_t pending = 0;
+  for (size_t i = 1; i < count;) {
+    if (values[i] != values[i - 1] + 1) {
+      ++i;
+      continue;
+    }
+    const size_t start = i - 1;
+    size_t end = i + 1;
+    while (end < count && values[end] == values[end - 1] + 1) {
+      ++end;
+    }
+    if (end - start >= RANGE_MIN_LENGTH) {
+      roaring_bitmap_add_many(r, start - pending, values + pending);
+      roaring_bitmap_add_range_closed(r, values[start], values[end - 1]);
+      pending = end;
+    }
+    i = end;
+  }
+  roaring_bitmap_add_many(r, count - pending, values + pending);
+}
 
 inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Local<v8::Value> arg, bool replace = false) {
   if (self->isFrozen()) {
@@ -16,6 +55,7 @@ inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Lo
   if (arg->IsNullOrUndefined()) {
     if (replace && self->roaring->high_low_container.containers != nullptr) {
       roaring_bitmap_clear(self->roaring);
+      self->invalidate(0);
     }
     return true;
   }
@@ -29,7 +69,7 @@ inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Lo
       roaring_bitmap_clear(self->roaring);
     }
     const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
-    roaring_bitmap_add_many(self->roaring, typedArray.length, typedArray.data);
+    roaringAddManyDetectingRuns(self->roaring, typedArray.data, typedArray.length);
     self->invalidate();
     return true;
   }
@@ -39,16 +79,38 @@ inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Lo
     if (self != other) {
       if (replace || self->roaring->high_low_container.containers == nullptr) {
         roaring_bitmap_overwrite(self->roaring, other->roaring);
+        self->invalidate(other->readonlyViewOf ? -1 : other->sizeCache);
       } else {
         roaring_bitmap_or_inplace(self->roaring, other->roaring);
+        self->invalidate();
       }
-      self->invalidate();
     }
     return true;
   }
 
   AddonData * addonData = self->addonData;
 
+  if (arg->IsArray() && arg.As<v8::Array>()->Length() <= AddonData::SCRATCH_UINT32_ARRAY_LENGTH) {
+    // Converts plain arrays into a reusable Uint32Array instead of allocating a new one with Uint32Array.from.
+    uint32_t * data = nullptr;
+    v8::Local<v8::Uint32Array> scratch = addonData->acquireScratchUint32Array(data);
+    if (!scratch.IsEmpty()) {
+      const uint32_t length = arg.As<v8::Array>()->Length();
+      v8::Local<v8::Value> argv[] = {arg};
+      const bool converted =
+        !addonData->Uint32Array_set.Get(isolate)->Call(isolate->GetCurrentContext(), scratch, 1, argv).IsEmpty();
+      if (converted) {
+        if (replace) {
+          roaring_bitmap_clear(self->roaring);
+        }
+        roaringAddManyDetectingRuns(self->roaring, data, length);
+        self->invalidate();
+      }
+      addonData->releaseScratchUint32Array();
+      return converted;
+    }
+  }
+
   v8::Local<v8::Value> argv[] = {arg};
   auto tMaybe = addonData->Uint32Array_from.Get(isolate)->Call(
     isolate->GetCurrentContext(), addonData->Uint32Array.Get(isolate), 1, argv);
@@ -59,7 +121,7 @@ inline bool roaringAddMany(v8::Isolate * isolate, RoaringBitmap32 * self, v8::Lo
   if (replace) {
     roaring_bitmap_clear(self->roaring);
   }
-  roaring_bitmap_add_many(self->roaring, typedArray.length, typedArray.data);
+  roaringAddManyDetectingRuns(self->roaring, typedArray.data, typedArray.length);
   self->invalidate();
   return true;
 }
@@ -104,7 +166,7 @@ void RoaringBitmap32_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
 
   info.GetReturnValue().Set(info.This());
 
-  bool changed = false;
+  int64_t added = 0;
   auto roaring = self->roaring;
   int len = info.Length();
   auto context = isolate->GetCurrentContext();
@@ -115,11 +177,11 @@ void RoaringBitmap32_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
       continue;
     }
     if (roaring_bitmap_add_checked(roaring, v)) {
-      changed = true;
+      ++added;
     }
   }
-  if (changed) {
-    self->invalidate();
+  if (added != 0) {
+    self->invalidateAddingToSize(added);
   }
 }
 
@@ -133,7 +195,7 @@ void RoaringBitmap32_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
 
-  bool changed = false;
+  int64_t added = 0;
   auto roaring = self->roaring;
   uint32_t v = 0;
   int len = info.Length();
@@ -144,13 +206,13 @@ void RoaringBitmap32_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
       continue;
     }
     if (roaring_bitmap_add_checked(roaring, v)) {
-      changed = true;
+      ++added;
     }
   }
-  if (changed) {
-    self->invalidate();
+  if (added != 0) {
+    self->invalidateAddingToSize(added);
   }
-  info.GetReturnValue().Set(changed);
+  info.GetReturnValue().Set(added != 0);
 }
 
 void RoaringBitmap32_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
@@ -162,7 +224,7 @@ void RoaringBitmap32_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
   if (self->isFrozen()) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
-  bool changed = false;
+  int64_t removed = 0;
   auto roaring = self->roaring;
   uint32_t v = 0;
   int len = info.Length();
@@ -173,13 +235,13 @@ void RoaringBitmap32_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
       continue;
     }
     if (roaring_bitmap_remove_checked(roaring, v)) {
-      changed = true;
+      ++removed;
     }
   }
-  if (changed) {
-    self->invalidate();
+  if (removed != 0) {
+    self->invalidateAddingToSize(-removed);
   }
-  info.GetReturnValue().Set(changed);
+  info.GetReturnValue().Set(removed != 0);
 }
 
 void RoaringBitmap32_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
@@ -192,7 +254,6 @@ void RoaringBitmap32_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
     return v8utils::throwError(isolate, ERROR_FROZEN);
   }
   if (info.Length() > 0) {
-    self->invalidate();
     if (roaringAddMany(isolate, self, info[0])) {
       return info.GetReturnValue().Set(info.This());
     }
@@ -212,7 +273,7 @@ void RoaringBitmap32_pop(const v8::FunctionCallbackInfo<v8::Value> & info) {
   uint32_t v = roaring_bitmap_maximum(self->roaring);
   bool result = roaring_bitmap_remove_checked(self->roaring, v);
   if (result) {
-    self->invalidate();
+    self->invalidateAddingToSize(-1);
     info.GetReturnValue().Set(v);
   }
 }
@@ -229,7 +290,7 @@ void RoaringBitmap32_shift(const v8::FunctionCallbackInfo<v8::Value> & info) {
   uint32_t v = roaring_bitmap_minimum(self->roaring);
   bool result = roaring_bitmap_remove_checked(self->roaring, v);
   if (result) {
-    self->invalidate();
+    self->invalidateAddingToSize(-1);
     info.GetReturnValue().Set(v);
   }
 }
@@ -249,7 +310,7 @@ void RoaringBitmap32_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
     if (self->roaring != nullptr) {
       roaring_bitmap_clear(self->roaring);
       roaring_bitmap_shrink_to_fit(self->roaring);
-      self->invalidate();
+      self->invalidate(0);
     }
     info.GetReturnValue().Set(true);
   }
@@ -367,4 +428,46 @@ void RoaringBitmap32_xorInPlace(const v8::FunctionCallbackInfo<v8::Value> & info
   return v8utils::throwTypeError(isolate, "Uint32Array, RoaringBitmap32 or Iterable<number> expected");
 }
 
+void RoaringBitmap32_binaryOperationAsync(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmap32BinaryOperation operation, bool inPlace) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  // Prototype methods do not carry the addon data, in place workers get it from this in before().
+  AddonData * addonData = nullptr;
+  if (!inPlace) {
+    addonData = AddonData::get(info);
+    if (addonData == nullptr) {
+      return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    }
+  }
+
+  auto * worker = new BinaryOperationAsyncWorker(info, addonData, operation, inPlace);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  const int callbackIndex = inPlace ? 1 : 2;
+  if (info.Length() > callbackIndex && info[callbackIndex]->IsFunction()) {
+    worker->setCallback(info[callbackIndex]);
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_and, true);
+}
+
+void RoaringBitmap32_andNotInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_andnot, true);
+}
+
+void RoaringBitmap32_orInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_or, true);
+}
+
+void RoaringBitmap32_xorInPlaceAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_xor, true);
+}
+
 #endif  // ROARING_NODE_ROARINGBITMAP32_OPS_
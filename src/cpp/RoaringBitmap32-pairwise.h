@@ -0,0 +1,342 @@
+#ifndef ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
+#define ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
+
+#include "RoaringBitmap32.h"
+#include "async-workers.h"
+
+enum class PairwiseMetric {
+  INVALID = -1,
+  intersection = 0,
+  jaccard = 1,
+  cosine = 2,
+};
+
+inline PairwiseMetric tryParsePairwiseMetric(const v8::Local<v8::Value> & value, v8::Isolate * isolate) {
+  if (!isolate || value.IsEmpty() || !value->IsString()) {
+    return PairwiseMetric::INVALID;
+  }
+  v8::String::Utf8Value metricString(isolate, value);
+  if (strcmp(*metricString, "intersection") == 0) {
+    return PairwiseMetric::intersection;
+  }
+  if (strcmp(*metricString, "jaccard") == 0) {
+    return PairwiseMetric::jaccard;
+  }
+  if (strcmp(*metricString, "cosine") == 0) {
+    return PairwiseMetric::cosine;
+  }
+  return PairwiseMetric::INVALID;
+}
+
+/**
+ * Computes the metric of two bitmaps from the cardinality of their intersection and their sizes.
+ * The result is NaN for a jaccard index of two empty bitmaps and for a cosine similarity with an empty bitmap.
+ * It never decreases when the intersection grows, so it can be used to compute upper bounds.
+ */
+inline double roaringPairwiseScore(PairwiseMetric metric, uint64_t intersection, uint64_t sizeA, uint64_t sizeB) {
+  switch (metric) {
+    case PairwiseMetric::intersection: return (double)intersection;
+    case PairwiseMetric::jaccard: return (double)intersection / (double)(sizeA + sizeB - intersection);
+    default: return (double)intersection / std::sqrt((double)sizeA * (double)sizeB);
+  }
+}
+
+/**
+ * Computes a metric between all the pairs of an array of bitmaps.
+ *
+ * The pair space is split in square tiles of TILE_SIZE x TILE_SIZE bitmaps, a tile compares the bitmaps of a block of rows
+ * with the bitmaps of a block of columns, so the containers of the two blocks stay in the cache while the tile is computed.
+ * Tiles are independent and can be computed concurrently.
+ *
+ * The output is the upper triangle without the diagonal, row by row, or the full symmetric n x n matrix.
+ * The intersection metric is written in a Uint32Array, the other metrics in a Float64Array.
+ */
+class RoaringBitmapPairwise final {
+ public:
+  static const constexpr uint32_t TILE_SIZE = 64;
+
+  RoaringBitmap32 ** bitmaps = nullptr;
+  uint64_t * sizes = nullptr;
+  uint32_t count = 0;
+  PairwiseMetric metric = PairwiseMetric::INVALID;
+  bool full = false;
+
+  /** The block of rows and the block of columns of each tile. */
+  uint32_t * tiles = nullptr;
+  uint32_t tilesCount = 0;
+
+  void * output = nullptr;
+  size_t outputLength = 0;
+
+  v8::Isolate * isolate = nullptr;
+
+  RoaringBitmapPairwise() = default;
+  RoaringBitmapPairwise(const RoaringBitmapPairwise &) = delete;
+  RoaringBitmapPairwise & operator=(const RoaringBitmapPairwise &) = delete;
+
+  ~RoaringBitmapPairwise() {
+    this->endFreeze();
+    if (this->bitmaps != nullptr) {
+      gcaware_free(this->isolate, this->bitmaps);
+    }
+    if (this->sizes != nullptr) {
+      gcaware_free(this->isolate, this->sizes);
+    }
+    if (this->tiles != nullptr) {
+      gcaware_free(this->isolate, this->tiles);
+    }
+    bare_aligned_free(this->output);
+  }
+
+  /** Parses (bitmaps, metric, options), options is an optional object with a boolean full property. */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentsCount) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
+
+    if (argumentsCount < 2) {
+      return WorkerError("RoaringBitmap32::pairwise expects an array of bitmaps and a metric");
+    }
+    if (!info[0]->IsArray()) {
+      return WorkerError("RoaringBitmap32::pairwise expects an array of RoaringBitmap32 as the first argument");
+    }
+    this->metric = tryParsePairwiseMetric(info[1], isolate);
+    if (this->metric == PairwiseMetric::INVALID) {
+      return WorkerError("RoaringBitmap32::pairwise metric must be one of intersection, jaccard, cosine");
+    }
+
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    if (argumentsCount >= 3 && !info[2]->IsUndefined()) {
+      if (!info[2]->IsObject()) {
+        return WorkerError("RoaringBitmap32::pairwise options must be an object");
+      }
+      v8::Local<v8::Value> fullValue;
+      if (info[2]
+            .As<v8::Object>()
+            ->Get(context, NEW_LITERAL_V8_STRING(isolate, "full", v8::NewStringType::kInternalized))
+            .ToLocal(&fullValue)) {
+        this->full = fullValue->BooleanValue(isolate);
+      }
+    }
+
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[0]);
+    const uint32_t length = array->Length();
+    const uint64_t cells = this->full ? (uint64_t)length * length : (uint64_t)length * (length - (length != 0)) / 2;
+    const size_t cellSize = this->metric == PairwiseMetric::intersection ? sizeof(uint32_t) : sizeof(double);
+    if (cells > node::Buffer::kMaxLength / cellSize) {
+      return WorkerError("RoaringBitmap32::pairwise too many bitmaps, the matrix would be too big");
+    }
+
+    if (length != 0) {
+      this->bitmaps = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      this->sizes = (uint64_t *)gcaware_malloc(length * sizeof(uint64_t));
+      if (this->bitmaps == nullptr || this->sizes == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise array can contain only RoaringBitmap32 instances");
+      }
+      this->bitmaps[i] = bitmap;
+      this->sizes[i] = bitmap->getSize();
+      this->count = i + 1;
+    }
+
+    // The tiles of the upper triangle of the blocks matrix, row by row.
+    const uint64_t blocks = ((uint64_t)length + TILE_SIZE - 1) / TILE_SIZE;
+    if (blocks * (blocks + 1) / 2 > UINT32_MAX) {
+      return WorkerError("RoaringBitmap32::pairwise too many bitmaps, the matrix would be too big");
+    }
+    this->tilesCount = (uint32_t)(blocks * (blocks + 1) / 2);
+    if (this->tilesCount != 0) {
+      this->tiles = (uint32_t *)gcaware_malloc(this->tilesCount * 2 * sizeof(uint32_t));
+      if (this->tiles == nullptr) {
+        return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+      }
+    }
+    uint32_t * tile = this->tiles;
+    for (uint32_t row = 0; row != (uint32_t)blocks; ++row) {
+      for (uint32_t column = row; column != (uint32_t)blocks; ++column) {
+        *tile++ = row;
+        *tile++ = column;
+      }
+    }
+
+    this->outputLength = (size_t)cells;
+    this->output = bare_aligned_malloc(32, cells != 0 ? (size_t)cells * cellSize : 1);
+    if (this->output == nullptr) {
+      return WorkerError("RoaringBitmap32::pairwise failed to allocate memory");
+    }
+    return WorkerError();
+  }
+
+  /** Freezes the bitmaps, so they cannot be modified while compared in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      for (uint32_t i = 0; i != this->count; ++i) {
+        this->owner(i)->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      for (uint32_t i = 0; i != this->count; ++i) {
+        this->owner(i)->endFreeze();
+      }
+    }
+  }
+
+  /** Computes the cells of a tile. Different tiles can be computed concurrently. */
+  void computeTile(uint32_t index) {
+    const uint32_t n = this->count;
+    const uint32_t rowBegin = this->tiles[index * 2] * TILE_SIZE;
+    const uint32_t columnBegin = this->tiles[index * 2 + 1] * TILE_SIZE;
+    const uint32_t rowEnd = std::min(rowBegin + TILE_SIZE, n);
+    const uint32_t columnEnd = std::min(columnBegin + TILE_SIZE, n);
+
+    for (uint32_t i = rowBegin; i < rowEnd; ++i) {
+      const roaring_bitmap_t * a = this->bitmaps[i]->roaring;
+      if (this->full && rowBegin == columnBegin) {
+        this->write((uint64_t)i * n + i, this->sizes[i], this->sizes[i], this->sizes[i]);
+      }
+      // Index of the cell (i, i + 1) in the upper triangle.
+      const uint64_t rowStart = (uint64_t)i * (2 * (uint64_t)n - i - 1) / 2;
+      for (uint32_t j = std::max(columnBegin, i + 1); j < columnEnd; ++j) {
+        const uint64_t intersection = roaring_bitmap_and_cardinality(a, this->bitmaps[j]->roaring);
+        if (this->full) {
+          this->write((uint64_t)i * n + j, intersection, this->sizes[i], this->sizes[j]);
+          this->write((uint64_t)j * n + i, intersection, this->sizes[i], this->sizes[j]);
+        } else {
+          this->write(rowStart + (j - i - 1), intersection, this->sizes[i], this->sizes[j]);
+        }
+      }
+    }
+  }
+
+  /** Creates the output typed array, the output memory is moved to the typed array. */
+  bool createResult(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
+    const size_t cellSize = this->metric == PairwiseMetric::intersection ? sizeof(uint32_t) : sizeof(double);
+    std::unique_ptr<v8::BackingStore> backingStore =
+      v8::ArrayBuffer::NewBackingStore(this->output, this->outputLength * cellSize, bare_aligned_free_callback2, nullptr);
+    if (!backingStore) {
+      return false;
+    }
+    this->output = nullptr;
+    v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, std::move(backingStore));
+    if (arrayBuffer.IsEmpty()) {
+      return false;
+    }
+    if (this->metric == PairwiseMetric::intersection) {
+      result = v8::Uint32Array::New(arrayBuffer, 0, this->outputLength);
+    } else {
+      result = v8::Float64Array::New(arrayBuffer, 0, this->outputLength);
+    }
+    return !result.IsEmpty();
+  }
+
+ private:
+  bool frozen = false;
+
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->bitmaps[index];
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  inline void write(uint64_t cell, uint64_t intersection, uint64_t sizeA, uint64_t sizeB) {
+    if (this->metric == PairwiseMetric::intersection) {
+      // Only the intersection of two full bitmaps does not fit, it saturates.
+      ((uint32_t *)this->output)[cell] = intersection > UINT32_MAX ? UINT32_MAX : (uint32_t)intersection;
+    } else {
+      ((double *)this->output)[cell] = roaringPairwiseScore(this->metric, intersection, sizeA, sizeB);
+    }
+  }
+};
+
+class PairwiseWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmapPairwise pairwise;
+  RoaringBitmap32Pins pins;
+
+  explicit PairwiseWorker(v8::Isolate * isolate, AddonData * addonData) : ParallelAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(PairwiseWorker));
+  }
+
+  virtual ~PairwiseWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(PairwiseWorker)); }
+
+ protected:
+  void before() final {
+    this->pairwise.beginFreeze();
+    this->loopCount = this->pairwise.tilesCount;
+  }
+
+  void parallelWork(uint32_t index) final { this->pairwise.computeTile(index); }
+
+  void finally() final { this->pairwise.endFreeze(); }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->pairwise.createResult(this->isolate, result)) {
+      return this->setError(WorkerError("RoaringBitmap32::pairwiseAsync failed to create the result"));
+    }
+  }
+};
+
+void RoaringBitmap32_pairwiseStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapPairwise pairwise;
+  WorkerError error = pairwise.parseArguments(info, info.Length());
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  for (uint32_t i = 0; i != pairwise.tilesCount; ++i) {
+    pairwise.computeTile(i);
+  }
+
+  v8::Local<v8::Value> result;
+  if (!pairwise.createResult(isolate, result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::pairwise failed to create the result");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_pairwiseStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new PairwiseWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  WorkerError error = worker->pairwise.parseArguments(info, length);
+  if (error.hasError()) {
+    worker->setError(error);
+  } else {
+    for (uint32_t i = 0; i != worker->pairwise.count; ++i) {
+      worker->pins.pin(isolate, worker->pairwise.bitmaps[i]);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_PAIRWISE_
@@ -48,6 +48,14 @@ inline bool getRangeOperationParameters(
   return minimum < 4294967296 && minInteger < maxInteger;
 }
 
+/**
+ * Number of values of the bitmap in [minInteger, maxInteger), used to keep the cached size valid across a range mutation.
+ * Returns 0 without counting if the size is not cached, as the size will be recomputed anyway.
+ */
+inline int64_t roaringRangeCardinalityIfSizeKnown(const RoaringBitmap32 * self, uint64_t minInteger, uint64_t maxInteger) {
+  return self->sizeCache >= 0 ? (int64_t)roaring_bitmap_range_cardinality(self->roaring, minInteger, maxInteger) : 0;
+}
+
 void RoaringBitmap32_rangeCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
   uint64_t minInteger, maxInteger;
   if (getRangeOperationParameters(info, minInteger, maxInteger)) {
@@ -75,8 +83,9 @@ void RoaringBitmap32_flipRange(const v8::FunctionCallbackInfo<v8::Value> & info)
   }
   if (getRangeOperationParameters(info, minInteger, maxInteger)) {
     if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
       roaring_bitmap_flip_inplace(self->roaring, minInteger, maxInteger);
-      self->invalidate();
+      self->invalidateAddingToSize((int64_t)(maxInteger - minInteger) - 2 * before);
     }
   }
   info.GetReturnValue().Set(info.This());
@@ -93,8 +102,9 @@ void RoaringBitmap32_addRange(const v8::FunctionCallbackInfo<v8::Value> & info)
   }
   if (getRangeOperationParameters(info, minInteger, maxInteger)) {
     if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
       roaring_bitmap_add_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
-      self->invalidate();
+      self->invalidateAddingToSize((int64_t)(maxInteger - minInteger) - before);
     }
   }
   info.GetReturnValue().Set(info.This());
@@ -111,8 +121,9 @@ void RoaringBitmap32_removeRange(const v8::FunctionCallbackInfo<v8::Value> & inf
   }
   if (getRangeOperationParameters(info, minInteger, maxInteger)) {
     if (self != nullptr) {
+      const int64_t before = roaringRangeCardinalityIfSizeKnown(self, minInteger, maxInteger);
       roaring_bitmap_remove_range_closed(self->roaring, (uint32_t)minInteger, (uint32_t)(maxInteger - 1));
-      self->invalidate();
+      self->invalidateAddingToSize(-before);
     }
   }
   info.GetReturnValue().Set(info.This());
@@ -495,7 +506,12 @@ void RoaringBitmap32_toReversed(const v8::FunctionCallbackInfo<v8::Value> & info
     return;
   }
 
-  size_t startOffset = cardinality - skip - limit;
+  roaring_uint32_iterator_t it;
+  roaring_iterator_init_last(self->roaring, &it);
+  if (skip != 0 && roaring_uint32_iterator_skip_backward(&it, (uint32_t)skip) != skip) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::toReversed - failed to build the range");
+  }
+
   constexpr size_t kChunkSize = 1024;
   uint32_t buffer[kChunkSize];
   size_t processed = 0;
@@ -505,12 +521,12 @@ void RoaringBitmap32_toReversed(const v8::FunctionCallbackInfo<v8::Value> & info
     if (chunk > kChunkSize) {
       chunk = kChunkSize;
     }
-    if (!roaring_bitmap_range_uint32_array(self->roaring, startOffset + processed, chunk, buffer)) {
+    if (roaringIteratorReadReverse(&it, buffer, (uint32_t)chunk) != chunk) {
       return v8utils::throwError(isolate, "RoaringBitmap32::toReversed - failed to build the range");
     }
     for (size_t i = 0; i < chunk; ++i) {
       bool ok = false;
-      uint32_t targetIndex = writeIndex + static_cast<uint32_t>(limit - 1 - (processed + i));
+      uint32_t targetIndex = writeIndex + static_cast<uint32_t>(processed + i);
       if (!jsArray->Set(context, targetIndex, v8::Uint32::NewFromUnsigned(isolate, buffer[i])).To(&ok) || !ok) {
         return;
       }
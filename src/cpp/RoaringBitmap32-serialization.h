@@ -115,6 +115,139 @@ void RoaringBitmap32_unsafeFrozenViewStatic(const v8::FunctionCallbackInfo<v8::V
   info.GetReturnValue().Set(result);
 }
 
+void RoaringBitmap32_mapFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  if (info.Length() < 1 || !info[0]->IsString()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::mapFile expects a file path as the first argument");
+  }
+
+  FrozenViewFormat format = FrozenViewFormat::unsafe_frozen_croaring;
+  if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+    format = tryParseFrozenViewFormat(info[1], isolate);
+    if (format == FrozenViewFormat::INVALID) {
+      return v8utils::throwError(isolate, "RoaringBitmap32::mapFile format argument is invalid");
+    }
+  }
+
+  v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+  const std::string filePath(*filePathUtf8, filePathUtf8.length());
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd == -1) {
+    isolate->ThrowException(WorkerError::from_errno("open", filePath).newV8Error(isolate));
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    WorkerError err = WorkerError::from_errno("fstat", filePath);
+    close(fd);
+    isolate->ThrowException(err.newV8Error(isolate));
+    return;
+  }
+
+  const size_t fileSize = (size_t)st.st_size;
+  if (fileSize == 0) {
+    // Nothing to map, an empty file is an empty bitmap.
+    close(fd);
+    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+    return info.GetReturnValue().Set(result);
+  }
+
+  // The mapping is shared, every process that maps the same file uses the same page cache pages.
+  void * data = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    WorkerError err = WorkerError::from_errno("mmap", filePath);
+    close(fd);
+    isolate->ThrowException(err.newV8Error(isolate));
+    return;
+  }
+  close(fd);
+
+  roaring_bitmap_t * bitmap;
+  if (format == FrozenViewFormat::unsafe_frozen_croaring) {
+    bitmap = const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view((const char *)data, fileSize));
+  } else if (roaring_bitmap_portable_deserialize_size((const char *)data, fileSize) == fileSize) {
+    // Checks the structure first, roaring_bitmap_portable_deserialize_frozen does not validate the input.
+    bitmap = const_cast<roaring_bitmap_t *>(roaring_bitmap_portable_deserialize_frozen((const char *)data));
+  } else {
+    bitmap = nullptr;
+  }
+
+  if (bitmap == nullptr) {
+    munmap(data, fileSize);
+    return v8utils::throwError(isolate, "RoaringBitmap32::mapFile failed to create a frozen view of the file");
+  }
+
+  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+  self->replaceBitmapInstance(isolate, bitmap);
+  self->mappedFile = data;
+  self->mappedFileSize = fileSize;
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_serializePackFileStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapPackFileSerializer serializer;
+  WorkerError error = serializer.parseArguments(info);
+  if (!error.hasError()) {
+    error = serializer.serialize();
+  }
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+  }
+}
+
+void RoaringBitmap32_serializePackFileAsyncStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new SerializePackFileWorker(info, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 serialization failed to allocate async worker");
+  }
+
+  if (info.Length() >= 4 && info[3]->IsFunction()) {
+    worker->setCallback(info[3]);
+  }
+
+  v8::Local<v8::Value> returnValue = AsyncWorker::run(worker);
+  info.GetReturnValue().Set(returnValue);
+}
+
+void RoaringBitmap32_releaseMappedFile(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (self == nullptr || self->mappedFile == nullptr) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (!self->releaseMappedFile()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::releaseMappedFile - the bitmap is in use by an async operation");
+  }
+  info.GetReturnValue().Set(true);
+}
+
 void RoaringBitmap32_deserializeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
 
@@ -236,7 +369,17 @@ void RoaringBitmap32_deserializeFileAsyncStatic(const v8::FunctionCallbackInfo<v
     return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
   }
 
-  auto * worker = new DeserializeFileWorker(info, addonData);
+  AsyncWorker * worker;
+  switch (info.Length() >= 2 ? tryParseFileDeserializationFormat(info[1], isolate) : FileDeserializationFormat::INVALID) {
+    case FileDeserializationFormat::comma_separated_values:
+    case FileDeserializationFormat::tab_separated_values:
+    case FileDeserializationFormat::newline_separated_values:
+    case FileDeserializationFormat::json_array:
+      // Text files are split in chunks and parsed in parallel.
+      worker = new DeserializeTextFileParallelWorker(info, addonData);
+      break;
+    default: worker = new DeserializeFileWorker(info, addonData); break;
+  }
   if (worker == nullptr) {
     return v8utils::throwError(isolate, "RoaringBitmap32 deserialization failed to allocate async worker");
   }
@@ -312,6 +455,93 @@ void RoaringBitmap32_deserializeParallelStaticAsync(const v8::FunctionCallbackIn
   info.GetReturnValue().Set(AsyncWorker::run(worker));
 }
 
+void RoaringBitmap32_serializeParallelStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new SerializeParallelWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int optionsArgIndex = -1;
+  if (info.Length() >= 3 && info[2]->IsFunction()) {
+    worker->setCallback(info[2]);
+  } else if (info.Length() >= 3) {
+    optionsArgIndex = 2;
+    if (info.Length() >= 4 && info[3]->IsFunction()) {
+      worker->setCallback(info[3]);
+    }
+  }
+
+  if (info.Length() < 2) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - requires at least two arguments"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  if (!info[0]->IsArray()) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync requires an array as first argument"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto array = v8::Local<v8::Array>::Cast(info[0]);
+  uint32_t length = array->Length();
+
+  if (length > 0x01FFFFFF) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - array too big"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto format = static_cast<FileSerializationFormat>(tryParseSerializationFormat(info[1], isolate));
+  if (format == FileSerializationFormat::INVALID) {
+    worker->setError(
+      WorkerError("RoaringBitmap32::serializeParallelAsync - second argument must be a valid serialization format"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  auto context = isolate->GetCurrentContext();
+  if (optionsArgIndex >= 0 && !info[optionsArgIndex]->IsUndefined()) {
+    if (!info[optionsArgIndex]->IsObject()) {
+      worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - options must be an object"));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    v8::Local<v8::Value> contiguous;
+    if (info[optionsArgIndex]
+          .As<v8::Object>()
+          ->Get(context, NEW_LITERAL_V8_STRING(isolate, "contiguous", v8::NewStringType::kInternalized))
+          .ToLocal(&contiguous)) {
+      worker->contiguous = contiguous->BooleanValue(isolate);
+    }
+  }
+
+  RoaringBitmapSerializer * items = length ? new RoaringBitmapSerializer[length]() : nullptr;
+  if (items == nullptr && length != 0) {
+    worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate array of serializers"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  worker->items = items;
+  for (uint32_t i = 0; i != length; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * bitmap =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (bitmap == nullptr) {
+      worker->setError(WorkerError("RoaringBitmap32::serializeParallelAsync array can contain only RoaringBitmap32 instances"));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->pins.pin(isolate, bitmap);
+    items[i].self = bitmap;
+    items[i].format = format;
+  }
+
+  worker->loopCount = length;
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
 void RoaringBitmap32_getSerializationSizeInBytes(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
   RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
@@ -2,6 +2,7 @@
 #define ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
 
 #include "RoaringBitmap32.h"
+#include "RoaringBitmap32-ops.h"
 
 void RoaringBitmap32_addOffsetStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   v8::Isolate * isolate = info.GetIsolate();
@@ -329,6 +330,178 @@ void roaringOpMany(
   }
 }
 
+/**
+ * Collects the RoaringBitmap32 instances passed as a single array or as a list of arguments, starting at firstArg.
+ * Returns the number of bitmaps, or -1 if an argument is not a RoaringBitmap32 or the allocation failed.
+ * The returned array has room for one additional item and must be released with gcaware_free.
+ */
+int64_t roaringCollectBitmaps(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int firstArg, RoaringBitmap32 ** & bitmaps) {
+  v8::Isolate * isolate = info.GetIsolate();
+  auto context = isolate->GetCurrentContext();
+  const int length = info.Length() - firstArg;
+
+  bitmaps = nullptr;
+
+  v8::Local<v8::Array> array;
+  const bool isArray = length == 1 && info[firstArg]->IsArray();
+  if (isArray) {
+    array = v8::Local<v8::Array>::Cast(info[firstArg]);
+  }
+
+  const uint32_t count = isArray ? array->Length() : (length > 0 ? (uint32_t)length : 0);
+  bitmaps = (RoaringBitmap32 **)gcaware_malloc((count + 1) * sizeof(RoaringBitmap32 *));
+  if (bitmaps == nullptr) {
+    return -1;
+  }
+
+  for (uint32_t i = 0; i != count; ++i) {
+    RoaringBitmap32 * p;
+    if (isArray) {
+      v8::Local<v8::Value> item;
+      p = array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    } else {
+      p = ObjectWrap::TryUnwrap<RoaringBitmap32>(info, firstArg + (int)i);
+    }
+    if (p == nullptr) {
+      gcaware_free(isolate, bitmaps);
+      bitmaps = nullptr;
+      return -1;
+    }
+    bitmaps[i] = p;
+  }
+
+  return count;
+}
+
+/** Intersects the given bitmaps smallest first. The given array is sorted in place. */
+roaring_bitmap_t * roaringAndManyBySize(v8::Isolate * isolate, RoaringBitmap32 ** bitmaps, size_t count) {
+  roaringSortBySize(bitmaps, count);
+  if (count != 0 && bitmaps[0]->isEmpty()) {
+    return roaring_bitmap_create();
+  }
+  const auto ** x = (const roaring_bitmap_t **)gcaware_malloc((count + 1) * sizeof(roaring_bitmap_t *));
+  if (x == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i != count; ++i) {
+    x[i] = bitmaps[i]->roaring;
+  }
+  roaring_bitmap_t * r = roaringAndMany(count, x);
+  gcaware_free(isolate, x);
+  return r;
+}
+
+void RoaringBitmap32_andManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andMany accepts only RoaringBitmap32 instances");
+  }
+
+  roaring_bitmap_t * r = roaringAndManyBySize(isolate, bitmaps, (size_t)count);
+  gcaware_free(isolate, bitmaps);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::andMany failed roaring allocation");
+  }
+
+  v8::Local<v8::Function> cons = addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * self = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)
+    ? ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate)
+    : nullptr;
+  if (self == nullptr) {
+    roaring_bitmap_free(r);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  self->replaceBitmapInstance(isolate, r);
+
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_andManyInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32 * self = ObjectWrap::TryUnwrap<RoaringBitmap32>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32::andManyInPlace accepts only RoaringBitmap32 instances");
+  }
+
+  bitmaps[count] = self;
+  roaring_bitmap_t * r = roaringAndManyBySize(isolate, bitmaps, (size_t)count + 1);
+  gcaware_free(isolate, bitmaps);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::andManyInPlace failed roaring allocation");
+  }
+
+  // Swap the content instead of the pointer, readonly views keep pointing to the same roaring bitmap.
+  std::swap(*self->roaring, *r);
+  roaring_bitmap_free(r);
+  self->invalidate();
+
+  info.GetReturnValue().Set(info.This());
+}
+
+void roaringOpManyCardinality(
+  const char * opName, ManyCardinalityParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32 ** bitmaps;
+  const int64_t count = roaringCollectBitmaps(info, 0, bitmaps);
+  if (count < 0) {
+    return v8utils::throwTypeError(isolate, opName, " accepts only RoaringBitmap32 instances");
+  }
+
+  const auto ** x = (const roaring_bitmap_t **)gcaware_malloc((count + 1) * sizeof(roaring_bitmap_t *));
+  if (x == nullptr) {
+    gcaware_free(isolate, bitmaps);
+    return v8utils::throwError(isolate, (std::string(opName) + " failed allocation").c_str());
+  }
+
+  if (operation == ManyCardinalityParallelWorker::Operation::AND) {
+    roaringSortBySize(bitmaps, (size_t)count);
+  }
+  for (int64_t i = 0; i != count; ++i) {
+    x[i] = bitmaps[i]->roaring;
+  }
+  gcaware_free(isolate, bitmaps);
+
+  uint64_t cardinality;
+  const bool succeeded = operation == ManyCardinalityParallelWorker::Operation::OR
+    ? roaringOrManyCardinality(x, (size_t)count, cardinality)
+    : roaringAndManyCardinality(x, (size_t)count, cardinality);
+  gcaware_free(isolate, x);
+  if (!succeeded) {
+    return v8utils::throwError(isolate, (std::string(opName) + " failed allocation").c_str());
+  }
+
+  info.GetReturnValue().Set((double)cardinality);
+}
+
+void RoaringBitmap32_andManyCardinalityStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinality("RoaringBitmap32::andManyCardinality", ManyCardinalityParallelWorker::Operation::AND, info);
+}
+
+void RoaringBitmap32_orManyCardinalityStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinality("RoaringBitmap32::orManyCardinality", ManyCardinalityParallelWorker::Operation::OR, info);
+}
+
 void RoaringBitmap32_orManyStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
   roaringOpMany("RoaringBitmap32::orMany", roaring_bitmap_or_many_heap, info);
 }
@@ -337,4 +510,167 @@ void RoaringBitmap32_xorManyStatic(const v8::FunctionCallbackInfo<v8::Value> & i
   roaringOpMany("RoaringBitmap32::xorMany", roaring_bitmap_xor_many, info);
 }
 
+void RoaringBitmap32_andStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_and, false);
+}
+
+void RoaringBitmap32_andNotStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_andnot, false);
+}
+
+void RoaringBitmap32_orStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_or, false);
+}
+
+void RoaringBitmap32_xorStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32_binaryOperationAsync(info, roaring_bitmap_xor, false);
+}
+
+void roaringOpManyAsync(
+  const char * opName, ManyOperationParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new ManyOperationParallelWorker(isolate, addonData, operation);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  auto context = isolate->GetCurrentContext();
+
+  // Accepts both an array of bitmaps or a list of bitmaps as arguments, like the synchronous versions.
+  v8::Local<v8::Array> array;
+  if (length == 1 && info[0]->IsArray()) {
+    array = v8::Local<v8::Array>::Cast(info[0]);
+  } else {
+    array = v8::Array::New(isolate, length);
+    for (int i = 0; i < length; ++i) {
+      ignoreMaybeResult(array->Set(context, (uint32_t)i, info[i]));
+    }
+  }
+
+  const uint32_t arrayLength = array->Length();
+  if (!worker->reserve(arrayLength)) {
+    worker->setError(WorkerError("RoaringBitmap32 many operation failed allocation"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  for (uint32_t i = 0; i != arrayLength; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * p =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (p == nullptr) {
+      worker->setError(WorkerError(opName));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->addInput(p);
+  }
+
+  if (operation == ManyOperationParallelWorker::Operation::AND) {
+    worker->sortInputsBySize();
+  }
+
+  if (!worker->partition()) {
+    worker->setError(WorkerError("RoaringBitmap32 many operation failed allocation"));
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::andManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::AND, info);
+}
+
+void RoaringBitmap32_orManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::orManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::OR, info);
+}
+
+void RoaringBitmap32_xorManyStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyAsync(
+    "RoaringBitmap32::xorManyAsync accepts only RoaringBitmap32 instances", ManyOperationParallelWorker::Operation::XOR, info);
+}
+
+void roaringOpManyCardinalityAsync(
+  const char * opName, ManyCardinalityParallelWorker::Operation operation, const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new ManyCardinalityParallelWorker(isolate, addonData, operation);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  auto context = isolate->GetCurrentContext();
+
+  // Accepts both an array of bitmaps or a list of bitmaps as arguments, like the synchronous versions.
+  v8::Local<v8::Array> array;
+  if (length == 1 && info[0]->IsArray()) {
+    array = v8::Local<v8::Array>::Cast(info[0]);
+  } else {
+    array = v8::Array::New(isolate, length);
+    for (int i = 0; i < length; ++i) {
+      ignoreMaybeResult(array->Set(context, (uint32_t)i, info[i]));
+    }
+  }
+
+  const uint32_t arrayLength = array->Length();
+  if (!worker->reserve(arrayLength)) {
+    worker->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+    return info.GetReturnValue().Set(AsyncWorker::run(worker));
+  }
+
+  for (uint32_t i = 0; i != arrayLength; ++i) {
+    v8::Local<v8::Value> item;
+    RoaringBitmap32 * p =
+      array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+    if (p == nullptr) {
+      worker->setError(WorkerError(opName));
+      return info.GetReturnValue().Set(AsyncWorker::run(worker));
+    }
+    worker->addInput(p);
+  }
+
+  if (!worker->partition()) {
+    worker->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+void RoaringBitmap32_andManyCardinalityStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinalityAsync(
+    "RoaringBitmap32::andManyCardinalityAsync accepts only RoaringBitmap32 instances",
+    ManyCardinalityParallelWorker::Operation::AND,
+    info);
+}
+
+void RoaringBitmap32_orManyCardinalityStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  roaringOpManyCardinalityAsync(
+    "RoaringBitmap32::orManyCardinalityAsync accepts only RoaringBitmap32 instances",
+    ManyCardinalityParallelWorker::Operation::OR,
+    info);
+}
+
 #endif  // ROARING_NODE_ROARINGBITMAP32_STATIC_OPS_
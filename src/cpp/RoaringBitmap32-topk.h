@@ -0,0 +1,322 @@
+#ifndef ROARING_NODE_ROARINGBITMAP32_TOPK_
+#define ROARING_NODE_ROARINGBITMAP32_TOPK_
+
+#include "RoaringBitmap32.h"
+#include "RoaringBitmap32-pairwise.h"
+#include "async-workers.h"
+
+struct RoaringTopKEntry {
+  double score;
+  uint32_t index;
+
+  /** Higher scores first, lower indices first on equal scores. */
+  static inline bool better(const RoaringTopKEntry & a, const RoaringTopKEntry & b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+  }
+};
+
+/**
+ * Finds the k candidates most similar to a query bitmap.
+ *
+ * An upper bound of the score of every candidate is computed up front from the sizes and from the overlap of the ranges
+ * [minimum, maximum] of the query and of the candidate. Candidates are visited from the highest bound, each partition
+ * keeps the best k in a bounded heap and stops as soon as the next bound is below the worst score in the heap.
+ * Partitions take the candidates interleaved, so every partition starts from the most promising ones.
+ */
+class RoaringBitmapTopK final {
+ public:
+  /** Below this number of candidates per partition, splitting the work is not worth the overhead. */
+  static const constexpr uint32_t MIN_PARTITION_SIZE = 256;
+
+  RoaringBitmap32 * query = nullptr;
+  RoaringBitmap32 ** candidates = nullptr;
+  uint32_t count = 0;
+  uint32_t k = 0;
+  uint64_t querySize = 0;
+  PairwiseMetric metric = PairwiseMetric::INVALID;
+
+  /** Candidate indices sorted by upper bound, highest first. */
+  uint32_t * order = nullptr;
+  double * bounds = nullptr;
+  uint64_t * sizes = nullptr;
+
+  uint32_t partitions = 0;
+  std::vector<RoaringTopKEntry> * heaps = nullptr;
+
+  v8::Isolate * isolate = nullptr;
+
+  RoaringBitmapTopK() = default;
+  RoaringBitmapTopK(const RoaringBitmapTopK &) = delete;
+  RoaringBitmapTopK & operator=(const RoaringBitmapTopK &) = delete;
+
+  ~RoaringBitmapTopK() {
+    this->endFreeze();
+    if (this->candidates != nullptr) {
+      gcaware_free(this->isolate, this->candidates);
+    }
+    if (this->order != nullptr) {
+      gcaware_free(this->isolate, this->order);
+    }
+    if (this->bounds != nullptr) {
+      gcaware_free(this->isolate, this->bounds);
+    }
+    if (this->sizes != nullptr) {
+      gcaware_free(this->isolate, this->sizes);
+    }
+    delete[] this->heaps;
+  }
+
+  /** Parses (query, candidates, k, metric) and computes the upper bounds. */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentsCount) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
+
+    if (argumentsCount < 4) {
+      return WorkerError("RoaringBitmap32::topK expects a query bitmap, an array of candidates, k and a metric");
+    }
+    this->query = ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate);
+    if (this->query == nullptr) {
+      return WorkerError("RoaringBitmap32::topK expects a RoaringBitmap32 as the first argument");
+    }
+    if (!info[1]->IsArray()) {
+      return WorkerError("RoaringBitmap32::topK expects an array of RoaringBitmap32 as the second argument");
+    }
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    const double kValue = info[2]->IsNumber() ? info[2]->NumberValue(context).FromMaybe(NAN) : NAN;
+    if (!(kValue >= 0)) {
+      return WorkerError("RoaringBitmap32::topK k must be a non negative number");
+    }
+    this->metric = tryParsePairwiseMetric(info[3], isolate);
+    if (this->metric == PairwiseMetric::INVALID) {
+      return WorkerError("RoaringBitmap32::topK metric must be one of intersection, jaccard, cosine");
+    }
+
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[1]);
+    const uint32_t length = array->Length();
+    this->k = kValue < (double)length ? (uint32_t)kValue : length;
+    if (length != 0) {
+      this->candidates = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      this->order = (uint32_t *)gcaware_malloc(length * sizeof(uint32_t));
+      this->bounds = (double *)gcaware_malloc(length * sizeof(double));
+      this->sizes = (uint64_t *)gcaware_malloc(length * sizeof(uint64_t));
+      if (this->candidates == nullptr || this->order == nullptr || this->bounds == nullptr || this->sizes == nullptr) {
+        return WorkerError("RoaringBitmap32::topK failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * candidate =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (candidate == nullptr) {
+        return WorkerError("RoaringBitmap32::topK array can contain only RoaringBitmap32 instances");
+      }
+      this->candidates[i] = candidate;
+      this->count = i + 1;
+    }
+
+    const roaring_bitmap_t * q = this->query->roaring;
+    const uint64_t querySize = this->query->getSize();
+    this->querySize = querySize;
+    const uint64_t queryMin = querySize != 0 ? roaring_bitmap_minimum(q) : 0;
+    const uint64_t queryMax = querySize != 0 ? roaring_bitmap_maximum(q) : 0;
+    for (uint32_t i = 0; i != length; ++i) {
+      const uint64_t size = this->candidates[i]->getSize();
+      this->sizes[i] = size;
+      this->order[i] = i;
+      uint64_t maxIntersection = 0;
+      if (size != 0 && querySize != 0) {
+        const roaring_bitmap_t * c = this->candidates[i]->roaring;
+        const uint64_t low = std::max(queryMin, (uint64_t)roaring_bitmap_minimum(c));
+        const uint64_t high = std::min(queryMax, (uint64_t)roaring_bitmap_maximum(c));
+        maxIntersection = high >= low ? std::min(std::min(querySize, size), high - low + 1) : 0;
+      }
+      const double bound = roaringPairwiseScore(this->metric, maxIntersection, querySize, size);
+      // Candidates that can only have an undefined score are never returned, they go last.
+      this->bounds[i] = std::isnan(bound) ? -1 : bound;
+    }
+    const double * bounds = this->bounds;
+    std::stable_sort(
+      this->order, this->order + length, [bounds](uint32_t a, uint32_t b) { return bounds[a] > bounds[b]; });
+
+    this->partitions = this->k != 0 ? std::max(1U, std::min(getCpusCount(), length / MIN_PARTITION_SIZE)) : 0;
+    if (this->partitions != 0) {
+      this->heaps = new std::vector<RoaringTopKEntry>[this->partitions]();
+    }
+    return WorkerError();
+  }
+
+  /** Freezes the query and the candidates, so they cannot be modified while compared in another thread. */
+  void beginFreeze() {
+    if (!this->frozen) {
+      this->frozen = true;
+      owner(this->query)->beginFreeze();
+      for (uint32_t i = 0; i != this->count; ++i) {
+        owner(this->candidates[i])->beginFreeze();
+      }
+    }
+  }
+
+  void endFreeze() {
+    if (this->frozen) {
+      this->frozen = false;
+      owner(this->query)->endFreeze();
+      for (uint32_t i = 0; i != this->count; ++i) {
+        owner(this->candidates[i])->endFreeze();
+      }
+    }
+  }
+
+  /** Finds the best k candidates of a partition. Different partitions can be computed concurrently. */
+  void computePartition(uint32_t partition) {
+    std::vector<RoaringTopKEntry> & heap = this->heaps[partition];
+    heap.reserve(this->k);
+    const roaring_bitmap_t * q = this->query->roaring;
+    for (uint32_t position = partition; position < this->count; position += this->partitions) {
+      const uint32_t index = this->order[position];
+      if (heap.size() == this->k && this->bounds[index] < heap.front().score) {
+        break;  // Bounds are sorted, no other candidate of this partition can enter the heap.
+      }
+      const uint64_t intersection = roaring_bitmap_and_cardinality(q, this->candidates[index]->roaring);
+      const RoaringTopKEntry entry = {
+        roaringPairwiseScore(this->metric, intersection, this->querySize, this->sizes[index]), index};
+      if (std::isnan(entry.score)) {
+        continue;
+      }
+      if (heap.size() < this->k) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+      } else if (RoaringTopKEntry::better(entry, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), RoaringTopKEntry::better);
+      }
+    }
+  }
+
+  /** Merges the partitions and creates the result object { indices: Uint32Array, scores: Float64Array }. */
+  bool createResult(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
+    std::vector<RoaringTopKEntry> merged;
+    for (uint32_t i = 0; i != this->partitions; ++i) {
+      merged.insert(merged.end(), this->heaps[i].begin(), this->heaps[i].end());
+    }
+    std::sort(merged.begin(), merged.end(), RoaringTopKEntry::better);
+    const size_t length = std::min(merged.size(), (size_t)this->k);
+
+    v8::Local<v8::ArrayBuffer> indicesBuffer = v8::ArrayBuffer::New(isolate, length * sizeof(uint32_t));
+    v8::Local<v8::ArrayBuffer> scoresBuffer = v8::ArrayBuffer::New(isolate, length * sizeof(double));
+    if (indicesBuffer.IsEmpty() || scoresBuffer.IsEmpty()) {
+      return false;
+    }
+    uint32_t * indices = (uint32_t *)indicesBuffer->GetBackingStore()->Data();
+    double * scores = (double *)scoresBuffer->GetBackingStore()->Data();
+    for (size_t i = 0; i != length; ++i) {
+      indices[i] = merged[i].index;
+      scores[i] = merged[i].score;
+    }
+
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Object> resultObject = v8::Object::New(isolate);
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "indices", v8::NewStringType::kInternalized),
+      v8::Uint32Array::New(indicesBuffer, 0, length)));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "scores", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(scoresBuffer, 0, length)));
+    result = resultObject;
+    return true;
+  }
+
+ private:
+  bool frozen = false;
+
+  static RoaringBitmap32 * owner(RoaringBitmap32 * bitmap) {
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+};
+
+class TopKWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmapTopK topK;
+  RoaringBitmap32Pins pins;
+
+  explicit TopKWorker(v8::Isolate * isolate, AddonData * addonData) : ParallelAsyncWorker(isolate, addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(TopKWorker));
+  }
+
+  virtual ~TopKWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(TopKWorker)); }
+
+ protected:
+  void before() final {
+    this->topK.beginFreeze();
+    this->loopCount = this->topK.partitions;
+    this->concurrency = this->topK.partitions;
+  }
+
+  void parallelWork(uint32_t index) final { this->topK.computePartition(index); }
+
+  void finally() final { this->topK.endFreeze(); }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->topK.createResult(this->isolate, result)) {
+      return this->setError(WorkerError("RoaringBitmap32::topKAsync failed to create the result"));
+    }
+  }
+};
+
+void RoaringBitmap32_topKStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmapTopK topK;
+  WorkerError error = topK.parseArguments(info, info.Length());
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  for (uint32_t i = 0; i != topK.partitions; ++i) {
+    topK.computePartition(i);
+  }
+
+  v8::Local<v8::Value> result;
+  if (!topK.createResult(isolate, result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32::topK failed to create the result");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32_topKStaticAsync(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto * worker = new TopKWorker(isolate, addonData);
+  if (worker == nullptr) {
+    return v8utils::throwError(isolate, "Failed to allocate async worker");
+  }
+
+  int length = info.Length();
+  if (length > 0 && info[length - 1]->IsFunction()) {
+    worker->setCallback(info[length - 1]);
+    --length;
+  }
+
+  WorkerError error = worker->topK.parseArguments(info, length);
+  if (error.hasError()) {
+    worker->setError(error);
+  } else {
+    worker->pins.pin(isolate, worker->topK.query);
+    for (uint32_t i = 0; i != worker->topK.count; ++i) {
+      worker->pins.pin(isolate, worker->topK.candidates[i]);
+    }
+  }
+
+  info.GetReturnValue().Set(AsyncWorker::run(worker));
+}
+
+#endif  // ROARING_NODE_ROARINGBITMAP32_TOPK_
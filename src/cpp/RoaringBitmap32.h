@@ -2,6 +2,7 @@
 #define __ROARINGBITMAP32__H__
 
 #include "v8utils.h"
+#include "mmap.h"
 #include "serialization-format.h"
 #include "WorkerError.h"
 
@@ -28,6 +29,13 @@ class RoaringBitmap32 final : public ObjectWrap {
   v8::Global<v8::Object> persistent;
   v8utils::TypedArrayContent<uint8_t> frozenStorage;
 
+  /** Memory mapped file backing a frozen bitmap created with mapFile, or nullptr. */
+  void * mappedFile;
+  size_t mappedFileSize;
+
+  /** Number of async operations reading a bitmap that is frozen forever, a mapped file cannot be released while in use. */
+  uint32_t foreverFrozenPins;
+
   inline bool isEmpty() const {
     if (this->sizeCache == 0) {
       return true;
@@ -63,22 +71,59 @@ class RoaringBitmap32 final : public ObjectWrap {
   inline void beginFreeze() {
     if (this->frozenCounter >= 0) {
       ++this->frozenCounter;
+    } else {
+      ++this->foreverFrozenPins;
     }
   }
 
   inline void endFreeze() {
     if (this->frozenCounter > 0) {
       --this->frozenCounter;
+    } else if (this->frozenCounter < 0 && this->foreverFrozenPins > 0) {
+      --this->foreverFrozenPins;
     }
   }
 
+  /**
+   * Releases the memory mapped file of a bitmap created with mapFile, the bitmap becomes empty and stays frozen.
+   * Returns false if the bitmap is in use by an async operation.
+   */
+  bool releaseMappedFile() {
+    if (this->mappedFile == nullptr) {
+      return true;
+    }
+    if (this->foreverFrozenPins != 0) {
+      return false;
+    }
+    roaring_bitmap_t * empty = roaring_bitmap_create();
+    if (empty == nullptr) {
+      return false;
+    }
+    roaring_bitmap_free(this->roaring);
+    this->roaring = empty;
+    munmap(this->mappedFile, this->mappedFileSize);
+    this->mappedFile = nullptr;
+    this->mappedFileSize = 0;
+    this->invalidate();
+    return true;
+  }
+
   inline int64_t getVersion() const { return this->_version; }
 
-  inline void invalidate() {
-    this->sizeCache = -1;
+  inline void invalidate() { this->invalidate(-1); }
+
+  /** Marks the bitmap as changed, caching its new size, or -1 if the size is not known. */
+  inline void invalidate(int64_t newSize) {
+    this->sizeCache = newSize;
     ++this->_version;
   }
 
+  /** Marks the bitmap as changed by a mutation that changed the size by delta. The cached size stays valid. */
+  inline void invalidateAddingToSize(int64_t delta) {
+    const int64_t size = this->sizeCache;
+    this->invalidate(size >= 0 ? size + delta : -1);
+  }
+
   inline bool roaring_bitmap_t_is_frozen(const roaring_bitmap_t * r) {
     return r->high_low_container.flags & ROARING_FLAG_FROZEN;
   }
@@ -104,7 +149,10 @@ class RoaringBitmap32 final : public ObjectWrap {
     roaring(readonlyViewOf->roaring),
     sizeCache(-1),
     frozenCounter(RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN),
-    readonlyViewOf(readonlyViewOf->readonlyViewOf ? readonlyViewOf->readonlyViewOf : readonlyViewOf) {
+    readonlyViewOf(readonlyViewOf->readonlyViewOf ? readonlyViewOf->readonlyViewOf : readonlyViewOf),
+    mappedFile(nullptr),
+    mappedFileSize(0),
+    foreverFrozenPins(0) {
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32));
   }
 
@@ -114,7 +162,10 @@ class RoaringBitmap32 final : public ObjectWrap {
     sizeCache(0),
     _version(0),
     frozenCounter(0),
-    readonlyViewOf(nullptr) {
+    readonlyViewOf(nullptr),
+    mappedFile(nullptr),
+    mappedFileSize(0),
+    foreverFrozenPins(0) {
     ++addonData->RoaringBitmap32_instances;
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32));
   }
@@ -129,6 +180,9 @@ class RoaringBitmap32 final : public ObjectWrap {
       if (this->frozenStorage.data != nullptr && this->frozenStorage.length == std::numeric_limits<size_t>::max()) {
         gcaware_aligned_free(this->isolate, this->frozenStorage.data);
       }
+      if (this->mappedFile != nullptr) {
+        munmap(this->mappedFile, this->mappedFileSize);
+      }
     }
     if (!this->persistent.IsEmpty()) {
       this->persistent.ClearWeak();
@@ -136,4 +190,654 @@ class RoaringBitmap32 final : public ObjectWrap {
   }
 };
 
+/**
+ * Strong references to the bitmaps read by an asynchronous operation, and to the owners of readonly views.
+ * Worker threads use raw pointers, the caller may drop every reference to the bitmaps before the operation completes.
+ */
+class RoaringBitmap32Pins final {
+ public:
+  void pin(v8::Isolate * isolate, const RoaringBitmap32 * bitmap) {
+    this->_pins.emplace_back(isolate, bitmap->persistent.Get(isolate));
+    if (bitmap->readonlyViewOf != nullptr) {
+      this->_pins.emplace_back(isolate, bitmap->readonlyViewOf->persistent.Get(isolate));
+    }
+  }
+
+ private:
+  std::vector<v8::Global<v8::Object>> _pins;
+};
+
+/** Sorts the given bitmaps by cardinality, smallest first, using the cached size. */
+inline void roaringSortBySize(RoaringBitmap32 ** bitmaps, size_t count) {
+  std::stable_sort(
+    bitmaps, bitmaps + count, [](const RoaringBitmap32 * a, const RoaringBitmap32 * b) { return a->getSize() < b->getSize(); });
+}
+
+/** Sorts the given roaring bitmaps by cardinality, smallest first. */
+inline void roaringSortByCardinality(const roaring_bitmap_t ** bitmaps, size_t count) {
+  if (count < 2) {
+    return;
+  }
+  std::vector<std::pair<uint64_t, const roaring_bitmap_t *>> sorted(count);
+  for (size_t i = 0; i != count; ++i) {
+    sorted[i] = {roaring_bitmap_get_cardinality(bitmaps[i]), bitmaps[i]};
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto & a, const auto & b) { return a.first < b.first; });
+  for (size_t i = 0; i != count; ++i) {
+    bitmaps[i] = sorted[i].second;
+  }
+}
+
+/**
+ * Intersects the given bitmaps into a new bitmap.
+ * The bitmaps should be sorted by cardinality, smallest first: the running result never grows,
+ * so starting from the smallest keeps every step cheap, and the loop stops as soon as the result is empty.
+ */
+roaring_bitmap_t * roaringAndMany(size_t count, const roaring_bitmap_t ** x) {
+  if (count == 0) {
+    return roaring_bitmap_create();
+  }
+  if (count == 1) {
+    return roaring_bitmap_copy(x[0]);
+  }
+  roaring_bitmap_t * r = roaring_bitmap_and(x[0], x[1]);
+  for (size_t i = 2; r != nullptr && i < count && !roaring_bitmap_is_empty(r); ++i) {
+    roaring_bitmap_and_inplace(r, x[i]);
+  }
+  return r;
+}
+
+/**
+ * A bitset container on the stack, used to combine the containers with the same key without allocating.
+ * The croaring bitset functions are used, they dispatch at runtime to the vectorized versions.
+ */
+struct RoaringScratchBitset {
+  alignas(64) uint64_t words[roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS];
+  roaring::internal::bitset_container_t bitset;
+
+  RoaringScratchBitset() {
+    this->bitset.cardinality = roaring::internal::BITSET_UNKNOWN_CARDINALITY;
+    this->bitset.words = this->words;
+  }
+
+  inline void clear() { memset(this->words, 0, sizeof(this->words)); }
+
+  inline uint64_t cardinality() const { return (uint64_t)roaring::internal::bitset_container_compute_cardinality(&this->bitset); }
+
+  /** Adds the values of a container. Returns true if the bitset is known to be full. */
+  bool orContainer(const roaring::internal::container_t * c, uint8_t typecode) {
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    switch (typecode) {
+      case BITSET_CONTAINER_TYPE:
+        // Computing the cardinality while merging is almost free, and allows to stop as soon as the union is full.
+        return roaring::internal::bitset_container_or(
+                 &this->bitset, (const roaring::internal::bitset_container_t *)c, &this->bitset) == (1 << 16);
+      case RUN_CONTAINER_TYPE: {
+        const auto * rc = (const roaring::internal::run_container_t *)c;
+        for (int32_t i = 0; i != rc->n_runs; ++i) {
+          roaring::internal::bitset_set_lenrange(this->words, rc->runs[i].value, rc->runs[i].length);
+        }
+        break;
+      }
+      default: {
+        const auto * ac = (const roaring::internal::array_container_t *)c;
+        roaring::internal::bitset_set_list(this->words, ac->array, (uint64_t)ac->cardinality);
+        break;
+      }
+    }
+    return false;
+  }
+
+  /** Removes the values that are not in a bitset or run container. Returns true if the bitset is known to be empty. */
+  bool andContainer(const roaring::internal::container_t * c, uint8_t typecode) {
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    if (typecode == BITSET_CONTAINER_TYPE) {
+      return roaring::internal::bitset_container_and(
+               &this->bitset, (const roaring::internal::bitset_container_t *)c, &this->bitset) == 0;
+    }
+    const auto * rc = (const roaring::internal::run_container_t *)c;
+    uint32_t start = 0;
+    for (int32_t i = 0; i != rc->n_runs; ++i) {
+      roaring::internal::bitset_reset_range(this->words, start, rc->runs[i].value);
+      start = (uint32_t)rc->runs[i].value + rc->runs[i].length + 1;
+    }
+    roaring::internal::bitset_reset_range(this->words, start, 1 << 16);
+    return false;
+  }
+};
+
+/** Keeps only the sorted values that are in the given container. Returns the number of values kept. */
+inline int32_t roaringContainerFilterValues(
+  const roaring::internal::container_t * c, uint8_t typecode, uint16_t * values, int32_t count) {
+  c = roaring::internal::container_unwrap_shared(c, &typecode);
+  int32_t kept = 0;
+  switch (typecode) {
+    case BITSET_CONTAINER_TYPE: {
+      const uint64_t * words = ((const roaring::internal::bitset_container_t *)c)->words;
+      for (int32_t i = 0; i != count; ++i) {
+        const uint16_t v = values[i];
+        values[kept] = v;
+        kept += (int32_t)((words[v >> 6] >> (v & 63)) & 1);
+      }
+      break;
+    }
+    case RUN_CONTAINER_TYPE: {
+      const auto * rc = (const roaring::internal::run_container_t *)c;
+      int32_t r = 0;
+      for (int32_t i = 0; i != count; ++i) {
+        const uint16_t v = values[i];
+        while (r != rc->n_runs && (uint32_t)rc->runs[r].value + rc->runs[r].length < v) {
+          ++r;
+        }
+        if (r == rc->n_runs) {
+          break;
+        }
+        values[kept] = v;
+        kept += (int32_t)(v >= rc->runs[r].value);
+      }
+      break;
+    }
+    default: {
+      // Wraps the values in an array container, to use the vectorized in place intersection of croaring.
+      roaring::internal::array_container_t candidates;
+      candidates.cardinality = count;
+      candidates.capacity = count;
+      candidates.array = values;
+      roaring::internal::array_container_intersection_inplace(&candidates, (const roaring::internal::array_container_t *)c);
+      kept = candidates.cardinality;
+      break;
+    }
+  }
+  return kept;
+}
+
+/**
+ * Computes the cardinality of the union of the given bitmaps, only for the keys (high 16 bits) in [keyBegin, keyEnd).
+ * The containers with the same key are combined in a scratch bitset and counted, no container is allocated.
+ * Returns false if the allocation of the cursors failed.
+ */
+inline bool roaringOrManyCardinality(
+  const roaring_bitmap_t ** x, size_t count, uint64_t & result, uint32_t keyBegin = 0, uint32_t keyEnd = 1 << 16) {
+  result = 0;
+  if (count == 0) {
+    return true;
+  }
+  auto * positions = (int32_t *)gcaware_malloc(count * (sizeof(int32_t) + sizeof(uint32_t)));
+  if (positions == nullptr) {
+    return false;
+  }
+  auto * matching = (uint32_t *)(positions + count);
+  for (size_t i = 0; i != count; ++i) {
+    positions[i] = keyBegin == 0 ? 0 : roaring::internal::ra_advance_until(&x[i]->high_low_container, (uint16_t)keyBegin, -1);
+  }
+
+  RoaringScratchBitset scratch;
+  uint64_t total = 0;
+  for (;;) {
+    uint32_t key = keyEnd;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      if (positions[i] < ra.size && ra.keys[positions[i]] < key) {
+        key = ra.keys[positions[i]];
+      }
+    }
+    if (key >= keyEnd) {
+      break;
+    }
+
+    size_t n = 0;
+    bool full = false;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const int32_t p = positions[i];
+      if (p < ra.size && ra.keys[p] == key) {
+        matching[n++] = (uint32_t)i;
+        full = full || roaring::internal::container_is_full(ra.containers[p], ra.typecodes[p]);
+      }
+    }
+
+    const roaring_array_t & ra0 = x[matching[0]]->high_low_container;
+    const int32_t p0 = positions[matching[0]];
+    if (full) {
+      total += 1 << 16;
+    } else if (n == 1) {
+      total += (uint64_t)roaring::internal::container_get_cardinality(ra0.containers[p0], ra0.typecodes[p0]);
+    } else if (n == 2) {
+      const roaring_array_t & ra1 = x[matching[1]]->high_low_container;
+      const int32_t p1 = positions[matching[1]];
+      total += (uint64_t)(roaring::internal::container_get_cardinality(ra0.containers[p0], ra0.typecodes[p0]) +
+                          roaring::internal::container_get_cardinality(ra1.containers[p1], ra1.typecodes[p1]) -
+                          roaring::internal::container_and_cardinality(
+                            ra0.containers[p0], ra0.typecodes[p0], ra1.containers[p1], ra1.typecodes[p1]));
+    } else {
+      scratch.clear();
+      bool filled = false;
+      for (size_t j = 0; j != n && !filled; ++j) {
+        const roaring_array_t & ra = x[matching[j]]->high_low_container;
+        const int32_t p = positions[matching[j]];
+        filled = scratch.orContainer(ra.containers[p], ra.typecodes[p]);
+      }
+      total += filled ? 1 << 16 : scratch.cardinality();
+    }
+
+    for (size_t j = 0; j != n; ++j) {
+      ++positions[matching[j]];
+    }
+  }
+
+  gcaware_free(positions);
+  result = total;
+  return true;
+}
+
+/**
+ * Computes the cardinality of the intersection of the given bitmaps, only for the keys (high 16 bits) in [keyBegin, keyEnd).
+ * The bitmaps should be sorted by cardinality, smallest first: only the keys of the first bitmap are visited.
+ * The containers with the same key are intersected in a scratch buffer and counted, no container is allocated.
+ * Returns false if the allocation of the cursors failed.
+ */
+inline bool roaringAndManyCardinality(
+  const roaring_bitmap_t ** x, size_t count, uint64_t & result, uint32_t keyBegin = 0, uint32_t keyEnd = 1 << 16) {
+  result = 0;
+  if (count == 0) {
+    return true;
+  }
+  auto * positions = (int32_t *)gcaware_malloc(count * sizeof(int32_t));
+  if (positions == nullptr) {
+    return false;
+  }
+  for (size_t i = 0; i != count; ++i) {
+    positions[i] = -1;
+  }
+
+  RoaringScratchBitset scratch;
+  uint16_t values[roaring::internal::DEFAULT_MAX_SIZE];
+  uint64_t total = 0;
+
+  const roaring_array_t & first = x[0]->high_low_container;
+  int32_t p = keyBegin == 0 ? 0 : roaring::internal::ra_advance_until(&first, (uint16_t)keyBegin, -1);
+  for (; p < first.size && first.keys[p] < keyEnd; ++p) {
+    const uint16_t key = first.keys[p];
+
+    // Finds the container with the same key in every other bitmap, and the smallest array container to start from.
+    bool found = true;
+    size_t smallestArray = SIZE_MAX;
+    int32_t smallestArrayCardinality = INT32_MAX;
+    for (size_t i = 0; i != count; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const int32_t q = i == 0 ? p : roaring::internal::ra_advance_until(&ra, key, positions[i]);
+      if (q >= ra.size) {
+        // No more keys in this bitmap, nothing else can intersect.
+        gcaware_free(positions);
+        result = total;
+        return true;
+      }
+      if (ra.keys[q] != key) {
+        positions[i] = q - 1;
+        found = false;
+        break;
+      }
+      positions[i] = q;
+      uint8_t typecode = ra.typecodes[q];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra.containers[q], &typecode);
+      if (typecode == ARRAY_CONTAINER_TYPE) {
+        const int32_t cardinality = ((const roaring::internal::array_container_t *)c)->cardinality;
+        if (cardinality < smallestArrayCardinality) {
+          smallestArrayCardinality = cardinality;
+          smallestArray = i;
+        }
+      }
+    }
+    if (!found) {
+      continue;
+    }
+
+    if (count == 1) {
+      total += (uint64_t)roaring::internal::container_get_cardinality(first.containers[p], first.typecodes[p]);
+      continue;
+    }
+    if (count == 2) {
+      const roaring_array_t & ra1 = x[1]->high_low_container;
+      total += (uint64_t)roaring::internal::container_and_cardinality(
+        first.containers[p], first.typecodes[p], ra1.containers[positions[1]], ra1.typecodes[positions[1]]);
+      continue;
+    }
+
+    if (smallestArray != SIZE_MAX) {
+      // Filters the values of the smallest array container through all the other containers.
+      const roaring_array_t & base = x[smallestArray]->high_low_container;
+      uint8_t typecode = base.typecodes[positions[smallestArray]];
+      const auto * ac = (const roaring::internal::array_container_t *)roaring::internal::container_unwrap_shared(
+        base.containers[positions[smallestArray]], &typecode);
+      int32_t n = ac->cardinality;
+      memcpy(values, ac->array, n * sizeof(uint16_t));
+      for (size_t i = 0; i != count && n != 0; ++i) {
+        if (i != smallestArray) {
+          const roaring_array_t & ra = x[i]->high_low_container;
+          n = roaringContainerFilterValues(ra.containers[positions[i]], ra.typecodes[positions[i]], values, n);
+        }
+      }
+      total += (uint64_t)n;
+      continue;
+    }
+
+    // Only bitset and run containers, full containers do not change the intersection.
+    bool initialized = false;
+    bool emptied = false;
+    for (size_t i = 0; i != count && !emptied; ++i) {
+      const roaring_array_t & ra = x[i]->high_low_container;
+      const roaring::internal::container_t * c = ra.containers[positions[i]];
+      const uint8_t typecode = ra.typecodes[positions[i]];
+      if (roaring::internal::container_is_full(c, typecode)) {
+        continue;
+      }
+      if (!initialized) {
+        scratch.clear();
+        scratch.orContainer(c, typecode);
+        initialized = true;
+      } else {
+        emptied = scratch.andContainer(c, typecode);
+      }
+    }
+    total += emptied ? 0 : initialized ? scratch.cardinality() : 1 << 16;
+  }
+
+  gcaware_free(positions);
+  result = total;
+  return true;
+}
+
+/**
+ * Checks the presence of many values, writing 1 or 0 for each value in output.
+ * The bulk context caches the last container, so lookups of close values skip the container search.
+ * Returns the number of values found.
+ */
+inline size_t roaringHasMany(const roaring_bitmap_t * r, const uint32_t * values, size_t count, uint8_t * output) {
+  roaring_bulk_context_t context;
+  memset(&context, 0, sizeof(context));
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const bool has = roaring_bitmap_contains_bulk(r, &context, values[i]);
+    output[i] = has;
+    found += has;
+  }
+  return found;
+}
+
+/**
+ * Checks the presence of many values, writing a packed bitset in output: bit i is set if values[i] is present.
+ * Output words are overwritten, the bits after count in the last word are cleared.
+ * Returns the number of values found.
+ */
+inline size_t roaringHasManyBits(const roaring_bitmap_t * r, const uint32_t * values, size_t count, uint32_t * output) {
+  roaring_bulk_context_t context;
+  memset(&context, 0, sizeof(context));
+  size_t found = 0;
+  for (size_t i = 0; i < count; i += 32) {
+    const size_t n = count - i < 32 ? count - i : 32;
+    uint32_t word = 0;
+    for (size_t j = 0; j < n; ++j) {
+      word |= (uint32_t)roaring_bitmap_contains_bulk(r, &context, values[i + j]) << j;
+    }
+    output[i >> 5] = word;
+    found += roaring_hamming(word);
+  }
+  return found;
+}
+
+/**
+ * Returns the positions of the values sorted by value, or nullptr if the values are already sorted.
+ * Sets failed to true if the allocation failed.
+ */
+inline uint32_t * roaringSortedOrder(const uint32_t * values, size_t count, bool & failed) {
+  failed = false;
+  size_t i = 1;
+  while (i < count && values[i - 1] <= values[i]) {
+    ++i;
+  }
+  if (i >= count) {
+    return nullptr;
+  }
+  uint32_t * order = (uint32_t *)gcaware_malloc(count * sizeof(uint32_t));
+  if (order == nullptr) {
+    failed = true;
+    return nullptr;
+  }
+  for (size_t k = 0; k < count; ++k) {
+    order[k] = (uint32_t)k;
+  }
+  std::stable_sort(order, order + count, [values](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+  return order;
+}
+
+/**
+ * Computes the rank of many values, sorted or not, with a single merged pass over the containers.
+ * Returns false if the allocation failed.
+ */
+template <typename T>
+bool roaringRankMany(const roaring_bitmap_t * r, const uint32_t * values, size_t count, T * output) {
+  if (count == 0) {
+    return true;
+  }
+  bool failed;
+  uint32_t * order = roaringSortedOrder(values, count, failed);
+  if (failed) {
+    return false;
+  }
+  uint64_t * ranks = (uint64_t *)gcaware_malloc(count * sizeof(uint64_t));
+  uint32_t * sorted = order != nullptr ? (uint32_t *)gcaware_malloc(count * sizeof(uint32_t)) : nullptr;
+  if (ranks == nullptr || (order != nullptr && sorted == nullptr)) {
+    gcaware_free(ranks);
+    gcaware_free(sorted);
+    gcaware_free(order);
+    return false;
+  }
+  if (order != nullptr) {
+    for (size_t i = 0; i < count; ++i) {
+      sorted[i] = values[order[i]];
+    }
+  }
+
+  // roaring_bitmap_rank_many stops at the last container, values after it have the rank of the whole set.
+  const uint64_t cardinality = roaring_bitmap_get_cardinality(r);
+  for (size_t i = 0; i < count; ++i) {
+    ranks[i] = cardinality;
+  }
+  const uint32_t * begin = order != nullptr ? sorted : values;
+  roaring_bitmap_rank_many(r, begin, begin + count, ranks);
+
+  if (order != nullptr) {
+    for (size_t i = 0; i < count; ++i) {
+      output[order[i]] = (T)ranks[i];
+    }
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      output[i] = (T)ranks[i];
+    }
+  }
+
+  gcaware_free(ranks);
+  gcaware_free(sorted);
+  gcaware_free(order);
+  return true;
+}
+
+/**
+ * Selects the values at many ranks, sorted or not, walking the containers once and accumulating their cardinality.
+ * Ranks out of range are set to missing. Returns false if the allocation failed.
+ */
+template <typename T>
+bool roaringSelectMany(const roaring_bitmap_t * r, const uint32_t * ranks, size_t count, T * output, T missing) {
+  if (count == 0) {
+    return true;
+  }
+  bool failed;
+  uint32_t * order = roaringSortedOrder(ranks, count, failed);
+  if (failed) {
+    return false;
+  }
+
+  const roaring_array_t * ra = &r->high_low_container;
+  int32_t containerIndex = 0;
+  uint32_t startRank = 0;
+  for (size_t k = 0; k < count; ++k) {
+    const size_t i = order != nullptr ? order[k] : k;
+    const uint32_t rank = ranks[i];
+    uint32_t element = 0;
+    bool found = false;
+    while (containerIndex < ra->size) {
+      // container_select adds the container cardinality to the start rank when the rank is not in the container.
+      uint32_t nextStartRank = startRank;
+      if (roaring::internal::container_select(
+            ra->containers[containerIndex], ra->typecodes[containerIndex], &nextStartRank, rank, &element)) {
+        element |= (uint32_t)ra->keys[containerIndex] << 16;
+        found = true;
+        break;
+      }
+      startRank = nextStartRank;
+      ++containerIndex;
+    }
+    output[i] = found ? (T)element : missing;
+  }
+
+  gcaware_free(order);
+  return true;
+}
+
+/**
+ * Positions the iterator on the last value of the container at it->container_index,
+ * the same as roaring_uint32_iterator_previous does when it moves to the previous container.
+ */
+inline bool roaringIteratorLoadLast(roaring_uint32_iterator_t * it) {
+  const roaring_array_t * ra = &it->parent->high_low_container;
+  if (it->container_index < 0 || it->container_index >= ra->size) {
+    return (it->has_value = false);
+  }
+  uint8_t typecode = ra->typecodes[it->container_index];
+  it->container = roaring::internal::container_unwrap_shared(ra->containers[it->container_index], &typecode);
+  it->typecode = typecode;
+  it->highbits = (uint32_t)ra->keys[it->container_index] << 16;
+  uint16_t low16 = 0;
+  it->container_it = roaring::internal::container_init_iterator_last(it->container, it->typecode, &low16);
+  it->current_value = it->highbits | low16;
+  return (it->has_value = true);
+}
+
+/**
+ * Copies up to count values of a container in descending order, starting from the iterator position.
+ * Returns true and updates the position if the container still has values.
+ */
+inline bool roaringContainerReadReverse(
+  const roaring::internal::container_t * c,
+  uint8_t typecode,
+  roaring::internal::roaring_container_iterator_t * cit,
+  uint32_t highbits,
+  uint32_t * buf,
+  uint32_t count,
+  uint32_t * consumed,
+  uint16_t * low16) {
+  uint32_t n = 0;
+  switch (typecode) {
+    case BITSET_CONTAINER_TYPE: {
+      const uint64_t * words = ((const roaring::internal::bitset_container_t *)c)->words;
+      int32_t wordindex = cit->index / 64;
+      uint64_t word = words[wordindex] & (UINT64_MAX >> (63 - (cit->index % 64)));
+      for (;;) {
+        while (word != 0 && n < count) {
+          const uint32_t bit = 63 - roaring_leading_zeroes(word);
+          buf[n++] = highbits | ((uint32_t)wordindex * 64 + bit);
+          word ^= (uint64_t)1 << bit;
+        }
+        if (n >= count) {
+          break;
+        }
+        if (wordindex == 0) {
+          break;
+        }
+        word = words[--wordindex];
+      }
+      *consumed = n;
+      if (word == 0) {
+        while (wordindex > 0 && (word = words[--wordindex]) == 0) {
+        }
+        if (word == 0) {
+          return false;
+        }
+      }
+      cit->index = wordindex * 64 + (63 - roaring_leading_zeroes(word));
+      *low16 = (uint16_t)cit->index;
+      return true;
+    }
+    case ARRAY_CONTAINER_TYPE: {
+      const uint16_t * array = ((const roaring::internal::array_container_t *)c)->array;
+      int32_t index = cit->index;
+      const uint32_t available = (uint32_t)index + 1;
+      n = available < count ? available : count;
+      for (uint32_t i = 0; i < n; ++i) {
+        buf[i] = highbits | array[index - (int32_t)i];
+      }
+      *consumed = n;
+      index -= (int32_t)n;
+      cit->index = index;
+      if (index < 0) {
+        return false;
+      }
+      *low16 = array[index];
+      return true;
+    }
+    case RUN_CONTAINER_TYPE: {
+      const roaring::internal::rle16_t * runs = ((const roaring::internal::run_container_t *)c)->runs;
+      int32_t index = cit->index;
+      uint32_t value = *low16;
+      while (n < count) {
+        const uint32_t start = runs[index].value;
+        const uint32_t available = value - start + 1;
+        const uint32_t toRead = available < count - n ? available : count - n;
+        for (uint32_t i = 0; i < toRead; ++i) {
+          buf[n + i] = highbits | (value - i);
+        }
+        n += toRead;
+        if (toRead < available) {
+          value -= toRead;
+          break;
+        }
+        if (--index < 0) {
+          break;
+        }
+        value = (uint32_t)runs[index].value + runs[index].length;
+      }
+      *consumed = n;
+      cit->index = index;
+      if (index < 0) {
+        return false;
+      }
+      *low16 = (uint16_t)value;
+      return true;
+    }
+    default: *consumed = 0; return false;
+  }
+}
+
+/**
+ * Reads up to count values walking backwards from the current position of the iterator,
+ * the reverse of roaring_uint32_iterator_read. Returns the number of values read.
+ */
+inline uint32_t roaringIteratorReadReverse(roaring_uint32_iterator_t * it, uint32_t * buf, uint32_t count) {
+  uint32_t ret = 0;
+  while (it->has_value && ret < count) {
+    uint32_t consumed;
+    uint16_t low16 = (uint16_t)it->current_value;
+    const bool hasValue = roaringContainerReadReverse(
+      it->container, it->typecode, &it->container_it, it->highbits, buf + ret, count - ret, &consumed, &low16);
+    ret += consumed;
+    if (hasValue) {
+      it->current_value = it->highbits | low16;
+      return ret;
+    }
+    --it->container_index;
+    roaringIteratorLoadLast(it);
+  }
+  return ret;
+}
+
 #endif
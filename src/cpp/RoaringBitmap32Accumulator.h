@@ -0,0 +1,258 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
+#define ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
+
+#include "RoaringBitmap32.h"
+
+/**
+ * Streaming union of many bitmaps.
+ *
+ * Inputs are merged with lazy unions, that skip the computation of exact cardinalities and container conversions;
+ * the result is repaired only once, when finish is called.
+ */
+class RoaringBitmap32Accumulator final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152414300;
+
+  /** The accumulated union, in lazy state if count is not zero. nullptr until the first input. */
+  roaring_bitmap_t * roaring;
+  /** The number of bitmaps merged since the last finish or clear. */
+  uint32_t count;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmap32Accumulator(AddonData * addonData) : ObjectWrap(addonData), roaring(nullptr), count(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32Accumulator));
+  }
+
+  ~RoaringBitmap32Accumulator() {
+    this->clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32Accumulator));
+  }
+
+  void clear() {
+    if (this->roaring != nullptr) {
+      roaring_bitmap_free(this->roaring);
+      this->roaring = nullptr;
+    }
+    this->count = 0;
+  }
+
+  /** Merges a bitmap in the accumulated union. Returns false if allocation failed. */
+  bool merge(const roaring_bitmap_t * bitmap) {
+    if (this->roaring == nullptr) {
+      this->roaring = roaring_bitmap_create();
+      if (this->roaring == nullptr) {
+        return false;
+      }
+    }
+    // Bitset conversion, as in roaring_bitmap_or_many: merging many inputs ends up in bitset containers anyway.
+    roaring_bitmap_lazy_or_inplace(this->roaring, bitmap, true);
+    ++this->count;
+    return true;
+  }
+
+  /** Repairs and returns the accumulated union, the accumulator is reset. Returns nullptr if allocation failed. */
+  roaring_bitmap_t * finish() {
+    roaring_bitmap_t * result = this->roaring;
+    if (result == nullptr) {
+      return roaring_bitmap_create();
+    }
+    roaring_bitmap_repair_after_lazy(result);
+    this->roaring = nullptr;
+    this->count = 0;
+    return result;
+  }
+};
+
+static RoaringBitmap32Accumulator * RoaringBitmap32Accumulator_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = ObjectWrap::TryUnwrap<RoaringBitmap32Accumulator>(info.This(), isolate);
+  if (self == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  return self;
+}
+
+void RoaringBitmap32Accumulator_or(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, 0);
+  if (bitmap == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Accumulator::or - argument must be a RoaringBitmap32");
+  }
+  if (!self->merge(bitmap->roaring)) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::or - failed to allocate memory");
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+/** orMany(bitmaps) or orMany(...bitmaps). All the arguments are validated before merging. */
+void RoaringBitmap32Accumulator_orMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  if (info.Length() == 1 && info[0]->IsArray()) {
+    v8::Local<v8::Array> array = info[0].As<v8::Array>();
+    const uint32_t length = array->Length();
+    bitmaps.reserve(length);
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      const RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<const RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32Accumulator::orMany - array must contain only RoaringBitmap32 instances");
+      }
+      bitmaps.push_back(bitmap->roaring);
+    }
+  } else {
+    const int length = info.Length();
+    bitmaps.reserve(length);
+    for (int i = 0; i != length; ++i) {
+      const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, i);
+      if (bitmap == nullptr) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32Accumulator::orMany - arguments must be RoaringBitmap32 instances");
+      }
+      bitmaps.push_back(bitmap->roaring);
+    }
+  }
+  for (const roaring_bitmap_t * bitmap : bitmaps) {
+    if (!self->merge(bitmap)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::orMany - failed to allocate memory");
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32Accumulator_finish(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return;
+  }
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  roaring_bitmap_t * r = self->finish();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::finish - failed to allocate memory");
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32Accumulator_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap32Accumulator * self = RoaringBitmap32Accumulator_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
+  }
+}
+
+void RoaringBitmap32Accumulator_count_getter(
+  v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap32Accumulator * self =
+    ObjectWrap::TryUnwrap<const RoaringBitmap32Accumulator>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? self->count : 0U);
+}
+
+void RoaringBitmap32Accumulator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32Accumulator> const & info) {
+  RoaringBitmap32Accumulator * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32Accumulator();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap32Accumulator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Accumulator::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32Accumulator));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32Accumulator(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Accumulator::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32Accumulator::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32Accumulator_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmap32Accumulator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32Accumulator", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32Accumulator_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "count", v8::NewStringType::kInternalized),
+    RoaringBitmap32Accumulator_count_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "count", v8::NewStringType::kInternalized),
+    RoaringBitmap32Accumulator_count_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap32Accumulator_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "finish", RoaringBitmap32Accumulator_finish);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "or", RoaringBitmap32Accumulator_or);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orMany", RoaringBitmap32Accumulator_orMany);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32Accumulator");
+  }
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_32_ACCUMULATOR_
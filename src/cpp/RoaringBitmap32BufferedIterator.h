@@ -11,6 +11,8 @@ class RoaringBitmap32BufferedIterator final : public ObjectWrap {
 
   roaring_uint32_iterator_t it;
   bool reversed;
+  /** Exclusive bound in the iteration direction, -1 or 2^32 if the iterator is not bounded. */
+  int64_t endBound;
   RoaringBitmap32 * bitmapInstance;
   int64_t bitmapVersion;
   v8utils::TypedArrayContent<uint32_t> bufferContent;
@@ -19,7 +21,7 @@ class RoaringBitmap32BufferedIterator final : public ObjectWrap {
   v8::Global<v8::Object> persistent;
 
   explicit RoaringBitmap32BufferedIterator(AddonData * addonData, bool reversed) :
-    ObjectWrap(addonData), reversed(reversed), bitmapInstance(nullptr) {
+    ObjectWrap(addonData), reversed(reversed), endBound(reversed ? -1 : 0x100000000LL), bitmapInstance(nullptr) {
     this->it.parent = nullptr;
     this->it.has_value = false;
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32BufferedIterator));
@@ -30,17 +32,50 @@ class RoaringBitmap32BufferedIterator final : public ObjectWrap {
     _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32BufferedIterator));
   }
 
-  inline uint32_t _fill() {
-    uint32_t n;
+  inline bool _outOfBounds(uint32_t value) const {
+    return this->reversed ? (int64_t)value <= this->endBound : (int64_t)value >= this->endBound;
+  }
+
+  /**
+   * Positions the iterator on the first value at or after the given one in the iteration direction,
+   * the largest value less or equal than it when reversed.
+   */
+  inline void _seek(double from) {
+    const roaring_bitmap_t * r = this->bitmapInstance->roaring;
     if (this->reversed) {
-      size_t size = this->bufferContent.length;
-      auto * data = this->bufferContent.data;
-      for (n = 0; n < size && this->it.has_value; ++n) {
-        data[n] = this->it.current_value;
-        roaring_uint32_iterator_previous(&this->it);
+      if (from >= 4294967295.0) {
+        roaring_iterator_init_last(r, &this->it);
+      } else {
+        roaring_iterator_init(r, &this->it);
+        if (from < 0) {
+          this->it.has_value = false;
+        } else {
+          // Moves past the value and steps back, CRoaring has no backward seek.
+          roaring_uint32_iterator_move_equalorlarger(&this->it, (uint32_t)std::floor(from) + 1);
+          roaring_uint32_iterator_previous(&this->it);
+        }
       }
     } else {
-      n = roaring_uint32_iterator_read(&this->it, this->bufferContent.data, this->bufferContent.length);
+      roaring_iterator_init(r, &this->it);
+      if (from > 4294967295.0) {
+        this->it.has_value = false;
+      } else if (from > 0) {
+        roaring_uint32_iterator_move_equalorlarger(&this->it, (uint32_t)std::ceil(from));
+      }
+    }
+  }
+
+  inline uint32_t _fill() {
+    uint32_t * data = this->bufferContent.data;
+    if (this->it.has_value && this->_outOfBounds(this->it.current_value)) {
+      this->it.has_value = false;
+    }
+    uint32_t n = this->reversed ? roaringIteratorReadReverse(&this->it, data, this->bufferContent.length)
+                                : roaring_uint32_iterator_read(&this->it, data, this->bufferContent.length);
+    if (n != 0 && this->_outOfBounds(data[n - 1])) {
+      // Values are sorted in the iteration direction, keep only the ones before the bound.
+      n = (uint32_t)(std::partition_point(data, data + n, [this](uint32_t v) { return !this->_outOfBounds(v); }) - data);
+      this->it.has_value = false;
     }
     if (n == 0) {
       this->bitmapInstance = nullptr;
@@ -86,6 +121,30 @@ void RoaringBitmap32BufferedIterator_fill(const v8::FunctionCallbackInfo<v8::Val
   return info.GetReturnValue().Set(instance->_fill());
 }
 
+void RoaringBitmap32BufferedIterator_seek(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap32BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), isolate);
+
+  RoaringBitmap32 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
+
+  if (bitmapInstance == nullptr) {
+    return info.GetReturnValue().Set(0U);
+  }
+
+  if (bitmapInstance->getVersion() != instance->bitmapVersion) {
+    return v8utils::throwError(isolate, "RoaringBitmap32 iterator - bitmap changed while iterating");
+  }
+
+  double from;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&from) || std::isnan(from)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32 iterator - seek value must be a number");
+  }
+
+  instance->_seek(from);
+  return info.GetReturnValue().Set(instance->_fill());
+}
+
 void RoaringBitmap32BufferedIterator_close(const v8::FunctionCallbackInfo<v8::Value> & info) {
   RoaringBitmap32BufferedIterator * instance =
     ObjectWrap::TryUnwrap<RoaringBitmap32BufferedIterator>(info.This(), info.GetIsolate());
@@ -113,7 +172,7 @@ void RoaringBitmap32BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Valu
   auto holder = info.This();
 
   if (info.Length() < 2) {
-    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs 2 or 3 arguments");
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - needs 2 to 5 arguments");
   }
 
   AddonData * addonData = AddonData::get(info);
@@ -129,6 +188,20 @@ void RoaringBitmap32BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Valu
 
   bool reversed = info.Length() > 2 && info[2]->BooleanValue(isolate);
 
+  // Optional start value and exclusive end bound, both in the iteration direction.
+  double from = reversed ? 4294967295.0 : 0;
+  double to = reversed ? -1 : 4294967296.0;
+  if (info.Length() > 3 && !info[3]->IsUndefined()) {
+    if (!info[3]->IsNumber() || !info[3]->NumberValue(isolate->GetCurrentContext()).To(&from) || std::isnan(from)) {
+      return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - from must be a number");
+    }
+  }
+  if (info.Length() > 4 && !info[4]->IsUndefined()) {
+    if (!info[4]->IsNumber() || !info[4]->NumberValue(isolate->GetCurrentContext()).To(&to) || std::isnan(to)) {
+      return v8utils::throwTypeError(isolate, "RoaringBitmap32BufferedIterator::ctor - to must be a number");
+    }
+  }
+
   auto bufferObject = info[1];
 
   if (!bufferObject->IsUint32Array()) {
@@ -176,11 +249,10 @@ void RoaringBitmap32BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Valu
 
   instance->bufferContent.set(isolate, bufferObject);
 
-  if (reversed) {
-    roaring_iterator_init_last(bitmapInstance->roaring, &instance->it);
-  } else {
-    roaring_iterator_init(bitmapInstance->roaring, &instance->it);
-  }
+  // A value on the other side of a bound is never returned, so the bound is clamped to [-1, 2^32].
+  instance->endBound = (int64_t)(reversed ? std::floor(std::max(-1.0, std::min(to, 4294967296.0)))
+                                          : std::ceil(std::max(-1.0, std::min(to, 4294967296.0))));
+  instance->_seek(from);
 
   uint32_t n = instance->_fill();
 
@@ -204,6 +276,7 @@ void RoaringBitmap32BufferedIterator_Init(v8::Local<v8::Object> exports, AddonDa
 
   NODE_SET_PROTOTYPE_METHOD(ctor, "fill", RoaringBitmap32BufferedIterator_fill);
   NODE_SET_PROTOTYPE_METHOD(ctor, "close", RoaringBitmap32BufferedIterator_close);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "seek", RoaringBitmap32BufferedIterator_seek);
 
   auto ctorFunctionMaybe = ctor->GetFunction(isolate->GetCurrentContext());
   v8::Local<v8::Function> ctorFunction;
@@ -0,0 +1,210 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
+#define ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
+
+#include "RoaringBitmap32.h"
+
+/**
+ * Adds values to a bitmap in batches: JS fills a reusable Uint32Array and flush adds the first n values of it,
+ * with a single native call and a bulk context that is kept across flushes while the bitmap is not changed elsewhere.
+ */
+class RoaringBitmap32BulkWriter final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152425700;
+
+  static const constexpr uint32_t DEFAULT_CAPACITY = 4096;
+
+  RoaringBitmap32 * bitmapInstance;
+  /**
+   * The version of the bitmap after the last flush, the bulk context is valid only while it does not change.
+   * Every operation that can move, convert or reallocate containers changes the version, runOptimize and shrinkToFit too.
+   */
+  int64_t bitmapVersion;
+  roaring_bulk_context_t bulkContext;
+  v8utils::TypedArrayContent<uint32_t> bufferContent;
+
+  v8::Global<v8::Object> bitmap;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmap32BulkWriter(AddonData * addonData, RoaringBitmap32 * bitmapInstance) :
+    ObjectWrap(addonData), bitmapInstance(bitmapInstance), bitmapVersion(-1), bulkContext() {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32BulkWriter));
+  }
+
+  ~RoaringBitmap32BulkWriter() {
+    this->bitmap.Reset();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32BulkWriter));
+  }
+
+  void flush(size_t count) {
+    RoaringBitmap32 * target = this->bitmapInstance;
+    if (target->getVersion() != this->bitmapVersion) {
+      // The cached container may have been moved or converted by other operations on the bitmap.
+      this->bulkContext = roaring_bulk_context_t();
+    }
+    roaring_bitmap_t * r = target->roaring;
+    const uint32_t * values = this->bufferContent.data;
+    for (size_t i = 0; i != count; ++i) {
+      roaring_bitmap_add_bulk(r, &this->bulkContext, values[i]);
+    }
+    target->invalidate();
+    this->bitmapVersion = target->getVersion();
+  }
+};
+
+/** Allocates a zeroed Uint32Array of the given length, on a 32 bytes aligned memory block. */
+static bool RoaringBitmap32BulkWriter_allocBuffer(v8::Isolate * isolate, uint32_t length, v8::Local<v8::Value> & result) {
+  const size_t size = (size_t)length * sizeof(uint32_t);
+  void * ptr = bare_aligned_malloc(32, size);
+  if (ptr == nullptr) {
+    return false;
+  }
+  memset(ptr, 0, size);
+  auto backingStore = v8::ArrayBuffer::NewBackingStore(ptr, size, bare_aligned_free_callback2, nullptr);
+  if (!backingStore) {
+    bare_aligned_free(ptr);
+    return false;
+  }
+  v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, std::move(backingStore));
+  if (arrayBuffer.IsEmpty()) {
+    return false;
+  }
+  v8::Local<v8::Uint32Array> array = v8::Uint32Array::New(arrayBuffer, 0, length);
+  if (array.IsEmpty()) {
+    return false;
+  }
+  result = array;
+  return true;
+}
+
+void RoaringBitmap32BulkWriter_flush(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32BulkWriter * self = ObjectWrap::TryUnwrap<RoaringBitmap32BulkWriter>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  if (self->bitmapInstance->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  size_t count = self->bufferContent.length;
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    uint32_t n;
+    if (!v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[0], n) || n > self->bufferContent.length) {
+      return v8utils::throwTypeError(
+        isolate, "RoaringBitmap32BulkWriter::flush - count must be an integer between 0 and the buffer length");
+    }
+    count = n;
+  }
+
+  self->flush(count);
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap32BulkWriter_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32BulkWriter> const & info) {
+  RoaringBitmap32BulkWriter * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32BulkWriter();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap32BulkWriter_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BulkWriter::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  RoaringBitmap32 * bitmapInstance = info.Length() > 0 ? ObjectWrap::TryUnwrap<RoaringBitmap32>(info[0], isolate) : nullptr;
+  if (bitmapInstance == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32BulkWriter::ctor - first argument must be a RoaringBitmap32");
+  }
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  // The buffer is a Uint32Array provided by the caller, or a new aligned one of the given length.
+  v8::Local<v8::Value> bufferObject;
+  if (info.Length() > 1 && info[1]->IsUint32Array()) {
+    bufferObject = info[1];
+  } else {
+    uint32_t capacity = RoaringBitmap32BulkWriter::DEFAULT_CAPACITY;
+    if (info.Length() > 1 && !info[1]->IsUndefined()) {
+      if (!v8utils::v8ValueToUint32Fast(context, info[1], capacity) || capacity == 0 || capacity > 0x10000000) {
+        return v8utils::throwTypeError(
+          isolate, "RoaringBitmap32BulkWriter::ctor - buffer must be a Uint32Array or a positive length");
+      }
+    }
+    if (!RoaringBitmap32BulkWriter_allocBuffer(isolate, capacity, bufferObject)) {
+      return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - buffer allocation failed");
+    }
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32BulkWriter));
+  auto * instance =
+    instanceMemory ? new (instanceMemory) RoaringBitmap32BulkWriter(addonData, bitmapInstance) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32BulkWriter::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32BulkWriter_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  // The bitmap is kept alive by the writer.
+  instance->bitmap.Reset(isolate, info[0].As<v8::Object>());
+  instance->bufferContent.set(isolate, bufferObject);
+
+  const auto attributes = (v8::PropertyAttribute)(v8::ReadOnly | v8::DontDelete);
+  if (
+    holder
+      ->DefineOwnProperty(
+        context, NEW_LITERAL_V8_STRING(isolate, "bitmap", v8::NewStringType::kInternalized), info[0], attributes)
+      .IsNothing() ||
+    holder
+      ->DefineOwnProperty(
+        context, NEW_LITERAL_V8_STRING(isolate, "buffer", v8::NewStringType::kInternalized), bufferObject, attributes)
+      .IsNothing()) {
+    return v8utils::throwError(isolate, "RoaringBitmap32BulkWriter::ctor - instantiation failed");
+  }
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmap32BulkWriter_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32BulkWriter", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32BulkWriter_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "flush", RoaringBitmap32BulkWriter_flush);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32BulkWriter");
+  }
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_32_BULK_WRITER_
@@ -0,0 +1,321 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_32_PACK_
+#define ROARING_NODE_ROARING_BITMAP_32_PACK_
+
+#include "RoaringBitmap32.h"
+#include "serialization-pack.h"
+
+/**
+ * A bitmap pack file opened for reading.
+ * The file is memory mapped, bitmaps are deserialized or viewed one at a time when requested.
+ */
+class RoaringBitmap32Pack final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F41525B0000;
+
+  const uint8_t * data;
+  size_t size;
+  bool isMmap;
+  RoaringBitmapPackFormat format;
+  uint32_t count;
+  const RoaringBitmapPackEntry * entries;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmap32Pack(AddonData * addonData) :
+    ObjectWrap(addonData),
+    data(nullptr),
+    size(0),
+    isMmap(false),
+    format(RoaringBitmapPackFormat::INVALID),
+    count(0),
+    entries(nullptr) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap32Pack));
+  }
+
+  ~RoaringBitmap32Pack() {
+    this->unmap();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap32Pack));
+  }
+
+  WorkerError map(const std::string & filePath) {
+    int fd = open(filePath.c_str(), O_RDONLY | O_BINARY);
+    if (fd == -1) {
+      return WorkerError::from_errno("open", filePath);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      WorkerError err = WorkerError::from_errno("fstat", filePath);
+      close(fd);
+      return err;
+    }
+
+    const size_t fileSize = (size_t)st.st_size;
+    if (fileSize < sizeof(RoaringBitmapPackHeader)) {
+      close(fd);
+      return WorkerError("RoaringBitmap32Pack - the file is not a valid bitmap pack");
+    }
+
+    void * buf = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (buf != MAP_FAILED) {
+      this->isMmap = true;
+    } else {
+      // mmap failed, try to read the file into a buffer
+      buf = gcaware_aligned_malloc(32, fileSize);
+      if (buf == nullptr) {
+        WorkerError err = WorkerError::from_errno("mmap", filePath);
+        close(fd);
+        return err;
+      }
+      ssize_t bytesRead = read(fd, buf, fileSize);
+      if (bytesRead == -1 || (size_t)bytesRead != fileSize) {
+        WorkerError err = bytesRead == -1 ? WorkerError::from_errno("read", filePath)
+                                          : WorkerError("RoaringBitmap32Pack - read less bytes than expected");
+        gcaware_aligned_free(buf);
+        close(fd);
+        return err;
+      }
+    }
+    close(fd);
+
+    this->data = (const uint8_t *)buf;
+    this->size = fileSize;
+
+    this->entries = roaringPackValidate(this->data, this->size, this->format, this->count);
+    if (this->entries == nullptr) {
+      this->unmap();
+      return WorkerError("RoaringBitmap32Pack - the file is not a valid bitmap pack");
+    }
+    return WorkerError();
+  }
+
+  /** Gets the body of the bitmap at the given index. Returns nullptr if the entry is out of the file. */
+  const char * body(uint32_t index, size_t & length) const {
+    RoaringBitmapPackEntry entry;
+    memcpy(&entry, this->entries + index, sizeof(entry));
+    if (entry.offset > this->size || entry.length > this->size - entry.offset || entry.offset % ROARING_PACK_ALIGNMENT != 0) {
+      return nullptr;
+    }
+    length = (size_t)entry.length;
+    return (const char *)this->data + entry.offset;
+  }
+
+  /** Creates a frozen view of the bitmap at the given index, over the mapped file. Returns nullptr if the body is invalid. */
+  roaring_bitmap_t * frozenView(uint32_t index) const {
+    size_t length;
+    const char * buf = this->body(index, length);
+    if (buf == nullptr) {
+      return nullptr;
+    }
+    if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+      return const_cast<roaring_bitmap_t *>(roaring_bitmap_frozen_view(buf, length));
+    }
+    // Checks the structure first, roaring_bitmap_portable_deserialize_frozen does not validate the input.
+    if (roaring_bitmap_portable_deserialize_size(buf, length) != length) {
+      return nullptr;
+    }
+    return roaring_bitmap_portable_deserialize_frozen(buf);
+  }
+
+  /** Deserializes a copy of the bitmap at the given index. Returns nullptr if the body is invalid. */
+  roaring_bitmap_t * deserialize(uint32_t index) const {
+    if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+      roaring_bitmap_t * view = this->frozenView(index);
+      if (view == nullptr) {
+        return nullptr;
+      }
+      roaring_bitmap_t * result = roaring_bitmap_copy(view);
+      roaring_bitmap_free(view);
+      return result;
+    }
+    size_t length;
+    const char * buf = this->body(index, length);
+    return buf != nullptr ? roaring_bitmap_portable_deserialize_safe(buf, length) : nullptr;
+  }
+
+ private:
+  void unmap() {
+    if (this->data == nullptr) {
+      return;
+    }
+    if (this->isMmap) {
+      munmap((void *)this->data, this->size);
+    } else {
+      gcaware_aligned_free((void *)this->data);
+    }
+    this->data = nullptr;
+    this->entries = nullptr;
+    this->count = 0;
+  }
+};
+
+static bool RoaringBitmap32Pack_getIndex(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmap32Pack *& pack, uint32_t & index) {
+  v8::Isolate * isolate = info.GetIsolate();
+  pack = ObjectWrap::TryUnwrap<RoaringBitmap32Pack>(info.This(), isolate);
+  if (pack == nullptr) {
+    v8utils::throwError(isolate, "RoaringBitmap32Pack - invalid object");
+    return false;
+  }
+  double n;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&n)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmap32Pack - index must be a number");
+    return false;
+  }
+  if (!(n >= 0 && n < pack->count) || n != (double)(uint32_t)n) {
+    v8utils::throwError(isolate, "RoaringBitmap32Pack - index out of range");
+    return false;
+  }
+  index = (uint32_t)n;
+  return true;
+}
+
+static bool RoaringBitmap32Pack_newBitmap(
+  RoaringBitmap32Pack * pack, v8::Local<v8::Object> & result, RoaringBitmap32 *& bitmap) {
+  v8::Isolate * isolate = pack->isolate;
+  v8::Local<v8::Function> cons = pack->addonData->RoaringBitmap32_constructor.Get(isolate);
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return false;
+  }
+  bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return false;
+  }
+  return true;
+}
+
+void RoaringBitmap32Pack_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Pack * pack;
+  uint32_t index;
+  if (!RoaringBitmap32Pack_getIndex(info, pack, index)) {
+    return;
+  }
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * bitmap;
+  if (!RoaringBitmap32Pack_newBitmap(pack, result, bitmap)) {
+    return;
+  }
+
+  roaring_bitmap_t * r = pack->deserialize(index);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::get - failed to deserialize the bitmap");
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32Pack_view(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap32Pack * pack;
+  uint32_t index;
+  if (!RoaringBitmap32Pack_getIndex(info, pack, index)) {
+    return;
+  }
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap32 * bitmap;
+  if (!RoaringBitmap32Pack_newBitmap(pack, result, bitmap)) {
+    return;
+  }
+
+  roaring_bitmap_t * r = pack->frozenView(index);
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::view - failed to create a frozen view");
+  }
+
+  bitmap->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+  bitmap->replaceBitmapInstance(isolate, r);
+  // The view reads from the mapped file, it keeps the pack alive.
+  bitmap->frozenStorage.bufferPersistent.Reset(isolate, info.This());
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap32Pack_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap32Pack> const & info) {
+  RoaringBitmap32Pack * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap32Pack();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap32Pack_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Pack::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  if (info.Length() < 1 || !info[0]->IsString()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap32Pack::ctor - expects a file path as the first argument");
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap32Pack));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap32Pack(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap32Pack::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap32Pack::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap32Pack_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+  WorkerError error = instance->map(std::string(*filePathUtf8, filePathUtf8.length()));
+  if (error.hasError()) {
+    isolate->ThrowException(error.newV8Error(isolate));
+    return;
+  }
+
+  v8utils::defineReadonlyField(isolate, holder, "length", v8::Uint32::NewFromUnsigned(isolate, instance->count));
+  v8utils::defineReadonlyField(
+    isolate,
+    holder,
+    "format",
+    instance->format == RoaringBitmapPackFormat::unsafe_frozen_croaring
+      ? NEW_LITERAL_V8_STRING(isolate, "unsafe_frozen_croaring", v8::NewStringType::kInternalized)
+      : NEW_LITERAL_V8_STRING(isolate, "portable", v8::NewStringType::kInternalized));
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmap32Pack_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap32Pack", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap32Pack_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmap32Pack_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "view", RoaringBitmap32Pack_view);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap32Pack");
+  }
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_32_PACK_
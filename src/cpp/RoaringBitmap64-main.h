@@ -0,0 +1,1424 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_64_MAIN_
+#define ROARING_NODE_ROARING_BITMAP_64_MAIN_
+
+#include "RoaringBitmap64.h"
+
+/** Adds values one by one, reusing the roaring bulk context while consecutive values share the same high 32 bits. */
+class RoaringBitmap64BulkAdder final {
+ public:
+  RoaringBitmap64Buckets & buckets;
+  roaring_bitmap_t * bitmap;
+  uint32_t high;
+  roaring_bulk_context_t context;
+
+  explicit RoaringBitmap64BulkAdder(RoaringBitmap64Buckets & buckets) : buckets(buckets), bitmap(nullptr), high(0), context() {}
+
+  inline bool add(uint64_t value) {
+    const uint32_t h = (uint32_t)(value >> 32);
+    if (this->bitmap == nullptr || h != this->high) {
+      this->bitmap = this->buckets.getOrCreate(h);
+      if (this->bitmap == nullptr) {
+        return false;
+      }
+      this->high = h;
+      this->context = roaring_bulk_context_t();
+    }
+    roaring_bitmap_add_bulk(this->bitmap, &this->context, (uint32_t)value);
+    return true;
+  }
+};
+
+bool roaring64AddUint64Array(RoaringBitmap64Buckets & buckets, const uint64_t * values, size_t length) {
+  RoaringBitmap64BulkAdder adder(buckets);
+  for (size_t i = 0; i < length; ++i) {
+    if (!adder.add(values[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void roaring64RemoveUint64Array(RoaringBitmap64Buckets & buckets, const uint64_t * values, size_t length) {
+  roaring_bitmap_t * bitmap = nullptr;
+  uint32_t high = 0;
+  for (size_t i = 0; i < length; ++i) {
+    const uint64_t value = values[i];
+    const uint32_t h = (uint32_t)(value >> 32);
+    if (bitmap == nullptr || h != high) {
+      bitmap = buckets.get(h);
+      high = h;
+      if (bitmap == nullptr) {
+        continue;
+      }
+    }
+    roaring_bitmap_remove(bitmap, (uint32_t)value);
+  }
+  buckets.compact();
+}
+
+/**
+ * Returns true if value is a BigInt outside the uint64 range, throwing a RangeError.
+ * Other invalid values are left to the caller.
+ */
+inline bool roaring64ThrowIfBigIntOutOfRange(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+  if (value.IsEmpty() || !value->IsBigInt()) {
+    return false;
+  }
+  bool lossless = false;
+  value.As<v8::BigInt>()->Uint64Value(&lossless);
+  if (lossless) {
+    return false;
+  }
+  v8utils::throwRangeError(isolate, ERROR_UINT64_RANGE);
+  return true;
+}
+
+/**
+ * Converts a JS array or iterable of numbers and bigints.
+ * Returns false if the conversion failed, or if any of the values is not a valid uint64; a BigInt outside the uint64
+ * range throws a RangeError.
+ */
+template <typename F>
+bool roaring64ForEachArrayValue(v8::Isolate * isolate, AddonData * addonData, v8::Local<v8::Value> arg, F fn) {
+  auto context = isolate->GetCurrentContext();
+  v8::Local<v8::Value> arrayValue = arg;
+  if (!arg->IsArray()) {
+    v8::Local<v8::Value> argv[] = {arg};
+    if (!addonData->Array_from.Get(isolate)->Call(context, v8::Undefined(isolate), 1, argv).ToLocal(&arrayValue)) {
+      return false;
+    }
+    if (!arrayValue->IsArray()) {
+      return false;
+    }
+  }
+  v8::Local<v8::Array> array = arrayValue.As<v8::Array>();
+  const uint32_t length = array->Length();
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < length; ++i) {
+    v8::Local<v8::Value> item;
+    if (!array->Get(context, i).ToLocal(&item)) {
+      return false;
+    }
+    if (!v8utils::v8ValueToUint64Fast(context, item, v)) {
+      roaring64ThrowIfBigIntOutOfRange(isolate, item);
+      return false;
+    }
+    if (!fn(v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Adds the values of a JS array, an iterable, a typed array or a bitmap.
+ * Returns false if the argument is not valid; allocation failures and out of range BigInts also throw.
+ */
+inline bool roaring64AddMany(v8::Isolate * isolate, RoaringBitmap64 * self, v8::Local<v8::Value> arg, bool replace = false) {
+  if (self->isFrozen()) {
+    v8utils::throwError(isolate, ERROR_FROZEN);
+    return false;
+  }
+
+  if (arg.IsEmpty()) {
+    return false;
+  }
+
+  if (arg->IsNullOrUndefined()) {
+    if (replace) {
+      self->buckets.clear();
+      self->invalidate();
+    }
+    return true;
+  }
+
+  if (!arg->IsObject()) {
+    return false;
+  }
+
+  RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(arg, isolate);
+  if (other != nullptr) {
+    if (self != other) {
+      bool copied;
+      if (replace || self->isEmpty()) {
+        copied = self->buckets.copyFrom(other->buckets);
+      } else {
+        RoaringBitmap64Buckets result;
+        copied = roaring64BucketsOperation(RoaringBitmap64Operation::OR, self->buckets, other->buckets, result, true);
+        self->buckets.swap(result);
+      }
+      self->invalidate();
+      if (!copied) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (replace) {
+    self->buckets.clear();
+  }
+  self->invalidate();
+
+  if (arg->IsBigUint64Array() || arg->IsBigInt64Array()) {
+    const v8utils::TypedArrayContent<uint64_t> typedArray(isolate, arg);
+    if (!roaring64AddUint64Array(self->buckets, typedArray.data, typedArray.length)) {
+      v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+      return false;
+    }
+    return true;
+  }
+
+  if (arg->IsUint32Array() || arg->IsInt32Array()) {
+    const v8utils::TypedArrayContent<uint32_t> typedArray(isolate, arg);
+    if (typedArray.length != 0) {
+      roaring_bitmap_t * bitmap = self->buckets.getOrCreate(0);
+      if (bitmap == nullptr) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+      roaring_bitmap_add_many(bitmap, typedArray.length, typedArray.data);
+    }
+    return true;
+  }
+
+  RoaringBitmap32 * other32 = ObjectWrap::TryUnwrap<RoaringBitmap32>(arg, isolate);
+  if (other32 != nullptr) {
+    if (!other32->isEmpty()) {
+      roaring_bitmap_t * bitmap = self->buckets.getOrCreate(0);
+      if (bitmap == nullptr) {
+        v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+        return false;
+      }
+      roaring_bitmap_or_inplace(bitmap, other32->roaring);
+    }
+    return true;
+  }
+
+  RoaringBitmap64BulkAdder adder(self->buckets);
+  return roaring64ForEachArrayValue(isolate, self->addonData, arg, [isolate, &adder](uint64_t v) {
+    if (!adder.add(v)) {
+      v8utils::throwError(isolate, "RoaringBitmap64::addMany - failed to allocate memory");
+      return false;
+    }
+    return true;
+  });
+}
+
+/** Parses the [rangeStart, rangeEnd) arguments. rangeEnd can be up to 2^64. Returns false if the range is empty. */
+inline bool getRange64OperationParameters(
+  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & minimum, uint64_t & maximumInclusive) {
+  minimum = 0;
+  maximumInclusive = UINT64_MAX;
+
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    auto arg = info[0];
+    if (arg->IsBigInt()) {
+      int sign = 0;
+      int wordCount = 1;
+      uint64_t word = 0;
+      arg.As<v8::BigInt>()->ToWordsArray(&sign, &wordCount, &word);
+      if (sign == 0) {
+        if (wordCount > 1) {
+          return false;
+        }
+        minimum = word;
+      }
+    } else if (arg->IsNumber()) {
+      double d = arg.As<v8::Number>()->Value();
+      if (std::isnan(d) || d >= 18446744073709551616.0) {
+        return false;
+      }
+      if (d > 0) {
+        minimum = (uint64_t)ceil(d);
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    auto arg = info[1];
+    if (arg->IsBigInt()) {
+      int sign = 0;
+      int wordCount = 2;
+      uint64_t words[2] = {0, 0};
+      arg.As<v8::BigInt>()->ToWordsArray(&sign, &wordCount, words);
+      if (sign != 0 || wordCount == 0 || (wordCount == 1 && words[0] == 0)) {
+        return false;
+      }
+      if (wordCount == 1) {
+        maximumInclusive = words[0] - 1;
+      }
+    } else if (arg->IsNumber()) {
+      double d = arg.As<v8::Number>()->Value();
+      if (std::isnan(d) || d <= 0) {
+        return false;
+      }
+      if (d < 18446744073709551616.0) {
+        maximumInclusive = (uint64_t)ceil(d) - 1;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return minimum <= maximumInclusive;
+}
+
+void RoaringBitmap64_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap64> const & info) {
+  RoaringBitmap64 * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap64();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap64_addMany(const v8::FunctionCallbackInfo<v8::Value> & info);
+
+void RoaringBitmap64_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+
+  if (!info.IsConstructCall()) {
+    v8::Local<v8::Function> cons = addonData->RoaringBitmap64_constructor.Get(isolate);
+    v8::MaybeLocal<v8::Object> v;
+    if (info.Length() < 1) {
+      v = cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr);
+    } else {
+      v8::Local<v8::Value> argv[1] = {info[0]};
+      v = cons->NewInstance(isolate->GetCurrentContext(), 1, argv);
+    }
+
+    v8::Local<v8::Object> vlocal;
+    if (v.ToLocal(&vlocal)) {
+      info.GetReturnValue().Set(vlocal);
+    }
+    return;
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap64));
+  RoaringBitmap64 * instance = instanceMemory ? new (instanceMemory) RoaringBitmap64(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::ctor - failed to create RoaringBitmap64 instance");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap64::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap64_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  if (info.Length() != 0 && !info[0]->IsNullOrUndefined() && !info[0]->IsNumber()) {
+    RoaringBitmap64_addMany(info);
+  }
+
+  info.GetReturnValue().Set(holder);
+}
+
+inline bool RoaringBitmap64_newInstance(
+  v8::Isolate * isolate, AddonData * addonData, v8::Local<v8::Object> & result, RoaringBitmap64 *& instance) {
+  if (!addonData->RoaringBitmap64_constructor.Get(isolate)->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    return false;
+  }
+  instance = ObjectWrap::TryUnwrap<RoaringBitmap64>(result, isolate);
+  if (instance == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+    return false;
+  }
+  return true;
+}
+
+void RoaringBitmap64_ofStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  auto context = isolate->GetCurrentContext();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
+    }
+  }
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
+  }
+
+  RoaringBitmap64BulkAdder adder(self->buckets);
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && !adder.add(v)) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::of - failed to allocate memory");
+    }
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_getInstanceCountStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  AddonData * addonData = AddonData::get(info);
+  info.GetReturnValue().Set(addonData ? (double)(addonData->RoaringBitmap64_instances) : 0.0);
+}
+
+void RoaringBitmap64_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
+  auto size = self != nullptr ? self->getSize() : 0U;
+  return size <= 0xFFFFFFFF ? info.GetReturnValue().Set((uint32_t)size) : info.GetReturnValue().Set((double)size);
+}
+
+void RoaringBitmap64_isEmpty_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self == nullptr || self->isEmpty());
+}
+
+void RoaringBitmap64_isFrozen_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self == nullptr || self->isFrozen());
+}
+
+void RoaringBitmap64_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<const RoaringBitmap64>(info.This(), isolate);
+  uint64_t v;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], v) &&
+    self->contains(v));
+}
+
+void RoaringBitmap64_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
+    }
+  }
+
+  info.GetReturnValue().Set(info.This());
+
+  bool changed = false;
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->addChecked(v)) {
+      changed = true;
+    }
+  }
+  if (changed) {
+    self->invalidate();
+  }
+}
+
+void RoaringBitmap64_tryAdd(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  const int len = info.Length();
+  for (int i = 0; i < len; ++i) {
+    if (roaring64ThrowIfBigIntOutOfRange(isolate, info[i])) {
+      return;
+    }
+  }
+
+  bool changed = false;
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->addChecked(v)) {
+      changed = true;
+    }
+  }
+  if (changed) {
+    self->invalidate();
+  }
+  info.GetReturnValue().Set(changed);
+}
+
+void RoaringBitmap64_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+
+  bool changed = false;
+  const int len = info.Length();
+  auto context = isolate->GetCurrentContext();
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) {
+    if (v8utils::v8ValueToUint64Fast(context, info[i], v) && self->removeChecked(v)) {
+      changed = true;
+    }
+  }
+  if (changed) {
+    self->invalidate();
+  }
+  info.GetReturnValue().Set(changed);
+}
+
+void RoaringBitmap64_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    v8::TryCatch tryCatch(isolate);
+    bool added = roaring64AddMany(isolate, self, info[0]);
+    if (tryCatch.HasCaught()) {
+      tryCatch.ReThrow();
+      return;
+    }
+    if (added) {
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
+}
+
+void RoaringBitmap64_removeMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0 && info[0]->IsObject()) {
+    auto arg = info[0];
+    RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(arg, isolate);
+    if (other != nullptr) {
+      if (other == self) {
+        self->buckets.clear();
+      } else {
+        RoaringBitmap64Buckets result;
+        roaring64BucketsOperation(RoaringBitmap64Operation::ANDNOT, self->buckets, other->buckets, result, true);
+        self->buckets.swap(result);
+      }
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    if (arg->IsBigUint64Array() || arg->IsBigInt64Array()) {
+      const v8utils::TypedArrayContent<uint64_t> typedArray(isolate, arg);
+      roaring64RemoveUint64Array(self->buckets, typedArray.data, typedArray.length);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+
+    RoaringBitmap64 tmp(self->addonData);
+    v8::TryCatch tryCatch(isolate);
+    const bool added = roaring64AddMany(isolate, &tmp, arg);
+    if (tryCatch.HasCaught()) {
+      tryCatch.ReThrow();
+      return;
+    }
+    if (added) {
+      RoaringBitmap64Buckets result;
+      roaring64BucketsOperation(RoaringBitmap64Operation::ANDNOT, self->buckets, tmp.buckets, result, true);
+      self->buckets.swap(result);
+      self->invalidate();
+      return info.GetReturnValue().Set(info.This());
+    }
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
+}
+
+template <RoaringBitmap64Operation OP>
+void RoaringBitmap64_opInPlace(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (info.Length() > 0) {
+    RoaringBitmap64 tmp(self->addonData);
+    RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info[0], isolate);
+    if (other == nullptr) {
+      v8::TryCatch tryCatch(isolate);
+      const bool added = roaring64AddMany(isolate, &tmp, info[0]);
+      if (tryCatch.HasCaught()) {
+        tryCatch.ReThrow();
+        return;
+      }
+      if (!added) {
+        return v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
+      }
+      other = &tmp;
+    }
+    if (other == self) {
+      if (OP == RoaringBitmap64Operation::XOR || OP == RoaringBitmap64Operation::ANDNOT) {
+        self->buckets.clear();
+      }
+    } else {
+      RoaringBitmap64Buckets result;
+      roaring64BucketsOperation(OP, self->buckets, other->buckets, result, true);
+      self->buckets.swap(result);
+    }
+    self->invalidate();
+    return info.GetReturnValue().Set(info.This());
+  }
+  v8utils::throwTypeError(isolate, "BigUint64Array, RoaringBitmap64 or Iterable<bigint | number> expected");
+}
+
+template <RoaringBitmap64Operation OP>
+void RoaringBitmap64_opStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+
+  RoaringBitmap64 * a = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  RoaringBitmap64 * b = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 1);
+  if (a == nullptr || b == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 operation expects two RoaringBitmap64 arguments");
+  }
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
+  }
+
+  if (!roaring64BucketsOperation(OP, a->buckets, b->buckets, self->buckets, false)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 operation failed to allocate memory");
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
+
+uint64_t roaring64AndCardinality(const RoaringBitmap64Buckets & a, const RoaringBitmap64Buckets & b) {
+  uint64_t result = 0;
+  for (uint32_t i = 0, j = 0; i < a.count && j < b.count;) {
+    if (a.items[i].high < b.items[j].high) {
+      ++i;
+    } else if (b.items[j].high < a.items[i].high) {
+      ++j;
+    } else {
+      result += roaring_bitmap_and_cardinality(a.items[i++].bitmap, b.items[j++].bitmap);
+    }
+  }
+  return result;
+}
+
+/** The other cardinalities are derived from |a|, |b| and |a and b|. */
+inline bool roaring64GetCardinalities(
+  const v8::FunctionCallbackInfo<v8::Value> & info, uint64_t & sizeA, uint64_t & sizeB, uint64_t & sizeAnd) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return false;
+  }
+  sizeAnd = roaring64AndCardinality(self->buckets, other->buckets);
+  sizeA = self->getSize();
+  sizeB = other->getSize();
+  return true;
+}
+
+void RoaringBitmap64_andCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)ab : -1);
+}
+
+void RoaringBitmap64_orCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a + b - ab) : -1);
+}
+
+void RoaringBitmap64_andNotCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a - ab) : -1);
+}
+
+void RoaringBitmap64_xorCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  uint64_t a, b, ab;
+  info.GetReturnValue().Set(roaring64GetCardinalities(info, a, b, ab) ? (double)(a + b - 2 * ab) : -1);
+}
+
+void RoaringBitmap64_intersects(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return info.GetReturnValue().Set(false);
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  for (uint32_t i = 0, j = 0; i < a.count && j < b.count;) {
+    if (a.items[i].high < b.items[j].high) {
+      ++i;
+    } else if (b.items[j].high < a.items[i].high) {
+      ++j;
+    } else if (roaring_bitmap_intersect(a.items[i++].bitmap, b.items[j++].bitmap)) {
+      return info.GetReturnValue().Set(true);
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+inline bool roaring64IsSubset(const RoaringBitmap64 * self, const RoaringBitmap64 * other) {
+  if (self == other) {
+    return true;
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  if (a.count > b.count) {
+    return false;
+  }
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < a.count; ++i) {
+    while (j < b.count && b.items[j].high < a.items[i].high) {
+      ++j;
+    }
+    if (j >= b.count || b.items[j].high != a.items[i].high || !roaring_bitmap_is_subset(a.items[i].bitmap, b.items[j].bitmap)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RoaringBitmap64_isSubset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring64IsSubset(self, other));
+}
+
+void RoaringBitmap64_isSuperset(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  info.GetReturnValue().Set(self && other && roaring64IsSubset(other, self));
+}
+
+void RoaringBitmap64_isEqual(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  const RoaringBitmap64 * other = ObjectWrap::TryUnwrap<RoaringBitmap64>(info, 0);
+  if (!self || !other) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (self == other) {
+    return info.GetReturnValue().Set(true);
+  }
+  const RoaringBitmap64Buckets & a = self->buckets;
+  const RoaringBitmap64Buckets & b = other->buckets;
+  if (a.count != b.count) {
+    return info.GetReturnValue().Set(false);
+  }
+  for (uint32_t i = 0; i < a.count; ++i) {
+    if (a.items[i].high != b.items[i].high || !roaring_bitmap_equals(a.items[i].bitmap, b.items[i].bitmap)) {
+      return info.GetReturnValue().Set(false);
+    }
+  }
+  info.GetReturnValue().Set(true);
+}
+
+void RoaringBitmap64_minimum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self != nullptr && !self->isEmpty()) {
+    const RoaringBitmap64Bucket & bucket = self->buckets.items[0];
+    const uint64_t v = ((uint64_t)bucket.high << 32) | roaring_bitmap_minimum(bucket.bitmap);
+    info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, v));
+  }
+}
+
+void RoaringBitmap64_maximum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self != nullptr && !self->isEmpty()) {
+    const RoaringBitmap64Bucket & bucket = self->buckets.items[self->buckets.count - 1];
+    const uint64_t v = ((uint64_t)bucket.high << 32) | roaring_bitmap_maximum(bucket.bitmap);
+    info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, v));
+  }
+}
+
+void RoaringBitmap64_rank(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  uint64_t v;
+  if (self == nullptr || info.Length() < 1 || !v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], v)) {
+    return info.GetReturnValue().Set(0);
+  }
+  const uint32_t high = (uint32_t)(v >> 32);
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  uint64_t result = 0;
+  for (uint32_t i = 0; i < buckets.count && buckets.items[i].high <= high; ++i) {
+    if (buckets.items[i].high < high) {
+      result += roaring_bitmap_get_cardinality(buckets.items[i].bitmap);
+    } else {
+      result += roaring_bitmap_rank(buckets.items[i].bitmap, (uint32_t)v);
+    }
+  }
+  info.GetReturnValue().Set((double)result);
+}
+
+void RoaringBitmap64_select(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  uint64_t rank;
+  if (self == nullptr || info.Length() < 1 || !v8utils::v8ValueToUint64Fast(isolate->GetCurrentContext(), info[0], rank)) {
+    return;
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    const uint64_t card = roaring_bitmap_get_cardinality(buckets.items[i].bitmap);
+    if (rank < card) {
+      uint32_t low;
+      if (roaring_bitmap_select(buckets.items[i].bitmap, (uint32_t)rank, &low)) {
+        info.GetReturnValue().Set(v8::BigInt::NewFromUnsigned(isolate, ((uint64_t)buckets.items[i].high << 32) | low));
+      }
+      return;
+    }
+    rank -= card;
+  }
+}
+
+void RoaringBitmap64_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (!self) {
+    return info.GetReturnValue().Set(false);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  if (self->isEmpty()) {
+    return info.GetReturnValue().Set(false);
+  }
+  self->buckets.clear();
+  self->invalidate();
+  info.GetReturnValue().Set(true);
+}
+
+void RoaringBitmap64_clone(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * instance;
+  if (!RoaringBitmap64_newInstance(isolate, self->addonData, result, instance)) {
+    return;
+  }
+  if (!instance->buckets.copyFrom(self->buckets)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::clone failed to allocate memory");
+  }
+  instance->invalidate();
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_freeze(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  if (self && self->frozenCounter >= 0) {
+    self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_SOFT_FROZEN;
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap64_runOptimize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  bool result = false;
+  for (uint32_t i = 0; i < self->buckets.count; ++i) {
+    if (roaring_bitmap_run_optimize(self->buckets.items[i].bitmap)) {
+      result = true;
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_shrinkToFit(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozenHard()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  double result = 0;
+  for (uint32_t i = 0; i < self->buckets.count; ++i) {
+    result += (double)roaring_bitmap_shrink_to_fit(self->buckets.items[i].bitmap);
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_addRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    if (roaring64RangeBucketsCount(minimum, maximum) > ROARING64_MAX_RANGE_BUCKETS) {
+      return v8utils::throwError(
+        isolate, "RoaringBitmap64::addRange - the range touches more than 65536 blocks of 2^32 values");
+    }
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    bool allocated = true;
+    roaring64ForEachRangeBucket(
+      minimum, maximum, [&buckets, &allocated](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+        roaring_bitmap_t * bitmap = buckets.getOrCreate(high);
+        if (bitmap == nullptr) {
+          allocated = false;
+          return false;
+        }
+        roaring_bitmap_add_range_closed(bitmap, lowMin, lowMax);
+        return true;
+      });
+    self->invalidate();
+    if (!allocated) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::addRange - failed to allocate memory");
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap64_removeRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    const uint32_t highMax = (uint32_t)(maximum >> 32);
+    for (uint32_t i = buckets.lowerBound((uint32_t)(minimum >> 32)); i < buckets.count && buckets.items[i].high <= highMax;
+         ++i) {
+      const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+      const uint32_t lowMin = minimum > base ? (uint32_t)minimum : 0;
+      const uint32_t lowMax = maximum < base + UINT32_MAX ? (uint32_t)maximum : UINT32_MAX;
+      roaring_bitmap_remove_range_closed(buckets.items[i].bitmap, lowMin, lowMax);
+    }
+    buckets.compact();
+    self->invalidate();
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap64_flipRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (self->isFrozen()) {
+    return v8utils::throwError(isolate, ERROR_FROZEN);
+  }
+  uint64_t minimum, maximum;
+  if (getRange64OperationParameters(info, minimum, maximum)) {
+    if (roaring64RangeBucketsCount(minimum, maximum) > ROARING64_MAX_RANGE_BUCKETS) {
+      return v8utils::throwError(
+        isolate, "RoaringBitmap64::flipRange - the range touches more than 65536 blocks of 2^32 values");
+    }
+    RoaringBitmap64Buckets & buckets = self->buckets;
+    bool allocated = true;
+    roaring64ForEachRangeBucket(
+      minimum, maximum, [&buckets, &allocated](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+        roaring_bitmap_t * bitmap = buckets.getOrCreate(high);
+        if (bitmap == nullptr) {
+          allocated = false;
+          return false;
+        }
+        roaring_bitmap_flip_inplace(bitmap, lowMin, (uint64_t)lowMax + 1);
+        return true;
+      });
+    buckets.compact();
+    self->invalidate();
+    if (!allocated) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::flipRange - failed to allocate memory");
+    }
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmap64_hasRange(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  uint64_t minimum, maximum;
+  if (self == nullptr || !getRange64OperationParameters(info, minimum, maximum)) {
+    return info.GetReturnValue().Set(false);
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  // Every bucket in the range must exist, so the bucket count is a cheap upper bound.
+  if ((maximum >> 32) - (minimum >> 32) >= buckets.count) {
+    return info.GetReturnValue().Set(false);
+  }
+  bool result = true;
+  roaring64ForEachRangeBucket(minimum, maximum, [&buckets, &result](uint32_t high, uint32_t lowMin, uint32_t lowMax) {
+    const roaring_bitmap_t * bitmap = buckets.get(high);
+    result = bitmap != nullptr && roaring_bitmap_contains_range(bitmap, lowMin, (uint64_t)lowMax + 1);
+    return result;
+  });
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_rangeCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), info.GetIsolate());
+  uint64_t minimum, maximum;
+  if (self == nullptr || !getRange64OperationParameters(info, minimum, maximum)) {
+    return info.GetReturnValue().Set(0);
+  }
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  const uint32_t highMax = (uint32_t)(maximum >> 32);
+  uint64_t result = 0;
+  for (uint32_t i = buckets.lowerBound((uint32_t)(minimum >> 32)); i < buckets.count && buckets.items[i].high <= highMax;
+       ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    const uint32_t lowMin = minimum > base ? (uint32_t)minimum : 0;
+    const uint32_t lowMax = maximum < base + UINT32_MAX ? (uint32_t)maximum : UINT32_MAX;
+    result += roaring_bitmap_range_cardinality(buckets.items[i].bitmap, lowMin, (uint64_t)lowMax + 1);
+  }
+  info.GetReturnValue().Set((double)result);
+}
+
+/** Writes up to length values in ascending order, returns the number of values written. */
+inline size_t roaring64ToUint64Array(const RoaringBitmap64Buckets & buckets, uint64_t * output, size_t length) {
+  uint32_t chunk[1024];
+  size_t n = 0;
+  for (uint32_t i = 0; i < buckets.count && n < length; ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(buckets.items[i].bitmap, &it);
+    while (n < length) {
+      const size_t toRead = std::min<size_t>(sizeof(chunk) / sizeof(chunk[0]), length - n);
+      const uint32_t read = roaring_uint32_iterator_read(&it, chunk, (uint32_t)toRead);
+      for (uint32_t k = 0; k < read; ++k) {
+        output[n++] = base | chunk[k];
+      }
+      if (read < toRead) {
+        break;
+      }
+    }
+  }
+  return n;
+}
+
+void RoaringBitmap64_toBigUint64Array(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  const uint64_t size = self->getSize();
+  if (size > node::Buffer::kMaxLength / sizeof(uint64_t)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::toBigUint64Array - bitmap is too big");
+  }
+  auto arrayBuffer = v8::ArrayBuffer::New(isolate, (size_t)size * sizeof(uint64_t));
+  if (size != 0) {
+    roaring64ToUint64Array(self->buckets, (uint64_t *)arrayBuffer->GetBackingStore()->Data(), (size_t)size);
+  }
+  info.GetReturnValue().Set(v8::BigUint64Array::New(arrayBuffer, 0, (size_t)size));
+}
+
+void RoaringBitmap64_toArray(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  uint64_t size = self->getSize();
+  double maxLength;
+  if (
+    info.Length() > 0 && info[0]->IsNumber() && info[0]->NumberValue(isolate->GetCurrentContext()).To(&maxLength) &&
+    maxLength >= 0 && maxLength < (double)size) {
+    size = (uint64_t)maxLength;
+  }
+  if (size > 0xFFFFFFF) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::toArray - bitmap is too big, use toBigUint64Array");
+  }
+  auto context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> result = v8::Array::New(isolate, (int)size);
+  uint32_t index = 0;
+  const RoaringBitmap64Buckets & buckets = self->buckets;
+  for (uint32_t i = 0; i < buckets.count && index < size; ++i) {
+    const uint64_t base = (uint64_t)buckets.items[i].high << 32;
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(buckets.items[i].bitmap, &it);
+    for (; it.has_value && index < size; roaring_uint32_iterator_advance(&it)) {
+      ignoreMaybeResult(result->Set(context, index++, v8::BigInt::NewFromUnsigned(isolate, base | it.current_value)));
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_toString(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  info.GetReturnValue().Set(self->addonData->strings.RoaringBitmap64.Get(isolate));
+}
+
+/////////////////// serialization ///////////////////
+
+/**
+ * Portable 64 bit format, compatible with CRoaring roaring64_bitmap_portable_serialize and the Java and Go implementations:
+ * uint64 number of buckets, then for each bucket the uint32 high 32 bits followed by the portable 32 bit bitmap.
+ */
+size_t roaring64PortableSizeInBytes(const RoaringBitmap64Buckets & buckets) {
+  size_t result = sizeof(uint64_t);
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    result += sizeof(uint32_t) + roaring_bitmap_portable_size_in_bytes(buckets.items[i].bitmap);
+  }
+  return result;
+}
+
+size_t roaring64PortableSerialize(const RoaringBitmap64Buckets & buckets, char * buf) {
+  char * p = buf;
+  const uint64_t count = buckets.count;
+  memcpy(p, &count, sizeof(count));
+  p += sizeof(count);
+  for (uint32_t i = 0; i < buckets.count; ++i) {
+    memcpy(p, &buckets.items[i].high, sizeof(uint32_t));
+    p += sizeof(uint32_t);
+    p += roaring_bitmap_portable_serialize(buckets.items[i].bitmap, p);
+  }
+  return p - buf;
+}
+
+const char * roaring64PortableDeserialize(RoaringBitmap64Buckets & buckets, const char * buf, size_t length, bool frozen) {
+  buckets.clear();
+  uint64_t count;
+  if (length < sizeof(count)) {
+    return "RoaringBitmap64 deserialization - buffer is too small";
+  }
+  memcpy(&count, buf, sizeof(count));
+  size_t offset = sizeof(count);
+  if (count > (length - offset) / sizeof(uint32_t) || !buckets.reserve((uint32_t)count)) {
+    return "RoaringBitmap64 deserialization - invalid number of buckets";
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    uint32_t high;
+    if (length - offset < sizeof(high)) {
+      return "RoaringBitmap64 deserialization - buffer is too small";
+    }
+    memcpy(&high, buf + offset, sizeof(high));
+    offset += sizeof(high);
+    if (buckets.count != 0 && high <= buckets.items[buckets.count - 1].high) {
+      return "RoaringBitmap64 deserialization - buckets are not sorted";
+    }
+    const size_t size = roaring_bitmap_portable_deserialize_size(buf + offset, length - offset);
+    if (size == 0) {
+      return "RoaringBitmap64 deserialization - invalid portable bitmap";
+    }
+    roaring_bitmap_t * bitmap = frozen ? roaring_bitmap_portable_deserialize_frozen(buf + offset)
+                                       : roaring_bitmap_portable_deserialize_safe(buf + offset, length - offset);
+    if (bitmap == nullptr) {
+      return "RoaringBitmap64 deserialization - invalid portable bitmap";
+    }
+    offset += size;
+    if (roaring_bitmap_is_empty(bitmap)) {
+      roaring_bitmap_free(bitmap);
+    } else if (!buckets.append(high, bitmap)) {
+      return "RoaringBitmap64 deserialization - failed to allocate memory";
+    }
+  }
+  return nullptr;
+}
+
+inline bool roaring64ParsePortableFormat(v8::Isolate * isolate, v8::Local<v8::Value> value) {
+  return tryParseSerializationFormat(value, isolate) == SerializationFormat::portable;
+}
+
+void RoaringBitmap64_getSerializationSizeInBytes(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 1 || !roaring64ParsePortableFormat(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 only supports the portable serialization format");
+  }
+  info.GetReturnValue().Set((double)roaring64PortableSizeInBytes(self->buckets));
+}
+
+void RoaringBitmap64_serialize(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  const RoaringBitmap64 * self = ObjectWrap::TryUnwrap<RoaringBitmap64>(info.This(), isolate);
+  if (self == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 1 || !roaring64ParsePortableFormat(isolate, info[0])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64 only supports the portable serialization format");
+  }
+
+  const size_t size = roaring64PortableSizeInBytes(self->buckets);
+
+  if (info.Length() > 1 && !info[1]->IsUndefined()) {
+    v8utils::TypedArrayContent<uint8_t> output(isolate, info[1]);
+    if (output.data == nullptr || output.length < size) {
+      return v8utils::throwError(isolate, "RoaringBitmap64::serialize - output buffer is too small");
+    }
+    roaring64PortableSerialize(self->buckets, (char *)output.data);
+    v8::Local<v8::Value> result;
+    if (!v8utils::v8ValueToBufferWithLimit(isolate, self->addonData, info[1], size, result)) {
+      return v8utils::throwError(isolate, "RoaringBitmap64 serialization failed to create the buffer view");
+    }
+    return info.GetReturnValue().Set(result);
+  }
+
+  char * data = (char *)bare_aligned_malloc(32, size);
+  if (data == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 serialization allocation failed");
+  }
+  roaring64PortableSerialize(self->buckets, data);
+  v8::Local<v8::Object> result;
+  if (!node::Buffer::New(isolate, data, size, bare_aligned_free_callback, nullptr).ToLocal(&result)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 serialization failed to create a new buffer");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_deserializeStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 2 || !roaring64ParsePortableFormat(isolate, info[1])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::deserialize only supports the portable serialization format");
+  }
+  if (!info[0]->IsArrayBufferView() && !info[0]->IsArrayBuffer() && !info[0]->IsSharedArrayBuffer()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::deserialize expects a buffer");
+  }
+  const v8utils::TypedArrayContent<uint8_t> input(isolate, info[0]);
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
+  }
+  const char * error = roaring64PortableDeserialize(self->buckets, (const char *)input.data, input.length, false);
+  if (error != nullptr) {
+    self->buckets.clear();
+    return v8utils::throwError(isolate, error);
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_unsafeFrozenViewStatic(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+  if (info.Length() < 2 || tryParseFrozenViewFormat(info[1], isolate) != FrozenViewFormat::unsafe_frozen_portable) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64::unsafeFrozenView only supports the unsafe_frozen_portable format");
+  }
+
+  v8::Local<v8::Object> result;
+  RoaringBitmap64 * self;
+  if (!RoaringBitmap64_newInstance(isolate, addonData, result, self)) {
+    return;
+  }
+
+  v8utils::TypedArrayContent<uint8_t> & frozenStorage = self->frozenStorage;
+  if (info[0]->IsNullOrUndefined() || !frozenStorage.set(isolate, info[0])) {
+    return v8utils::throwError(isolate, "RoaringBitmap64::unsafeFrozenView buffer argument was invalid");
+  }
+
+  self->frozenCounter = RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+
+  const char * error =
+    roaring64PortableDeserialize(self->buckets, (const char *)frozenStorage.data, frozenStorage.length, true);
+  if (error != nullptr) {
+    self->buckets.clear();
+    return v8utils::throwError(isolate, error);
+  }
+  self->invalidate();
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmap64_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::String> className = addonData->strings.RoaringBitmap64.Get(isolate);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap64_New, addonData->external.Get(isolate));
+  if (ctor.IsEmpty()) {
+    return;
+  }
+  addonData->RoaringBitmap64_constructorTemplate.Reset(isolate, ctor);
+
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctor->SetClassName(className);
+
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
+    RoaringBitmap64_isEmpty_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmap64_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
+    RoaringBitmap64_isFrozen_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "isEmpty", v8::NewStringType::kInternalized),
+    RoaringBitmap64_isEmpty_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmap64_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "isFrozen", v8::NewStringType::kInternalized),
+    RoaringBitmap64_isFrozen_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmap64_add);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmap64_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addRange", RoaringBitmap64_addRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andCardinality", RoaringBitmap64_andCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::AND>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotCardinality", RoaringBitmap64_andNotCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andNotInPlace", RoaringBitmap64_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmap64_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clone", RoaringBitmap64_clone);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmap64_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "flipRange", RoaringBitmap64_flipRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "freeze", RoaringBitmap64_freeze);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "getSerializationSizeInBytes", RoaringBitmap64_getSerializationSizeInBytes);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmap64_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "hasRange", RoaringBitmap64_hasRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "includes", RoaringBitmap64_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "intersects", RoaringBitmap64_intersects);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isEqual", RoaringBitmap64_isEqual);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSubset", RoaringBitmap64_isSubset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "isSuperset", RoaringBitmap64_isSuperset);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "maximum", RoaringBitmap64_maximum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "minimum", RoaringBitmap64_minimum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orCardinality", RoaringBitmap64_orCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::OR>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rangeCardinality", RoaringBitmap64_rangeCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "rank", RoaringBitmap64_rank);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmap64_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeMany", RoaringBitmap64_removeMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "removeRange", RoaringBitmap64_removeRange);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "runOptimize", RoaringBitmap64_runOptimize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "select", RoaringBitmap64_select);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "serialize", RoaringBitmap64_serialize);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "shrinkToFit", RoaringBitmap64_shrinkToFit);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toArray", RoaringBitmap64_toArray);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toBigUint64Array", RoaringBitmap64_toBigUint64Array);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "toString", RoaringBitmap64_toString);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "tryAdd", RoaringBitmap64_tryAdd);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorCardinality", RoaringBitmap64_xorCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "xorInPlace", RoaringBitmap64_opInPlace<RoaringBitmap64Operation::XOR>);
+
+  auto ctorFunction = ctor->GetFunction(context).ToLocalChecked();
+  auto ctorObject = ctorFunction->ToObject(context).ToLocalChecked();
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  addonData->setMethod(ctorObject, "and", RoaringBitmap64_opStatic<RoaringBitmap64Operation::AND>);
+  addonData->setMethod(ctorObject, "andNot", RoaringBitmap64_opStatic<RoaringBitmap64Operation::ANDNOT>);
+
+  v8utils::defineHiddenField(isolate, ctorObject, "default", ctorFunction);
+
+  addonData->setMethod(ctorObject, "deserialize", RoaringBitmap64_deserializeStatic);
+
+  ignoreMaybeResult(
+    ctorObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized), ctorFunction));
+
+  addonData->setMethod(ctorObject, "getInstancesCount", RoaringBitmap64_getInstanceCountStatic);
+  addonData->setMethod(ctorObject, "of", RoaringBitmap64_ofStatic);
+  addonData->setMethod(ctorObject, "or", RoaringBitmap64_opStatic<RoaringBitmap64Operation::OR>);
+  addonData->setMethod(ctorObject, "unsafeFrozenView", RoaringBitmap64_unsafeFrozenViewStatic);
+  addonData->setMethod(ctorObject, "xor", RoaringBitmap64_opStatic<RoaringBitmap64Operation::XOR>);
+
+  v8utils::defineHiddenField(isolate, ctorObject, className, ctorFunction);
+
+  ignoreMaybeResult(exports->Set(context, className, ctorFunction));
+
+  addonData->RoaringBitmap64_constructor.Reset(isolate, ctorFunction);
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_64_MAIN_
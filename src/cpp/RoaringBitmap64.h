@@ -0,0 +1,331 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_64_
+#define ROARING_NODE_ROARING_BITMAP_64_
+
+#include "RoaringBitmap32.h"
+
+/** One 32 bit roaring bitmap holding all the values of a RoaringBitmap64 that share the same high 32 bits. */
+struct RoaringBitmap64Bucket {
+  uint32_t high;
+  roaring_bitmap_t * bitmap;
+};
+
+/**
+ * Sorted array of buckets, keyed by the high 32 bits of the values.
+ * This is the same two level layout used by the portable 64 bit roaring format,
+ * so serialization and deserialization are a straight walk of the buckets.
+ */
+class RoaringBitmap64Buckets final {
+ public:
+  RoaringBitmap64Bucket * items;
+  uint32_t count;
+  uint32_t capacity;
+
+  inline RoaringBitmap64Buckets() : items(nullptr), count(0), capacity(0) {}
+
+  RoaringBitmap64Buckets(const RoaringBitmap64Buckets &) = delete;
+  RoaringBitmap64Buckets & operator=(const RoaringBitmap64Buckets &) = delete;
+
+  inline ~RoaringBitmap64Buckets() {
+    this->clear();
+    gcaware_free(this->items);
+  }
+
+  inline void clear() {
+    for (uint32_t i = 0; i < this->count; ++i) {
+      roaring_bitmap_free(this->items[i].bitmap);
+    }
+    this->count = 0;
+  }
+
+  inline void swap(RoaringBitmap64Buckets & other) {
+    std::swap(this->items, other.items);
+    std::swap(this->count, other.count);
+    std::swap(this->capacity, other.capacity);
+  }
+
+  bool reserve(uint32_t newCapacity) {
+    if (newCapacity <= this->capacity) {
+      return true;
+    }
+    auto * newItems = (RoaringBitmap64Bucket *)gcaware_realloc(this->items, (size_t)newCapacity * sizeof(RoaringBitmap64Bucket));
+    if (newItems == nullptr) {
+      return false;
+    }
+    this->items = newItems;
+    this->capacity = newCapacity;
+    return true;
+  }
+
+  /** Index of the first bucket with high >= the given high. */
+  inline uint32_t lowerBound(uint32_t high) const {
+    uint32_t lo = 0, hi = this->count;
+    // Appending in order is the common case, check the last bucket first.
+    if (hi != 0 && this->items[hi - 1].high < high) {
+      return hi;
+    }
+    while (lo < hi) {
+      uint32_t mid = (lo + hi) >> 1;
+      if (this->items[mid].high < high) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  inline roaring_bitmap_t * get(uint32_t high) const {
+    uint32_t index = this->lowerBound(high);
+    return index < this->count && this->items[index].high == high ? this->items[index].bitmap : nullptr;
+  }
+
+  /** Inserts the given bitmap at the given position. Takes ownership of the bitmap, also on failure. */
+  bool insertAt(uint32_t index, uint32_t high, roaring_bitmap_t * bitmap) {
+    if (bitmap == nullptr) {
+      return false;
+    }
+    if (this->count == this->capacity && !this->reserve(this->capacity < 4 ? 4 : this->capacity * 2)) {
+      roaring_bitmap_free(bitmap);
+      return false;
+    }
+    if (index < this->count) {
+      memmove(this->items + index + 1, this->items + index, (this->count - index) * sizeof(RoaringBitmap64Bucket));
+    }
+    this->items[index].high = high;
+    this->items[index].bitmap = bitmap;
+    ++this->count;
+    return true;
+  }
+
+  /** Appends a bucket, the high must be greater than the high of the last bucket. */
+  inline bool append(uint32_t high, roaring_bitmap_t * bitmap) { return this->insertAt(this->count, high, bitmap); }
+
+  roaring_bitmap_t * getOrCreate(uint32_t high) {
+    uint32_t index = this->lowerBound(high);
+    if (index < this->count && this->items[index].high == high) {
+      return this->items[index].bitmap;
+    }
+    if (!this->insertAt(index, high, roaring_bitmap_create())) {
+      return nullptr;
+    }
+    return this->items[index].bitmap;
+  }
+
+  void removeAt(uint32_t index) {
+    roaring_bitmap_free(this->items[index].bitmap);
+    --this->count;
+    if (index < this->count) {
+      memmove(this->items + index, this->items + index + 1, (this->count - index) * sizeof(RoaringBitmap64Bucket));
+    }
+  }
+
+  /** Removes all the buckets that became empty. */
+  void compact() {
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < this->count; ++i) {
+      if (roaring_bitmap_is_empty(this->items[i].bitmap)) {
+        roaring_bitmap_free(this->items[i].bitmap);
+      } else {
+        this->items[j++] = this->items[i];
+      }
+    }
+    this->count = j;
+  }
+
+  uint64_t cardinality() const {
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < this->count; ++i) {
+      result += roaring_bitmap_get_cardinality(this->items[i].bitmap);
+    }
+    return result;
+  }
+
+  bool copyFrom(const RoaringBitmap64Buckets & other) {
+    this->clear();
+    if (!this->reserve(other.count)) {
+      return false;
+    }
+    for (uint32_t i = 0; i < other.count; ++i) {
+      if (!this->append(other.items[i].high, roaring_bitmap_copy(other.items[i].bitmap))) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+enum class RoaringBitmap64Operation { AND, OR, XOR, ANDNOT };
+
+/**
+ * Computes a op b into result, walking the two sorted bucket arrays in lockstep.
+ * If inPlace is true, a is consumed: its buckets are moved into the result and modified in place.
+ */
+bool roaring64BucketsOperation(
+  RoaringBitmap64Operation op, RoaringBitmap64Buckets & a, const RoaringBitmap64Buckets & b, RoaringBitmap64Buckets & result, bool inPlace) {
+  result.clear();
+  if (!result.reserve(op == RoaringBitmap64Operation::AND ? std::min(a.count, b.count) : a.count + b.count)) {
+    return false;
+  }
+  const bool keepA = op != RoaringBitmap64Operation::AND;
+  const bool keepB = op == RoaringBitmap64Operation::OR || op == RoaringBitmap64Operation::XOR;
+  uint32_t i = 0, j = 0;
+  bool ok = true;
+  while (ok && (i < a.count || j < b.count)) {
+    if (j >= b.count || (i < a.count && a.items[i].high < b.items[j].high)) {
+      RoaringBitmap64Bucket & bucket = a.items[i++];
+      if (keepA) {
+        ok = result.append(bucket.high, inPlace ? bucket.bitmap : roaring_bitmap_copy(bucket.bitmap));
+        if (inPlace) {
+          bucket.bitmap = nullptr;
+        }
+      }
+    } else if (i >= a.count || b.items[j].high < a.items[i].high) {
+      const RoaringBitmap64Bucket & bucket = b.items[j++];
+      if (keepB) {
+        ok = result.append(bucket.high, roaring_bitmap_copy(bucket.bitmap));
+      }
+    } else {
+      RoaringBitmap64Bucket & x = a.items[i++];
+      const roaring_bitmap_t * y = b.items[j++].bitmap;
+      roaring_bitmap_t * r;
+      if (inPlace) {
+        switch (op) {
+          case RoaringBitmap64Operation::AND: roaring_bitmap_and_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::OR: roaring_bitmap_or_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::XOR: roaring_bitmap_xor_inplace(x.bitmap, y); break;
+          case RoaringBitmap64Operation::ANDNOT: roaring_bitmap_andnot_inplace(x.bitmap, y); break;
+        }
+        r = x.bitmap;
+        x.bitmap = nullptr;
+      } else {
+        switch (op) {
+          case RoaringBitmap64Operation::AND: r = roaring_bitmap_and(x.bitmap, y); break;
+          case RoaringBitmap64Operation::OR: r = roaring_bitmap_or(x.bitmap, y); break;
+          case RoaringBitmap64Operation::XOR: r = roaring_bitmap_xor(x.bitmap, y); break;
+          default: r = roaring_bitmap_andnot(x.bitmap, y); break;
+        }
+      }
+      if (r != nullptr && roaring_bitmap_is_empty(r)) {
+        roaring_bitmap_free(r);
+      } else {
+        ok = result.append(x.high, r);
+      }
+    }
+  }
+  if (inPlace) {
+    // Buckets not moved into the result are released when a is cleared.
+    uint32_t k = 0;
+    for (uint32_t n = 0; n < a.count; ++n) {
+      if (a.items[n].bitmap != nullptr) {
+        a.items[k++] = a.items[n];
+      }
+    }
+    a.count = k;
+    a.clear();
+  }
+  return ok;
+}
+
+/**
+ * The maximum number of 32 bit buckets a range operation that creates buckets (addRange, flipRange) can touch.
+ * A range over the whole 64 bit space would otherwise allocate 2^32 bitmaps.
+ */
+static const constexpr uint64_t ROARING64_MAX_RANGE_BUCKETS = 65536;
+
+/** The number of 32 bit buckets touched by the inclusive range [minimum, maximum]. */
+inline uint64_t roaring64RangeBucketsCount(uint64_t minimum, uint64_t maximum) {
+  return minimum > maximum ? 0 : (maximum >> 32) - (minimum >> 32) + 1;
+}
+
+/** Calls fn(high, lowMin, lowMax) for every 32 bit bucket touched by the inclusive range [minimum, maximum]. */
+template <typename F>
+inline void roaring64ForEachRangeBucket(uint64_t minimum, uint64_t maximum, F fn) {
+  const uint32_t highMin = (uint32_t)(minimum >> 32);
+  const uint32_t highMax = (uint32_t)(maximum >> 32);
+  for (uint64_t high = highMin; high <= highMax; ++high) {
+    const uint32_t lowMin = high == highMin ? (uint32_t)minimum : 0;
+    const uint32_t lowMax = high == highMax ? (uint32_t)maximum : UINT32_MAX;
+    if (!fn((uint32_t)high, lowMin, lowMax)) {
+      break;
+    }
+  }
+}
+
+class RoaringBitmap64 final : public ObjectWrap {
+ public:
+  static const constexpr uint64_t OBJECT_TOKEN = 0x21524F4152360000;
+
+  RoaringBitmap64Buckets buckets;
+  int64_t sizeCache;
+  int64_t _version;
+  int64_t frozenCounter;
+  v8::Global<v8::Object> persistent;
+  v8utils::TypedArrayContent<uint8_t> frozenStorage;
+
+  inline bool isEmpty() const { return this->buckets.count == 0; }
+
+  inline uint64_t getSize() const {
+    int64_t size = this->sizeCache;
+    if (size < 0) {
+      size = (int64_t)this->buckets.cardinality();
+      const_cast<RoaringBitmap64 *>(this)->sizeCache = size;
+    }
+    return (uint64_t)size;
+  }
+
+  inline bool isFrozen() const { return this->frozenCounter != 0; }
+  inline bool isFrozenHard() const {
+    return this->frozenCounter > 0 || this->frozenCounter == RoaringBitmap32::FROZEN_COUNTER_HARD_FROZEN;
+  }
+
+  inline int64_t getVersion() const { return this->_version; }
+
+  inline void invalidate() {
+    this->sizeCache = -1;
+    ++this->_version;
+  }
+
+  inline bool contains(uint64_t value) const {
+    const roaring_bitmap_t * r = this->buckets.get((uint32_t)(value >> 32));
+    return r != nullptr && roaring_bitmap_contains(r, (uint32_t)value);
+  }
+
+  inline bool addChecked(uint64_t value) {
+    roaring_bitmap_t * r = this->buckets.getOrCreate((uint32_t)(value >> 32));
+    return r != nullptr && roaring_bitmap_add_checked(r, (uint32_t)value);
+  }
+
+  inline bool removeChecked(uint64_t value) {
+    const uint32_t high = (uint32_t)(value >> 32);
+    const uint32_t index = this->buckets.lowerBound(high);
+    if (index >= this->buckets.count || this->buckets.items[index].high != high) {
+      return false;
+    }
+    roaring_bitmap_t * r = this->buckets.items[index].bitmap;
+    if (!roaring_bitmap_remove_checked(r, (uint32_t)value)) {
+      return false;
+    }
+    if (roaring_bitmap_is_empty(r)) {
+      this->buckets.removeAt(index);
+    }
+    return true;
+  }
+
+  explicit RoaringBitmap64(AddonData * addonData) :
+    ObjectWrap(addonData), sizeCache(0), _version(0), frozenCounter(0) {
+    ++addonData->RoaringBitmap64_instances;
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap64));
+  }
+
+  ~RoaringBitmap64() {
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap64));
+    --this->addonData->RoaringBitmap64_instances;
+    // Frozen views reference frozenStorage, release them before the storage goes away.
+    this->buckets.clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+    }
+  }
+};
+
+#endif  // ROARING_NODE_ROARING_BITMAP_64_
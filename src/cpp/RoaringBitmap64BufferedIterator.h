@@ -0,0 +1,235 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
+#define ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
+
+#include "RoaringBitmap64.h"
+
+class RoaringBitmap64BufferedIterator final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F41524A0000;
+
+  roaring_uint32_iterator_t it;
+  bool reversed;
+  uint32_t bucketIndex;
+  RoaringBitmap64 * bitmapInstance;
+  int64_t bitmapVersion;
+  v8utils::TypedArrayContent<uint64_t> bufferContent;
+
+  v8::Global<v8::Object> bitmap;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmap64BufferedIterator(AddonData * addonData, bool reversed) :
+    ObjectWrap(addonData), reversed(reversed), bucketIndex(0), bitmapInstance(nullptr), bitmapVersion(0) {
+    this->it.parent = nullptr;
+    this->it.has_value = false;
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmap64BufferedIterator));
+  }
+
+  ~RoaringBitmap64BufferedIterator() {
+    this->destroy();
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmap64BufferedIterator));
+  }
+
+  /** Positions the 32 bit iterator on the current bucket, skipping to the next bucket when one is exhausted. */
+  inline bool _seekBucket() {
+    const RoaringBitmap64Buckets & buckets = this->bitmapInstance->buckets;
+    while (!this->it.has_value) {
+      if (this->it.parent != nullptr) {
+        if (this->reversed) {
+          if (this->bucketIndex == 0) {
+            return false;
+          }
+          --this->bucketIndex;
+        } else {
+          ++this->bucketIndex;
+        }
+      }
+      if (this->bucketIndex >= buckets.count) {
+        return false;
+      }
+      if (this->reversed) {
+        roaring_iterator_init_last(buckets.items[this->bucketIndex].bitmap, &this->it);
+      } else {
+        roaring_iterator_init(buckets.items[this->bucketIndex].bitmap, &this->it);
+      }
+    }
+    return true;
+  }
+
+  inline uint32_t _fill() {
+    const size_t size = this->bufferContent.length;
+    uint64_t * data = this->bufferContent.data;
+    uint32_t n = 0;
+    uint32_t lows[256];
+    while (n < size && this->bitmapInstance != nullptr && this->_seekBucket()) {
+      const uint64_t base = (uint64_t)this->bitmapInstance->buckets.items[this->bucketIndex].high << 32;
+      const uint32_t toRead = (uint32_t)std::min<size_t>(sizeof(lows) / sizeof(lows[0]), size - n);
+      const uint32_t read = this->reversed ? roaringIteratorReadReverse(&this->it, lows, toRead)
+                                           : roaring_uint32_iterator_read(&this->it, lows, toRead);
+      for (uint32_t k = 0; k < read; ++k) {
+        data[n++] = base | lows[k];
+      }
+    }
+    if (n == 0) {
+      this->close();
+    }
+    return n;
+  }
+
+  inline void close() {
+    this->bitmapInstance = nullptr;
+    this->bitmapVersion = 0;
+    this->bufferContent.reset();
+    this->bitmap.Reset();
+    this->it.has_value = false;
+  }
+
+ private:
+  void destroy() {
+    this->bitmap.Reset();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+  }
+};
+
+void RoaringBitmap64BufferedIterator_fill(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  RoaringBitmap64BufferedIterator * instance = ObjectWrap::TryUnwrap<RoaringBitmap64BufferedIterator>(info.This(), isolate);
+
+  RoaringBitmap64 * bitmapInstance = instance ? instance->bitmapInstance : nullptr;
+
+  if (bitmapInstance == nullptr) {
+    return info.GetReturnValue().Set(0U);
+  }
+
+  if (bitmapInstance->getVersion() != instance->bitmapVersion) {
+    return v8utils::throwError(isolate, "RoaringBitmap64 iterator - bitmap changed while iterating");
+  }
+
+  return info.GetReturnValue().Set(instance->_fill());
+}
+
+void RoaringBitmap64BufferedIterator_close(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmap64BufferedIterator * instance =
+    ObjectWrap::TryUnwrap<RoaringBitmap64BufferedIterator>(info.This(), info.GetIsolate());
+  if (instance == nullptr) {
+    return;
+  }
+  instance->close();
+}
+
+void RoaringBitmap64BufferedIterator_WeakCallback(v8::WeakCallbackInfo<RoaringBitmap64BufferedIterator> const & info) {
+  RoaringBitmap64BufferedIterator * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmap64BufferedIterator();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmap64BufferedIterator_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - needs to be called with new");
+  }
+
+  auto holder = info.This();
+
+  if (info.Length() < 2) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - needs 2 or 3 arguments");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT_64);
+  }
+
+  RoaringBitmap64 * bitmapInstance = ObjectWrap::TryUnwrap<RoaringBitmap64>(info[0], isolate);
+  if (bitmapInstance == nullptr) {
+    return v8utils::throwTypeError(
+      isolate, "RoaringBitmap64BufferedIterator::ctor - first argument must be of type RoaringBitmap64");
+  }
+
+  bool reversed = info.Length() > 2 && info[2]->BooleanValue(isolate);
+
+  auto bufferObject = info[1];
+
+  if (!bufferObject->IsBigUint64Array()) {
+    return v8utils::throwTypeError(
+      isolate, "RoaringBitmap64BufferedIterator::ctor - second argument must be of type BigUint64Array");
+  }
+
+  const v8utils::TypedArrayContent<uint64_t> bufferContent(isolate, bufferObject);
+  if (!bufferContent.data || bufferContent.length < 1) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmap64BufferedIterator::ctor - invalid BigUint64Array buffer");
+  }
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmap64BufferedIterator));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmap64BufferedIterator(addonData, reversed) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmap64BufferedIterator::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  info.GetReturnValue().Set(holder);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmap64BufferedIterator_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  auto context = isolate->GetCurrentContext();
+
+  instance->bitmapInstance = bitmapInstance;
+  instance->bitmapVersion = bitmapInstance->getVersion();
+
+  v8::Local<v8::Object> a0;
+  if (!info[0]->ToObject(context).ToLocal(&a0)) {
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - allocation failed");
+  }
+  instance->bitmap.Reset(isolate, a0);
+
+  instance->bufferContent.set(isolate, bufferObject);
+
+  if (reversed && bitmapInstance->buckets.count != 0) {
+    instance->bucketIndex = bitmapInstance->buckets.count - 1;
+  }
+
+  uint32_t n = instance->_fill();
+
+  if (holder->Set(context, addonData->strings.n.Get(isolate), v8::Uint32::NewFromUnsigned(isolate, n)).IsNothing()) {
+    return v8utils::throwError(isolate, "RoaringBitmap64BufferedIterator::ctor - instantiation failed");
+  }
+}
+
+void RoaringBitmap64BufferedIterator_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmap64BufferedIterator", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmap64BufferedIterator_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  ctor->InstanceTemplate()->SetInternalFieldCount(2);
+
+  addonData->RoaringBitmap64BufferedIterator_constructorTemplate.Reset(isolate, ctor);
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "fill", RoaringBitmap64BufferedIterator_fill);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "close", RoaringBitmap64BufferedIterator_close);
+
+  auto ctorFunctionMaybe = ctor->GetFunction(isolate->GetCurrentContext());
+  v8::Local<v8::Function> ctorFunction;
+
+  if (!ctorFunctionMaybe.ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmap64BufferedIterator");
+  }
+
+  addonData->RoaringBitmap64BufferedIterator_constructor.Reset(isolate, ctorFunction);
+  v8utils::defineHiddenField(isolate, exports, "RoaringBitmap64BufferedIterator", ctorFunction);
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_64_BUFFERED_ITERATOR_
@@ -0,0 +1,551 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_INDEX_
+#define ROARING_NODE_ROARING_BITMAP_INDEX_
+
+#include "RoaringBitmap32.h"
+
+/**
+ * A keyed store of bitmaps, for inverted indexes: string keys are mapped to native roaring bitmaps.
+ *
+ * Bitmaps are owned by a C++ hash table and have no JS object, no persistent handle and no weak callback each;
+ * JS RoaringBitmap32 instances are created only when a bitmap or the result of an operation is requested.
+ * Keys whose bitmap becomes empty are removed.
+ */
+class RoaringBitmapIndex final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152494400;
+
+  /** Approximation of the memory used by an entry of the hash table, in addition to the key and the bitmap. */
+  static const constexpr int64_t ENTRY_OVERHEAD =
+    (int64_t)(sizeof(std::string) + sizeof(roaring_bitmap_t) + 4 * sizeof(void *));
+
+  std::unordered_map<std::string, roaring_bitmap_t *> entries;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmapIndex(AddonData * addonData) : ObjectWrap(addonData) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmapIndex));
+  }
+
+  ~RoaringBitmapIndex() {
+    this->clear();
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmapIndex));
+  }
+
+  void clear() {
+    int64_t memory = 0;
+    for (auto & entry : this->entries) {
+      memory += ENTRY_OVERHEAD + (int64_t)entry.first.size();
+      roaring_bitmap_free(entry.second);
+    }
+    this->entries.clear();
+    _gcaware_adjustAllocatedMemory(this->isolate, -memory);
+  }
+
+  roaring_bitmap_t * find(const std::string & key) const {
+    auto it = this->entries.find(key);
+    return it != this->entries.end() ? it->second : nullptr;
+  }
+
+  /** Gets the bitmap of a key, creating an empty one if the key does not exist. Returns nullptr if allocation failed. */
+  roaring_bitmap_t * getOrCreate(const std::string & key) {
+    auto it = this->entries.find(key);
+    if (it != this->entries.end()) {
+      return it->second;
+    }
+    roaring_bitmap_t * bitmap = roaring_bitmap_create();
+    if (bitmap == nullptr) {
+      return nullptr;
+    }
+    this->entries.emplace(key, bitmap);
+    _gcaware_adjustAllocatedMemory(this->isolate, ENTRY_OVERHEAD + (int64_t)key.size());
+    return bitmap;
+  }
+
+  /** Replaces the bitmap of a key, the index takes ownership of the bitmap. Empty bitmaps remove the key. */
+  void replace(const std::string & key, roaring_bitmap_t * bitmap) {
+    if (roaring_bitmap_is_empty(bitmap)) {
+      roaring_bitmap_free(bitmap);
+      this->erase(key);
+      return;
+    }
+    auto it = this->entries.find(key);
+    if (it != this->entries.end()) {
+      roaring_bitmap_free(it->second);
+      it->second = bitmap;
+    } else {
+      this->entries.emplace(key, bitmap);
+      _gcaware_adjustAllocatedMemory(this->isolate, ENTRY_OVERHEAD + (int64_t)key.size());
+    }
+  }
+
+  bool erase(const std::string & key) {
+    auto it = this->entries.find(key);
+    if (it == this->entries.end()) {
+      return false;
+    }
+    roaring_bitmap_free(it->second);
+    this->entries.erase(it);
+    _gcaware_adjustAllocatedMemory(this->isolate, -(ENTRY_OVERHEAD + (int64_t)key.size()));
+    return true;
+  }
+};
+
+static RoaringBitmapIndex * RoaringBitmapIndex_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = ObjectWrap::TryUnwrap<RoaringBitmapIndex>(info.This(), isolate);
+  if (self == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  return self;
+}
+
+static bool RoaringBitmapIndex_toKey(v8::Isolate * isolate, const v8::Local<v8::Value> & value, std::string & key) {
+  if (value.IsEmpty() || !value->IsString()) {
+    return false;
+  }
+  v8::String::Utf8Value utf8(isolate, value);
+  key.assign(*utf8, utf8.length());
+  return true;
+}
+
+static bool RoaringBitmapIndex_getKey(const v8::FunctionCallbackInfo<v8::Value> & info, std::string & key) {
+  if (info.Length() < 1 || !RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key)) {
+    v8utils::throwTypeError(info.GetIsolate(), "RoaringBitmapIndex - key must be a string");
+    return false;
+  }
+  return true;
+}
+
+static bool RoaringBitmapIndex_getId(const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, uint32_t & id) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (info.Length() <= argumentIndex || !v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[argumentIndex], id)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapIndex - id must be a 32 bit unsigned integer");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Collects the bitmaps of an array of keys. Missing keys are skipped and counted.
+ * Returns false and throws if the argument is not an array of strings.
+ */
+static bool RoaringBitmapIndex_getBitmaps(
+  const v8::FunctionCallbackInfo<v8::Value> & info,
+  const RoaringBitmapIndex * self,
+  std::vector<const roaring_bitmap_t *> & bitmaps,
+  size_t & missing) {
+  v8::Isolate * isolate = info.GetIsolate();
+  missing = 0;
+  if (info.Length() < 1 || !info[0]->IsArray()) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+    return false;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> array = info[0].As<v8::Array>();
+  const uint32_t length = array->Length();
+  bitmaps.reserve(length);
+  std::string key;
+  for (uint32_t i = 0; i != length; ++i) {
+    v8::Local<v8::Value> item;
+    if (!array->Get(context, i).ToLocal(&item) || !RoaringBitmapIndex_toKey(isolate, item, key)) {
+      v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+      return false;
+    }
+    const roaring_bitmap_t * bitmap = self->find(key);
+    if (bitmap != nullptr) {
+      bitmaps.push_back(bitmap);
+    } else {
+      ++missing;
+    }
+  }
+  return true;
+}
+
+/** Wraps a roaring_bitmap_t in a new RoaringBitmap32 and returns it. The bitmap is released on failure. */
+static void RoaringBitmapIndex_returnBitmap(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmapIndex * self, roaring_bitmap_t * r) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex - failed to allocate memory");
+  }
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    roaring_bitmap_free(r);
+    return;
+  }
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    roaring_bitmap_free(r);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmapIndex_add(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  uint32_t id;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key) || !RoaringBitmapIndex_getId(info, 1, id)) {
+    return;
+  }
+  roaring_bitmap_t * bitmap = self->getOrCreate(key);
+  if (bitmap == nullptr) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex::add - failed to allocate memory");
+  }
+  roaring_bitmap_add(bitmap, id);
+  info.GetReturnValue().Set(info.This());
+}
+
+/**
+ * addMany(key, ids) adds all the ids to a key.
+ * addMany(keys, ids) adds ids[i] to keys[i], the ids of consecutive equal keys are added to their bitmap at once.
+ * Keys and ids are all validated before the index is modified.
+ */
+void RoaringBitmapIndex_addMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  const bool manyKeys = info.Length() > 0 && info[0]->IsArray();
+  if (info.Length() < 2 || !(manyKeys || info[0]->IsString())) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::addMany - keys must be a string or an array of strings");
+  }
+
+  // Ids in a JS array are converted first, so invalid ids are rejected before the index is modified.
+  v8utils::TypedArrayContent<uint32_t> typedIds;
+  std::vector<uint32_t> arrayIds;
+  const uint32_t * ids;
+  size_t idsCount;
+  if (info[1]->IsUint32Array() || info[1]->IsInt32Array()) {
+    typedIds.set(isolate, info[1]);
+    ids = typedIds.data;
+    idsCount = typedIds.length;
+  } else if (info[1]->IsArray()) {
+    v8::Local<v8::Array> array = info[1].As<v8::Array>();
+    idsCount = array->Length();
+    arrayIds.resize(idsCount);
+    for (size_t i = 0; i != idsCount; ++i) {
+      v8::Local<v8::Value> item;
+      if (
+        !array->Get(context, (uint32_t)i).ToLocal(&item) ||
+        !v8utils::v8ValueToUint32Fast(context, item, arrayIds[i])) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmapIndex - id must be a 32 bit unsigned integer");
+      }
+    }
+    ids = arrayIds.data();
+  } else {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::addMany - ids must be a Uint32Array or an array");
+  }
+
+  info.GetReturnValue().Set(info.This());
+  std::string key;
+  if (!manyKeys) {
+    if (idsCount == 0) {
+      return;
+    }
+    RoaringBitmapIndex_toKey(isolate, info[0], key);
+    roaring_bitmap_t * bitmap = self->getOrCreate(key);
+    if (bitmap == nullptr) {
+      return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - failed to allocate memory");
+    }
+    roaring_bitmap_add_many(bitmap, idsCount, ids);
+    return;
+  }
+
+  v8::Local<v8::Array> keys = info[0].As<v8::Array>();
+  if (keys->Length() != idsCount) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - keys and ids must have the same length");
+  }
+
+  // Keys are converted before the index is modified too. Each run of consecutive equal keys is stored once, with the
+  // index of the id that follows the run.
+  std::vector<std::pair<std::string, size_t>> runs;
+  v8::Local<v8::Value> previousKey;
+  for (size_t i = 0; i != idsCount; ++i) {
+    v8::Local<v8::Value> item;
+    if (!keys->Get(context, (uint32_t)i).ToLocal(&item)) {
+      return;
+    }
+    if (runs.empty() || !item->StrictEquals(previousKey)) {
+      if (!RoaringBitmapIndex_toKey(isolate, item, key)) {
+        return v8utils::throwTypeError(isolate, "RoaringBitmapIndex - keys must be an array of strings");
+      }
+      runs.emplace_back(std::move(key), i);
+      previousKey = item;
+    }
+    runs.back().second = i + 1;
+  }
+
+  size_t start = 0;
+  for (const auto & run : runs) {
+    roaring_bitmap_t * bitmap = self->getOrCreate(run.first);
+    if (bitmap == nullptr) {
+      return v8utils::throwError(isolate, "RoaringBitmapIndex::addMany - failed to allocate memory");
+    }
+    roaring_bitmap_add_many(bitmap, run.second - start, ids + start);
+    start = run.second;
+  }
+}
+
+void RoaringBitmapIndex_remove(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  uint32_t id;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key) || !RoaringBitmapIndex_getId(info, 1, id)) {
+    return;
+  }
+  roaring_bitmap_t * bitmap = self->find(key);
+  const bool removed = bitmap != nullptr && roaring_bitmap_remove_checked(bitmap, id);
+  if (removed && roaring_bitmap_is_empty(bitmap)) {
+    self->erase(key);
+  }
+  info.GetReturnValue().Set(removed);
+}
+
+void RoaringBitmapIndex_set(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
+    return;
+  }
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info, 1);
+  if (bitmap == nullptr) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::set - bitmap must be a RoaringBitmap32");
+  }
+  roaring_bitmap_t * copy = roaring_bitmap_copy(bitmap->roaring);
+  if (copy == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::set - failed to allocate memory");
+  }
+  self->replace(key, copy);
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmapIndex_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
+    return;
+  }
+  const roaring_bitmap_t * bitmap = self->find(key);
+  if (bitmap != nullptr) {
+    RoaringBitmapIndex_returnBitmap(info, self, roaring_bitmap_copy(bitmap));
+  }
+}
+
+void RoaringBitmapIndex_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key) &&
+    self->find(key) != nullptr);
+}
+
+void RoaringBitmapIndex_delete(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && RoaringBitmapIndex_toKey(info.GetIsolate(), info[0], key) &&
+    self->erase(key));
+}
+
+void RoaringBitmapIndex_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
+  }
+}
+
+void RoaringBitmapIndex_cardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::string key;
+  if (self == nullptr || !RoaringBitmapIndex_getKey(info, key)) {
+    return;
+  }
+  const roaring_bitmap_t * bitmap = self->find(key);
+  info.GetReturnValue().Set(bitmap != nullptr ? (double)roaring_bitmap_get_cardinality(bitmap) : 0.0);
+}
+
+void RoaringBitmapIndex_keys(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> result = v8::Array::New(isolate, (int)self->entries.size());
+  uint32_t index = 0;
+  for (const auto & entry : self->entries) {
+    v8::Local<v8::String> key;
+    if (!v8::String::NewFromUtf8(isolate, entry.first.data(), v8::NewStringType::kNormal, (int)entry.first.size())
+           .ToLocal(&key)) {
+      return;
+    }
+    ignoreMaybeResult(result->Set(context, index++, key));
+  }
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmapIndex_orMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  RoaringBitmapIndex_returnBitmap(
+    info, self, bitmaps.empty() ? roaring_bitmap_create() : roaring_bitmap_or_many(bitmaps.size(), bitmaps.data()));
+}
+
+void RoaringBitmapIndex_andMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  if (missing != 0) {
+    bitmaps.clear();  // A missing key is an empty bitmap, the intersection is empty.
+  }
+  roaringSortByCardinality(bitmaps.data(), bitmaps.size());
+  RoaringBitmapIndex_returnBitmap(info, self, roaringAndMany(bitmaps.size(), bitmaps.data()));
+}
+
+void RoaringBitmapIndex_orManyCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  uint64_t cardinality;
+  if (!roaringOrManyCardinality(bitmaps.data(), bitmaps.size(), cardinality)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex - failed to allocate memory");
+  }
+  info.GetReturnValue().Set((double)cardinality);
+}
+
+void RoaringBitmapIndex_andManyCardinality(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapIndex * self = RoaringBitmapIndex_unwrap(info);
+  std::vector<const roaring_bitmap_t *> bitmaps;
+  size_t missing;
+  if (self == nullptr || !RoaringBitmapIndex_getBitmaps(info, self, bitmaps, missing)) {
+    return;
+  }
+  if (missing != 0) {
+    return info.GetReturnValue().Set(0);
+  }
+  roaringSortByCardinality(bitmaps.data(), bitmaps.size());
+  uint64_t cardinality;
+  if (!roaringAndManyCardinality(bitmaps.data(), bitmaps.size(), cardinality)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapIndex - failed to allocate memory");
+  }
+  info.GetReturnValue().Set((double)cardinality);
+}
+
+void RoaringBitmapIndex_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapIndex * self = ObjectWrap::TryUnwrap<const RoaringBitmapIndex>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? (double)self->entries.size() : 0.0);
+}
+
+void RoaringBitmapIndex_WeakCallback(v8::WeakCallbackInfo<RoaringBitmapIndex> const & info) {
+  RoaringBitmapIndex * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmapIndex();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmapIndex_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapIndex::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmapIndex));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmapIndex(addonData) : nullptr;
+  if (instance == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapIndex::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmapIndex::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmapIndex_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmapIndex_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmapIndex", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmapIndex_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapIndex_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapIndex_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "add", RoaringBitmapIndex_add);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "addMany", RoaringBitmapIndex_addMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andMany", RoaringBitmapIndex_andMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "andManyCardinality", RoaringBitmapIndex_andManyCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "cardinality", RoaringBitmapIndex_cardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmapIndex_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmapIndex_delete);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmapIndex_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmapIndex_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "keys", RoaringBitmapIndex_keys);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orMany", RoaringBitmapIndex_orMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "orManyCardinality", RoaringBitmapIndex_orManyCardinality);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "remove", RoaringBitmapIndex_remove);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "set", RoaringBitmapIndex_set);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmapIndex");
+  }
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_INDEX_
@@ -0,0 +1,645 @@
+#ifndef ROARING_NODE_ROARING_BITMAP_SLICED_32_
+#define ROARING_NODE_ROARING_BITMAP_SLICED_32_
+
+#include "RoaringBitmap32.h"
+
+enum class RoaringBitmapSliced32Operation { EQ, NEQ, LT, LE, GT, GE };
+
+/**
+ * A bit-sliced index: maps 32 bit columns (row ids) to 32 bit unsigned values.
+ *
+ * The existence bitmap contains all the columns that have a value, the slice i contains the columns whose value has the
+ * bit i set. Slices are allocated up to the highest bit ever set, so small values use few bitmaps.
+ * Predicates and aggregates are computed slice by slice with bitmap operations, without visiting the columns.
+ */
+class RoaringBitmapSliced32 final : public ObjectWrap {
+ public:
+  static constexpr const uint64_t OBJECT_TOKEN = 0x21524F4152534900;
+  static const constexpr uint32_t MAX_BIT_DEPTH = 32;
+
+  roaring_bitmap_t * existence;
+  roaring_bitmap_t * slices[MAX_BIT_DEPTH];
+  uint32_t bitDepth;
+  v8::Global<v8::Object> persistent;
+
+  explicit RoaringBitmapSliced32(AddonData * addonData) :
+    ObjectWrap(addonData), existence(roaring_bitmap_create()), slices(), bitDepth(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(RoaringBitmapSliced32));
+  }
+
+  ~RoaringBitmapSliced32() {
+    this->clear();
+    if (this->existence != nullptr) {
+      roaring_bitmap_free(this->existence);
+    }
+    if (!this->persistent.IsEmpty()) {
+      this->persistent.ClearWeak();
+      this->persistent.Reset();
+    }
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(RoaringBitmapSliced32));
+  }
+
+  /** Removes all the columns and releases the slices. */
+  void clear() {
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      roaring_bitmap_free(this->slices[i]);
+      this->slices[i] = nullptr;
+    }
+    this->bitDepth = 0;
+    if (this->existence != nullptr) {
+      roaring_bitmap_clear(this->existence);
+    }
+  }
+
+  /** Allocates the slices needed to store the given value. Returns false if the allocation failed. */
+  bool grow(uint32_t value) {
+    const uint32_t depth = value != 0 ? 64 - (uint32_t)roaring_leading_zeroes(value) : 0;
+    while (this->bitDepth < depth) {
+      roaring_bitmap_t * slice = roaring_bitmap_create();
+      if (slice == nullptr) {
+        return false;
+      }
+      this->slices[this->bitDepth++] = slice;
+    }
+    return true;
+  }
+
+  /** Sets the value of a column. The slice bulk contexts can be passed to speed up sequential calls. */
+  bool set(uint32_t column, uint32_t value, roaring_bulk_context_t * contexts = nullptr) {
+    if (this->existence == nullptr || !this->grow(value)) {
+      return false;
+    }
+    // Columns that are new have no bit set in any slice, there is nothing to remove.
+    const bool existed = !roaring_bitmap_add_checked(this->existence, column);
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      if ((value >> i) & 1) {
+        if (contexts != nullptr) {
+          roaring_bitmap_add_bulk(this->slices[i], &contexts[i], column);
+        } else {
+          roaring_bitmap_add(this->slices[i], column);
+        }
+      } else if (existed) {
+        roaring_bitmap_remove(this->slices[i], column);
+        if (contexts != nullptr) {
+          // A removal can convert or free the container cached in the bulk context.
+          contexts[i] = roaring_bulk_context_t();
+        }
+      }
+    }
+    return true;
+  }
+
+  bool get(uint32_t column, uint32_t & value) const {
+    if (this->existence == nullptr || !roaring_bitmap_contains(this->existence, column)) {
+      return false;
+    }
+    uint32_t result = 0;
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      if (roaring_bitmap_contains(this->slices[i], column)) {
+        result |= (uint32_t)1 << i;
+      }
+    }
+    value = result;
+    return true;
+  }
+
+  bool remove(uint32_t column) {
+    if (this->existence == nullptr || !roaring_bitmap_remove_checked(this->existence, column)) {
+      return false;
+    }
+    for (uint32_t i = 0; i != this->bitDepth; ++i) {
+      roaring_bitmap_remove(this->slices[i], column);
+    }
+    return true;
+  }
+
+  /** Creates the set of the columns that have a value and are in the filter, if a filter is given. */
+  roaring_bitmap_t * found(const roaring_bitmap_t * filter) const {
+    return filter != nullptr ? roaring_bitmap_and(this->existence, filter) : roaring_bitmap_copy(this->existence);
+  }
+
+  /**
+   * Computes the columns whose value satisfies the comparison with the given value, with the O'Neil algorithm:
+   * the slices are visited from the most significant one, the columns equal so far are split in the columns
+   * that are lower, greater or still equal to the prefix of the value.
+   */
+  roaring_bitmap_t * compare(RoaringBitmapSliced32Operation op, uint32_t value, const roaring_bitmap_t * filter) const {
+    roaring_bitmap_t * eq = this->found(filter);
+    if (eq == nullptr) {
+      return nullptr;
+    }
+    roaring_bitmap_t * lt = roaring_bitmap_create();
+    roaring_bitmap_t * gt = roaring_bitmap_create();
+    if (lt == nullptr || gt == nullptr) {
+      roaring_bitmap_free(eq);
+      roaring_bitmap_free(lt);
+      roaring_bitmap_free(gt);
+      return nullptr;
+    }
+
+    const bool needsLt = op == RoaringBitmapSliced32Operation::LT || op == RoaringBitmapSliced32Operation::LE ||
+      op == RoaringBitmapSliced32Operation::NEQ;
+    const bool needsGt = op == RoaringBitmapSliced32Operation::GT || op == RoaringBitmapSliced32Operation::GE ||
+      op == RoaringBitmapSliced32Operation::NEQ;
+
+    if (this->bitDepth < 32 && (value >> this->bitDepth) != 0) {
+      // The value has a bit higher than any stored value, all the values are lower.
+      std::swap(lt, eq);
+    } else {
+      for (uint32_t i = this->bitDepth; i-- != 0 && !roaring_bitmap_is_empty(eq);) {
+        const roaring_bitmap_t * slice = this->slices[i];
+        if ((value >> i) & 1) {
+          if (needsLt) {
+            roaring_bitmap_t * lower = roaring_bitmap_andnot(eq, slice);
+            roaring_bitmap_or_inplace(lt, lower);
+            roaring_bitmap_free(lower);
+          }
+          roaring_bitmap_and_inplace(eq, slice);
+        } else {
+          if (needsGt) {
+            roaring_bitmap_t * greater = roaring_bitmap_and(eq, slice);
+            roaring_bitmap_or_inplace(gt, greater);
+            roaring_bitmap_free(greater);
+          }
+          roaring_bitmap_andnot_inplace(eq, slice);
+        }
+      }
+    }
+
+    roaring_bitmap_t ** result;
+    switch (op) {
+      case RoaringBitmapSliced32Operation::EQ: result = &eq; break;
+      case RoaringBitmapSliced32Operation::NEQ:
+        roaring_bitmap_or_inplace(lt, gt);
+        result = &lt;
+        break;
+      case RoaringBitmapSliced32Operation::LT: result = &lt; break;
+      case RoaringBitmapSliced32Operation::LE:
+        roaring_bitmap_or_inplace(lt, eq);
+        result = &lt;
+        break;
+      case RoaringBitmapSliced32Operation::GT: result = &gt; break;
+      default:
+        roaring_bitmap_or_inplace(gt, eq);
+        result = &gt;
+        break;
+    }
+    roaring_bitmap_t * output = *result;
+    *result = nullptr;
+    roaring_bitmap_free(eq);
+    roaring_bitmap_free(lt);
+    roaring_bitmap_free(gt);
+    return output;
+  }
+
+  /** Computes the columns whose value is between min and max, inclusive. */
+  roaring_bitmap_t * between(uint32_t min, uint32_t max, const roaring_bitmap_t * filter) const {
+    if (min > max) {
+      return roaring_bitmap_create();
+    }
+    roaring_bitmap_t * ge = this->compare(RoaringBitmapSliced32Operation::GE, min, filter);
+    if (ge == nullptr) {
+      return nullptr;
+    }
+    roaring_bitmap_t * result = this->compare(RoaringBitmapSliced32Operation::LE, max, ge);
+    roaring_bitmap_free(ge);
+    return result;
+  }
+
+  /** Sums the values of the columns in the filter, one intersection cardinality per slice. */
+  uint64_t sum(const roaring_bitmap_t * filter, uint64_t & count) const {
+    count = filter != nullptr ? roaring_bitmap_and_cardinality(this->existence, filter)
+                              : roaring_bitmap_get_cardinality(this->existence);
+    uint64_t result = 0;
+    for (uint32_t i = 0; i != this->bitDepth && count != 0; ++i) {
+      const uint64_t bits = filter != nullptr ? roaring_bitmap_and_cardinality(this->slices[i], filter)
+                                              : roaring_bitmap_get_cardinality(this->slices[i]);
+      result += bits << i;
+    }
+    return result;
+  }
+
+  /**
+   * Finds the minimum or the maximum value of the columns in the filter.
+   * Returns 0 if there are no columns, -1 if an allocation failed, 1 if found.
+   */
+  int extreme(bool maximum, const roaring_bitmap_t * filter, uint32_t & value) const {
+    roaring_bitmap_t * candidates = this->found(filter);
+    if (candidates == nullptr) {
+      return -1;
+    }
+    if (roaring_bitmap_is_empty(candidates)) {
+      roaring_bitmap_free(candidates);
+      return 0;
+    }
+    uint32_t result = 0;
+    for (uint32_t i = this->bitDepth; i-- != 0;) {
+      // Keeps the candidates with the bit set for the maximum, cleared for the minimum, if there are any.
+      roaring_bitmap_t * next =
+        maximum ? roaring_bitmap_and(candidates, this->slices[i]) : roaring_bitmap_andnot(candidates, this->slices[i]);
+      if (next == nullptr) {
+        roaring_bitmap_free(candidates);
+        return -1;
+      }
+      if (roaring_bitmap_is_empty(next)) {
+        roaring_bitmap_free(next);
+        if (!maximum) {
+          result |= (uint32_t)1 << i;
+        }
+      } else {
+        roaring_bitmap_free(candidates);
+        candidates = next;
+        if (maximum) {
+          result |= (uint32_t)1 << i;
+        }
+      }
+    }
+    roaring_bitmap_free(candidates);
+    value = result;
+    return 1;
+  }
+
+  /**
+   * Computes the k columns in the filter with the highest values.
+   * Columns with the same value are taken in ascending column order.
+   */
+  roaring_bitmap_t * topK(uint64_t k, const roaring_bitmap_t * filter) const {
+    roaring_bitmap_t * candidates = this->found(filter);
+    if (candidates == nullptr || roaring_bitmap_get_cardinality(candidates) <= k) {
+      return candidates;
+    }
+    roaring_bitmap_t * taken = roaring_bitmap_create();
+    if (taken == nullptr) {
+      roaring_bitmap_free(candidates);
+      return nullptr;
+    }
+    uint64_t takenCount = 0;
+    for (uint32_t i = this->bitDepth; i-- != 0 && takenCount < k;) {
+      // Candidates are the columns not taken yet, all with the same prefix of the highest values.
+      roaring_bitmap_t * high = roaring_bitmap_and(candidates, this->slices[i]);
+      const uint64_t highCount = roaring_bitmap_get_cardinality(high);
+      if (takenCount + highCount > k) {
+        roaring_bitmap_free(candidates);
+        candidates = high;
+      } else {
+        roaring_bitmap_or_inplace(taken, high);
+        roaring_bitmap_andnot_inplace(candidates, high);
+        roaring_bitmap_free(high);
+        takenCount += highCount;
+      }
+    }
+    if (takenCount < k) {
+      // All the remaining candidates have the same value, the ones with the lowest columns are taken.
+      uint32_t last;
+      if (roaring_bitmap_select(candidates, (uint32_t)(k - takenCount - 1), &last)) {
+        roaring_bitmap_remove_range_closed(candidates, last, UINT32_MAX);
+        roaring_bitmap_add(candidates, last);
+        roaring_bitmap_or_inplace(taken, candidates);
+      }
+    }
+    roaring_bitmap_free(candidates);
+    return taken;
+  }
+};
+
+static RoaringBitmapSliced32 * RoaringBitmapSliced32_unwrap(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<RoaringBitmapSliced32>(info.This(), isolate);
+  if (self == nullptr || self->existence == nullptr) {
+    v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+    return nullptr;
+  }
+  return self;
+}
+
+/** Reads an optional RoaringBitmap32 filter argument. Returns false and throws if the argument is not valid. */
+static bool RoaringBitmapSliced32_getFilter(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, const roaring_bitmap_t *& filter) {
+  filter = nullptr;
+  if (info.Length() <= argumentIndex || info[argumentIndex]->IsNullOrUndefined()) {
+    return true;
+  }
+  const RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<const RoaringBitmap32>(info[argumentIndex], info.GetIsolate());
+  if (bitmap == nullptr) {
+    v8utils::throwTypeError(info.GetIsolate(), "RoaringBitmapSliced32 - filter must be a RoaringBitmap32");
+    return false;
+  }
+  filter = bitmap->roaring;
+  return true;
+}
+
+static bool RoaringBitmapSliced32_getUint32(
+  const v8::FunctionCallbackInfo<v8::Value> & info, int argumentIndex, uint32_t & value) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (info.Length() <= argumentIndex || !v8utils::v8ValueToUint32Fast(isolate->GetCurrentContext(), info[argumentIndex], value)) {
+    v8utils::throwTypeError(isolate, "RoaringBitmapSliced32 - columns and values must be 32 bit unsigned integers");
+    return false;
+  }
+  return true;
+}
+
+/** Wraps a roaring_bitmap_t in a new RoaringBitmap32 and returns it. The bitmap is released on failure. */
+static void RoaringBitmapSliced32_returnBitmap(
+  const v8::FunctionCallbackInfo<v8::Value> & info, RoaringBitmapSliced32 * self, roaring_bitmap_t * r) {
+  v8::Isolate * isolate = info.GetIsolate();
+  if (r == nullptr) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32 - failed to allocate memory");
+  }
+  v8::Local<v8::Function> cons = self->addonData->RoaringBitmap32_constructor.Get(isolate);
+  v8::Local<v8::Object> result;
+  if (!cons->NewInstance(isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+    roaring_bitmap_free(r);
+    return;
+  }
+  RoaringBitmap32 * bitmap = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, isolate);
+  if (bitmap == nullptr) {
+    roaring_bitmap_free(r);
+    return v8utils::throwError(isolate, ERROR_INVALID_OBJECT);
+  }
+  bitmap->replaceBitmapInstance(isolate, r);
+  info.GetReturnValue().Set(result);
+}
+
+void RoaringBitmapSliced32_set(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column, value;
+  if (
+    self == nullptr || !RoaringBitmapSliced32_getUint32(info, 0, column) ||
+    !RoaringBitmapSliced32_getUint32(info, 1, value)) {
+    return;
+  }
+  if (!self->set(column, value)) {
+    return v8utils::throwError(info.GetIsolate(), "RoaringBitmapSliced32::set - failed to allocate memory");
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmapSliced32_setMany(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  v8utils::TypedArrayContent<uint32_t> columns;
+  v8utils::TypedArrayContent<uint32_t> values;
+  if (
+    info.Length() < 2 || !(info[0]->IsUint32Array() || info[0]->IsInt32Array()) ||
+    !(info[1]->IsUint32Array() || info[1]->IsInt32Array()) || !columns.set(isolate, info[0]) ||
+    !values.set(isolate, info[1])) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::setMany - columns and values must be Uint32Array");
+  }
+  if (columns.length != values.length) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::setMany - columns and values must have the same length");
+  }
+
+  // Grows once for the highest value, so the bulk contexts are valid for the whole loop.
+  uint32_t maxValue = 0;
+  for (size_t i = 0; i != values.length; ++i) {
+    maxValue |= values.data[i];
+  }
+  if (!self->grow(maxValue)) {
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::setMany - failed to allocate memory");
+  }
+  roaring_bulk_context_t contexts[RoaringBitmapSliced32::MAX_BIT_DEPTH] = {};
+  for (size_t i = 0; i != columns.length; ++i) {
+    self->set(columns.data[i], values.data[i], contexts);
+  }
+  info.GetReturnValue().Set(info.This());
+}
+
+void RoaringBitmapSliced32_get(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column, value;
+  if (self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+      info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) && self->get(column, value)) {
+    info.GetReturnValue().Set(value);
+  }
+}
+
+void RoaringBitmapSliced32_has(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+    info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) &&
+    roaring_bitmap_contains(self->existence, column));
+}
+
+void RoaringBitmapSliced32_delete(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t column;
+  info.GetReturnValue().Set(
+    self != nullptr && info.Length() > 0 && info[0]->IsUint32() &&
+    info[0]->Uint32Value(info.GetIsolate()->GetCurrentContext()).To(&column) && self->remove(column));
+}
+
+void RoaringBitmapSliced32_clear(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self != nullptr) {
+    self->clear();
+  }
+}
+
+void RoaringBitmapSliced32_columns(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->found(filter));
+  }
+}
+
+template <RoaringBitmapSliced32Operation OP>
+void RoaringBitmapSliced32_compare(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t value;
+  const roaring_bitmap_t * filter;
+  if (
+    self != nullptr && RoaringBitmapSliced32_getUint32(info, 0, value) &&
+    RoaringBitmapSliced32_getFilter(info, 1, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->compare(OP, value, filter));
+  }
+}
+
+void RoaringBitmapSliced32_between(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  uint32_t min, max;
+  const roaring_bitmap_t * filter;
+  if (
+    self != nullptr && RoaringBitmapSliced32_getUint32(info, 0, min) && RoaringBitmapSliced32_getUint32(info, 1, max) &&
+    RoaringBitmapSliced32_getFilter(info, 2, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->between(min, max, filter));
+  }
+}
+
+void RoaringBitmapSliced32_sum(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    uint64_t count;
+    info.GetReturnValue().Set((double)self->sum(filter, count));
+  }
+}
+
+template <bool MAXIMUM>
+void RoaringBitmapSliced32_extreme(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  const roaring_bitmap_t * filter;
+  if (self != nullptr && RoaringBitmapSliced32_getFilter(info, 0, filter)) {
+    uint32_t value;
+    const int found = self->extreme(MAXIMUM, filter, value);
+    if (found < 0) {
+      return v8utils::throwError(info.GetIsolate(), "RoaringBitmapSliced32 - failed to allocate memory");
+    }
+    if (found > 0) {
+      info.GetReturnValue().Set(value);
+    }
+  }
+}
+
+void RoaringBitmapSliced32_topK(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+  RoaringBitmapSliced32 * self = RoaringBitmapSliced32_unwrap(info);
+  if (self == nullptr) {
+    return;
+  }
+  double k;
+  if (info.Length() < 1 || !info[0]->IsNumber() || !info[0]->NumberValue(isolate->GetCurrentContext()).To(&k) || !(k >= 0)) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::topK - k must be a non negative number");
+  }
+  const roaring_bitmap_t * filter;
+  if (RoaringBitmapSliced32_getFilter(info, 1, filter)) {
+    RoaringBitmapSliced32_returnBitmap(info, self, self->topK(k < 4294967296.0 ? (uint64_t)k : 4294967296ULL, filter));
+  }
+}
+
+void RoaringBitmapSliced32_size_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<const RoaringBitmapSliced32>(info.This(), info.GetIsolate());
+  const uint64_t size = self != nullptr && self->existence != nullptr ? roaring_bitmap_get_cardinality(self->existence) : 0;
+  return size <= 0xFFFFFFFF ? info.GetReturnValue().Set((uint32_t)size) : info.GetReturnValue().Set((double)size);
+}
+
+void RoaringBitmapSliced32_bitDepth_getter(
+  v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> & info) {
+  const RoaringBitmapSliced32 * self = ObjectWrap::TryUnwrap<const RoaringBitmapSliced32>(info.This(), info.GetIsolate());
+  info.GetReturnValue().Set(self != nullptr ? self->bitDepth : 0U);
+}
+
+void RoaringBitmapSliced32_WeakCallback(v8::WeakCallbackInfo<RoaringBitmapSliced32> const & info) {
+  RoaringBitmapSliced32 * p = info.GetParameter();
+  if (p != nullptr) {
+    p->~RoaringBitmapSliced32();
+    bare_aligned_free(p);
+  }
+}
+
+void RoaringBitmapSliced32_New(const v8::FunctionCallbackInfo<v8::Value> & info) {
+  v8::Isolate * isolate = info.GetIsolate();
+
+  if (!info.IsConstructCall()) {
+    return v8utils::throwTypeError(isolate, "RoaringBitmapSliced32::ctor - needs to be called with new");
+  }
+
+  AddonData * addonData = AddonData::get(info);
+  if (addonData == nullptr) {
+    return v8utils::throwTypeError(isolate, ERROR_INVALID_OBJECT);
+  }
+
+  auto holder = info.This();
+
+  auto * instanceMemory = bare_aligned_malloc(16, sizeof(RoaringBitmapSliced32));
+  auto * instance = instanceMemory ? new (instanceMemory) RoaringBitmapSliced32(addonData) : nullptr;
+  if (instance == nullptr || instance->existence == nullptr) {
+    if (instance != nullptr) {
+      instance->~RoaringBitmapSliced32();
+      bare_aligned_free(instance);
+    }
+    return v8utils::throwError(isolate, "RoaringBitmapSliced32::ctor - allocation failed");
+  }
+
+  int indices[2] = {0, 1};
+  void * values[2] = {instance, (void *)(RoaringBitmapSliced32::OBJECT_TOKEN)};
+  holder->SetAlignedPointerInInternalFields(2, indices, values);
+
+  instance->persistent.Reset(isolate, holder);
+  instance->persistent.SetWeak(instance, RoaringBitmapSliced32_WeakCallback, v8::WeakCallbackType::kParameter);
+
+  info.GetReturnValue().Set(holder);
+}
+
+void RoaringBitmapSliced32_Init(v8::Local<v8::Object> exports, AddonData * addonData) {
+  v8::Isolate * isolate = addonData->isolate;
+
+  auto className = NEW_LITERAL_V8_STRING(isolate, "RoaringBitmapSliced32", v8::NewStringType::kInternalized);
+
+  v8::Local<v8::FunctionTemplate> ctor =
+    v8::FunctionTemplate::New(isolate, RoaringBitmapSliced32_New, addonData->external.Get(isolate));
+
+  ctor->SetClassName(className);
+  v8::Local<v8::ObjectTemplate> ctorInstanceTemplate = ctor->InstanceTemplate();
+  ctorInstanceTemplate->SetInternalFieldCount(2);
+
+#if V8_MAJOR_VERSION >= 12 && V8_MINOR_VERSION >= 1  // after 12.1.0
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+
+  ctorInstanceTemplate->SetNativeDataProperty(
+    NEW_LITERAL_V8_STRING(isolate, "bitDepth", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_bitDepth_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::PropertyAttribute)(v8::ReadOnly),
+    v8::SideEffectType::kHasNoSideEffect);
+#else
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "size", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_size_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+
+  ctorInstanceTemplate->SetAccessor(
+    NEW_LITERAL_V8_STRING(isolate, "bitDepth", v8::NewStringType::kInternalized),
+    RoaringBitmapSliced32_bitDepth_getter,
+    nullptr,
+    v8::Local<v8::Value>(),
+    (v8::AccessControl)(v8::ALL_CAN_READ),
+    (v8::PropertyAttribute)(v8::ReadOnly));
+#endif
+
+  NODE_SET_PROTOTYPE_METHOD(ctor, "between", RoaringBitmapSliced32_between);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "clear", RoaringBitmapSliced32_clear);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "columns", RoaringBitmapSliced32_columns);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "delete", RoaringBitmapSliced32_delete);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "equal", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::EQ>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "get", RoaringBitmapSliced32_get);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "greaterThan", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::GT>);
+  NODE_SET_PROTOTYPE_METHOD(
+    ctor, "greaterThanOrEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::GE>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "has", RoaringBitmapSliced32_has);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "lessThan", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::LT>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "lessThanOrEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::LE>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "max", RoaringBitmapSliced32_extreme<true>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "min", RoaringBitmapSliced32_extreme<false>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "notEqual", RoaringBitmapSliced32_compare<RoaringBitmapSliced32Operation::NEQ>);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "set", RoaringBitmapSliced32_set);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "setMany", RoaringBitmapSliced32_setMany);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "sum", RoaringBitmapSliced32_sum);
+  NODE_SET_PROTOTYPE_METHOD(ctor, "topK", RoaringBitmapSliced32_topK);
+
+  ctor->PrototypeTemplate()->Set(v8::Symbol::GetToStringTag(isolate), className);
+
+  v8::Local<v8::Function> ctorFunction;
+  if (!ctor->GetFunction(isolate->GetCurrentContext()).ToLocal(&ctorFunction)) {
+    return v8utils::throwError(isolate, "Failed to instantiate RoaringBitmapSliced32");
+  }
+
+  ignoreMaybeResult(exports->Set(isolate->GetCurrentContext(), className, ctorFunction));
+}
+
+#endif  // ROARING_NODE_ROARING_BITMAP_SLICED_32_
@@ -12,6 +12,11 @@ template <typename T>
 inline void ignoreMaybeResult(v8::MaybeLocal<T>) {}
 
 class AddonData final {
+ private:
+  v8::Global<v8::Uint32Array> scratchUint32Array;
+  uint32_t * scratchUint32ArrayData = nullptr;
+  bool scratchUint32ArrayInUse = false;
+
  public:
   v8::Isolate * isolate;
 
@@ -20,9 +25,12 @@ class AddonData final {
   v8::Global<v8::Object> Buffer;
   v8::Global<v8::Object> Uint32Array;
   v8::Global<v8::Function> Uint32Array_from;
+  v8::Global<v8::Function> Uint32Array_set;
   v8::Global<v8::Function> Buffer_from;
+  v8::Global<v8::Function> Array_from;
 
   std::atomic<uint64_t> RoaringBitmap32_instances;
+  std::atomic<uint64_t> RoaringBitmap64_instances;
   std::atomic<uint32_t> activeAsyncWorkers;
   std::atomic<bool> shuttingDown;
 
@@ -32,10 +40,24 @@ class AddonData final {
   v8::Global<v8::FunctionTemplate> RoaringBitmap32BufferedIterator_constructorTemplate;
   v8::Global<v8::Function> RoaringBitmap32BufferedIterator_constructor;
 
+  v8::Global<v8::FunctionTemplate> RoaringBitmap64_constructorTemplate;
+  v8::Global<v8::Function> RoaringBitmap64_constructor;
+
+  v8::Global<v8::FunctionTemplate> RoaringBitmap64BufferedIterator_constructorTemplate;
+  v8::Global<v8::Function> RoaringBitmap64BufferedIterator_constructor;
+
   v8::Global<v8::External> external;
 
+  /** Length of the reusable Uint32Array used to convert JS arrays, see acquireScratchUint32Array. */
+  static const constexpr uint32_t SCRATCH_UINT32_ARRAY_LENGTH = 1 << 17;
+
   inline explicit AddonData(v8::Isolate * isolate) :
-    isolate(isolate), strings(isolate), RoaringBitmap32_instances(0), activeAsyncWorkers(0), shuttingDown(false) {
+    isolate(isolate),
+    strings(isolate),
+    RoaringBitmap32_instances(0),
+    RoaringBitmap64_instances(0),
+    activeAsyncWorkers(0),
+    shuttingDown(false) {
     const int64_t externalSize = static_cast<int64_t>(sizeof(AddonData)) + 256;
     isolate->AdjustAmountOfExternalAllocatedMemory(externalSize);
   }
@@ -46,11 +68,18 @@ class AddonData final {
     Buffer.Reset();
     Uint32Array.Reset();
     Uint32Array_from.Reset();
+    Uint32Array_set.Reset();
+    scratchUint32Array.Reset();
     Buffer_from.Reset();
+    Array_from.Reset();
     RoaringBitmap32_constructorTemplate.Reset();
     RoaringBitmap32_constructor.Reset();
     RoaringBitmap32BufferedIterator_constructorTemplate.Reset();
     RoaringBitmap32BufferedIterator_constructor.Reset();
+    RoaringBitmap64_constructorTemplate.Reset();
+    RoaringBitmap64_constructor.Reset();
+    RoaringBitmap64BufferedIterator_constructorTemplate.Reset();
+    RoaringBitmap64BufferedIterator_constructor.Reset();
     external.Reset();
     const int64_t externalSize = -static_cast<int64_t>(sizeof(AddonData)) - 256;
     this->isolate->AdjustAmountOfExternalAllocatedMemory(externalSize);
@@ -99,13 +128,58 @@ class AddonData final {
 
     this->Uint32Array.Reset(isolate, uint32Array);
 
+    auto array = global->Get(context, NEW_LITERAL_V8_STRING(isolate, "Array", v8::NewStringType::kInternalized))
+                   .ToLocalChecked()
+                   .As<v8::Object>();
+
+    this->Array_from.Reset(
+      isolate,
+      array->Get(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized))
+        .ToLocalChecked()
+        .As<v8::Function>());
+
     this->Uint32Array_from.Reset(
       isolate,
       v8::Local<v8::Function>::Cast(
         uint32Array->Get(context, NEW_LITERAL_V8_STRING(isolate, "from", v8::NewStringType::kInternalized))
           .ToLocalChecked()));
+
+    this->Uint32Array_set.Reset(
+      isolate,
+      v8::Local<v8::Function>::Cast(
+        uint32Array->Get(context, NEW_LITERAL_V8_STRING(isolate, "prototype", v8::NewStringType::kInternalized))
+          .ToLocalChecked()
+          ->ToObject(context)
+          .ToLocalChecked()
+          ->Get(context, NEW_LITERAL_V8_STRING(isolate, "set", v8::NewStringType::kInternalized))
+          .ToLocalChecked()));
   }
 
+  /**
+   * Returns a reusable Uint32Array of SCRATCH_UINT32_ARRAY_LENGTH elements, allocated on first use, and its data.
+   * Returns an empty handle if the array is already in use by an outer call, that can happen if the conversion of a
+   * value calls back into JS. releaseScratchUint32Array must be called when done.
+   */
+  v8::Local<v8::Uint32Array> acquireScratchUint32Array(uint32_t *& data) {
+    if (this->scratchUint32ArrayInUse) {
+      return v8::Local<v8::Uint32Array>();
+    }
+    if (this->scratchUint32Array.IsEmpty()) {
+      v8::Local<v8::ArrayBuffer> arrayBuffer =
+        v8::ArrayBuffer::New(this->isolate, SCRATCH_UINT32_ARRAY_LENGTH * sizeof(uint32_t));
+      if (arrayBuffer.IsEmpty()) {
+        return v8::Local<v8::Uint32Array>();
+      }
+      this->scratchUint32ArrayData = (uint32_t *)arrayBuffer->GetBackingStore()->Data();
+      this->scratchUint32Array.Reset(this->isolate, v8::Uint32Array::New(arrayBuffer, 0, SCRATCH_UINT32_ARRAY_LENGTH));
+    }
+    this->scratchUint32ArrayInUse = true;
+    data = this->scratchUint32ArrayData;
+    return this->scratchUint32Array.Get(this->isolate);
+  }
+
+  inline void releaseScratchUint32Array() { this->scratchUint32ArrayInUse = false; }
+
   inline void setMethod(v8::Local<v8::Object> recv, const char * name, v8::FunctionCallback callback) {
     if (recv.IsEmpty() || name == nullptr || callback == nullptr) {
       return;
@@ -5,12 +5,15 @@
 
 const char * const ERROR_FROZEN = "This bitmap is frozen and cannot be modified";
 const char * const ERROR_INVALID_OBJECT = "Invalid RoaringBitmap32 object";
+const char * const ERROR_INVALID_OBJECT_64 = "Invalid RoaringBitmap64 object";
+const char * const ERROR_UINT64_RANGE = "RoaringBitmap64 - BigInt value is outside the 64 bit unsigned integer range";
 
 class AddonDataStrings final {
  public:
   v8::Global<v8::String> n;
   v8::Global<v8::String> readonly;
   v8::Global<v8::String> RoaringBitmap32;
+  v8::Global<v8::String> RoaringBitmap64;
   v8::Global<v8::Symbol> symbol_rnshared;
 
   v8::Global<v8::String> OperationFailed;
@@ -23,6 +26,7 @@ class AddonDataStrings final {
     literal(isolate, this->n, "n");
     literal(isolate, this->readonly, "readonly");
     literal(isolate, this->RoaringBitmap32, "RoaringBitmap32");
+    literal(isolate, this->RoaringBitmap64, "RoaringBitmap64");
     literal(isolate, this->Comma, ",");
 
     literal(isolate, this->OperationFailed, "Operation failed");
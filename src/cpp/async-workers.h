@@ -2,7 +2,7 @@
 #define ROARING_NODE_ASYNC_WORKERS_
 
 #include "RoaringBitmap32.h"
-#include "RoaringBitmap32-serialization.h"
+#include "serialization.h"
 #include "WorkerError.h"
 #include "memory.h"
 
@@ -480,8 +480,19 @@ class RoaringBitmap32FactoryAsyncWorker : public AsyncWorker {
   }
 };
 
-class ToUint32ArrayAsyncWorker final : public AsyncWorker {
+class ToUint32ArrayAsyncWorker final : public ParallelAsyncWorker {
  public:
+  /** Outputs smaller than this are decoded by a single thread. */
+  static const constexpr size_t PARALLEL_MIN_VALUES = 1 << 21;
+  /** Minimum number of values decoded by each parallel task. */
+  static const constexpr size_t PARTITION_MIN_VALUES = 1 << 18;
+
+  /** First container and output offset of a range of containers decoded by one task. */
+  struct Partition {
+    int32_t container;
+    size_t offset;
+  };
+
   const v8::FunctionCallbackInfo<v8::Value> & info;
   v8::Global<v8::Value> bitmapPersistent;
   RoaringBitmap32 * bitmap = nullptr;
@@ -490,9 +501,11 @@ class ToUint32ArrayAsyncWorker final : public AsyncWorker {
   std::atomic<size_t> outputSize{0};
   size_t maxSize = std::numeric_limits<size_t>::max();
   bool hasInput = false;
+  uint32_t * output = nullptr;
+  Partition * partitions = nullptr;
 
   explicit ToUint32ArrayAsyncWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ToUint32ArrayAsyncWorker));
   }
 
@@ -501,6 +514,7 @@ class ToUint32ArrayAsyncWorker final : public AsyncWorker {
     if (buffer) {
       bare_aligned_free(buffer);
     }
+    gcaware_free(this->isolate, this->partitions);
     _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ToUint32ArrayAsyncWorker));
   }
 
@@ -537,45 +551,81 @@ class ToUint32ArrayAsyncWorker final : public AsyncWorker {
 
     this->bitmap = self;
     this->bitmap->beginFreeze();
-  }
 
-  void work() final {
-    auto size = this->bitmap->getSize();
+    size_t size = this->bitmap->getSize();
+    const size_t limit = this->hasInput ? this->inputContent.length : this->maxSize;
+    if (size > limit) {
+      size = limit;
+    }
     if (size == 0) {
       return;
     }
 
     if (this->hasInput) {
-      if (size > this->inputContent.length) {
-        size_t limitedSize = this->inputContent.length;
-        this->outputSize.store(limitedSize, std::memory_order_release);
-        roaring_bitmap_range_uint32_array(this->bitmap->roaring, 0, limitedSize, this->inputContent.data);
-      } else {
-        this->outputSize.store(size, std::memory_order_release);
-        roaring_bitmap_to_uint32_array(this->bitmap->roaring, this->inputContent.data);
+      this->output = this->inputContent.data;
+    } else {
+      this->output = static_cast<uint32_t *>(bare_aligned_malloc(32, size * sizeof(uint32_t)));
+      if (!this->output) {
+        return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to allocate memory"));
       }
-      return;
+      this->allocatedBuffer.store(this->output, std::memory_order_release);
     }
+    this->outputSize.store(size, std::memory_order_release);
 
-    auto maxSize = this->maxSize;
-    if (maxSize > size) {
-      maxSize = size;
-    }
+    this->partition(size);
+  }
 
-    // Allocate a new buffer
-    uint32_t * buffer = static_cast<uint32_t *>(bare_aligned_malloc(32, size * sizeof(uint32_t)));
-    if (!buffer) {
+  /**
+   * Splits the containers in ranges of about the same number of values, so each thread
+   * decodes a disjoint range straight into the output at an offset known in advance.
+   */
+  void partition(size_t size) {
+    const roaring_array_t * ra = &this->bitmap->roaring->high_low_container;
+
+    size_t partitionValues = size;
+    if (size >= PARALLEL_MIN_VALUES) {
+      // A few partitions per thread balance the load when containers have different cardinality.
+      partitionValues = std::max(PARTITION_MIN_VALUES, size / ((size_t)getCpusCount() * 4));
+    }
+    const size_t maxPartitions = (size + partitionValues - 1) / partitionValues + 1;
+    this->partitions = (Partition *)gcaware_malloc((maxPartitions + 1) * sizeof(Partition));
+    if (this->partitions == nullptr) {
       return this->setError(WorkerError("RoaringBitmap32::toUint32ArrayAsync - failed to allocate memory"));
     }
-    this->allocatedBuffer.store(buffer, std::memory_order_release);
 
-    if (maxSize < size) {
-      roaring_bitmap_range_uint32_array(this->bitmap->roaring, 0, maxSize, buffer);
-    } else {
-      roaring_bitmap_to_uint32_array(this->bitmap->roaring, buffer);
+    uint32_t count = 0;
+    size_t offset = 0;
+    size_t partitionStart = 0;
+    this->partitions[0] = {0, 0};
+    int32_t i = 0;
+    for (; i < ra->size && offset < size; ++i) {
+      if (offset - partitionStart >= partitionValues && count + 1 < maxPartitions) {
+        this->partitions[++count] = {i, offset};
+        partitionStart = offset;
+      }
+      offset += roaring::internal::container_get_cardinality(ra->containers[i], ra->typecodes[i]);
     }
+    this->partitions[++count] = {i, offset};
+    this->loopCount = count;
+  }
 
-    this->outputSize.store(maxSize, std::memory_order_release);
+  void parallelWork(uint32_t index) final {
+    const roaring_bitmap_t * r = this->bitmap->roaring;
+    const roaring_array_t * ra = &r->high_low_container;
+    const size_t size = this->outputSize.load(std::memory_order_relaxed);
+    size_t offset = this->partitions[index].offset;
+    const int32_t end = this->partitions[index + 1].container;
+    for (int32_t i = this->partitions[index].container; i < end; ++i) {
+      const size_t cardinality = roaring::internal::container_get_cardinality(ra->containers[i], ra->typecodes[i]);
+      if (offset + cardinality > size) {
+        // The output is truncated in the middle of the last container.
+        roaring_bitmap_range_uint32_array(r, offset, size - offset, this->output + offset);
+        break;
+      }
+      roaring::internal::container_to_uint32_array(
+        this->output + offset, ra->containers[i], ra->typecodes[i], (uint32_t)ra->keys[i] << 16);
+      offset += cardinality;
+    }
   }
 
   void finally() final {
@@ -635,14 +685,18 @@ class ToUint32ArrayAsyncWorker final : public AsyncWorker {
   }
 };
 
-class SerializeWorker final : public AsyncWorker {
+/**
+ * Serializes a bitmap to a buffer. Big bitmaps in the croaring, portable and unsafe_frozen_croaring formats
+ * are split in ranges of containers written concurrently, the output is the same of the synchronous serialize.
+ */
+class SerializeWorker final : public ParallelAsyncWorker {
  public:
   const v8::FunctionCallbackInfo<v8::Value> & info;
   v8::Global<v8::Value> bitmapPersistent;
   RoaringBitmapSerializer serializer;
 
   explicit SerializeWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeWorker));
   }
 
@@ -652,18 +706,33 @@ class SerializeWorker final : public AsyncWorker {
   // Called before the thread starts, in the main thread.
   void before() final {
     this->serializer.parseArguments(this->info);
-    if (this->serializer.self) {
-      if (this->maybeAddonData == nullptr) {
-        this->maybeAddonData = this->serializer.self->addonData;
-      }
-      this->bitmapPersistent.Reset(isolate, this->info.This());
-      this->serializer.self->beginFreeze();
+    if (!this->serializer.self) {
+      return;
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = this->serializer.self->addonData;
+    }
+    this->bitmapPersistent.Reset(isolate, this->info.This());
+    this->serializer.self->beginFreeze();
+
+    WorkerError err = this->serializer.computeSerializedSize();
+    if (!err.hasError()) {
+      err = this->serializer.prepareBuffer();
+    }
+    if (err.hasError()) {
+      return this->setError(err);
+    }
+    this->loopCount = this->serializer.computeParts(getCpusCount());
+    if (this->loopCount == 0) {
+      this->setError(WorkerError("RoaringBitmap32 serialization allocation failed"));
     }
   }
 
-  void work() final {
-    if (this->serializer.self) {
-      this->setError(this->serializer.serialize());
+  void parallelWork(uint32_t index) final {
+    if (this->serializer.partsCount() <= 1) {
+      this->setError(this->serializer.serializeToBuffer(this->serializer.outputBuffer));
+    } else {
+      this->serializer.serializePart(this->serializer.outputBuffer, index);
     }
   }
 
@@ -676,14 +745,22 @@ class SerializeWorker final : public AsyncWorker {
   void done(v8::Local<v8::Value> & result) final { this->serializer.done(this->isolate, result); }
 };
 
-class SerializeFileWorker final : public AsyncWorker {
+/**
+ * Serializes a bitmap to a file. As SerializeWorker, big bitmaps are written concurrently in ranges of containers,
+ * the file is created and mapped by the first task and closed by the last one.
+ */
+class SerializeFileWorker final : public ParallelAsyncWorker {
  public:
   const v8::FunctionCallbackInfo<v8::Value> & info;
   v8::Global<v8::Value> bitmapPersistent;
   RoaringBitmapFileSerializer serializer;
 
   explicit SerializeFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * maybeAddonData) :
-    AsyncWorker(info.GetIsolate(), maybeAddonData), info(info) {
+    ParallelAsyncWorker(info.GetIsolate(), maybeAddonData),
+    info(info),
+    _data(nullptr),
+    _opened(false),
+    _completedParts(0) {
     _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializeFileWorker));
   }
 
@@ -693,22 +770,47 @@ class SerializeFileWorker final : public AsyncWorker {
   // Called before the thread starts, in the main thread.
   void before() final {
     this->serializer.parseArguments(this->info);
-    if (this->serializer.self) {
-      if (this->maybeAddonData == nullptr) {
-        this->maybeAddonData = this->serializer.self->addonData;
+    if (!this->serializer.self) {
+      return;
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = this->serializer.self->addonData;
+    }
+    this->bitmapPersistent.Reset(isolate, this->info.This());
+    this->serializer.self->beginFreeze();
+
+    // Text formats have no size known up front, they are always written by a single task.
+    this->loopCount = 1;
+    if (!this->serializer.computeSerializedSize().hasError()) {
+      this->loopCount = this->serializer.computeParts(getCpusCount());
+      if (this->loopCount == 0) {
+        this->setError(WorkerError("RoaringBitmap32 serialization allocation failed"));
       }
-      this->bitmapPersistent.Reset(isolate, this->info.This());
-      this->serializer.self->beginFreeze();
     }
   }
 
-  void work() final {
-    if (this->serializer.self) {
+  void parallelWork(uint32_t index) final {
+    if (this->serializer.partsCount() <= 1) {
       this->setError(this->serializer.serialize());
+      return;
+    }
+    if (!this->_open()) {
+      return;
+    }
+    this->serializer.serializePart(this->_data, index);
+    if (this->_completedParts.fetch_add(1, std::memory_order_acq_rel) + 1 == this->loopCount) {
+      std::lock_guard<std::mutex> lock(this->_outputMutex);
+      this->setError(this->serializer.closeOutput(this->_data, true));
+      this->_data = nullptr;
     }
   }
 
   void finally() final {
+    if (this->_opened && this->_data != nullptr) {
+      // Not all the parts were written, release the output without writing it.
+      this->serializer.closeOutput(this->_data, false);
+      this->_data = nullptr;
+    }
     if (this->serializer.self) {
       this->serializer.self->endFreeze();
     }
@@ -719,6 +821,127 @@ class SerializeFileWorker final : public AsyncWorker {
       result = this->bitmapPersistent.Get(this->isolate);
     }
   }
+
+ private:
+  std::mutex _outputMutex;
+  uint8_t * _data;
+  bool _opened;
+  std::atomic<uint32_t> _completedParts;
+
+  bool _open() {
+    std::lock_guard<std::mutex> lock(this->_outputMutex);
+    if (!this->_opened) {
+      this->_opened = true;
+      WorkerError err = this->serializer.openOutput(this->_data);
+      if (err.hasError()) {
+        this->serializer.closeOutput(this->_data, false);
+        this->_data = nullptr;
+        this->setError(err);
+      }
+    }
+    return this->_data != nullptr;
+  }
+};
+
+/**
+ * Checks the presence of many values in a bitmap, in parallel.
+ * The values are split in chunks of CHUNK_SIZE values, each chunk is checked by one thread with its own bulk context.
+ */
+class HasManyParallelWorker final : public ParallelAsyncWorker {
+ public:
+  /** Number of values per chunk, a multiple of 32 so threads never write the same word of a packed output. */
+  static const constexpr size_t CHUNK_SIZE = 65536;
+
+  RoaringBitmap32 * bitmap;
+  v8::Global<v8::Value> bitmapPersistent;
+  v8::Global<v8::Value> resultPersistent;
+  v8utils::TypedArrayContent<uint32_t> values;
+  v8utils::TypedArrayContent<uint8_t> output;
+  bool packed;
+  bool frozen;
+
+  explicit HasManyParallelWorker(v8::Isolate * isolate, RoaringBitmap32 * bitmap) :
+    ParallelAsyncWorker(isolate, bitmap->addonData), bitmap(bitmap), packed(false), frozen(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(HasManyParallelWorker));
+  }
+
+  virtual ~HasManyParallelWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(HasManyParallelWorker)); }
+
+  void setResult(v8::Local<v8::Value> result) {
+    this->resultPersistent.Reset(this->isolate, result);
+    this->loopCount = (uint32_t)((this->values.length + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  }
+
+ protected:
+  void before() final {
+    if (!this->hasError()) {
+      this->bitmapPersistent.Reset(this->isolate, this->bitmap->persistent.Get(this->isolate));
+      this->owner()->beginFreeze();
+      this->frozen = true;
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    const size_t begin = (size_t)index * CHUNK_SIZE;
+    const size_t count = std::min(CHUNK_SIZE, this->values.length - begin);
+    if (this->packed) {
+      roaringHasManyBits(this->bitmap->roaring, this->values.data + begin, count, (uint32_t *)this->output.data + (begin >> 5));
+    } else {
+      roaringHasMany(this->bitmap->roaring, this->values.data + begin, count, this->output.data + begin);
+    }
+  }
+
+  void finally() final {
+    if (this->frozen) {
+      this->frozen = false;
+      this->owner()->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final { result = this->resultPersistent.Get(this->isolate); }
+
+ private:
+  RoaringBitmap32 * owner() const {
+    return this->bitmap->readonlyViewOf ? this->bitmap->readonlyViewOf : this->bitmap;
+  }
+};
+
+class SerializePackFileWorker final : public AsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  RoaringBitmap32Pins pins;
+  RoaringBitmapPackFileSerializer serializer;
+  bool frozen;
+
+  explicit SerializePackFileWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    AsyncWorker(info.GetIsolate(), addonData), info(info), frozen(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(SerializePackFileWorker));
+  }
+
+  virtual ~SerializePackFileWorker() { _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(SerializePackFileWorker)); }
+
+ protected:
+  void before() final {
+    this->setError(this->serializer.parseArguments(this->info));
+    if (!this->hasError()) {
+      for (uint32_t i = 0; i != this->serializer.count; ++i) {
+        this->pins.pin(this->isolate, this->serializer.bitmaps[i]);
+      }
+      this->serializer.beginFreeze();
+      this->frozen = true;
+    }
+  }
+
+  void work() final { this->setError(this->serializer.serialize()); }
+
+  void finally() final {
+    if (this->frozen) {
+      this->frozen = false;
+      this->serializer.endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final { result = v8::Undefined(this->isolate); }
 };
 
 class DeserializeWorker final : public AsyncWorker {
@@ -867,6 +1090,168 @@ class DeserializeParallelWorker : public ParallelAsyncWorker {
   }
 };
 
+/**
+ * Serializes many bitmaps in parallel, to a buffer each or, if contiguous is true, to a single pre-sized buffer.
+ * In the contiguous buffer the bitmaps in the unsafe_frozen_croaring format start at a 32 bytes boundary.
+ */
+class SerializeParallelWorker final : public ParallelAsyncWorker {
+ public:
+  RoaringBitmap32Pins pins;
+  RoaringBitmapSerializer * items;
+  bool contiguous;
+
+  explicit SerializeParallelWorker(v8::Isolate * isolate, AddonData * maybeAddonData) :
+    ParallelAsyncWorker(isolate, maybeAddonData),
+    items(nullptr),
+    contiguous(false),
+    _offsets(nullptr),
+    _buffer(nullptr),
+    _bufferSize(0),
+    _frozen(false) {}
+
+  virtual ~SerializeParallelWorker() {
+    if (items) {
+      delete[] items;
+    }
+    gcaware_free(this->isolate, _offsets);
+    bare_aligned_free(_buffer);
+  }
+
+ protected:
+  // Called before the threads start, in the main thread.
+  void before() final {
+    const uint32_t count = this->loopCount;
+    for (uint32_t i = 0; i != count; ++i) {
+      this->owner(i)->beginFreeze();
+    }
+    this->_frozen = true;
+
+    for (uint32_t i = 0; i != count; ++i) {
+      WorkerError err = this->items[i].computeSerializedSize();
+      if (err.hasError()) {
+        return this->setError(err);
+      }
+    }
+
+    if (!this->contiguous) {
+      return;
+    }
+
+    if (count != 0) {
+      this->_offsets = (size_t *)gcaware_malloc(count * sizeof(size_t));
+      if (this->_offsets == nullptr) {
+        return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+      }
+    }
+    size_t size = 0;
+    for (uint32_t i = 0; i != count; ++i) {
+      const RoaringBitmapSerializer & item = this->items[i];
+      if (item.format == FileSerializationFormat::unsafe_frozen_croaring) {
+        size = (size + 31) & ~(size_t)31;
+      }
+      this->_offsets[i] = size;
+      size += item.serializedSize;
+    }
+    this->_bufferSize = size;
+    this->_buffer = (uint8_t *)bare_aligned_malloc(32, size != 0 ? size : 1);
+    if (this->_buffer == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+    }
+  }
+
+  void parallelWork(uint32_t index) final {
+    RoaringBitmapSerializer & item = this->items[index];
+    WorkerError error;
+    if (this->contiguous) {
+      // Zero the alignment padding before the body.
+      const size_t previousEnd = index != 0 ? this->_offsets[index - 1] + this->items[index - 1].serializedSize : 0;
+      memset(this->_buffer + previousEnd, 0, this->_offsets[index] - previousEnd);
+      error = item.serializeToBuffer(this->_buffer + this->_offsets[index]);
+    } else {
+      error = item.serialize();
+    }
+    if (error.hasError()) {
+      std::lock_guard<std::mutex> lock(this->_errorMutex);
+      this->setError(error);
+    }
+  }
+
+  void finally() final {
+    if (this->_frozen) {
+      this->_frozen = false;
+      for (uint32_t i = 0; i != this->loopCount; ++i) {
+        this->owner(i)->endFreeze();
+      }
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    const uint32_t count = this->loopCount;
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    if (!this->contiguous) {
+      v8::Local<v8::Array> resultArray = v8::Array::New(isolate, count);
+      if (resultArray.IsEmpty()) {
+        return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to create a new array"));
+      }
+      for (uint32_t i = 0; i != count; ++i) {
+        v8::Local<v8::Value> buffer;
+        this->items[i].done(isolate, buffer);
+        if (buffer.IsEmpty()) {
+          return;
+        }
+        ignoreMaybeResult(resultArray->Set(context, i, buffer));
+      }
+      result = resultArray;
+      return;
+    }
+
+    v8::Local<v8::Object> buffer;
+    if (!node::Buffer::New(isolate, (char *)this->_buffer, this->_bufferSize, bare_aligned_free_callback, nullptr)
+           .ToLocal(&buffer)) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to create a new buffer"));
+    }
+    this->_buffer = nullptr;
+
+    v8::Local<v8::ArrayBuffer> offsetsBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    v8::Local<v8::ArrayBuffer> lengthsBuffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+    if (offsetsBuffer.IsEmpty() || lengthsBuffer.IsEmpty()) {
+      return this->setError(WorkerError("RoaringBitmap32::serializeParallelAsync - failed to allocate memory"));
+    }
+    double * offsets = (double *)offsetsBuffer->GetBackingStore()->Data();
+    double * lengths = (double *)lengthsBuffer->GetBackingStore()->Data();
+    for (uint32_t i = 0; i != count; ++i) {
+      offsets[i] = (double)this->_offsets[i];
+      lengths[i] = (double)this->items[i].serializedSize;
+    }
+
+    v8::Local<v8::Object> resultObject = v8::Object::New(isolate);
+    ignoreMaybeResult(
+      resultObject->Set(context, NEW_LITERAL_V8_STRING(isolate, "buffer", v8::NewStringType::kInternalized), buffer));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "offsets", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(offsetsBuffer, 0, count)));
+    ignoreMaybeResult(resultObject->Set(
+      context,
+      NEW_LITERAL_V8_STRING(isolate, "lengths", v8::NewStringType::kInternalized),
+      v8::Float64Array::New(lengthsBuffer, 0, count)));
+    result = resultObject;
+  }
+
+ private:
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->items[index].self;
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  std::mutex _errorMutex;
+  size_t * _offsets;
+  uint8_t * _buffer;
+  size_t _bufferSize;
+  bool _frozen;
+};
+
 class FromArrayAsyncWorker : public RoaringBitmap32FactoryAsyncWorker {
  public:
   v8::Global<v8::Value> argPersistent;
@@ -893,4 +1278,663 @@ class FromArrayAsyncWorker : public RoaringBitmap32FactoryAsyncWorker {
   }
 };
 
+typedef roaring_bitmap_t * (*RoaringBitmap32BinaryOperation)(const roaring_bitmap_t *, const roaring_bitmap_t *);
+
+/**
+ * Computes a binary set operation (and, or, xor, andNot) in a worker thread.
+ * Both inputs are frozen until the operation completes.
+ * If inPlace is true the result replaces the content of the first bitmap (this) when the worker completes,
+ * so readers on the main thread never observe a partially modified bitmap.
+ */
+class BinaryOperationAsyncWorker final : public RoaringBitmap32FactoryAsyncWorker {
+ public:
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+  const RoaringBitmap32BinaryOperation operation;
+  const bool inPlace;
+  v8::Global<v8::Value> aPersistent;
+  v8::Global<v8::Value> bPersistent;
+  RoaringBitmap32 * a = nullptr;
+  RoaringBitmap32 * b = nullptr;
+  int64_t resultSize = -1;
+
+  explicit BinaryOperationAsyncWorker(
+    const v8::FunctionCallbackInfo<v8::Value> & info,
+    AddonData * addonData,
+    RoaringBitmap32BinaryOperation operation,
+    bool inPlace) :
+    RoaringBitmap32FactoryAsyncWorker(info.GetIsolate(), addonData), info(info), operation(operation), inPlace(inPlace) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(BinaryOperationAsyncWorker));
+  }
+
+  virtual ~BinaryOperationAsyncWorker() {
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(BinaryOperationAsyncWorker));
+  }
+
+ protected:
+  // Called before the thread starts, in the main thread.
+  void before() final {
+    v8::Isolate * isolate = this->isolate;
+
+    v8::Local<v8::Value> aValue = this->inPlace ? v8::Local<v8::Value>(this->info.This()) : this->info[0];
+    v8::Local<v8::Value> bValue = this->inPlace ? this->info[0] : this->info[1];
+
+    RoaringBitmap32 * a = ObjectWrap::TryUnwrap<RoaringBitmap32>(aValue, isolate);
+    if (a == nullptr) {
+      return this->setError(WorkerError(
+        this->inPlace ? ERROR_INVALID_OBJECT : "RoaringBitmap32 async operation first argument must be a RoaringBitmap32"));
+    }
+    if (this->maybeAddonData == nullptr) {
+      this->maybeAddonData = a->addonData;
+    }
+    if (this->inPlace && a->isFrozen()) {
+      return this->setError(WorkerError(ERROR_FROZEN));
+    }
+
+    RoaringBitmap32 * b = ObjectWrap::TryUnwrap<RoaringBitmap32>(bValue, isolate);
+    if (b == nullptr) {
+      if (!this->inPlace) {
+        return this->setError(WorkerError("RoaringBitmap32 async operation second argument must be a RoaringBitmap32"));
+      }
+      // In place operations accept anything the constructor accepts, like the synchronous versions.
+      v8::Local<v8::Value> argv[] = {bValue};
+      v8::Local<v8::Object> converted;
+      if (!this->maybeAddonData->RoaringBitmap32_constructor.Get(isolate)
+             ->NewInstance(isolate->GetCurrentContext(), 1, argv)
+             .ToLocal(&converted)) {
+        return;
+      }
+      bValue = converted;
+      b = ObjectWrap::TryUnwrap<RoaringBitmap32>(bValue, isolate);
+      if (b == nullptr) {
+        return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+      }
+    }
+
+    this->aPersistent.Reset(isolate, aValue);
+    this->bPersistent.Reset(isolate, bValue);
+
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    this->a = a->readonlyViewOf ? a->readonlyViewOf : a;
+    this->b = b->readonlyViewOf ? b->readonlyViewOf : b;
+    this->a->beginFreeze();
+    this->b->beginFreeze();
+  }
+
+  void work() final {
+    roaring_bitmap_t_ptr r = this->operation(this->a->roaring, this->b->roaring);
+    if (r == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32 async operation failed materalization"));
+    }
+    if (this->inPlace) {
+      // Count here, in the worker thread, so the size of the target is already known when the operation completes.
+      this->resultSize = (int64_t)roaring_bitmap_get_cardinality(r);
+    }
+    this->bitmap.store(r, std::memory_order_release);
+  }
+
+  void finally() final {
+    if (this->a) {
+      this->a->endFreeze();
+    }
+    if (this->b) {
+      this->b->endFreeze();
+    }
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    if (!this->inPlace) {
+      return RoaringBitmap32FactoryAsyncWorker::done(result);
+    }
+
+    roaring_bitmap_t_ptr r = this->bitmap.load(std::memory_order_acquire);
+    if (r == nullptr) {
+      return this->setError(WorkerError("RoaringBitmap32 async operation failed materalization"));
+    }
+
+    // Swap the content instead of the pointer, readonly views keep pointing to the same roaring bitmap.
+    // The previous content is released by the destructor of this worker.
+    std::swap(*this->a->roaring, *r);
+    this->a->invalidate(this->resultSize);
+
+    result = this->aPersistent.Get(this->isolate);
+  }
+};
+
+/**
+ * Base class for workers that compute a RoaringBitmap32 with a parallel reduction.
+ * Each partition is reduced to a partial bitmap in a different thread,
+ * the last partition to complete merges all the partial results, still in a worker thread.
+ */
+class RoaringBitmap32ParallelReduceWorker : public ParallelAsyncWorker {
+ public:
+  roaring_bitmap_t ** partials;
+  std::atomic<uint32_t> completedPartitions;
+  std::atomic<roaring_bitmap_t_ptr> bitmap;
+
+  explicit RoaringBitmap32ParallelReduceWorker(v8::Isolate * isolate, AddonData * addonData) :
+    ParallelAsyncWorker(isolate, addonData), partials(nullptr), completedPartitions(0), bitmap(nullptr) {}
+
+  virtual ~RoaringBitmap32ParallelReduceWorker() {
+    if (this->partials != nullptr) {
+      for (uint32_t i = 0; i != this->loopCount; ++i) {
+        if (this->partials[i] != nullptr) {
+          roaring_bitmap_free(this->partials[i]);
+        }
+      }
+      gcaware_free(this->isolate, this->partials);
+    }
+    roaring_bitmap_t_ptr ptr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (ptr != nullptr) {
+      roaring_bitmap_free(ptr);
+    }
+  }
+
+  /** Allocates the given number of partitions, one per thread. */
+  bool allocatePartitions(uint32_t count) {
+    if (count == 0) {
+      count = 1;
+    }
+    this->partials = (roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    if (this->partials == nullptr) {
+      return false;
+    }
+    memset(this->partials, 0, count * sizeof(roaring_bitmap_t *));
+    this->loopCount = count;
+    this->concurrency = count;
+    return true;
+  }
+
+ protected:
+  /** Sets the error from a worker thread, partitions can fail concurrently. */
+  void setPartitionError(const WorkerError & error) {
+    std::lock_guard<std::mutex> lock(this->_errorMutex);
+    this->setError(error);
+  }
+
+  /** Computes the partial result of a partition, in a worker thread. Returns nullptr on failure. */
+  virtual roaring_bitmap_t * reducePartition(uint32_t index) = 0;
+
+  /** Merges the partial results, in a worker thread. Returns nullptr on failure. */
+  virtual roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) = 0;
+
+  void parallelWork(uint32_t index) final {
+    roaring_bitmap_t * partial = this->reducePartition(index);
+    if (partial == nullptr) {
+      return this->setPartitionError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+    }
+    this->partials[index] = partial;
+
+    const uint32_t partitions = this->loopCount;
+    if (this->completedPartitions.fetch_add(1, std::memory_order_acq_rel) + 1 != partitions) {
+      return;
+    }
+
+    roaring_bitmap_t * result;
+    if (partitions == 1) {
+      result = partial;
+      this->partials[0] = nullptr;
+    } else {
+      result = this->mergePartitions(this->partials, partitions);
+      if (result == nullptr) {
+        return this->setPartitionError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+      }
+    }
+    this->bitmap.store(result, std::memory_order_release);
+  }
+
+  void done(v8::Local<v8::Value> & result) override {
+    roaring_bitmap_t_ptr bitmapPtr = this->bitmap.exchange(nullptr, std::memory_order_acq_rel);
+    if (bitmapPtr == nullptr) {
+      bitmapPtr = roaring_bitmap_create();
+      if (bitmapPtr == nullptr) {
+        return this->setError(WorkerError("RoaringBitmap32 parallel operation failed roaring allocation"));
+      }
+    }
+
+    v8::Local<v8::Function> cons = this->maybeAddonData->RoaringBitmap32_constructor.Get(this->isolate);
+
+    if (!cons->NewInstance(this->isolate->GetCurrentContext(), 0, nullptr).ToLocal(&result)) {
+      roaring_bitmap_free(bitmapPtr);
+      return this->setError(WorkerError("RoaringBitmap32 parallel operation failed to create a new instance"));
+    }
+
+    RoaringBitmap32 * unwrapped = ObjectWrap::TryUnwrap<RoaringBitmap32>(result, this->isolate);
+    if (unwrapped == nullptr) {
+      roaring_bitmap_free(bitmapPtr);
+      return this->setError(WorkerError(ERROR_INVALID_OBJECT));
+    }
+
+    unwrapped->replaceBitmapInstance(this->isolate, bitmapPtr);
+  }
+
+ private:
+  std::mutex _errorMutex;
+};
+
+/**
+ * Computes a multi-way OR, XOR or AND of many bitmaps with a parallel reduction.
+ * The inputs are split in partitions, each partition is reduced in a different thread.
+ * For an intersection the inputs sorted by size are interleaved, so every partition starts from one of the smallest.
+ */
+class ManyOperationParallelWorker final : public RoaringBitmap32ParallelReduceWorker {
+ public:
+  enum class Operation { OR, XOR, AND };
+
+  /** Below this number of bitmaps per partition, splitting the work is not worth the overhead. */
+  static const constexpr uint32_t MIN_PARTITION_SIZE = 4;
+
+  const Operation operation;
+  RoaringBitmap32Pins pins;
+  const roaring_bitmap_t ** inputs;
+  RoaringBitmap32 ** pinned;
+  uint32_t inputsCount;
+  uint32_t pinnedCount;
+  std::atomic<bool> emptyIntersection;
+
+  explicit ManyOperationParallelWorker(v8::Isolate * isolate, AddonData * addonData, Operation operation) :
+    RoaringBitmap32ParallelReduceWorker(isolate, addonData),
+    operation(operation),
+    inputs(nullptr),
+    pinned(nullptr),
+    inputsCount(0),
+    pinnedCount(0),
+    emptyIntersection(false) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ManyOperationParallelWorker));
+  }
+
+  virtual ~ManyOperationParallelWorker() {
+    gcaware_free(this->isolate, this->inputs);
+    gcaware_free(this->isolate, this->pinned);
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ManyOperationParallelWorker));
+  }
+
+  /** Allocates the inputs. Returns false if the allocation failed. */
+  bool reserve(uint32_t count) {
+    if (count == 0) {
+      return true;
+    }
+    this->inputs = (const roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    this->pinned = (RoaringBitmap32 **)gcaware_malloc(count * sizeof(RoaringBitmap32 *));
+    return this->inputs != nullptr && this->pinned != nullptr;
+  }
+
+  /** Adds an input bitmap and freezes it until the operation completes. */
+  void addInput(RoaringBitmap32 * input) {
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    RoaringBitmap32 * owner = input->readonlyViewOf ? input->readonlyViewOf : input;
+    owner->beginFreeze();
+    this->pins.pin(this->isolate, input);
+    this->pinned[this->pinnedCount++] = owner;
+    this->inputs[this->inputsCount++] = input->roaring;
+  }
+
+  /** Sorts the inputs by cardinality, smallest first, so each partition of an intersection starts from the smallest. */
+  void sortInputsBySize() {
+    roaringSortBySize(this->pinned, this->pinnedCount);
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->inputs[i] = this->pinned[i]->roaring;
+    }
+  }
+
+  /** Splits the inputs in partitions, one per thread. */
+  bool partition() {
+    uint32_t partitions = this->inputsCount / MIN_PARTITION_SIZE;
+    const uint32_t cpus = getCpusCount();
+    if (partitions > cpus) {
+      partitions = cpus;
+    }
+    if (!this->allocatePartitions(partitions)) {
+      return false;
+    }
+    if (this->operation == Operation::AND && this->loopCount > 1) {
+      // Partition p takes the sorted inputs p, p + partitions, p + 2 * partitions..., still sorted by size.
+      uint32_t position = 0;
+      for (uint32_t p = 0; p != this->loopCount; ++p) {
+        for (uint32_t i = p; i < this->pinnedCount; i += this->loopCount) {
+          this->inputs[position++] = this->pinned[i]->roaring;
+        }
+      }
+    }
+    return true;
+  }
+
+ protected:
+  roaring_bitmap_t * reducePartition(uint32_t index) final {
+    const uint32_t begin = this->partitionBegin(index);
+    return this->reduce(this->inputs + begin, this->partitionBegin(index + 1) - begin, false);
+  }
+
+  roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) final {
+    return this->reduce((const roaring_bitmap_t **)partials, count, true);
+  }
+
+  void finally() final {
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->pinned[i]->endFreeze();
+    }
+    this->pinnedCount = 0;
+  }
+
+ private:
+  /** The first input of a partition. The first count % partitions partitions have one input more than the others. */
+  uint32_t partitionBegin(uint32_t index) const {
+    const uint32_t partitions = this->loopCount;
+    return index * (this->inputsCount / partitions) + std::min(index, this->inputsCount % partitions);
+  }
+
+  roaring_bitmap_t * reduce(const roaring_bitmap_t ** x, uint32_t n, bool isMerge) {
+    if (n == 0) {
+      return roaring_bitmap_create();
+    }
+    if (n == 1) {
+      return roaring_bitmap_copy(x[0]);
+    }
+    switch (this->operation) {
+      case Operation::OR: return roaring_bitmap_or_many(n, x);
+      case Operation::XOR: return roaring_bitmap_xor_many(n, x);
+      default: break;
+    }
+    if (this->emptyIntersection.load(std::memory_order_relaxed)) {
+      return roaring_bitmap_create();
+    }
+    if (isMerge) {
+      // Inputs are sorted by size before partitioning, partial results are not.
+      std::sort(x, x + n, [](const roaring_bitmap_t * a, const roaring_bitmap_t * b) {
+        return roaring_bitmap_get_cardinality(a) < roaring_bitmap_get_cardinality(b);
+      });
+    }
+    roaring_bitmap_t * r = roaringAndMany(n, x);
+    if (r != nullptr && roaring_bitmap_is_empty(r)) {
+      // The intersection of everything is empty, other partitions can stop early.
+      this->emptyIntersection.store(true, std::memory_order_relaxed);
+    }
+    return r;
+  }
+};
+
+/**
+ * Computes the cardinality of the union or of the intersection of many bitmaps without materializing the result.
+ * The key space (high 16 bits) is split in ranges with about the same number of containers, each range is counted
+ * in a different thread and the partial counts are summed.
+ */
+class ManyCardinalityParallelWorker final : public ParallelAsyncWorker {
+ public:
+  enum class Operation { OR, AND };
+
+  /** Below this number of containers per range, splitting the work is not worth the overhead. */
+  static const constexpr int32_t MIN_PARTITION_CONTAINERS = 64;
+
+  const Operation operation;
+  RoaringBitmap32Pins pins;
+  const roaring_bitmap_t ** inputs;
+  RoaringBitmap32 ** pinned;
+  uint32_t * boundaries;
+  uint32_t inputsCount;
+  uint32_t pinnedCount;
+  std::atomic<uint64_t> cardinality;
+
+  explicit ManyCardinalityParallelWorker(v8::Isolate * isolate, AddonData * addonData, Operation operation) :
+    ParallelAsyncWorker(isolate, addonData),
+    operation(operation),
+    inputs(nullptr),
+    pinned(nullptr),
+    boundaries(nullptr),
+    inputsCount(0),
+    pinnedCount(0),
+    cardinality(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(ManyCardinalityParallelWorker));
+  }
+
+  virtual ~ManyCardinalityParallelWorker() {
+    gcaware_free(this->isolate, this->inputs);
+    gcaware_free(this->isolate, this->pinned);
+    gcaware_free(this->isolate, this->boundaries);
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(ManyCardinalityParallelWorker));
+  }
+
+  /** Allocates the inputs. Returns false if the allocation failed. */
+  bool reserve(uint32_t count) {
+    if (count == 0) {
+      return true;
+    }
+    this->inputs = (const roaring_bitmap_t **)gcaware_malloc(count * sizeof(roaring_bitmap_t *));
+    this->pinned = (RoaringBitmap32 **)gcaware_malloc(count * sizeof(RoaringBitmap32 *));
+    return this->inputs != nullptr && this->pinned != nullptr;
+  }
+
+  /** Adds an input bitmap and freezes it until the operation completes. */
+  void addInput(RoaringBitmap32 * input) {
+    // Readonly views share the roaring bitmap of their owner, the owner is the one that needs to be frozen.
+    RoaringBitmap32 * owner = input->readonlyViewOf ? input->readonlyViewOf : input;
+    owner->beginFreeze();
+    this->pins.pin(this->isolate, input);
+    this->pinned[this->pinnedCount++] = owner;
+    this->inputs[this->inputsCount++] = input->roaring;
+  }
+
+  /**
+   * Splits the key space in ranges, one per thread. An intersection visits only the keys of the smallest bitmap,
+   * that is sorted first, an union visits the keys of all the bitmaps, the ranges follow the keys of the largest one.
+   */
+  bool partition() {
+    if (this->operation == Operation::AND) {
+      roaringSortBySize(this->pinned, this->pinnedCount);
+      for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+        this->inputs[i] = this->pinned[i]->roaring;
+      }
+    }
+
+    const roaring_array_t * reference = nullptr;
+    for (uint32_t i = 0; i != this->inputsCount; ++i) {
+      const roaring_array_t * ra = &this->inputs[i]->high_low_container;
+      if (reference == nullptr || (this->operation == Operation::OR && ra->size > reference->size)) {
+        reference = ra;
+      }
+    }
+
+    uint32_t partitions = reference != nullptr ? (uint32_t)(reference->size / MIN_PARTITION_CONTAINERS) : 0;
+    const uint32_t cpus = getCpusCount();
+    if (partitions > cpus) {
+      partitions = cpus;
+    }
+    if (partitions == 0) {
+      partitions = 1;
+    }
+
+    this->boundaries = (uint32_t *)gcaware_malloc((partitions + 1) * sizeof(uint32_t));
+    if (this->boundaries == nullptr) {
+      return false;
+    }
+    this->boundaries[0] = 0;
+    for (uint32_t i = 1; i != partitions; ++i) {
+      this->boundaries[i] = reference->keys[(uint64_t)reference->size * i / partitions];
+    }
+    this->boundaries[partitions] = 1 << 16;
+    this->loopCount = partitions;
+    this->concurrency = partitions;
+    return true;
+  }
+
+ protected:
+  void parallelWork(uint32_t index) final {
+    uint64_t partial;
+    const bool succeeded = this->operation == Operation::OR
+      ? roaringOrManyCardinality(
+          this->inputs, this->inputsCount, partial, this->boundaries[index], this->boundaries[index + 1])
+      : roaringAndManyCardinality(
+          this->inputs, this->inputsCount, partial, this->boundaries[index], this->boundaries[index + 1]);
+    if (!succeeded) {
+      std::lock_guard<std::mutex> lock(this->_errorMutex);
+      return this->setError(WorkerError("RoaringBitmap32 many cardinality operation failed allocation"));
+    }
+    this->cardinality.fetch_add(partial, std::memory_order_relaxed);
+  }
+
+  void finally() final {
+    for (uint32_t i = 0; i != this->pinnedCount; ++i) {
+      this->pinned[i]->endFreeze();
+    }
+    this->pinnedCount = 0;
+  }
+
+  void done(v8::Local<v8::Value> & result) final {
+    result = v8::Number::New(this->isolate, (double)this->cardinality.load(std::memory_order_acquire));
+  }
+
+ private:
+  std::mutex _errorMutex;
+};
+
+/**
+ * Deserializes a text file (comma, tab or newline separated values, or a JSON array) in parallel.
+ * The file is memory mapped and split in chunks at number boundaries, each chunk is parsed
+ * in a different thread in its own bitmap, and the bitmaps are merged with a multi-way OR.
+ */
+class DeserializeTextFileParallelWorker final : public RoaringBitmap32ParallelReduceWorker {
+ public:
+  /** The minimum size of a partition, files smaller than this are parsed by a single thread. */
+  static const constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+  RoaringBitmapFileDeserializer args;
+  const v8::FunctionCallbackInfo<v8::Value> & info;
+
+  explicit DeserializeTextFileParallelWorker(const v8::FunctionCallbackInfo<v8::Value> & info, AddonData * addonData) :
+    RoaringBitmap32ParallelReduceWorker(info.GetIsolate(), addonData),
+    info(info),
+    _mapped(false),
+    _isMmap(false),
+    _data(nullptr),
+    _size(0) {
+    _gcaware_adjustAllocatedMemory(this->isolate, sizeof(DeserializeTextFileParallelWorker));
+  }
+
+  virtual ~DeserializeTextFileParallelWorker() {
+    this->_unmap();
+    _gcaware_adjustAllocatedMemory(this->isolate, -sizeof(DeserializeTextFileParallelWorker));
+  }
+
+ protected:
+  void before() final {
+    this->setError(this->args.parseArguments(this->info));
+    if (!this->hasError() && !this->allocatePartitions(this->_partitionsCount())) {
+      this->setError(WorkerError("RoaringBitmap32::deserializeFileAsync failed to allocate memory"));
+    }
+  }
+
+  roaring_bitmap_t * reducePartition(uint32_t index) final {
+    roaring_bitmap_t * r = roaring_bitmap_create();
+    if (r == nullptr) {
+      return nullptr;
+    }
+
+    if (!this->_map()) {
+      return r;
+    }
+
+    const uint32_t chunks = this->loopCount;
+    const size_t begin = (size_t)(((uint64_t)this->_size * index) / chunks);
+    const size_t end = (size_t)(((uint64_t)this->_size * (index + 1)) / chunks);
+    WorkerError error = deserializeRoaringCsvChunk(r, this->_data, this->_size, begin, end);
+    if (error.hasError()) {
+      this->setPartitionError(error);
+    }
+    return r;
+  }
+
+  roaring_bitmap_t * mergePartitions(roaring_bitmap_t ** partials, uint32_t count) final {
+    this->_unmap();
+    return roaring_bitmap_or_many(count, (const roaring_bitmap_t **)partials);
+  }
+
+ private:
+  std::mutex _mapMutex;
+  bool _mapped;
+  bool _isMmap;
+  const char * _data;
+  size_t _size;
+
+  /**
+   * One partition per MIN_CHUNK_SIZE bytes of the file, at most one per CPU.
+   * A file that cannot be read gets a single partition, that reports the error when it maps the file.
+   */
+  uint32_t _partitionsCount() const {
+    struct stat st;
+    if (stat(this->args.filePath.c_str(), &st) == -1 || st.st_size <= 0) {
+      return 1;
+    }
+    const uint64_t chunks = (uint64_t)st.st_size / MIN_CHUNK_SIZE + 1;
+    const uint32_t cpus = getCpusCount();
+    return chunks < cpus ? (uint32_t)chunks : cpus;
+  }
+
+  /** Maps the file in memory, once, the first thread to get here does it. Returns false if the file is empty or on error. */
+  bool _map() {
+    std::lock_guard<std::mutex> lock(this->_mapMutex);
+    if (this->_mapped) {
+      return this->_data != nullptr && !this->hasError();
+    }
+    this->_mapped = true;
+
+    const std::string & filePath = this->args.filePath;
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd == -1) {
+      this->setPartitionError(WorkerError::from_errno("open", filePath));
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      this->setPartitionError(WorkerError::from_errno("fstat", filePath));
+      close(fd);
+      return false;
+    }
+
+    const size_t fileSize = (size_t)st.st_size;
+    if (fileSize == 0) {
+      close(fd);
+      return false;
+    }
+
+    void * buf = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (buf != MAP_FAILED) {
+      this->_isMmap = true;
+    } else {
+      // mmap failed, try to read the file into a buffer
+      buf = gcaware_aligned_malloc(32, fileSize);
+      if (buf == nullptr) {
+        this->setPartitionError(WorkerError::from_errno("mmap", filePath));
+        close(fd);
+        return false;
+      }
+      ssize_t bytesRead = read(fd, buf, fileSize);
+      if (bytesRead == -1 || (size_t)bytesRead != fileSize) {
+        this->setPartitionError(
+          bytesRead == -1 ? WorkerError::from_errno("read", filePath)
+                          : WorkerError("RoaringBitmap32::deserializeFileAsync read less bytes than expected"));
+        gcaware_aligned_free(buf);
+        close(fd);
+        return false;
+      }
+    }
+    close(fd);
+
+    this->_data = (const char *)buf;
+    this->_size = fileSize;
+    return true;
+  }
+
+  void _unmap() {
+    const char * data = this->_data;
+    if (data == nullptr) {
+      return;
+    }
+    this->_data = nullptr;
+    if (this->_isMmap) {
+      munmap((void *)data, this->_size);
+    } else {
+      gcaware_aligned_free((void *)data);
+    }
+  }
+};
+
 #endif  // ROARING_NODE_ASYNC_WORKERS_
@@ -18,6 +18,7 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
 #if defined(__APPLE__)
 #  include <malloc/malloc.h>
@@ -1,6 +1,13 @@
 #include "aligned-buffers.h"
 #include "RoaringBitmap32-main.h"
 #include "RoaringBitmap32BufferedIterator.h"
+#include "RoaringBitmap32BulkWriter.h"
+#include "RoaringBitmap32Accumulator.h"
+#include "RoaringBitmap32Pack.h"
+#include "RoaringBitmapIndex.h"
+#include "RoaringBitmapSliced32.h"
+#include "RoaringBitmap64-main.h"
+#include "RoaringBitmap64BufferedIterator.h"
 
 using namespace v8;
 
@@ -29,6 +36,13 @@ void InitRoaringNode(Local<Object> exports) {
   AlignedBuffers_Init(exports, addonData);
   RoaringBitmap32_Init(exports, addonData);
   RoaringBitmap32BufferedIterator_Init(exports, addonData);
+  RoaringBitmap32BulkWriter_Init(exports, addonData);
+  RoaringBitmap32Accumulator_Init(exports, addonData);
+  RoaringBitmap32Pack_Init(exports, addonData);
+  RoaringBitmapIndex_Init(exports, addonData);
+  RoaringBitmapSliced32_Init(exports, addonData);
+  RoaringBitmap64_Init(exports, addonData);
+  RoaringBitmap64BufferedIterator_Init(exports, addonData);
 
   addonData->setMethod(exports, "getRoaringUsedMemory", getRoaringUsedMemory);
 
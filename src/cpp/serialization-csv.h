@@ -20,12 +20,16 @@ struct CsvFileDescriptorSerializer final {
     }
 
     CsvFileDescriptorSerializer writer(fd, separator);
+    if (!writer.buf) {
+      return ENOMEM;
+    }
+
     if (format == FileSerializationFormat::json_array) {
       writer.appendChar('[');
     }
 
-    if (r) {
-      roaring_iterate(r, roaringIteratorFn, &writer);
+    if (r && !writer.appendBitmap(r)) {
+      return writer.error();
     }
 
     if (format == FileSerializationFormat::newline_separated_values) {
@@ -35,40 +39,97 @@ struct CsvFileDescriptorSerializer final {
     }
 
     if (!writer.flush()) {
-      int errorno = errno;
-      errno = 0;
-      return errorno ? errorno : EIO;
+      return writer.error();
     }
 
     return 0;
   }
 
+  /** Number of decimal digits of a 32 bit unsigned integer. */
+  static inline uint32_t digitsCount(uint32_t value) {
+    if (value < 100000) {
+      return value < 100 ? (value < 10 ? 1 : 2) : (value < 1000 ? 3 : value < 10000 ? 4 : 5);
+    }
+    return value < 10000000 ? (value < 1000000 ? 6 : 7) : (value < 100000000 ? 8 : value < 1000000000 ? 9 : 10);
+  }
+
+  /**
+   * Writes the decimal representation of a 32 bit unsigned integer, two digits at a time from a lookup table.
+   * Returns the number of characters written, at most 10.
+   */
+  static inline uint32_t formatUint32(char * out, uint32_t value) {
+    static const char digitPairs[201] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+
+    const uint32_t length = digitsCount(value);
+    char * p = out + length;
+    while (value >= 100) {
+      const uint32_t pair = (value % 100) * 2;
+      value /= 100;
+      p -= 2;
+      p[0] = digitPairs[pair];
+      p[1] = digitPairs[pair + 1];
+    }
+    if (value >= 10) {
+      p -= 2;
+      p[0] = digitPairs[value * 2];
+      p[1] = digitPairs[value * 2 + 1];
+    } else {
+      *--p = (char)('0' + value);
+    }
+    return length;
+  }
+
  private:
-  const constexpr static size_t BUFFER_SIZE = 131072;
+  const constexpr static size_t BUFFER_SIZE = 1048576;
+
+  /** Number of values read from the bitmap at a time. */
+  const constexpr static uint32_t BLOCK_SIZE = 2048;
+
+  /** Maximum number of bytes a value takes, separator included. */
+  const constexpr static size_t MAX_VALUE_LENGTH = 11;
 
   char * buf;
   size_t bufPos;
   int fd;
+  int errorno;
   bool needsSeparator;
   char separator;
 
   CsvFileDescriptorSerializer(int fd, char separator) :
-    buf((char *)gcaware_aligned_malloc(32, BUFFER_SIZE)), bufPos(0), fd(fd), needsSeparator(false), separator(separator) {}
+    buf((char *)gcaware_aligned_malloc(32, BUFFER_SIZE)),
+    bufPos(0),
+    fd(fd),
+    errorno(0),
+    needsSeparator(false),
+    separator(separator) {}
 
   ~CsvFileDescriptorSerializer() { gcaware_aligned_free(this->buf); }
 
+  int error() const { return this->errorno ? this->errorno : EIO; }
+
   bool flush() {
-    if (this->bufPos == 0) {
-      return true;
-    }
     if (!this->buf) {
       return false;
     }
-    ssize_t written = write(this->fd, this->buf, this->bufPos);
-    if (written < 0) {
-      gcaware_aligned_free(this->buf);
-      this->buf = nullptr;
-      return false;
+    const char * p = this->buf;
+    size_t remaining = this->bufPos;
+    while (remaining != 0) {
+      ssize_t written = write(this->fd, p, remaining);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        this->errorno = errno;
+        errno = 0;
+        gcaware_aligned_free(this->buf);
+        this->buf = nullptr;
+        return false;
+      }
+      p += written;
+      remaining -= (size_t)written;
     }
     this->bufPos = 0;
     return true;
@@ -87,46 +148,73 @@ struct CsvFileDescriptorSerializer final {
     return true;
   }
 
-  bool appendValue(uint32_t value) {
-    if (this->bufPos + 15 >= BUFFER_SIZE) {
-      if (!this->flush()) {
-        return false;
+  /**
+   * Appends all the values of the bitmap, reading them in blocks.
+   * Consecutive values, common in run containers, are formatted incrementing the previous decimal string
+   * instead of converting every value from scratch.
+   */
+  bool appendBitmap(const roaring::api::roaring_bitmap_t * r) {
+    uint32_t values[BLOCK_SIZE];
+    char last[MAX_VALUE_LENGTH];
+    uint32_t lastLength = 0;
+    uint32_t lastValue = 0;
+
+    roaring_uint32_iterator_t it;
+    roaring_iterator_init(r, &it);
+    for (;;) {
+      const uint32_t count = roaring_uint32_iterator_read(&it, values, BLOCK_SIZE);
+      if (count == 0) {
+        break;
       }
-    }
-    if (!this->buf) {
-      return false;
-    }
-    if (this->needsSeparator) {
-      this->buf[this->bufPos++] = this->separator;
-    }
-    this->needsSeparator = true;
 
-    char * str = this->buf + this->bufPos;
-    int32_t i, j;
-    char c;
+      if (this->bufPos + count * MAX_VALUE_LENGTH >= BUFFER_SIZE && !this->flush()) {
+        return false;
+      }
 
-    /* uint to decimal  */
-    i = 0;
-    do {
-      uint32_t remainder = value % 10;
-      str[i++] = (char)(remainder + 48);
-      value = value / 10;
-    } while (value != 0);
+      char * out = this->buf + this->bufPos;
+      uint32_t i = 0;
+      if (!this->needsSeparator) {
+        this->needsSeparator = true;
+        lastValue = values[0];
+        lastLength = formatUint32(last, lastValue);
+        memcpy(out, last, lastLength);
+        out += lastLength;
+        i = 1;
+      }
 
-    this->bufPos += i;
+      const char separator = this->separator;
+      for (; i < count; ++i) {
+        const uint32_t value = values[i];
+        *out++ = separator;
+        if (value == lastValue + 1 && lastLength != 0) {
+          lastLength = incrementDecimal(last, lastLength);
+        } else {
+          lastLength = formatUint32(last, value);
+        }
+        lastValue = value;
+        memcpy(out, last, lastLength);
+        out += lastLength;
+      }
 
-    /* reverse string */
-    for (j = 0, i--; j < i; j++, i--) {
-      c = str[i];
-      str[i] = str[j];
-      str[j] = c;
+      this->bufPos = (size_t)(out - this->buf);
     }
-
     return true;
   }
 
-  static bool roaringIteratorFn(uint32_t value, void * param) {
-    return ((CsvFileDescriptorSerializer *)param)->appendValue(value);
+  /** Adds one to a decimal string in place, returns the new length. */
+  static inline uint32_t incrementDecimal(char * str, uint32_t length) {
+    uint32_t i = length;
+    while (i != 0) {
+      if (str[--i] != '9') {
+        ++str[i];
+        return length;
+      }
+      str[i] = '0';
+    }
+    // All nines, 999 + 1 = 1000
+    str[0] = '1';
+    str[length] = '0';
+    return length + 1;
   }
 };
 
@@ -205,4 +293,31 @@ WorkerError deserializeRoaringCsvFile(
   return WorkerError();
 }
 
+/**
+ * Parses the chunk [begin, end) of a text buffer, so a big text file can be split and parsed in parallel.
+ * A number belongs to the chunk that contains its first digit: the digits of a number that started in the
+ * previous chunk are skipped, and a number that continues past the end of the chunk is parsed entirely.
+ */
+WorkerError deserializeRoaringCsvChunk(
+  roaring::api::roaring_bitmap_t * r, const char * input, size_t inputSize, size_t begin, size_t end) {
+  if (end > inputSize) {
+    end = inputSize;
+  }
+  if (begin > 0 && input[begin - 1] >= '0' && input[begin - 1] <= '9') {
+    while (begin < end && input[begin] >= '0' && input[begin] <= '9') {
+      ++begin;
+    }
+  }
+  if (begin >= end) {
+    return WorkerError();
+  }
+  if (begin > 0 && input[begin - 1] == '-') {
+    --begin;  // Keep the sign of the first number
+  }
+  while (end < inputSize && input[end] >= '0' && input[end] <= '9') {
+    ++end;
+  }
+  return deserializeRoaringCsvFile(r, -1, input + begin, end - begin, "");
+}
+
 #endif
@@ -0,0 +1,276 @@
+#ifndef ROARING_NODE_SERIALIZATION_PACK_
+#define ROARING_NODE_SERIALIZATION_PACK_
+
+#include "RoaringBitmap32.h"
+#include "mmap.h"
+
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#  include <io.h>
+#endif
+
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
+
+/*
+ * Bitmap pack file layout, little endian:
+ *
+ *   RoaringBitmapPackHeader   32 bytes, magic "RBPK", version, body format and number of bitmaps
+ *   RoaringBitmapPackEntry[]  offset and length of each serialized bitmap, from the start of the file
+ *   bodies                    each bitmap serialized in the body format, every body starts at a 32 bytes boundary
+ *
+ * The offset table allows to read or to create a frozen view of a single bitmap without reading the whole file.
+ */
+
+static const constexpr char ROARING_PACK_MAGIC[4] = {'R', 'B', 'P', 'K'};
+static const constexpr uint32_t ROARING_PACK_VERSION = 1;
+static const constexpr size_t ROARING_PACK_ALIGNMENT = 32;
+
+enum class RoaringBitmapPackFormat : uint32_t {
+  INVALID = 0,
+  portable = 1,
+  unsafe_frozen_croaring = 2,
+};
+
+struct RoaringBitmapPackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t format;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t reserved2;
+};
+
+struct RoaringBitmapPackEntry {
+  uint64_t offset;
+  uint64_t length;
+};
+
+static_assert(sizeof(RoaringBitmapPackHeader) == 32, "RoaringBitmapPackHeader must be 32 bytes");
+static_assert(sizeof(RoaringBitmapPackEntry) == 16, "RoaringBitmapPackEntry must be 16 bytes");
+
+inline RoaringBitmapPackFormat tryParseRoaringBitmapPackFormat(const v8::Local<v8::Value> & value, v8::Isolate * isolate) {
+  switch (tryParseFileSerializationFormat(value, isolate)) {
+    case FileSerializationFormat::portable: return RoaringBitmapPackFormat::portable;
+    case FileSerializationFormat::unsafe_frozen_croaring: return RoaringBitmapPackFormat::unsafe_frozen_croaring;
+    default: return RoaringBitmapPackFormat::INVALID;
+  }
+}
+
+inline uint64_t roaringPackAlign(uint64_t offset) {
+  return (offset + (ROARING_PACK_ALIGNMENT - 1)) & ~(uint64_t)(ROARING_PACK_ALIGNMENT - 1);
+}
+
+/** Writes many bitmaps in a single pack file. */
+class RoaringBitmapPackFileSerializer final {
+ public:
+  std::string filePath;
+  RoaringBitmapPackFormat format = RoaringBitmapPackFormat::INVALID;
+  RoaringBitmap32 ** bitmaps = nullptr;
+  uint32_t count = 0;
+  v8::Isolate * isolate = nullptr;
+
+  RoaringBitmapPackFileSerializer() = default;
+  RoaringBitmapPackFileSerializer(const RoaringBitmapPackFileSerializer &) = delete;
+  RoaringBitmapPackFileSerializer & operator=(const RoaringBitmapPackFileSerializer &) = delete;
+
+  ~RoaringBitmapPackFileSerializer() {
+    if (this->bitmaps != nullptr) {
+      gcaware_free(this->isolate, this->bitmaps);
+    }
+  }
+
+  /** Parses (filePath, bitmaps, format). */
+  WorkerError parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info) {
+    v8::Isolate * isolate = info.GetIsolate();
+    this->isolate = isolate;
+    v8::HandleScope scope(isolate);
+
+    if (info.Length() < 3) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects a file path, an array of bitmaps and a format");
+    }
+    if (!info[0]->IsString()) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects a file path as the first argument");
+    }
+    if (!info[1]->IsArray()) {
+      return WorkerError("RoaringBitmap32::serializePackFile expects an array of RoaringBitmap32 as the second argument");
+    }
+    this->format = tryParseRoaringBitmapPackFormat(info[2], isolate);
+    if (this->format == RoaringBitmapPackFormat::INVALID) {
+      return WorkerError(
+        "RoaringBitmap32::serializePackFile format argument was invalid, only portable and unsafe_frozen_croaring are supported");
+    }
+
+    v8::String::Utf8Value filePathUtf8(isolate, info[0]);
+    this->filePath = std::string(*filePathUtf8, filePathUtf8.length());
+
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[1]);
+    const uint32_t length = array->Length();
+    if (length != 0) {
+      this->bitmaps = (RoaringBitmap32 **)gcaware_malloc(length * sizeof(RoaringBitmap32 *));
+      if (this->bitmaps == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile failed to allocate memory");
+      }
+    }
+    for (uint32_t i = 0; i != length; ++i) {
+      v8::Local<v8::Value> item;
+      RoaringBitmap32 * bitmap =
+        array->Get(context, i).ToLocal(&item) ? ObjectWrap::TryUnwrap<RoaringBitmap32>(item, isolate) : nullptr;
+      if (bitmap == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile array can contain only RoaringBitmap32 instances");
+      }
+      this->bitmaps[this->count++] = bitmap;
+    }
+    return WorkerError();
+  }
+
+  /** Freezes the bitmaps, so they cannot be modified while written in another thread. */
+  void beginFreeze() {
+    for (uint32_t i = 0; i != this->count; ++i) {
+      this->owner(i)->beginFreeze();
+    }
+  }
+
+  void endFreeze() {
+    for (uint32_t i = 0; i != this->count; ++i) {
+      this->owner(i)->endFreeze();
+    }
+  }
+
+  WorkerError serialize() {
+    const uint64_t tableEnd = sizeof(RoaringBitmapPackHeader) + (uint64_t)this->count * sizeof(RoaringBitmapPackEntry);
+    RoaringBitmapPackEntry * entries = nullptr;
+    if (this->count != 0) {
+      entries = (RoaringBitmapPackEntry *)gcaware_malloc(this->count * sizeof(RoaringBitmapPackEntry));
+      if (entries == nullptr) {
+        return WorkerError("RoaringBitmap32::serializePackFile failed to allocate memory");
+      }
+    }
+
+    uint64_t fileSize = tableEnd;
+    for (uint32_t i = 0; i != this->count; ++i) {
+      const roaring_bitmap_t * r = this->bitmaps[i]->roaring;
+      const uint64_t offset = roaringPackAlign(fileSize);
+      const uint64_t length = this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring
+        ? roaring_bitmap_frozen_size_in_bytes(r)
+        : roaring_bitmap_portable_size_in_bytes(r);
+      entries[i].offset = offset;
+      entries[i].length = length;
+      fileSize = offset + length;
+    }
+
+    WorkerError err = this->writeFile(entries, (size_t)fileSize);
+    gcaware_free(this->isolate, entries);
+    return err;
+  }
+
+ private:
+  RoaringBitmap32 * owner(uint32_t index) const {
+    RoaringBitmap32 * bitmap = this->bitmaps[index];
+    return bitmap->readonlyViewOf ? bitmap->readonlyViewOf : bitmap;
+  }
+
+  /** Writes the pack, data must be large enough for the last entry: the entries were computed from the bitmaps sizes. */
+  void serializeToBuffer(uint8_t * data, const RoaringBitmapPackEntry * entries) const {
+    RoaringBitmapPackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROARING_PACK_MAGIC, sizeof(header.magic));
+    header.version = ROARING_PACK_VERSION;
+    header.format = (uint32_t)this->format;
+    header.count = this->count;
+    memcpy(data, &header, sizeof(header));
+    if (this->count != 0) {
+      memcpy(data + sizeof(header), entries, this->count * sizeof(RoaringBitmapPackEntry));
+    }
+
+    size_t written = sizeof(header) + this->count * sizeof(RoaringBitmapPackEntry);
+    for (uint32_t i = 0; i != this->count; ++i) {
+      // Zero the alignment padding, the file may have been mapped over old content.
+      memset(data + written, 0, (size_t)entries[i].offset - written);
+      char * body = (char *)data + entries[i].offset;
+      if (this->format == RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+        roaring_bitmap_frozen_serialize(this->bitmaps[i]->roaring, body);
+      } else {
+        roaring_bitmap_portable_serialize(this->bitmaps[i]->roaring, body);
+      }
+      written = (size_t)(entries[i].offset + entries[i].length);
+    }
+  }
+
+  WorkerError writeFile(const RoaringBitmapPackEntry * entries, size_t fileSize) {
+    int fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+    if (fd < 0) {
+      return WorkerError::from_errno("open", this->filePath);
+    }
+
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    int truncateErr = _chsize_s(fd, fileSize);
+    if (truncateErr != 0) {
+      close(fd);
+      return WorkerError(truncateErr, "_chsize_s", this->filePath);
+    }
+#else
+    if (ftruncate(fd, fileSize) < 0) {
+      WorkerError err = WorkerError::from_errno("ftruncate", this->filePath);
+      close(fd);
+      return err;
+    }
+#endif
+
+    uint8_t * data = (uint8_t *)mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      this->serializeToBuffer(data, entries);
+      munmap(data, fileSize);
+      close(fd);
+      return WorkerError();
+    }
+
+    // mmap failed, serialize to a buffer and write it instead
+    data = (uint8_t *)gcaware_aligned_malloc(32, fileSize);
+    if (data == nullptr) {
+      WorkerError err = WorkerError::from_errno("mmap", this->filePath);
+      close(fd);
+      return err;
+    }
+    this->serializeToBuffer(data, entries);
+    WorkerError err;
+    for (size_t pos = 0; pos < fileSize;) {
+      ssize_t written = write(fd, data + pos, fileSize - pos);
+      if (written < 0) {
+        err = WorkerError::from_errno("write", this->filePath);
+        break;
+      }
+      pos += (size_t)written;
+    }
+    gcaware_aligned_free(data);
+    close(fd);
+    return err;
+  }
+};
+
+/** Validates the header and the offset table of a pack. Returns the entries, or nullptr if the data is not a valid pack. */
+inline const RoaringBitmapPackEntry * roaringPackValidate(
+  const uint8_t * data, size_t size, RoaringBitmapPackFormat & format, uint32_t & count) {
+  if (size < sizeof(RoaringBitmapPackHeader)) {
+    return nullptr;
+  }
+  RoaringBitmapPackHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, ROARING_PACK_MAGIC, sizeof(header.magic)) != 0 || header.version != ROARING_PACK_VERSION) {
+    return nullptr;
+  }
+  if (
+    header.format != (uint32_t)RoaringBitmapPackFormat::portable &&
+    header.format != (uint32_t)RoaringBitmapPackFormat::unsafe_frozen_croaring) {
+    return nullptr;
+  }
+  if (header.count > UINT32_MAX || header.count > (size - sizeof(header)) / sizeof(RoaringBitmapPackEntry)) {
+    return nullptr;
+  }
+  format = (RoaringBitmapPackFormat)header.format;
+  count = (uint32_t)header.count;
+  return (const RoaringBitmapPackEntry *)(data + sizeof(header));
+}
+
+#endif  // ROARING_NODE_SERIALIZATION_PACK_
@@ -0,0 +1,242 @@
+#ifndef ROARING_NODE_SERIALIZATION_PARALLEL_
+#define ROARING_NODE_SERIALIZATION_PARALLEL_
+
+#include "RoaringBitmap32.h"
+
+/** A range of containers serialized by one thread, with the offsets where its payloads start in the output. */
+struct RoaringBitmapSerializationPart {
+  int32_t container;
+  /** Portable format: offset of the first container. Frozen format: offset in the bitset zone. */
+  size_t offset;
+  /** Frozen format only: offsets in the run and in the array zones. */
+  size_t runOffset;
+  size_t arrayOffset;
+};
+
+/**
+ * Splits the serialization of a single bitmap in the portable or frozen format in parts that can be written concurrently.
+ * The layout is computed up front from the container sizes, so every part knows where to write its containers,
+ * and the output is byte identical to roaring_bitmap_portable_serialize and roaring_bitmap_frozen_serialize.
+ * The part 0 writes also the header.
+ */
+class RoaringBitmapParallelSerialization final {
+ public:
+  /** Outputs smaller than this are serialized by a single thread. */
+  static const constexpr size_t PART_MIN_BYTES = 1 << 20;
+
+  RoaringBitmapSerializationPart * parts = nullptr;
+  uint32_t count = 0;
+
+  RoaringBitmapParallelSerialization() = default;
+  RoaringBitmapParallelSerialization(const RoaringBitmapParallelSerialization &) = delete;
+  RoaringBitmapParallelSerialization & operator=(const RoaringBitmapParallelSerialization &) = delete;
+
+  ~RoaringBitmapParallelSerialization() { gcaware_free(this->parts); }
+
+  /**
+   * Computes the parts for a portable (frozen is false) or a frozen serialization of totalSize bytes, starting at headerOffset,
+   * to be written by the given number of threads. Returns the number of parts, 0 on allocation failure.
+   * If 1 is returned the bitmap is too small to be worth splitting.
+   */
+  uint32_t compute(const roaring_bitmap_t * r, bool frozen, size_t headerOffset, size_t totalSize, uint32_t threads) {
+    gcaware_free(this->parts);
+    this->parts = nullptr;
+    this->count = 1;
+    this->frozen = frozen;
+    this->headerOffset = headerOffset;
+
+    const roaring_array_t * ra = &r->high_low_container;
+    if (totalSize < 2 * PART_MIN_BYTES || ra->size < 2) {
+      return 1;
+    }
+
+    // A few parts per thread balance the load when containers have different sizes.
+    const size_t partBytes = std::max(PART_MIN_BYTES, totalSize / ((size_t)std::max(threads, 1U) * 4));
+    const size_t maxParts = totalSize / partBytes + 1;
+    this->parts = (RoaringBitmapSerializationPart *)gcaware_malloc((maxParts + 1) * sizeof(RoaringBitmapSerializationPart));
+    if (this->parts == nullptr) {
+      return 0;
+    }
+
+    size_t bitsetOffset = headerOffset, runOffset = 0, arrayOffset = 0;
+    if (frozen) {
+      size_t bitsetZone = 0, runZone = 0;
+      for (int32_t i = 0; i < ra->size; ++i) {
+        uint8_t typecode = ra->typecodes[i];
+        const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+        if (typecode == BITSET_CONTAINER_TYPE) {
+          bitsetZone += roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+        } else if (typecode == RUN_CONTAINER_TYPE) {
+          runZone += ((const roaring::internal::run_container_t *)c)->n_runs * sizeof(roaring::internal::rle16_t);
+        }
+      }
+      runOffset = headerOffset + bitsetZone;
+      arrayOffset = runOffset + runZone;
+    } else {
+      bitsetOffset += roaring::internal::ra_portable_header_size(ra);
+    }
+
+    uint32_t n = 0;
+    size_t written = 0, partStart = 0;
+    this->parts[0] = {0, bitsetOffset, runOffset, arrayOffset};
+    for (int32_t i = 0; i < ra->size; ++i) {
+      if (written - partStart >= partBytes && n + 1 < maxParts) {
+        this->parts[++n] = {i, bitsetOffset, runOffset, arrayOffset};
+        partStart = written;
+      }
+      const size_t bytes = this->containerBytes(ra->containers[i], ra->typecodes[i]);
+      if (!frozen) {
+        bitsetOffset += bytes;
+      } else {
+        uint8_t typecode = ra->typecodes[i];
+        roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+        (typecode == BITSET_CONTAINER_TYPE ? bitsetOffset : typecode == RUN_CONTAINER_TYPE ? runOffset : arrayOffset) +=
+          bytes;
+      }
+      written += bytes;
+    }
+    this->parts[++n] = {ra->size, bitsetOffset, runOffset, arrayOffset};
+    this->count = n;
+    return n;
+  }
+
+  /** Writes the containers of the given part, and the header if index is 0. Parts can be written concurrently. */
+  void serializePart(const roaring_bitmap_t * r, uint8_t * data, uint32_t index) const {
+    const roaring_array_t * ra = &r->high_low_container;
+    const RoaringBitmapSerializationPart & part = this->parts[index];
+    const int32_t end = this->parts[index + 1].container;
+
+    if (!this->frozen) {
+      if (index == 0) {
+        this->writePortableHeader(ra, (char *)data + this->headerOffset);
+      }
+      char * out = (char *)data + part.offset;
+      for (int32_t i = part.container; i < end; ++i) {
+        out += roaring::internal::container_write(ra->containers[i], ra->typecodes[i], out);
+      }
+      return;
+    }
+
+    if (index == 0) {
+      this->writeFrozenHeader(ra, data + this->parts[this->count].arrayOffset);
+    }
+    uint8_t * bitsetZone = data + part.offset;
+    uint8_t * runZone = data + part.runOffset;
+    uint8_t * arrayZone = data + part.arrayOffset;
+    for (int32_t i = part.container; i < end; ++i) {
+      uint8_t typecode = ra->typecodes[i];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+      switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+          const size_t bytes = roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+          memcpy(bitsetZone, ((const roaring::internal::bitset_container_t *)c)->words, bytes);
+          bitsetZone += bytes;
+          break;
+        }
+        case RUN_CONTAINER_TYPE: {
+          const auto * rc = (const roaring::internal::run_container_t *)c;
+          const size_t bytes = rc->n_runs * sizeof(roaring::internal::rle16_t);
+          memcpy(runZone, rc->runs, bytes);
+          runZone += bytes;
+          break;
+        }
+        default: {
+          const auto * ac = (const roaring::internal::array_container_t *)c;
+          const size_t bytes = ac->cardinality * sizeof(uint16_t);
+          memcpy(arrayZone, ac->array, bytes);
+          arrayZone += bytes;
+          break;
+        }
+      }
+    }
+  }
+
+ private:
+  bool frozen = false;
+  size_t headerOffset = 0;
+
+  size_t containerBytes(const roaring::internal::container_t * c, uint8_t typecode) const {
+    if (!this->frozen) {
+      return roaring::internal::container_size_in_bytes(c, typecode);
+    }
+    c = roaring::internal::container_unwrap_shared(c, &typecode);
+    switch (typecode) {
+      case BITSET_CONTAINER_TYPE: return roaring::internal::BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+      case RUN_CONTAINER_TYPE:
+        return ((const roaring::internal::run_container_t *)c)->n_runs * sizeof(roaring::internal::rle16_t);
+      default: return ((const roaring::internal::array_container_t *)c)->cardinality * sizeof(uint16_t);
+    }
+  }
+
+  /** The header written by ra_portable_serialize: cookie, run containers bitset, keys and cardinalities, offsets. */
+  static void writePortableHeader(const roaring_array_t * ra, char * buf) {
+    uint32_t startOffset;
+    const bool hasrun = roaring::internal::ra_has_run_container(ra);
+    if (hasrun) {
+      const uint32_t cookie = roaring::internal::SERIAL_COOKIE | ((uint32_t)(ra->size - 1) << 16);
+      memcpy(buf, &cookie, sizeof(cookie));
+      buf += sizeof(cookie);
+      const uint32_t s = (ra->size + 7) / 8;
+      memset(buf, 0, s);
+      for (int32_t i = 0; i < ra->size; ++i) {
+        if (roaring::internal::get_container_type(ra->containers[i], ra->typecodes[i]) == RUN_CONTAINER_TYPE) {
+          buf[i / 8] |= 1 << (i % 8);
+        }
+      }
+      buf += s;
+      startOffset = ra->size < roaring::internal::NO_OFFSET_THRESHOLD ? 4 + 4 * ra->size + s : 4 + 8 * ra->size + s;
+    } else {
+      const uint32_t cookie = roaring::internal::SERIAL_COOKIE_NO_RUNCONTAINER;
+      memcpy(buf, &cookie, sizeof(cookie));
+      buf += sizeof(cookie);
+      memcpy(buf, &ra->size, sizeof(ra->size));
+      buf += sizeof(ra->size);
+      startOffset = 4 + 4 + 4 * ra->size + 4 * ra->size;
+    }
+    for (int32_t k = 0; k < ra->size; ++k) {
+      memcpy(buf, &ra->keys[k], sizeof(ra->keys[k]));
+      buf += sizeof(ra->keys[k]);
+      const uint16_t card = (uint16_t)(roaring::internal::container_get_cardinality(ra->containers[k], ra->typecodes[k]) - 1);
+      memcpy(buf, &card, sizeof(card));
+      buf += sizeof(card);
+    }
+    if (!hasrun || ra->size >= roaring::internal::NO_OFFSET_THRESHOLD) {
+      for (int32_t k = 0; k < ra->size; ++k) {
+        memcpy(buf, &startOffset, sizeof(startOffset));
+        buf += sizeof(startOffset);
+        startOffset += roaring::internal::container_size_in_bytes(ra->containers[k], ra->typecodes[k]);
+      }
+    }
+  }
+
+  /** The tail written by roaring_bitmap_frozen_serialize after the array zone: keys, counts, typecodes and header. */
+  static void writeFrozenHeader(const roaring_array_t * ra, uint8_t * buf) {
+    uint8_t * keyZone = buf;
+    uint8_t * countZone = keyZone + 2 * ra->size;
+    uint8_t * typecodeZone = countZone + 2 * ra->size;
+    uint8_t * headerZone = typecodeZone + ra->size;
+    for (int32_t i = 0; i < ra->size; ++i) {
+      uint8_t typecode = ra->typecodes[i];
+      const roaring::internal::container_t * c = roaring::internal::container_unwrap_shared(ra->containers[i], &typecode);
+      uint16_t count;
+      switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+          const auto * bc = (const roaring::internal::bitset_container_t *)c;
+          count = (uint16_t)((bc->cardinality != roaring::internal::BITSET_UNKNOWN_CARDINALITY ? bc->cardinality
+                                                                           : roaring::internal::bitset_container_compute_cardinality(bc)) -
+                             1);
+          break;
+        }
+        case RUN_CONTAINER_TYPE: count = (uint16_t)((const roaring::internal::run_container_t *)c)->n_runs; break;
+        default: count = (uint16_t)(((const roaring::internal::array_container_t *)c)->cardinality - 1); break;
+      }
+      memcpy(countZone + 2 * i, &count, 2);
+      typecodeZone[i] = typecode;
+    }
+    memcpy(keyZone, ra->keys, ra->size * sizeof(uint16_t));
+    const uint32_t header = ((uint32_t)ra->size << 15) | roaring::internal::FROZEN_COOKIE;
+    memcpy(headerZone, &header, 4);
+  }
+};
+
+#endif  // ROARING_NODE_SERIALIZATION_PARALLEL_
@@ -3,6 +3,8 @@
 
 #include "RoaringBitmap32.h"
 #include "serialization-csv.h"
+#include "serialization-pack.h"
+#include "serialization-parallel.h"
 #include "mmap.h"
 
 #if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
@@ -25,6 +27,7 @@ class RoaringBitmapSerializerBase {
  private:
   bool serializeArray = false;
   size_t cardinality = 0;
+  RoaringBitmapParallelSerialization parallel;
 
  public:
   RoaringBitmap32 * self = nullptr;
@@ -70,6 +73,32 @@ class RoaringBitmapSerializerBase {
     return WorkerError();
   }
 
+  /**
+   * Splits the serialization in parts that can be written concurrently by serializePart, for the formats that support it.
+   * computeSerializedSize must be called before. Returns the number of parts, 1 if the serialization cannot be split.
+   */
+  uint32_t computeParts(uint32_t threads) {
+    const roaring_bitmap_t * r = this->self->roaring;
+    switch (this->format) {
+      case FileSerializationFormat::croaring:
+        return this->serializeArray ? 1 : this->parallel.compute(r, false, 1, this->serializedSize, threads);
+      case FileSerializationFormat::portable: return this->parallel.compute(r, false, 0, this->serializedSize, threads);
+      case FileSerializationFormat::unsafe_frozen_croaring:
+        return this->parallel.compute(r, true, 0, this->serializedSize, threads);
+      default: return 1;
+    }
+  }
+
+  inline uint32_t partsCount() const { return this->parallel.count; }
+
+  /** Writes one of the parts computed by computeParts. Different parts can be written concurrently. */
+  void serializePart(uint8_t * data, uint32_t index) {
+    if (index == 0 && this->format == FileSerializationFormat::croaring) {
+      data[0] = CROARING_SERIALIZATION_CONTAINER;
+    }
+    this->parallel.serializePart(this->self->roaring, data, index);
+  }
+
   WorkerError serializeToBuffer(uint8_t * data) {
     if (!data) {
       return WorkerError("RoaringBitmap32 serialization allocation failed");
@@ -113,6 +142,7 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
  public:
   v8utils::TypedArrayContent<uint8_t> inputBuffer;
   uint8_t * volatile allocatedBuffer = nullptr;
+  uint8_t * outputBuffer = nullptr;
 
   void parseArguments(const v8::FunctionCallbackInfo<v8::Value> & info) {
     v8::Isolate * isolate = info.GetIsolate();
@@ -153,12 +183,8 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
     this->self = bitmap;
   }
 
-  WorkerError serialize() {
-    WorkerError err = this->computeSerializedSize();
-    if (err.hasError()) {
-      return err;
-    }
-
+  /** Allocates the output buffer, or checks the size of the given one. computeSerializedSize must be called before. */
+  WorkerError prepareBuffer() {
     uint8_t * data = this->inputBuffer.data;
 
     if (data == nullptr) {
@@ -169,7 +195,22 @@ class RoaringBitmapSerializer final : public RoaringBitmapSerializerBase {
       return WorkerError("RoaringBitmap32 serialization buffer is too small");
     }
 
-    return this->serializeToBuffer(data);
+    this->outputBuffer = data;
+    return data ? WorkerError() : WorkerError("RoaringBitmap32 serialization allocation failed");
+  }
+
+  WorkerError serialize() {
+    WorkerError err = this->computeSerializedSize();
+    if (err.hasError()) {
+      return err;
+    }
+
+    err = this->prepareBuffer();
+    if (err.hasError()) {
+      return err;
+    }
+
+    return this->serializeToBuffer(this->outputBuffer);
   }
 
   void done(v8::Isolate * isolate, v8::Local<v8::Value> & result) {
@@ -250,62 +291,81 @@ class RoaringBitmapFileSerializer final : public RoaringBitmapSerializerBase {
       return err;
     }
 
-    int fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
-    if (fd < 0) {
+    uint8_t * data = nullptr;
+    err = this->openOutput(data);
+    if (!err.hasError() && data != nullptr) {
+      err = this->serializeToBuffer(data);
+    }
+    WorkerError closeErr = this->closeOutput(data, !err.hasError());
+    return err.hasError() ? err : closeErr;
+  }
+
+  /**
+   * Creates the file with the size computed by computeSerializedSize and maps it in memory.
+   * If the file cannot be mapped, data is a buffer written to the file by closeOutput. data is nullptr for an empty file.
+   */
+  WorkerError openOutput(uint8_t *& data) {
+    data = nullptr;
+    this->fd = open(this->filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+    if (this->fd < 0) {
       return WorkerError::from_errno("open", this->filePath);
     }
 
 #if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
-    int truncateErr = _chsize_s(fd, this->serializedSize);
+    int truncateErr = _chsize_s(this->fd, this->serializedSize);
     if (truncateErr != 0) {
-      err = WorkerError(truncateErr, "_chsize_s", this->filePath);
-      close(fd);
-      return err;
+      return WorkerError(truncateErr, "_chsize_s", this->filePath);
     }
 #else
-    if (ftruncate(fd, this->serializedSize) < 0) {
-      err = WorkerError::from_errno("ftruncate", this->filePath);
-      close(fd);
-      return err;
+    if (ftruncate(this->fd, this->serializedSize) < 0) {
+      return WorkerError::from_errno("ftruncate", this->filePath);
     }
 #endif
 
-    if (this->serializedSize != 0) {
-      uint8_t * data = (uint8_t *)mmap(nullptr, this->serializedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-      if (data == MAP_FAILED) {
-        // mmap failed, allocate and write to buffer instead
-        data = (uint8_t *)gcaware_aligned_malloc(32, this->serializedSize);
-        if (data) {
-          err = this->serializeToBuffer(data);
-          if (!err.hasError()) {
-            auto wresult = write(fd, data, this->serializedSize);
-            if (wresult < 0) {
-              err = WorkerError::from_errno("write", this->filePath);
-              close(fd);
-            }
-          }
-          gcaware_aligned_free(data);
-          return err;
-        }
+    if (this->serializedSize == 0) {
+      return WorkerError();
+    }
 
-        err = WorkerError::from_errno("mmap", this->filePath);
-        close(fd);
-        return err;
-      }
+    data = (uint8_t *)mmap(nullptr, this->serializedSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (data != MAP_FAILED) {
+      this->isMmap = true;
+      return WorkerError();
+    }
 
-      err = this->serializeToBuffer(data);
+    // mmap failed, allocate and write to buffer instead
+    this->isMmap = false;
+    data = (uint8_t *)gcaware_aligned_malloc(32, this->serializedSize);
+    return data ? WorkerError() : WorkerError::from_errno("mmap", this->filePath);
+  }
 
-      if (err.hasError()) {
-        close(fd);
-        return err;
+  /** Unmaps the file or writes the buffer returned by openOutput, if write is true, and closes the file. */
+  WorkerError closeOutput(uint8_t * data, bool write) {
+    WorkerError err;
+    if (data != nullptr) {
+      if (this->isMmap) {
+        munmap(data, this->serializedSize);
+      } else {
+        for (size_t pos = 0; write && pos < this->serializedSize;) {
+          auto written = ::write(this->fd, data + pos, this->serializedSize - pos);
+          if (written < 0) {
+            err = WorkerError::from_errno("write", this->filePath);
+            break;
+          }
+          pos += (size_t)written;
+        }
+        gcaware_aligned_free(data);
       }
-
-      munmap(data, this->serializedSize);
     }
-
-    close(fd);
+    if (this->fd >= 0) {
+      close(this->fd);
+      this->fd = -1;
+    }
     return err;
   }
+
+ private:
+  int fd = -1;
+  bool isMmap = false;
 };
 
 class RoaringBitmapDeserializerBase {
@@ -50,6 +50,44 @@ namespace v8utils {
     return true;
   }
 
+  /** Converts a non negative BigInt or a non negative safe integer number to an uint64_t. */
+  inline bool v8ValueToUint64Fast(v8::Local<v8::Context> context, v8::Local<v8::Value> value, uint64_t & result) {
+    if (value.IsEmpty()) {
+      return false;
+    }
+    if (value->IsBigInt()) {
+      bool lossless = false;
+      const uint64_t n = value.As<v8::BigInt>()->Uint64Value(&lossless);
+      if (!lossless) {
+        return false;
+      }
+      result = n;
+      return true;
+    }
+    uint32_t u32;
+    if (value->IsUint32() || value->IsInt32()) {
+      if (!v8ValueToUint32Fast(context, value, u32)) {
+        return false;
+      }
+      result = u32;
+      return true;
+    }
+    if (value->IsNullOrUndefined()) {
+      return false;
+    }
+    double d;
+    if (value->IsNumber()) {
+      d = value.As<v8::Number>()->Value();
+    } else if (!value->NumberValue(context).To(&d)) {
+      return false;
+    }
+    if (std::isnan(d) || d < 0 || d > 9007199254740991.0 || d != std::trunc(d)) {
+      return false;
+    }
+    result = static_cast<uint64_t>(d);
+    return true;
+  }
+
   template <int N>
   inline void throwError(v8::Isolate * isolate, const char (&message)[N]) {
     isolate->ThrowException(v8::Exception::Error(NEW_LITERAL_V8_STRING(isolate, message, v8::NewStringType::kInternalized)));
@@ -89,6 +127,20 @@ namespace v8utils {
       v8::Exception::TypeError(NEW_LITERAL_V8_STRING(isolate, "Operation failed", v8::NewStringType::kInternalized)));
   }
 
+  void throwRangeError(v8::Isolate * isolate, const char * message) {
+    v8::HandleScope scope(isolate);
+    if (message != nullptr && message[0] != '\0') {
+      auto msg = v8::String::NewFromUtf8(isolate, message, v8::NewStringType::kInternalized);
+      v8::Local<v8::String> msgLocal;
+      if (msg.ToLocal(&msgLocal)) {
+        isolate->ThrowException(v8::Exception::RangeError(msgLocal));
+        return;
+      }
+    }
+    isolate->ThrowException(
+      v8::Exception::RangeError(NEW_LITERAL_V8_STRING(isolate, "Operation failed", v8::NewStringType::kInternalized)));
+  }
+
   void throwTypeError(v8::Isolate * isolate, const char * context, const char * message) {
     v8::HandleScope scope(isolate);
     auto a = v8::String::NewFromUtf8(isolate, context, v8::NewStringType::kInternalized);
@@ -152,6 +152,80 @@ describe("RoaringBitmap32 basic", () => {
     });
   });
 
+  describe("rankMany", () => {
+    it("throws for invalid arguments", () => {
+      const bitmap = new RoaringBitmap32([1, 2, 3]);
+      expect(() => bitmap.rankMany([1, 2] as any)).toThrow();
+      expect(() => bitmap.rankMany(new Uint32Array(2), new Uint8Array(2) as any)).toThrow();
+      expect(() => bitmap.rankMany(new Uint32Array(3), new Float64Array(2))).toThrow();
+    });
+
+    it("returns an empty Float64Array for no values", () => {
+      const result = new RoaringBitmap32([1, 2, 3]).rankMany(new Uint32Array(0));
+      expect(result).to.be.instanceOf(Float64Array);
+      expect(result).to.have.lengthOf(0);
+    });
+
+    it("returns the same values of rank for sorted and unsorted values", () => {
+      const bitmap = new RoaringBitmap32([1, 2, 3, 4, 5, 10, 100, 1000, 2000, 3000]);
+      bitmap.addRange(100000, 200000);
+      bitmap.add(0xfffffff0);
+      const values = [0, 1, 4, 5, 9, 10, 500, 3000, 70000, 150000, 150000, 300000, 0xfffffff0, 0xffffffff];
+      const expected = values.map((v) => bitmap.rank(v));
+      expect(Array.from(bitmap.rankMany(new Uint32Array(values)))).deep.equal(expected);
+
+      const shuffled = [7, 2, 13, 0, 11, 4, 9, 1, 12, 3, 10, 6, 8, 5];
+      const result = bitmap.rankMany(new Uint32Array(shuffled.map((i) => values[i])));
+      expect(Array.from(result)).deep.equal(shuffled.map((i) => expected[i]));
+    });
+
+    it("fills the given output array", () => {
+      const bitmap = new RoaringBitmap32([10, 20, 30]);
+      const output = new Uint32Array(4);
+      expect(bitmap.rankMany(new Uint32Array([35, 5, 20]), output)).eq(output);
+      expect(Array.from(output)).deep.equal([3, 0, 2, 0]);
+    });
+  });
+
+  describe("selectMany", () => {
+    it("returns NaN for ranks out of range", () => {
+      const result = new RoaringBitmap32().selectMany(new Uint32Array([0, 1]));
+      expect(result).to.be.instanceOf(Float64Array);
+      expect(Array.from(result)).deep.equal([NaN, NaN]);
+    });
+
+    it("returns the same values of select for sorted and unsorted ranks", () => {
+      const bitmap = new RoaringBitmap32([1, 2, 3, 4, 5, 10, 100, 1000, 2000, 3000]);
+      bitmap.addRange(100000, 200000);
+      bitmap.add(0xfffffff0);
+      const size = bitmap.size;
+      const ranks = [0, 1, 5, 9, 10, 50000, 50000, 100009, size - 1, size, 0xffffffff];
+      const expected = ranks.map((r) => bitmap.select(r) ?? NaN);
+      expect(Array.from(bitmap.selectMany(new Uint32Array(ranks)))).deep.equal(expected);
+
+      const shuffled = [9, 3, 0, 7, 10, 2, 5, 8, 1, 6, 4];
+      const result = bitmap.selectMany(new Uint32Array(shuffled.map((i) => ranks[i])));
+      expect(Array.from(result)).deep.equal(shuffled.map((i) => expected[i]));
+    });
+
+    it("fills the given output array", () => {
+      const bitmap = new RoaringBitmap32([10, 20, 30]);
+      const output = new Uint32Array([7, 7, 7, 7]);
+      expect(bitmap.selectMany(new Uint32Array([2, 0, 3]), output)).eq(output);
+      expect(Array.from(output)).deep.equal([30, 10, 0, 7]);
+    });
+
+    it("writes the given missing value for ranks out of range", () => {
+      const bitmap = new RoaringBitmap32([0, 20]);
+      const output = new Uint32Array(3);
+      bitmap.selectMany(new Uint32Array([0, 5, 1]), output, 0xffffffff);
+      expect(Array.from(output)).deep.equal([0, 0xffffffff, 20]);
+      expect(Array.from(bitmap.selectMany(new Uint32Array([2, 1]), undefined, -1))).deep.equal([-1, 20]);
+      expect(() => bitmap.selectMany(new Uint32Array([2]), output, -1)).to.throw(TypeError);
+      expect(() => bitmap.selectMany(new Uint32Array([2]), undefined, "x" as any)).to.throw(TypeError);
+    });
+  });
+
   describe("toUint32Array", () => {
     it("returns an empty Uint32Array for an empty bitmap", () => {
       const a = new RoaringBitmap32().toUint32Array();
@@ -296,6 +370,26 @@ describe("RoaringBitmap32 basic", () => {
       expect(Array.from(result)).to.deep.eq(data);
     });
 
+    it("decodes a big bitmap in parallel", async () => {
+      const bitmap = new RoaringBitmap32();
+      for (let i = 0; i < 200000; ++i) {
+        bitmap.add((i * 7919) % 50000000);
+      }
+      bitmap.addRange(60000000, 63000000);
+      bitmap.addRange(0xfffffff0, 0x100000000);
+      bitmap.runOptimize();
+      const expected = bitmap.toUint32Array();
+      expect(Buffer.compare(Buffer.from((await bitmap.toUint32ArrayAsync()).buffer), Buffer.from(expected.buffer))).eq(0);
+
+      const limited = await bitmap.toUint32ArrayAsync(2500000);
+      expect(limited.length).eq(2500000);
+      expect(Buffer.compare(Buffer.from(limited.buffer), Buffer.from(expected.buffer, 0, 2500000 * 4))).eq(0);
+
+      const output = new Uint32Array(expected.length - 7);
+      expect(await bitmap.toUint32ArrayAsync(output)).eq(output);
+      expect(Buffer.compare(Buffer.from(output.buffer), Buffer.from(expected.buffer, 0, output.byteLength))).eq(0);
+    });
+
     it("writes the bitmap to the output array if the output array is smaller", async () => {
       const data = [1, 2, 10, 30, 40, 50, 55, 0x7fffffff, 0xffffffff];
       const bitmap = new RoaringBitmap32(data);
@@ -788,6 +882,77 @@ describe("RoaringBitmap32 basic", () => {
     });
   });
 
+  describe("size", () => {
+    it("stays exact across interleaved mutations", async () => {
+      const bitmap = new RoaringBitmap32();
+      const expected = new Set<number>();
+      let seed = 12345;
+      const random = (max: number) => {
+        seed = (seed * 1103515245 + 12345) >>> 0;
+        return seed % max;
+      };
+      for (let i = 0; i < 2000; ++i) {
+        const v = random(200000);
+        switch (random(8)) {
+          case 0:
+            bitmap.add(v, v + 1);
+            expected.add(v).add(v + 1);
+            break;
+          case 1:
+            expect(bitmap.tryAdd(v)).to.equal(!expected.has(v));
+            expected.add(v);
+            break;
+          case 2:
+            bitmap.remove(v);
+            expected.delete(v);
+            break;
+          case 3:
+            bitmap.addRange(v, v + 300);
+            for (let j = v; j < v + 300; ++j) {
+              expected.add(j);
+            }
+            break;
+          case 4:
+            bitmap.removeRange(v, v + 500);
+            for (let j = v; j < v + 500; ++j) {
+              expected.delete(j);
+            }
+            break;
+          case 5:
+            bitmap.flipRange(v, v + 100);
+            for (let j = v; j < v + 100; ++j) {
+              if (!expected.delete(j)) {
+                expected.add(j);
+              }
+            }
+            break;
+          case 6:
+            if (expected.size !== 0) {
+              expected.delete(bitmap.pop()!);
+            }
+            break;
+          default:
+            bitmap.removeRunCompression();
+            bitmap.runOptimize();
+            break;
+        }
+        expect(bitmap.size).to.equal(expected.size);
+      }
+      expect(bitmap.toArray().length).to.equal(expected.size);
+
+      const other = new RoaringBitmap32([1, 2, 3, 500000]);
+      await bitmap.orInPlaceAsync(other);
+      expect(bitmap.size).to.equal(new RoaringBitmap32(bitmap).size);
+      RoaringBitmap32.swap(bitmap, other);
+      expect(other.size).to.equal(other.toArray().length);
+      expect(bitmap.size).to.equal(4);
+      bitmap.clear();
+      expect(bitmap.size).to.equal(0);
+      bitmap.copyFrom(other);
+      expect(bitmap.size).to.equal(other.toArray().length);
+    });
+  });
+
   describe("indexOf", () => {
     it("returns -1 if the value is not present", () => {
       const rb = new RoaringBitmap32([1, 2, 3, 4, 5, 0xffffffff]);
@@ -1139,6 +1304,75 @@ describe("RoaringBitmap32 basic", () => {
     });
   });
 
+  describe("hasMany", () => {
+    it("returns a Uint8Array with the presence of each value", () => {
+      const bitmap = new RoaringBitmap32([1, 2, 3, 100000, 0xffffffff]);
+      bitmap.addRange(500, 1000);
+      const values = new Uint32Array([3, 4, 1, 0xffffffff, 100000, 499, 500, 999, 1000, 2]);
+      expect(Array.from(bitmap.hasMany(values))).to.deep.equal([1, 0, 1, 1, 1, 0, 1, 1, 0, 1]);
+      expect(bitmap.hasMany(new Uint32Array(0))).to.be.an.instanceOf(Uint8Array);
+      expect(Array.from(bitmap.hasMany(new Int32Array([-1, 2])))).to.deep.equal([1, 1]);
+    });
+
+    it("writes into the given output arrays", () => {
+      const bitmap = new RoaringBitmap32();
+      const values = new Uint32Array(100);
+      for (let i = 0; i < values.length; ++i) {
+        values[i] = i * 3;
+        if (i % 7 === 0) {
+          bitmap.add(i * 3);
+        }
+      }
+      const bytes = new Uint8Array(100).fill(7);
+      expect(bitmap.hasMany(values, bytes)).to.equal(bytes);
+      const bits = new Uint32Array(4).fill(0xffffffff);
+      expect(bitmap.hasMany(values, bits)).to.equal(bits);
+      for (let i = 0; i < values.length; ++i) {
+        expect(bytes[i]).eq(i % 7 === 0 ? 1 : 0);
+        expect((bits[i >>> 5] >>> (i & 31)) & 1).eq(i % 7 === 0 ? 1 : 0);
+      }
+      expect(bits[3] >>> 4).eq(0);
+    });
+
+    it("throws for invalid arguments", () => {
+      const bitmap = new RoaringBitmap32([1]);
+      expect(() => bitmap.hasMany([1, 2] as any)).to.throw(TypeError);
+      expect(() => bitmap.hasMany(new Uint32Array(3), new Uint8Array(2))).to.throw();
+      expect(() => bitmap.hasMany(new Uint32Array(33), new Uint32Array(1))).to.throw();
+      expect(() => bitmap.hasMany(new Uint32Array(3), new Int8Array(3) as any)).to.throw(TypeError);
+    });
+  });
+
+  describe("hasManyAsync", () => {
+    it("matches hasMany on a big input", async () => {
+      const bitmap = new RoaringBitmap32();
+      bitmap.addRange(0, 100000);
+      for (let i = 0; i < 200000; ++i) {
+        bitmap.add(i * 13 + 1000000);
+      }
+      const values = new Uint32Array(300001);
+      for (let i = 0; i < values.length; ++i) {
+        values[i] = (i * 2654435761) % 4000000;
+      }
+      const expected = bitmap.hasMany(values);
+      const bytes = await bitmap.hasManyAsync(values);
+      expect(Buffer.from(bytes).equals(Buffer.from(expected))).eq(true);
+
+      const bits = await bitmap.hasManyAsync(values, new Uint32Array(Math.ceil(values.length / 32)));
+      const expectedBits = bitmap.hasMany(values, new Uint32Array(bits.length));
+      expect(Array.from(bits)).to.deep.equal(Array.from(expectedBits));
+    });
+
+    it("freezes the bitmap and rejects invalid arguments", async () => {
+      const bitmap = new RoaringBitmap32([5]);
+      const promise = bitmap.hasManyAsync(new Uint32Array([5, 6]));
+      expect(() => bitmap.add(1)).to.throw();
+      expect(Array.from(await promise)).to.deep.equal([1, 0]);
+      bitmap.add(1);
+      await expect(bitmap.hasManyAsync([1] as any)).rejects.toThrow();
+    });
+  });
+
   describe("toSorted", () => {
     it("returns a sorted array", () => {
       const bitmap = new RoaringBitmap32([1, 2, 3, 4, 5, 6]);
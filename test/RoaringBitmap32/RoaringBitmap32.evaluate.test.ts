@@ -0,0 +1,116 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import type { RoaringBitmap32Expression } from "../..";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+describe("RoaringBitmap32 evaluate", () => {
+  it("evaluates nested expressions", () => {
+    const [a, b, c, d, e, f] = makeBitmaps(6);
+    const expected = RoaringBitmap32.andNot(
+      RoaringBitmap32.and(RoaringBitmap32.orMany(a, b, c), d),
+      RoaringBitmap32.or(e, f),
+    );
+    const result = RoaringBitmap32.evaluate(["andNot", ["and", ["or", a, b, c], d], ["or", e, f]]);
+    expect(result.isEqual(expected)).eq(true);
+  });
+
+  it("matches the binary operations", () => {
+    const [a, b, c, d] = makeBitmaps(4);
+    expect(RoaringBitmap32.evaluate(["or", a, b, c, d]).isEqual(RoaringBitmap32.orMany(a, b, c, d))).eq(true);
+    expect(RoaringBitmap32.evaluate(["and", b, d, a]).isEqual(RoaringBitmap32.andMany(a, b, d))).eq(true);
+    expect(
+      RoaringBitmap32.evaluate(["andNot", d, a, b]).isEqual(RoaringBitmap32.andNot(RoaringBitmap32.andNot(d, a), b)),
+    ).eq(true);
+    expect(RoaringBitmap32.evaluate(["xor", a, b, c]).isEqual(RoaringBitmap32.xorMany(a, b, c))).eq(true);
+    const nested = RoaringBitmap32.evaluate(["or", ["and", a, c], ["xor", b, d]]);
+    expect(nested.isEqual(RoaringBitmap32.or(RoaringBitmap32.and(a, c), RoaringBitmap32.xor(b, d)))).eq(true);
+  });
+
+  it("returns a copy, never an operand", () => {
+    const [a] = makeBitmaps(1);
+    const expressions: RoaringBitmap32Expression[] = [a, ["or", a], ["and", a], ["or", a, new RoaringBitmap32()]];
+    for (const expression of expressions) {
+      const result = RoaringBitmap32.evaluate(expression);
+      expect(result).not.eq(a);
+      expect(result.isEqual(a)).eq(true);
+      result.add(123456);
+      expect(a.has(123456)).eq(false);
+    }
+  });
+
+  it("handles empty operands and operations", () => {
+    const [a, b] = makeBitmaps(2);
+    const empty = new RoaringBitmap32();
+    expect(RoaringBitmap32.evaluate(["or"]).size).eq(0);
+    expect(RoaringBitmap32.evaluate(["and", a, ["or"], b]).size).eq(0);
+    expect(RoaringBitmap32.evaluate(["andNot", empty, a]).size).eq(0);
+    expect(RoaringBitmap32.evaluate(["and", ["andNot", a, a], b]).size).eq(0);
+    expect(RoaringBitmap32.evaluate(["xor", a, empty]).isEqual(a)).eq(true);
+  });
+
+  it("throws on invalid expressions", () => {
+    const [a] = makeBitmaps(1);
+    expect(() => RoaringBitmap32.evaluate(undefined as any)).to.throw(TypeError);
+    expect(() => (RoaringBitmap32 as any).evaluate()).to.throw(TypeError);
+    expect(() => RoaringBitmap32.evaluate([] as any)).to.throw("operation");
+    expect(() => RoaringBitmap32.evaluate(["nand", a] as any)).to.throw("operation must be one of");
+    expect(() => RoaringBitmap32.evaluate(["or", a, 1] as any)).to.throw("RoaringBitmap32");
+    const cyclic: any[] = ["or", a];
+    cyclic.push(cyclic);
+    expect(() => RoaringBitmap32.evaluate(cyclic as any)).to.throw("too deep");
+  });
+
+  describe("evaluateAsync", () => {
+    it("matches evaluate", async () => {
+      const [a, b, c, d, e, f] = makeBitmaps(6);
+      const expression: RoaringBitmap32Expression = ["andNot", ["and", ["or", a, b, c], d], ["or", e, f]];
+      const result = await RoaringBitmap32.evaluateAsync(expression);
+      expect(result.isEqual(RoaringBitmap32.evaluate(expression))).eq(true);
+    });
+
+    it("freezes the operands while running", async () => {
+      const [a, b] = makeBitmaps(2);
+      const promise = RoaringBitmap32.evaluateAsync(["or", a, ["and", a, b]]);
+      expect(a.isFrozen).eq(true);
+      expect(b.isFrozen).eq(true);
+      await promise;
+      expect(a.isFrozen).eq(false);
+      expect(b.isFrozen).eq(false);
+    });
+
+    it("keeps the operands alive when the caller empties the expression", async () => {
+      const [a, b, c, d, e, f] = makeBitmaps(6);
+      const expected = RoaringBitmap32.evaluate(["andNot", ["and", ["or", a, b, c], d], ["or", e, f]]);
+      const result = await startWithUnreferencedBitmaps(makeBitmaps(6), (x) => {
+        const union: unknown[] = ["or", x[0], x[1], x[2]];
+        const intersection: unknown[] = ["and", union, x[3]];
+        const subtrahend: unknown[] = ["or", x[4], x[5]];
+        const expression: unknown[] = ["andNot", intersection, subtrahend];
+        const promise = RoaringBitmap32.evaluateAsync(expression as RoaringBitmap32Expression);
+        for (const array of [union, intersection, subtrahend, expression]) {
+          array.length = 0;
+        }
+        return promise;
+      });
+      expect(result.isEqual(expected)).eq(true);
+    });
+
+    it("supports callbacks", async () => {
+      const [a, b] = makeBitmaps(2);
+      const result = await new Promise<RoaringBitmap32 | undefined>((resolve, reject) => {
+        RoaringBitmap32.evaluateAsync(["and", a, b], (error, bitmap) => (error ? reject(error) : resolve(bitmap)));
+      });
+      expect(result!.isEqual(RoaringBitmap32.and(a, b))).eq(true);
+    });
+
+    it("rejects invalid expressions", async () => {
+      await expect(RoaringBitmap32.evaluateAsync(["nand"] as any)).rejects.toThrow("operation must be one of");
+      await expect((RoaringBitmap32 as any).evaluateAsync()).rejects.toThrow("operand must be");
+      const error = await new Promise((resolve) => {
+        (RoaringBitmap32 as any).evaluateAsync((e: Error) => resolve(e));
+      });
+      expect(error).toBeInstanceOf(Error);
+    });
+  });
+});
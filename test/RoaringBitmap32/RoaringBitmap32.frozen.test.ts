@@ -1,3 +1,5 @@
+import fs from "node:fs";
+import path from "node:path";
 import { describe, expect, it } from "vitest";
 import RoaringBitmap32 from "../../RoaringBitmap32";
 import { FrozenViewFormat } from "../helpers/roaring";
@@ -139,6 +141,107 @@ describe("RoaringBitmap32 frozen", () => {
     }
   });
 
+  describe("mapFile", () => {
+    const tmpDir = path.resolve(__dirname, "..", "..", ".tmp", "tests");
+
+    it("maps a frozen file in both formats", async () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const bitmap = new RoaringBitmap32([1, 2, 3, 100, 0xfffffffe]);
+      bitmap.addRange(1000, 200000);
+      for (const format of ["unsafe_frozen_croaring", "unsafe_frozen_portable"] as const) {
+        const filePath = path.resolve(tmpDir, `test-map-${format}.bin`);
+        await bitmap.serializeFileAsync(filePath, format === "unsafe_frozen_croaring" ? format : "portable");
+        const mapped = RoaringBitmap32.mapFile(filePath, format);
+        expect(mapped.isFrozen).eq(true);
+        expect(mapped.isEqual(bitmap)).eq(true);
+        expect(mapped.size).eq(bitmap.size);
+        expect(() => mapped.add(5)).to.throw(ERROR_FROZEN);
+        expect(RoaringBitmap32.and(mapped, new RoaringBitmap32([3, 4, 1000])).toArray()).to.deep.equal([3, 1000]);
+        expect((await RoaringBitmap32.orAsync(mapped, new RoaringBitmap32([4]))).size).eq(bitmap.size + 1);
+        expect(mapped.releaseMappedFile()).eq(true);
+        expect(mapped.size).eq(0);
+        expect(mapped.isFrozen).eq(true);
+        expect(mapped.releaseMappedFile()).eq(false);
+      }
+    });
+
+    it("uses unsafe_frozen_croaring by default and can be disposed", async () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const filePath = path.resolve(tmpDir, "test-map-default.bin");
+      await new RoaringBitmap32([5, 6, 7]).serializeFileAsync(filePath, "unsafe_frozen_croaring");
+      const mapped = RoaringBitmap32.mapFile(filePath);
+      expect(mapped.toArray()).to.deep.equal([5, 6, 7]);
+      mapped.dispose();
+      expect(mapped.toArray()).to.deep.equal([]);
+    });
+
+    it("cannot release a file in use by an async operation", async () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const filePath = path.resolve(tmpDir, "test-map-pinned.bin");
+      await new RoaringBitmap32([5, 6, 7]).serializeFileAsync(filePath, "unsafe_frozen_croaring");
+      const mapped = RoaringBitmap32.mapFile(filePath);
+      const promise = RoaringBitmap32.andAsync(mapped, new RoaringBitmap32([6]));
+      expect(() => mapped.releaseMappedFile()).to.throw();
+      expect((await promise).toArray()).to.deep.equal([6]);
+      expect(mapped.releaseMappedFile()).eq(true);
+    });
+
+    it("keeps readonly views valid after the file is released", async () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const filePath = path.resolve(tmpDir, "test-map-view.bin");
+      await new RoaringBitmap32([5, 6, 70000]).serializeFileAsync(filePath, "unsafe_frozen_croaring");
+      const mapped = RoaringBitmap32.mapFile(filePath);
+      const view = new RoaringBitmap32(mapped, "readonly");
+      const readonlyView = mapped.asReadonlyView();
+      expect(view.toArray()).to.deep.equal([5, 6, 70000]);
+      expect(mapped.releaseMappedFile()).eq(true);
+      expect(view.toArray()).to.deep.equal([]);
+      expect(view.has(70000)).eq(false);
+      expect(readonlyView.size).eq(0);
+    });
+
+    it("throws for truncated portable files", async () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const filePath = path.resolve(tmpDir, "test-map-truncated.bin");
+      const bitmap = new RoaringBitmap32([1, 2, 3]);
+      bitmap.addRange(100000, 300000);
+      const buffer = bitmap.serialize("portable");
+      fs.writeFileSync(filePath, buffer.subarray(0, buffer.length - 10));
+      expect(() => RoaringBitmap32.mapFile(filePath, "unsafe_frozen_portable")).to.throw();
+      fs.writeFileSync(filePath, Buffer.concat([buffer, Buffer.alloc(3)]));
+      expect(() => RoaringBitmap32.mapFile(filePath, "unsafe_frozen_portable")).to.throw();
+      fs.writeFileSync(filePath, buffer);
+      expect(RoaringBitmap32.mapFile(filePath, "unsafe_frozen_portable").isEqual(bitmap)).eq(true);
+    });
+
+    it("maps an empty file to an empty frozen bitmap", () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const filePath = path.resolve(tmpDir, "test-map-empty.bin");
+      fs.writeFileSync(filePath, "");
+      const mapped = RoaringBitmap32.mapFile(filePath);
+      expect(mapped.size).eq(0);
+      expect(mapped.isFrozen).eq(true);
+    });
+
+    it("throws for missing or invalid files", () => {
+      fs.mkdirSync(tmpDir, { recursive: true });
+      const missing = path.resolve(tmpDir, "test-map-ENOENT.bin");
+      let error: any;
+      try {
+        RoaringBitmap32.mapFile(missing);
+      } catch (e) {
+        error = e;
+      }
+      expect(error.code).eq("ENOENT");
+      expect(error.path).eq(missing);
+
+      const invalid = path.resolve(tmpDir, "test-map-invalid.bin");
+      fs.writeFileSync(invalid, "not a bitmap");
+      expect(() => RoaringBitmap32.mapFile(invalid, "unsafe_frozen_croaring")).to.throw();
+      expect(() => RoaringBitmap32.mapFile(invalid, "xxx" as any)).to.throw();
+    });
+  });
+
   describe("asReadonlyView", () => {
     it("offers a readonly view", () => {
       const bitmap = new RoaringBitmap32([1, 2, 3]);
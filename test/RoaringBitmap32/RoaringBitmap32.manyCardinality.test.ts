@@ -0,0 +1,106 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+describe("RoaringBitmap32 many cardinality", () => {
+  describe("orManyCardinality", () => {
+    it("returns 0 with no bitmaps", () => {
+      expect(RoaringBitmap32.orManyCardinality()).eq(0);
+      expect(RoaringBitmap32.orManyCardinality([])).eq(0);
+    });
+
+    it("matches orMany", () => {
+      for (const count of [1, 2, 3, 10, 50]) {
+        const bitmaps = makeBitmaps(count);
+        expect(RoaringBitmap32.orManyCardinality(bitmaps)).eq(RoaringBitmap32.orMany(bitmaps).size);
+      }
+    });
+
+    it("accepts bitmaps as arguments", () => {
+      expect(RoaringBitmap32.orManyCardinality(new RoaringBitmap32([1, 2]), new RoaringBitmap32([2, 3]))).eq(3);
+    });
+
+    it("throws on invalid inputs", () => {
+      expect(() => RoaringBitmap32.orManyCardinality([new RoaringBitmap32(), 1 as any])).to.throw(
+        "accepts only RoaringBitmap32 instances",
+      );
+    });
+  });
+
+  describe("andManyCardinality", () => {
+    it("returns 0 with no bitmaps", () => {
+      expect(RoaringBitmap32.andManyCardinality()).eq(0);
+      expect(RoaringBitmap32.andManyCardinality([])).eq(0);
+    });
+
+    it("matches andMany", () => {
+      for (const count of [1, 2, 3, 10, 50]) {
+        const bitmaps = makeBitmaps(count);
+        expect(RoaringBitmap32.andManyCardinality(bitmaps)).eq(RoaringBitmap32.andMany(bitmaps).size);
+      }
+    });
+
+    it("returns 0 when the intersection is empty", () => {
+      const bitmaps = makeBitmaps(10);
+      bitmaps.push(new RoaringBitmap32([5]));
+      expect(RoaringBitmap32.andManyCardinality(bitmaps)).eq(0);
+    });
+
+    it("accepts bitmaps as arguments", () => {
+      expect(RoaringBitmap32.andManyCardinality(new RoaringBitmap32([1, 2]), new RoaringBitmap32([2, 3]))).eq(1);
+    });
+  });
+
+  describe("async", () => {
+    it("matches the synchronous versions", async () => {
+      const bitmaps = makeBitmaps(30);
+      expect(await RoaringBitmap32.orManyCardinalityAsync(bitmaps)).eq(RoaringBitmap32.orManyCardinality(bitmaps));
+      expect(await RoaringBitmap32.andManyCardinalityAsync(...bitmaps)).eq(RoaringBitmap32.andManyCardinality(bitmaps));
+      expect(await RoaringBitmap32.orManyCardinalityAsync([])).eq(0);
+    });
+
+    it("splits the key space of big bitmaps", async () => {
+      const a = new RoaringBitmap32();
+      const b = new RoaringBitmap32();
+      for (let key = 0; key < 1000; ++key) {
+        a.addRange(key * 0x10000, key * 0x10000 + 1000);
+        b.addRange(key * 0x10000 + 500, key * 0x10000 + 600 + key);
+      }
+      expect(await RoaringBitmap32.orManyCardinalityAsync([a, b])).eq(a.orCardinality(b));
+      expect(await RoaringBitmap32.andManyCardinalityAsync([a, b])).eq(a.andCardinality(b));
+    });
+
+    it("freezes the inputs while running", async () => {
+      const bitmaps = makeBitmaps(5);
+      const promise = RoaringBitmap32.orManyCardinalityAsync(bitmaps);
+      expect(bitmaps[0].isFrozen).eq(true);
+      await promise;
+      expect(bitmaps[0].isFrozen).eq(false);
+    });
+
+    it("keeps the inputs alive when the caller drops them", async () => {
+      const expected = makeBitmaps(30);
+      const or = startWithUnreferencedBitmaps(makeBitmaps(30), (x) => RoaringBitmap32.orManyCardinalityAsync(x));
+      expect(await or).eq(RoaringBitmap32.orManyCardinality(expected));
+      const and = startWithUnreferencedBitmaps(makeBitmaps(30), (x) => RoaringBitmap32.andManyCardinalityAsync(x));
+      expect(await and).eq(RoaringBitmap32.andManyCardinality(expected));
+    });
+
+    it("supports callbacks", async () => {
+      const bitmaps = makeBitmaps(5);
+      const result = await new Promise<number | undefined>((resolve, reject) => {
+        RoaringBitmap32.andManyCardinalityAsync(bitmaps, (error, cardinality) =>
+          error ? reject(error) : resolve(cardinality),
+        );
+      });
+      expect(result).eq(RoaringBitmap32.andMany(bitmaps).size);
+    });
+
+    it("rejects invalid inputs and releases the other bitmaps", async () => {
+      const bitmap = new RoaringBitmap32([1]);
+      await expect(RoaringBitmap32.andManyCardinalityAsync([bitmap, 1 as any])).rejects.toThrow();
+      expect(bitmap.isFrozen).eq(false);
+    });
+  });
+});
@@ -0,0 +1,108 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+describe("RoaringBitmap32 many operations async", () => {
+  describe("orManyAsync", () => {
+    it("returns an empty bitmap with no arguments", async () => {
+      const result = await RoaringBitmap32.orManyAsync([]);
+      expect(result).to.be.instanceOf(RoaringBitmap32);
+      expect(result.isEmpty).eq(true);
+      expect((await RoaringBitmap32.orManyAsync()).isEmpty).eq(true);
+    });
+
+    it("copies a single bitmap", async () => {
+      const bitmap = new RoaringBitmap32([1, 2, 3]);
+      const result = await RoaringBitmap32.orManyAsync([bitmap]);
+      expect(result).not.eq(bitmap);
+      expect(result.toArray()).deep.equal([1, 2, 3]);
+    });
+
+    it("accepts bitmaps as arguments", async () => {
+      const result = await RoaringBitmap32.orManyAsync(new RoaringBitmap32([1]), new RoaringBitmap32([2]));
+      expect(result.toArray()).deep.equal([1, 2]);
+    });
+
+    it("matches orMany with many bitmaps", async () => {
+      const bitmaps = makeBitmaps(1000);
+      const result = await RoaringBitmap32.orManyAsync(bitmaps);
+      expect(result.isEqual(RoaringBitmap32.orMany(bitmaps))).eq(true);
+    });
+
+    it("freezes the inputs while running", async () => {
+      const bitmaps = makeBitmaps(50);
+      const promise = RoaringBitmap32.orManyAsync(bitmaps);
+      expect(bitmaps[0].isFrozen).eq(true);
+      expect(() => bitmaps[0].add(1)).to.throw();
+      await promise;
+      expect(bitmaps[0].isFrozen).eq(false);
+    });
+
+    it("supports callbacks", async () => {
+      const bitmaps = makeBitmaps(20);
+      const result = await new Promise<RoaringBitmap32 | undefined>((resolve, reject) => {
+        RoaringBitmap32.orManyAsync(bitmaps, (error, bitmap) => (error ? reject(error) : resolve(bitmap)));
+      });
+      expect(result!.isEqual(RoaringBitmap32.orMany(bitmaps))).eq(true);
+    });
+
+    it("keeps the inputs alive when the caller drops them", async () => {
+      const orMany = startWithUnreferencedBitmaps(makeBitmaps(100), (x) => RoaringBitmap32.orManyAsync(x));
+      expect((await orMany).isEqual(RoaringBitmap32.orMany(makeBitmaps(100)))).eq(true);
+      const xorMany = startWithUnreferencedBitmaps(makeBitmaps(100), (x) => RoaringBitmap32.xorManyAsync(x));
+      expect((await xorMany).isEqual(RoaringBitmap32.xorMany(makeBitmaps(100)))).eq(true);
+      const andMany = startWithUnreferencedBitmaps(makeBitmaps(100), (x) => RoaringBitmap32.andManyAsync(x));
+      expect((await andMany).isEqual(RoaringBitmap32.andMany(makeBitmaps(100)))).eq(true);
+    });
+
+    it("rejects invalid inputs and releases the other bitmaps", async () => {
+      const bitmap = new RoaringBitmap32([1]);
+      await expect(RoaringBitmap32.orManyAsync([bitmap, 1 as any])).rejects.toThrow();
+      expect(bitmap.isFrozen).eq(false);
+    });
+  });
+
+  describe("xorManyAsync", () => {
+    it("matches xorMany with many bitmaps", async () => {
+      const bitmaps = makeBitmaps(1000);
+      const result = await RoaringBitmap32.xorManyAsync(bitmaps);
+      expect(result.isEqual(RoaringBitmap32.xorMany(bitmaps))).eq(true);
+    });
+
+    it("works with an odd number of bitmaps", async () => {
+      const result = await RoaringBitmap32.xorManyAsync(makeBitmaps(37));
+      expect(result.isEqual(RoaringBitmap32.xorMany(makeBitmaps(37)))).eq(true);
+    });
+  });
+
+  describe("andManyAsync", () => {
+    it("intersects many bitmaps", async () => {
+      const bitmaps = makeBitmaps(1000);
+      expect((await RoaringBitmap32.andManyAsync(bitmaps)).toArray()).deep.equal([77777]);
+    });
+
+    it("returns an empty bitmap when the intersection is empty", async () => {
+      const bitmaps = makeBitmaps(100);
+      bitmaps.push(new RoaringBitmap32([5]));
+      expect((await RoaringBitmap32.andManyAsync(bitmaps)).isEmpty).eq(true);
+    });
+
+    it("matches andMany with inputs of different sizes in any order", async () => {
+      const bitmaps: RoaringBitmap32[] = [];
+      for (let i = 0; i < 64; ++i) {
+        const bitmap = RoaringBitmap32.fromRange(0, 1000 + ((i * 37) % 64) * 5000, 1 + (i % 3));
+        bitmap.add(900000 + i);
+        bitmaps.push(bitmap);
+      }
+      const result = await RoaringBitmap32.andManyAsync(bitmaps);
+      expect(result.isEqual(RoaringBitmap32.andMany(bitmaps))).eq(true);
+      expect(result.size).eq(RoaringBitmap32.fromRange(0, 1000, 6).size);
+    });
+
+    it("intersects two bitmaps", async () => {
+      const result = await RoaringBitmap32.andManyAsync(new RoaringBitmap32([1, 2, 3]), new RoaringBitmap32([2, 3, 4]));
+      expect(result.toArray()).deep.equal([2, 3]);
+    });
+  });
+});
@@ -123,6 +123,44 @@ describe("RoaringBitmap32 operations", () => {
       expect(valuesSet.size).eq(0);
       expect(Array.from(bitmap)).deep.equal(values.slice().sort((a, b) => a - b));
     });
+
+    it("adds sorted arrays with runs", () => {
+      const values: number[] = [];
+      for (let i = 0; i < 5000; ++i) {
+        values.push(i % 1000 < 700 ? i * 2 : i * 2 + (i % 3));
+      }
+      for (let i = 100000; i < 100500; ++i) {
+        values.push(i);
+      }
+      values.push(200000, 200002, 0xffffffff);
+      const bitmap = new RoaringBitmap32([5]);
+      bitmap.addMany(values);
+      expect(bitmap.toArray()).deep.equal(Array.from(new Set([5, ...values])).sort((a, b) => a - b));
+      bitmap.copyFrom(values);
+      expect(bitmap.toArray()).deep.equal(Array.from(new Set(values)).sort((a, b) => a - b));
+      const tail = values.slice(4000);
+      expect(new RoaringBitmap32(tail).toArray()).deep.equal(Array.from(new Set(tail)).sort((a, b) => a - b));
+    });
+
+    it("converts array elements like Uint32Array.from", () => {
+      const values = [1.7, -1, Number.NaN, Number.POSITIVE_INFINITY, 2 ** 32 + 5, "7", null, undefined, true];
+      const expected = Array.from(new Set(Uint32Array.from(values as any))).sort((a, b) => a - b);
+      expect(new RoaringBitmap32(values as any).toArray()).deep.equal(expected);
+    });
+
+    it("supports arrays converted while converting another array", () => {
+      const inner = new RoaringBitmap32();
+      const outer = new RoaringBitmap32();
+      const values = [1, 2, { valueOf: () => inner.addMany([10, 11, 12]).size }, 4];
+      outer.addMany(values as any);
+      expect(inner.toArray()).deep.equal([10, 11, 12]);
+      expect(outer.toArray()).deep.equal([1, 2, 3, 4]);
+    });
+
+    it("adds big arrays", () => {
+      const values = Array.from({ length: 300000 }, (_, i) => i * 5);
+      expect(new RoaringBitmap32(values).size).eq(values.length);
+    });
   });
 
   describe("clear", () => {
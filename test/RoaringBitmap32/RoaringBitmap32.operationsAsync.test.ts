@@ -0,0 +1,128 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+
+describe("RoaringBitmap32 async operations", () => {
+  const a = new RoaringBitmap32([1, 2, 3, 4, 100000]);
+  const b = new RoaringBitmap32([3, 4, 5, 100000, 200000]);
+
+  describe("static", () => {
+    it("andAsync", async () => {
+      const result = await RoaringBitmap32.andAsync(a, b);
+      expect(result).to.be.instanceOf(RoaringBitmap32);
+      expect(result.toArray()).deep.equal([3, 4, 100000]);
+    });
+
+    it("orAsync", async () => {
+      expect((await RoaringBitmap32.orAsync(a, b)).toArray()).deep.equal([1, 2, 3, 4, 5, 100000, 200000]);
+    });
+
+    it("xorAsync", async () => {
+      expect((await RoaringBitmap32.xorAsync(a, b)).toArray()).deep.equal([1, 2, 5, 200000]);
+    });
+
+    it("andNotAsync", async () => {
+      expect((await RoaringBitmap32.andNotAsync(a, b)).toArray()).deep.equal([1, 2]);
+    });
+
+    it("does not modify the inputs and freezes them while running", async () => {
+      const x = a.clone();
+      const y = b.clone();
+      const promise = RoaringBitmap32.orAsync(x, y);
+      expect(x.isFrozen).eq(true);
+      expect(y.isFrozen).eq(true);
+      expect(() => x.add(7)).to.throw();
+      await promise;
+      expect(x.isFrozen).eq(false);
+      expect(y.isFrozen).eq(false);
+      expect(x.isEqual(a)).eq(true);
+      expect(y.isEqual(b)).eq(true);
+    });
+
+    it("works with readonly views", async () => {
+      expect((await RoaringBitmap32.andAsync(a.asReadonlyView(), b)).toArray()).deep.equal([3, 4, 100000]);
+    });
+
+    it("supports callbacks", async () => {
+      const result = await new Promise<RoaringBitmap32 | undefined>((resolve, reject) => {
+        RoaringBitmap32.xorAsync(a, b, (error, bitmap) => (error ? reject(error) : resolve(bitmap)));
+      });
+      expect(result!.toArray()).deep.equal([1, 2, 5, 200000]);
+    });
+
+    it("rejects with invalid arguments", async () => {
+      await expect(RoaringBitmap32.andAsync(a, [1, 2] as any)).rejects.toThrow();
+      await expect(RoaringBitmap32.orAsync(null as any, b)).rejects.toThrow();
+    });
+  });
+
+  describe("in place", () => {
+    it("orInPlaceAsync", async () => {
+      const x = a.clone();
+      expect(await x.orInPlaceAsync(b)).eq(x);
+      expect(x.toArray()).deep.equal([1, 2, 3, 4, 5, 100000, 200000]);
+      expect(x.size).eq(7);
+    });
+
+    it("andInPlaceAsync", async () => {
+      const x = a.clone();
+      await x.andInPlaceAsync(b);
+      expect(x.toArray()).deep.equal([3, 4, 100000]);
+    });
+
+    it("xorInPlaceAsync", async () => {
+      const x = a.clone();
+      await x.xorInPlaceAsync(b);
+      expect(x.toArray()).deep.equal([1, 2, 5, 200000]);
+    });
+
+    it("andNotInPlaceAsync", async () => {
+      const x = a.clone();
+      await x.andNotInPlaceAsync(b);
+      expect(x.toArray()).deep.equal([1, 2]);
+    });
+
+    it("accepts arrays and typed arrays", async () => {
+      const x = a.clone();
+      await x.andInPlaceAsync([1, 2, 9]);
+      expect(x.toArray()).deep.equal([1, 2]);
+      await x.orInPlaceAsync(new Uint32Array([7]));
+      expect(x.toArray()).deep.equal([1, 2, 7]);
+    });
+
+    it("works with the same instance", async () => {
+      const x = a.clone();
+      await x.xorInPlaceAsync(x);
+      expect(x.isEmpty).eq(true);
+    });
+
+    it("freezes the bitmap until completion and updates readonly views", async () => {
+      const x = a.clone();
+      const view = x.asReadonlyView();
+      const promise = x.orInPlaceAsync([7]);
+      expect(x.isFrozen).eq(true);
+      expect(() => x.add(8)).to.throw();
+      expect(x.has(7)).eq(false);
+      await promise;
+      expect(x.isFrozen).eq(false);
+      expect(x.has(7)).eq(true);
+      expect(view.has(7)).eq(true);
+      x.add(8);
+      expect(x.has(8)).eq(true);
+    });
+
+    it("rejects if the bitmap is frozen", async () => {
+      const x = a.clone().freeze();
+      await expect(x.orInPlaceAsync(b)).rejects.toThrow();
+      await expect(a.asReadonlyView().orInPlaceAsync(b)).rejects.toThrow();
+    });
+
+    it("supports callbacks", async () => {
+      const x = a.clone();
+      const result = await new Promise<RoaringBitmap32 | undefined>((resolve, reject) => {
+        x.andNotInPlaceAsync(b, (error, bitmap) => (error ? reject(error) : resolve(bitmap)));
+      });
+      expect(result).eq(x);
+      expect(x.toArray()).deep.equal([1, 2]);
+    });
+  });
+});
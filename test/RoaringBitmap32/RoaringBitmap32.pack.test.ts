@@ -0,0 +1,92 @@
+import fs from "node:fs";
+import path from "node:path";
+import { beforeAll, describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmap32Pack from "../../RoaringBitmap32Pack";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+const tmpDir = path.resolve(__dirname, "..", "..", ".tmp", "tests");
+
+describe("RoaringBitmap32 pack", () => {
+  beforeAll(() => {
+    if (!fs.existsSync(tmpDir)) {
+      fs.mkdirSync(tmpDir, { recursive: true });
+    }
+  });
+
+  for (const format of ["portable", "unsafe_frozen_croaring"] as const) {
+    it(`writes and reads a pack in ${format} format`, async () => {
+      const filePath = path.resolve(tmpDir, `test-pack-${format}.pack`);
+      const bitmaps = makeBitmaps(300);
+      bitmaps.splice(150, 0, new RoaringBitmap32());
+      await RoaringBitmap32.serializePackFileAsync(filePath, bitmaps, format);
+
+      const pack = new RoaringBitmap32Pack(filePath);
+      expect(pack.length).eq(bitmaps.length);
+      expect(pack.format).eq(format);
+
+      for (let i = bitmaps.length - 1; i >= 0; --i) {
+        const copy = pack.get(i);
+        expect(copy.isFrozen).eq(false);
+        expect(copy.isEqual(bitmaps[i])).eq(true);
+        copy.add(0xffffffff);
+
+        const view = pack.view(i);
+        expect(view.isFrozen).eq(true);
+        expect(view.size).eq(bitmaps[i].size);
+        expect(view.isEqual(bitmaps[i])).eq(true);
+      }
+
+      RoaringBitmap32.serializePackFile(filePath, bitmaps.slice(0, 3), format);
+      expect(new RoaringBitmap32Pack(filePath).get(2).toArray()).to.deep.equal(bitmaps[2].toArray());
+    });
+  }
+
+  it("writes an empty pack", () => {
+    const filePath = path.resolve(tmpDir, "test-pack-empty.pack");
+    RoaringBitmap32.serializePackFile(filePath, [], "portable");
+    const pack = new RoaringBitmap32Pack(filePath);
+    expect(pack.length).eq(0);
+    expect(() => pack.get(0)).to.throw();
+  });
+
+  it("throws for invalid arguments and files", () => {
+    const filePath = path.resolve(tmpDir, "test-pack-invalid.pack");
+    expect(() => RoaringBitmap32.serializePackFile(filePath, [1 as any], "portable")).to.throw();
+    expect(() => RoaringBitmap32.serializePackFile(filePath, [], "croaring" as any)).to.throw();
+
+    fs.writeFileSync(filePath, Buffer.alloc(100));
+    expect(() => new RoaringBitmap32Pack(filePath)).to.throw();
+    expect(() => new RoaringBitmap32Pack(path.resolve(tmpDir, "test-pack-ENOENT.pack"))).to.throw(/ENOENT/);
+
+    RoaringBitmap32.serializePackFile(filePath, [new RoaringBitmap32([1, 2])], "portable");
+    const pack = new RoaringBitmap32Pack(filePath);
+    expect(() => pack.view(1)).to.throw();
+    expect(() => pack.view(-1)).to.throw();
+    expect(() => pack.view(0.5)).to.throw();
+  });
+
+  it("keeps the bitmaps frozen while writing asynchronously", async () => {
+    const filePath = path.resolve(tmpDir, "test-pack-frozen.pack");
+    const bitmap = new RoaringBitmap32([1, 2, 3]);
+    const promise = RoaringBitmap32.serializePackFileAsync(filePath, [bitmap], "portable");
+    expect(() => bitmap.add(4)).to.throw();
+    await promise;
+    bitmap.add(4);
+    expect(new RoaringBitmap32Pack(filePath).get(0).toArray()).to.deep.equal([1, 2, 3]);
+  });
+
+  it("keeps the bitmaps alive when the caller drops them", async () => {
+    const filePath = path.resolve(tmpDir, "test-pack-unreferenced.pack");
+    await startWithUnreferencedBitmaps(makeBitmaps(50), (x) =>
+      RoaringBitmap32.serializePackFileAsync(filePath, x, "portable"),
+    );
+    const expected = makeBitmaps(50);
+    const pack = new RoaringBitmap32Pack(filePath);
+    expect(pack.length).eq(expected.length);
+    for (let i = 0; i < expected.length; ++i) {
+      expect(pack.get(i).isEqual(expected[i])).eq(true);
+    }
+  });
+});
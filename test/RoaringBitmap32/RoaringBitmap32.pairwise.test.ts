@@ -0,0 +1,102 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+function expected(a: RoaringBitmap32, b: RoaringBitmap32, metric: "intersection" | "jaccard" | "cosine"): number {
+  const intersection = a.andCardinality(b);
+  switch (metric) {
+    case "intersection":
+      return intersection;
+    case "jaccard":
+      return intersection / (a.size + b.size - intersection);
+    default:
+      return intersection / Math.sqrt(a.size * b.size);
+  }
+}
+
+function checkMatrix(
+  bitmaps: RoaringBitmap32[],
+  metric: "intersection" | "jaccard" | "cosine",
+  full: boolean,
+  matrix: Uint32Array | Float64Array,
+) {
+  const n = bitmaps.length;
+  expect(matrix).to.be.instanceOf(metric === "intersection" ? Uint32Array : Float64Array);
+  expect(matrix.length).eq(full ? n * n : (n * (n - 1)) / 2);
+  for (let i = 0; i < n; ++i) {
+    for (let j = full ? 0 : i + 1; j < n; ++j) {
+      const index = full ? i * n + j : (i * (2 * n - i - 1)) / 2 + (j - i - 1);
+      const value = expected(bitmaps[i], bitmaps[j], metric);
+      if (Number.isNaN(value)) {
+        expect(matrix[index]).to.be.NaN;
+      } else {
+        expect(matrix[index]).to.be.closeTo(value, 1e-12);
+      }
+    }
+  }
+}
+
+describe("RoaringBitmap32 pairwise", () => {
+  it("returns an empty matrix for less than two bitmaps", () => {
+    expect(RoaringBitmap32.pairwise([], "intersection")).to.deep.equal(new Uint32Array(0));
+    expect(RoaringBitmap32.pairwise([new RoaringBitmap32([1])], "jaccard")).to.deep.equal(new Float64Array(0));
+    expect(RoaringBitmap32.pairwise([new RoaringBitmap32([1, 2])], "intersection", { full: true })).to.deep.equal(
+      new Uint32Array([2]),
+    );
+  });
+
+  it("computes all the metrics, upper triangle and full", () => {
+    const bitmaps = [...makeBitmaps(150), new RoaringBitmap32(), new RoaringBitmap32()];
+    for (const metric of ["intersection", "jaccard", "cosine"] as const) {
+      checkMatrix(bitmaps, metric, false, RoaringBitmap32.pairwise(bitmaps, metric));
+      checkMatrix(bitmaps, metric, true, RoaringBitmap32.pairwise(bitmaps, metric, { full: true }));
+    }
+  });
+
+  it("throws on invalid arguments", () => {
+    expect(() => RoaringBitmap32.pairwise([new RoaringBitmap32()], "invalid" as any)).to.throw("metric");
+    expect(() => RoaringBitmap32.pairwise([1 as any], "jaccard")).to.throw("RoaringBitmap32 instances");
+    expect(() => RoaringBitmap32.pairwise([], "jaccard", 1 as any)).to.throw("options");
+  });
+
+  describe("pairwiseAsync", () => {
+    it("matches pairwise", async () => {
+      const bitmaps = [...makeBitmaps(150), new RoaringBitmap32(), new RoaringBitmap32()];
+      for (const metric of ["intersection", "jaccard", "cosine"] as const) {
+        checkMatrix(bitmaps, metric, false, await RoaringBitmap32.pairwiseAsync(bitmaps, metric));
+        checkMatrix(bitmaps, metric, true, await RoaringBitmap32.pairwiseAsync(bitmaps, metric, { full: true }));
+      }
+    });
+
+    it("freezes the bitmaps while running", async () => {
+      const bitmaps = makeBitmaps(10);
+      const promise = RoaringBitmap32.pairwiseAsync(bitmaps, "jaccard");
+      expect(bitmaps[0].isFrozen).eq(true);
+      await promise;
+      expect(bitmaps[0].isFrozen).eq(false);
+    });
+
+    it("keeps the bitmaps alive when the caller drops them", async () => {
+      const expected = RoaringBitmap32.pairwise(makeBitmaps(40), "jaccard");
+      const result = await startWithUnreferencedBitmaps(makeBitmaps(40), (x) =>
+        RoaringBitmap32.pairwiseAsync(x, "jaccard"),
+      );
+      expect(result).to.deep.equal(expected);
+    });
+
+    it("supports callbacks", async () => {
+      const bitmaps = makeBitmaps(10);
+      const result = await new Promise<Uint32Array | Float64Array | undefined>((resolve, reject) => {
+        RoaringBitmap32.pairwiseAsync(bitmaps, "intersection", undefined, (error, matrix) =>
+          error ? reject(error) : resolve(matrix),
+        );
+      });
+      checkMatrix(bitmaps, "intersection", false, result!);
+    });
+
+    it("rejects invalid arguments", async () => {
+      await expect(RoaringBitmap32.pairwiseAsync([1 as any], "cosine")).rejects.toThrow("RoaringBitmap32 instances");
+    });
+  });
+});
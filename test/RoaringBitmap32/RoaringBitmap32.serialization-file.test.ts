@@ -135,6 +135,53 @@ describe("RoaringBitmap32 file serialization", () => {
     expect(syncError.path).to.equal(tmpFilePath);
   });
 
+  it("deserializes big text files in parallel, with numbers across chunk boundaries", async () => {
+    const tmpFilePath = path.resolve(tmpDir, `test-big-text.csv`);
+    const values: number[] = [];
+    let text = "";
+    for (let i = 0; i < 600000; ++i) {
+      const v = (i * 7919 + (i % 13) * 1000003) >>> 0;
+      values.push(v);
+      text += i % 97 === 0 ? ` -${v}\r\n` : `${v},`;
+    }
+    text += "4294967295,4294967296";
+    await fs.promises.writeFile(tmpFilePath, text);
+    expect(text.length).to.be.greaterThan(4 << 20);
+
+    const expected = new RoaringBitmap32(values.filter((_, i) => i % 97 !== 0));
+    expected.add(4294967295);
+
+    const syncResult = RoaringBitmap32.deserializeFile(tmpFilePath, "comma_separated_values");
+    expect(syncResult.isEqual(expected)).eq(true);
+    for (const format of ["comma_separated_values", "newline_separated_values", "json_array"] as const) {
+      const asyncResult = await RoaringBitmap32.deserializeFileAsync(tmpFilePath, format);
+      expect(asyncResult.size).eq(expected.size);
+      expect(asyncResult.isEqual(expected)).eq(true);
+    }
+  });
+
+  it("deserializes an empty text file asynchronously", async () => {
+    const tmpFilePath = path.resolve(tmpDir, `test-empty-text.csv`);
+    await fs.promises.writeFile(tmpFilePath, "");
+    expect((await RoaringBitmap32.deserializeFileAsync(tmpFilePath, "tab_separated_values")).toArray()).to.deep.equal(
+      [],
+    );
+  });
+
+  it("throws ENOENT if a text file does not exist", async () => {
+    const tmpFilePath = path.resolve(tmpDir, `test-ENOENT.csv`);
+    let error: any;
+    try {
+      await RoaringBitmap32.deserializeFileAsync(tmpFilePath, "comma_separated_values");
+    } catch (e) {
+      error = e;
+    }
+    expect(error).to.be.an.instanceOf(Error);
+    expect(error.code).to.equal("ENOENT");
+    expect(error.syscall).to.equal("open");
+    expect(error.path).to.equal(tmpFilePath);
+  });
+
   it("serializes to comma_separated_values", async () => {
     const tmpFilePath = path.resolve(tmpDir, `test-csv.csv`);
     const bmp = new RoaringBitmap32([1, 2, 3, 100, 14120, 3481983]);
@@ -174,6 +221,57 @@ describe("RoaringBitmap32 file serialization", () => {
     );
   });
 
+  it("serializes runs and big bitmaps to text", async () => {
+    const tmpFilePath = path.resolve(tmpDir, `test-csv-big.csv`);
+    const bmp = new RoaringBitmap32();
+    bmp.addRange(0, 150000);
+    bmp.addRange(999999990, 1000000010);
+    bmp.addRange(4294967290, 4294967296);
+    for (let i = 0; i < 100000; ++i) {
+      bmp.add(200000 + i * 37);
+    }
+    const expected = bmp.toArray().join("\n");
+    await bmp.serializeFileAsync(tmpFilePath, "newline_separated_values");
+    expect(await fs.promises.readFile(tmpFilePath, "utf8")).to.equal(`${expected}\n`);
+    await bmp.serializeFileAsync(tmpFilePath, "json_array");
+    expect(await fs.promises.readFile(tmpFilePath, "utf8")).to.equal(`[${expected.replace(/\n/g, ",")}]`);
+  });
+
+  it("serializes big bitmaps in parallel with the same output of serialize", async () => {
+    const values: number[] = [];
+    for (let k = 0; k < 900; ++k) {
+      const base = k * 0x10000;
+      switch (k % 3) {
+        case 0:
+          for (let i = 0; i < 5000; ++i) {
+            values.push(base + i * 13);
+          }
+          break;
+        case 1:
+          for (let i = 0; i < 100; ++i) {
+            values.push(base + i * 7);
+          }
+          break;
+      }
+    }
+    const bmp = new RoaringBitmap32(values);
+    for (let k = 2; k < 900; k += 3) {
+      bmp.addRange(k * 0x10000 + k, k * 0x10000 + 3000 + k);
+      bmp.addRange(k * 0x10000 + 5000, k * 0x10000 + 5100);
+    }
+    bmp.runOptimize();
+
+    for (const format of ["croaring", "portable", "unsafe_frozen_croaring"] as const) {
+      const expected = bmp.serialize(format);
+      expect(expected.length).to.be.greaterThan(2 * 1024 * 1024);
+      expect(Buffer.compare(await bmp.serializeAsync(format), expected)).to.equal(0);
+
+      const tmpFilePath = path.resolve(tmpDir, `test-parallel-${format}.bin`);
+      await bmp.serializeFileAsync(tmpFilePath, format);
+      expect(Buffer.compare(await fs.promises.readFile(tmpFilePath), expected)).to.equal(0);
+    }
+  });
+
   it("serializes to an empty json array", async () => {
     const tmpFilePath = path.resolve(tmpDir, `test-json-array-empty.csv`);
     await new RoaringBitmap32().serializeFileAsync(tmpFilePath, "json_array");
@@ -0,0 +1,84 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+describe("RoaringBitmap32 serializeParallelAsync", () => {
+  it("resolves to an empty array", async () => {
+    expect(await RoaringBitmap32.serializeParallelAsync([], "portable")).to.deep.equal([]);
+  });
+
+  it("serializes many bitmaps to a buffer each", async () => {
+    const bitmaps = [...makeBitmaps(100), new RoaringBitmap32()];
+    for (const format of ["croaring", "portable", "unsafe_frozen_croaring", "uint32_array"] as const) {
+      const buffers = await RoaringBitmap32.serializeParallelAsync(bitmaps, format);
+      expect(buffers).to.have.lengthOf(bitmaps.length);
+      for (let i = 0; i < bitmaps.length; ++i) {
+        expect(Buffer.compare(buffers[i], bitmaps[i].serialize(format))).to.equal(0);
+      }
+    }
+  });
+
+  it("serializes many bitmaps to a contiguous buffer", async () => {
+    const bitmaps = [...makeBitmaps(100), new RoaringBitmap32()];
+    for (const format of ["croaring", "portable", "unsafe_frozen_croaring"] as const) {
+      const { buffer, offsets, lengths } = await RoaringBitmap32.serializeParallelAsync(bitmaps, format, {
+        contiguous: true,
+      });
+      expect(offsets).to.be.instanceOf(Float64Array);
+      expect(lengths).to.have.lengthOf(bitmaps.length);
+      for (let i = 0; i < bitmaps.length; ++i) {
+        const body = buffer.subarray(offsets[i], offsets[i] + lengths[i]);
+        expect(Buffer.compare(body, bitmaps[i].serialize(format))).to.equal(0);
+        if (format === "unsafe_frozen_croaring") {
+          expect(offsets[i] % 32).to.equal(0);
+          expect(RoaringBitmap32.unsafeFrozenView(body, format).isEqual(bitmaps[i])).to.equal(true);
+        }
+      }
+    }
+  });
+
+  it("freezes the owners of readonly views until completion", async () => {
+    const bitmap = new RoaringBitmap32([1, 2, 100000]);
+    const view = bitmap.asReadonlyView();
+    const promise = RoaringBitmap32.serializeParallelAsync([view, view], "portable");
+    expect(bitmap.isFrozen).eq(true);
+    expect(() => bitmap.add(3)).to.throw();
+    const buffers = await promise;
+    expect(bitmap.isFrozen).eq(false);
+    for (const buffer of buffers) {
+      expect(Buffer.compare(buffer, bitmap.serialize("portable"))).to.equal(0);
+    }
+    bitmap.add(3);
+    expect(view.has(3)).eq(true);
+  });
+
+  it("keeps the bitmaps alive when the caller drops them", async () => {
+    const expected = makeBitmaps(50).map((bitmap) => bitmap.serialize("portable"));
+    const buffers = await startWithUnreferencedBitmaps(makeBitmaps(50), (x) =>
+      RoaringBitmap32.serializeParallelAsync(x, "portable"),
+    );
+    for (let i = 0; i < expected.length; ++i) {
+      expect(Buffer.compare(buffers[i], expected[i])).to.equal(0);
+    }
+  });
+
+  it("calls the callback", async () => {
+    const bitmaps = makeBitmaps(3);
+    const buffers = await new Promise<Buffer[] | undefined>((resolve, reject) => {
+      RoaringBitmap32.serializeParallelAsync(bitmaps, "portable", undefined, (error, result) =>
+        error ? reject(error) : resolve(result),
+      );
+    });
+    expect(buffers).to.have.lengthOf(bitmaps.length);
+  });
+
+  it("rejects invalid arguments", async () => {
+    await expect(RoaringBitmap32.serializeParallelAsync([1 as any], "portable")).rejects.toThrow(
+      "can contain only RoaringBitmap32 instances",
+    );
+    await expect(RoaringBitmap32.serializeParallelAsync([], "invalid" as any)).rejects.toThrow(
+      "valid serialization format",
+    );
+  });
+});
@@ -337,6 +337,50 @@ describe("RoaringBitmap32 static", () => {
     });
   });
 
+  describe("static andMany", () => {
+    it("returns an empty bitmap with no arguments", () => {
+      expect(RoaringBitmap32.andMany().isEmpty).eq(true);
+      expect(RoaringBitmap32.andMany([]).isEmpty).eq(true);
+    });
+
+    it("copies a single bitmap", () => {
+      const bitmap = new RoaringBitmap32([1, 2]);
+      const result = RoaringBitmap32.andMany([bitmap]);
+      expect(result).not.eq(bitmap);
+      expect(result.toArray()).deep.equal([1, 2]);
+    });
+
+    it("intersects many bitmaps passed as arguments or as an array", () => {
+      const a = new RoaringBitmap32([1, 2, 3, 4, 5, 100000]);
+      const b = new RoaringBitmap32([2, 3, 4, 100000]);
+      const c = new RoaringBitmap32([3, 4, 9, 100000]);
+      expect(RoaringBitmap32.andMany(a, b, c).toArray()).deep.equal([3, 4, 100000]);
+      expect(RoaringBitmap32.andMany([c, a, b]).toArray()).deep.equal([3, 4, 100000]);
+      expect(a.toArray()).deep.equal([1, 2, 3, 4, 5, 100000]);
+    });
+
+    it("returns an empty bitmap if one of the bitmaps is empty", () => {
+      const a = new RoaringBitmap32([1, 2, 3]);
+      expect(RoaringBitmap32.andMany(a, new RoaringBitmap32(), a).isEmpty).eq(true);
+      expect(RoaringBitmap32.andMany(a, new RoaringBitmap32([7]), a).isEmpty).eq(true);
+    });
+
+    it("throws if an argument is not a RoaringBitmap32", () => {
+      expect(() => RoaringBitmap32.andMany(new RoaringBitmap32(), 1 as any)).to.throw(TypeError);
+    });
+
+    it("intersects in place with andManyInPlace", () => {
+      const a = new RoaringBitmap32([1, 2, 3, 4, 5]);
+      const view = a.asReadonlyView();
+      expect(a.andManyInPlace(new RoaringBitmap32([2, 3, 4]), new RoaringBitmap32([3, 4, 9]))).eq(a);
+      expect(a.toArray()).deep.equal([3, 4]);
+      expect(view.toArray()).deep.equal([3, 4]);
+      a.andManyInPlace([new RoaringBitmap32([4])]);
+      expect(a.toArray()).deep.equal([4]);
+      expect(() => a.freeze().andManyInPlace(a)).to.throw();
+    });
+  });
+
   describe("static swap", () => {
     it("swaps two empty bitmaps", () => {
       const a = new RoaringBitmap32();
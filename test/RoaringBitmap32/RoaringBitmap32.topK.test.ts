@@ -0,0 +1,135 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import { makeBitmaps } from "../helpers/bitmaps";
+import { startWithUnreferencedBitmaps } from "../helpers/gc";
+
+type Metric = "intersection" | "jaccard" | "cosine";
+
+function score(a: RoaringBitmap32, b: RoaringBitmap32, metric: Metric): number {
+  const intersection = a.andCardinality(b);
+  switch (metric) {
+    case "intersection":
+      return intersection;
+    case "jaccard":
+      return intersection / (a.size + b.size - intersection);
+    default:
+      return intersection / Math.sqrt(a.size * b.size);
+  }
+}
+
+function expected(query: RoaringBitmap32, candidates: RoaringBitmap32[], k: number, metric: Metric) {
+  const all = candidates
+    .map((candidate, index) => ({ index, score: score(query, candidate, metric) }))
+    .filter((entry) => !Number.isNaN(entry.score))
+    .sort((a, b) => b.score - a.score || a.index - b.index)
+    .slice(0, k);
+  return { indices: all.map((entry) => entry.index), scores: all.map((entry) => entry.score) };
+}
+
+function check(
+  result: { indices: Uint32Array; scores: Float64Array },
+  query: RoaringBitmap32,
+  candidates: RoaringBitmap32[],
+  k: number,
+  metric: Metric,
+) {
+  const { indices, scores } = expected(query, candidates, k, metric);
+  expect(result.indices).to.be.instanceOf(Uint32Array);
+  expect(result.scores).to.be.instanceOf(Float64Array);
+  expect(Array.from(result.indices)).to.deep.equal(indices);
+  for (let i = 0; i < scores.length; ++i) {
+    expect(result.scores[i]).to.be.closeTo(scores[i], 1e-12);
+  }
+}
+
+describe("RoaringBitmap32 topK", () => {
+  it("returns empty results with no candidates or k 0", () => {
+    const query = new RoaringBitmap32([1, 2, 3]);
+    const empty = RoaringBitmap32.topK(query, [], 10, "jaccard");
+    expect(empty.indices.length).eq(0);
+    expect(empty.scores.length).eq(0);
+    expect(RoaringBitmap32.topK(query, [new RoaringBitmap32([1])], 0, "jaccard").indices.length).eq(0);
+  });
+
+  it("matches a full scan for all the metrics", () => {
+    const candidates = [...makeBitmaps(1200), new RoaringBitmap32()];
+    const query = new RoaringBitmap32();
+    query.addRange(300, 1400);
+    for (const metric of ["intersection", "jaccard", "cosine"] as const) {
+      for (const k of [1, 5, 50, 2000]) {
+        check(RoaringBitmap32.topK(query, candidates, k, metric), query, candidates, k, metric);
+      }
+    }
+  });
+
+  it("sorts ties by index and skips undefined scores", () => {
+    const candidates = [
+      new RoaringBitmap32(),
+      new RoaringBitmap32([1, 2]),
+      new RoaringBitmap32([5]),
+      new RoaringBitmap32([1, 2]),
+    ];
+    const result = RoaringBitmap32.topK(new RoaringBitmap32([1, 2, 3]), candidates, 10, "jaccard");
+    expect(Array.from(result.indices)).to.deep.equal([1, 3, 0, 2]);
+    expect(Array.from(result.scores)).to.deep.equal([2 / 3, 2 / 3, 0, 0]);
+    expect(RoaringBitmap32.topK(new RoaringBitmap32(), candidates, 10, "cosine").indices.length).eq(0);
+  });
+
+  it("throws on invalid arguments", () => {
+    const query = new RoaringBitmap32();
+    expect(() => RoaringBitmap32.topK(1 as any, [], 1, "jaccard")).to.throw("first argument");
+    expect(() => RoaringBitmap32.topK(query, [1 as any], 1, "jaccard")).to.throw("RoaringBitmap32 instances");
+    expect(() => RoaringBitmap32.topK(query, [], -1, "jaccard")).to.throw("k must be");
+    expect(() => RoaringBitmap32.topK(query, [], 1, "invalid" as any)).to.throw("metric");
+  });
+
+  describe("topKAsync", () => {
+    it("matches topK", async () => {
+      const candidates = [...makeBitmaps(1200), new RoaringBitmap32()];
+      const query = new RoaringBitmap32();
+      query.addRange(100, 900);
+      for (const metric of ["intersection", "jaccard", "cosine"] as const) {
+        check(await RoaringBitmap32.topKAsync(query, candidates, 20, metric), query, candidates, 20, metric);
+      }
+    });
+
+    it("freezes the bitmaps while running", async () => {
+      const candidates = makeBitmaps(10);
+      const query = new RoaringBitmap32([1]);
+      const promise = RoaringBitmap32.topKAsync(query, candidates, 3, "cosine");
+      expect(query.isFrozen).eq(true);
+      expect(candidates[0].isFrozen).eq(true);
+      await promise;
+      expect(query.isFrozen).eq(false);
+      expect(candidates[0].isFrozen).eq(false);
+    });
+
+    it("keeps the query and the candidates alive when the caller drops them", async () => {
+      const bitmaps = makeBitmaps(300);
+      const expected = RoaringBitmap32.topK(bitmaps[0], bitmaps.slice(1), 20, "jaccard");
+      const result = await startWithUnreferencedBitmaps(makeBitmaps(300), (x) =>
+        RoaringBitmap32.topKAsync(x[0], x.slice(1), 20, "jaccard"),
+      );
+      expect(result).to.deep.equal(expected);
+    });
+
+    it("supports callbacks", async () => {
+      const candidates = makeBitmaps(10);
+      const query = new RoaringBitmap32([1, 2, 3, 50]);
+      const result = await new Promise<{ indices: Uint32Array; scores: Float64Array } | undefined>(
+        (resolve, reject) => {
+          RoaringBitmap32.topKAsync(query, candidates, 3, "intersection", (error, r) =>
+            error ? reject(error) : resolve(r),
+          );
+        },
+      );
+      check(result!, query, candidates, 3, "intersection");
+    });
+
+    it("rejects invalid arguments", async () => {
+      await expect(RoaringBitmap32.topKAsync(new RoaringBitmap32(), [1 as any], 1, "cosine")).rejects.toThrow(
+        "RoaringBitmap32 instances",
+      );
+    });
+  });
+});
@@ -0,0 +1,72 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmap32Accumulator from "../../RoaringBitmap32Accumulator";
+import roaring from "../..";
+import { makeBitmaps } from "../helpers/bitmaps";
+
+describe("RoaringBitmap32Accumulator", () => {
+  it("is exported", () => {
+    expect(roaring.RoaringBitmap32Accumulator).eq(RoaringBitmap32Accumulator);
+    expect(Object.prototype.toString.call(new RoaringBitmap32Accumulator())).eq("[object RoaringBitmap32Accumulator]");
+  });
+
+  it("computes the union of the merged bitmaps", () => {
+    const bitmaps = makeBitmaps(30);
+    const accumulator = new RoaringBitmap32Accumulator();
+    for (const bitmap of bitmaps) {
+      expect(accumulator.or(bitmap)).eq(accumulator);
+    }
+    expect(accumulator.count).eq(bitmaps.length);
+    const result = accumulator.finish();
+    const expected = RoaringBitmap32.orMany(bitmaps);
+    expect(result.isEqual(expected)).eq(true);
+    expect(result.size).eq(expected.size);
+    expect(result.toArray()).deep.equal(expected.toArray());
+  });
+
+  it("merges many bitmaps at once", () => {
+    const bitmaps = makeBitmaps(30);
+    const expected = RoaringBitmap32.orMany(bitmaps);
+    const accumulator = new RoaringBitmap32Accumulator();
+    expect(accumulator.orMany(bitmaps.slice(0, 10)).orMany(...bitmaps.slice(10)).finish().isEqual(expected)).eq(true);
+  });
+
+  it("does not modify the inputs", () => {
+    const a = new RoaringBitmap32([1, 2, 3]);
+    const b = new RoaringBitmap32([3, 4]);
+    const result = new RoaringBitmap32Accumulator().or(a).or(b).or(a).finish();
+    expect(result.toArray()).deep.equal([1, 2, 3, 4]);
+    expect(a.toArray()).deep.equal([1, 2, 3]);
+    expect(b.toArray()).deep.equal([3, 4]);
+  });
+
+  it("resets after finish and clear", () => {
+    const accumulator = new RoaringBitmap32Accumulator();
+    expect(accumulator.finish().size).eq(0);
+    const first = accumulator.or(new RoaringBitmap32([1, 2])).finish();
+    expect(accumulator.count).eq(0);
+    const second = accumulator.or(new RoaringBitmap32([5])).finish();
+    expect(first.toArray()).deep.equal([1, 2]);
+    expect(second.toArray()).deep.equal([5]);
+    accumulator.or(new RoaringBitmap32([7]));
+    accumulator.clear();
+    expect(accumulator.count).eq(0);
+    expect(accumulator.finish().size).eq(0);
+  });
+
+  it("accepts frozen bitmaps", () => {
+    const bitmap = new RoaringBitmap32([1, 100000]);
+    const buffer = bitmap.serialize("unsafe_frozen_croaring");
+    const frozen = RoaringBitmap32.unsafeFrozenView(buffer, "unsafe_frozen_croaring");
+    const result = new RoaringBitmap32Accumulator().or(frozen).or(new RoaringBitmap32([2])).finish();
+    expect(result.toArray()).deep.equal([1, 2, 100000]);
+  });
+
+  it("throws on invalid arguments", () => {
+    const accumulator = new RoaringBitmap32Accumulator();
+    expect(() => accumulator.or([1, 2] as any)).to.throw("RoaringBitmap32");
+    expect(() => accumulator.orMany([new RoaringBitmap32([1]), 2] as any)).to.throw("RoaringBitmap32");
+    expect(accumulator.count).eq(0);
+    expect(() => (RoaringBitmap32Accumulator as any)()).to.throw("new");
+  });
+});
@@ -0,0 +1,104 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmap32BulkWriter from "../../RoaringBitmap32BulkWriter";
+import roaring from "../..";
+
+describe("RoaringBitmap32BulkWriter", () => {
+  it("is exported", () => {
+    expect(roaring.RoaringBitmap32BulkWriter).eq(RoaringBitmap32BulkWriter);
+    const writer = new RoaringBitmap32BulkWriter(new RoaringBitmap32());
+    expect(Object.prototype.toString.call(writer)).eq("[object RoaringBitmap32BulkWriter]");
+  });
+
+  it("allocates an aligned buffer", () => {
+    const bitmap = new RoaringBitmap32();
+    const writer = new RoaringBitmap32BulkWriter(bitmap);
+    expect(writer.bitmap).eq(bitmap);
+    expect(writer.buffer).toBeInstanceOf(Uint32Array);
+    expect(writer.buffer.length).eq(4096);
+    expect(roaring.isBufferAligned(writer.buffer, 32)).eq(true);
+    expect(new RoaringBitmap32BulkWriter(bitmap, 10).buffer.length).eq(10);
+    const buffer = new Uint32Array(3);
+    expect(new RoaringBitmap32BulkWriter(bitmap, buffer).buffer).eq(buffer);
+  });
+
+  it("adds the values of the buffer", () => {
+    const bitmap = new RoaringBitmap32([5]);
+    const writer = new RoaringBitmap32BulkWriter(bitmap, 4);
+    writer.buffer.set([3, 1, 2, 70000]);
+    expect(writer.flush(3)).eq(writer);
+    expect(bitmap.toArray()).deep.equal([1, 2, 3, 5]);
+    writer.flush();
+    expect(bitmap.toArray()).deep.equal([1, 2, 3, 5, 70000]);
+    expect(bitmap.size).eq(5);
+    writer.flush(0);
+    expect(bitmap.size).eq(5);
+  });
+
+  it("matches addMany on many batches", () => {
+    const values = new Uint32Array(100000);
+    let seed = 1;
+    for (let i = 0; i < values.length; ++i) {
+      seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+      values[i] = i % 3 === 0 ? seed : seed % 200000;
+    }
+    const bitmap = new RoaringBitmap32();
+    const writer = new RoaringBitmap32BulkWriter(bitmap, 1000);
+    const buffer = writer.buffer;
+    let n = 0;
+    for (const value of values) {
+      buffer[n++] = value;
+      if (n === buffer.length) {
+        writer.flush(n);
+        n = 0;
+      }
+    }
+    writer.flush(n);
+    expect(bitmap.isEqual(new RoaringBitmap32(values))).eq(true);
+  });
+
+  it("supports changes to the bitmap between flushes", () => {
+    const bitmap = new RoaringBitmap32();
+    const writer = new RoaringBitmap32BulkWriter(bitmap, 2);
+    writer.buffer.set([1, 2]);
+    writer.flush();
+    bitmap.addRange(0, 100000);
+    bitmap.runOptimize();
+    bitmap.removeRange(10, 50000);
+    writer.buffer.set([20, 30]);
+    writer.flush();
+    bitmap.clear();
+    writer.buffer.set([7, 8]);
+    writer.flush();
+    expect(bitmap.toArray()).deep.equal([7, 8]);
+  });
+
+  it("supports runOptimize and shrinkToFit between flushes", () => {
+    const bitmap = new RoaringBitmap32();
+    const writer = new RoaringBitmap32BulkWriter(bitmap, 3000);
+    writer.buffer.set(Uint32Array.from({ length: 3000 }, (_, i) => i));
+    writer.flush();
+    expect(bitmap.runOptimize()).eq(true);
+    writer.buffer.set(Uint32Array.from({ length: 3000 }, (_, i) => 3000 + i));
+    writer.flush();
+    bitmap.shrinkToFit();
+    writer.buffer.set(Uint32Array.from({ length: 3000 }, (_, i) => 10000 + i * 2));
+    writer.flush();
+    const expected = RoaringBitmap32.fromRange(0, 6000);
+    expected.addMany(Uint32Array.from({ length: 3000 }, (_, i) => 10000 + i * 2));
+    expect(bitmap.isEqual(expected)).eq(true);
+  });
+
+  it("throws on invalid arguments", () => {
+    const bitmap = new RoaringBitmap32();
+    expect(() => new RoaringBitmap32BulkWriter([] as any)).to.throw("RoaringBitmap32");
+    expect(() => new RoaringBitmap32BulkWriter(bitmap, 0)).to.throw(TypeError);
+    expect(() => new RoaringBitmap32BulkWriter(bitmap, "x" as any)).to.throw(TypeError);
+    const writer = new RoaringBitmap32BulkWriter(bitmap, 4);
+    expect(() => writer.flush(5)).to.throw("count must be");
+    expect(() => writer.flush(-1)).to.throw("count must be");
+    bitmap.freeze();
+    expect(() => writer.flush(1)).to.throw();
+    expect(() => (RoaringBitmap32BulkWriter as any)(bitmap)).to.throw("new");
+  });
+});
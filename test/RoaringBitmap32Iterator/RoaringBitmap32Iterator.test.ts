@@ -207,6 +207,77 @@ describe("RoaringBitmap32Iterator", () => {
     });
   });
 
+  describe("from, to and seek", () => {
+    const bitmap = new RoaringBitmap32([1, 5, 10, 70000, 70001, 0xfffffffe]);
+    bitmap.addRange(200000, 200100);
+
+    it("iterates from a start value to an exclusive end bound", () => {
+      expect(Array.from(new RoaringBitmap32Iterator(bitmap, 4, { from: 5, to: 70001 }))).deep.equal([5, 10, 70000]);
+      expect(Array.from(bitmap.iterator({ from: 6 })).slice(0, 3)).deep.equal([10, 70000, 70001]);
+      expect(Array.from(bitmap.iterator({ to: 10 }))).deep.equal([1, 5]);
+      expect(Array.from(bitmap.iterator({ from: 200095, to: 0x100000000 }))).deep.equal([
+        200095, 200096, 200097, 200098, 200099, 0xfffffffe,
+      ]);
+      expect(Array.from(bitmap.iterator({ from: 0xffffffff }))).deep.equal([]);
+      expect(Array.from(bitmap.iterator({ from: 10, to: 10 }))).deep.equal([]);
+    });
+
+    it("paginates with seek", () => {
+      const iterator = new RoaringBitmap32Iterator(bitmap, 3, { to: 200010 });
+      const pages: number[][] = [];
+      let cursor = 0;
+      for (;;) {
+        const page: number[] = [];
+        iterator.seek(cursor);
+        for (let r = iterator.next(); !r.done; r = iterator.next()) {
+          page.push(r.value);
+          if (page.length === 4) {
+            break;
+          }
+        }
+        if (page.length === 0) {
+          break;
+        }
+        pages.push(page);
+        cursor = page[page.length - 1] + 1;
+        if (pages.length > 10) {
+          break;
+        }
+      }
+      expect(pages).deep.equal([
+        [1, 5, 10, 70000],
+        [70001, 200000, 200001, 200002],
+        [200003, 200004, 200005, 200006],
+        [200007, 200008, 200009],
+      ]);
+    });
+
+    it("seeks forward and backward on an open iterator", () => {
+      const iterator = bitmap.iterator();
+      expect(iterator.next().value).eq(1);
+      expect(iterator.seek(70000).next().value).eq(70000);
+      expect(iterator.seek(2).next().value).eq(5);
+      expect(iterator.next().value).eq(10);
+      expect(iterator.seek(0xffffffff).next().done).eq(true);
+      expect(iterator.seek(0xfffffffe).next().value).eq(0xfffffffe);
+    });
+
+    it("seeks back after a seek past the end", () => {
+      const iterator = bitmap.iterator();
+      expect(iterator.next().value).eq(1);
+      iterator.seek(0xffffffff);
+      expect(iterator.seek(5).next().value).eq(5);
+      expect(iterator.next().value).eq(10);
+      iterator.seek(0xffffffff).seek(0xffffffff);
+      expect(iterator.seek(70001).next().value).eq(70001);
+    });
+
+    it("throws for invalid bounds", () => {
+      expect(() => new RoaringBitmap32Iterator(bitmap, 4, { from: "x" as any })).toThrow();
+      expect(() => bitmap.iterator().seek(Number.NaN)).toThrow();
+    });
+  });
+
   it("throws if the bitmap is changed while iterating", () => {
     const bitmap = new RoaringBitmap32();
     bitmap.addRange(0, 1050);
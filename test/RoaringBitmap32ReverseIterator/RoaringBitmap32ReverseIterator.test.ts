@@ -208,6 +208,53 @@ describe("RoaringBitmap32ReverseIterator", () => {
     });
   });
 
+  it("iterates array, bitset and run containers with any buffer size", () => {
+    const bitmap = new RoaringBitmap32([1, 5, 70000, 70001, 0xfffffffe]);
+    for (let i = 0; i < 10000; ++i) {
+      bitmap.add(0x20000 + ((i * 7919) % 0x10000));
+    }
+    bitmap.addRange(0x30000, 0x30100);
+    bitmap.addRange(0x3ff00, 0x40010);
+    bitmap.addRange(0xffff0000, 0xffff0100);
+    bitmap.add(0xffffffff);
+    bitmap.runOptimize();
+    const expected = bitmap.toArray().reverse();
+    for (const bufferSize of [1, 2, 3, 63, 64, 65, 1000, 100000]) {
+      expect(Array.from(new RoaringBitmap32ReverseIterator(bitmap, bufferSize))).deep.equal(expected);
+    }
+    expect(bitmap.toReversed()).deep.equal(expected);
+    expect(bitmap.toReversed(300, 9000)).deep.equal(expected.slice(9000, 9300));
+  });
+
+  describe("from, to and seek", () => {
+    const bitmap = new RoaringBitmap32([0, 1, 5, 10, 70000, 70001, 0xffffffff]);
+
+    it("iterates from a start value down to an exclusive end bound", () => {
+      expect(Array.from(new RoaringBitmap32ReverseIterator(bitmap, 2, { from: 70000, to: 1 }))).deep.equal([
+        70000, 10, 5,
+      ]);
+      expect(Array.from(bitmap.reverseIterator({ from: 69999 }))).deep.equal([10, 5, 1, 0]);
+      expect(Array.from(bitmap.reverseIterator({ to: 10 }))).deep.equal([0xffffffff, 70001, 70000]);
+      expect(Array.from(bitmap.reverseIterator({ from: -1 }))).deep.equal([]);
+    });
+
+    it("seeks on an open iterator", () => {
+      const iterator = bitmap.reverseIterator({ to: 0 });
+      expect(iterator.next().value).eq(0xffffffff);
+      expect(iterator.seek(9).next().value).eq(5);
+      expect(Array.from(iterator)).deep.equal([1]);
+      expect(Array.from(iterator.seek(70000))).deep.equal([70000, 10, 5, 1]);
+    });
+
+    it("seeks back after a seek past the end", () => {
+      const iterator = bitmap.reverseIterator();
+      expect(iterator.next().value).eq(0xffffffff);
+      iterator.seek(-0.5);
+      expect(iterator.seek(10).next().value).eq(10);
+      expect(iterator.next().value).eq(5);
+    });
+  });
+
   it("throws if the bitmap is changed while iterating", () => {
     const bitmap = new RoaringBitmap32();
     bitmap.addRange(0, 1050);
@@ -0,0 +1,170 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmap64 from "../../RoaringBitmap64";
+
+const HIGH = 2n ** 32n;
+
+describe("RoaringBitmap64 basic", () => {
+  it("is exported", () => {
+    expect(typeof RoaringBitmap64).eq("function");
+    expect(RoaringBitmap64.default).eq(RoaringBitmap64);
+    expect(typeof RoaringBitmap64.RoaringBitmap64Iterator).eq("function");
+    expect(typeof RoaringBitmap64.RoaringBitmap64ReverseIterator).eq("function");
+  });
+
+  it("creates an empty bitmap", () => {
+    const bitmap = new RoaringBitmap64();
+    expect(bitmap.size).eq(0);
+    expect(bitmap.isEmpty).eq(true);
+    expect(bitmap.isFrozen).eq(false);
+    expect(bitmap.minimum()).eq(undefined);
+    expect(bitmap.maximum()).eq(undefined);
+    expect(bitmap.toArray()).deep.equal([]);
+    expect(String(bitmap)).eq("RoaringBitmap64");
+  });
+
+  it("accepts bigint and number values", () => {
+    const bitmap = new RoaringBitmap64([5, 2n ** 63n, HIGH + 1n, 1n, 2 ** 40]);
+    expect(bitmap.size).eq(5);
+    expect(bitmap.toArray()).deep.equal([1n, 5n, HIGH + 1n, 2n ** 40n, 2n ** 63n]);
+    expect(bitmap.has(5)).eq(true);
+    expect(bitmap.has(5n)).eq(true);
+    expect(bitmap.has(HIGH + 1n)).eq(true);
+    expect(bitmap.has(HIGH)).eq(false);
+    expect(bitmap.has(-1)).eq(false);
+    expect(bitmap.has("x")).eq(false);
+    expect(bitmap.minimum()).eq(1n);
+    expect(bitmap.maximum()).eq(2n ** 63n);
+  });
+
+  it("accepts the maximum uint64", () => {
+    const max = 2n ** 64n - 1n;
+    const bitmap = RoaringBitmap64.of(max, 0n);
+    expect(bitmap.toArray()).deep.equal([0n, max]);
+    expect(bitmap.select(1)).eq(max);
+    expect(bitmap.rank(max)).eq(2);
+  });
+
+  it("throws on invalid values", () => {
+    expect(() => new RoaringBitmap64([-1])).to.throw(TypeError);
+    expect(() => new RoaringBitmap64([2n ** 64n])).to.throw(RangeError);
+    expect(() => new RoaringBitmap64([0.5])).to.throw(TypeError);
+  });
+
+  it("rejects BigInts outside the 64 bit unsigned range", () => {
+    const bitmap = new RoaringBitmap64([1n, 2n]);
+    for (const value of [-1n, 2n ** 64n]) {
+      expect(() => bitmap.add(3n, value)).to.throw(RangeError, "64 bit unsigned");
+      expect(() => bitmap.tryAdd(value)).to.throw(RangeError, "64 bit unsigned");
+      expect(() => bitmap.addMany([value, 3n])).to.throw(RangeError, "64 bit unsigned");
+      expect(() => bitmap.removeMany([1n, value])).to.throw(RangeError, "64 bit unsigned");
+      expect(() => bitmap.orInPlace([value])).to.throw(RangeError, "64 bit unsigned");
+      expect(() => RoaringBitmap64.of(3n, value)).to.throw(RangeError, "64 bit unsigned");
+    }
+    expect(bitmap.toArray()).deep.equal([1n, 2n]);
+    expect(bitmap.add(-1, 0.5, "x" as any).toArray()).deep.equal([1n, 2n]);
+  });
+
+  it("constructs from BigUint64Array, Set, RoaringBitmap32 and RoaringBitmap64", () => {
+    const a = new RoaringBitmap64(new BigUint64Array([3n, HIGH * 3n, 1n]));
+    expect(a.toArray()).deep.equal([1n, 3n, HIGH * 3n]);
+    expect(new RoaringBitmap64(new Set([7n, 8])).toArray()).deep.equal([7n, 8n]);
+    expect(new RoaringBitmap64(new RoaringBitmap32([1, 2, 0xffffffff])).toArray()).deep.equal([1n, 2n, 0xffffffffn]);
+    const b = new RoaringBitmap64(a);
+    expect(b.isEqual(a)).eq(true);
+    expect(b).not.eq(a);
+  });
+
+  it("adds and removes values", () => {
+    const bitmap = new RoaringBitmap64();
+    expect(bitmap.add(1n, HIGH + 2n)).eq(bitmap);
+    expect(bitmap.tryAdd(1n)).eq(false);
+    expect(bitmap.tryAdd(HIGH)).eq(true);
+    expect(bitmap.size).eq(3);
+    expect(bitmap.remove(HIGH + 2n)).eq(true);
+    expect(bitmap.delete(HIGH + 2n)).eq(false);
+    expect(bitmap.toArray()).deep.equal([1n, HIGH]);
+    bitmap.addMany([10n, 11n]).removeMany(new BigUint64Array([1n]));
+    expect(bitmap.toArray()).deep.equal([10n, 11n, HIGH]);
+    expect(bitmap.clear()).eq(true);
+    expect(bitmap.clear()).eq(false);
+    expect(bitmap.isEmpty).eq(true);
+  });
+
+  it("handles ranges across the 32 bit boundary", () => {
+    const bitmap = new RoaringBitmap64().addRange(HIGH - 2n, HIGH + 2n);
+    expect(bitmap.toArray()).deep.equal([HIGH - 2n, HIGH - 1n, HIGH, HIGH + 1n]);
+    expect(bitmap.rangeCardinality(HIGH - 1n, HIGH + 1n)).eq(2);
+    expect(bitmap.hasRange(HIGH - 2n, HIGH + 2n)).eq(true);
+    expect(bitmap.hasRange(HIGH - 2n, HIGH + 3n)).eq(false);
+    bitmap.removeRange(HIGH - 1n, HIGH + 1n);
+    expect(bitmap.toArray()).deep.equal([HIGH - 2n, HIGH + 1n]);
+    bitmap.flipRange(HIGH - 2n, HIGH + 2n);
+    expect(bitmap.toArray()).deep.equal([HIGH - 1n, HIGH]);
+  });
+
+  it("rejects ranges that touch too many blocks of 2^32 values", () => {
+    const bitmap = new RoaringBitmap64();
+    expect(() => bitmap.addRange(0n, 2n ** 64n)).to.throw("65536");
+    expect(() => bitmap.flipRange(0)).to.throw("65536");
+    expect(bitmap.isEmpty).eq(true);
+    bitmap.addRange(HIGH * 65535n, HIGH * 65536n + 1n);
+    expect(bitmap.size).eq(Number(HIGH) + 1);
+    expect(bitmap.removeRange(0n).isEmpty).eq(true);
+  });
+
+  it("computes set operations", () => {
+    const a = new RoaringBitmap64([1n, 2n, HIGH + 1n, HIGH * 5n]);
+    const b = new RoaringBitmap64([2n, HIGH + 1n, HIGH * 7n]);
+    expect(RoaringBitmap64.and(a, b).toArray()).deep.equal([2n, HIGH + 1n]);
+    expect(RoaringBitmap64.or(a, b).toArray()).deep.equal([1n, 2n, HIGH + 1n, HIGH * 5n, HIGH * 7n]);
+    expect(RoaringBitmap64.xor(a, b).toArray()).deep.equal([1n, HIGH * 5n, HIGH * 7n]);
+    expect(RoaringBitmap64.andNot(a, b).toArray()).deep.equal([1n, HIGH * 5n]);
+    expect(a.andCardinality(b)).eq(2);
+    expect(a.orCardinality(b)).eq(5);
+    expect(a.xorCardinality(b)).eq(3);
+    expect(a.andNotCardinality(b)).eq(2);
+    expect(a.intersects(b)).eq(true);
+    expect(RoaringBitmap64.and(a, b).isSubset(a)).eq(true);
+    expect(a.isSuperset(RoaringBitmap64.and(a, b))).eq(true);
+
+    const c = a.clone();
+    c.andInPlace(b);
+    expect(c.toArray()).deep.equal([2n, HIGH + 1n]);
+    c.orInPlace([HIGH * 9n]);
+    expect(c.toArray()).deep.equal([2n, HIGH + 1n, HIGH * 9n]);
+    c.xorInPlace(b);
+    expect(c.toArray()).deep.equal([HIGH * 7n, HIGH * 9n]);
+    c.andNotInPlace([HIGH * 7n]);
+    expect(c.toArray()).deep.equal([HIGH * 9n]);
+  });
+
+  it("iterates forward and in reverse", () => {
+    const values = [0n, 3n, HIGH, HIGH + 9n, 2n ** 50n];
+    const bitmap = new RoaringBitmap64(values);
+    expect(Array.from(bitmap)).deep.equal(values);
+    expect(Array.from(bitmap.reverseIterator())).deep.equal(values.slice().reverse());
+    expect(Array.from(new RoaringBitmap64.RoaringBitmap64Iterator(bitmap, 1))).deep.equal(values);
+    const seen: bigint[] = [];
+    bitmap.forEach((v) => seen.push(v));
+    expect(seen).deep.equal(values);
+    expect(bitmap.toBigUint64Array()).deep.equal(new BigUint64Array(values));
+  });
+
+  it("throws if the bitmap changes while iterating", () => {
+    const bitmap = new RoaringBitmap64().addRange(0, 10000);
+    const iterator = new RoaringBitmap64.RoaringBitmap64Iterator(bitmap, 16);
+    for (let i = 0; i < 16; ++i) {
+      iterator.next();
+    }
+    bitmap.add(HIGH);
+    expect(() => iterator.next()).to.throw();
+  });
+
+  it("freezes", () => {
+    const bitmap = new RoaringBitmap64([1n]).freeze();
+    expect(bitmap.isFrozen).eq(true);
+    expect(() => bitmap.add(2n)).to.throw();
+    expect(bitmap.clone().isFrozen).eq(false);
+  });
+});
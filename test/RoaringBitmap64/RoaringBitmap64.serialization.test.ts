@@ -0,0 +1,54 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmap64 from "../../RoaringBitmap64";
+
+const HIGH = 2n ** 32n;
+
+describe("RoaringBitmap64 serialization", () => {
+  it("serializes an empty bitmap as a bucket count of zero", () => {
+    const buffer = new RoaringBitmap64().serialize("portable");
+    expect(Array.from(buffer)).deep.equal([0, 0, 0, 0, 0, 0, 0, 0]);
+    expect(RoaringBitmap64.deserialize(buffer, "portable").isEmpty).eq(true);
+  });
+
+  it("writes the portable 64 bit layout", () => {
+    const bitmap = new RoaringBitmap64([1n, 2n, HIGH * 3n + 4n]);
+    const buffer = bitmap.serialize("portable");
+    expect(buffer.length).eq(bitmap.getSerializationSizeInBytes("portable"));
+    const view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
+    expect(view.getBigUint64(0, true)).eq(2n);
+    expect(view.getUint32(8, true)).eq(0);
+    const first = new RoaringBitmap32([1, 2]).serialize("portable");
+    expect(Array.from(buffer.subarray(12, 12 + first.length))).deep.equal(Array.from(first));
+    expect(view.getUint32(12 + first.length, true)).eq(3);
+  });
+
+  it("round trips", () => {
+    const bitmap = new RoaringBitmap64([0n, 5n, HIGH + 1n, 2n ** 63n, 2n ** 64n - 1n]).addRange(HIGH * 8n, HIGH * 8n + 100000n);
+    bitmap.runOptimize();
+    const buffer = bitmap.serialize("portable");
+    const copy = RoaringBitmap64.deserialize(buffer, "portable");
+    expect(copy.isEqual(bitmap)).eq(true);
+    expect(copy.size).eq(bitmap.size);
+  });
+
+  it("serializes into the given output buffer", () => {
+    const bitmap = new RoaringBitmap64([HIGH, HIGH + 1n]);
+    const output = new Uint8Array(bitmap.getSerializationSizeInBytes("portable"));
+    bitmap.serialize("portable", output);
+    expect(RoaringBitmap64.deserialize(output, "portable").toArray()).deep.equal([HIGH, HIGH + 1n]);
+  });
+
+  it("throws on invalid data", () => {
+    expect(() => RoaringBitmap64.deserialize(new Uint8Array([1, 0, 0, 0, 0, 0, 0, 0]), "portable")).to.throw();
+    expect(() => RoaringBitmap64.deserialize(new Uint8Array([1, 2, 3]), "portable")).to.throw();
+  });
+
+  it("creates a frozen view", () => {
+    const bitmap = new RoaringBitmap64([1n, 2n, HIGH * 7n]);
+    const view = RoaringBitmap64.unsafeFrozenView(bitmap.serialize("portable"), "unsafe_frozen_portable");
+    expect(view.isFrozen).eq(true);
+    expect(view.toArray()).deep.equal([1n, 2n, HIGH * 7n]);
+    expect(() => view.add(3n)).to.throw();
+  });
+});
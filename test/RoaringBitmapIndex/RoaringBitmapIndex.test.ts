@@ -0,0 +1,114 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmapIndex from "../../RoaringBitmapIndex";
+import roaring from "../..";
+
+describe("RoaringBitmapIndex", () => {
+  it("is exported", () => {
+    expect(roaring.RoaringBitmapIndex).eq(RoaringBitmapIndex);
+    expect(Object.prototype.toString.call(new RoaringBitmapIndex())).eq("[object RoaringBitmapIndex]");
+  });
+
+  it("adds, gets and removes ids", () => {
+    const index = new RoaringBitmapIndex();
+    expect(index.size).eq(0);
+    expect(index.add("a", 1)).eq(index);
+    index.add("a", 5).add("b", 3).add("ü€", 7);
+    expect(index.size).eq(3);
+    expect(index.has("a")).eq(true);
+    expect(index.has("c")).eq(false);
+    expect(index.cardinality("a")).eq(2);
+    expect(index.cardinality("c")).eq(0);
+    expect(index.get("a")!.toArray()).deep.equal([1, 5]);
+    expect(index.get("ü€")!.toArray()).deep.equal([7]);
+    expect(index.get("c")).eq(undefined);
+    expect(index.keys().sort()).deep.equal(["a", "b", "ü€"]);
+
+    expect(index.remove("a", 1)).eq(true);
+    expect(index.remove("a", 1)).eq(false);
+    expect(index.remove("b", 3)).eq(true);
+    expect(index.has("b")).eq(false);
+    expect(index.delete("a")).eq(true);
+    expect(index.delete("a")).eq(false);
+    expect(index.size).eq(1);
+    index.clear();
+    expect(index.size).eq(0);
+  });
+
+  it("returns copies", () => {
+    const index = new RoaringBitmapIndex().add("a", 1);
+    const bitmap = index.get("a")!;
+    bitmap.add(2);
+    expect(index.cardinality("a")).eq(1);
+    index.set("b", bitmap);
+    bitmap.add(3);
+    expect(index.get("b")!.toArray()).deep.equal([1, 2]);
+    index.set("b", new RoaringBitmap32());
+    expect(index.has("b")).eq(false);
+  });
+
+  it("adds many ids", () => {
+    const index = new RoaringBitmapIndex();
+    index.addMany("x", new Uint32Array([3, 1, 2]));
+    index.addMany("x", [10, 11]);
+    index.addMany("y", []);
+    expect(index.get("x")!.toArray()).deep.equal([1, 2, 3, 10, 11]);
+    expect(index.has("y")).eq(false);
+
+    index.addMany(["a", "a", "b", "a", "c"], new Uint32Array([1, 2, 3, 4, 5]));
+    index.addMany(["b", "c"], [6, 7]);
+    expect(index.get("a")!.toArray()).deep.equal([1, 2, 4]);
+    expect(index.get("b")!.toArray()).deep.equal([3, 6]);
+    expect(index.get("c")!.toArray()).deep.equal([5, 7]);
+
+    expect(() => index.addMany(["a"], [1, 2])).to.throw("same length");
+    expect(() => index.addMany("z", [1, -1])).to.throw(TypeError);
+    expect(index.has("z")).eq(false);
+  });
+
+  it("does not modify the index when addMany gets an invalid key or id", () => {
+    const index = new RoaringBitmapIndex();
+    index.add("a", 100);
+    expect(() => index.addMany(["a", "b", 5 as any, "c"], [1, 2, 3, 4])).to.throw(TypeError);
+    expect(() => index.addMany(["a", "b", "c"], [1, 2, -3])).to.throw(TypeError);
+    expect(() => index.addMany(["a", "b", "c"], [1, 2])).to.throw("same length");
+    expect(index.size).eq(1);
+    expect(index.keys()).deep.equal(["a"]);
+    expect(index.get("a")!.toArray()).deep.equal([100]);
+  });
+
+  it("computes unions and intersections of keys", () => {
+    const index = new RoaringBitmapIndex();
+    const expected = new Map<string, RoaringBitmap32>();
+    for (let k = 0; k < 20; ++k) {
+      const bitmap = new RoaringBitmap32();
+      for (let v = k; v < 100000; v += k + 1) {
+        bitmap.add(v);
+      }
+      bitmap.add(99999);
+      expected.set(`key${k}`, bitmap);
+      index.set(`key${k}`, bitmap);
+    }
+    const keys = ["key3", "key0", "key7", "key12"];
+    const bitmaps = keys.map((key) => expected.get(key)!);
+    expect(index.orMany(keys).isEqual(RoaringBitmap32.orMany(bitmaps))).eq(true);
+    expect(index.andMany(keys).isEqual(RoaringBitmap32.andMany(bitmaps))).eq(true);
+    expect(index.orManyCardinality(keys)).eq(RoaringBitmap32.orMany(bitmaps).size);
+    expect(index.andManyCardinality(keys)).eq(RoaringBitmap32.andMany(bitmaps).size);
+
+    expect(index.orMany([...keys, "missing"]).isEqual(RoaringBitmap32.orMany(bitmaps))).eq(true);
+    expect(index.andMany([...keys, "missing"]).size).eq(0);
+    expect(index.andManyCardinality(["missing"])).eq(0);
+    expect(index.orMany([]).size).eq(0);
+    expect(index.andMany([]).size).eq(0);
+  });
+
+  it("throws on invalid arguments", () => {
+    const index = new RoaringBitmapIndex();
+    expect(() => index.add(1 as any, 1)).to.throw("key must be a string");
+    expect(() => index.add("a", -1)).to.throw(TypeError);
+    expect(() => index.orMany([1 as any])).to.throw("array of strings");
+    expect(() => index.set("a", [1] as any)).to.throw("RoaringBitmap32");
+    expect(() => (RoaringBitmapIndex as any)()).to.throw("new");
+  });
+});
@@ -0,0 +1,179 @@
+import { describe, expect, it } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+import RoaringBitmapSliced32 from "../../RoaringBitmapSliced32";
+import roaring from "../..";
+
+/** Deterministic pseudo random columns and values, with repeated values and a few big ones. */
+function makeData(count: number): Map<number, number> {
+  const data = new Map<number, number>();
+  let seed = 12345;
+  const next = () => {
+    seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+    return seed;
+  };
+  for (let i = 0; i < count; ++i) {
+    const column = next() % 200000;
+    const value = i % 17 === 0 ? next() : next() % 1000;
+    data.set(column, value);
+  }
+  data.set(7, 0);
+  data.set(8, 0xffffffff);
+  return data;
+}
+
+function build(data: Map<number, number>): RoaringBitmapSliced32 {
+  const bsi = new RoaringBitmapSliced32();
+  for (const [column, value] of data) {
+    bsi.set(column, value);
+  }
+  return bsi;
+}
+
+function select(data: Map<number, number>, predicate: (value: number) => boolean, filter?: RoaringBitmap32) {
+  const result: number[] = [];
+  for (const [column, value] of data) {
+    if ((!filter || filter.has(column)) && predicate(value)) {
+      result.push(column);
+    }
+  }
+  return result.sort((a, b) => a - b);
+}
+
+describe("RoaringBitmapSliced32", () => {
+  it("is exported", () => {
+    expect(roaring.RoaringBitmapSliced32).eq(RoaringBitmapSliced32);
+    expect(Object.prototype.toString.call(new RoaringBitmapSliced32())).eq("[object RoaringBitmapSliced32]");
+  });
+
+  it("sets, gets and deletes values", () => {
+    const bsi = new RoaringBitmapSliced32();
+    expect(bsi.size).eq(0);
+    expect(bsi.bitDepth).eq(0);
+    expect(bsi.set(10, 5)).eq(bsi);
+    bsi.set(20, 0).set(30, 1000);
+    expect(bsi.size).eq(3);
+    expect(bsi.bitDepth).eq(10);
+    expect(bsi.get(10)).eq(5);
+    expect(bsi.get(20)).eq(0);
+    expect(bsi.get(30)).eq(1000);
+    expect(bsi.get(40)).eq(undefined);
+    bsi.set(30, 3);
+    expect(bsi.get(30)).eq(3);
+    expect(bsi.has(30)).eq(true);
+    expect(bsi.delete(30)).eq(true);
+    expect(bsi.delete(30)).eq(false);
+    expect(bsi.has(30)).eq(false);
+    expect(bsi.columns().toArray()).deep.equal([10, 20]);
+    bsi.clear();
+    expect(bsi.size).eq(0);
+    expect(bsi.bitDepth).eq(0);
+  });
+
+  it("sets many values", () => {
+    const data = makeData(5000);
+    const bsi = new RoaringBitmapSliced32();
+    bsi.set(8, 1);
+    bsi.setMany(new Uint32Array(data.keys()), new Uint32Array(data.values()));
+    expect(bsi.size).eq(data.size);
+    for (const [column, value] of data) {
+      expect(bsi.get(column)).eq(value);
+    }
+    expect(() => bsi.setMany(new Uint32Array(2), new Uint32Array(1))).to.throw("same length");
+  });
+
+  it("updates existing columns with setMany", () => {
+    const bsi = new RoaringBitmapSliced32();
+    const count = 4097;
+    bsi.setMany(
+      Uint32Array.from({ length: count }, (_, i) => i),
+      new Uint32Array(count).fill(1),
+    );
+    // Clearing bit 0 of existing columns shrinks the slice container from a bitset to an array between bulk adds.
+    bsi.setMany(new Uint32Array([5000, 0, 1, 2, 5001, 5002]), new Uint32Array([1, 2, 2, 2, 1, 1]));
+    bsi.setMany(
+      Uint32Array.from({ length: count }, (_, i) => i),
+      Uint32Array.from({ length: count }, (_, i) => (i % 3 === 0 ? 2 : 1)),
+    );
+    for (let column = 0; column < count; ++column) {
+      expect(bsi.get(column)).eq(column % 3 === 0 ? 2 : 1);
+    }
+    expect(bsi.get(5000)).eq(1);
+    expect(bsi.get(5002)).eq(1);
+    expect(bsi.equal(1).size).eq(count - Math.ceil(count / 3) + 3);
+  });
+
+  it("computes range predicates", () => {
+    const data = makeData(5000);
+    const bsi = build(data);
+    const filter = new RoaringBitmap32();
+    filter.addRange(0, 100000);
+    for (const value of [0, 1, 500, 999, 1000, 0x7fffffff, 0xffffffff]) {
+      for (const f of [undefined, filter]) {
+        expect(bsi.equal(value, f).toArray()).deep.equal(select(data, (v) => v === value, f));
+        expect(bsi.notEqual(value, f).toArray()).deep.equal(select(data, (v) => v !== value, f));
+        expect(bsi.lessThan(value, f).toArray()).deep.equal(select(data, (v) => v < value, f));
+        expect(bsi.lessThanOrEqual(value, f).toArray()).deep.equal(select(data, (v) => v <= value, f));
+        expect(bsi.greaterThan(value, f).toArray()).deep.equal(select(data, (v) => v > value, f));
+        expect(bsi.greaterThanOrEqual(value, f).toArray()).deep.equal(select(data, (v) => v >= value, f));
+      }
+    }
+    expect(bsi.between(100, 200).toArray()).deep.equal(select(data, (v) => v >= 100 && v <= 200));
+    expect(bsi.between(100, 200, filter).toArray()).deep.equal(select(data, (v) => v >= 100 && v <= 200, filter));
+    expect(bsi.between(200, 100).size).eq(0);
+  });
+
+  it("compares values above the bit depth", () => {
+    const bsi = new RoaringBitmapSliced32().set(1, 3).set(2, 5);
+    expect(bsi.lessThan(100).toArray()).deep.equal([1, 2]);
+    expect(bsi.greaterThan(100).size).eq(0);
+    expect(bsi.equal(100).size).eq(0);
+  });
+
+  it("computes sum, min and max", () => {
+    const data = makeData(5000);
+    const bsi = build(data);
+    const filter = new RoaringBitmap32();
+    filter.addRange(50000, 150000);
+    const values = [...data.values()];
+    const filtered = select(data, () => true, filter).map((column) => data.get(column)!);
+    expect(bsi.sum()).eq(values.reduce((a, b) => a + b, 0));
+    expect(bsi.sum(filter)).eq(filtered.reduce((a, b) => a + b, 0));
+    expect(bsi.min()).eq(Math.min(...values));
+    expect(bsi.max()).eq(Math.max(...values));
+    expect(bsi.min(filter)).eq(Math.min(...filtered));
+    expect(bsi.max(filter)).eq(Math.max(...filtered));
+    expect(bsi.min(new RoaringBitmap32([1000000]))).eq(undefined);
+    expect(new RoaringBitmapSliced32().max()).eq(undefined);
+    expect(new RoaringBitmapSliced32().sum()).eq(0);
+  });
+
+  it("computes the top k columns", () => {
+    const data = makeData(5000);
+    const bsi = build(data);
+    const filter = new RoaringBitmap32();
+    filter.addRange(0, 120000);
+    for (const f of [undefined, filter]) {
+      const sorted = select(data, () => true, f).sort((a, b) => data.get(b)! - data.get(a)! || a - b);
+      for (const k of [0, 1, 10, 100, 1000, 1000000]) {
+        expect(bsi.topK(k, f).toArray()).deep.equal(sorted.slice(0, k).sort((a, b) => a - b));
+      }
+    }
+  });
+
+  it("takes ties in column order", () => {
+    const bsi = new RoaringBitmapSliced32();
+    for (let column = 0; column < 10; ++column) {
+      bsi.set(column, column < 3 ? 9 : 4);
+    }
+    expect(bsi.topK(5).toArray()).deep.equal([0, 1, 2, 3, 4]);
+  });
+
+  it("throws on invalid arguments", () => {
+    const bsi = new RoaringBitmapSliced32();
+    expect(() => bsi.set(-1, 1)).to.throw(TypeError);
+    expect(() => bsi.set(1, 2 ** 32)).to.throw(TypeError);
+    expect(() => bsi.equal(1, [1] as any)).to.throw("filter");
+    expect(() => bsi.topK(-1)).to.throw("k must be");
+    expect(() => (RoaringBitmapSliced32 as any)()).to.throw("new");
+  });
+});
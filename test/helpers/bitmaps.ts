@@ -0,0 +1,30 @@
+import RoaringBitmap32 from "../../RoaringBitmap32";
+
+/**
+ * Creates count different bitmaps for the tests of operations on many bitmaps.
+ * Sizes and overlaps vary with the index, with array, run, bitset and full containers; all the bitmaps contain 77777.
+ */
+export function makeBitmaps(count: number): RoaringBitmap32[] {
+  const result: RoaringBitmap32[] = [];
+  for (let i = 0; i < count; ++i) {
+    const bitmap = new RoaringBitmap32([77777]);
+    const start = (i * 37) % 2000;
+    for (let k = 0; k < (i % 11) * 25; ++k) {
+      bitmap.add(start + ((k * (i + 3)) % 1500));
+    }
+    if (i % 3 === 1) {
+      bitmap.addRange(0x10000 + i * 100, 0x10000 + i * 100 + 3000);
+    }
+    if (i % 4 === 2) {
+      bitmap.orInPlace(RoaringBitmap32.fromRange(0x30000 + (i % 5), 0x40000, 2 + (i % 5)));
+    }
+    if (i % 2 === 1) {
+      bitmap.addRange(0x40000, 0x50000);
+    }
+    if (i % 5 === 0) {
+      bitmap.runOptimize();
+    }
+    result.push(bitmap);
+  }
+  return result;
+}
@@ -0,0 +1,30 @@
+import v8 from "node:v8";
+import vm from "node:vm";
+import { expect } from "vitest";
+import RoaringBitmap32 from "../../RoaringBitmap32";
+
+v8.setFlagsFromString("--expose-gc");
+
+/** Runs a full garbage collection. */
+export const gc: () => void = vm.runInNewContext("gc");
+
+/**
+ * Starts an asynchronous operation on the given bitmaps, half of them passed as readonly views, then drops every
+ * reference to them and runs the garbage collector: the operation must keep alive all the bitmaps it reads.
+ */
+export function startWithUnreferencedBitmaps<T>(
+  bitmaps: RoaringBitmap32[],
+  start: (bitmaps: RoaringBitmap32[]) => Promise<T>,
+): Promise<T> {
+  gc();
+  const instances = RoaringBitmap32.getInstancesCount();
+  let inputs: RoaringBitmap32[] | null = bitmaps.map((bitmap, i) =>
+    i % 2 ? (bitmap.asReadonlyView() as RoaringBitmap32) : bitmap,
+  );
+  const promise = start(inputs);
+  inputs = null;
+  bitmaps.length = 0;
+  gc();
+  expect(RoaringBitmap32.getInstancesCount()).eq(instances);
+  return promise;
+}